@@ -1,3 +1,79 @@
+#if BLOCK_WORLD_VERTEX_FACTORY_FLAG_PACKED_VERTICES
+
+struct VertexFactoryInput
+{
+    uint2 PackedPosition            : POSITION;
+    uint PackedTexCoord             : TEXCOORD;
+    float4 Color                    : COLOR;
+};
+
+// horizontal normal directions for frame indices 0-31, in 22.5 degree steps
+static const float2 PACKED_FRAME_DIRECTIONS[16] =
+{
+    float2(1.0f, 0.0f), float2(0.92388f, 0.382683f), float2(0.707107f, 0.707107f), float2(0.382683f, 0.92388f),
+    float2(0.0f, 1.0f), float2(-0.382683f, 0.92388f), float2(-0.707107f, 0.707107f), float2(-0.92388f, 0.382683f),
+    float2(-1.0f, 0.0f), float2(-0.92388f, -0.382683f), float2(-0.707107f, -0.707107f), float2(-0.382683f, -0.92388f),
+    float2(0.0f, -1.0f), float2(0.382683f, -0.92388f), float2(0.707107f, -0.707107f), float2(0.92388f, -0.382683f)
+};
+
+float3 UnpackPosition(VertexFactoryInput input)
+{
+    return float3(float(input.PackedPosition.x & 0xFFFF), float(input.PackedPosition.x >> 16), float(input.PackedPosition.y & 0xFFFF)) * (1.0f / 256.0f);
+}
+
+float3 UnpackTexCoord(VertexFactoryInput input)
+{
+    // sign extend the 16-bit components
+    int u = int(input.PackedTexCoord << 16) >> 16;
+    int v = int(input.PackedTexCoord) >> 16;
+    return float3(float(u) * (1.0f / 256.0f), float(v) * (1.0f / 256.0f), float(input.PackedPosition.y >> 22));
+}
+
+// 0-15: horizontal normal, tangent rotated -90 degrees, 16-31: horizontal normal, tangent rotated +90 degrees, 32: up, 33: down
+void UnpackTangentFrame(VertexFactoryInput input, out float3 tangent, out float3 normal, out float binormalSign)
+{
+    uint frameIndex = (input.PackedPosition.y >> 16) & 0x3F;
+    if (frameIndex >= 32)
+    {
+        normal = float3(0.0f, 0.0f, (frameIndex == 32) ? 1.0f : -1.0f);
+        tangent = float3(1.0f, 0.0f, 0.0f);
+        binormalSign = -normal.z;
+    }
+    else
+    {
+        float2 direction = PACKED_FRAME_DIRECTIONS[frameIndex & 15];
+        binormalSign = (frameIndex >= 16) ? -1.0f : 1.0f;
+        normal = float3(direction, 0.0f);
+        tangent = float3(direction.y, -direction.x, 0.0f) * binormalSign;
+    }
+}
+
+float3 UnpackNormal(VertexFactoryInput input)
+{
+    float3 tangent, normal;
+    float binormalSign;
+    UnpackTangentFrame(input, tangent, normal, binormalSign);
+    return normal;
+}
+
+float3 VertexFactoryGetLocalPosition(VertexFactoryInput input) { return UnpackPosition(input); }
+float3 VertexFactoryGetWorldPosition(VertexFactoryInput input) { return mul(ObjectConstants.WorldMatrix, float4(UnpackPosition(input), 1)).xyz; }
+float4 VertexFactoryGetTexCoord(VertexFactoryInput input) { return float4(UnpackTexCoord(input), 0); }
+float4 VertexFactoryGetTexCoord2(VertexFactoryInput input) { return float4(0, 0, 0, 0); }
+float4 VertexFactoryGetVertexColor(VertexFactoryInput input) { return float4(input.Color.xyz, 1.0f); }
+float3 VertexFactoryGetLocalNormal(VertexFactoryInput input) { return UnpackNormal(input); }
+float3 VertexFactoryGetWorldNormal(VertexFactoryInput input) { return normalize(mul((float3x3)ObjectConstants.WorldMatrix, UnpackNormal(input))); }
+float3x3 VertexFactoryGetTangentBasis(VertexFactoryInput input)
+{
+    float3 tangent, normal;
+    float binormalSign;
+    UnpackTangentFrame(input, tangent, normal, binormalSign);
+    float3 binormal = cross(normal, tangent) * binormalSign;
+    return float3x3(tangent, binormal, normal);
+}
+
+#else
+
 struct VertexFactoryInput
 {
     float3 Position                 : POSITION;
@@ -17,8 +93,8 @@ float4 VertexFactoryGetTexCoord2(VertexFactoryInput input) { return float4(0, 0,
 float4 VertexFactoryGetVertexColor(VertexFactoryInput input) { return float4(input.Color.xyz, 1.0f); }
 float3 VertexFactoryGetLocalNormal(VertexFactoryInput input) { return input.Normal.xyz; }
 float3 VertexFactoryGetWorldNormal(VertexFactoryInput input) { return normalize(mul((float3x3)ObjectConstants.WorldMatrix, input.Normal.xyz)); }
-float3x3 VertexFactoryGetTangentBasis(VertexFactoryInput input) 
-{ 
+float3x3 VertexFactoryGetTangentBasis(VertexFactoryInput input)
+{
     float3 tangent = /*UnpackFromColorRange3*/(input.TangentAndBinormalSign.xyz);
     float3 normal = /*UnpackFromColorRange3*/(input.Normal.xyz);
     float3 binormal = cross(normal, tangent) * (input.TangentAndBinormalSign.w);// * 2.0f + -1.0f);
@@ -26,6 +102,8 @@ float3x3 VertexFactoryGetTangentBasis(VertexFactoryInput input)
     //return float3x3(input.Tangent, input.Binormal, input.Normal);
 }
 
+#endif
+
 float3x3 VertexFactoryGetTangentToWorld(VertexFactoryInput input, float3x3 tangentBasis) { return mul((float3x3)ObjectConstants.WorldMatrix, transpose(tangentBasis)); }
 float3 VertexFactoryTransformWorldToTangentSpace(float3x3 tangentBasis, float3 worldVector) { return mul(tangentBasis, mul((float3x3)ObjectConstants.InverseWorldMatrix, worldVector)); }
 
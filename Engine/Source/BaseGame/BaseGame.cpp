@@ -7,6 +7,7 @@
 #include "Engine/Profiling.h"
 #include "Renderer/WorldRenderer.h"
 #include "Renderer/ImGuiBridge.h"
+#include "BaseGame/LoadingScreenProgressCallbacks.h"
 #include "YBaseLib/CPUID.h"
 Log_SetChannel(BaseGame);
 
@@ -593,13 +594,15 @@ void BaseGame::MainThreadFrame(float deltaTime)
     // wait for async commands to finish, use the main thread to help them out
     {
         MICROPROFILE_SCOPEI("BaseGame", "CompleteAsyncTasks", MICROPROFILE_COLOR(10, 50, 20));
-        g_pEngine->GetAsyncCommandQueue()->ExecuteQueuedTasks();
+        g_pEngine->GetAsyncCommandQueue()->ExecuteQueuedCommands();
     }
 
     // run any callbacks
     {
         MICROPROFILE_SCOPEI("BaseGame", "ExecuteQueuedTasks", MICROPROFILE_COLOR(75, 120, 10));
-        g_pEngine->GetMainThreadCommandQueue()->ExecuteQueuedTasks();
+        g_pEngine->GetMainThreadCommandQueue()->ExecuteQueuedCommands();
+        g_pEngine->GetJobSystem()->ExecuteMainThreadJobs();
+        g_pEngine->UpdateCommandQueueProfilerCounters();
     }
 
     // run normal tick
@@ -1244,6 +1247,13 @@ int32 BaseGame::MainEntryPoint()
     // everything started
     Log_InfoPrintf("All engine subsystems initialized in %.2f msec", initTimer.GetTimeMilliseconds());
 
+    // create the shader permutations used on previous runs up front, rather than on first draw
+    if (CVars::r_precompile_shaders.GetBool())
+    {
+        LoadingScreenProgressCallbacks progressCallbacks;
+        g_pRenderer->PrecompileRecordedShaderPermutations(&progressCallbacks);
+    }
+
     // initialize game
     initTimer.Reset();
     Log_InfoPrint("Initializing game...");
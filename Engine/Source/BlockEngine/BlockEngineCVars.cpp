@@ -8,9 +8,15 @@ namespace CVars
     CVar r_block_world_chunk_remove_delay("r_block_world_chunk_remove_delay", 0, "10", "Number of seconds to delay removing a previously visible chunk", "float:0-60");
     CVar r_block_world_parallel_chunk_build("r_block_world_parallel_chunk_build", CVAR_FLAG_REQUIRE_MAP_RESTART, "true", "Enable parallel chunk building", "bool");
     CVar r_block_world_max_chunks_per_frame("r_block_world_max_chunks_per_frame", 0, "100", "Maximum number of triangulation passes to perform each frame", "uint:1-256");
+    CVar r_block_world_max_meshing_jobs("r_block_world_max_meshing_jobs", 0, "64", "Maximum number of chunks being meshed at once", "uint:1-4096");
+    CVar r_block_world_mesh_apply_time_budget("r_block_world_mesh_apply_time_budget", 0, "2", "Milliseconds per frame to spend applying completed chunk meshes, 0 for no limit", "float:0-100");
     CVar r_block_world_max_sections_per_frame("r_block_world_max_sections_per_frame", 0, "1", "Maximum number of sections to load/generate per frame", "uint:1-256");
     CVar r_block_world_occlusion("r_block_world_occlusion", 0, "1", "Use occlusion queries for block terrain chunks", "bool");
     CVar r_block_world_show_lods("r_block_world_show_lods", 0, "0", "Show lod via colours", "bool");
     CVar r_block_world_use_lightmaps("r_block_world_use_lightmaps", 0, "false", "Use lightmaps instead of dynamic lighting", "bool");
+    CVar r_block_world_packed_vertices("r_block_world_packed_vertices", 0, "true", "Use the compact vertex format for chunk meshes, requires SM4", "bool");
+    CVar r_block_world_ray_cast_batch_size("r_block_world_ray_cast_batch_size", 0, "64", "Number of rays cast by each job when casting rays in batches", "uint:1-4096");
+    CVar r_block_world_parallel_generation("r_block_world_parallel_generation", CVAR_FLAG_REQUIRE_MAP_RESTART, "true", "Generate new sections a chunk column at a time on the job system, when the generator supports it", "bool");
+    CVar r_block_world_parallel_lighting("r_block_world_parallel_lighting", CVAR_FLAG_REQUIRE_MAP_RESTART, "true", "Propagate block lighting changes on the job system between frames", "bool");
 }
 
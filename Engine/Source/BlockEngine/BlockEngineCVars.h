@@ -9,8 +9,14 @@ namespace CVars
     extern CVar r_block_world_chunk_remove_delay;
     extern CVar r_block_world_parallel_chunk_build;
     extern CVar r_block_world_max_chunks_per_frame;
+    extern CVar r_block_world_max_meshing_jobs;
+    extern CVar r_block_world_mesh_apply_time_budget;
     extern CVar r_block_world_max_sections_per_frame;
     extern CVar r_block_world_occlusion;
     extern CVar r_block_world_show_lods;
     extern CVar r_block_world_use_lightmaps;
+    extern CVar r_block_world_packed_vertices;
+    extern CVar r_block_world_ray_cast_batch_size;
+    extern CVar r_block_world_parallel_generation;
+    extern CVar r_block_world_parallel_lighting;
 }
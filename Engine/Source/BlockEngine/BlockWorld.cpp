@@ -6,14 +6,17 @@
 #include "BlockEngine/BlockWorldMesher.h"
 #include "BlockEngine/BlockEngineCVars.h"
 #include "BlockEngine/BlockWorldGenerator.h"
+#include "BlockEngine/BlockWorldLighting.h"
 #include "BlockEngine/BlockDrawTemplate.h"
 #include "Engine/ResourceManager.h"
 #include "Engine/Entity.h"
 #include "Engine/Engine.h"
+#include "Engine/JobSystem.h"
 #include "Engine/Physics/PhysicsWorld.h"
 #include "Engine/Physics/StaticObject.h"
 #include "Engine/Physics/RigidBody.h"
 #include "Engine/Physics/BoxCollisionShape.h"
+#include "Engine/Profiling.h"
 #include "Renderer/RenderWorld.h"
 #include "Core/FIFVolume.h"
 Log_SetChannel(BlockWorld);
@@ -41,9 +44,22 @@ BlockWorld::BlockWorld()
       m_sectionCount(0),
       m_ppSections(nullptr),
       m_chunksMeshingInProgress(0),
+      m_pMeshDataCopyJobCounter(new JobCounter()),
+      m_pMeshingJobCounter(new JobCounter()),
+      m_parallelMeshing(CVars::r_block_world_parallel_chunk_build.GetBool()),
+      m_pLighting(new BlockWorldLighting(this)),
+      m_parallelLighting(CVars::r_block_world_parallel_lighting.GetBool()),
+      m_parallelGeneration(CVars::r_block_world_parallel_generation.GetBool()),
       m_pGenerator(nullptr)
 {
+    Y_memzero(&m_storageStats, sizeof(m_storageStats));
 
+    // without parallel building the meshing is done inline
+#ifdef Y_PLATFORM_HTML5
+    m_parallelMeshing = false;
+    m_parallelLighting = false;
+    m_parallelGeneration = false;
+#endif
 }
 
 BlockWorld::~BlockWorld()
@@ -64,14 +80,39 @@ BlockWorld::~BlockWorld()
         // todo: set block if it's still being animated?
     }
 
+    // let the meshing jobs finish what they are working on, and discard the results
+    g_pEngine->GetJobSystem()->WaitFor(m_pMeshDataCopyJobCounter);
+    g_pEngine->GetJobSystem()->WaitFor(m_pMeshingJobCounter);
+    m_pMeshDataCopyJobCounter->Release();
+    m_pMeshingJobCounter->Release();
+    for (MeshingJob &job : m_meshingJobsToApply)
+    {
+        if (job.pMesher != nullptr)
+            BlockWorldMesher::Free(job.pMesher);
+
+        job.pSection->RemoveChunkPendingMeshing();
+        job.pChunk->SetMeshState(BlockWorldChunk::MeshState_Idle);
+        m_chunksMeshingInProgress--;
+    }
+    m_meshingJobsToApply.Obliterate();
+
+    // the generator may still be in use by columns, wait for them before it goes
+    for (PendingGeneration *pGeneration : m_pendingGenerations)
+    {
+        g_pEngine->GetJobSystem()->WaitFor(pGeneration->pJobCounter);
+        DeletePendingGeneration(pGeneration);
+    }
+    m_pendingGenerations.Obliterate();
+
     delete m_pGenerator;
     SAFE_RELEASE(m_pBlockDrawTemplate);
 
-    // unload sections
+    // unload sections, this finishes any lighting in progress
     UnloadAllSections();
     for (int32 i = 0; i < m_sectionCount; i++)
         delete m_ppSections[i];
     delete[] m_ppSections;
+    delete m_pLighting;
 
     // clean out entities
     while (m_globalEntityReferences.GetSize() > 0)
@@ -1018,6 +1059,9 @@ bool BlockWorld::LoadSection(int32 sectionX, int32 sectionY, int32 lodLevel, boo
 {
     Timer loadTimer;
 
+    // lighting has to finish with the chunks before they can be changed
+    m_pLighting->EndBatch();
+
     // handle section generation
     if (sectionX < m_minSectionX || sectionX > m_maxSectionX || sectionY < m_minSectionY || sectionY > m_maxSectionY ||     // section is out-of-range
         !m_availableSectionMask.TestBit(GetSectionArrayIndex(sectionX, sectionY)))                                            // section is not generated
@@ -1053,6 +1097,14 @@ bool BlockWorld::LoadSection(int32 sectionX, int32 sectionY, int32 lodLevel, boo
         // set to generating state
         pSection->SetLoadState(BlockWorldSection::LoadState_Generating);
 
+        // hand it to the job workers if the generator can work a column at a time, it's integrated in Update when complete
+        if (m_parallelGeneration && m_pGenerator->CanGenerateColumns())
+        {
+            Log_DevPrintf("BlockWorld::LoadSection: Queued generation of section [%i, %i] (block Z range %i - %i)", sectionX, sectionY, minBlockZ, maxBlockZ);
+            QueueSectionGeneration(pSection);
+            return true;
+        }
+
         // log it
         Log_DevPrintf("BlockWorld::LoadSection: Generating section [%i, %i]... (block Z range %i - %i)", sectionX, sectionY, minBlockZ, maxBlockZ);
         if (!m_pGenerator->GenerateBlocks(blockStartX, blockStartY, blockEndX, blockEndY))
@@ -1065,6 +1117,9 @@ bool BlockWorld::LoadSection(int32 sectionX, int32 sectionY, int32 lodLevel, boo
 
         // force a load update
         pSection->SetLoadState(BlockWorldSection::LoadState_Changed);
+
+        // light it from above, the spreading into shade happens with the next lighting batch
+        m_pLighting->InitializeSectionSkyLight(pSection);
         pSection->RebuildLODs(m_lodLevels);
 
         // flag the section as unchanged since it can be regenerated quite easily... this will screw with lods forcing a regen if it changed among other things...
@@ -1103,8 +1158,8 @@ bool BlockWorld::LoadSection(int32 sectionX, int32 sectionY, int32 lodLevel, boo
                 }
             });
 
-            // save the section if it's changed and we're going from lod0
-            if (pSection->IsChanged() && pSection->GetLoadedLODLevel() == 0)
+            // save the section if it's changed and we're going from lod0, generating sections have nothing to save yet
+            if (pSection->GetLoadState() == BlockWorldSection::LoadState_Changed && pSection->GetLoadedLODLevel() == 0)
             {
                 if (!SaveSection(pSection))
                     Log_WarningPrintf("BlockWorld::LoadSection: SaveSection(%i, %i) failed, changes to this section are now lost", sectionX, sectionY);
@@ -1168,11 +1223,24 @@ void BlockWorld::UnloadSection(int32 sectionX, int32 sectionY)
     if (m_ppSections[arrayIndex] == nullptr)
         return;
 
+    // lighting may be working on its chunks
+    m_pLighting->EndBatch();
+
     // load index
     BlockWorldSection *pSection = m_ppSections[arrayIndex];
     int32 loadedSectionIndex = m_loadedSections.IndexOf(pSection);
     DebugAssert(loadedSectionIndex >= 0);
 
+    // a section that is still generating is thrown away, and generated again when it next comes into range
+    if (pSection->GetLoadState() == BlockWorldSection::LoadState_Generating)
+    {
+        DeleteSection(sectionX, sectionY);
+        if (!SaveIndex())
+            Log_WarningPrintf("BlockWorld::UnloadSection: Failed to save index after discarding section [%i, %i]", sectionX, sectionY);
+
+        return;
+    }
+
     // save changes to the section
     if (pSection->GetLoadedLODLevel() == 0 && pSection->IsChanged() && !SaveSection(sectionX, sectionY))
         Log_WarningPrintf("BlockWorld::UnloadSection: SaveSection(%i, %i) failed, changes to this section are now lost", sectionX, sectionY);
@@ -1243,6 +1311,10 @@ void BlockWorld::DeleteSection(int32 sectionX, int32 sectionY)
     BlockWorldSection *pSection = m_ppSections[arrayIndex];
     if (pSection != nullptr)
     {
+        // lighting may be working on its chunks, and the job workers may be generating it
+        m_pLighting->EndBatch();
+        CancelSectionGeneration(pSection);
+
         // kill any pending meshing
         for (uint32 i = 0; i < m_pendingChunks.GetSize();)
         {
@@ -1258,6 +1330,10 @@ void BlockWorld::DeleteSection(int32 sectionX, int32 sectionY)
         }
 
         // unload section
+        int32 loadedSectionIndex = m_loadedSections.IndexOf(pSection);
+        if (loadedSectionIndex >= 0)
+            m_loadedSections.FastRemove(loadedSectionIndex);
+
         delete pSection;
         m_ppSections[arrayIndex] = nullptr;
     }
@@ -1266,6 +1342,167 @@ void BlockWorld::DeleteSection(int32 sectionX, int32 sectionY)
     m_availableSectionMask.UnsetBit(arrayIndex);
 }
 
+struct BlockWorld::PendingGeneration
+{
+    BlockWorldSection *pSection;
+    JobCounter *pJobCounter;
+    PODArray<BlockWorldGeneratorColumn *> Columns;
+    std::atomic<uint32> FailedColumnCount;
+    Timer GenerationTimer;
+};
+
+void BlockWorld::QueueSectionGeneration(BlockWorldSection *pSection)
+{
+    PendingGeneration *pGeneration = new PendingGeneration();
+    pGeneration->pSection = pSection;
+    pGeneration->pJobCounter = new JobCounter();
+    pGeneration->FailedColumnCount.store(0);
+    pGeneration->Columns.Resize(m_sectionSize * m_sectionSize);
+    for (uint32 i = 0; i < pGeneration->Columns.GetSize(); i++)
+        pGeneration->Columns[i] = nullptr;
+
+    m_pendingGenerations.Add(pGeneration);
+
+    // a job per column of chunks, each one only touches its own column
+    int32 baseChunkX = pSection->GetSectionX() * m_sectionSize;
+    int32 baseChunkY = pSection->GetSectionY() * m_sectionSize;
+    int32 minChunkZ = pSection->GetMinChunkZ();
+    int32 maxChunkZ = pSection->GetMaxChunkZ();
+    for (int32 chunkY = 0; chunkY < m_sectionSize; chunkY++)
+    {
+        for (int32 chunkX = 0; chunkX < m_sectionSize; chunkX++)
+        {
+            BlockWorldGeneratorColumn **ppColumn = &pGeneration->Columns[chunkY * m_sectionSize + chunkX];
+            int32 columnChunkX = baseChunkX + chunkX;
+            int32 columnChunkY = baseChunkY + chunkY;
+            g_pEngine->GetJobSystem()->Run([this, pGeneration, ppColumn, columnChunkX, columnChunkY, minChunkZ, maxChunkZ]()
+            {
+                BlockWorldGeneratorColumn *pColumn = new BlockWorldGeneratorColumn(m_chunkSize, m_lodLevels, columnChunkX, columnChunkY, minChunkZ, maxChunkZ);
+                *ppColumn = pColumn;
+                if (!m_pGenerator->GenerateColumn(pColumn))
+                {
+                    pGeneration->FailedColumnCount.fetch_add(1);
+                    return;
+                }
+
+                // light it from above and build the lods here as well, so the main thread only has to copy it in
+                m_pLighting->InitializeColumnSkyLight(pColumn);
+                pColumn->BuildLODs();
+            }, pGeneration->pJobCounter);
+        }
+    }
+}
+
+void BlockWorld::IntegrateGeneratedSections()
+{
+    // sections whose columns are all done, limited to the same number per frame as are loaded
+    uint32 maxSectionsToIntegrate = CVars::r_block_world_max_sections_per_frame.GetUInt();
+    uint32 sectionsIntegrated = 0;
+    for (uint32 i = 0; i < m_pendingGenerations.GetSize() && sectionsIntegrated < maxSectionsToIntegrate;)
+    {
+        PendingGeneration *pGeneration = m_pendingGenerations[i];
+        if (!pGeneration->pJobCounter->IsComplete())
+        {
+            i++;
+            continue;
+        }
+
+        m_pendingGenerations.FastRemove(i);
+        IntegrateGeneratedSection(pGeneration);
+        DeletePendingGeneration(pGeneration);
+        sectionsIntegrated++;
+    }
+}
+
+void BlockWorld::IntegrateGeneratedSection(PendingGeneration *pGeneration)
+{
+    Timer integrateTimer;
+    BlockWorldSection *pSection = pGeneration->pSection;
+    int32 sectionX = pSection->GetSectionX();
+    int32 sectionY = pSection->GetSectionY();
+    if (pGeneration->FailedColumnCount.load() != 0)
+    {
+        Log_ErrorPrintf("BlockWorld::IntegrateGeneratedSection: Failed to generate %u columns of section [%i, %i]. Deleting section.", pGeneration->FailedColumnCount.load(), sectionX, sectionY);
+        DeleteSection(sectionX, sectionY);
+        if (!SaveIndex())
+            Log_WarningPrintf("BlockWorld::IntegrateGeneratedSection: Failed to save index after deleting section [%i, %i]", sectionX, sectionY);
+
+        return;
+    }
+
+    // lighting has to finish with the chunks before they can be changed
+    m_pLighting->EndBatch();
+
+    // copy in every chunk that has something in it
+    for (int32 chunkY = 0; chunkY < m_sectionSize; chunkY++)
+    {
+        for (int32 chunkX = 0; chunkX < m_sectionSize; chunkX++)
+        {
+            const BlockWorldGeneratorColumn *pColumn = pGeneration->Columns[chunkY * m_sectionSize + chunkX];
+            for (int32 chunkZ = pColumn->GetMinChunkZ(); chunkZ <= pColumn->GetMaxChunkZ(); chunkZ++)
+            {
+                if (pColumn->GetChunkSolidBlockCount(0, chunkZ) == 0)
+                    continue;
+
+                // edits are refused while the section is generating, so it has no chunks of its own yet
+                DebugAssert(!pSection->GetChunkAvailability(chunkX, chunkY, chunkZ));
+                BlockWorldChunk *pChunk = pSection->CreateChunk(chunkX, chunkY, chunkZ);
+                if (pChunk == nullptr)
+                    continue;
+
+                for (int32 lodLevel = 0; lodLevel < m_lodLevels; lodLevel++)
+                    pChunk->SetBlocks(lodLevel, pColumn->GetChunkBlockValues(lodLevel, chunkZ), pColumn->GetChunkBlockData(lodLevel, chunkZ), pColumn->GetChunkSolidBlockCount(lodLevel, chunkZ));
+
+                // the coarser lods won't change again until something is edited
+                pChunk->PackLODs();
+                OnChunkLoaded(pSection, pChunk);
+            }
+        }
+    }
+
+    // force a load update, the sky light spreads into shade with the next lighting batch
+    pSection->SetLoadState(BlockWorldSection::LoadState_Changed);
+    m_pLighting->QueueSectionSkyLightEdges(pSection);
+    Log_DevPrintf("BlockWorld::IntegrateGeneratedSection: Generated section [%i, %i] in %.3f ms, integrated in %.3f ms", sectionX, sectionY, pGeneration->GenerationTimer.GetTimeMilliseconds(), integrateTimer.GetTimeMilliseconds());
+}
+
+bool BlockWorld::IsSectionGenerationQueued(const BlockWorldSection *pSection) const
+{
+    for (uint32 i = 0; i < m_pendingGenerations.GetSize(); i++)
+    {
+        if (m_pendingGenerations[i]->pSection == pSection)
+            return true;
+    }
+
+    return false;
+}
+
+void BlockWorld::CancelSectionGeneration(BlockWorldSection *pSection)
+{
+    for (uint32 i = 0; i < m_pendingGenerations.GetSize(); i++)
+    {
+        PendingGeneration *pGeneration = m_pendingGenerations[i];
+        if (pGeneration->pSection != pSection)
+            continue;
+
+        // the columns can't be stopped part way through, so wait for them and throw the results away
+        g_pEngine->GetJobSystem()->WaitFor(pGeneration->pJobCounter);
+        m_pendingGenerations.FastRemove(i);
+        DeletePendingGeneration(pGeneration);
+        return;
+    }
+}
+
+void BlockWorld::DeletePendingGeneration(PendingGeneration *pGeneration)
+{
+    DebugAssert(pGeneration->pJobCounter->IsComplete());
+    for (BlockWorldGeneratorColumn *pColumn : pGeneration->Columns)
+        delete pColumn;
+
+    pGeneration->pJobCounter->Release();
+    delete pGeneration;
+}
+
 bool BlockWorld::SaveSection(int32 sectionX, int32 sectionY)
 {
     // get section
@@ -1281,6 +1518,9 @@ bool BlockWorld::SaveSection(BlockWorldSection *pSection)
     Log_DevPrintf("Saving section %i,%i", pSection->GetSectionX(), pSection->GetSectionY());
     DebugAssert(pSection->GetLoadState() == BlockWorldSection::LoadState_Changed);
 
+    // don't write out light values that are still being changed
+    m_pLighting->EndBatch();
+
     // open file
     ByteStream *pStream = OpenWorldFile(SmallString::FromFormat("%i_%i.section", pSection->GetSectionX(), pSection->GetSectionY()), BYTESTREAM_OPEN_CREATE | BYTESTREAM_OPEN_CREATE_PATH | BYTESTREAM_OPEN_WRITE | BYTESTREAM_OPEN_STREAMED | BYTESTREAM_OPEN_TRUNCATE | BYTESTREAM_OPEN_ATOMIC_UPDATE);
     if (pStream == nullptr)
@@ -1358,7 +1598,8 @@ bool BlockWorld::SaveChangedSections()
 {
     for (BlockWorldSection *pSection : m_loadedSections)
     {
-        if (pSection->IsChanged())
+        // sections that are still generating are saved once they're integrated
+        if (pSection->GetLoadState() == BlockWorldSection::LoadState_Changed)
         {
             if (!SaveSection(pSection->GetSectionX(), pSection->GetSectionY()))
                 return false;
@@ -1370,6 +1611,9 @@ bool BlockWorld::SaveChangedSections()
 
 BlockWorldChunk *BlockWorld::CreateChunk(int32 chunkX, int32 chunkY, int32 chunkZ)
 {
+    // lighting may be working on the section's chunks
+    m_pLighting->EndBatch();
+
     int32 sectionX, sectionY;
     int32 relativeChunkX, relativeChunkY, relativeChunkZ;
     CalculateRelativeChunkCoordinates(&sectionX, &sectionY, &relativeChunkX, &relativeChunkY, &relativeChunkZ, chunkX, chunkY, chunkZ);
@@ -1392,17 +1636,25 @@ BlockWorldChunk *BlockWorld::CreateChunk(int32 chunkX, int32 chunkY, int32 chunk
         }
     }
 
+    // the generated chunks would replace anything created here, so wait for them
+    if (IsSectionGenerationQueued(pSection))
+        return nullptr;
+
     DebugAssert(!pSection->GetChunkAvailability(relativeChunkX, relativeChunkY, relativeChunkZ));
     BlockWorldChunk *pChunk = pSection->CreateChunk(relativeChunkX, relativeChunkY, relativeChunkZ);
     if (pChunk == nullptr)
         return nullptr;
 
     OnChunkLoaded(pSection, pChunk);
+    m_pLighting->InitializeChunkSkyLight(pChunk);
     return pChunk;
 }
 
 BlockWorldChunk *BlockWorld::GetWritableChunk(int32 chunkX, int32 chunkY, int32 chunkZ, bool allowCreate /* = true */)
 {
+    // lighting reads the block values
+    m_pLighting->EndBatch();
+
     int32 sectionX, sectionY;
     int32 relativeChunkX, relativeChunkY, relativeChunkZ;
     CalculateRelativeChunkCoordinates(&sectionX, &sectionY, &relativeChunkX, &relativeChunkY, &relativeChunkZ, chunkX, chunkY, chunkZ);
@@ -1425,6 +1677,10 @@ BlockWorldChunk *BlockWorld::GetWritableChunk(int32 chunkX, int32 chunkY, int32
         }
     }
 
+    // edits can't be made until the generated chunks are in, they would be lost
+    if (IsSectionGenerationQueued(pSection))
+        return nullptr;
+
     if (!pSection->GetChunkAvailability(relativeChunkX, relativeChunkY, relativeChunkZ))
     {
         if (!allowCreate)
@@ -1435,6 +1691,7 @@ BlockWorldChunk *BlockWorld::GetWritableChunk(int32 chunkX, int32 chunkY, int32
             return nullptr;
 
         OnChunkLoaded(pSection, pChunk);
+        m_pLighting->InitializeChunkSkyLight(pChunk);
         return pChunk;
     }
     else
@@ -1449,6 +1706,12 @@ void BlockWorld::OnChunkLoaded(BlockWorldSection *pSection, BlockWorldChunk *pCh
     m_pPhysicsWorld->AddObject(pChunk->GetCollisionObject());
 }
 
+void BlockWorld::OnChunkStorageChanged(int32 chunkCountDelta, int64 storageBytesDelta)
+{
+    m_storageStats.LoadedChunkCount = (uint32)((int32)m_storageStats.LoadedChunkCount + chunkCountDelta);
+    m_storageStats.BlockStorageBytes = (uint64)((int64)m_storageStats.BlockStorageBytes + storageBytesDelta);
+}
+
 void BlockWorld::OnChunkUnloaded(BlockWorldSection *pSection, BlockWorldChunk *pChunk)
 {
     DebugAssert(pChunk->GetMeshState() != BlockWorldChunk::MeshState_InProgress);
@@ -1511,6 +1774,9 @@ bool BlockWorld::SetBlockType(int32 bx, int32 by, int32 bz, BlockWorldBlockType
     int32 localX, localY, localZ;
     SplitCoordinates(&chunkX, &chunkY, &chunkZ, &localX, &localY, &localZ, bx, by, bz);
 
+    // lighting reads the block values
+    m_pLighting->EndBatch();
+
     // find chunk
     BlockWorldChunk *pChunk = GetWritableChunk(chunkX, chunkY, chunkZ, (createNonExistantChunks && blockType != 0));
     if (pChunk == nullptr)
@@ -1542,16 +1808,18 @@ bool BlockWorld::SetBlockType(int32 bx, int32 by, int32 bz, BlockWorldBlockType
             OnEdgeBlockChanged(pChunk, localX, localY, localZ);
     }
 
-    // if the old block value was an emitter, unspread it's light
-    if ((pOldBlockType != nullptr && (pOldBlockType->Flags & BLOCK_MESH_BLOCK_TYPE_FLAG_BLOCK_LIGHT_EMITTER)) ||
-        (IsLightBlockingBlockValue(blockType) && pChunk->GetBlockLight(0, localX, localY, localZ) > 0))
-    {
-        UnspreadBlockLighting(pChunk, localX, localY, localZ);
-    }
-
-    // if the new block type is an emitter, spread it's light
+    // queue the lighting changes, these are applied with the next batch. generated sections get their sky light when complete.
+    bool generating = (pChunk->GetSection()->GetLoadState() == BlockWorldSection::LoadState_Generating);
+    bool oldBlockLightBlocking = IsLightBlockingBlockValue(oldBlockValue);
+    bool newBlockLightBlocking = IsLightBlockingBlockValue(blockType);
+    if ((pOldBlockType != nullptr && (pOldBlockType->Flags & BLOCK_MESH_BLOCK_TYPE_FLAG_BLOCK_LIGHT_EMITTER)) || (newBlockLightBlocking && !oldBlockLightBlocking))
+        m_pLighting->QueueRemoveLight(bx, by, bz, BLOCK_WORLD_LIGHT_CHANNEL_BLOCK);
+    if (newBlockLightBlocking && !oldBlockLightBlocking && !generating)
+        m_pLighting->QueueRemoveLight(bx, by, bz, BLOCK_WORLD_LIGHT_CHANNEL_SKY);
+    if (oldBlockLightBlocking && !newBlockLightBlocking && !generating)
+        m_pLighting->QueueOpenBlock(bx, by, bz);
     if (pNewBlockType != nullptr && (pNewBlockType->Flags & BLOCK_MESH_BLOCK_TYPE_FLAG_BLOCK_LIGHT_EMITTER))
-        SpreadBlockLighting(pChunk, localX, localY, localZ, (uint8)pNewBlockType->BlockLightEmitterSettings.Radius);
+        m_pLighting->QueueAddLight(bx, by, bz, BLOCK_WORLD_LIGHT_CHANNEL_BLOCK, (uint8)pNewBlockType->BlockLightEmitterSettings.Radius);
 
     // changing from an empty block to a solid block
     bool oldBlockSolid = (oldBlockValue != 0) ? ((pOldBlockType != nullptr) ? ((pOldBlockType->Flags & BLOCK_MESH_BLOCK_TYPE_FLAG_COLLIDABLE) != 0) : true) : false;
@@ -1611,8 +1879,37 @@ void BlockWorld::OnBlockChanged(BlockWorldChunk *pChunk, int32 lx, int32 ly, int
         QueueSingleChunkForMeshing(pChunk, pChunk->GetRenderLODLevel());
 }
 
+void BlockWorld::OnChunkLightingChanged(BlockWorldChunk *pChunk, uint32 edgeMask)
+{
+    static const int32 edgeOffsets[CUBE_FACE_COUNT][3] = { { 1, 0, 0 }, { -1, 0, 0 }, { 0, 1, 0 }, { 0, -1, 0 }, { 0, 0, 1 }, { 0, 0, -1 } };
+
+    // the light values are saved with the section, and averaged into the lower lods. only a loaded section is flagged,
+    // a section that is still generating has to stay in that state until its blocks are in.
+    BlockWorldSection *pSection = pChunk->GetSection();
+    if (pSection->GetLoadState() == BlockWorldSection::LoadState_Loaded)
+        pSection->SetLoadState(BlockWorldSection::LoadState_Changed);
+    pSection->RebuildLODsForChunk(pChunk->GetRelativeChunkX(), pChunk->GetRelativeChunkY(), pChunk->GetRelativeChunkZ());
+
+    if (pChunk->GetMeshState() != BlockWorldChunk::MeshState_Pending && pChunk->GetRenderLODLevel() != m_lodLevels)
+        QueueSingleChunkForMeshing(pChunk, pChunk->GetRenderLODLevel());
+
+    // faces on the edge are lit by the neighbouring chunk's blocks
+    for (uint32 face = 0; face < CUBE_FACE_COUNT; face++)
+    {
+        if (!(edgeMask & (1 << face)))
+            continue;
+
+        BlockWorldChunk *pNeighbourChunk = GetChunk(pChunk->GetGlobalChunkX() + edgeOffsets[face][0], pChunk->GetGlobalChunkY() + edgeOffsets[face][1], pChunk->GetGlobalChunkZ() + edgeOffsets[face][2]);
+        if (pNeighbourChunk != nullptr && pNeighbourChunk->GetRenderLODLevel() != m_lodLevels && pNeighbourChunk->GetMeshState() != BlockWorldChunk::MeshState_Pending)
+            QueueSingleChunkForMeshing(pNeighbourChunk, pNeighbourChunk->GetRenderLODLevel());
+    }
+}
+
 bool BlockWorld::SetBlockBit(int32 x, int32 y, int32 z, BlockWorldBlockType bit)
 {
+    // lighting reads the block values
+    m_pLighting->EndBatch();
+
     // determine chunks
     int32 sx, sy;
     int32 lcx, lcy, lcz;
@@ -1643,6 +1940,9 @@ bool BlockWorld::SetBlockBit(int32 x, int32 y, int32 z, BlockWorldBlockType bit)
 
 bool BlockWorld::ClearBlockBit(int32 x, int32 y, int32 z, BlockWorldBlockType bit)
 {
+    // lighting reads the block values
+    m_pLighting->EndBatch();
+
     // determine chunks
     int32 sx, sy;
     int32 lcx, lcy, lcz;
@@ -1851,6 +2151,13 @@ void BlockWorld::StreamSections(float timeSinceLastUpdate)
         // is the current lod correct?
         if (pSection->GetLoadedLODLevel() != sectionLODLevel)
         {
+            // a section still being generated can only be dropped until it is complete
+            if (pSection->GetLoadState() == BlockWorldSection::LoadState_Generating && sectionLODLevel != m_lodLevels)
+            {
+                loadedSectionIndex++;
+                continue;
+            }
+
             // if we are currently meshing and the new lod is lower (higher numerically), we can't do anything yet
             if (sectionLODLevel > pSection->GetLoadedLODLevel() && pSection->GetChunksPendingMeshing() != 0)
             {
@@ -2078,8 +2385,16 @@ void BlockWorld::QueueSingleChunkForMeshing(BlockWorldChunk *pChunk, int32 lodLe
     }
     else if (pChunk->GetMeshState() == BlockWorldChunk::MeshState_InProgress)
     {
-        // in progress in background, switch the state and bail
+        // in progress in background, switch the state and bail. the job is cancelled if it has not started yet,
+        // and the chunk is re-queued at this lod level when the job completes.
         pChunk->SetMeshState(BlockWorldChunk::MeshState_InProgressWithChanges);
+        pChunk->SetRenderLODLevel(lodLevel);
+        return;
+    }
+    else if (pChunk->GetMeshState() == BlockWorldChunk::MeshState_InProgressWithChanges)
+    {
+        // already going to be re-queued
+        pChunk->SetRenderLODLevel(lodLevel);
         return;
     }
 
@@ -2132,109 +2447,140 @@ void BlockWorld::MeshSingleChunk(BlockWorldSection *pSection, BlockWorldChunk *p
     pChunk->SetMeshState(BlockWorldChunk::MeshState_InProgress);
     m_chunksMeshingInProgress++;
 
-    // grab the data from the chunk and adjacent chunks
-    QUEUE_ASYNC_LAMBDA_COMMAND([this, pSection, pChunk, lodLevel]()
+    if (!m_parallelMeshing)
     {
-        BlockWorldMesher *pBuilder = BlockWorldChunkRenderProxy::CreateMesher(this, pSection, pChunk, lodLevel);
+        BlockWorldMesher *pMesher = BlockWorldChunkRenderProxy::CreateMesher(this, pSection, pChunk, lodLevel);
+        RunMeshingJob(pSection, pChunk, pMesher, lodLevel, (pChunk->GetRenderProxy() == nullptr));
+        return;
+    }
 
-        // if this chunk is new, we can push it to the background
-        if (pChunk->GetRenderProxy() == nullptr)
+    // grab the data from the chunk and adjacent chunks, this has to happen while the world isn't being modified,
+    // so UpdateAsync waits on the copy counter before returning
+    JobSystem *pJobSystem = g_pEngine->GetJobSystem();
+    pJobSystem->Run([this, pJobSystem, pSection, pChunk, lodLevel]()
+    {
+        BlockWorldMesher *pMesher = BlockWorldChunkRenderProxy::CreateMesher(this, pSection, pChunk, lodLevel);
+        bool isNewChunk = (pChunk->GetRenderProxy() == nullptr);
+
+        // the mesh job goes on this worker's deque, so it is likely to run here while the copied data is still in cache
+        pJobSystem->Run([this, pSection, pChunk, pMesher, lodLevel, isNewChunk]()
         {
-            // kick off the mesh operation in background
-            QUEUE_BACKGROUND_LAMBDA_COMMAND([this, pSection, pChunk, lodLevel, pBuilder]()
-            {
-                Timer meshTimer;
+            RunMeshingJob(pSection, pChunk, pMesher, lodLevel, isNewChunk);
+        }, m_pMeshingJobCounter);
+    }, m_pMeshDataCopyJobCounter);
+}
 
-                // mesh away
-                pBuilder->GenerateMesh();
-                if (meshTimer.GetTimeMilliseconds() > 30.0f)
-                    Log_PerfPrintf("Background meshing of chunk %i/%i/%i lod %u took %.4fms", pChunk->GetGlobalChunkX(), pChunk->GetGlobalChunkY(), pChunk->GetGlobalChunkZ(), lodLevel, meshTimer.GetTimeMilliseconds());
+void BlockWorld::RunMeshingJob(BlockWorldSection *pSection, BlockWorldChunk *pChunk, BlockWorldMesher *pMesher, int32 lodLevel, bool isNewChunk)
+{
+    MeshingJob job;
+    job.pSection = pSection;
+    job.pChunk = pChunk;
+    job.pMesher = pMesher;
+    job.LODLevel = lodLevel;
+    job.IsNewChunk = isNewChunk;
+    job.Cancelled = false;
 
-                // anything generated?
-                if (pBuilder->GetOutputBatchCount() == 0 && pBuilder->GetOutputLightCount() == 0 && pBuilder->GetOutputMeshInstancesCount() == 0)
-                {
-                    // wipe out the builder
-                    delete pBuilder;
-                }
-                else
-                {
-                    // create the render proxy and bring it into the world
-                    BlockWorldChunkRenderProxy *pRenderProxy = nullptr;
-                    pRenderProxy = BlockWorldChunkRenderProxy::CreateForChunk(0, this, pSection, pChunk, lodLevel, pBuilder);
-                    pChunk->SetRenderProxy(pRenderProxy);
-                    m_pRenderWorld->AddRenderable(pRenderProxy);
-                }
+    // if the chunk has been changed since the volume was copied, this mesh would be thrown away anyway
+    if (pChunk->GetMeshState() == BlockWorldChunk::MeshState_InProgressWithChanges)
+    {
+        BlockWorldMesher::Free(job.pMesher);
+        job.pMesher = nullptr;
+        job.Cancelled = true;
+    }
+    else
+    {
+        Timer meshTimer;
 
-                // update the state on the main thread
-                QUEUE_MAIN_THREAD_LAMBDA_COMMAND([this, pSection, pChunk, lodLevel]()
-                {
-                    // section has one less chunk outstanding
-                    pSection->RemoveChunkPendingMeshing();
-                    m_chunksMeshingInProgress--;
+        // mesh away, pooled meshers already have output arrays sized for a chunk
+        pMesher->GenerateMesh();
+        if (meshTimer.GetTimeMilliseconds() > 30.0f)
+            Log_PerfPrintf("Meshing of chunk %i/%i/%i lod %u took %.4fms", pChunk->GetGlobalChunkX(), pChunk->GetGlobalChunkY(), pChunk->GetGlobalChunkZ(), lodLevel, meshTimer.GetTimeMilliseconds());
 
-                    // has something re-queued us?
-                    if (pChunk->GetMeshState() == BlockWorldChunk::MeshState_InProgressWithChanges)
-                    {
-                        // queue chunk for meshing
-                        QueueSingleChunkForMeshing(pChunk, lodLevel);
-                    }
-                    else
-                    {
-                        // clear state
-                        pChunk->SetMeshState(BlockWorldChunk::MeshState_Idle);
-                    }
-                });
-            });
-        }
-        else
+        // anything generated?
+        if (pMesher->GetOutputBatchCount() == 0 && pMesher->GetOutputLightCount() == 0 && pMesher->GetOutputMeshInstancesCount() == 0)
         {
-            Timer meshTimer;
+            // wipe out the mesher
+            BlockWorldMesher::Free(job.pMesher);
+            job.pMesher = nullptr;
+        }
+    }
 
-            // mesh away
-            pBuilder->GenerateMesh();
-            if (meshTimer.GetTimeMilliseconds() > 30.0f)
-                Log_PerfPrintf("Async meshing of chunk %i/%i/%i lod %u took %.4fms", pChunk->GetGlobalChunkX(), pChunk->GetGlobalChunkY(), pChunk->GetGlobalChunkZ(), lodLevel, meshTimer.GetTimeMilliseconds());
+    // the render proxy and render world are only touched from the main thread
+    g_pEngine->GetJobSystem()->Run([this, job]()
+    {
+        m_meshingJobsToApply.Add(job);
+    }, m_pMeshingJobCounter, JOB_AFFINITY_MAIN_THREAD);
+}
 
-            // this a re-mesh, so it must be done on the main thread
-            QUEUE_MAIN_THREAD_LAMBDA_COMMAND([this, pSection, pChunk, lodLevel, pBuilder]()
-            {
-                BlockWorldChunkRenderProxy *pRenderProxy = pChunk->GetRenderProxy();
-                DebugAssert(pRenderProxy != nullptr);
+void BlockWorld::ProcessCompletedMeshingJobs()
+{
+    // completed jobs are added to the list by main thread jobs, so no locking is needed
+    if (m_meshingJobsToApply.IsEmpty())
+        return;
 
-                // anything generated?
-                if (pBuilder->GetOutputBatchCount() == 0 && pBuilder->GetOutputLightCount() == 0 && pBuilder->GetOutputMeshInstancesCount() == 0)
-                {
-                    delete pBuilder;
+    float timeBudget = CVars::r_block_world_mesh_apply_time_budget.GetFloat();
+    Timer budgetTimer;
+    uint32 jobIndex = 0;
+    for (; jobIndex < m_meshingJobsToApply.GetSize(); jobIndex++)
+    {
+        // always make progress, even if a single job takes longer than the budget
+        if (jobIndex > 0 && timeBudget > 0.0f && (float)budgetTimer.GetTimeMilliseconds() >= timeBudget)
+            break;
 
-                    // clear render proxy if one exists
-                    m_pRenderWorld->RemoveRenderable(pRenderProxy);
-                    pChunk->SetRenderProxy(nullptr);
-                    pRenderProxy->Release();
-                }
-                else
-                {
-                    // update the mesh on it
-                    pRenderProxy->RebuildForChunk(this, pSection, pChunk, lodLevel, pBuilder);
-                }
+        const MeshingJob &job = m_meshingJobsToApply[jobIndex];
+        BlockWorldChunk *pChunk = job.pChunk;
+        if (!job.Cancelled && job.IsNewChunk)
+        {
+            // bring the chunk into the world, the proxy takes ownership of the mesher
+            DebugAssert(pChunk->GetRenderProxy() == nullptr);
+            if (job.pMesher != nullptr)
+            {
+                BlockWorldChunkRenderProxy *pRenderProxy = BlockWorldChunkRenderProxy::CreateForChunk(0, this, job.pSection, pChunk, job.LODLevel, job.pMesher);
+                pChunk->SetRenderProxy(pRenderProxy);
+                m_pRenderWorld->AddRenderable(pRenderProxy);
+            }
+        }
+        else if (!job.Cancelled)
+        {
+            BlockWorldChunkRenderProxy *pRenderProxy = pChunk->GetRenderProxy();
+            DebugAssert(pRenderProxy != nullptr);
 
-                // section has one less chunk outstanding
-                pSection->RemoveChunkPendingMeshing();
-                m_chunksMeshingInProgress--;
+            // anything generated?
+            if (job.pMesher == nullptr)
+            {
+                // clear render proxy if one exists
+                m_pRenderWorld->RemoveRenderable(pRenderProxy);
+                pChunk->SetRenderProxy(nullptr);
+                pRenderProxy->Release();
+            }
+            else
+            {
+                // update the mesh on it
+                pRenderProxy->RebuildForChunk(this, job.pSection, pChunk, job.LODLevel, job.pMesher);
+            }
+        }
 
-                // has something re-queued us?
-                if (pChunk->GetMeshState() == BlockWorldChunk::MeshState_InProgressWithChanges)
-                {
-                    // queue chunk for meshing
-                    QueueSingleChunkForMeshing(pChunk, lodLevel);
-                }
-                else
-                {
-                    // clear state
-                    pChunk->SetMeshState(BlockWorldChunk::MeshState_Idle);
-                }
-            });
+        // section has one less chunk outstanding
+        job.pSection->RemoveChunkPendingMeshing();
+        m_chunksMeshingInProgress--;
+
+        // has something re-queued us?
+        if (pChunk->GetMeshState() == BlockWorldChunk::MeshState_InProgressWithChanges)
+        {
+            // queue chunk for meshing, at the lod level that was last requested
+            pChunk->SetMeshState(BlockWorldChunk::MeshState_Idle);
+            QueueSingleChunkForMeshing(pChunk, pChunk->GetRenderLODLevel());
         }
-    });
+        else
+        {
+            // clear state
+            pChunk->SetMeshState(BlockWorldChunk::MeshState_Idle);
+        }
+    }
+
+    // anything over budget is left for the next frame
+    if (jobIndex != 0)
+        m_meshingJobsToApply.RemoveRange(0, jobIndex);
 }
 
 void BlockWorld::ProcessPendingMeshChunks()
@@ -2256,38 +2602,22 @@ void BlockWorld::ProcessPendingMeshChunks()
         return;
     }
 
-    // todo: limit this rate
-    //uint32 chunksToMesh = m_pendingMeshChunks.GetSize();
-    //uint32 chunksToMesh = Min(m_pendingChunks.GetSize(), (uint32)1);
+    // the pending list is sorted by distance, so the closest chunks are dispatched first. the number of
+    // chunks started per frame is limited, as is the number in flight, so a large lod transition doesn't
+    // flood the job workers with work that will be out of date by the time it completes.
     uint32 chunksToMesh = CVars::r_block_world_max_chunks_per_frame.GetUInt();
+    uint32 maxChunksInProgress = CVars::r_block_world_max_meshing_jobs.GetUInt();
     uint32 chunksMeshed = 0;
     uint32 pendingChunkIndex = 0;
     for (; pendingChunkIndex < m_pendingChunks.GetSize(); pendingChunkIndex++)
     {
+        if (chunksMeshed == chunksToMesh || m_chunksMeshingInProgress >= maxChunksInProgress)
+            break;
+
         // mesh a chunk!
         PendingMeshingChunk &pmc = m_pendingChunks[pendingChunkIndex];
-        BlockWorldSection *pSection = pmc.pSection;
-
-        // meshing a single chunk
-        BlockWorldChunk *pChunk = pmc.pChunk;
-        int32 lodLevel = pmc.NewLODLevel;
-        /*QUEUE_ASYNC_LAMBDA_COMMAND([this, pSection, pChunk, lodLevel]() {
-            MeshSingleChunk(pSection, pChunk, lodLevel);
-        });*/
-
-        // mesh chunk
-        MeshSingleChunk(pSection, pChunk, lodLevel);
-
-        // remove from list
-        //pSection->RemoveChunkPendingMeshing();
-
+        MeshSingleChunk(pmc.pSection, pmc.pChunk, pmc.NewLODLevel);
         chunksMeshed++;
-        if (chunksMeshed == chunksToMesh)
-        {
-            // this increment is necessary so that the pending entry is removed
-            pendingChunkIndex++;
-            break;
-        }
     }
 
     // remove the chunks that were meshed
@@ -2297,129 +2627,49 @@ void BlockWorld::ProcessPendingMeshChunks()
 
 bool BlockWorld::RayCastBlock(const Ray &ray, int32 *pBlockX, int32 *pBlockY, int32 *pBlockZ, CUBE_FACE *pBlockFace, BlockWorldBlockType *pBlockValue, float *pDistance) const
 {
-    // this is rather crude and can definitely be optimized with an octree to further eliminate tests
-    // also, the current hit distance can be compared against when testing the section, to skip further tests
-
-    // hit information
-    const BlockWorldSection *pHitSection = nullptr;
-    const BlockWorldChunk *pHitChunk = nullptr;
-    int32 hitBlockX = 0, hitBlockY = 0, hitBlockZ = 0;
-    BlockWorldBlockType hitBlockValue = 0;
-    CUBE_FACE hitBlockFace = CUBE_FACE_COUNT;
-    float hitBlockDistance = Y_FLT_INFINITE;
+    BlockWorldRayCastResult result;
+    if (!RayCastBlock(ray, &result))
+        return false;
 
-    // get bounding box of ray
-    AABox rayBoundingBox(ray.GetAABox());
+    *pBlockX = result.BlockX;
+    *pBlockY = result.BlockY;
+    *pBlockZ = result.BlockZ;
+    *pBlockFace = result.BlockFace;
+    *pBlockValue = result.BlockValue;
+    *pDistance = result.Distance;
+    return true;
+}
 
-    // transform to section indices, clamp to actual section range
-    int32 minSectionX = Math::Clamp(Math::Truncate(Math::Floor(rayBoundingBox.GetMinBounds().x / (float)m_sectionSizeInBlocks)), m_minSectionX, m_maxSectionX);
-    int32 minSectionY = Math::Clamp(Math::Truncate(Math::Floor(rayBoundingBox.GetMinBounds().y / (float)m_sectionSizeInBlocks)), m_minSectionY, m_maxSectionY);
-    int32 maxSectionX = Math::Clamp(Math::Truncate(Math::Ceil(rayBoundingBox.GetMaxBounds().x / (float)m_sectionSizeInBlocks)), m_minSectionX, m_maxSectionX);
-    int32 maxSectionY = Math::Clamp(Math::Truncate(Math::Ceil(rayBoundingBox.GetMaxBounds().y / (float)m_sectionSizeInBlocks)), m_minSectionY, m_maxSectionY);
+bool BlockWorld::RayCastBlock(const Ray &ray, BlockWorldRayCastResult *pResult) const
+{
+    // only the horizontal extent of the world is known, vertically the ray runs until its end
+    AABox worldBounds((float)(m_minSectionX * m_sectionSizeInBlocks), (float)(m_minSectionY * m_sectionSizeInBlocks), -Y_FLT_MAX,
+                      (float)((m_maxSectionX + 1) * m_sectionSizeInBlocks), (float)((m_maxSectionY + 1) * m_sectionSizeInBlocks), Y_FLT_MAX);
 
-    // iterate over these sections
-    for (int32 sectionY = minSectionY; sectionY <= maxSectionY; sectionY++)
+    // chunks that aren't loaded at lod 0 are skipped, as are empty ones
+    return BlockWorldRayCast::TraceRay(ray, worldBounds, m_chunkSize, [this](int32 chunkX, int32 chunkY, int32 chunkZ) -> const BlockWorldBlockType *
     {
-        for (int32 sectionX = minSectionX; sectionX <= maxSectionX; sectionX++)
-        {
-            // loaded at lod0? also check if it hits the section
-            const BlockWorldSection *pSection = GetSection(sectionX, sectionY);
-            if (pSection == nullptr || pSection->GetLoadedLODLevel() != 0 || ray.AABoxIntersectionTime(pSection->GetBoundingBox()) >= hitBlockDistance)
-                continue;
-
-            // move the search range into section space
-            float3 rayBoundingBoxMinSectionSpace(rayBoundingBox.GetMinBounds() - pSection->GetBoundingBox().GetMinBounds());
-            float3 rayBoundingBoxMaxSectionSpace(rayBoundingBox.GetMaxBounds() - pSection->GetBoundingBox().GetMinBounds());
-
-            // convert to chunks
-            int32 minChunkX = Math::Clamp(Math::Truncate(Math::Floor(rayBoundingBoxMinSectionSpace.x / (float)m_chunkSize)), 0, m_sectionSize - 1);
-            int32 minChunkY = Math::Clamp(Math::Truncate(Math::Floor(rayBoundingBoxMinSectionSpace.y / (float)m_chunkSize)), 0, m_sectionSize - 1);
-            int32 minChunkZ = Math::Clamp(Math::Truncate(Math::Floor(rayBoundingBoxMinSectionSpace.z / (float)m_chunkSize)), pSection->GetMinChunkZ(), pSection->GetMaxChunkZ());
-            int32 maxChunkX = Math::Clamp(Math::Truncate(Math::Ceil(rayBoundingBoxMaxSectionSpace.x / (float)m_chunkSize)), 0, m_sectionSize - 1);
-            int32 maxChunkY = Math::Clamp(Math::Truncate(Math::Ceil(rayBoundingBoxMaxSectionSpace.y / (float)m_chunkSize)), 0, m_sectionSize - 1);
-            int32 maxChunkZ = Math::Clamp(Math::Truncate(Math::Ceil(rayBoundingBoxMaxSectionSpace.z / (float)m_chunkSize)), pSection->GetMinChunkZ(), pSection->GetMaxChunkZ());
+        const BlockWorldChunk *pChunk = GetChunk(chunkX, chunkY, chunkZ);
+        if (pChunk == nullptr || pChunk->GetLoadedLODLevel() != 0 || pChunk->IsAirChunk(0))
+            return nullptr;
 
-            // iterate through these chunks
-            for (int32 chunkZ = minChunkZ; chunkZ <= maxChunkZ; chunkZ++)
-            {
-                for (int32 chunkY = minChunkY; chunkY <= maxChunkY; chunkY++)
-                {
-                    for (int32 chunkX = minChunkX; chunkX <= maxChunkX; chunkX++)
-                    {
-                        // ensure chunk exists and actually intersects
-                        const BlockWorldChunk *pChunk = pSection->GetChunk(chunkX, chunkY, chunkZ);
-                        if (pChunk == nullptr || ray.AABoxIntersectionTime(pChunk->GetBoundingBox()) >= hitBlockDistance)
-                            continue;
-
-                        // we hit the chunk, so move the search range into chunk space
-                        float3 rayBoundingBoxMinChunkSpace(rayBoundingBox.GetMinBounds() - pChunk->GetBasePosition());
-                        float3 rayBoundingBoxMaxChunkSpace(rayBoundingBox.GetMaxBounds() - pChunk->GetBasePosition());
-
-                        // convert to blocks
-                        int32 minBlockX = Math::Clamp(Math::Truncate(Math::Floor(rayBoundingBoxMinChunkSpace.x)), 0, m_chunkSize - 1);
-                        int32 minBlockY = Math::Clamp(Math::Truncate(Math::Floor(rayBoundingBoxMinChunkSpace.y)), 0, m_chunkSize - 1);
-                        int32 minBlockZ = Math::Clamp(Math::Truncate(Math::Floor(rayBoundingBoxMinChunkSpace.z)), 0, m_chunkSize - 1);
-                        int32 maxBlockX = Math::Clamp(Math::Truncate(Math::Ceil(rayBoundingBoxMaxChunkSpace.x)), 0, m_chunkSize - 1);
-                        int32 maxBlockY = Math::Clamp(Math::Truncate(Math::Ceil(rayBoundingBoxMaxChunkSpace.y)), 0, m_chunkSize - 1);
-                        int32 maxBlockZ = Math::Clamp(Math::Truncate(Math::Ceil(rayBoundingBoxMaxChunkSpace.z)), 0, m_chunkSize - 1);
-
-                        // iterate through blocks
-                        for (int32 blockZ = minBlockZ; blockZ <= maxBlockZ; blockZ++)
-                        {
-                            for (int32 blockY = minBlockY; blockY <= maxBlockY; blockY++)
-                            {
-                                for (int32 blockX = minBlockX; blockX <= maxBlockX; blockX++)
-                                {
-                                    // get block value
-                                    BlockWorldBlockType blockValue = pChunk->GetBlock(0, blockX, blockY, blockZ);
-                                    if (blockValue == 0)
-                                        continue;
-
-                                    // get block coordinates
-                                    float3 blockMinBounds(pChunk->GetBasePosition() + float3((float)blockX, (float)blockY, (float)blockZ));
-                                    float3 blockMaxBounds(blockMinBounds + 1.0f);
-
-                                    // test an intersection :: todo: move this test to local chunk space instead of world space for accuracy?
-                                    float thisBlockHitTime;
-                                    CUBE_FACE thisBlockHitFace;
-                                    if (!ray.AABoxIntersectionTimeFace(blockMinBounds, blockMaxBounds, &thisBlockHitTime, &thisBlockHitFace))
-                                        continue;
-
-                                    // less than current?
-                                    if (thisBlockHitTime < hitBlockDistance)
-                                    {
-                                        pHitSection = pSection;
-                                        pHitChunk = pChunk;
-                                        hitBlockX = blockX;
-                                        hitBlockY = blockY;
-                                        hitBlockZ = blockZ;
-                                        hitBlockValue = blockValue;
-                                        hitBlockFace = thisBlockHitFace;
-                                        hitBlockDistance = thisBlockHitTime;
-                                    }
-                                }
-                            }
-                        }
-                    }
-                }
-            }
-        }
-    }
+        return pChunk->GetBlockValues(0);
+    }, pResult);
+}
 
-    // did we hit anything?
-    if (pHitSection == nullptr)
-        return false;
+uint32 BlockWorld::RayCastBlocks(const Ray *pRays, uint32 rayCount, BlockWorldRayCastResult *pResults) const
+{
+    // the world is only read, so the rays can be cast on the job workers
+    g_pEngine->GetJobSystem()->ParallelFor(rayCount, CVars::r_block_world_ray_cast_batch_size.GetUInt(), [this, pRays, pResults](uint32 start, uint32 end) {
+        for (uint32 i = start; i < end; i++)
+            RayCastBlock(pRays[i], &pResults[i]);
+    });
 
-    // convert local coordinates to global coordinates
-    ConvertChunkBlockCoordinatesToGlobalCoordinates(m_chunkSize, pHitChunk->GetGlobalChunkX(), pHitChunk->GetGlobalChunkY(), pHitChunk->GetGlobalChunkZ(), hitBlockX, hitBlockY, hitBlockZ, pBlockX, pBlockY, pBlockZ);
-    *pBlockFace = hitBlockFace;
-    *pBlockValue = hitBlockValue;
-    *pDistance = hitBlockDistance;
+    uint32 hitCount = 0;
+    for (uint32 i = 0; i < rayCount; i++)
+        hitCount += (pResults[i].Hit) ? 1 : 0;
 
-    int tsx, tsy, tcx, tcy, tcz, tbx, tby, tbz;
-    SplitCoordinates(&tsx, &tsy, &tcx, &tcy, &tcz, &tbx, &tby, &tbz, *pBlockX, *pBlockY, *pBlockZ);
-    DebugAssert(tsx == pHitSection->GetSectionX() && tsy == pHitSection->GetSectionY() && tcx == pHitChunk->GetRelativeChunkX() && tcy == pHitChunk->GetRelativeChunkY() && tcz == pHitChunk->GetRelativeChunkZ() && tbx == hitBlockX && tby == hitBlockY && tbz == hitBlockZ);
-    return true;
+    return hitCount;
 }
 
 void BlockWorld::AddBrush(Brush *pObject)
@@ -2668,13 +2918,18 @@ void BlockWorld::OnUnloadEntity(Entity *pEntity)
 void BlockWorld::BeginFrame(float deltaTime)
 {
     World::BeginFrame(deltaTime);
+
+    // apply last frame's lighting before anything is meshed
+    m_pLighting->EndBatch();
 }
 
 void BlockWorld::UpdateAsync(float deltaTime)
 {
     World::UpdateAsync(deltaTime);
 
+    // the meshing jobs have to finish reading the world before it can be modified, help them out meanwhile
     ProcessPendingMeshChunks();
+    g_pEngine->GetJobSystem()->WaitFor(m_pMeshDataCopyJobCounter);
 }
 
 void BlockWorld::Update(float deltaTime)
@@ -2686,326 +2941,26 @@ void BlockWorld::Update(float deltaTime)
     //UnloadOutOfRangeSections(deltaTime);
     //LoadNewInRangeSections();
     StreamSections(deltaTime);
+    IntegrateGeneratedSections();
+    ProcessCompletedMeshingJobs();
     TransitionLoadedChunkRenderLODs();
     SortPendingMeshChunks();
-}
-
-void BlockWorld::EndFrame()
-{
-    World::EndFrame();
-}
 
-struct BlockLightingUpdateNode
-{
-    inline BlockLightingUpdateNode() {}
-    inline BlockLightingUpdateNode(BlockWorldChunk *pChunk_, int32 x_, int32 y_, int32 z_) : pChunk(pChunk_), x(x_), y(y_), z(z_), level(0) {}
-    inline BlockLightingUpdateNode(BlockWorldChunk *pChunk_, int32 x_, int32 y_, int32 z_, uint8 level_) : pChunk(pChunk_), x(x_), y(y_), z(z_), level(level_) {}
-    inline BlockLightingUpdateNode(const BlockLightingUpdateNode &copy) { Y_memcpy(this, &copy, sizeof(*this)); }
-    inline void Set(BlockWorldChunk *pChunk_, int32 x_, int32 y_, int32 z_) { pChunk = pChunk_; x = x_; y = y_; z = z_; level = 0;  }
-    inline void Set(BlockWorldChunk *pChunk_, int32 x_, int32 y_, int32 z_, uint8 level_) { pChunk = pChunk_; x = x_; y = y_; z = z_; level = level_; }
-
-    BlockWorldChunk *pChunk;
-    int32 x;
-    int32 y;
-    int32 z;
-    uint8 level;
-
-    //////////////////////////////////////////////////////////////////////////
-    inline bool GetLeftNode(BlockWorld *pWorld, BlockLightingUpdateNode *node) const
-    {
-        int32 chunkSizeMinusOne = pWorld->GetChunkSize() - 1;
-        if (x == 0)
-        {
-            BlockWorldChunk *pAdjChunk;
-            if ((pAdjChunk = pWorld->GetWritableChunk(pChunk->GetGlobalChunkX() - 1, pChunk->GetGlobalChunkY(), pChunk->GetGlobalChunkZ(), true)) == nullptr)
-                return false;
+    // the meshing jobs are done reading the world, so the lighting can run until the next frame begins
+    if (m_pLighting->HasQueuedChanges())
+        m_pLighting->BeginBatch(m_parallelLighting);
 
-            node->Set(pAdjChunk, chunkSizeMinusOne, this->y, this->z);
-        }
-        else
-        {
-            node->Set(this->pChunk, this->x - 1, this->y, this->z);
-        }
-
-        return true;
-    }
-
-    inline bool GetRightNode(BlockWorld *pWorld, BlockLightingUpdateNode *node) const
-    {
-        int32 chunkSizeMinusOne = pWorld->GetChunkSize() - 1;
-        if (x == chunkSizeMinusOne)
-        {
-            BlockWorldChunk *pAdjChunk;
-            if ((pAdjChunk = pWorld->GetWritableChunk(pChunk->GetGlobalChunkX() + 1, pChunk->GetGlobalChunkY(), pChunk->GetGlobalChunkZ(), true)) == nullptr)
-                return false;
-
-            node->Set(pAdjChunk, 0, this->y, this->z);
-        }
-        else
-        {
-            node->Set(this->pChunk, this->x + 1, this->y, this->z);
-        }
-
-        return true;
-    }
-
-    inline bool GetBackNode(BlockWorld *pWorld, BlockLightingUpdateNode *node) const
-    {
-        int32 chunkSizeMinusOne = pWorld->GetChunkSize() - 1;
-        if (y == 0)
-        {
-            BlockWorldChunk *pAdjChunk;
-            if ((pAdjChunk = pWorld->GetWritableChunk(pChunk->GetGlobalChunkX(), pChunk->GetGlobalChunkY() - 1, pChunk->GetGlobalChunkZ(), true)) == nullptr)
-                return false;
-
-            node->Set(pAdjChunk, this->x, chunkSizeMinusOne, this->z);
-        }
-        else
-        {
-            node->Set(this->pChunk, this->x, this->y - 1, this->z);
-        }
-
-        return true;
-    }
-
-    inline bool GetFrontNode(BlockWorld *pWorld, BlockLightingUpdateNode *node) const
-    {
-        int32 chunkSizeMinusOne = pWorld->GetChunkSize() - 1;
-        if (y == chunkSizeMinusOne)
-        {
-            BlockWorldChunk *pAdjChunk;
-            if ((pAdjChunk = pWorld->GetWritableChunk(pChunk->GetGlobalChunkX(), pChunk->GetGlobalChunkY() + 1, pChunk->GetGlobalChunkZ(), true)) == nullptr)
-                return false;
-
-            node->Set(pAdjChunk, this->x, 0, this->z);
-        }
-        else
-        {
-            node->Set(this->pChunk, this->x, this->y + 1, this->z);
-        }
-
-        return true;
-    }
-
-    inline bool GetBottomNode(BlockWorld *pWorld, BlockLightingUpdateNode *node) const
-    {
-        int32 chunkSizeMinusOne = pWorld->GetChunkSize() - 1;
-        if (z == 0)
-        {
-            BlockWorldChunk *pAdjChunk;
-            if ((pAdjChunk = pWorld->GetWritableChunk(pChunk->GetGlobalChunkX(), pChunk->GetGlobalChunkY(), pChunk->GetGlobalChunkZ() - 1, true)) == nullptr)
-                return false;
-
-            node->Set(pAdjChunk, this->x, this->y, chunkSizeMinusOne);
-        }
-        else
-        {
-            node->Set(this->pChunk, this->x, this->y, this->z - 1);
-        }
-
-        return true;
-    }
-
-    inline bool GetTopNode(BlockWorld *pWorld, BlockLightingUpdateNode *node) const
-    {
-        int32 chunkSizeMinusOne = pWorld->GetChunkSize() - 1;
-        if (z == chunkSizeMinusOne)
-        {
-            BlockWorldChunk *pAdjChunk;
-            if ((pAdjChunk = pWorld->GetWritableChunk(pChunk->GetGlobalChunkX(), pChunk->GetGlobalChunkY(), pChunk->GetGlobalChunkZ() + 1, true)) == nullptr)
-                return false;
-
-            node->Set(pAdjChunk, this->x, this->y, 0);
-        }
-        else
-        {
-            node->Set(this->pChunk, this->x, this->y, this->z + 1);
-        }
-
-        return true;
-    }
-
-    //////////////////////////////////////////////////////////////////////////
-    inline bool SpreadToNode(BlockWorld *pWorld, uint8 lightLevel)
-    {
-        // light cannot spread to translucent nodes
-        BlockWorldBlockType blockValue = pChunk->GetBlock(0, x, y, z);
-        if (pWorld->IsLightBlockingBlockValue(blockValue))
-            return false;
-
-        // check lightlevel is within threshold
-        uint8 currentLightLevel = pChunk->GetBlockLight(0, x, y, z);
-        if ((currentLightLevel + 2) <= lightLevel)
-        {
-            // update the light level of this node
-            pChunk->SetBlockLight(0, x, y, z, lightLevel - 1);
-            pWorld->OnBlockChanged(pChunk, x, y, z);
-            this->level = lightLevel - 1;
-            //Log_DevPrintf("  -- spread to [%i,%i,%i] %i,%i,%i %u", pChunk->GetGlobalChunkX(), pChunk->GetGlobalChunkY(), pChunk->GetGlobalChunkZ(), x, y, z, level);
-            return true;
-        }
-
-        return false;
-    }
-
-    inline int32 UnspreadFromNode(BlockWorld *pWorld, uint8 lightLevel)
-    {
-        // check lightlevel is within threshold
-        uint8 currentLightLevel = pChunk->GetBlockLight(0, x, y, z);
-        if (currentLightLevel != 0 && currentLightLevel < lightLevel)
-        {
-            // set light level of node to zero, and store the level for future use
-            pChunk->SetBlockLight(0, x, y, z, 0);
-            pWorld->OnBlockChanged(pChunk, x, y, z);
-            this->level = currentLightLevel;
-            return -1;
-        }
-        else if (currentLightLevel >= lightLevel)
-        {
-            this->level = currentLightLevel;
-            return 1;
-        }
-
-        return 0;
-    }
-};
-
-void BlockWorld::SpreadBlockLighting(BlockWorldChunk *pChunk, int32 x, int32 y, int32 z, uint8 lightLevel)
-{
-    //Log_DevPrintf("SPREAD BLOCK LIGHTING: [%i,%i,%i] %i,%i,%i %u", pChunk->GetGlobalChunkX(), pChunk->GetGlobalChunkY(), pChunk->GetGlobalChunkZ(), x, y, z, lightLevel);
-
-    // set light of node
-    pChunk->SetBlockLight(0, x, y, z, lightLevel);
-    OnBlockChanged(pChunk, x, y, z);
-
-    // create queue and push node to it (this is gonna have a lot of memmoves.. use a better container)
-    MemArray<BlockLightingUpdateNode> queue(128);
-    queue.Add(BlockLightingUpdateNode(pChunk, x, y, z, lightLevel));
-
-    // while the queue has elements
-    while (!queue.IsEmpty())
-    {
-        // retrieve the front node from the queue
-        BlockLightingUpdateNode node;
-        queue.PopFront(&node);
-
-        // spread it to each neighbor
-        BlockLightingUpdateNode neighbourNode;
-        if (node.GetLeftNode(this, &neighbourNode) && neighbourNode.SpreadToNode(this, node.level))
-            queue.Add(neighbourNode);
-        if (node.GetRightNode(this, &neighbourNode) && neighbourNode.SpreadToNode(this, node.level))
-            queue.Add(neighbourNode);
-        if (node.GetBackNode(this, &neighbourNode) && neighbourNode.SpreadToNode(this, node.level))
-            queue.Add(neighbourNode);
-        if (node.GetFrontNode(this, &neighbourNode) && neighbourNode.SpreadToNode(this, node.level))
-            queue.Add(neighbourNode);
-        if (node.GetBottomNode(this, &neighbourNode) && neighbourNode.SpreadToNode(this, node.level))
-            queue.Add(neighbourNode);
-        if (node.GetTopNode(this, &neighbourNode) && neighbourNode.SpreadToNode(this, node.level))
-            queue.Add(neighbourNode);                
-    }
+#ifdef WITH_PROFILER
+    MicroProfileCounterSet(MicroProfileGetCounterToken("blockworld/loaded_chunks"), (int64_t)m_storageStats.LoadedChunkCount);
+    MicroProfileCounterSet(MicroProfileGetCounterToken("blockworld/block_storage_bytes"), (int64_t)m_storageStats.BlockStorageBytes);
+    MicroProfileCounterSet(MicroProfileGetCounterToken("blockworld/bytes_per_chunk"), (m_storageStats.LoadedChunkCount > 0) ? (int64_t)(m_storageStats.BlockStorageBytes / m_storageStats.LoadedChunkCount) : 0);
+    MicroProfileCounterSet(MicroProfileGetCounterToken("blockworld/pending_generations"), (int64_t)m_pendingGenerations.GetSize());
+#endif
 }
 
-void BlockWorld::UnspreadBlockLighting(BlockWorldChunk *pChunk, int32 x, int32 y, int32 z)
+void BlockWorld::EndFrame()
 {
-    // create queue and push node to it (this is gonna have a lot of memmoves.. use a better container)
-    MemArray<BlockLightingUpdateNode> removeQueue(128);
-    MemArray<BlockLightingUpdateNode> updateQueue(128);
-    removeQueue.Add(BlockLightingUpdateNode(pChunk, x, y, z, pChunk->GetBlockLight(0, x, y, z)));
-
-    // clear light of node
-    pChunk->SetBlockLight(0, x, y, z, 0);
-    OnBlockChanged(pChunk, x, y, z);
-
-    // while the queue has elements
-    while (!removeQueue.IsEmpty())
-    {
-        // retrieve the front node from the queue
-        BlockLightingUpdateNode node;
-        removeQueue.PopFront(&node);
-
-        // create neighbour node
-        BlockLightingUpdateNode neighbourNode;
-        int32 unspreadResult;
-
-        // spread it to each neighbor
-        if (node.GetLeftNode(this, &neighbourNode))
-        {
-            unspreadResult = neighbourNode.UnspreadFromNode(this, node.level);
-            if (unspreadResult < 0)
-                removeQueue.Add(neighbourNode);
-            else if (unspreadResult > 0)
-                updateQueue.Add(neighbourNode);
-        }
-
-        if (node.GetRightNode(this, &neighbourNode))
-        {
-            unspreadResult = neighbourNode.UnspreadFromNode(this, node.level);
-            if (unspreadResult < 0)
-                removeQueue.Add(neighbourNode);
-            else if (unspreadResult > 0)
-                updateQueue.Add(neighbourNode);
-        }
-
-        if (node.GetBackNode(this, &neighbourNode))
-        {
-            unspreadResult = neighbourNode.UnspreadFromNode(this, node.level);
-            if (unspreadResult < 0)
-                removeQueue.Add(neighbourNode);
-            else if (unspreadResult > 0)
-                updateQueue.Add(neighbourNode);
-        }
-
-        if (node.GetFrontNode(this, &neighbourNode))
-        {
-            unspreadResult = neighbourNode.UnspreadFromNode(this, node.level);
-            if (unspreadResult < 0)
-                removeQueue.Add(neighbourNode);
-            else if (unspreadResult > 0)
-                updateQueue.Add(neighbourNode);
-        }
-
-        if (node.GetBottomNode(this, &neighbourNode))
-        {
-            unspreadResult = neighbourNode.UnspreadFromNode(this, node.level);
-            if (unspreadResult < 0)
-                removeQueue.Add(neighbourNode);
-            else if (unspreadResult > 0)
-                updateQueue.Add(neighbourNode);
-        }
-
-        if (node.GetTopNode(this, &neighbourNode))
-        {
-            unspreadResult = neighbourNode.UnspreadFromNode(this, node.level);
-            if (unspreadResult < 0)
-                removeQueue.Add(neighbourNode);
-            else if (unspreadResult > 0)
-                updateQueue.Add(neighbourNode);
-        }
-    }
-
-    // process remaining propagation nodes
-    while (!updateQueue.IsEmpty())
-    {
-        // retrieve the front node from the queue
-        BlockLightingUpdateNode node;
-        updateQueue.PopFront(&node);
-
-        // spread it to each neighbor
-        BlockLightingUpdateNode neighbourNode;
-        if (node.GetLeftNode(this, &neighbourNode) && neighbourNode.SpreadToNode(this, node.level))
-            updateQueue.Add(neighbourNode);
-        if (node.GetRightNode(this, &neighbourNode) && neighbourNode.SpreadToNode(this, node.level))
-            updateQueue.Add(neighbourNode);
-        if (node.GetBackNode(this, &neighbourNode) && neighbourNode.SpreadToNode(this, node.level))
-            updateQueue.Add(neighbourNode);
-        if (node.GetFrontNode(this, &neighbourNode) && neighbourNode.SpreadToNode(this, node.level))
-            updateQueue.Add(neighbourNode);
-        if (node.GetBottomNode(this, &neighbourNode) && neighbourNode.SpreadToNode(this, node.level))
-            updateQueue.Add(neighbourNode);
-        if (node.GetTopNode(this, &neighbourNode) && neighbourNode.SpreadToNode(this, node.level))
-            updateQueue.Add(neighbourNode);
-    }
+    World::EndFrame();
 }
 
 bool BlockWorld::CreateAnimatedPhysicsBlock(const float3 &basePosition, const Quaternion &rotation, BlockWorldBlockType blockValue, const float3 &forceVector, float despawnTime /*= 5.0f*/)
@@ -3,15 +3,25 @@
 #include "Engine/BlockPalette.h"
 #include "BlockEngine/BlockWorldTypes.h"
 #include "BlockEngine/BlockDrawTemplate.h"
+#include "BlockEngine/BlockWorldMesher.h"
+#include "BlockEngine/BlockWorldRayCast.h"
 
 class BlockWorldSection;
 class BlockWorldChunk;
 class BlockWorldGenerator;
 class BlockDrawTemplate;
 class FIFVolume;
+class JobCounter;
 
 namespace Physics { class RigidBody; }
 
+// block storage held by the loaded chunks
+struct BlockWorldStorageStats
+{
+    uint32 LoadedChunkCount;
+    uint64 BlockStorageBytes;
+};
+
 class BlockWorld : public World
 {
 public:
@@ -105,6 +115,7 @@ public:
 
     // pending chunk count accessor (really block groups when transitioning)
     uint32 GetPendingChunkCount() const { return m_pendingChunks.GetSize(); }
+    uint32 GetPendingGenerationCount() const { return m_pendingGenerations.GetSize(); }
     uint32 GetChunksMeshingInProgress() const { return m_chunksMeshingInProgress; }
     uint32 GetLoadedSectionCount() const { return m_loadedSections.GetSize(); }
 
@@ -148,6 +159,13 @@ public:
     // block-only raycast, this will hit blocks that aren't cubes as well
     bool RayCastBlock(const Ray &ray, int32 *pBlockX, int32 *pBlockY, int32 *pBlockZ, CUBE_FACE *pBlockFace, BlockWorldBlockType *pBlockValue, float *pDistance) const;
     bool RayCastBlock(const float3 &origin, const float3 &direction, float maxDistance, int32 *pBlockX, int32 *pBlockY, int32 *pBlockZ, CUBE_FACE *pBlockFace, BlockWorldBlockType *pBlockValue, float *pDistance) const { return RayCastBlock(Ray(origin, direction, maxDistance), pBlockX, pBlockY, pBlockZ, pBlockFace, pBlockValue, pDistance); }
+    bool RayCastBlock(const Ray &ray, BlockWorldRayCastResult *pResult) const;
+
+    // casts many rays at once, spread across the job system. returns the number of rays that hit a block.
+    uint32 RayCastBlocks(const Ray *pRays, uint32 rayCount, BlockWorldRayCastResult *pResults) const;
+
+    // storage stats
+    const BlockWorldStorageStats &GetStorageStats() const { return m_storageStats; }
 
     // helpers
     static bool IsValidChunkSize(uint32 chunkSize, uint32 sectionSize, uint32 lodCount);
@@ -190,6 +208,17 @@ private:
     bool SaveSection(int32 sectionX, int32 sectionY);
     bool SaveSection(BlockWorldSection *pSection);
 
+    // parallel generation, a new section is filled a column at a time on the job workers, and its chunks are handed to
+    // the world in Update once every column is complete. until then the section is in the generating state and empty,
+    // and chunks in it can't be created or edited.
+    struct PendingGeneration;
+    void QueueSectionGeneration(BlockWorldSection *pSection);
+    bool IsSectionGenerationQueued(const BlockWorldSection *pSection) const;
+    void IntegrateGeneratedSections();
+    void IntegrateGeneratedSection(PendingGeneration *pGeneration);
+    void CancelSectionGeneration(BlockWorldSection *pSection);
+    void DeletePendingGeneration(PendingGeneration *pGeneration);
+
     // call when a section/chunk is created or loaded
     void OnChunkLoaded(BlockWorldSection *pSection, BlockWorldChunk *pChunk);
     void OnChunkUnloaded(BlockWorldSection *pSection, BlockWorldChunk *pChunk);
@@ -227,6 +256,13 @@ private:
     // call once per frame, meshes queued chunks
     void ProcessPendingMeshChunks();
 
+    // runs on the job workers, generates the mesh and queues it to be applied on the main thread
+    void RunMeshingJob(BlockWorldSection *pSection, BlockWorldChunk *pChunk, BlockWorldMesher *pMesher, int32 lodLevel, bool isNewChunk);
+
+    // call once per frame, applies completed meshes
+    void ProcessCompletedMeshingJobs();
+
+
     // chunk creator
     BlockWorldChunk *CreateChunk(int32 chunkX, int32 chunkY, int32 chunkZ);
     BlockWorldChunk *GetWritableChunk(int32 chunkX, int32 chunkY, int32 chunkZ, bool allowCreate = true);
@@ -237,10 +273,13 @@ private:
     bool ClearBlockBit(int32 x, int32 y, int32 z, BlockWorldBlockType bit);
     bool SetBlockBit(int32 x, int32 y, int32 z, BlockWorldBlockType bit);
 
-    // block lighting update helper
-    friend struct BlockLightingUpdateNode;
-    void SpreadBlockLighting(BlockWorldChunk *pChunk, int32 x, int32 y, int32 z, uint8 lightLevel);
-    void UnspreadBlockLighting(BlockWorldChunk *pChunk, int32 x, int32 y, int32 z);
+    // called by the lighting when a batch has changed light values in a chunk, edgeMask has a bit per CUBE_FACE the changes touched
+    friend class BlockWorldLighting;
+    void OnChunkLightingChanged(BlockWorldChunk *pChunk, uint32 edgeMask);
+
+    // called by chunks as they're created, destroyed, or their block storage changes size
+    friend class BlockWorldChunk;
+    void OnChunkStorageChanged(int32 chunkCountDelta, int64 storageBytesDelta);
 
     // so it can access the entity lookup hash table
     friend BlockWorldSection;
@@ -302,6 +341,34 @@ private:
     MemArray<PendingMeshingChunk> m_pendingChunks;
     uint32 m_chunksMeshingInProgress;
 
+    // chunk that has been handed to the meshing jobs
+    struct MeshingJob
+    {
+        BlockWorldSection *pSection;
+        BlockWorldChunk *pChunk;
+        BlockWorldMesher *pMesher;
+        int32 LODLevel;
+        bool IsNewChunk;
+        bool Cancelled;
+    };
+
+    // meshing jobs, the copy counter covers the part that reads the world, the other everything up to the main thread
+    JobCounter *m_pMeshDataCopyJobCounter;
+    JobCounter *m_pMeshingJobCounter;
+    bool m_parallelMeshing;
+    MemArray<MeshingJob> m_meshingJobsToApply;
+
+    // light propagation, batched once per frame
+    BlockWorldLighting *m_pLighting;
+    bool m_parallelLighting;
+
+    // chunk storage accounting
+    BlockWorldStorageStats m_storageStats;
+
+    // sections being generated on the job workers
+    PODArray<PendingGeneration *> m_pendingGenerations;
+    bool m_parallelGeneration;
+
     // generator
     BlockWorldGenerator *m_pGenerator;
 
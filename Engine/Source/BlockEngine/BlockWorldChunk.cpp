@@ -9,6 +9,145 @@
 #include "Renderer/Renderer.h"
 Log_SetChannel(BlockWorldChunk);
 
+// packed keys hold the block value in the high half, and the data in the low half
+static inline uint32 MakePackedKey(BlockWorldBlockType blockValue, BlockWorldBlockDataType blockData)
+{
+    return ((uint32)blockValue << 16) | (uint32)blockData;
+}
+static inline BlockWorldBlockType GetPackedKeyBlockValue(uint32 key)
+{
+    return (BlockWorldBlockType)(key >> 16);
+}
+static inline BlockWorldBlockDataType GetPackedKeyBlockData(uint32 key)
+{
+    return (BlockWorldBlockDataType)(key & 0xFFFF);
+}
+
+// bits per palette index, indices never straddle a word
+static uint32 GetPackedIndexBits(uint32 paletteSize)
+{
+    if (paletteSize <= 1)
+        return 0;
+    else if (paletteSize <= 2)
+        return 1;
+    else if (paletteSize <= 4)
+        return 2;
+    else if (paletteSize <= 16)
+        return 4;
+    else
+        return 8;
+}
+static uint32 GetPackedIndicesPerWordShift(uint32 indexBits)
+{
+    switch (indexBits)
+    {
+    case 1:     return 5;
+    case 2:     return 4;
+    case 4:     return 3;
+    case 8:     return 2;
+    default:    return 0;
+    }
+}
+static uint32 GetPackedIndexWordCount(uint32 blockCount, uint32 indexBits, uint32 indicesPerWordShift)
+{
+    return (indexBits != 0) ? ((blockCount + (1 << indicesPerWordShift) - 1) >> indicesPerWordShift) : 0;
+}
+
+// Maps keys to palette indices while packing. Open addressing over twice the largest palette, the empty marker can't be
+// a real key as the top bits of the block data are never set.
+struct BlockPaletteBuilder
+{
+    static const uint32 MAX_PALETTE_SIZE = 256;
+    static const uint32 TABLE_SIZE = 512;
+    static const uint32 EMPTY_KEY = 0xFFFFFFFF;
+
+    uint32 TableKeys[TABLE_SIZE];
+    uint8 TableIndices[TABLE_SIZE];
+    uint32 Palette[MAX_PALETTE_SIZE];
+    uint32 PaletteSize;
+    uint32 LastKey;
+    uint32 LastIndex;
+
+    BlockPaletteBuilder()
+        : PaletteSize(0),
+          LastKey(EMPTY_KEY),
+          LastIndex(0)
+    {
+        Y_memset(TableKeys, 0xFF, sizeof(TableKeys));
+    }
+
+    // returns the palette index for the key, adding it if it's new, or -1 if the palette is full
+    int32 Lookup(uint32 key)
+    {
+        // neighbouring blocks are usually the same
+        if (key == LastKey)
+            return (int32)LastIndex;
+
+        uint32 slot = (key * 2654435761u) >> 23;
+        for (;;)
+        {
+            if (TableKeys[slot] == key)
+                break;
+
+            if (TableKeys[slot] == EMPTY_KEY)
+            {
+                if (PaletteSize == MAX_PALETTE_SIZE)
+                    return -1;
+
+                TableKeys[slot] = key;
+                TableIndices[slot] = (uint8)PaletteSize;
+                Palette[PaletteSize++] = key;
+                break;
+            }
+
+            slot = (slot + 1) & (TABLE_SIZE - 1);
+        }
+
+        LastKey = key;
+        LastIndex = TableIndices[slot];
+        return (int32)LastIndex;
+    }
+};
+
+// runs read from a section file
+struct StoredRunSource
+{
+    const uint16 *pRunLengths;
+    const uint32 *pRunKeys;
+    uint32 RunCount;
+
+    template<class Callback> void operator()(const Callback &callback) const
+    {
+        for (uint32 i = 0; i < RunCount; i++)
+            callback(pRunKeys[i], (uint32)pRunLengths[i] + 1);
+    }
+};
+
+// runs of the blocks in an unpacked lod
+struct BlockArrayRunSource
+{
+    const BlockWorldBlockType *pBlockValues;
+    const BlockWorldBlockDataType *pBlockData;
+    uint32 BlockCount;
+
+    template<class Callback> void operator()(const Callback &callback) const
+    {
+        uint32 runStart = 0;
+        uint32 runKey = MakePackedKey(pBlockValues[0], pBlockData[0]);
+        for (uint32 i = 1; i < BlockCount; i++)
+        {
+            uint32 key = MakePackedKey(pBlockValues[i], pBlockData[i]);
+            if (key != runKey)
+            {
+                callback(runKey, i - runStart);
+                runStart = i;
+                runKey = key;
+            }
+        }
+        callback(runKey, BlockCount - runStart);
+    }
+};
+
 BlockWorldChunk::BlockWorldChunk(BlockWorldSection *pSection, int32 relativeChunkX, int32 relativeChunkY, int32 relativeChunkZ)
     : m_pSection(pSection),
       m_chunkSize(pSection->GetChunkSize()),
@@ -20,10 +159,13 @@ BlockWorldChunk::BlockWorldChunk(BlockWorldSection *pSection, int32 relativeChun
       m_globalChunkX(pSection->GetBaseChunkX() + relativeChunkX),
       m_globalChunkY(pSection->GetBaseChunkY() + relativeChunkY),
       m_globalChunkZ(relativeChunkZ),
+      m_memoryUsage(0),
       m_pCollisionShape(nullptr),
       m_pCollisionObject(nullptr),
       m_pRenderProxy(nullptr),
-      m_meshState(MeshState_Idle)
+      m_meshState(MeshState_Idle),
+      m_lightingChanged(false),
+      m_lightingChangedEdges(0)
 {
     // calculate base position, or translation
     m_basePosition.Set(static_cast<float>((pSection->GetBaseChunkX() + relativeChunkX) * m_chunkSize),
@@ -37,10 +179,14 @@ BlockWorldChunk::BlockWorldChunk(BlockWorldSection *pSection, int32 relativeChun
     Y_memzero(m_pBlockValues, sizeof(m_pBlockValues));
     Y_memzero(m_pBlockData, sizeof(m_pBlockData));
     Y_memzero(m_zStride, sizeof(m_zStride));
+    Y_memzero(m_solidBlockCount, sizeof(m_solidBlockCount));
+    Y_memzero(m_packedLODs, sizeof(m_packedLODs));
 
     // allocate collision shape and object
     m_pCollisionShape = new BlockWorldChunkCollisionShape(pSection->GetWorld()->GetPalette(), m_chunkSize, this);
     m_pCollisionObject = new Physics::StaticObject(0, m_pCollisionShape, Transform(m_basePosition, Quaternion::Identity, float3::One));
+
+    m_pSection->GetWorld()->OnChunkStorageChanged(1, 0);
 }
 
 BlockWorldChunk::~BlockWorldChunk()
@@ -50,10 +196,9 @@ BlockWorldChunk::~BlockWorldChunk()
 
     // kill all data levels
     for (int32 i = BLOCK_WORLD_MAX_LOD_LEVELS - 1; i >= 0; i--)
-    {
-        delete[] m_pBlockData[i];
-        delete[] m_pBlockValues[i];
-    }
+        FreeLOD(i);
+
+    m_pSection->GetWorld()->OnChunkStorageChanged(-1, -(int64)m_memoryUsage);
 
     m_pCollisionObject->Release();
     m_pCollisionShape->Release();
@@ -72,49 +217,167 @@ void BlockWorldChunk::Create()
         m_pBlockData[lodLevel] = new BlockWorldBlockDataType[blockCount];
         Y_memzero(m_pBlockData[lodLevel], sizeof(BlockWorldBlockDataType) * blockCount);
         m_zStride[lodLevel] = (m_chunkSize >> lodLevel) * (m_chunkSize >> lodLevel);
+        m_solidBlockCount[lodLevel] = 0;
     }
 
     // has everything loaded to start with
     m_loadedLODLevel = 0;
+    UpdateMemoryUsage();
+}
+
+template<class RunSource>
+bool BlockWorldChunk::PackFromRuns(int32 lodLevel, const RunSource &runSource)
+{
+    uint32 blockCount = GetLODBlockCount(lodLevel);
+
+    // gather the palette, giving up if there's more keys than a byte index covers
+    BlockPaletteBuilder paletteBuilder;
+    bool paletteFull = false;
+    runSource([&paletteBuilder, &paletteFull](uint32 key, uint32 runLength)
+    {
+        if (!paletteFull && paletteBuilder.Lookup(key) < 0)
+            paletteFull = true;
+    });
+    if (paletteFull)
+        return false;
+
+    // only worth it if it comes out smaller than the arrays
+    uint32 paletteSize = paletteBuilder.PaletteSize;
+    uint32 indexBits = GetPackedIndexBits(paletteSize);
+    uint32 indicesPerWordShift = GetPackedIndicesPerWordShift(indexBits);
+    uint32 storageSize = paletteSize + GetPackedIndexWordCount(blockCount, indexBits, indicesPerWordShift);
+    if ((sizeof(uint32) * storageSize) >= ((sizeof(BlockWorldBlockType) + sizeof(BlockWorldBlockDataType)) * blockCount))
+        return false;
+
+    // palette, then the indices
+    uint32 *pStorage = new uint32[storageSize];
+    Y_memcpy(pStorage, paletteBuilder.Palette, sizeof(uint32) * paletteSize);
+    if (indexBits != 0)
+    {
+        uint32 *pIndices = pStorage + paletteSize;
+        uint32 indexMask = (1 << indicesPerWordShift) - 1;
+        uint32 blockIndex = 0;
+        Y_memzero(pIndices, sizeof(uint32) * (storageSize - paletteSize));
+        runSource([&paletteBuilder, pIndices, indexBits, indicesPerWordShift, indexMask, &blockIndex](uint32 key, uint32 runLength)
+        {
+            uint32 paletteIndex = (uint32)paletteBuilder.Lookup(key);
+            for (uint32 i = 0; i < runLength; i++, blockIndex++)
+                pIndices[blockIndex >> indicesPerWordShift] |= paletteIndex << ((blockIndex & indexMask) * indexBits);
+        });
+    }
+
+    // replace the arrays
+    delete[] m_pBlockData[lodLevel];
+    m_pBlockData[lodLevel] = nullptr;
+    delete[] m_pBlockValues[lodLevel];
+    m_pBlockValues[lodLevel] = nullptr;
+    delete[] m_packedLODs[lodLevel].pStorage;
+
+    PackedLOD &packedLOD = m_packedLODs[lodLevel];
+    packedLOD.pStorage = pStorage;
+    packedLOD.PaletteSize = paletteSize;
+    packedLOD.IndexBits = indexBits;
+    packedLOD.IndicesPerWordShift = indicesPerWordShift;
+    return true;
 }
 
 bool BlockWorldChunk::LoadFromStream(int32 lodLevel, ByteStream *pStream)
 {
-    // allocate block values, data and set z stride
-    int32 blockCount = (m_chunkSize >> lodLevel) * (m_chunkSize >> lodLevel) * (m_chunkSize >> lodLevel);
-    if (m_pBlockValues[lodLevel] == nullptr)
+    // blocks are stored as runs of the same key, the lengths first, then the keys
+    uint32 blockCount = GetLODBlockCount(lodLevel);
+    BinaryReader binaryReader(pStream);
+    uint32 runCount;
+    if (!binaryReader.SafeReadUInt32(&runCount) || runCount == 0 || runCount > blockCount)
+        return false;
+
+    PODArray<uint16> runLengths;
+    PODArray<uint32> runKeys;
+    runLengths.Resize(runCount);
+    runKeys.Resize(runCount);
+    if (!pStream->Read2(runLengths.GetBasePointer(), sizeof(uint16) * runCount) ||
+        !pStream->Read2(runKeys.GetBasePointer(), sizeof(uint32) * runCount))
     {
-        DebugAssert(m_pBlockData[lodLevel] == nullptr && m_zStride[lodLevel] == 0);
-        m_pBlockValues[lodLevel] = new BlockWorldBlockType[blockCount];
-        m_pBlockData[lodLevel] = new BlockWorldBlockDataType[blockCount];
-        m_zStride[lodLevel] = (m_chunkSize >> lodLevel) * (m_chunkSize >> lodLevel);
+        return false;
     }
 
-    // read in block values, then data
-    if (!pStream->Read2(m_pBlockValues[lodLevel], sizeof(BlockWorldBlockType) * blockCount) ||
-        !pStream->Read2(m_pBlockData[lodLevel], sizeof(BlockWorldBlockDataType) * blockCount))
+    // the runs have to cover the chunk exactly
+    uint32 totalLength = 0;
+    uint32 solidBlockCount = 0;
+    for (uint32 i = 0; i < runCount; i++)
     {
-        //delete[] m_pBlockData[lodLevel];
-        //m_pBlockData[lodLevel] = nullptr;
-        //delete[] m_pBlockValues[lodLevel];
-        //m_pBlockValues[lodLevel] = nullptr;
-        //m_zStride[lodLevel] = 0;
+        uint32 runLength = (uint32)runLengths[i] + 1;
+        totalLength += runLength;
+        solidBlockCount += (GetPackedKeyBlockValue(runKeys[i]) != 0) ? runLength : 0;
+    }
+    if (totalLength != blockCount)
         return false;
+
+    // replace anything already there
+    FreeLOD(lodLevel);
+    m_zStride[lodLevel] = (m_chunkSize >> lodLevel) * (m_chunkSize >> lodLevel);
+    m_solidBlockCount[lodLevel] = solidBlockCount;
+
+    // lods past 0 go straight to the packed form if they can, otherwise expand the runs
+    StoredRunSource runSource = { runLengths.GetBasePointer(), runKeys.GetBasePointer(), runCount };
+    if (lodLevel == 0 || !PackFromRuns(lodLevel, runSource))
+    {
+        BlockWorldBlockType *pBlockValues = new BlockWorldBlockType[blockCount];
+        BlockWorldBlockDataType *pBlockData = new BlockWorldBlockDataType[blockCount];
+        uint32 blockIndex = 0;
+        runSource([pBlockValues, pBlockData, &blockIndex](uint32 key, uint32 runLength)
+        {
+            BlockWorldBlockType blockValue = GetPackedKeyBlockValue(key);
+            BlockWorldBlockDataType blockData = GetPackedKeyBlockData(key);
+            for (uint32 i = 0; i < runLength; i++, blockIndex++)
+            {
+                pBlockValues[blockIndex] = blockValue;
+                pBlockData[blockIndex] = blockData;
+            }
+        });
+
+        m_pBlockValues[lodLevel] = pBlockValues;
+        m_pBlockData[lodLevel] = pBlockData;
     }
 
     // update loaded level
     m_loadedLODLevel = Min(m_loadedLODLevel, lodLevel);
+    UpdateMemoryUsage();
     return true;
 }
 
 bool BlockWorldChunk::SaveToStream(int32 lodLevel, ByteStream *pStream)
 {
-    int32 blockCount = (m_chunkSize >> lodLevel) * (m_chunkSize >> lodLevel) * (m_chunkSize >> lodLevel);
-    DebugAssert(m_pBlockValues[lodLevel] != nullptr);
+    uint32 blockCount = GetLODBlockCount(lodLevel);
+    DebugAssert(IsLODLoaded(lodLevel));
+
+    // split into runs of the same key, no longer than the 16-bit length can hold
+    PODArray<uint16> runLengths;
+    PODArray<uint32> runKeys;
+    const BlockWorldBlockType *pBlockValues = m_pBlockValues[lodLevel];
+    const BlockWorldBlockDataType *pBlockData = m_pBlockData[lodLevel];
+    uint32 runKey = 0;
+    uint32 runLength = 0;
+    for (uint32 i = 0; i < blockCount; i++)
+    {
+        uint32 key = (pBlockValues != nullptr) ? MakePackedKey(pBlockValues[i], pBlockData[i]) : GetPackedKey(lodLevel, i);
+        if (runLength > 0 && (key != runKey || runLength == 65536))
+        {
+            runLengths.Add((uint16)(runLength - 1));
+            runKeys.Add(runKey);
+            runLength = 0;
+        }
 
-    // write block values, then data
-    if (!pStream->Write2(m_pBlockValues[lodLevel], sizeof(BlockWorldBlockType) * blockCount) ||
-        !pStream->Write2(m_pBlockData[lodLevel], sizeof(BlockWorldBlockDataType) * blockCount))
+        runKey = key;
+        runLength++;
+    }
+    runLengths.Add((uint16)(runLength - 1));
+    runKeys.Add(runKey);
+
+    BinaryWriter binaryWriter(pStream);
+    uint32 runCount = runKeys.GetSize();
+    if (!binaryWriter.SafeWriteUInt32(runCount) ||
+        !pStream->Write2(runLengths.GetBasePointer(), sizeof(uint16) * runCount) ||
+        !pStream->Write2(runKeys.GetBasePointer(), sizeof(uint32) * runCount))
     {
         return false;
     }
@@ -124,13 +387,9 @@ bool BlockWorldChunk::SaveToStream(int32 lodLevel, ByteStream *pStream)
 
 void BlockWorldChunk::UnloadLODLevel(int32 lodLevel)
 {
-    delete[] m_pBlockData[lodLevel];
-    m_pBlockData[lodLevel] = nullptr;
-
-    delete[] m_pBlockValues[lodLevel];
-    m_pBlockValues[lodLevel] = nullptr;
-
+    FreeLOD(lodLevel);
     m_zStride[lodLevel] = 0;
+    m_solidBlockCount[lodLevel] = 0;
 
     // is this the highest lod level? update the loaded level
     if (lodLevel == m_loadedLODLevel)
@@ -138,92 +397,255 @@ void BlockWorldChunk::UnloadLODLevel(int32 lodLevel)
         int32 lodLevels = m_pSection->GetWorld()->GetLODLevels();
         for (m_loadedLODLevel = lodLevel + 1; m_loadedLODLevel < lodLevels; m_loadedLODLevel++)
         {
-            if (m_pBlockValues[m_loadedLODLevel] != nullptr)
+            if (IsLODLoaded(m_loadedLODLevel))
                 break;
         }
     }
+
+    UpdateMemoryUsage();
 }
 
-bool BlockWorldChunk::IsAirChunk() const
+void BlockWorldChunk::FreeLOD(int32 lodLevel)
+{
+    delete[] m_pBlockData[lodLevel];
+    m_pBlockData[lodLevel] = nullptr;
+
+    delete[] m_pBlockValues[lodLevel];
+    m_pBlockValues[lodLevel] = nullptr;
+
+    delete[] m_packedLODs[lodLevel].pStorage;
+    Y_memzero(&m_packedLODs[lodLevel], sizeof(m_packedLODs[lodLevel]));
+}
+
+bool BlockWorldChunk::PackLOD(int32 lodLevel)
+{
+    DebugAssert(lodLevel > 0 && m_pBlockValues[lodLevel] != nullptr);
+
+    BlockArrayRunSource runSource = { m_pBlockValues[lodLevel], m_pBlockData[lodLevel], GetLODBlockCount(lodLevel) };
+    return PackFromRuns(lodLevel, runSource);
+}
+
+void BlockWorldChunk::PackLODs()
+{
+    int32 lodLevels = m_pSection->GetWorld()->GetLODLevels();
+    for (int32 lodLevel = 1; lodLevel < lodLevels; lodLevel++)
+    {
+        if (m_pBlockValues[lodLevel] != nullptr)
+            PackLOD(lodLevel);
+    }
+
+    UpdateMemoryUsage();
+}
+
+void BlockWorldChunk::UnpackLOD(int32 lodLevel)
 {
-    uint32 blockCount = m_chunkSize * m_chunkSize * m_chunkSize;
+    DebugAssert(IsLODPacked(lodLevel) && m_pBlockValues[lodLevel] == nullptr);
+
+    uint32 blockCount = GetLODBlockCount(lodLevel);
+    BlockWorldBlockType *pBlockValues = new BlockWorldBlockType[blockCount];
+    BlockWorldBlockDataType *pBlockData = new BlockWorldBlockDataType[blockCount];
     for (uint32 i = 0; i < blockCount; i++)
     {
-        if (m_pBlockValues[i] != 0)
-            return false;
+        uint32 key = GetPackedKey(lodLevel, i);
+        pBlockValues[i] = GetPackedKeyBlockValue(key);
+        pBlockData[i] = GetPackedKeyBlockData(key);
     }
 
-    return true;
+    delete[] m_packedLODs[lodLevel].pStorage;
+    Y_memzero(&m_packedLODs[lodLevel], sizeof(m_packedLODs[lodLevel]));
+    m_pBlockValues[lodLevel] = pBlockValues;
+    m_pBlockData[lodLevel] = pBlockData;
+    UpdateMemoryUsage();
+}
+
+uint32 BlockWorldChunk::GetPackedKey(int32 lodLevel, uint32 index) const
+{
+    const PackedLOD &packedLOD = m_packedLODs[lodLevel];
+    if (packedLOD.IndexBits == 0)
+        return packedLOD.pStorage[0];
+
+    uint32 word = packedLOD.pStorage[packedLOD.PaletteSize + (index >> packedLOD.IndicesPerWordShift)];
+    uint32 shift = (index & ((1 << packedLOD.IndicesPerWordShift) - 1)) * packedLOD.IndexBits;
+    return packedLOD.pStorage[(word >> shift) & ((1 << packedLOD.IndexBits) - 1)];
+}
+
+void BlockWorldChunk::UpdateMemoryUsage()
+{
+    int32 lodLevels = m_pSection->GetWorld()->GetLODLevels();
+    uint32 memoryUsage = 0;
+    for (int32 lodLevel = 0; lodLevel < lodLevels; lodLevel++)
+    {
+        const PackedLOD &packedLOD = m_packedLODs[lodLevel];
+        if (m_pBlockValues[lodLevel] != nullptr)
+            memoryUsage += (sizeof(BlockWorldBlockType) + sizeof(BlockWorldBlockDataType)) * GetLODBlockCount(lodLevel);
+        else if (packedLOD.pStorage != nullptr)
+            memoryUsage += sizeof(uint32) * (packedLOD.PaletteSize + GetPackedIndexWordCount(GetLODBlockCount(lodLevel), packedLOD.IndexBits, packedLOD.IndicesPerWordShift));
+    }
+
+    if (memoryUsage != m_memoryUsage)
+    {
+        m_pSection->GetWorld()->OnChunkStorageChanged(0, (int64)memoryUsage - (int64)m_memoryUsage);
+        m_memoryUsage = memoryUsage;
+    }
+}
+
+void BlockWorldChunk::CopyBlockRow(int32 lodLevel, int32 by, int32 bz, BlockWorldBlockType *pBlockValues, BlockWorldBlockDataType *pBlockData) const
+{
+    int32 rowLength = m_chunkSize >> lodLevel;
+    uint32 startIndex = GetBlockIndex(lodLevel, 0, by, bz);
+    if (m_pBlockValues[lodLevel] != nullptr)
+    {
+        Y_memcpy(pBlockValues, m_pBlockValues[lodLevel] + startIndex, sizeof(BlockWorldBlockType) * rowLength);
+        Y_memcpy(pBlockData, m_pBlockData[lodLevel] + startIndex, sizeof(BlockWorldBlockDataType) * rowLength);
+        return;
+    }
+
+    for (int32 i = 0; i < rowLength; i++)
+    {
+        uint32 key = GetPackedKey(lodLevel, startIndex + i);
+        pBlockValues[i] = GetPackedKeyBlockValue(key);
+        pBlockData[i] = GetPackedKeyBlockData(key);
+    }
+}
+
+bool BlockWorldChunk::IsAirChunk() const
+{
+    // nothing loaded counts as empty
+    if (m_loadedLODLevel >= m_pSection->GetWorld()->GetLODLevels())
+        return true;
+
+    return (m_solidBlockCount[m_loadedLODLevel] == 0);
 }
 
 BlockWorldBlockType BlockWorldChunk::GetBlock(int32 lodLevel, int32 bx, int32 by, int32 bz) const
 {
     DebugAssert(bx < (m_chunkSize >> lodLevel) && by < (m_chunkSize >> lodLevel) && bz < (m_chunkSize >> lodLevel));
-    return m_pBlockValues[lodLevel][(bz * m_zStride[lodLevel]) + (by * (m_chunkSize >> lodLevel)) + bx];
+    uint32 index = GetBlockIndex(lodLevel, bx, by, bz);
+    if (m_pBlockValues[lodLevel] != nullptr)
+        return m_pBlockValues[lodLevel][index];
+
+    return GetPackedKeyBlockValue(GetPackedKey(lodLevel, index));
+}
+
+void BlockWorldChunk::SetBlocks(int32 lodLevel, const BlockWorldBlockType *pBlockValues, const BlockWorldBlockDataType *pBlockData, uint32 solidBlockCount)
+{
+    if (m_pBlockValues[lodLevel] == nullptr)
+        UnpackLOD(lodLevel);
+
+    uint32 blockCount = GetLODBlockCount(lodLevel);
+    Y_memcpy(m_pBlockValues[lodLevel], pBlockValues, sizeof(BlockWorldBlockType) * blockCount);
+    Y_memcpy(m_pBlockData[lodLevel], pBlockData, sizeof(BlockWorldBlockDataType) * blockCount);
+    m_solidBlockCount[lodLevel] = solidBlockCount;
 }
 
 void BlockWorldChunk::SetBlock(int32 lodLevel, int32 bx, int32 by, int32 bz, BlockWorldBlockType blockType)
 {
     DebugAssert(bx < (m_chunkSize >> lodLevel) && by < (m_chunkSize >> lodLevel) && bz < (m_chunkSize >> lodLevel));
     DebugAssert((blockType & BLOCK_WORLD_BLOCK_VALUE_COLORED_FLAG_BIT) != 0 || blockType < BLOCK_MESH_MAX_BLOCK_TYPES);
-    uint32 index = (bz * m_zStride[lodLevel]) + (by * (m_chunkSize >> lodLevel)) + bx;
-    if (m_pBlockValues[lodLevel][index] == blockType)
+    uint32 index = GetBlockIndex(lodLevel, bx, by, bz);
+    BlockWorldBlockType currentBlockType = (m_pBlockValues[lodLevel] != nullptr) ? m_pBlockValues[lodLevel][index] : GetPackedKeyBlockValue(GetPackedKey(lodLevel, index));
+    if (currentBlockType == blockType)
         return;
 
+    // keep the solid count in step
+    if (currentBlockType == 0)
+        m_solidBlockCount[lodLevel]++;
+    else if (blockType == 0)
+        m_solidBlockCount[lodLevel]--;
+
+    // writes expand a packed lod
+    if (m_pBlockValues[lodLevel] == nullptr)
+        UnpackLOD(lodLevel);
+
     m_pBlockValues[lodLevel][index] = blockType;
 }
 
+BlockWorldBlockDataType BlockWorldChunk::ReadBlockData(int32 lodLevel, uint32 index) const
+{
+    if (m_pBlockData[lodLevel] != nullptr)
+        return m_pBlockData[lodLevel][index];
+
+    return GetPackedKeyBlockData(GetPackedKey(lodLevel, index));
+}
+
+void BlockWorldChunk::WriteBlockData(int32 lodLevel, uint32 index, BlockWorldBlockDataType data)
+{
+    // writes expand a packed lod
+    if (m_pBlockData[lodLevel] == nullptr)
+        UnpackLOD(lodLevel);
+
+    m_pBlockData[lodLevel][index] = data;
+}
+
 BlockWorldBlockDataType BlockWorldChunk::GetBlockData(int32 lodLevel, int32 bx, int32 by, int32 bz) const
 {
     DebugAssert(bx < (m_chunkSize >> lodLevel) && by < (m_chunkSize >> lodLevel) && bz < (m_chunkSize >> lodLevel));
-    return m_pBlockData[lodLevel][(bz * m_zStride[lodLevel]) + (by * (m_chunkSize >> lodLevel)) + bx];
+    return ReadBlockData(lodLevel, GetBlockIndex(lodLevel, bx, by, bz));
 }
 
 void BlockWorldChunk::SetBlockData(int32 lodLevel, int32 bx, int32 by, int32 bz, BlockWorldBlockDataType blockType)
 {
     DebugAssert(bx < (m_chunkSize >> lodLevel) && by < (m_chunkSize >> lodLevel) && bz < (m_chunkSize >> lodLevel));
 
-    uint32 index = (bz * m_zStride[lodLevel]) + (by * (m_chunkSize >> lodLevel)) + bx;
-    if (m_pBlockData[lodLevel][index] == blockType)
+    uint32 index = GetBlockIndex(lodLevel, bx, by, bz);
+    if (ReadBlockData(lodLevel, index) == blockType)
         return;
 
-    m_pBlockData[lodLevel][index] = blockType;
+    WriteBlockData(lodLevel, index, blockType);
 }
 
 uint8 BlockWorldChunk::GetBlockLight(int32 lodLevel, int32 bx, int32 by, int32 bz) const
 {
     DebugAssert(bx < (m_chunkSize >> lodLevel) && by < (m_chunkSize >> lodLevel) && bz < (m_chunkSize >> lodLevel));
-    return BLOCK_WORLD_BLOCK_DATA_GET_LIGHTING(m_pBlockData[lodLevel][(bz * m_zStride[lodLevel]) + (by * (m_chunkSize >> lodLevel)) + bx]);
+    return BLOCK_WORLD_BLOCK_DATA_GET_LIGHTING(ReadBlockData(lodLevel, GetBlockIndex(lodLevel, bx, by, bz)));
 }
 
 void BlockWorldChunk::SetBlockLight(int32 lodLevel, int32 bx, int32 by, int32 bz, uint8 lightLevel)
 {
     DebugAssert(bx < (m_chunkSize >> lodLevel) && by < (m_chunkSize >> lodLevel) && bz < (m_chunkSize >> lodLevel));
 
-    uint32 index = (bz * m_zStride[lodLevel]) + (by * (m_chunkSize >> lodLevel)) + bx;
-    uint8 data = m_pBlockData[lodLevel][index];
+    uint32 index = GetBlockIndex(lodLevel, bx, by, bz);
+    BlockWorldBlockDataType data = ReadBlockData(lodLevel, index);
     if (BLOCK_WORLD_BLOCK_DATA_GET_LIGHTING(data) == lightLevel)
         return;
 
-    m_pBlockData[lodLevel][index] = BLOCK_WORLD_BLOCK_DATA_SET_LIGHTING(data, lightLevel);
+    WriteBlockData(lodLevel, index, BLOCK_WORLD_BLOCK_DATA_SET_LIGHTING(data, lightLevel));
+}
+
+uint8 BlockWorldChunk::GetBlockSkyLight(int32 lodLevel, int32 bx, int32 by, int32 bz) const
+{
+    DebugAssert(bx < (m_chunkSize >> lodLevel) && by < (m_chunkSize >> lodLevel) && bz < (m_chunkSize >> lodLevel));
+    return BLOCK_WORLD_BLOCK_DATA_GET_SKY_LIGHTING(ReadBlockData(lodLevel, GetBlockIndex(lodLevel, bx, by, bz)));
+}
+
+void BlockWorldChunk::SetBlockSkyLight(int32 lodLevel, int32 bx, int32 by, int32 bz, uint8 lightLevel)
+{
+    DebugAssert(bx < (m_chunkSize >> lodLevel) && by < (m_chunkSize >> lodLevel) && bz < (m_chunkSize >> lodLevel));
+
+    uint32 index = GetBlockIndex(lodLevel, bx, by, bz);
+    BlockWorldBlockDataType data = ReadBlockData(lodLevel, index);
+    if (BLOCK_WORLD_BLOCK_DATA_GET_SKY_LIGHTING(data) == lightLevel)
+        return;
+
+    WriteBlockData(lodLevel, index, BLOCK_WORLD_BLOCK_DATA_SET_SKY_LIGHTING(data, lightLevel));
 }
 
 uint8 BlockWorldChunk::GetBlockRotation(int32 lodLevel, int32 bx, int32 by, int32 bz) const
 {
     DebugAssert(bx < (m_chunkSize >> lodLevel) && by < (m_chunkSize >> lodLevel) && bz < (m_chunkSize >> lodLevel));
-    return BLOCK_WORLD_BLOCK_DATA_GET_ROTATION(m_pBlockData[lodLevel][(bz * m_zStride[lodLevel]) + (by * (m_chunkSize >> lodLevel)) + bx]);
+    return BLOCK_WORLD_BLOCK_DATA_GET_ROTATION(ReadBlockData(lodLevel, GetBlockIndex(lodLevel, bx, by, bz)));
 }
 
 void BlockWorldChunk::SetBlockRotation(int32 lodLevel, int32 bx, int32 by, int32 bz, uint8 rotation)
 {
     DebugAssert(bx < (m_chunkSize >> lodLevel) && by < (m_chunkSize >> lodLevel) && bz < (m_chunkSize >> lodLevel));
 
-    uint32 index = (bz * m_zStride[lodLevel]) + (by * (m_chunkSize >> lodLevel)) + bx;
-    uint8 data = m_pBlockData[lodLevel][index];
+    uint32 index = GetBlockIndex(lodLevel, bx, by, bz);
+    BlockWorldBlockDataType data = ReadBlockData(lodLevel, index);
     if (BLOCK_WORLD_BLOCK_DATA_GET_ROTATION(data) == rotation)
         return;
 
-    m_pBlockData[lodLevel][index] = BLOCK_WORLD_BLOCK_DATA_SET_ROTATION(data, rotation);
+    WriteBlockData(lodLevel, index, BLOCK_WORLD_BLOCK_DATA_SET_ROTATION(data, rotation));
 }
 
 void BlockWorldChunk::UpdateLODs(int32 lodLevel, int32 blockX, int32 blockY, int32 blockZ)
@@ -262,17 +684,9 @@ void BlockWorldChunk::UpdateLODs(int32 lodLevel, int32 blockX, int32 blockY, int
     //Log_DevPrintf("BLOCK SET %i [%i,%i,%i] (base %i %i %i) [[[%u]]]", lodLevel, blockX, blockY, blockZ, baseBlockX, baseBlockY, baseBlockZ, pChunk->GetBlock(blockX, blockY, blockZ));
 
     // do average operation fixme
-    BlockWorldBlockType lodBlockValue = blocks[0];
-    BlockWorldBlockDataType lodBlockData = blockData[0];
-    for (uint32 i = 0; i < 8; i++)
-    {
-        if (blocks[i] != 0)
-        {
-            lodBlockValue = blocks[i];
-            lodBlockData = blockData[i];
-            break;
-        }
-    }
+    uint32 sourceBlock = SelectLODSourceBlock(blocks);
+    BlockWorldBlockType lodBlockValue = blocks[sourceBlock];
+    BlockWorldBlockDataType lodBlockData = blockData[sourceBlock];
     //if (lodBlockValue == 0)
         //Log_WarningPrintf("no block found");
 
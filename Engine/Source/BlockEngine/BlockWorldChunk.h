@@ -1,5 +1,6 @@
 #pragma once
 #include "BlockEngine/BlockWorldTypes.h"
+#include <atomic>
 
 namespace Physics { class StaticObject; }
 
@@ -42,15 +43,33 @@ public:
     bool SaveToStream(int32 lodLevel, ByteStream *pStream);
     void UnloadLODLevel(int32 lodLevel);
 
+    // lods other than 0 may be held packed, see PackLODs
+    bool IsLODLoaded(int32 lodLevel) const { return (m_pBlockValues[lodLevel] != nullptr || m_packedLODs[lodLevel].pStorage != nullptr); }
+    bool IsLODPacked(int32 lodLevel) const { return (m_packedLODs[lodLevel].pStorage != nullptr); }
+
     // chunk data is indexed by (bz * CHUNKSIZE * CHUNKHEIGHT) + (by * CHUNKSIZE) + bx
-    const BlockWorldBlockType *GetBlockValues(int32 lodLevel) const { return m_pBlockValues[lodLevel]; }
-    const BlockWorldBlockDataType *GetBlockData(int32 lodLevel) const { return m_pBlockData[lodLevel]; }
-    BlockWorldBlockType *GetBlockValues(int32 lodLevel) { return m_pBlockValues[lodLevel]; }
-    BlockWorldBlockDataType *GetBlockData(int32 lodLevel) { return m_pBlockData[lodLevel]; }
+    // the arrays are only there for unpacked lods, lod 0 is never packed
+    const BlockWorldBlockType *GetBlockValues(int32 lodLevel) const { DebugAssert(!IsLODPacked(lodLevel)); return m_pBlockValues[lodLevel]; }
+    const BlockWorldBlockDataType *GetBlockData(int32 lodLevel) const { DebugAssert(!IsLODPacked(lodLevel)); return m_pBlockData[lodLevel]; }
+    BlockWorldBlockType *GetBlockValues(int32 lodLevel) { DebugAssert(!IsLODPacked(lodLevel)); return m_pBlockValues[lodLevel]; }
+    BlockWorldBlockDataType *GetBlockData(int32 lodLevel) { DebugAssert(!IsLODPacked(lodLevel)); return m_pBlockData[lodLevel]; }
     int32 GetZStride(int32 lodLevel) { return m_zStride[lodLevel]; }
 
-    // check if the chunk is empty
+    // replaces every block of a lod, for chunks filled in by the generator
+    void SetBlocks(int32 lodLevel, const BlockWorldBlockType *pBlockValues, const BlockWorldBlockDataType *pBlockData, uint32 solidBlockCount);
+
+    // copies a row of blocks along x, packed or not
+    void CopyBlockRow(int32 lodLevel, int32 by, int32 bz, BlockWorldBlockType *pBlockValues, BlockWorldBlockDataType *pBlockData) const;
+
+    // packs every lod past 0 that gets smaller for it. writing to a packed lod expands it again.
+    void PackLODs();
+
+    // bytes used by the block values and data of all lods
+    uint32 GetMemoryUsage() const { return m_memoryUsage; }
+
+    // check if the chunk is empty, at the highest loaded lod
     bool IsAirChunk() const;
+    bool IsAirChunk(int32 lodLevel) const { return (m_solidBlockCount[lodLevel] == 0); }
 
     // manipulators
     BlockWorldBlockType GetBlock(int32 lodLevel, int32 bx, int32 by, int32 bz) const;
@@ -63,6 +82,8 @@ public:
     // lighting manipulators
     uint8 GetBlockLight(int32 lodLevel, int32 bx, int32 by, int32 bz) const;
     void SetBlockLight(int32 lodLevel, int32 bx, int32 by, int32 bz, uint8 lightLevel);
+    uint8 GetBlockSkyLight(int32 lodLevel, int32 bx, int32 by, int32 bz) const;
+    void SetBlockSkyLight(int32 lodLevel, int32 bx, int32 by, int32 bz, uint8 lightLevel);
 
     // rotation manipulators
     uint8 GetBlockRotation(int32 lodLevel, int32 bx, int32 by, int32 bz) const;
@@ -71,10 +92,30 @@ public:
     // update the lods for a particular block
     void UpdateLODs(int32 lodLevel, int32 blockX, int32 blockY, int32 blockZ);
 
+    // which of the 8 blocks a block of the next lod covers it is taken from, the first one that isn't air.
+    // the blocks are ordered x, then y, then z. the generator builds its lods with this too.
+    static uint32 SelectLODSourceBlock(const BlockWorldBlockType *pBlockValues)
+    {
+        for (uint32 i = 0; i < 8; i++)
+        {
+            if (pBlockValues[i] != 0)
+                return i;
+        }
+
+        return 0;
+    }
+
     // mesh pending flag
-    MeshState GetMeshState() const { return m_meshState; }
-    bool IsMeshPending() const { return (m_meshState != MeshState_Idle); }
-    void SetMeshState(MeshState state) { DebugAssert(state <= MeshState_InProgress); m_meshState = state; }
+    // read by the meshing jobs to cancel out of date work, so changes are published with release ordering
+    MeshState GetMeshState() const { return m_meshState.load(std::memory_order_acquire); }
+    bool IsMeshPending() const { return (m_meshState.load(std::memory_order_acquire) != MeshState_Idle); }
+    void SetMeshState(MeshState state) { DebugAssert(state <= MeshState_InProgressWithChanges); m_meshState.store(state, std::memory_order_release); }
+
+    // set by the lighting batch when it changes any light in this chunk, with a bit per CUBE_FACE for changes on the edges
+    bool IsLightingChanged() const { return m_lightingChanged; }
+    uint32 GetLightingChangedEdges() const { return m_lightingChangedEdges; }
+    void SetLightingChanged(uint32 edgeMask) { m_lightingChanged = true; m_lightingChangedEdges |= edgeMask; }
+    void ClearLightingChanged() { m_lightingChanged = false; m_lightingChangedEdges = 0; }
 
     // collision object
     BlockWorldChunkCollisionShape *GetCollisionShape() { return m_pCollisionShape; }
@@ -102,7 +143,36 @@ private:
     BlockWorldBlockType *m_pBlockValues[BLOCK_WORLD_MAX_LOD_LEVELS];
     BlockWorldBlockDataType *m_pBlockData[BLOCK_WORLD_MAX_LOD_LEVELS];
     int32 m_zStride[BLOCK_WORLD_MAX_LOD_LEVELS];
-   
+
+    // number of non-air blocks at each lod, so empty chunks can be skipped without scanning them
+    uint32 m_solidBlockCount[BLOCK_WORLD_MAX_LOD_LEVELS];
+
+    // The coarser lods are mostly large areas of air or stone, so they can be held as a palette of (value << 16 | data)
+    // keys followed by a bit-packed palette index per block. A chunk of a single block is only the palette.
+    struct PackedLOD
+    {
+        uint32 *pStorage;
+        uint32 PaletteSize;
+        uint32 IndexBits;
+        uint32 IndicesPerWordShift;
+    };
+    PackedLOD m_packedLODs[BLOCK_WORLD_MAX_LOD_LEVELS];
+
+    // packing helpers, the run source is called with a callback taking (key, length) for each run of blocks in order
+    template<class RunSource> bool PackFromRuns(int32 lodLevel, const RunSource &runSource);
+    bool PackLOD(int32 lodLevel);
+    void UnpackLOD(int32 lodLevel);
+    uint32 GetPackedKey(int32 lodLevel, uint32 index) const;
+    void FreeLOD(int32 lodLevel);
+    uint32 GetLODBlockCount(int32 lodLevel) const { return (uint32)((m_chunkSize >> lodLevel) * (m_chunkSize >> lodLevel) * (m_chunkSize >> lodLevel)); }
+    uint32 GetBlockIndex(int32 lodLevel, int32 bx, int32 by, int32 bz) const { return (uint32)((bz * m_zStride[lodLevel]) + (by * (m_chunkSize >> lodLevel)) + bx); }
+    BlockWorldBlockDataType ReadBlockData(int32 lodLevel, uint32 index) const;
+    void WriteBlockData(int32 lodLevel, uint32 index, BlockWorldBlockDataType data);
+
+    // storage accounting, reported to the world
+    uint32 m_memoryUsage;
+    void UpdateMemoryUsage();
+
     // physics object for this chunk
     BlockWorldChunkCollisionShape *m_pCollisionShape;
     Physics::StaticObject *m_pCollisionObject;
@@ -111,5 +181,9 @@ private:
     BlockWorldChunkRenderProxy *m_pRenderProxy;
 
     // mesh pending flag
-    MeshState m_meshState;
+    std::atomic<MeshState> m_meshState;
+
+    // lighting changed flag
+    bool m_lightingChanged;
+    uint32 m_lightingChangedEdges;
 };
@@ -17,7 +17,9 @@ BlockWorldChunkRenderProxy::BlockWorldChunkRenderProxy(uint32 entityID, const Bl
     : RenderProxy(entityID),
       m_pPalette(pPalette),
       m_transformMatrix(transformMatrix),
+      m_vertexTransformMatrix(transformMatrix),
       m_lodLevel(lodLevel),
+      m_vertexFactoryFlags(0),
       m_renderResourcesCreated(false),
       m_pIndexBuffer(nullptr),
       m_indexFormat(GPU_INDEX_FORMAT_COUNT),
@@ -74,14 +76,16 @@ BlockWorldMesher *BlockWorldChunkRenderProxy::CreateMesher(const BlockWorld *pWo
     int32 volumeSize = chunkSize + 2;
     int32 volumeSizeMinusOne = volumeSize - 1;
 #ifdef USE_LOCAL_TO_WORLD_TRANSFORM
-    BlockWorldMesher *pBuilder = new BlockWorldMesher(pWorld->GetPalette(), volumeSize, lodLevel, float3::Zero, CVars::r_block_world_use_lightmaps.GetBool());
+    BlockWorldMesher *pBuilder = BlockWorldMesher::Allocate(pWorld->GetPalette(), volumeSize, lodLevel, float3::Zero, CVars::r_block_world_use_lightmaps.GetBool());
 #else
-    BlockWorldMesher *pBuilder = new BlockWorldMesher(pWorld->GetPalette(), volumeSize, lodLevel, pChunk->GetBasePosition(), CVars::r_block_world_use_lightmaps.GetBool());
+    BlockWorldMesher *pBuilder = BlockWorldMesher::Allocate(pWorld->GetPalette(), volumeSize, lodLevel, pChunk->GetBasePosition(), CVars::r_block_world_use_lightmaps.GetBool());
 #endif
+
+    // packed vertices need integer vertex attributes
+    pBuilder->SetPackVertices(CVars::r_block_world_packed_vertices.GetBool() && g_pRenderer->GetFeatureLevel() >= RENDERER_FEATURE_LEVEL_SM4);
+
     BlockWorldBlockType *pBlockValues = pBuilder->GetBlockValues();
     BlockWorldBlockDataType *pBlockData = pBuilder->GetBlockData();
-    int32 srcZStride = (chunkSize * chunkSize);
-    int32 srcYStride = (chunkSize);
     int32 zStride = (volumeSize * volumeSize);
     int32 yStride = (volumeSize);
 
@@ -109,8 +113,8 @@ BlockWorldMesher *BlockWorldChunkRenderProxy::CreateMesher(const BlockWorld *pWo
             // copy the bottom slab's top layer to our bottom slab
             if (pNeighbourChunks[CUBE_FACE_BOTTOM] != nullptr)
             {
-                Y_memcpy_stride(&BLOCK(1, 1), sizeof(BlockWorldBlockType) * yStride, pNeighbourChunks[CUBE_FACE_BOTTOM]->GetBlockValues(lodLevel) + (srcZStride * chunkSizeMinusOne), sizeof(BlockWorldBlockType) * srcYStride, sizeof(BlockWorldBlockType) * chunkSize, chunkSize);
-                Y_memcpy_stride(&BLOCKDATA(1, 1), sizeof(BlockWorldBlockDataType) * yStride, pNeighbourChunks[CUBE_FACE_BOTTOM]->GetBlockData(lodLevel) + (srcZStride * chunkSizeMinusOne), sizeof(BlockWorldBlockDataType) * srcYStride, sizeof(BlockWorldBlockDataType) * chunkSize, chunkSize);
+                for (int32 y = 0; y < chunkSize; y++)
+                    pNeighbourChunks[CUBE_FACE_BOTTOM]->CopyBlockRow(lodLevel, y, chunkSizeMinusOne, &BLOCK(1, y + 1), &BLOCKDATA(1, y + 1));
             }
         }
         // top slab?
@@ -119,8 +123,8 @@ BlockWorldMesher *BlockWorldChunkRenderProxy::CreateMesher(const BlockWorld *pWo
             // copy the bottom slab's bottom layer to our top slab
             if (pNeighbourChunks[CUBE_FACE_TOP] != nullptr)
             {
-                Y_memcpy_stride(&BLOCK(1, 1), sizeof(BlockWorldBlockType) * yStride, pNeighbourChunks[CUBE_FACE_TOP]->GetBlockValues(lodLevel), sizeof(BlockWorldBlockType) * srcYStride, sizeof(BlockWorldBlockType) * chunkSize, chunkSize);
-                Y_memcpy_stride(&BLOCKDATA(1, 1), sizeof(BlockWorldBlockDataType) * yStride, pNeighbourChunks[CUBE_FACE_TOP]->GetBlockData(lodLevel), sizeof(BlockWorldBlockDataType) * srcYStride, sizeof(BlockWorldBlockDataType) * chunkSize, chunkSize);
+                for (int32 y = 0; y < chunkSize; y++)
+                    pNeighbourChunks[CUBE_FACE_TOP]->CopyBlockRow(lodLevel, y, 0, &BLOCK(1, y + 1), &BLOCKDATA(1, y + 1));
             }
         }
         // normal slabs
@@ -167,16 +171,8 @@ BlockWorldMesher *BlockWorldChunkRenderProxy::CreateMesher(const BlockWorld *pWo
             }
 
             // set everything else to the actual chunk data
-            //Y_memcpy_stride(&BLOCK(1, 1), yStride, pChunk->GetBlockValues(lodLevel) + (srcZStride * (z - 1)), sizeof(BlockWorldBlockType) * srcYStride, sizeof(BlockWorldBlockType) * chunkSize, chunkSize);
-
             for (int32 y = 0; y < chunkSize; y++)
-            {
-                for (int32 x = 0; x < chunkSize; x++)
-                {
-                    BLOCK(x + 1, y + 1) = pChunk->GetBlock(lodLevel, x, y, z - 1);
-                    BLOCKDATA(x + 1, y + 1) = pChunk->GetBlockData(lodLevel, x, y, z - 1);
-                }
-            }
+                pChunk->CopyBlockRow(lodLevel, y, z - 1, &BLOCK(1, y + 1), &BLOCKDATA(1, y + 1));
         }
 #undef BLOCKDATA
 #undef BLOCK
@@ -292,11 +288,23 @@ bool BlockWorldChunkRenderProxy::UploadMeshToGPU(BlockWorldMesher *pBuilder)
     m_lights.Clear();
     m_lights.AddArray(pBuilder->GetOutputLights());
 
+    // packed vertices are relative to the mesher's base position
+    if (pBuilder->HasPackedOutputVertices())
+    {
+        m_vertexFactoryFlags = BLOCK_WORLD_VERTEX_FACTORY_FLAG_PACKED_VERTICES;
+        m_vertexTransformMatrix = m_transformMatrix * float4x4::MakeTranslationMatrix(pBuilder->GetBasePosition());
+    }
+    else
+    {
+        m_vertexFactoryFlags = 0;
+        m_vertexTransformMatrix = m_transformMatrix;
+    }
+
     // update lod level
     m_lodLevel = pBuilder->GetLODLevel();
 
     // clean up
-    delete pBuilder;
+    BlockWorldMesher::Free(pBuilder);
     m_renderResourcesCreated = true;
     return true;
 }
@@ -383,7 +391,7 @@ void BlockWorldChunkRenderProxy::QueueForRender(const Camera *pCamera, RenderQue
             queueEntry.pMaterial = pMaterial;
             queueEntry.BoundingBox = GetBoundingBox();
             queueEntry.RenderPassMask = renderPassMask;
-            queueEntry.VertexFactoryFlags = 0;
+            queueEntry.VertexFactoryFlags = m_vertexFactoryFlags;
             queueEntry.ViewDistance = viewDistance;
             queueEntry.TintColor = MAKE_COLOR_R8G8B8A8_UNORM(255, 255, 255, 255);
             queueEntry.UserData[0] = 0;
@@ -446,7 +454,7 @@ void BlockWorldChunkRenderProxy::SetupForDraw(const Camera *pCamera, const RENDE
 {
     if (pQueueEntry->UserData[0] == 0)
     {
-        pCommandList->GetConstants()->SetLocalToWorldMatrix(m_transformMatrix, true);
+        pCommandList->GetConstants()->SetLocalToWorldMatrix(m_vertexTransformMatrix, true);
         pCommandList->SetDrawTopology(DRAW_TOPOLOGY_TRIANGLE_LIST);
         m_vertexBuffers.BindBuffers(pCommandList);
         pCommandList->SetIndexBuffer(m_pIndexBuffer, m_indexFormat, 0);
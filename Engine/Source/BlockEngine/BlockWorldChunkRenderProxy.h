@@ -55,6 +55,7 @@ private:
     // data
     const BlockPalette *m_pPalette;
     float4x4 m_transformMatrix;
+    float4x4 m_vertexTransformMatrix;
     int32 m_lodLevel;
 
     // gpu resources
@@ -62,6 +63,7 @@ private:
     mutable VertexBufferBindingArray m_vertexBuffers;
     mutable GPUBuffer *m_pIndexBuffer;
     mutable GPU_INDEX_FORMAT m_indexFormat;
+    mutable uint32 m_vertexFactoryFlags;
     mutable MemArray<RenderBatch> m_renderBatches;
     mutable GPUBuffer *m_pMeshInstanceBuffer;
     mutable MemArray<RenderMeshInstance> m_renderMeshInstances;
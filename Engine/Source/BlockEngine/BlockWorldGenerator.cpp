@@ -1,5 +1,134 @@
 #include "BlockEngine/PrecompiledHeader.h"
 #include "BlockEngine/BlockWorldGenerator.h"
+#include "BlockEngine/BlockWorldChunk.h"
+
+BlockWorldGeneratorColumn::BlockWorldGeneratorColumn(int32 chunkSize, int32 lodLevels, int32 chunkX, int32 chunkY, int32 minChunkZ, int32 maxChunkZ)
+    : m_chunkSize(chunkSize),
+      m_lodLevels(lodLevels),
+      m_chunkX(chunkX),
+      m_chunkY(chunkY),
+      m_minChunkZ(minChunkZ),
+      m_maxChunkZ(maxChunkZ)
+{
+    int32 chunkCount = GetChunkCount();
+    for (int32 lodLevel = 0; lodLevel < BLOCK_WORLD_MAX_LOD_LEVELS; lodLevel++)
+    {
+        if (lodLevel >= m_lodLevels)
+        {
+            m_pBlockValues[lodLevel] = nullptr;
+            m_pBlockData[lodLevel] = nullptr;
+            continue;
+        }
+
+        int32 lodChunkSize = m_chunkSize >> lodLevel;
+        int32 blockCount = chunkCount * lodChunkSize * lodChunkSize * lodChunkSize;
+        m_pBlockValues[lodLevel] = new BlockWorldBlockType[blockCount];
+        Y_memzero(m_pBlockValues[lodLevel], sizeof(BlockWorldBlockType) * blockCount);
+        m_pBlockData[lodLevel] = new BlockWorldBlockDataType[blockCount];
+        Y_memzero(m_pBlockData[lodLevel], sizeof(BlockWorldBlockDataType) * blockCount);
+    }
+
+    m_pSolidBlockCounts = new uint32[m_lodLevels * chunkCount];
+    Y_memzero(m_pSolidBlockCounts, sizeof(uint32) * m_lodLevels * chunkCount);
+}
+
+BlockWorldGeneratorColumn::~BlockWorldGeneratorColumn()
+{
+    for (int32 lodLevel = 0; lodLevel < m_lodLevels; lodLevel++)
+    {
+        delete[] m_pBlockData[lodLevel];
+        delete[] m_pBlockValues[lodLevel];
+    }
+
+    delete[] m_pSolidBlockCounts;
+}
+
+void BlockWorldGeneratorColumn::SetBlock(int32 lx, int32 ly, int32 bz, BlockWorldBlockType blockValue, BlockWorldBlockDataType blockData /* = 0 */)
+{
+    DebugAssert(lx >= 0 && lx < m_chunkSize && ly >= 0 && ly < m_chunkSize && bz >= GetMinBlockZ() && bz <= GetMaxBlockZ());
+
+    uint32 index = GetBlockIndex(lx, ly, bz);
+    m_pBlockValues[0][index] = blockValue;
+    m_pBlockData[0][index] = blockData;
+}
+
+void BlockWorldGeneratorColumn::FillBlocks(int32 lx, int32 ly, int32 startZ, int32 endZ, BlockWorldBlockType blockValue)
+{
+    DebugAssert(lx >= 0 && lx < m_chunkSize && ly >= 0 && ly < m_chunkSize);
+
+    startZ = Max(startZ, GetMinBlockZ());
+    endZ = Min(endZ, GetMaxBlockZ());
+    if (startZ > endZ)
+        return;
+
+    // one block per z slice
+    uint32 index = GetBlockIndex(lx, ly, startZ);
+    uint32 zStride = (uint32)(m_chunkSize * m_chunkSize);
+    for (int32 bz = startZ; bz <= endZ; bz++, index += zStride)
+    {
+        m_pBlockValues[0][index] = blockValue;
+        m_pBlockData[0][index] = 0;
+    }
+}
+
+void BlockWorldGeneratorColumn::BuildLODs()
+{
+    int32 chunkCount = GetChunkCount();
+    for (int32 lodLevel = 1; lodLevel < m_lodLevels; lodLevel++)
+    {
+        // each block is picked from the 8 it covers at the previous lod, as BlockWorldChunk::UpdateLODs does
+        const BlockWorldBlockType *pSourceValues = m_pBlockValues[lodLevel - 1];
+        const BlockWorldBlockDataType *pSourceData = m_pBlockData[lodLevel - 1];
+        BlockWorldBlockType *pBlockValues = m_pBlockValues[lodLevel];
+        BlockWorldBlockDataType *pBlockData = m_pBlockData[lodLevel];
+        int32 sourceSize = m_chunkSize >> (lodLevel - 1);
+        int32 lodSize = m_chunkSize >> lodLevel;
+        int32 lodHeight = chunkCount * lodSize;
+        uint32 index = 0;
+        for (int32 z = 0; z < lodHeight; z++)
+        {
+            for (int32 y = 0; y < lodSize; y++)
+            {
+                for (int32 x = 0; x < lodSize; x++, index++)
+                {
+                    uint32 baseIndex = (uint32)((((z * 2) * sourceSize + (y * 2)) * sourceSize) + (x * 2));
+                    uint32 sourceIndices[8] =
+                    {
+                        baseIndex, baseIndex + 1,
+                        baseIndex + sourceSize, baseIndex + sourceSize + 1,
+                        baseIndex + sourceSize * sourceSize, baseIndex + sourceSize * sourceSize + 1,
+                        baseIndex + sourceSize * sourceSize + sourceSize, baseIndex + sourceSize * sourceSize + sourceSize + 1
+                    };
+
+                    BlockWorldBlockType sourceValues[8];
+                    for (uint32 i = 0; i < 8; i++)
+                        sourceValues[i] = pSourceValues[sourceIndices[i]];
+
+                    uint32 sourceIndex = sourceIndices[BlockWorldChunk::SelectLODSourceBlock(sourceValues)];
+                    pBlockValues[index] = pSourceValues[sourceIndex];
+                    pBlockData[index] = pSourceData[sourceIndex];
+                }
+            }
+        }
+    }
+
+    // count the solid blocks, so the world can skip chunks of air
+    for (int32 lodLevel = 0; lodLevel < m_lodLevels; lodLevel++)
+    {
+        int32 lodChunkSize = m_chunkSize >> lodLevel;
+        uint32 chunkBlockCount = (uint32)(lodChunkSize * lodChunkSize * lodChunkSize);
+        const BlockWorldBlockType *pBlockValues = m_pBlockValues[lodLevel];
+        for (int32 chunkIndex = 0; chunkIndex < chunkCount; chunkIndex++)
+        {
+            uint32 solidBlockCount = 0;
+            for (uint32 i = 0; i < chunkBlockCount; i++)
+                solidBlockCount += (pBlockValues[i] != 0) ? 1 : 0;
+
+            m_pSolidBlockCounts[lodLevel * chunkCount + chunkIndex] = solidBlockCount;
+            pBlockValues += chunkBlockCount;
+        }
+    }
+}
 
 BlockWorldGenerator::BlockWorldGenerator(BlockWorld *pBlockWorld)
     : m_pBlockWorld(pBlockWorld)
@@ -38,3 +167,13 @@ bool BlockWorldGenerator::GenerateBlocks(int32 startX, int32 startY, int32 endX,
 {
     return false;
 }
+
+bool BlockWorldGenerator::CanGenerateColumns() const
+{
+    return false;
+}
+
+bool BlockWorldGenerator::GenerateColumn(BlockWorldGeneratorColumn *pColumn) const
+{
+    return false;
+}
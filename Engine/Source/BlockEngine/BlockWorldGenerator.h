@@ -1,6 +1,64 @@
 #pragma once
 #include "BlockEngine/BlockWorld.h"
 
+// One column of chunks of a section, filled in by a generator on a job worker. Block coordinates are local to the
+// column in x and y, and global in z. The blocks are held as the column's chunks one after another, each indexed as a
+// chunk is, so the world can copy every chunk out whole once the column is complete.
+class BlockWorldGeneratorColumn
+{
+public:
+    BlockWorldGeneratorColumn(int32 chunkSize, int32 lodLevels, int32 chunkX, int32 chunkY, int32 minChunkZ, int32 maxChunkZ);
+    ~BlockWorldGeneratorColumn();
+
+    const int32 GetChunkSize() const { return m_chunkSize; }
+    const int32 GetLODLevels() const { return m_lodLevels; }
+    const int32 GetChunkX() const { return m_chunkX; }
+    const int32 GetChunkY() const { return m_chunkY; }
+    const int32 GetMinChunkZ() const { return m_minChunkZ; }
+    const int32 GetMaxChunkZ() const { return m_maxChunkZ; }
+
+    // global block coordinates covered by the column
+    const int32 GetBaseBlockX() const { return m_chunkX * m_chunkSize; }
+    const int32 GetBaseBlockY() const { return m_chunkY * m_chunkSize; }
+    const int32 GetMinBlockZ() const { return m_minChunkZ * m_chunkSize; }
+    const int32 GetMaxBlockZ() const { return (m_maxChunkZ + 1) * m_chunkSize - 1; }
+
+    // lod 0 manipulators
+    BlockWorldBlockType GetBlock(int32 lx, int32 ly, int32 bz) const { return m_pBlockValues[0][GetBlockIndex(lx, ly, bz)]; }
+    void SetBlock(int32 lx, int32 ly, int32 bz, BlockWorldBlockType blockValue, BlockWorldBlockDataType blockData = 0);
+
+    // sets the blocks from startZ to endZ inclusive, clipped to the column
+    void FillBlocks(int32 lx, int32 ly, int32 startZ, int32 endZ, BlockWorldBlockType blockValue);
+
+    // whole column at a lod, indexed by ((bz - GetMinBlockZ()) * CHUNKSIZE * CHUNKSIZE) + (ly * CHUNKSIZE) + lx at lod 0
+    const BlockWorldBlockType *GetBlockValues(int32 lodLevel) const { return m_pBlockValues[lodLevel]; }
+    BlockWorldBlockDataType *GetBlockData(int32 lodLevel) { return m_pBlockData[lodLevel]; }
+
+    // blocks of one chunk of the column, in chunk order
+    const BlockWorldBlockType *GetChunkBlockValues(int32 lodLevel, int32 chunkZ) const { return m_pBlockValues[lodLevel] + GetChunkOffset(lodLevel, chunkZ); }
+    const BlockWorldBlockDataType *GetChunkBlockData(int32 lodLevel, int32 chunkZ) const { return m_pBlockData[lodLevel] + GetChunkOffset(lodLevel, chunkZ); }
+    uint32 GetChunkSolidBlockCount(int32 lodLevel, int32 chunkZ) const { return m_pSolidBlockCounts[lodLevel * GetChunkCount() + (chunkZ - m_minChunkZ)]; }
+
+    // builds the coarser lods from lod 0 the same way chunks do, and counts the solid blocks of every chunk
+    void BuildLODs();
+
+private:
+    int32 GetChunkCount() const { return (m_maxChunkZ - m_minChunkZ + 1); }
+    uint32 GetChunkOffset(int32 lodLevel, int32 chunkZ) const { int32 lodChunkSize = m_chunkSize >> lodLevel; return (uint32)((chunkZ - m_minChunkZ) * lodChunkSize * lodChunkSize * lodChunkSize); }
+    uint32 GetBlockIndex(int32 lx, int32 ly, int32 bz) const { return (uint32)(((bz - GetMinBlockZ()) * m_chunkSize * m_chunkSize) + (ly * m_chunkSize) + lx); }
+
+    int32 m_chunkSize;
+    int32 m_lodLevels;
+    int32 m_chunkX;
+    int32 m_chunkY;
+    int32 m_minChunkZ;
+    int32 m_maxChunkZ;
+
+    BlockWorldBlockType *m_pBlockValues[BLOCK_WORLD_MAX_LOD_LEVELS];
+    BlockWorldBlockDataType *m_pBlockData[BLOCK_WORLD_MAX_LOD_LEVELS];
+    uint32 *m_pSolidBlockCounts;
+};
+
 class BlockWorldGenerator
 {
 public:
@@ -16,6 +74,12 @@ public:
     virtual bool GetZRange(int32 startX, int32 startY, int32 endX, int32 endY, int32 *minBlockZ, int32 *maxBlockZ) const;
     virtual bool GenerateBlocks(int32 startX, int32 startY, int32 endX, int32 endY) const;
 
+    // Generators that can fill a section one chunk column at a time return true here. The world then creates the
+    // section and calls GenerateColumn for each column on the job workers, so it must not touch the world, and may be
+    // called for several columns at once. GenerateBlocks is still used when parallel generation is turned off.
+    virtual bool CanGenerateColumns() const;
+    virtual bool GenerateColumn(BlockWorldGeneratorColumn *pColumn) const;
+
 protected:
     // enumerate chunk coordinates for a specified section, returns global chunk coordinates
     template<typename T>
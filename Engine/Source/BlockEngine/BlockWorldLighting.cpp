@@ -0,0 +1,585 @@
+#include "BlockEngine/PrecompiledHeader.h"
+#include "BlockEngine/BlockWorldLighting.h"
+#include "BlockEngine/BlockWorld.h"
+#include "BlockEngine/BlockWorldSection.h"
+#include "BlockEngine/BlockWorldChunk.h"
+#include "BlockEngine/BlockWorldGenerator.h"
+#include "Engine/Engine.h"
+#include "Engine/JobSystem.h"
+Log_SetChannel(BlockWorldLighting);
+
+// block offsets for each CUBE_FACE
+static const int32 s_faceOffsets[CUBE_FACE_COUNT][3] = { { 1, 0, 0 }, { -1, 0, 0 }, { 0, 1, 0 }, { 0, -1, 0 }, { 0, 0, 1 }, { 0, 0, -1 } };
+
+// chunk sizes are powers of two, so block indices can be split with shifts
+static inline uint32 GetChunkSizeShift(int32 chunkSize)
+{
+    uint32 shift = 0;
+    while ((1 << shift) < chunkSize)
+        shift++;
+
+    return shift;
+}
+
+static inline uint32 GetChannelShift(BLOCK_WORLD_LIGHT_CHANNEL channel)
+{
+    return (channel == BLOCK_WORLD_LIGHT_CHANNEL_SKY) ? BLOCK_WORLD_BLOCK_DATA_SKY_LIGHTING_SHIFT : BLOCK_WORLD_BLOCK_DATA_LIGHTING_SHIFT;
+}
+
+static inline uint8 GetChannelLight(BlockWorldBlockDataType data, uint32 shift)
+{
+    return (uint8)((data >> shift) & 0xF);
+}
+
+static inline BlockWorldBlockDataType SetChannelLight(BlockWorldBlockDataType data, uint32 shift, uint8 lightLevel)
+{
+    return (BlockWorldBlockDataType)((data & ~(0xF << shift)) | ((uint32)lightLevel << shift));
+}
+
+// sky light at full strength travels straight down without fading
+static inline uint8 GetSpreadLight(BLOCK_WORLD_LIGHT_CHANNEL channel, uint32 face, uint8 lightLevel)
+{
+    if (channel == BLOCK_WORLD_LIGHT_CHANNEL_SKY && face == CUBE_FACE_BOTTOM && lightLevel == BLOCK_WORLD_MAX_LIGHT_LEVEL)
+        return BLOCK_WORLD_MAX_LIGHT_LEVEL;
+
+    return (lightLevel > 0) ? (lightLevel - 1) : 0;
+}
+
+BlockWorldLighting::LightNodeQueue::LightNodeQueue()
+    : m_pNodes(nullptr),
+      m_mask(0),
+      m_head(0),
+      m_tail(0)
+{
+
+}
+
+BlockWorldLighting::LightNodeQueue::~LightNodeQueue()
+{
+    Y_free(m_pNodes);
+}
+
+void BlockWorldLighting::LightNodeQueue::Push(BlockWorldChunk *pChunk, uint32 index, uint8 lightLevel)
+{
+    if (m_pNodes == nullptr || (m_tail - m_head) > m_mask)
+        Grow();
+
+    LightNode &node = m_pNodes[(m_tail++) & m_mask];
+    node.pChunk = pChunk;
+    node.Index = index;
+    node.LightLevel = lightLevel;
+}
+
+void BlockWorldLighting::LightNodeQueue::Grow()
+{
+    // unwrap the nodes into the new storage
+    uint32 count = m_tail - m_head;
+    uint32 newCapacity = (m_pNodes != nullptr) ? ((m_mask + 1) * 2) : 1024;
+    LightNode *pNewNodes = (LightNode *)Y_malloc(sizeof(LightNode) * newCapacity);
+    for (uint32 i = 0; i < count; i++)
+        pNewNodes[i] = m_pNodes[(m_head + i) & m_mask];
+
+    Y_free(m_pNodes);
+    m_pNodes = pNewNodes;
+    m_mask = newCapacity - 1;
+    m_head = 0;
+    m_tail = count;
+}
+
+BlockWorldLighting::BlockWorldLighting(BlockWorld *pWorld)
+    : m_pWorld(pWorld),
+      m_chunkSizeShift(0),
+      m_batchNodeCount(0),
+      m_batchTime(0.0f),
+      m_pBatchJobCounter(new JobCounter()),
+      m_batchInProgress(false)
+{
+
+}
+
+BlockWorldLighting::~BlockWorldLighting()
+{
+    EndBatch();
+    m_pBatchJobCounter->Release();
+}
+
+void BlockWorldLighting::QueueAddLight(int32 bx, int32 by, int32 bz, BLOCK_WORLD_LIGHT_CHANNEL channel, uint8 lightLevel)
+{
+    QueuedChange change = { bx, by, bz, CHANGE_TYPE_ADD, (uint8)channel, Min(lightLevel, (uint8)BLOCK_WORLD_MAX_LIGHT_LEVEL) };
+    m_queuedChanges.Add(change);
+}
+
+void BlockWorldLighting::QueueRemoveLight(int32 bx, int32 by, int32 bz, BLOCK_WORLD_LIGHT_CHANNEL channel)
+{
+    QueuedChange change = { bx, by, bz, CHANGE_TYPE_REMOVE, (uint8)channel, 0 };
+    m_queuedChanges.Add(change);
+}
+
+void BlockWorldLighting::QueueOpenBlock(int32 bx, int32 by, int32 bz)
+{
+    QueuedChange change = { bx, by, bz, CHANGE_TYPE_OPEN, 0, 0 };
+    m_queuedChanges.Add(change);
+}
+
+void BlockWorldLighting::InitializeSectionSkyLight(BlockWorldSection *pSection)
+{
+    DebugAssert(!m_batchInProgress);
+
+    const int32 chunkSize = pSection->GetChunkSize();
+    const int32 sectionSize = pSection->GetSectionSize();
+    PODArray<bool> openColumns;
+    openColumns.Resize(chunkSize * chunkSize);
+
+    // light falls straight down each column until something stops it, missing chunks are air
+    for (int32 chunkY = 0; chunkY < sectionSize; chunkY++)
+    {
+        for (int32 chunkX = 0; chunkX < sectionSize; chunkX++)
+        {
+            for (uint32 i = 0; i < openColumns.GetSize(); i++)
+                openColumns[i] = true;
+
+            for (int32 chunkZ = pSection->GetMaxChunkZ(); chunkZ >= pSection->GetMinChunkZ(); chunkZ--)
+            {
+                BlockWorldChunk *pChunk = pSection->GetChunk(chunkX, chunkY, chunkZ);
+                if (pChunk == nullptr)
+                    continue;
+
+                const BlockWorldBlockType *pBlockValues = pChunk->GetBlockValues(0);
+                BlockWorldBlockDataType *pBlockData = pChunk->GetBlockData(0);
+                for (int32 z = chunkSize - 1; z >= 0; z--)
+                {
+                    uint32 index = (uint32)(z * chunkSize * chunkSize);
+                    for (int32 column = 0; column < chunkSize * chunkSize; column++, index++)
+                    {
+                        if (openColumns[column] && m_pWorld->IsLightBlockingBlockValue(pBlockValues[index]))
+                            openColumns[column] = false;
+
+                        pBlockData[index] = (BlockWorldBlockDataType)BLOCK_WORLD_BLOCK_DATA_SET_SKY_LIGHTING(pBlockData[index], (openColumns[column]) ? BLOCK_WORLD_MAX_LIGHT_LEVEL : 0);
+                    }
+                }
+            }
+        }
+    }
+
+    // then it spreads sideways, under overhangs and into caves, with the next batch
+    QueueSectionSkyLightEdges(pSection);
+}
+
+void BlockWorldLighting::InitializeColumnSkyLight(BlockWorldGeneratorColumn *pColumn) const
+{
+    const int32 chunkSize = pColumn->GetChunkSize();
+    const int32 columnHeight = pColumn->GetMaxBlockZ() - pColumn->GetMinBlockZ() + 1;
+    const BlockWorldBlockType *pBlockValues = pColumn->GetBlockValues(0);
+    BlockWorldBlockDataType *pBlockData = pColumn->GetBlockData(0);
+    PODArray<bool> openColumns;
+    openColumns.Resize(chunkSize * chunkSize);
+    for (uint32 i = 0; i < openColumns.GetSize(); i++)
+        openColumns[i] = true;
+
+    // the same fall as InitializeSectionSkyLight, the column's chunks are contiguous so it is one pass down
+    for (int32 z = columnHeight - 1; z >= 0; z--)
+    {
+        uint32 index = (uint32)(z * chunkSize * chunkSize);
+        for (int32 column = 0; column < chunkSize * chunkSize; column++, index++)
+        {
+            if (openColumns[column] && m_pWorld->IsLightBlockingBlockValue(pBlockValues[index]))
+                openColumns[column] = false;
+
+            pBlockData[index] = (BlockWorldBlockDataType)BLOCK_WORLD_BLOCK_DATA_SET_SKY_LIGHTING(pBlockData[index], (openColumns[column]) ? BLOCK_WORLD_MAX_LIGHT_LEVEL : 0);
+        }
+    }
+}
+
+void BlockWorldLighting::QueueSectionSkyLightEdges(BlockWorldSection *pSection)
+{
+    DebugAssert(!m_batchInProgress);
+    pSection->EnumerateChunks([this](BlockWorldChunk *pChunk) { QueueSkyLightEdges(pChunk); });
+}
+
+void BlockWorldLighting::InitializeChunkSkyLight(BlockWorldChunk *pChunk)
+{
+    DebugAssert(!m_batchInProgress);
+
+    // generated sections are lit in one go once they are complete
+    if (pChunk->GetSection()->GetLoadState() == BlockWorldSection::LoadState_Generating)
+        return;
+
+    const int32 chunkSize = pChunk->GetChunkSize();
+    const int32 chunkX = pChunk->GetGlobalChunkX();
+    const int32 chunkY = pChunk->GetGlobalChunkY();
+    const int32 chunkZ = pChunk->GetGlobalChunkZ();
+    BlockWorldChunk *pAboveChunk = m_pWorld->GetChunk(chunkX, chunkY, chunkZ + 1);
+    if (pAboveChunk == nullptr || pAboveChunk->GetLoadedLODLevel() != 0)
+    {
+        // a new chunk is empty, so with nothing above it is all open to the sky
+        uint32 blockCount = (uint32)(chunkSize * chunkSize * chunkSize);
+        BlockWorldBlockDataType *pBlockData = pChunk->GetBlockData(0);
+        for (uint32 i = 0; i < blockCount; i++)
+            pBlockData[i] = (BlockWorldBlockDataType)BLOCK_WORLD_BLOCK_DATA_SET_SKY_LIGHTING(pBlockData[i], BLOCK_WORLD_MAX_LIGHT_LEVEL);
+
+        QueueSkyLightEdges(pChunk);
+        return;
+    }
+
+    // otherwise it comes down from the bottom layer of the chunk above
+    const BlockWorldBlockDataType *pAboveBlockData = pAboveChunk->GetBlockData(0);
+    for (int32 y = 0; y < chunkSize; y++)
+    {
+        for (int32 x = 0; x < chunkSize; x++)
+        {
+            uint8 lightLevel = BLOCK_WORLD_BLOCK_DATA_GET_SKY_LIGHTING(pAboveBlockData[y * chunkSize + x]);
+            if (lightLevel > 1)
+                QueueAddLight(chunkX * chunkSize + x, chunkY * chunkSize + y, (chunkZ + 1) * chunkSize, BLOCK_WORLD_LIGHT_CHANNEL_SKY, lightLevel);
+        }
+    }
+}
+
+void BlockWorldLighting::QueueSkyLightEdges(BlockWorldChunk *pChunk)
+{
+    static const CUBE_FACE horizontalFaces[4] = { CUBE_FACE_RIGHT, CUBE_FACE_LEFT, CUBE_FACE_BACK, CUBE_FACE_FRONT };
+
+    const int32 chunkSize = pChunk->GetChunkSize();
+    const uint32 blockCount = (uint32)(chunkSize * chunkSize * chunkSize);
+    const BlockWorldBlockDataType *pBlockData = pChunk->GetBlockData(0);
+    m_chunkSizeShift = GetChunkSizeShift(chunkSize);
+
+    for (uint32 index = 0; index < blockCount; index++)
+    {
+        if (BLOCK_WORLD_BLOCK_DATA_GET_SKY_LIGHTING(pBlockData[index]) != BLOCK_WORLD_MAX_LIGHT_LEVEL)
+            continue;
+
+        for (uint32 i = 0; i < countof(horizontalFaces); i++)
+        {
+            BlockWorldChunk *pNeighbourChunk;
+            uint32 neighbourIndex;
+            if (!GetNeighbour(pChunk, index, horizontalFaces[i], &pNeighbourChunk, &neighbourIndex, nullptr))
+                continue;
+
+            if (BLOCK_WORLD_BLOCK_DATA_GET_SKY_LIGHTING(pNeighbourChunk->GetBlockData(0)[neighbourIndex]) < (BLOCK_WORLD_MAX_LIGHT_LEVEL - 1) &&
+                !m_pWorld->IsLightBlockingBlockValue(pNeighbourChunk->GetBlockValues(0)[neighbourIndex]))
+            {
+                int32 x = (int32)(index & (chunkSize - 1));
+                int32 y = (int32)((index >> m_chunkSizeShift) & (chunkSize - 1));
+                int32 z = (int32)(index >> (m_chunkSizeShift * 2));
+                QueueAddLight(pChunk->GetGlobalChunkX() * chunkSize + x, pChunk->GetGlobalChunkY() * chunkSize + y, pChunk->GetGlobalChunkZ() * chunkSize + z, BLOCK_WORLD_LIGHT_CHANNEL_SKY, BLOCK_WORLD_MAX_LIGHT_LEVEL);
+                break;
+            }
+        }
+    }
+}
+
+bool BlockWorldLighting::GetNeighbour(BlockWorldChunk *pChunk, uint32 index, CUBE_FACE face, BlockWorldChunk **ppNeighbourChunk, uint32 *pNeighbourIndex, int3 *pNeighbourPosition) const
+{
+    const int32 chunkSize = pChunk->GetChunkSize();
+    const int32 chunkSizeMask = chunkSize - 1;
+    int32 x = (int32)(index & chunkSizeMask) + s_faceOffsets[face][0];
+    int32 y = (int32)((index >> m_chunkSizeShift) & chunkSizeMask) + s_faceOffsets[face][1];
+    int32 z = (int32)(index >> (m_chunkSizeShift * 2)) + s_faceOffsets[face][2];
+
+    // fast path, still in this chunk
+    if ((uint32)x < (uint32)chunkSize && (uint32)y < (uint32)chunkSize && (uint32)z < (uint32)chunkSize)
+    {
+        *ppNeighbourChunk = pChunk;
+        *pNeighbourIndex = (uint32)((z << (m_chunkSizeShift * 2)) | (y << m_chunkSizeShift) | x);
+        return true;
+    }
+
+    // crossing into the adjacent chunk, only one axis can be out of range
+    int32 chunkX = pChunk->GetGlobalChunkX() + ((x < 0) ? -1 : ((x >= chunkSize) ? 1 : 0));
+    int32 chunkY = pChunk->GetGlobalChunkY() + ((y < 0) ? -1 : ((y >= chunkSize) ? 1 : 0));
+    int32 chunkZ = pChunk->GetGlobalChunkZ() + ((z < 0) ? -1 : ((z >= chunkSize) ? 1 : 0));
+    x &= chunkSizeMask;
+    y &= chunkSizeMask;
+    z &= chunkSizeMask;
+
+    BlockWorldChunk *pNeighbourChunk = m_pWorld->GetChunk(chunkX, chunkY, chunkZ);
+    if (pNeighbourChunk == nullptr || pNeighbourChunk->GetLoadedLODLevel() != 0)
+    {
+        if (pNeighbourPosition != nullptr)
+            *pNeighbourPosition = int3(chunkX * chunkSize + x, chunkY * chunkSize + y, chunkZ * chunkSize + z);
+
+        return false;
+    }
+
+    *ppNeighbourChunk = pNeighbourChunk;
+    *pNeighbourIndex = (uint32)((z << (m_chunkSizeShift * 2)) | (y << m_chunkSizeShift) | x);
+    return true;
+}
+
+void BlockWorldLighting::MarkChanged(BlockWorldChunk *pChunk, uint32 index)
+{
+    const uint32 chunkSizeMask = (uint32)pChunk->GetChunkSize() - 1;
+    uint32 x = index & chunkSizeMask;
+    uint32 y = (index >> m_chunkSizeShift) & chunkSizeMask;
+    uint32 z = index >> (m_chunkSizeShift * 2);
+
+    uint32 edgeMask = 0;
+    edgeMask |= (x == chunkSizeMask) ? (1 << CUBE_FACE_RIGHT) : ((x == 0) ? (1 << CUBE_FACE_LEFT) : 0);
+    edgeMask |= (y == chunkSizeMask) ? (1 << CUBE_FACE_BACK) : ((y == 0) ? (1 << CUBE_FACE_FRONT) : 0);
+    edgeMask |= (z == chunkSizeMask) ? (1 << CUBE_FACE_TOP) : ((z == 0) ? (1 << CUBE_FACE_BOTTOM) : 0);
+
+    if (!pChunk->IsLightingChanged())
+        m_changedChunks.Add(pChunk);
+
+    pChunk->SetLightingChanged(edgeMask);
+}
+
+void BlockWorldLighting::BeginBatch(bool parallel)
+{
+    DebugAssert(!m_batchInProgress);
+    if (m_queuedChanges.IsEmpty())
+        return;
+
+    // the main thread keeps queueing into the other list
+    m_batchChanges.Swap(m_queuedChanges);
+    m_chunkSizeShift = GetChunkSizeShift(m_pWorld->GetChunkSize());
+    m_batchInProgress = true;
+
+    if (!parallel)
+    {
+        RunBatch();
+        return;
+    }
+
+    g_pEngine->GetJobSystem()->Run([this]()
+    {
+        RunBatch();
+    }, m_pBatchJobCounter);
+}
+
+void BlockWorldLighting::EndBatch()
+{
+    if (!m_batchInProgress)
+        return;
+
+    g_pEngine->GetJobSystem()->WaitFor(m_pBatchJobCounter);
+    m_batchInProgress = false;
+
+    if (m_batchTime > 10.0f)
+        Log_PerfPrintf("Lighting batch of %u changes visited %u blocks in %u chunks, took %.4fms", m_batchChanges.GetSize(), m_batchNodeCount, m_changedChunks.GetSize(), m_batchTime);
+
+    m_batchChanges.Clear();
+
+    // re-mesh everything that was touched, once
+    for (BlockWorldChunk *pChunk : m_changedChunks)
+    {
+        m_pWorld->OnChunkLightingChanged(pChunk, pChunk->GetLightingChangedEdges());
+        pChunk->ClearLightingChanged();
+    }
+    m_changedChunks.Clear();
+
+    // block light that reached missing chunks in loaded sections creates them, as the light has to be stored somewhere.
+    // sky light doesn't, a missing chunk is already open to the sky.
+    for (const QueuedChange &change : m_spilledChanges)
+    {
+        int32 sectionX, sectionY, chunkX, chunkY, chunkZ, localX, localY, localZ;
+        m_pWorld->SplitCoordinates(&sectionX, &sectionY, &chunkX, &chunkY, &chunkZ, &localX, &localY, &localZ, change.BlockX, change.BlockY, change.BlockZ);
+
+        const BlockWorldSection *pSection = m_pWorld->GetSection(sectionX, sectionY);
+        if (pSection == nullptr || pSection->GetLoadedLODLevel() != 0)
+            continue;
+
+        m_pWorld->SplitCoordinates(&chunkX, &chunkY, &chunkZ, &localX, &localY, &localZ, change.BlockX, change.BlockY, change.BlockZ);
+        if (m_pWorld->GetWritableChunk(chunkX, chunkY, chunkZ, true) != nullptr)
+            m_queuedChanges.Add(change);
+    }
+    m_spilledChanges.Clear();
+}
+
+void BlockWorldLighting::RunBatch()
+{
+    Timer batchTimer;
+    m_batchNodeCount = 0;
+
+    // removals run to completion first, so light from a removed source can't cut off a new one placed in its range.
+    // the blocks left lit at the edges of the removed light are queued to spread back in afterwards.
+    for (const QueuedChange &change : m_batchChanges)
+    {
+        if (change.Type == CHANGE_TYPE_REMOVE)
+            ApplyChange(change, m_removeQueues[change.Channel], m_addQueues[change.Channel]);
+    }
+    for (uint32 channel = 0; channel < NUM_BLOCK_WORLD_LIGHT_CHANNELS; channel++)
+        PropagateRemovals((BLOCK_WORLD_LIGHT_CHANNEL)channel, m_removeQueues[channel], m_addQueues[channel]);
+
+    for (const QueuedChange &change : m_batchChanges)
+    {
+        if (change.Type != CHANGE_TYPE_REMOVE)
+            ApplyChange(change, m_removeQueues[change.Channel], m_addQueues[change.Channel]);
+    }
+    for (uint32 channel = 0; channel < NUM_BLOCK_WORLD_LIGHT_CHANNELS; channel++)
+        PropagateAdditions((BLOCK_WORLD_LIGHT_CHANNEL)channel, m_addQueues[channel]);
+
+    m_batchTime = (float)batchTimer.GetTimeMilliseconds();
+}
+
+void BlockWorldLighting::ApplyChange(const QueuedChange &change, LightNodeQueue &removeQueue, LightNodeQueue &addQueue)
+{
+    // the chunk may have gone since the change was queued
+    int32 chunkX, chunkY, chunkZ, localX, localY, localZ;
+    m_pWorld->SplitCoordinates(&chunkX, &chunkY, &chunkZ, &localX, &localY, &localZ, change.BlockX, change.BlockY, change.BlockZ);
+    BlockWorldChunk *pChunk = m_pWorld->GetChunk(chunkX, chunkY, chunkZ);
+    if (pChunk == nullptr || pChunk->GetLoadedLODLevel() != 0)
+        return;
+
+    uint32 index = (uint32)((localZ << (m_chunkSizeShift * 2)) | (localY << m_chunkSizeShift) | localX);
+    BlockWorldBlockDataType &blockData = pChunk->GetBlockData(0)[index];
+    switch (change.Type)
+    {
+    case CHANGE_TYPE_REMOVE:
+        {
+            uint32 shift = GetChannelShift((BLOCK_WORLD_LIGHT_CHANNEL)change.Channel);
+            uint8 lightLevel = GetChannelLight(blockData, shift);
+            if (lightLevel > 0)
+            {
+                blockData = SetChannelLight(blockData, shift, 0);
+                MarkChanged(pChunk, index);
+                removeQueue.Push(pChunk, index, lightLevel);
+            }
+        }
+        break;
+
+    case CHANGE_TYPE_OPEN:
+        {
+            // pull the light in from every neighbour, on both channels
+            for (uint32 face = 0; face < CUBE_FACE_COUNT; face++)
+            {
+                BlockWorldChunk *pNeighbourChunk;
+                uint32 neighbourIndex;
+                if (!GetNeighbour(pChunk, index, (CUBE_FACE)face, &pNeighbourChunk, &neighbourIndex, nullptr))
+                {
+                    // nothing above is open sky
+                    if (face == CUBE_FACE_TOP)
+                    {
+                        blockData = (BlockWorldBlockDataType)BLOCK_WORLD_BLOCK_DATA_SET_SKY_LIGHTING(blockData, BLOCK_WORLD_MAX_LIGHT_LEVEL);
+                        MarkChanged(pChunk, index);
+                        m_addQueues[BLOCK_WORLD_LIGHT_CHANNEL_SKY].Push(pChunk, index, BLOCK_WORLD_MAX_LIGHT_LEVEL);
+                    }
+
+                    continue;
+                }
+
+                BlockWorldBlockDataType neighbourData = pNeighbourChunk->GetBlockData(0)[neighbourIndex];
+                if (BLOCK_WORLD_BLOCK_DATA_GET_LIGHTING(neighbourData) > 1)
+                    m_addQueues[BLOCK_WORLD_LIGHT_CHANNEL_BLOCK].Push(pNeighbourChunk, neighbourIndex, BLOCK_WORLD_BLOCK_DATA_GET_LIGHTING(neighbourData));
+                if (BLOCK_WORLD_BLOCK_DATA_GET_SKY_LIGHTING(neighbourData) > 1)
+                    m_addQueues[BLOCK_WORLD_LIGHT_CHANNEL_SKY].Push(pNeighbourChunk, neighbourIndex, BLOCK_WORLD_BLOCK_DATA_GET_SKY_LIGHTING(neighbourData));
+            }
+        }
+        break;
+
+    case CHANGE_TYPE_ADD:
+        {
+            uint32 shift = GetChannelShift((BLOCK_WORLD_LIGHT_CHANNEL)change.Channel);
+            uint8 lightLevel = GetChannelLight(blockData, shift);
+            if (change.LightLevel > lightLevel)
+            {
+                lightLevel = change.LightLevel;
+                blockData = SetChannelLight(blockData, shift, lightLevel);
+                MarkChanged(pChunk, index);
+            }
+
+            addQueue.Push(pChunk, index, lightLevel);
+        }
+        break;
+    }
+}
+
+void BlockWorldLighting::PropagateRemovals(BLOCK_WORLD_LIGHT_CHANNEL channel, LightNodeQueue &removeQueue, LightNodeQueue &addQueue)
+{
+    const BlockPalette *pPalette = m_pWorld->GetPalette();
+    const uint32 shift = GetChannelShift(channel);
+
+    while (!removeQueue.IsEmpty())
+    {
+        LightNode node = removeQueue.Pop();
+        m_batchNodeCount++;
+
+        for (uint32 face = 0; face < CUBE_FACE_COUNT; face++)
+        {
+            BlockWorldChunk *pNeighbourChunk;
+            uint32 neighbourIndex;
+            if (!GetNeighbour(node.pChunk, node.Index, (CUBE_FACE)face, &pNeighbourChunk, &neighbourIndex, nullptr))
+                continue;
+
+            BlockWorldBlockDataType &neighbourData = pNeighbourChunk->GetBlockData(0)[neighbourIndex];
+            uint8 neighbourLevel = GetChannelLight(neighbourData, shift);
+            if (neighbourLevel == 0)
+                continue;
+
+            // anything dimmer than this node was lit by it, anything as bright or brighter is lit from elsewhere and has
+            // to spread back into the removed area
+            if (neighbourLevel < node.LightLevel || (neighbourLevel == BLOCK_WORLD_MAX_LIGHT_LEVEL && GetSpreadLight(channel, face, node.LightLevel) == BLOCK_WORLD_MAX_LIGHT_LEVEL))
+            {
+                neighbourData = SetChannelLight(neighbourData, shift, 0);
+                MarkChanged(pNeighbourChunk, neighbourIndex);
+                removeQueue.Push(pNeighbourChunk, neighbourIndex, neighbourLevel);
+
+                // an emitter caught in the removal lights itself again
+                BlockWorldBlockType neighbourValue = pNeighbourChunk->GetBlockValues(0)[neighbourIndex];
+                if (channel == BLOCK_WORLD_LIGHT_CHANNEL_BLOCK && neighbourValue != 0 && (neighbourValue & BLOCK_WORLD_BLOCK_VALUE_COLORED_FLAG_BIT) == 0)
+                {
+                    const BlockPalette::BlockType *pBlockType = pPalette->GetBlockType(neighbourValue);
+                    if (pBlockType->Flags & BLOCK_MESH_BLOCK_TYPE_FLAG_BLOCK_LIGHT_EMITTER)
+                    {
+                        uint8 emitterLevel = (uint8)Min(pBlockType->BlockLightEmitterSettings.Radius, (uint32)BLOCK_WORLD_MAX_LIGHT_LEVEL);
+                        neighbourData = SetChannelLight(neighbourData, shift, emitterLevel);
+                        addQueue.Push(pNeighbourChunk, neighbourIndex, emitterLevel);
+                    }
+                }
+            }
+            else
+            {
+                addQueue.Push(pNeighbourChunk, neighbourIndex, neighbourLevel);
+            }
+        }
+    }
+}
+
+void BlockWorldLighting::PropagateAdditions(BLOCK_WORLD_LIGHT_CHANNEL channel, LightNodeQueue &addQueue)
+{
+    const uint32 shift = GetChannelShift(channel);
+
+    while (!addQueue.IsEmpty())
+    {
+        LightNode node = addQueue.Pop();
+        m_batchNodeCount++;
+
+        // the node may have been lit brighter since it was queued, in which case that one spreads further
+        uint8 lightLevel = GetChannelLight(node.pChunk->GetBlockData(0)[node.Index], shift);
+        if (lightLevel != node.LightLevel)
+            continue;
+
+        for (uint32 face = 0; face < CUBE_FACE_COUNT; face++)
+        {
+            uint8 spreadLevel = GetSpreadLight(channel, face, lightLevel);
+            if (spreadLevel == 0)
+                continue;
+
+            BlockWorldChunk *pNeighbourChunk;
+            uint32 neighbourIndex;
+            int3 neighbourPosition;
+            if (!GetNeighbour(node.pChunk, node.Index, (CUBE_FACE)face, &pNeighbourChunk, &neighbourIndex, &neighbourPosition))
+            {
+                if (channel == BLOCK_WORLD_LIGHT_CHANNEL_BLOCK)
+                {
+                    QueuedChange change = { neighbourPosition.x, neighbourPosition.y, neighbourPosition.z, CHANGE_TYPE_ADD, (uint8)channel, spreadLevel };
+                    m_spilledChanges.Add(change);
+                }
+
+                continue;
+            }
+
+            // light can't pass into solid blocks
+            if (m_pWorld->IsLightBlockingBlockValue(pNeighbourChunk->GetBlockValues(0)[neighbourIndex]))
+                continue;
+
+            BlockWorldBlockDataType &neighbourData = pNeighbourChunk->GetBlockData(0)[neighbourIndex];
+            if (GetChannelLight(neighbourData, shift) < spreadLevel)
+            {
+                neighbourData = SetChannelLight(neighbourData, shift, spreadLevel);
+                MarkChanged(pNeighbourChunk, neighbourIndex);
+                addQueue.Push(pNeighbourChunk, neighbourIndex, spreadLevel);
+            }
+        }
+    }
+}
@@ -0,0 +1,122 @@
+#pragma once
+#include "BlockEngine/BlockWorldTypes.h"
+
+class JobCounter;
+class BlockWorldGeneratorColumn;
+
+// Propagates block and sky light through the world's lod 0 data. Changes made to the world are queued, and applied in
+// one batch per frame: removals first, then additions, each as a breadth-first flood through ring-buffer queues. Nodes
+// are kept as a chunk and a block index, so steps within a chunk don't need any lookups. The batch can run on the job
+// system while the frame is rendered, the world finishes it before anything else reads or writes block data.
+class BlockWorldLighting
+{
+public:
+    BlockWorldLighting(BlockWorld *pWorld);
+    ~BlockWorldLighting();
+
+    // queue changes in global block coordinates, main thread only
+    void QueueAddLight(int32 bx, int32 by, int32 bz, BLOCK_WORLD_LIGHT_CHANNEL channel, uint8 lightLevel);
+    void QueueRemoveLight(int32 bx, int32 by, int32 bz, BLOCK_WORLD_LIGHT_CHANNEL channel);
+
+    // a light-blocking block was removed, so the light around it can flow in
+    void QueueOpenBlock(int32 bx, int32 by, int32 bz);
+
+    // sets the sky light of a generated section column by column, and queues the lit blocks next to shade for spreading
+    void InitializeSectionSkyLight(BlockWorldSection *pSection);
+
+    // sets the sky light of a column being generated on a job worker, it only reads the palette so is safe there.
+    // once the column's chunks are in the world, QueueSectionSkyLightEdges spreads it.
+    void InitializeColumnSkyLight(BlockWorldGeneratorColumn *pColumn) const;
+    void QueueSectionSkyLightEdges(BlockWorldSection *pSection);
+
+    // sets the sky light of a chunk created in an existing section
+    void InitializeChunkSkyLight(BlockWorldChunk *pChunk);
+
+    // batch state
+    bool HasQueuedChanges() const { return (m_queuedChanges.GetSize() > 0); }
+    bool IsBatchInProgress() const { return m_batchInProgress; }
+
+    // starts applying the queued changes, on the job system if parallel is set
+    void BeginBatch(bool parallel);
+
+    // waits for the batch in progress, then hands the changed chunks to the world, and queues any light that ran into
+    // chunks that don't exist yet for the next batch. does nothing if there is no batch in progress.
+    void EndBatch();
+
+private:
+    enum CHANGE_TYPE
+    {
+        CHANGE_TYPE_REMOVE,
+        CHANGE_TYPE_OPEN,
+        CHANGE_TYPE_ADD,
+    };
+
+    struct QueuedChange
+    {
+        int32 BlockX, BlockY, BlockZ;
+        uint8 Type;
+        uint8 Channel;
+        uint8 LightLevel;
+    };
+
+    struct LightNode
+    {
+        BlockWorldChunk *pChunk;
+        uint32 Index;
+        uint8 LightLevel;
+    };
+
+    // fifo of light nodes, grows by doubling and keeps its storage between batches
+    class LightNodeQueue
+    {
+    public:
+        LightNodeQueue();
+        ~LightNodeQueue();
+
+        bool IsEmpty() const { return (m_head == m_tail); }
+        void Push(BlockWorldChunk *pChunk, uint32 index, uint8 lightLevel);
+        const LightNode &Pop() { return m_pNodes[(m_head++) & m_mask]; }
+
+    private:
+        void Grow();
+
+        LightNode *m_pNodes;
+        uint32 m_mask;
+        uint32 m_head;
+        uint32 m_tail;
+    };
+
+    // runs the queued changes, on a job worker or inline
+    void RunBatch();
+    void ApplyChange(const QueuedChange &change, LightNodeQueue &removeQueue, LightNodeQueue &addQueue);
+    void PropagateRemovals(BLOCK_WORLD_LIGHT_CHANNEL channel, LightNodeQueue &removeQueue, LightNodeQueue &addQueue);
+    void PropagateAdditions(BLOCK_WORLD_LIGHT_CHANNEL channel, LightNodeQueue &addQueue);
+
+    // steps to the neighbouring block on a face, moving to the adjacent chunk at the edges. returns false if that chunk
+    // isn't loaded, in which case the neighbour's global coordinates are still written.
+    bool GetNeighbour(BlockWorldChunk *pChunk, uint32 index, CUBE_FACE face, BlockWorldChunk **ppNeighbourChunk, uint32 *pNeighbourIndex, int3 *pNeighbourPosition) const;
+
+    // flags the chunk for the world to re-mesh when the batch ends
+    void MarkChanged(BlockWorldChunk *pChunk, uint32 index);
+
+    // queues sky-lit blocks of a chunk that have an unlit, open horizontal neighbour
+    void QueueSkyLightEdges(BlockWorldChunk *pChunk);
+
+    BlockWorld *m_pWorld;
+    uint32 m_chunkSizeShift;
+
+    // changes queued by the main thread, and the ones the batch is working on
+    MemArray<QueuedChange> m_queuedChanges;
+    MemArray<QueuedChange> m_batchChanges;
+
+    // batch working state
+    LightNodeQueue m_removeQueues[NUM_BLOCK_WORLD_LIGHT_CHANNELS];
+    LightNodeQueue m_addQueues[NUM_BLOCK_WORLD_LIGHT_CHANNELS];
+    PODArray<BlockWorldChunk *> m_changedChunks;
+    MemArray<QueuedChange> m_spilledChanges;
+    uint32 m_batchNodeCount;
+    float m_batchTime;
+
+    JobCounter *m_pBatchJobCounter;
+    bool m_batchInProgress;
+};
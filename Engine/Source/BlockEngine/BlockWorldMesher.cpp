@@ -70,20 +70,88 @@ static const float BLOCK_ROTATION_MATRIX_LUT[NUM_BLOCK_WORLD_BLOCK_ROTATIONS][4]
 
 };
 
-BlockWorldMesher::BlockWorldMesher(const BlockPalette *pPalette, uint32 chunkSize, uint32 lodLevel, const float3 &basePosition, bool generateLightMaps)
-    : m_pPalette(pPalette),
-      m_chunkSize(chunkSize),
-      m_lodLevel(lodLevel),
-      m_basePosition(basePosition),
-      m_generateLightMaps(generateLightMaps)
+// meshers waiting to be reused, bounded so a burst of meshing doesn't hold on to the memory forever
+static const uint32 MAX_POOLED_MESHERS = 32;
+struct BlockWorldMesherPool
 {
-    m_pBlockValues = new BlockWorldBlockType[chunkSize * chunkSize * chunkSize];
-    m_pBlockData = new BlockWorldBlockDataType[chunkSize * chunkSize * chunkSize];
-    m_pBlockFaceMasks = new uint8[chunkSize * chunkSize * chunkSize];
-    Y_memzero(m_pBlockFaceMasks, sizeof(uint8) * chunkSize * chunkSize * chunkSize);
+    Mutex Lock;
+    PODArray<BlockWorldMesher *> FreeMeshers;
 
+    ~BlockWorldMesherPool()
+    {
+        for (BlockWorldMesher *pMesher : FreeMeshers)
+            delete pMesher;
+    }
+};
+static BlockWorldMesherPool s_mesherPool;
+
+BlockWorldMesher::BlockWorldMesher(const BlockPalette *pPalette, uint32 chunkSize, uint32 lodLevel, const float3 &basePosition, bool generateLightMaps)
+    : m_pBlockValues(nullptr),
+      m_pBlockData(nullptr),
+      m_pBlockFaceMasks(nullptr),
+      m_volumeCapacity(0),
+      m_packVertices(false)
+{
     m_output.BoundingBox = AABox::Zero;
     m_output.BoundingSphere = Sphere::Zero;
+    Initialize(pPalette, chunkSize, lodLevel, basePosition, generateLightMaps);
+}
+
+void BlockWorldMesher::Initialize(const BlockPalette *pPalette, uint32 chunkSize, uint32 lodLevel, const float3 &basePosition, bool generateLightMaps)
+{
+    m_pPalette = pPalette;
+    m_chunkSize = chunkSize;
+    m_lodLevel = lodLevel;
+    m_basePosition = basePosition;
+    m_generateLightMaps = generateLightMaps;
+
+    // the volume size depends on the lod, so keep the largest one allocated
+    uint32 volumeSize = chunkSize * chunkSize * chunkSize;
+    if (volumeSize > m_volumeCapacity)
+    {
+        delete[] m_pBlockFaceMasks;
+        delete[] m_pBlockData;
+        delete[] m_pBlockValues;
+        m_pBlockValues = new BlockWorldBlockType[volumeSize];
+        m_pBlockData = new BlockWorldBlockDataType[volumeSize];
+        m_pBlockFaceMasks = new uint8[volumeSize];
+        m_volumeCapacity = volumeSize;
+    }
+
+    Y_memzero(m_pBlockFaceMasks, sizeof(uint8) * volumeSize);
+}
+
+BlockWorldMesher *BlockWorldMesher::Allocate(const BlockPalette *pPalette, uint32 chunkSize, uint32 lodLevel, const float3 &basePosition, bool generateLightMaps)
+{
+    BlockWorldMesher *pMesher = nullptr;
+    {
+        MutexLock lock(s_mesherPool.Lock);
+        if (!s_mesherPool.FreeMeshers.IsEmpty())
+            pMesher = s_mesherPool.FreeMeshers.PopBack();
+    }
+
+    if (pMesher == nullptr)
+        return new BlockWorldMesher(pPalette, chunkSize, lodLevel, basePosition, generateLightMaps);
+
+    // the output keeps its capacity from the previous chunk
+    ResetOutput(pMesher->m_output);
+    pMesher->m_packVertices = false;
+    pMesher->Initialize(pPalette, chunkSize, lodLevel, basePosition, generateLightMaps);
+    return pMesher;
+}
+
+void BlockWorldMesher::Free(BlockWorldMesher *pMesher)
+{
+    {
+        MutexLock lock(s_mesherPool.Lock);
+        if (s_mesherPool.FreeMeshers.GetSize() < MAX_POOLED_MESHERS)
+        {
+            s_mesherPool.FreeMeshers.Add(pMesher);
+            return;
+        }
+    }
+
+    delete pMesher;
 }
 
 BlockWorldMesher::~BlockWorldMesher()
@@ -272,21 +340,22 @@ const uint32 BlockWorldMesher::CalculateCubeFaceLighting(uint32 x, uint32 y, uin
     const uint32 yStride = m_chunkSize;
     const uint32 zStride = yStride * m_chunkSize;
 
-    uint8 lightLevel = 0;
+    BlockWorldBlockDataType blockData = 0;
     switch (faceIndex)
     {
-    case CUBE_FACE_LEFT:    lightLevel = BLOCK_DATA_ARRAY_ACCESS(x - 1, y, z);  break;
-    case CUBE_FACE_RIGHT:   lightLevel = BLOCK_DATA_ARRAY_ACCESS(x + 1, y, z);  break;
-    case CUBE_FACE_FRONT:   lightLevel = BLOCK_DATA_ARRAY_ACCESS(x, y - 1, z);  break;
-    case CUBE_FACE_BACK:    lightLevel = BLOCK_DATA_ARRAY_ACCESS(x, y + 1, z);  break;
-    case CUBE_FACE_BOTTOM:  lightLevel = BLOCK_DATA_ARRAY_ACCESS(x, y, z - 1);  break;
-    case CUBE_FACE_TOP:     lightLevel = BLOCK_DATA_ARRAY_ACCESS(x, y, z + 1);  break;
+    case CUBE_FACE_LEFT:    blockData = BLOCK_DATA_ARRAY_ACCESS(x - 1, y, z);  break;
+    case CUBE_FACE_RIGHT:   blockData = BLOCK_DATA_ARRAY_ACCESS(x + 1, y, z);  break;
+    case CUBE_FACE_FRONT:   blockData = BLOCK_DATA_ARRAY_ACCESS(x, y - 1, z);  break;
+    case CUBE_FACE_BACK:    blockData = BLOCK_DATA_ARRAY_ACCESS(x, y + 1, z);  break;
+    case CUBE_FACE_BOTTOM:  blockData = BLOCK_DATA_ARRAY_ACCESS(x, y, z - 1);  break;
+    case CUBE_FACE_TOP:     blockData = BLOCK_DATA_ARRAY_ACCESS(x, y, z + 1);  break;
     }
 
-    return (uint32)BLOCK_WORLD_BLOCK_DATA_GET_LIGHTING(lightLevel);
+    // the brighter of the block and sky light
+    return (uint32)Max(BLOCK_WORLD_BLOCK_DATA_GET_LIGHTING(blockData), BLOCK_WORLD_BLOCK_DATA_GET_SKY_LIGHTING(blockData));
 }
 
-void BlockWorldMesher::GenerateBlocks(uint3 &minBlockCoordinates, uint3 &maxBlockCoordinates)
+void BlockWorldMesher::GenerateBlocks(Output &output, uint3 &minBlockCoordinates, uint3 &maxBlockCoordinates)
 {
     const uint32 yStride = m_chunkSize;
     const uint32 zStride = yStride * m_chunkSize;
@@ -471,15 +540,15 @@ void BlockWorldMesher::GenerateBlocks(uint3 &minBlockCoordinates, uint3 &maxBloc
                         // set slice axis
                         blockCoordinates[sliceAxis] = baseCoordinates[sliceAxis];
 
-                        // forward...
-                        if (sweepAxis0 >= 0 && sweepAxis1 >= 0)
+                        // forward... faces that can't tile vertically can still be merged along axis 0
+                        if (sweepAxis0 >= 0)
                         {
                             {
                                 // axis 0
+                                Y_memcpy(blockCoordinates, baseCoordinates, sizeof(blockCoordinates));
                                 for (i = quadBoundaries[0][sweepAxis0] + 1; i < volumeSizeMinusOne; i++)
                                 {
                                     blockCoordinates[sweepAxis0] = i;
-                                    blockCoordinates[sweepAxis1] = baseCoordinates[sweepAxis1];
                                     uint32 searchBlockValue = BLOCK_VALUE_ARRAY_ACCESS(blockCoordinates[0], blockCoordinates[1], blockCoordinates[2]);
                                     uint8 searchBlockRotation = BLOCK_WORLD_BLOCK_DATA_GET_ROTATION(BLOCK_DATA_ARRAY_ACCESS(blockCoordinates[0], blockCoordinates[1], blockCoordinates[2]));
                                     uint8 searchFaceMask = BLOCK_FACEMASK_ARRAY_ACCESS(blockCoordinates[0], blockCoordinates[1], blockCoordinates[2]);
@@ -497,6 +566,7 @@ void BlockWorldMesher::GenerateBlocks(uint3 &minBlockCoordinates, uint3 &maxBloc
                             }
 
                             // axis 1
+                            if (sweepAxis1 >= 0)
                             {
                                 for (i = quadBoundaries[0][sweepAxis1] + 1; i < volumeSizeMinusOne; i++)
                                 {
@@ -551,15 +621,15 @@ void BlockWorldMesher::GenerateBlocks(uint3 &minBlockCoordinates, uint3 &maxBloc
                         switch (shapeType)
                         {
                         case BLOCK_MESH_BLOCK_TYPE_SHAPE_TYPE_CUBE:
-                            AddCubeBlockFace(pBlockType, blockValue, blockLighting, blockRotation, m_basePosition, m_lodLevel, quadBoundaries[0][0] - 1, quadBoundaries[0][1] - 1, quadBoundaries[0][2] - 1, quadBoundaries[1][0] - 1, quadBoundaries[1][1] - 1, quadBoundaries[1][2] - 1, (CUBE_FACE)faceIndex, m_output);
+                            AddCubeBlockFace(pBlockType, blockValue, blockLighting, blockRotation, m_basePosition, m_lodLevel, quadBoundaries[0][0] - 1, quadBoundaries[0][1] - 1, quadBoundaries[0][2] - 1, quadBoundaries[1][0] - 1, quadBoundaries[1][1] - 1, quadBoundaries[1][2] - 1, (CUBE_FACE)faceIndex, output);
                             break;
 
                         case BLOCK_MESH_BLOCK_TYPE_SHAPE_TYPE_SLAB:
-                            AddSlabBlockFace(pBlockType, blockValue, blockLighting, blockRotation, m_basePosition, m_lodLevel, quadBoundaries[0][0] - 1, quadBoundaries[0][1] - 1, quadBoundaries[0][2] - 1, quadBoundaries[1][0] - 1, quadBoundaries[1][1] - 1, quadBoundaries[1][2] - 1, (CUBE_FACE)faceIndex, (GetBlockValueAt(quadBoundaries[1][0], quadBoundaries[1][1], quadBoundaries[1][2] + 1) != blockValue), m_output);
+                            AddSlabBlockFace(pBlockType, blockValue, blockLighting, blockRotation, m_basePosition, m_lodLevel, quadBoundaries[0][0] - 1, quadBoundaries[0][1] - 1, quadBoundaries[0][2] - 1, quadBoundaries[1][0] - 1, quadBoundaries[1][1] - 1, quadBoundaries[1][2] - 1, (CUBE_FACE)faceIndex, (GetBlockValueAt(quadBoundaries[1][0], quadBoundaries[1][1], quadBoundaries[1][2] + 1) != blockValue), output);
                             break;
 
                         case BLOCK_MESH_BLOCK_TYPE_SHAPE_TYPE_STAIRS:
-                            AddStairBlockFace(pBlockType, blockValue, blockLighting, blockRotation, m_basePosition, m_lodLevel, quadBoundaries[0][0] - 1, quadBoundaries[0][1] - 1, quadBoundaries[0][2] - 1, quadBoundaries[1][0] - 1, quadBoundaries[1][1] - 1, quadBoundaries[1][2] - 1, (CUBE_FACE)faceIndex, m_output);
+                            AddStairBlockFace(pBlockType, blockValue, blockLighting, blockRotation, m_basePosition, m_lodLevel, quadBoundaries[0][0] - 1, quadBoundaries[0][1] - 1, quadBoundaries[0][2] - 1, quadBoundaries[1][0] - 1, quadBoundaries[1][1] - 1, quadBoundaries[1][2] - 1, (CUBE_FACE)faceIndex, output);
                             break;
                         }
                     }
@@ -578,7 +648,7 @@ void BlockWorldMesher::GenerateBlocks(uint3 &minBlockCoordinates, uint3 &maxBloc
 
                         // update the cached data too
                         //blockFaceMask &= ~currentFaceMask;
-                        AddStairBlockFace(pBlockType, blockValue, blockLighting, blockRotation, m_basePosition, m_lodLevel, x - 1, y - 1, z - 1, x - 1, y - 1, z - 1, (CUBE_FACE)faceIndex, m_output);
+                        AddStairBlockFace(pBlockType, blockValue, blockLighting, blockRotation, m_basePosition, m_lodLevel, x - 1, y - 1, z - 1, x - 1, y - 1, z - 1, (CUBE_FACE)faceIndex, output);
                     }
                 }
                 else if (shapeType == BLOCK_MESH_BLOCK_TYPE_SHAPE_TYPE_PLANE ||
@@ -598,11 +668,11 @@ void BlockWorldMesher::GenerateBlocks(uint3 &minBlockCoordinates, uint3 &maxBloc
                         switch (shapeType)
                         {
                         case BLOCK_MESH_BLOCK_TYPE_SHAPE_TYPE_PLANE:
-                            AddPlaneBlock(pBlockType, blockValue, blockLighting, blockRotation, m_basePosition, m_lodLevel, x - 1, y - 1, z - 1, m_output);
+                            AddPlaneBlock(pBlockType, blockValue, blockLighting, blockRotation, m_basePosition, m_lodLevel, x - 1, y - 1, z - 1, output);
                             break;
 
                         case BLOCK_MESH_BLOCK_TYPE_SHAPE_TYPE_MESH:
-                            AddMeshBlock(pBlockType, blockValue, blockLighting, blockRotation, m_basePosition, m_lodLevel, x - 1, y - 1, z - 1, m_output);
+                            AddMeshBlock(pBlockType, blockValue, blockLighting, blockRotation, m_basePosition, m_lodLevel, x - 1, y - 1, z - 1, output);
                             break;
                         }
                     }
@@ -610,7 +680,7 @@ void BlockWorldMesher::GenerateBlocks(uint3 &minBlockCoordinates, uint3 &maxBloc
 
                 // handle point light emitting blocks, currently only at lod0
                 if (pBlockType != nullptr && (pBlockType->Flags & BLOCK_MESH_BLOCK_TYPE_FLAG_POINT_LIGHT_EMITTER) && m_lodLevel == 0)
-                    AddLightBlock(pBlockType, m_basePosition, m_lodLevel, x - 1, y - 1, z - 1, m_output);
+                    AddLightBlock(pBlockType, m_basePosition, m_lodLevel, x - 1, y - 1, z - 1, output);
 
                 // update block bounds
                 minBlockCoordinates = minBlockCoordinates.Min(uint3(x - 1, y - 1, z - 1));
@@ -622,6 +692,21 @@ void BlockWorldMesher::GenerateBlocks(uint3 &minBlockCoordinates, uint3 &maxBloc
 
 #undef BLOCK_VALUE_ARRAY_ACCESS
 
+void BlockWorldMesher::ResetOutput(Output &output)
+{
+    for (MeshInstances *pMeshInstances : output.Instances)
+        delete pMeshInstances;
+
+    output.BoundingBox = AABox::Zero;
+    output.BoundingSphere = Sphere::Zero;
+    output.Vertices.Clear();
+    output.PackedVertices.Clear();
+    output.Triangles.Clear();
+    output.Batches.Clear();
+    output.Instances.Clear();
+    output.Lights.Clear();
+}
+
 void BlockWorldMesher::GenerateMesh()
 {
     // min/max bounds
@@ -629,7 +714,7 @@ void BlockWorldMesher::GenerateMesh()
     uint3 maxBlockCoordinates(0, 0, 0);
 
     // generate cube faces
-    GenerateBlocks(minBlockCoordinates, maxBlockCoordinates);
+    GenerateBlocks(m_output, minBlockCoordinates, maxBlockCoordinates);
 
     // fill bounds
     if (minBlockCoordinates <= maxBlockCoordinates)
@@ -645,6 +730,27 @@ void BlockWorldMesher::GenerateMesh()
 
     // generate batches
     GenerateBatches(m_output);
+
+    // convert to the compact vertex format, if everything fits
+    if (m_packVertices)
+        PackVertices(m_output, m_basePosition);
+}
+
+bool BlockWorldMesher::PackVertices(Output &output, const float3 &origin)
+{
+    output.PackedVertices.Resize(output.Vertices.GetSize());
+    for (uint32 i = 0; i < output.Vertices.GetSize(); i++)
+    {
+        if (!BlockWorldVertexFactory::PackVertex(output.Vertices[i], origin, &output.PackedVertices[i]))
+        {
+            // keep the full vertices for this chunk
+            output.PackedVertices.Clear();
+            return false;
+        }
+    }
+
+    output.Vertices.Clear();
+    return true;
 }
 
 static int TriangleOrderSortFunction(const BlockWorldMesher::Triangle *pLeft, const BlockWorldMesher::Triangle *pRight)
@@ -727,7 +833,17 @@ void BlockWorldMesher::GenerateBatches(Output &output)
 
 bool BlockWorldMesher::CreateGPUBuffers(const Output &output, VertexBufferBindingArray *pVertexBuffers, GPUBuffer **ppIndexBuffer, GPU_INDEX_FORMAT *pIndexFormat, GPUBuffer **ppInstanceTransformBuffer)
 {
-    if (!output.Vertices.IsEmpty())
+    if (!output.PackedVertices.IsEmpty())
+    {
+        // packed vertices take priority, the full vertices are discarded when packing succeeds
+        GPU_BUFFER_DESC vertexBufferDesc(GPU_BUFFER_FLAG_BIND_VERTEX_BUFFER, output.PackedVertices.GetStorageSizeInBytes());
+        AutoReleasePtr<GPUBuffer> pVertexBuffer = g_pRenderer->CreateBuffer(&vertexBufferDesc, output.PackedVertices.GetBasePointer());
+        if (pVertexBuffer == nullptr)
+            return false;
+
+        pVertexBuffers->SetBuffer(0, pVertexBuffer, 0, sizeof(PackedVertex));
+    }
+    else if (!output.Vertices.IsEmpty())
     {
         // create buffer directly from data
         GPU_BUFFER_DESC vertexBufferDesc(GPU_BUFFER_FLAG_BIND_VERTEX_BUFFER, output.Vertices.GetStorageSizeInBytes());
@@ -743,9 +859,9 @@ bool BlockWorldMesher::CreateGPUBuffers(const Output &output, VertexBufferBindin
         // generate indices
         GPUBuffer *pIndexBuffer;
         GPU_INDEX_FORMAT indexFormat;
-        if (output.Vertices.GetSize() <= 0xFFFF)
+        if ((output.Vertices.GetSize() + output.PackedVertices.GetSize()) <= 0xFFFF)
         {
-            uint16 *pIndices = new uint16[output.Vertices.GetSize() * 3];
+            uint16 *pIndices = new uint16[output.Triangles.GetSize() * 3];
             for (uint32 i = 0, n = 0; i < output.Triangles.GetSize(); i++)
             {
                 const Triangle &t = output.Triangles[i];
@@ -11,6 +11,7 @@ class BlockWorldMesher
 {
 public:
     typedef BlockWorldVertexFactory::Vertex Vertex;
+    typedef BlockWorldVertexFactory::PackedVertex PackedVertex;
 
     struct FullVertex
     {
@@ -69,6 +70,7 @@ public:
     };
 
     typedef MemArray<BlockWorldVertexFactory::Vertex> VertexArray;
+    typedef MemArray<BlockWorldVertexFactory::PackedVertex> PackedVertexArray;
     typedef MemArray<Triangle> TriangleArray;
     typedef MemArray<Batch> BatchArray;
     typedef PODArray<MeshInstances *> MeshInstancesArray;
@@ -79,6 +81,7 @@ public:
         AABox BoundingBox;
         Sphere BoundingSphere;
         VertexArray Vertices;
+        PackedVertexArray PackedVertices;
         TriangleArray Triangles;
         BatchArray Batches;
         MeshInstancesArray Instances;
@@ -89,21 +92,33 @@ public:
     BlockWorldMesher(const BlockPalette *pPalette, uint32 chunkSize, uint32 lodLevel, const float3 &basePosition, bool generateLightMaps);
     ~BlockWorldMesher();
 
+    // meshers are recycled rather than deleted, so the volume and output arrays keep their capacity from the
+    // previous chunk. both can be called from any thread.
+    static BlockWorldMesher *Allocate(const BlockPalette *pPalette, uint32 chunkSize, uint32 lodLevel, const float3 &basePosition, bool generateLightMaps);
+    static void Free(BlockWorldMesher *pMesher);
+
     // input data accessors
     const BlockPalette *GetPalette() const { return m_pPalette; }
     const int32 GetChunkSize() const { return m_chunkSize; }
     const int32 GetLODLevel() const { return m_lodLevel; }
     const float3 &GetBasePosition() const { return m_basePosition; }
+    const bool GetPackVertices() const { return m_packVertices; }
 
     // input data mutators
     BlockWorldBlockType *GetBlockValues() { return m_pBlockValues; }
     BlockWorldBlockDataType *GetBlockData() { return m_pBlockData; }
 
+    // output packed vertices relative to the base position, falls back to full vertices if the chunk can't be packed
+    void SetPackVertices(bool enabled) { m_packVertices = enabled; }
+
     // output data
     const AABox &GetOutputBoundingBox() const { return m_output.BoundingBox; }
     const Sphere &GetOutputBoundingSphere() const { return m_output.BoundingSphere; }
     const VertexArray &GetOutputVertices() const { return m_output.Vertices; }
     const uint32 GetOutputVertexCount() const { return m_output.Vertices.GetSize(); }
+    const PackedVertexArray &GetOutputPackedVertices() const { return m_output.PackedVertices; }
+    const uint32 GetOutputPackedVertexCount() const { return m_output.PackedVertices.GetSize(); }
+    const bool HasPackedOutputVertices() const { return !m_output.PackedVertices.IsEmpty(); }
     const TriangleArray &GetOutputTriangles() const { return m_output.Triangles; }
     const uint32 GetOutputTriangleCount() const { return m_output.Triangles.GetSize(); }
     const BatchArray &GetOutputBatches() const { return m_output.Batches; }
@@ -116,6 +131,9 @@ public:
     // generate a render view of the chunk
     void GenerateMesh();
 
+    // clears an output, without releasing the memory held by its arrays
+    static void ResetOutput(Output &output);
+
     // create gpu buffers for the generated data
     bool CreateGPUBuffers(VertexBufferBindingArray *pVertexBuffers, GPUBuffer **ppIndexBuffer, GPU_INDEX_FORMAT *pIndexFormat, GPUBuffer **ppInstanceTransformBuffer) { return CreateGPUBuffers(m_output, pVertexBuffers, ppIndexBuffer, pIndexFormat, ppInstanceTransformBuffer); }
 
@@ -146,8 +164,12 @@ private:
 
     static void OptimizeTriangleOrder(Output &output);
     static void GenerateBatches(Output &output);
+    static bool PackVertices(Output &output, const float3 &origin);
+
+    void GenerateBlocks(Output &output, uint3 &minBlockCoordinates, uint3 &maxBlockCoordinates);
 
-    void GenerateBlocks(uint3 &minBlockCoordinates, uint3 &maxBlockCoordinates);
+    // sets the input parameters, growing the volume arrays if needed
+    void Initialize(const BlockPalette *pPalette, uint32 chunkSize, uint32 lodLevel, const float3 &basePosition, bool generateLightMaps);
 
     // input data
     const BlockPalette *m_pPalette;
@@ -157,7 +179,9 @@ private:
     BlockWorldBlockType *m_pBlockValues;
     BlockWorldBlockDataType *m_pBlockData;
     uint8 *m_pBlockFaceMasks;
+    uint32 m_volumeCapacity;
     bool m_generateLightMaps;
+    bool m_packVertices;
 
     // output data
     Output m_output;
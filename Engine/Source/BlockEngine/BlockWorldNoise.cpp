@@ -0,0 +1,382 @@
+#include "BlockEngine/PrecompiledHeader.h"
+#include "BlockEngine/BlockWorldNoise.h"
+
+// points are evaluated in batches of this many, so the coordinate arrays fit on the stack
+static const uint32 NOISE_BATCH_SIZE = 64;
+
+// seed step between octaves, so they don't line up
+static const uint32 NOISE_OCTAVE_SEED_STEP = 0x9E3779B9;
+
+// scales bringing each noise type to roughly [-1, 1]
+static const float PERLIN_2D_SCALE = 0.66f;
+static const float PERLIN_3D_SCALE = 1.0f;
+static const float SIMPLEX_2D_SCALE = 45.0f;
+static const float SIMPLEX_3D_SCALE = 32.0f;
+
+static inline int32 FastFloor(float value)
+{
+    int32 truncated = (int32)value;
+    return truncated - (int32)(value < (float)truncated);
+}
+
+static inline float Fade(float t)
+{
+    return t * t * t * (t * (t * 6.0f - 15.0f) + 10.0f);
+}
+
+static inline float Lerp(float a, float b, float t)
+{
+    return a + (b - a) * t;
+}
+
+static inline uint32 HashLattice(uint32 seed, int32 x, int32 y, int32 z)
+{
+    uint32 hash = seed ^ ((uint32)x * 0x8DA6B343u) ^ ((uint32)y * 0xD8163841u) ^ ((uint32)z * 0xCB1AB31Fu);
+    hash ^= hash >> 15;
+    hash *= 0x2C1B3C6Du;
+    hash ^= hash >> 12;
+    hash *= 0x297A2D39u;
+    hash ^= hash >> 15;
+    return hash;
+}
+
+// lattice value in [-1, 1]
+static inline float LatticeValue(uint32 hash)
+{
+    return (float)(hash & 0xFFFF) * (2.0f / 65535.0f) - 1.0f;
+}
+
+// dot product with one of the gradients (+-1, +-2) and (+-2, +-1)
+static inline float GradientDot2(uint32 hash, float x, float y)
+{
+    uint32 h = hash & 7;
+    float u = (h < 4) ? x : y;
+    float v = (h < 4) ? y : x;
+    return ((h & 1) ? -u : u) + ((h & 2) ? -2.0f * v : 2.0f * v);
+}
+
+// dot product with one of the twelve cube edge gradients, as in improved perlin noise
+static inline float GradientDot3(uint32 hash, float x, float y, float z)
+{
+    uint32 h = hash & 15;
+    float u = (h < 8) ? x : y;
+    float v = (h < 4) ? y : ((h == 12 || h == 14) ? x : z);
+    return ((h & 1) ? -u : u) + ((h & 2) ? -v : v);
+}
+
+static void ValueNoise2D(uint32 seed, const float *pX, const float *pY, float *pResults, uint32 count)
+{
+    for (uint32 i = 0; i < count; i++)
+    {
+        int32 x0 = FastFloor(pX[i]);
+        int32 y0 = FastFloor(pY[i]);
+        float u = Fade(pX[i] - (float)x0);
+        float v = Fade(pY[i] - (float)y0);
+
+        float v00 = LatticeValue(HashLattice(seed, x0, y0, 0));
+        float v10 = LatticeValue(HashLattice(seed, x0 + 1, y0, 0));
+        float v01 = LatticeValue(HashLattice(seed, x0, y0 + 1, 0));
+        float v11 = LatticeValue(HashLattice(seed, x0 + 1, y0 + 1, 0));
+        pResults[i] = Lerp(Lerp(v00, v10, u), Lerp(v01, v11, u), v);
+    }
+}
+
+static void ValueNoise3D(uint32 seed, const float *pX, const float *pY, const float *pZ, float *pResults, uint32 count)
+{
+    for (uint32 i = 0; i < count; i++)
+    {
+        int32 x0 = FastFloor(pX[i]);
+        int32 y0 = FastFloor(pY[i]);
+        int32 z0 = FastFloor(pZ[i]);
+        float u = Fade(pX[i] - (float)x0);
+        float v = Fade(pY[i] - (float)y0);
+        float w = Fade(pZ[i] - (float)z0);
+
+        float v000 = LatticeValue(HashLattice(seed, x0, y0, z0));
+        float v100 = LatticeValue(HashLattice(seed, x0 + 1, y0, z0));
+        float v010 = LatticeValue(HashLattice(seed, x0, y0 + 1, z0));
+        float v110 = LatticeValue(HashLattice(seed, x0 + 1, y0 + 1, z0));
+        float v001 = LatticeValue(HashLattice(seed, x0, y0, z0 + 1));
+        float v101 = LatticeValue(HashLattice(seed, x0 + 1, y0, z0 + 1));
+        float v011 = LatticeValue(HashLattice(seed, x0, y0 + 1, z0 + 1));
+        float v111 = LatticeValue(HashLattice(seed, x0 + 1, y0 + 1, z0 + 1));
+        pResults[i] = Lerp(Lerp(Lerp(v000, v100, u), Lerp(v010, v110, u), v),
+                           Lerp(Lerp(v001, v101, u), Lerp(v011, v111, u), v), w);
+    }
+}
+
+static void PerlinNoise2D(uint32 seed, const float *pX, const float *pY, float *pResults, uint32 count)
+{
+    for (uint32 i = 0; i < count; i++)
+    {
+        int32 x0 = FastFloor(pX[i]);
+        int32 y0 = FastFloor(pY[i]);
+        float fx = pX[i] - (float)x0;
+        float fy = pY[i] - (float)y0;
+        float u = Fade(fx);
+        float v = Fade(fy);
+
+        float n00 = GradientDot2(HashLattice(seed, x0, y0, 0), fx, fy);
+        float n10 = GradientDot2(HashLattice(seed, x0 + 1, y0, 0), fx - 1.0f, fy);
+        float n01 = GradientDot2(HashLattice(seed, x0, y0 + 1, 0), fx, fy - 1.0f);
+        float n11 = GradientDot2(HashLattice(seed, x0 + 1, y0 + 1, 0), fx - 1.0f, fy - 1.0f);
+        pResults[i] = Lerp(Lerp(n00, n10, u), Lerp(n01, n11, u), v) * PERLIN_2D_SCALE;
+    }
+}
+
+static void PerlinNoise3D(uint32 seed, const float *pX, const float *pY, const float *pZ, float *pResults, uint32 count)
+{
+    for (uint32 i = 0; i < count; i++)
+    {
+        int32 x0 = FastFloor(pX[i]);
+        int32 y0 = FastFloor(pY[i]);
+        int32 z0 = FastFloor(pZ[i]);
+        float fx = pX[i] - (float)x0;
+        float fy = pY[i] - (float)y0;
+        float fz = pZ[i] - (float)z0;
+        float u = Fade(fx);
+        float v = Fade(fy);
+        float w = Fade(fz);
+
+        float n000 = GradientDot3(HashLattice(seed, x0, y0, z0), fx, fy, fz);
+        float n100 = GradientDot3(HashLattice(seed, x0 + 1, y0, z0), fx - 1.0f, fy, fz);
+        float n010 = GradientDot3(HashLattice(seed, x0, y0 + 1, z0), fx, fy - 1.0f, fz);
+        float n110 = GradientDot3(HashLattice(seed, x0 + 1, y0 + 1, z0), fx - 1.0f, fy - 1.0f, fz);
+        float n001 = GradientDot3(HashLattice(seed, x0, y0, z0 + 1), fx, fy, fz - 1.0f);
+        float n101 = GradientDot3(HashLattice(seed, x0 + 1, y0, z0 + 1), fx - 1.0f, fy, fz - 1.0f);
+        float n011 = GradientDot3(HashLattice(seed, x0, y0 + 1, z0 + 1), fx, fy - 1.0f, fz - 1.0f);
+        float n111 = GradientDot3(HashLattice(seed, x0 + 1, y0 + 1, z0 + 1), fx - 1.0f, fy - 1.0f, fz - 1.0f);
+        pResults[i] = Lerp(Lerp(Lerp(n000, n100, u), Lerp(n010, n110, u), v),
+                           Lerp(Lerp(n001, n101, u), Lerp(n011, n111, u), v), w) * PERLIN_3D_SCALE;
+    }
+}
+
+static void SimplexNoise2D(uint32 seed, const float *pX, const float *pY, float *pResults, uint32 count)
+{
+    static const float F2 = 0.366025403784f;        // (sqrt(3) - 1) / 2
+    static const float G2 = 0.211324865405f;        // (3 - sqrt(3)) / 6
+
+    for (uint32 i = 0; i < count; i++)
+    {
+        // skew into the simplex grid, and find the cell
+        float skew = (pX[i] + pY[i]) * F2;
+        int32 cellX = FastFloor(pX[i] + skew);
+        int32 cellY = FastFloor(pY[i] + skew);
+        float unskew = (float)(cellX + cellY) * G2;
+        float x0 = pX[i] - ((float)cellX - unskew);
+        float y0 = pY[i] - ((float)cellY - unskew);
+
+        // which of the two triangles the point is in
+        int32 offsetX = (x0 > y0) ? 1 : 0;
+        int32 offsetY = 1 - offsetX;
+        float x1 = x0 - (float)offsetX + G2;
+        float y1 = y0 - (float)offsetY + G2;
+        float x2 = x0 - 1.0f + 2.0f * G2;
+        float y2 = y0 - 1.0f + 2.0f * G2;
+
+        // corner contributions, falling to zero at the edge of each corner's radius
+        float t0 = Max(0.5f - x0 * x0 - y0 * y0, 0.0f);
+        float t1 = Max(0.5f - x1 * x1 - y1 * y1, 0.0f);
+        float t2 = Max(0.5f - x2 * x2 - y2 * y2, 0.0f);
+        t0 *= t0;
+        t1 *= t1;
+        t2 *= t2;
+
+        float n0 = t0 * t0 * GradientDot2(HashLattice(seed, cellX, cellY, 0), x0, y0);
+        float n1 = t1 * t1 * GradientDot2(HashLattice(seed, cellX + offsetX, cellY + offsetY, 0), x1, y1);
+        float n2 = t2 * t2 * GradientDot2(HashLattice(seed, cellX + 1, cellY + 1, 0), x2, y2);
+        pResults[i] = (n0 + n1 + n2) * SIMPLEX_2D_SCALE;
+    }
+}
+
+static void SimplexNoise3D(uint32 seed, const float *pX, const float *pY, const float *pZ, float *pResults, uint32 count)
+{
+    static const float F3 = 1.0f / 3.0f;
+    static const float G3 = 1.0f / 6.0f;
+
+    for (uint32 i = 0; i < count; i++)
+    {
+        // skew into the simplex grid, and find the cell
+        float skew = (pX[i] + pY[i] + pZ[i]) * F3;
+        int32 cellX = FastFloor(pX[i] + skew);
+        int32 cellY = FastFloor(pY[i] + skew);
+        int32 cellZ = FastFloor(pZ[i] + skew);
+        float unskew = (float)(cellX + cellY + cellZ) * G3;
+        float x0 = pX[i] - ((float)cellX - unskew);
+        float y0 = pY[i] - ((float)cellY - unskew);
+        float z0 = pZ[i] - ((float)cellZ - unskew);
+
+        // rank the axes to find which of the six tetrahedra the point is in
+        int32 xy = (x0 >= y0) ? 1 : 0;
+        int32 xz = (x0 >= z0) ? 1 : 0;
+        int32 yz = (y0 >= z0) ? 1 : 0;
+        int32 offset1X = xy & xz;
+        int32 offset1Y = (1 - xy) & yz;
+        int32 offset1Z = (1 - xz) & (1 - yz);
+        int32 offset2X = xy | xz;
+        int32 offset2Y = (1 - xy) | yz;
+        int32 offset2Z = (1 - xz) | (1 - yz);
+
+        float x1 = x0 - (float)offset1X + G3;
+        float y1 = y0 - (float)offset1Y + G3;
+        float z1 = z0 - (float)offset1Z + G3;
+        float x2 = x0 - (float)offset2X + 2.0f * G3;
+        float y2 = y0 - (float)offset2Y + 2.0f * G3;
+        float z2 = z0 - (float)offset2Z + 2.0f * G3;
+        float x3 = x0 - 1.0f + 3.0f * G3;
+        float y3 = y0 - 1.0f + 3.0f * G3;
+        float z3 = z0 - 1.0f + 3.0f * G3;
+
+        // corner contributions
+        float t0 = Max(0.6f - x0 * x0 - y0 * y0 - z0 * z0, 0.0f);
+        float t1 = Max(0.6f - x1 * x1 - y1 * y1 - z1 * z1, 0.0f);
+        float t2 = Max(0.6f - x2 * x2 - y2 * y2 - z2 * z2, 0.0f);
+        float t3 = Max(0.6f - x3 * x3 - y3 * y3 - z3 * z3, 0.0f);
+        t0 *= t0;
+        t1 *= t1;
+        t2 *= t2;
+        t3 *= t3;
+
+        float n0 = t0 * t0 * GradientDot3(HashLattice(seed, cellX, cellY, cellZ), x0, y0, z0);
+        float n1 = t1 * t1 * GradientDot3(HashLattice(seed, cellX + offset1X, cellY + offset1Y, cellZ + offset1Z), x1, y1, z1);
+        float n2 = t2 * t2 * GradientDot3(HashLattice(seed, cellX + offset2X, cellY + offset2Y, cellZ + offset2Z), x2, y2, z2);
+        float n3 = t3 * t3 * GradientDot3(HashLattice(seed, cellX + 1, cellY + 1, cellZ + 1), x3, y3, z3);
+        pResults[i] = (n0 + n1 + n2 + n3) * SIMPLEX_3D_SCALE;
+    }
+}
+
+void BlockWorldNoise::Evaluate2D(BLOCK_WORLD_NOISE_TYPE type, uint32 seed, const float *pX, const float *pY, float *pResults, uint32 count)
+{
+    switch (type)
+    {
+    case BLOCK_WORLD_NOISE_TYPE_VALUE:
+        ValueNoise2D(seed, pX, pY, pResults, count);
+        break;
+
+    case BLOCK_WORLD_NOISE_TYPE_PERLIN:
+        PerlinNoise2D(seed, pX, pY, pResults, count);
+        break;
+
+    case BLOCK_WORLD_NOISE_TYPE_SIMPLEX:
+        SimplexNoise2D(seed, pX, pY, pResults, count);
+        break;
+
+    default:
+        UnreachableCode();
+        break;
+    }
+}
+
+void BlockWorldNoise::Evaluate3D(BLOCK_WORLD_NOISE_TYPE type, uint32 seed, const float *pX, const float *pY, const float *pZ, float *pResults, uint32 count)
+{
+    switch (type)
+    {
+    case BLOCK_WORLD_NOISE_TYPE_VALUE:
+        ValueNoise3D(seed, pX, pY, pZ, pResults, count);
+        break;
+
+    case BLOCK_WORLD_NOISE_TYPE_PERLIN:
+        PerlinNoise3D(seed, pX, pY, pZ, pResults, count);
+        break;
+
+    case BLOCK_WORLD_NOISE_TYPE_SIMPLEX:
+        SimplexNoise3D(seed, pX, pY, pZ, pResults, count);
+        break;
+
+    default:
+        UnreachableCode();
+        break;
+    }
+}
+
+void BlockWorldNoise::Fractal2DGrid(const BlockWorldNoiseParameters &parameters, float startX, float startY, uint32 countX, uint32 countY, float *pResults)
+{
+    uint32 pointCount = countX * countY;
+    for (uint32 i = 0; i < pointCount; i++)
+        pResults[i] = 0.0f;
+
+    float pointX[NOISE_BATCH_SIZE];
+    float pointY[NOISE_BATCH_SIZE];
+    float values[NOISE_BATCH_SIZE];
+    float frequency = parameters.Frequency;
+    float amplitude = 1.0f;
+    float amplitudeSum = 0.0f;
+    uint32 seed = parameters.Seed;
+    for (uint32 octave = 0; octave < parameters.Octaves; octave++)
+    {
+        for (uint32 batchStart = 0; batchStart < pointCount; batchStart += NOISE_BATCH_SIZE)
+        {
+            uint32 batchCount = Min(pointCount - batchStart, NOISE_BATCH_SIZE);
+            for (uint32 i = 0; i < batchCount; i++)
+            {
+                uint32 pointIndex = batchStart + i;
+                pointX[i] = (startX + (float)(pointIndex % countX)) * frequency;
+                pointY[i] = (startY + (float)(pointIndex / countX)) * frequency;
+            }
+
+            Evaluate2D(parameters.Type, seed, pointX, pointY, values, batchCount);
+            for (uint32 i = 0; i < batchCount; i++)
+                pResults[batchStart + i] += values[i] * amplitude;
+        }
+
+        amplitudeSum += amplitude;
+        frequency *= parameters.Lacunarity;
+        amplitude *= parameters.Gain;
+        seed += NOISE_OCTAVE_SEED_STEP;
+    }
+
+    // keep the sum in the same range as one octave
+    if (amplitudeSum > 0.0f)
+    {
+        float scale = 1.0f / amplitudeSum;
+        for (uint32 i = 0; i < pointCount; i++)
+            pResults[i] *= scale;
+    }
+}
+
+void BlockWorldNoise::Fractal3DColumn(const BlockWorldNoiseParameters &parameters, float x, float y, float startZ, uint32 count, float *pResults)
+{
+    for (uint32 i = 0; i < count; i++)
+        pResults[i] = 0.0f;
+
+    float pointX[NOISE_BATCH_SIZE];
+    float pointY[NOISE_BATCH_SIZE];
+    float pointZ[NOISE_BATCH_SIZE];
+    float values[NOISE_BATCH_SIZE];
+    float frequency = parameters.Frequency;
+    float amplitude = 1.0f;
+    float amplitudeSum = 0.0f;
+    uint32 seed = parameters.Seed;
+    for (uint32 octave = 0; octave < parameters.Octaves; octave++)
+    {
+        // x and y are the same all the way up the column
+        for (uint32 i = 0; i < NOISE_BATCH_SIZE; i++)
+        {
+            pointX[i] = x * frequency;
+            pointY[i] = y * frequency;
+        }
+
+        for (uint32 batchStart = 0; batchStart < count; batchStart += NOISE_BATCH_SIZE)
+        {
+            uint32 batchCount = Min(count - batchStart, NOISE_BATCH_SIZE);
+            for (uint32 i = 0; i < batchCount; i++)
+                pointZ[i] = (startZ + (float)(batchStart + i)) * frequency;
+
+            Evaluate3D(parameters.Type, seed, pointX, pointY, pointZ, values, batchCount);
+            for (uint32 i = 0; i < batchCount; i++)
+                pResults[batchStart + i] += values[i] * amplitude;
+        }
+
+        amplitudeSum += amplitude;
+        frequency *= parameters.Lacunarity;
+        amplitude *= parameters.Gain;
+        seed += NOISE_OCTAVE_SEED_STEP;
+    }
+
+    if (amplitudeSum > 0.0f)
+    {
+        float scale = 1.0f / amplitudeSum;
+        for (uint32 i = 0; i < count; i++)
+            pResults[i] *= scale;
+    }
+}
@@ -0,0 +1,38 @@
+#pragma once
+#include "BlockEngine/BlockWorldTypes.h"
+
+enum BLOCK_WORLD_NOISE_TYPE
+{
+    BLOCK_WORLD_NOISE_TYPE_VALUE,
+    BLOCK_WORLD_NOISE_TYPE_PERLIN,
+    BLOCK_WORLD_NOISE_TYPE_SIMPLEX,
+    NUM_BLOCK_WORLD_NOISE_TYPES,
+};
+
+// fractal noise settings, frequency is in cycles per block
+struct BlockWorldNoiseParameters
+{
+    BLOCK_WORLD_NOISE_TYPE Type;
+    uint32 Seed;
+    float Frequency;
+    uint32 Octaves;
+    float Lacunarity;
+    float Gain;
+};
+
+// Coherent noise for world generators, evaluated over arrays of points rather than one point per call. The lattice is
+// hashed instead of using permutation tables, and corner selection is done with compares, so the inner loops have no
+// branches or table lookups and can be vectorized by the compiler. Results are roughly within [-1, 1]. Everything here
+// is safe to call from the job workers.
+namespace BlockWorldNoise
+{
+    // single octave at each point
+    void Evaluate2D(BLOCK_WORLD_NOISE_TYPE type, uint32 seed, const float *pX, const float *pY, float *pResults, uint32 count);
+    void Evaluate3D(BLOCK_WORLD_NOISE_TYPE type, uint32 seed, const float *pX, const float *pY, const float *pZ, float *pResults, uint32 count);
+
+    // fractal sum over a grid of block columns starting at startX, startY, written to pResults[y * countX + x], for height maps
+    void Fractal2DGrid(const BlockWorldNoiseParameters &parameters, float startX, float startY, uint32 countX, uint32 countY, float *pResults);
+
+    // fractal sum up one column of blocks starting at startZ, written to pResults[z], for densities of caves and overhangs
+    void Fractal3DColumn(const BlockWorldNoiseParameters &parameters, float x, float y, float startZ, uint32 count, float *pResults);
+}
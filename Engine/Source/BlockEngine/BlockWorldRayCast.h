@@ -0,0 +1,207 @@
+#pragma once
+#include "BlockEngine/BlockWorldTypes.h"
+
+// result of a block-only ray cast
+struct BlockWorldRayCastResult
+{
+    bool Hit;
+    int32 BlockX, BlockY, BlockZ;
+    CUBE_FACE BlockFace;
+    BlockWorldBlockType BlockValue;
+    float Distance;
+};
+
+// Grid traversal for ray casts against blocks, after Amanatides and Woo, "A Fast Voxel Traversal Algorithm for Ray Tracing".
+// The blocks the ray passes through are visited in order, so the first solid block is the hit. Chunks without any solid blocks
+// are crossed in one step. This is independent of BlockWorld, the chunk storage is supplied through a lookup function.
+namespace BlockWorldRayCast
+{
+    // face of a block the ray enters through when stepping along an axis, and the one it leaves through
+    static inline CUBE_FACE GetEntryFace(uint32 axis, int32 step)
+    {
+        static const CUBE_FACE entryFaces[3][2] = { { CUBE_FACE_RIGHT, CUBE_FACE_LEFT }, { CUBE_FACE_BACK, CUBE_FACE_FRONT }, { CUBE_FACE_TOP, CUBE_FACE_BOTTOM } };
+        return entryFaces[axis][(step > 0) ? 1 : 0];
+    }
+    static inline CUBE_FACE GetExitFace(uint32 axis, int32 step)
+    {
+        return GetEntryFace(axis, -step);
+    }
+
+    // division rounding towards negative infinity, for chunk coordinates
+    static inline int32 FloorDivide(int32 value, int32 divisor)
+    {
+        return (value >= 0) ? (value / divisor) : ((value + 1) / divisor - 1);
+    }
+
+    // Casts the ray through the blocks within bounds. lookupChunk(chunkX, chunkY, chunkZ) returns the block values of a chunk,
+    // indexed by (bz * chunkSize * chunkSize) + (by * chunkSize) + bx, or nullptr if the chunk is missing or has no solid blocks.
+    // A ray starting inside a solid block hits it where it leaves the block, as the box test RayCastBlock used before does.
+    template<class LookupChunkFunction>
+    bool TraceRay(const Ray &ray, const AABox &bounds, int32 chunkSize, const LookupChunkFunction &lookupChunk, BlockWorldRayCastResult *pResult)
+    {
+        const float3 &origin = ray.GetOrigin();
+        const float3 &direction = ray.GetDirection();
+        const float3 &inverseDirection = ray.GetInverseDirection();
+        pResult->Hit = false;
+
+        // clip the ray against the bounds, remembering the axis it enters through
+        float startTime = 0.0f;
+        float endTime = ray.GetDistance();
+        int32 startAxis = -1;
+        for (uint32 axis = 0; axis < 3; axis++)
+        {
+            if (direction[axis] == 0.0f)
+            {
+                if (origin[axis] < bounds.GetMinBounds()[axis] || origin[axis] >= bounds.GetMaxBounds()[axis])
+                    return false;
+
+                continue;
+            }
+
+            float minBoundTime = (bounds.GetMinBounds()[axis] - origin[axis]) * inverseDirection[axis];
+            float maxBoundTime = (bounds.GetMaxBounds()[axis] - origin[axis]) * inverseDirection[axis];
+            float nearTime = Min(minBoundTime, maxBoundTime);
+            float farTime = Max(minBoundTime, maxBoundTime);
+
+            if (nearTime > startTime)
+            {
+                startTime = nearTime;
+                startAxis = (int32)axis;
+            }
+            endTime = Min(endTime, farTime);
+        }
+        if (startTime > endTime)
+            return false;
+
+        // starting block, and the time at which the ray crosses the next block boundary on each axis
+        int32 step[3];
+        int32 block[3];
+        float nextCrossingTime[3];
+        float crossingTimeDelta[3];
+        float3 startPosition(origin + direction * startTime);
+        for (uint32 axis = 0; axis < 3; axis++)
+        {
+            step[axis] = (direction[axis] > 0.0f) ? 1 : ((direction[axis] < 0.0f) ? -1 : 0);
+
+            // the entry axis is exactly on the bounds, don't leave it to rounding
+            if ((int32)axis == startAxis)
+                block[axis] = (step[axis] > 0) ? Math::Truncate(Math::Floor(bounds.GetMinBounds()[axis])) : Math::Truncate(Math::Floor(bounds.GetMaxBounds()[axis])) - 1;
+            else
+                block[axis] = Math::Truncate(Math::Floor(startPosition[axis]));
+
+            if (step[axis] != 0)
+            {
+                float boundary = (float)((step[axis] > 0) ? (block[axis] + 1) : block[axis]);
+                nextCrossingTime[axis] = (boundary - origin[axis]) * inverseDirection[axis];
+                crossingTimeDelta[axis] = Math::Abs(inverseDirection[axis]);
+            }
+            else
+            {
+                nextCrossingTime[axis] = Y_FLT_INFINITE;
+                crossingTimeDelta[axis] = Y_FLT_INFINITE;
+            }
+        }
+
+        // walk the blocks
+        float currentTime = startTime;
+        CUBE_FACE currentFace = (startAxis >= 0) ? GetEntryFace(startAxis, step[startAxis]) : CUBE_FACE_COUNT;
+        int32 chunk[3] = { Y_INT32_MIN, Y_INT32_MIN, Y_INT32_MIN };
+        const BlockWorldBlockType *pChunkBlockValues = nullptr;
+        for (;;)
+        {
+            // entered a different chunk?
+            int32 blockChunk[3] = { FloorDivide(block[0], chunkSize), FloorDivide(block[1], chunkSize), FloorDivide(block[2], chunkSize) };
+            if (blockChunk[0] != chunk[0] || blockChunk[1] != chunk[1] || blockChunk[2] != chunk[2])
+            {
+                chunk[0] = blockChunk[0];
+                chunk[1] = blockChunk[1];
+                chunk[2] = blockChunk[2];
+                pChunkBlockValues = lookupChunk(chunk[0], chunk[1], chunk[2]);
+            }
+
+            if (pChunkBlockValues == nullptr)
+            {
+                // nothing to hit in this chunk, find the axis the ray leaves it through, and the blocks needed to get there
+                int32 stepsToBoundary[3] = { 0, 0, 0 };
+                float exitTime = Y_FLT_INFINITE;
+                int32 exitAxis = -1;
+                for (uint32 axis = 0; axis < 3; axis++)
+                {
+                    if (step[axis] == 0)
+                        continue;
+
+                    int32 chunkStart = chunk[axis] * chunkSize;
+                    stepsToBoundary[axis] = (step[axis] > 0) ? (chunkStart + chunkSize - block[axis]) : (block[axis] - chunkStart + 1);
+                    float boundaryTime = nextCrossingTime[axis] + (float)(stepsToBoundary[axis] - 1) * crossingTimeDelta[axis];
+                    if (boundaryTime < exitTime)
+                    {
+                        exitTime = boundaryTime;
+                        exitAxis = (int32)axis;
+                    }
+                }
+                if (exitAxis < 0 || exitTime > endTime)
+                    return false;
+
+                // move along the other axes by the boundaries crossed before then, without leaving the chunk
+                for (uint32 axis = 0; axis < 3; axis++)
+                {
+                    if (step[axis] == 0)
+                        continue;
+
+                    int32 stepCount;
+                    if ((int32)axis == exitAxis)
+                        stepCount = stepsToBoundary[axis];
+                    else if (nextCrossingTime[axis] < exitTime)
+                        stepCount = Min(Math::Truncate(Math::Ceil((exitTime - nextCrossingTime[axis]) / crossingTimeDelta[axis])), stepsToBoundary[axis] - 1);
+                    else
+                        stepCount = 0;
+
+                    block[axis] += step[axis] * stepCount;
+                    nextCrossingTime[axis] += (float)stepCount * crossingTimeDelta[axis];
+                }
+
+                currentTime = exitTime;
+                currentFace = GetEntryFace(exitAxis, step[exitAxis]);
+                continue;
+            }
+
+            // solid block?
+            int32 localX = block[0] - chunk[0] * chunkSize;
+            int32 localY = block[1] - chunk[1] * chunkSize;
+            int32 localZ = block[2] - chunk[2] * chunkSize;
+            BlockWorldBlockType blockValue = pChunkBlockValues[(localZ * chunkSize + localY) * chunkSize + localX];
+            if (blockValue != 0)
+            {
+                if (currentFace == CUBE_FACE_COUNT)
+                {
+                    // started inside this block, so it is hit on the way out
+                    uint32 exitAxis = (nextCrossingTime[0] < nextCrossingTime[1]) ? ((nextCrossingTime[0] < nextCrossingTime[2]) ? 0 : 2) : ((nextCrossingTime[1] < nextCrossingTime[2]) ? 1 : 2);
+                    if (step[exitAxis] == 0 || nextCrossingTime[exitAxis] > ray.GetDistance())
+                        return false;
+
+                    currentTime = nextCrossingTime[exitAxis];
+                    currentFace = GetExitFace(exitAxis, step[exitAxis]);
+                }
+
+                pResult->Hit = true;
+                pResult->BlockX = block[0];
+                pResult->BlockY = block[1];
+                pResult->BlockZ = block[2];
+                pResult->BlockFace = currentFace;
+                pResult->BlockValue = blockValue;
+                pResult->Distance = currentTime;
+                return true;
+            }
+
+            // step to the next block along the axis with the nearest boundary
+            uint32 nextAxis = (nextCrossingTime[0] < nextCrossingTime[1]) ? ((nextCrossingTime[0] < nextCrossingTime[2]) ? 0 : 2) : ((nextCrossingTime[1] < nextCrossingTime[2]) ? 1 : 2);
+            currentTime = nextCrossingTime[nextAxis];
+            if (currentTime > endTime)
+                return false;
+
+            block[nextAxis] += step[nextAxis];
+            nextCrossingTime[nextAxis] += crossingTimeDelta[nextAxis];
+            currentFace = GetEntryFace(nextAxis, step[nextAxis]);
+        }
+    }
+}
@@ -4,6 +4,8 @@
 #include "BlockEngine/BlockWorld.h"
 #include "Engine/Entity.h"
 #include "Core/ClassTable.h"
+#include "Core/LZ4Compression.h"
+#include "YBaseLib/BinaryWriteBuffer.h"
 Log_SetChannel(BlockWorldSection);
 
 BlockWorldSection::BlockWorldSection(BlockWorld *pWorld, int32 sectionX, int32 sectionY)
@@ -243,7 +245,7 @@ bool BlockWorldSection::LoadFromStream(ByteStream *pStream, int32 maxLODLevel)
     BinaryReader binaryReader(pStream);
 
     uint32 signature;
-    if (!binaryReader.SafeReadUInt32(&signature) || signature != 0xCCBBAA03)
+    if (!binaryReader.SafeReadUInt32(&signature) || signature != 0xCCBBAA05)
         return false;
 
     int32 chunkSize;
@@ -285,7 +287,7 @@ bool BlockWorldSection::LoadLODs(ByteStream *pStream, int32 maxLODLevel)
     BinaryReader binaryReader(pStream);
 
     uint32 signature;
-    if (!binaryReader.SafeReadUInt32(&signature) || signature != 0xCCBBAA03)
+    if (!binaryReader.SafeReadUInt32(&signature) || signature != 0xCCBBAA05)
         return false;
 
     int32 chunkSize;
@@ -344,7 +346,30 @@ bool BlockWorldSection::InternalLoadLODs(ByteStream *pStream, int32 maxLODLevel)
         if (!binaryReader.SafeSeekAbsolute((uint64)lodOffsets[lodLevel]))
             return false;
 
+        // each lod is compressed as one block, the runs can't take more space than the raw blocks plus a count per chunk
+        int32 chunkSizeInBlocks = m_chunkSize >> lodLevel;
+        uint32 maxChunkSizeInBytes = sizeof(uint32) + (chunkSizeInBlocks * chunkSizeInBlocks * chunkSizeInBlocks) * (sizeof(uint16) + sizeof(uint32));
+        uint32 uncompressedSize, compressedSize;
+        if (!binaryReader.SafeReadUInt32(&uncompressedSize) || uncompressedSize > maxChunkSizeInBytes * (uint32)m_chunkCount ||
+            !binaryReader.SafeReadUInt32(&compressedSize) || compressedSize > LZ4Compression::GetMaxCompressedSize(uncompressedSize))
+        {
+            return false;
+        }
+
+        PODArray<byte> compressedData;
+        PODArray<byte> lodData;
+        compressedData.Resize(compressedSize);
+        lodData.Resize(uncompressedSize);
+        if (!pStream->Read2(compressedData.GetBasePointer(), compressedSize) ||
+            !LZ4Compression::Decompress(compressedData.GetBasePointer(), compressedSize, lodData.GetBasePointer(), uncompressedSize))
+        {
+            Log_ErrorPrintf("BlockWorldSection::LoadLODs: Failed to decompress section [%i, %i] lod %i.", m_sectionX, m_sectionY, lodLevel);
+            return false;
+        }
+        compressedData.Obliterate();
+
         // read chunks
+        AutoReleasePtr<ByteStream> pLODStream = ByteStream_CreateReadOnlyMemoryStream(lodData.GetBasePointer(), uncompressedSize);
         int32 chunkIndex = 0;
         for (int32 z = m_minChunkZ; z <= m_maxChunkZ; z++)
         {
@@ -360,7 +385,7 @@ bool BlockWorldSection::InternalLoadLODs(ByteStream *pStream, int32 maxLODLevel)
                     if (pChunk == nullptr)
                     {
                         pChunk = new BlockWorldChunk(this, x, y, z);
-                        if (!pChunk->LoadFromStream(lodLevel, pStream))
+                        if (!pChunk->LoadFromStream(lodLevel, pLODStream))
                         {
                             delete pChunk;
                             return false;
@@ -371,7 +396,7 @@ bool BlockWorldSection::InternalLoadLODs(ByteStream *pStream, int32 maxLODLevel)
                     }
                     else
                     {
-                        if (!pChunk->LoadFromStream(lodLevel, pStream))
+                        if (!pChunk->LoadFromStream(lodLevel, pLODStream))
                             return false;
                     }
                 }
@@ -501,6 +526,13 @@ void BlockWorldSection::UnloadLODs(int32 lodLevel)
         }
     }
 
+    // nothing can edit the remaining lods now, so pack any that were expanded by edits
+    for (int32 i = 0; i < m_chunkCount; i++)
+    {
+        if (m_ppChunks[i] != nullptr)
+            m_ppChunks[i]->PackLODs();
+    }
+
     // and update the loaded lod level
     m_loadedLODLevel = lodLevel;
 }
@@ -515,7 +547,7 @@ bool BlockWorldSection::SaveToStream(ByteStream *pStream) const
     bool writeResult = true;
 
     // write header
-    writeResult &= binaryWriter.SafeWriteUInt32(0xCCBBAA03);
+    writeResult &= binaryWriter.SafeWriteUInt32(0xCCBBAA05);
     writeResult &= binaryWriter.SafeWriteInt32(m_chunkSize);
     writeResult &= binaryWriter.SafeWriteInt32(m_sectionSize);
     writeResult &= binaryWriter.SafeWriteInt32(m_lodLevels);
@@ -526,40 +558,12 @@ bool BlockWorldSection::SaveToStream(ByteStream *pStream) const
     writeResult &= binaryWriter.SafeWriteUInt32(m_chunkAvailability.GetValueCount());
     writeResult &= binaryWriter.SafeWriteBytes(m_chunkAvailability.GetValuesPointer(), sizeof(uint32) * m_chunkAvailability.GetValueCount());
 
-    // count available chunks
-    int32 availableChunkCount = 0;
-    for (int32 i = 0; i < m_chunkCount; i++)
-    {
-        if (m_chunkAvailability.TestBit(i))
-            availableChunkCount++;
-    }
-    
-    // calculate the offset to each lod level, and save it for checking later
-    uint32 *lodLevelOffsets = (uint32 *)alloca(sizeof(uint32) * m_lodLevels);
-    uint32 currentOffset = (uint32)binaryWriter.GetStreamPosition() + (sizeof(uint32) * m_lodLevels) + sizeof(uint32) + sizeof(uint32);
+    // encode each lod level's chunks, and compress them together, so the sizes are known before anything is written
+    PODArray<byte> compressedLODData[BLOCK_WORLD_MAX_LOD_LEVELS];
+    uint32 uncompressedLODSize[BLOCK_WORLD_MAX_LOD_LEVELS];
     for (int32 lodLevel = (m_lodLevels - 1); lodLevel >= 0; lodLevel--)
     {
-        // save offset
-        lodLevelOffsets[lodLevel] = currentOffset;
-
-        // calculate size of this lod
-        int32 chunkSizeInBlocks = m_chunkSize >> lodLevel;
-        int32 chunkSizeInBytes = (chunkSizeInBlocks * chunkSizeInBlocks * chunkSizeInBlocks) * (sizeof(BlockWorldBlockType) + sizeof(BlockWorldBlockDataType));
-        currentOffset += chunkSizeInBytes * availableChunkCount;
-    }
-
-    // write the offsets
-    writeResult &= binaryWriter.SafeWriteBytes(lodLevelOffsets, sizeof(uint32) * m_lodLevels);
-
-    // write entity offsets and counts
-    writeResult &= binaryWriter.SafeWriteUInt32(currentOffset);
-    writeResult &= binaryWriter.SafeWriteUInt32(m_entities.GetSize());
-
-    // now save each lod level's data
-    for (int32 lodLevel = (m_lodLevels - 1); lodLevel >= 0; lodLevel--)
-    {
-        DebugAssert(binaryWriter.GetStreamPosition() == lodLevelOffsets[lodLevel]);
-
+        BinaryWriteBuffer lodBuffer;
         int32 chunkIndex = 0;
         for (int32 z = m_minChunkZ; z <= m_maxChunkZ; z++)
         {
@@ -574,7 +578,7 @@ bool BlockWorldSection::SaveToStream(ByteStream *pStream) const
                     BlockWorldChunk *pChunk = m_ppChunks[thisChunkIndex];
                     DebugAssert(pChunk != nullptr);
 
-                    if (!pChunk->SaveToStream(lodLevel, pStream))
+                    if (!pChunk->SaveToStream(lodLevel, lodBuffer.GetStream()))
                     {
                         Log_ErrorPrintf("Failed to write section %i,%i chunk %i,%i,%i", m_sectionX, m_sectionY, x, y, z);
                         return false;
@@ -582,10 +586,46 @@ bool BlockWorldSection::SaveToStream(ByteStream *pStream) const
                 }
             }
         }
+
+        PODArray<byte> &compressedData = compressedLODData[lodLevel];
+        uncompressedLODSize[lodLevel] = lodBuffer.GetBufferSize();
+        compressedData.Resize(LZ4Compression::GetMaxCompressedSize(uncompressedLODSize[lodLevel]));
+        uint32 compressedSize = LZ4Compression::Compress(lodBuffer.GetBufferPointer(), uncompressedLODSize[lodLevel], compressedData.GetBasePointer(), compressedData.GetSize());
+        if (compressedSize == 0)
+        {
+            Log_ErrorPrintf("Failed to compress section %i,%i lod %i", m_sectionX, m_sectionY, lodLevel);
+            return false;
+        }
+        compressedData.Resize(compressedSize);
     }
-    
+
+    // calculate the offset to each lod level, and save it for checking later
+    uint32 *lodLevelOffsets = (uint32 *)alloca(sizeof(uint32) * m_lodLevels);
+    uint32 currentOffset = (uint32)binaryWriter.GetStreamPosition() + (sizeof(uint32) * m_lodLevels) + sizeof(uint32) + sizeof(uint32);
+    for (int32 lodLevel = (m_lodLevels - 1); lodLevel >= 0; lodLevel--)
+    {
+        lodLevelOffsets[lodLevel] = currentOffset;
+        currentOffset += sizeof(uint32) + sizeof(uint32) + compressedLODData[lodLevel].GetSize();
+    }
+
+    // write the offsets
+    writeResult &= binaryWriter.SafeWriteBytes(lodLevelOffsets, sizeof(uint32) * m_lodLevels);
+
+    // write entity offsets and counts
+    writeResult &= binaryWriter.SafeWriteUInt32(currentOffset);
+    writeResult &= binaryWriter.SafeWriteUInt32(m_entities.GetSize());
+
+    // now write each lod level's data
+    for (int32 lodLevel = (m_lodLevels - 1); lodLevel >= 0; lodLevel--)
+    {
+        DebugAssert(!writeResult || binaryWriter.GetStreamPosition() == lodLevelOffsets[lodLevel]);
+        writeResult &= binaryWriter.SafeWriteUInt32(uncompressedLODSize[lodLevel]);
+        writeResult &= binaryWriter.SafeWriteUInt32(compressedLODData[lodLevel].GetSize());
+        writeResult &= binaryWriter.SafeWriteBytes(compressedLODData[lodLevel].GetBasePointer(), compressedLODData[lodLevel].GetSize());
+    }
+
     // should be equal
-    DebugAssert(pStream->GetPosition() == currentOffset);
+    DebugAssert(!writeResult || pStream->GetPosition() == currentOffset);
 
     // write entities
     if (m_entities.GetSize() > 0)
@@ -720,6 +760,9 @@ void BlockWorldSection::RebuildLODs(int32 lodCount)
                     UpdateChunkLODLevels(pChunk, 0, blockX, blockY, blockZ);
             }
         }
+
+        // the coarser lods won't change again until something is edited
+        pChunk->PackLODs();
     }
 }
 
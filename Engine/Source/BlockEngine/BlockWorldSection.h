@@ -18,6 +18,7 @@ public:
     ~BlockWorldSection();
 
     // accessors
+    BlockWorld *GetWorld() { return m_pWorld; }
     const BlockWorld *GetWorld() const { return m_pWorld; }
     const int32 GetSectionSize() const { return m_sectionSize; }
     const int32 GetChunkSize() const { return m_chunkSize; }
@@ -11,13 +11,14 @@ class BlockWorldSection;
 class BlockWorldChunk;
 class BlockWorldChunkRenderProxy;
 class BlockWorldChunkCollisionShape;
+class BlockWorldLighting;
 
 // fixed limits
 #define BLOCK_WORLD_MAX_LOD_LEVELS (3)
 
 // block data type
 typedef uint16 BlockWorldBlockType;
-typedef uint8 BlockWorldBlockDataType;
+typedef uint16 BlockWorldBlockDataType;
 
 #define BLOCK_WORLD_BLOCK_VALUE_COLORED_FLAG_BIT    (0x8000U)
 #define BLOCK_WORLD_BLOCK_DATA_LIGHTING_MASK (0xF)
@@ -28,6 +29,21 @@ typedef uint8 BlockWorldBlockDataType;
 #define BLOCK_WORLD_BLOCK_DATA_ROTATION_SHIFT (6)
 #define BLOCK_WORLD_BLOCK_DATA_GET_ROTATION(data) (((data) >> BLOCK_WORLD_BLOCK_DATA_ROTATION_SHIFT) & BLOCK_WORLD_BLOCK_DATA_ROTATION_MASK)
 #define BLOCK_WORLD_BLOCK_DATA_SET_ROTATION(data, rotation) (((data) & ~(BLOCK_WORLD_BLOCK_DATA_ROTATION_MASK << BLOCK_WORLD_BLOCK_DATA_ROTATION_SHIFT)) | (((rotation) & BLOCK_WORLD_BLOCK_DATA_ROTATION_MASK) << BLOCK_WORLD_BLOCK_DATA_ROTATION_SHIFT))
+#define BLOCK_WORLD_BLOCK_DATA_SKY_LIGHTING_MASK (0xF)
+#define BLOCK_WORLD_BLOCK_DATA_SKY_LIGHTING_SHIFT (8)
+#define BLOCK_WORLD_BLOCK_DATA_GET_SKY_LIGHTING(data) (((data) >> BLOCK_WORLD_BLOCK_DATA_SKY_LIGHTING_SHIFT) & BLOCK_WORLD_BLOCK_DATA_SKY_LIGHTING_MASK)
+#define BLOCK_WORLD_BLOCK_DATA_SET_SKY_LIGHTING(data, lighting) (((data) & ~(BLOCK_WORLD_BLOCK_DATA_SKY_LIGHTING_MASK << BLOCK_WORLD_BLOCK_DATA_SKY_LIGHTING_SHIFT)) | (((lighting) & BLOCK_WORLD_BLOCK_DATA_SKY_LIGHTING_MASK) << BLOCK_WORLD_BLOCK_DATA_SKY_LIGHTING_SHIFT))
+
+// light levels
+#define BLOCK_WORLD_MAX_LIGHT_LEVEL (15)
+
+// light channels, block light comes from emitters, sky light from open sky above
+enum BLOCK_WORLD_LIGHT_CHANNEL
+{
+    BLOCK_WORLD_LIGHT_CHANNEL_BLOCK,
+    BLOCK_WORLD_LIGHT_CHANNEL_SKY,
+    NUM_BLOCK_WORLD_LIGHT_CHANNELS,
+};
 
 // rotation enumeration
 enum BLOCK_WORLD_BLOCK_ROTATION
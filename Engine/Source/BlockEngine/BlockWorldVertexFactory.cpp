@@ -8,14 +8,34 @@ DEFINE_VERTEX_FACTORY_TYPE_INFO(BlockWorldVertexFactory);
 BEGIN_SHADER_COMPONENT_PARAMETERS(BlockWorldVertexFactory)
 END_SHADER_COMPONENT_PARAMETERS()
 
+// 8.8 fixed point positions and texture coordinates
+const float BlockWorldVertexFactory::PACKED_POSITION_SCALE = 256.0f;
+const float BlockWorldVertexFactory::PACKED_POSITION_MAX = 65535.0f / 256.0f;
+const float BlockWorldVertexFactory::PACKED_TEXCOORD_SCALE = 256.0f;
+const float BlockWorldVertexFactory::PACKED_TEXCOORD_MAX = 32767.0f / 256.0f;
+
 bool BlockWorldVertexFactory::IsValidPermutation(uint32 globalShaderFlags, const ShaderComponentTypeInfo *pBaseShaderTypeInfo, uint32 baseShaderFlags, const VertexFactoryTypeInfo *pVertexFactoryTypeInfo, uint32 vertexFactoryFlags, const MaterialShader *pMaterialShader, uint32 materialShaderFlags)
 {
+    // packed vertices are unpacked with integer ops, which need SM4
+    if ((vertexFactoryFlags & BLOCK_WORLD_VERTEX_FACTORY_FLAG_PACKED_VERTICES) && g_pRenderer != nullptr && g_pRenderer->GetFeatureLevel() < RENDERER_FEATURE_LEVEL_SM4)
+        return false;
+
     return true;
 }
 
 bool BlockWorldVertexFactory::FillShaderCompilerParameters(uint32 globalShaderFlags, uint32 baseShaderFlags, uint32 vertexFactoryFlags, ShaderCompilerParameters *pParameters)
 {
     pParameters->SetVertexFactoryFileName("shaders/base/BlockWorldVertexFactory.hlsl");
+
+    if (vertexFactoryFlags & BLOCK_WORLD_VERTEX_FACTORY_FLAG_PACKED_VERTICES)
+    {
+        // the renderer may not be running when compiling offline
+        if (pParameters->FeatureLevel < RENDERER_FEATURE_LEVEL_SM4)
+            return false;
+
+        pParameters->AddPreprocessorMacro("BLOCK_WORLD_VERTEX_FACTORY_FLAG_PACKED_VERTICES", "1");
+    }
+
     return true;
 }
 
@@ -27,6 +47,48 @@ uint32 BlockWorldVertexFactory::GetVertexElementsDesc(RENDERER_PLATFORM platform
     uint32 nElements = 0;
     uint32 nStreams = 0;
 
+    // packed vertices, single stream
+    if (flags & BLOCK_WORLD_VERTEX_FACTORY_FLAG_PACKED_VERTICES)
+    {
+        streamOffset = 0;
+
+        // position, frame index and texture index
+        pElementDesc->Semantic = GPU_VERTEX_ELEMENT_SEMANTIC_POSITION;
+        pElementDesc->SemanticIndex = 0;
+        pElementDesc->Type = GPU_VERTEX_ELEMENT_TYPE_UINT2;
+        pElementDesc->StreamIndex = nStreams;
+        pElementDesc->StreamOffset = streamOffset;
+        pElementDesc->InstanceStepRate = 0;
+        streamOffset += sizeof(uint32) * 2;
+        pElementDesc++;
+        nElements++;
+
+        // texcoord
+        pElementDesc->Semantic = GPU_VERTEX_ELEMENT_SEMANTIC_TEXCOORD;
+        pElementDesc->SemanticIndex = 0;
+        pElementDesc->Type = GPU_VERTEX_ELEMENT_TYPE_UINT;
+        pElementDesc->StreamIndex = nStreams;
+        pElementDesc->StreamOffset = streamOffset;
+        pElementDesc->InstanceStepRate = 0;
+        streamOffset += sizeof(uint32);
+        pElementDesc++;
+        nElements++;
+
+        // color
+        pElementDesc->Semantic = GPU_VERTEX_ELEMENT_SEMANTIC_COLOR;
+        pElementDesc->SemanticIndex = 0;
+        pElementDesc->Type = GPU_VERTEX_ELEMENT_TYPE_UNORM4;
+        pElementDesc->StreamIndex = nStreams;
+        pElementDesc->StreamOffset = streamOffset;
+        pElementDesc->InstanceStepRate = 0;
+        streamOffset += sizeof(uint32);
+        pElementDesc++;
+        nElements++;
+
+        DebugAssert(streamOffset == sizeof(PackedVertex));
+        return nElements;
+    }
+
     // build stream 0
     {
         streamOffset = 0;
@@ -153,3 +215,104 @@ void BlockWorldVertexFactory::Vertex::Set(const float3 &position, const float3 &
     TangentAndSign = packedTangentAndSign;
     Normal = packedNormal;
 }
+
+// horizontal directions in 22.5 degree steps, matches PACKED_FRAME_DIRECTIONS in the shader
+static const float PACKED_FRAME_DIRECTIONS[16][2] =
+{
+    { 1.0f, 0.0f }, { 0.92388f, 0.382683f }, { 0.707107f, 0.707107f }, { 0.382683f, 0.92388f },
+    { 0.0f, 1.0f }, { -0.382683f, 0.92388f }, { -0.707107f, 0.707107f }, { -0.92388f, 0.382683f },
+    { -1.0f, 0.0f }, { -0.92388f, -0.382683f }, { -0.707107f, -0.707107f }, { -0.382683f, -0.92388f },
+    { 0.0f, -1.0f }, { 0.382683f, -0.92388f }, { 0.707107f, -0.707107f }, { 0.92388f, -0.382683f }
+};
+
+// frame indices for vertical normals
+static const uint32 PACKED_FRAME_INDEX_UP = 32;
+static const uint32 PACKED_FRAME_INDEX_DOWN = 33;
+
+// normals/tangents must be within ~8 degrees of a fixed frame
+static const float PACKED_FRAME_TOLERANCE = 0.99f;
+
+static bool FindPackedFrameIndex(uint32 packedTangentAndSign, uint32 packedNormal, uint32 *pFrameIndex)
+{
+    union
+    {
+        uint32 asUInt32;
+        int8 asInt8[4];
+    } converter;
+
+    converter.asUInt32 = packedTangentAndSign;
+    float3 tangent((float)converter.asInt8[0], (float)converter.asInt8[1], (float)converter.asInt8[2]);
+    bool negativeBinormalSign = (converter.asInt8[3] < 0);
+    converter.asUInt32 = packedNormal;
+    float3 normal((float)converter.asInt8[0], (float)converter.asInt8[1], (float)converter.asInt8[2]);
+    tangent.SafeNormalizeInPlace();
+    normal.SafeNormalizeInPlace();
+
+    // top/bottom faces, tangent is always +x
+    if (Math::Abs(normal.z) >= PACKED_FRAME_TOLERANCE)
+    {
+        bool up = (normal.z > 0.0f);
+        if (tangent.x < PACKED_FRAME_TOLERANCE || negativeBinormalSign != up)
+            return false;
+
+        *pFrameIndex = (up) ? PACKED_FRAME_INDEX_UP : PACKED_FRAME_INDEX_DOWN;
+        return true;
+    }
+
+    // snap to the nearest horizontal direction
+    uint32 directionIndex = 0;
+    float bestDot = -1.0f;
+    for (uint32 i = 0; i < countof(PACKED_FRAME_DIRECTIONS); i++)
+    {
+        float dot = normal.x * PACKED_FRAME_DIRECTIONS[i][0] + normal.y * PACKED_FRAME_DIRECTIONS[i][1];
+        if (dot > bestDot)
+        {
+            directionIndex = i;
+            bestDot = dot;
+        }
+    }
+    if (bestDot < PACKED_FRAME_TOLERANCE)
+        return false;
+
+    // tangent is the direction rotated by -90 degrees, or +90 with a negative binormal sign
+    const float *direction = PACKED_FRAME_DIRECTIONS[directionIndex];
+    float tangentSign = (negativeBinormalSign) ? -1.0f : 1.0f;
+    if ((tangent.x * direction[1] - tangent.y * direction[0]) * tangentSign < PACKED_FRAME_TOLERANCE)
+        return false;
+
+    *pFrameIndex = directionIndex + ((negativeBinormalSign) ? 16 : 0);
+    return true;
+}
+
+bool BlockWorldVertexFactory::PackVertex(const Vertex &vertex, const float3 &origin, PackedVertex *pPackedVertex)
+{
+    float3 position(vertex.Position - origin);
+    if (position.x < 0.0f || position.y < 0.0f || position.z < 0.0f ||
+        position.x > PACKED_POSITION_MAX || position.y > PACKED_POSITION_MAX || position.z > PACKED_POSITION_MAX)
+    {
+        return false;
+    }
+
+    if (Math::Abs(vertex.TexCoord.x) > PACKED_TEXCOORD_MAX || Math::Abs(vertex.TexCoord.y) > PACKED_TEXCOORD_MAX ||
+        vertex.TexCoord.z < 0.0f || vertex.TexCoord.z > (float)PACKED_TEXTURE_INDEX_MAX)
+    {
+        return false;
+    }
+
+    uint32 frameIndex;
+    if (!FindPackedFrameIndex(vertex.TangentAndSign, vertex.Normal, &frameIndex))
+        return false;
+
+    uint32 x = (uint32)Math::Truncate(Math::Round(position.x * PACKED_POSITION_SCALE));
+    uint32 y = (uint32)Math::Truncate(Math::Round(position.y * PACKED_POSITION_SCALE));
+    uint32 z = (uint32)Math::Truncate(Math::Round(position.z * PACKED_POSITION_SCALE));
+    uint32 textureIndex = (uint32)Math::Truncate(Math::Round(vertex.TexCoord.z));
+    uint16 u = (uint16)(int16)Math::Truncate(Math::Round(vertex.TexCoord.x * PACKED_TEXCOORD_SCALE));
+    uint16 v = (uint16)(int16)Math::Truncate(Math::Round(vertex.TexCoord.y * PACKED_TEXCOORD_SCALE));
+
+    pPackedVertex->PositionXY = x | (y << 16);
+    pPackedVertex->PositionZAndFrame = z | (frameIndex << 16) | (textureIndex << 22);
+    pPackedVertex->TexCoord = (uint32)u | ((uint32)v << 16);
+    pPackedVertex->Color = vertex.Color;
+    return true;
+}
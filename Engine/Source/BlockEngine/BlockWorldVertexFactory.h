@@ -1,6 +1,11 @@
 #pragma once
 #include "Renderer/VertexFactory.h"
 
+enum BLOCK_WORLD_VERTEX_FACTORY_FLAGS
+{
+    BLOCK_WORLD_VERTEX_FACTORY_FLAG_PACKED_VERTICES         = (1 << 0),
+};
+
 class BlockWorldVertexFactory : public VertexFactory
 {
     DECLARE_VERTEX_FACTORY_TYPE_INFO(BlockWorldVertexFactory, VertexFactory);
@@ -25,8 +30,32 @@ public:
         void Set(const float3 &position, const float3 &texcoord, uint32 color, const float3 &tangent, const float3 &binormal, const float3 &normal);
         void Set(const float3 &position, const float3 &texcoord, uint32 color, uint32 packedTangentAndSign, uint32 packedNormal);
     };
+
+    // Compact chunk vertex, positions are relative to the chunk origin. Requires integer vertex attributes.
+    //   PositionXY: x and y in 8.8 fixed point
+    //   PositionZAndFrame: z in 8.8 fixed point, tangent frame index in bits 16-21, texture array index in bits 22-31
+    //   TexCoord: u and v as signed 8.8 fixed point
+    //   Color: rgb colour, light value in alpha
+    struct PackedVertex
+    {
+        uint32 PositionXY;
+        uint32 PositionZAndFrame;
+        uint32 TexCoord;
+        uint32 Color;
+    };
 #pragma pack(pop)
 
+    // packed vertex limits
+    static const float PACKED_POSITION_SCALE;
+    static const float PACKED_POSITION_MAX;
+    static const float PACKED_TEXCOORD_SCALE;
+    static const float PACKED_TEXCOORD_MAX;
+    static const uint32 PACKED_TEXTURE_INDEX_MAX = 1023;
+
+    // Packs a vertex relative to the specified origin. Returns false if the vertex is out of range,
+    // or its tangent frame can't be represented by one of the fixed frames.
+    static bool PackVertex(const Vertex &vertex, const float3 &origin, PackedVertex *pPackedVertex);
+
 public:
     static bool IsValidPermutation(uint32 globalShaderFlags, const ShaderComponentTypeInfo *pBaseShaderTypeInfo, uint32 baseShaderFlags, const VertexFactoryTypeInfo *pVertexFactoryTypeInfo, uint32 vertexFactoryFlags, const MaterialShader *pMaterialShader, uint32 materialShaderFlags);
     static bool FillShaderCompilerParameters(uint32 globalShaderFlags, uint32 baseShaderFlags, uint32 vertexFactoryFlags, ShaderCompilerParameters *pParameters);
@@ -0,0 +1,731 @@
+#include "Core/PrecompiledHeader.h"
+#include "Core/BlockCompression.h"
+#include "YBaseLib/MemArray.h"
+#include "YBaseLib/PODArray.h"
+#include "YBaseLib/Thread.h"
+#include "YBaseLib/CPUID.h"
+#include "YBaseLib/Assert.h"
+#include "YBaseLib/Log.h"
+#include <atomic>
+Log_SetChannel(BlockCompression);
+
+#ifdef HAVE_SQUISH
+#include <squish.h>
+#endif
+
+namespace NameTables {
+    Y_Define_NameTable(BlockCompressionQuality)
+        Y_NameTable_VEntry(BLOCK_COMPRESSION_QUALITY_FAST, "Fast")
+        Y_NameTable_VEntry(BLOCK_COMPRESSION_QUALITY_NORMAL, "Normal")
+        Y_NameTable_VEntry(BLOCK_COMPRESSION_QUALITY_SLOW, "Slow")
+    Y_NameTable_End()
+}
+
+// block rows handed to a thread at a time
+static const uint32 BLOCK_ROWS_PER_STRIP = 8;
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// BC4/BC5
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// eight interpolated values when endpoint0 > endpoint1, otherwise six plus 0 and 255
+static void GetSingleChannelPalette(uint32 endpoint0, uint32 endpoint1, uint32 pPalette[8])
+{
+    pPalette[0] = endpoint0;
+    pPalette[1] = endpoint1;
+    if (endpoint0 > endpoint1)
+    {
+        for (uint32 i = 1; i < 7; i++)
+            pPalette[i + 1] = ((7 - i) * endpoint0 + i * endpoint1 + 3) / 7;
+    }
+    else
+    {
+        for (uint32 i = 1; i < 5; i++)
+            pPalette[i + 1] = ((5 - i) * endpoint0 + i * endpoint1 + 2) / 5;
+
+        pPalette[6] = 0;
+        pPalette[7] = 255;
+    }
+}
+
+// picks the closest palette entry for each pixel, returning the squared error
+static uint32 FitSingleChannelIndices(const byte pValues[16], uint32 mask, uint32 endpoint0, uint32 endpoint1, uint64 *pIndices)
+{
+    uint32 palette[8];
+    GetSingleChannelPalette(endpoint0, endpoint1, palette);
+
+    uint32 totalError = 0;
+    uint64 indices = 0;
+    for (uint32 i = 0; i < 16; i++)
+    {
+        if (!(mask & (1 << i)))
+            continue;
+
+        uint32 bestIndex = 0;
+        uint32 bestError = 0xFFFFFFFF;
+        for (uint32 j = 0; j < 8; j++)
+        {
+            int32 difference = (int32)palette[j] - (int32)pValues[i];
+            uint32 error = (uint32)(difference * difference);
+            if (error < bestError)
+            {
+                bestIndex = j;
+                bestError = error;
+            }
+        }
+
+        indices |= (uint64)bestIndex << (i * 3);
+        totalError += bestError;
+    }
+
+    *pIndices = indices;
+    return totalError;
+}
+
+static void EncodeSingleChannelBlock(BLOCK_COMPRESSION_QUALITY quality, const byte *pPixels, uint32 channel, uint32 mask, byte *pBlock)
+{
+    // gather the channel, and its range with and without the values the six value mode has for free
+    byte values[16];
+    uint32 minValue = 255, maxValue = 0;
+    uint32 innerMinValue = 255, innerMaxValue = 0;
+    for (uint32 i = 0; i < 16; i++)
+    {
+        values[i] = pPixels[i * 4 + channel];
+        if (!(mask & (1 << i)))
+            continue;
+
+        minValue = Min(minValue, (uint32)values[i]);
+        maxValue = Max(maxValue, (uint32)values[i]);
+        if (values[i] != 0 && values[i] != 255)
+        {
+            innerMinValue = Min(innerMinValue, (uint32)values[i]);
+            innerMaxValue = Max(innerMaxValue, (uint32)values[i]);
+        }
+    }
+
+    if (minValue > maxValue)
+    {
+        Y_memzero(pBlock, 8);
+        return;
+    }
+
+    // eight value mode between the extremes, collapsing to a single value block when flat
+    uint32 bestEndpoint0 = maxValue;
+    uint32 bestEndpoint1 = minValue;
+    uint64 bestIndices;
+    uint32 bestError = FitSingleChannelIndices(values, mask, bestEndpoint0, bestEndpoint1, &bestIndices);
+
+    // six value mode covers blocks with both black and white texels better
+    if (quality >= BLOCK_COMPRESSION_QUALITY_NORMAL && bestError > 0 && innerMinValue <= innerMaxValue)
+    {
+        uint64 indices;
+        uint32 error = FitSingleChannelIndices(values, mask, innerMinValue, innerMaxValue, &indices);
+        if (error < bestError)
+        {
+            bestEndpoint0 = innerMinValue;
+            bestEndpoint1 = innerMaxValue;
+            bestIndices = indices;
+            bestError = error;
+        }
+    }
+
+    // search around the endpoints, keeping the mode
+    if (quality >= BLOCK_COMPRESSION_QUALITY_SLOW && bestError > 0)
+    {
+        static const int32 SEARCH_RADIUS = 4;
+        int32 centerEndpoint0 = (int32)bestEndpoint0;
+        int32 centerEndpoint1 = (int32)bestEndpoint1;
+        bool eightValueMode = (bestEndpoint0 > bestEndpoint1);
+        for (int32 offset0 = -SEARCH_RADIUS; offset0 <= SEARCH_RADIUS; offset0++)
+        {
+            for (int32 offset1 = -SEARCH_RADIUS; offset1 <= SEARCH_RADIUS; offset1++)
+            {
+                int32 endpoint0 = centerEndpoint0 + offset0;
+                int32 endpoint1 = centerEndpoint1 + offset1;
+                if (endpoint0 < 0 || endpoint0 > 255 || endpoint1 < 0 || endpoint1 > 255 || (endpoint0 > endpoint1) != eightValueMode)
+                    continue;
+
+                uint64 indices;
+                uint32 error = FitSingleChannelIndices(values, mask, (uint32)endpoint0, (uint32)endpoint1, &indices);
+                if (error < bestError)
+                {
+                    bestEndpoint0 = (uint32)endpoint0;
+                    bestEndpoint1 = (uint32)endpoint1;
+                    bestIndices = indices;
+                    bestError = error;
+                }
+            }
+        }
+    }
+
+    // two endpoint bytes, then 48 bits of 3-bit indices
+    pBlock[0] = (byte)bestEndpoint0;
+    pBlock[1] = (byte)bestEndpoint1;
+    for (uint32 i = 0; i < 6; i++)
+        pBlock[2 + i] = (byte)(bestIndices >> (i * 8));
+}
+
+static void DecodeSingleChannelBlock(const byte *pBlock, byte *pPixels, uint32 channel)
+{
+    uint32 palette[8];
+    GetSingleChannelPalette(pBlock[0], pBlock[1], palette);
+
+    uint64 indices = 0;
+    for (uint32 i = 0; i < 6; i++)
+        indices |= (uint64)pBlock[2 + i] << (i * 8);
+
+    for (uint32 i = 0; i < 16; i++)
+        pPixels[i * 4 + channel] = (byte)palette[(indices >> (i * 3)) & 7];
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// BC7, mode 6 only
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+static const uint32 BC7_MODE6_WEIGHTS[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+// endpoints after quantization, 7 bits per channel plus the shared p-bit
+struct BC7Endpoints
+{
+    uint32 Values[2][4];
+};
+
+static inline void WriteBlockBits(byte *pBlock, uint32 &bitPosition, uint32 value, uint32 bitCount)
+{
+    for (uint32 i = 0; i < bitCount; i++, bitPosition++)
+        pBlock[bitPosition >> 3] |= (byte)(((value >> i) & 1) << (bitPosition & 7));
+}
+
+static void QuantizeBC7Endpoint(const float pEndpoint[4], uint32 pBit, uint32 pValues[4])
+{
+    for (uint32 c = 0; c < 4; c++)
+    {
+        int32 quantized = Math::Truncate((Math::Clamp(pEndpoint[c], 0.0f, 255.0f) - (float)pBit) * 0.5f + 0.5f);
+        pValues[c] = ((uint32)Math::Clamp(quantized, 0, 127) << 1) | pBit;
+    }
+}
+
+// picks the p-bit with the lowest quantization error
+static void QuantizeBC7EndpointBestPBit(const float pEndpoint[4], uint32 pValues[4])
+{
+    uint32 candidates[2][4];
+    float errors[2];
+    for (uint32 pBit = 0; pBit < 2; pBit++)
+    {
+        QuantizeBC7Endpoint(pEndpoint, pBit, candidates[pBit]);
+        errors[pBit] = 0.0f;
+        for (uint32 c = 0; c < 4; c++)
+        {
+            float difference = (float)candidates[pBit][c] - pEndpoint[c];
+            errors[pBit] += difference * difference;
+        }
+    }
+
+    uint32 bestPBit = (errors[1] < errors[0]) ? 1 : 0;
+    Y_memcpy(pValues, candidates[bestPBit], sizeof(uint32) * 4);
+}
+
+static uint32 FitBC7Indices(const int32 pPixels[16][4], uint32 mask, const BC7Endpoints &endpoints, uint32 pIndices[16])
+{
+    int32 palette[16][4];
+    for (uint32 i = 0; i < 16; i++)
+    {
+        uint32 weight = BC7_MODE6_WEIGHTS[i];
+        for (uint32 c = 0; c < 4; c++)
+            palette[i][c] = (int32)(((64 - weight) * endpoints.Values[0][c] + weight * endpoints.Values[1][c] + 32) >> 6);
+    }
+
+    uint32 totalError = 0;
+    for (uint32 i = 0; i < 16; i++)
+    {
+        pIndices[i] = 0;
+        if (!(mask & (1 << i)))
+            continue;
+
+        uint32 bestError = 0xFFFFFFFF;
+        for (uint32 j = 0; j < 16; j++)
+        {
+            uint32 error = 0;
+            for (uint32 c = 0; c < 4; c++)
+            {
+                int32 difference = palette[j][c] - pPixels[i][c];
+                error += (uint32)(difference * difference);
+            }
+
+            if (error < bestError)
+            {
+                pIndices[i] = j;
+                bestError = error;
+            }
+        }
+
+        totalError += bestError;
+    }
+
+    return totalError;
+}
+
+// least squares endpoints for the current index assignment
+static bool RefitBC7Endpoints(const int32 pPixels[16][4], uint32 mask, const uint32 pIndices[16], float pEndpoints[2][4])
+{
+    float sumAA = 0.0f, sumAB = 0.0f, sumBB = 0.0f;
+    float sumAX[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+    float sumBX[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+    for (uint32 i = 0; i < 16; i++)
+    {
+        if (!(mask & (1 << i)))
+            continue;
+
+        float b = (float)BC7_MODE6_WEIGHTS[pIndices[i]] / 64.0f;
+        float a = 1.0f - b;
+        sumAA += a * a;
+        sumAB += a * b;
+        sumBB += b * b;
+        for (uint32 c = 0; c < 4; c++)
+        {
+            sumAX[c] += a * (float)pPixels[i][c];
+            sumBX[c] += b * (float)pPixels[i][c];
+        }
+    }
+
+    float determinant = sumAA * sumBB - sumAB * sumAB;
+    if (Y_fabs(determinant) < 1e-6f)
+        return false;
+
+    float inverseDeterminant = 1.0f / determinant;
+    for (uint32 c = 0; c < 4; c++)
+    {
+        pEndpoints[0][c] = Math::Clamp((sumBB * sumAX[c] - sumAB * sumBX[c]) * inverseDeterminant, 0.0f, 255.0f);
+        pEndpoints[1][c] = Math::Clamp((sumAA * sumBX[c] - sumAB * sumAX[c]) * inverseDeterminant, 0.0f, 255.0f);
+    }
+
+    return true;
+}
+
+static void EncodeBC7Block(BLOCK_COMPRESSION_QUALITY quality, const byte *pPixels, uint32 mask, byte *pBlock)
+{
+    int32 pixels[16][4];
+    float mean[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+    float minValues[4] = { 255.0f, 255.0f, 255.0f, 255.0f };
+    float maxValues[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+    uint32 pixelCount = 0;
+    for (uint32 i = 0; i < 16; i++)
+    {
+        for (uint32 c = 0; c < 4; c++)
+            pixels[i][c] = (int32)pPixels[i * 4 + c];
+
+        if (!(mask & (1 << i)))
+            continue;
+
+        for (uint32 c = 0; c < 4; c++)
+        {
+            mean[c] += (float)pixels[i][c];
+            minValues[c] = Min(minValues[c], (float)pixels[i][c]);
+            maxValues[c] = Max(maxValues[c], (float)pixels[i][c]);
+        }
+        pixelCount++;
+    }
+
+    BC7Endpoints endpoints;
+    uint32 indices[16];
+    Y_memzero(&endpoints, sizeof(endpoints));
+    Y_memzero(indices, sizeof(indices));
+
+    if (pixelCount > 0)
+    {
+        for (uint32 c = 0; c < 4; c++)
+            mean[c] /= (float)pixelCount;
+
+        // covariance of the block
+        float covariance[4][4];
+        Y_memzero(covariance, sizeof(covariance));
+        for (uint32 i = 0; i < 16; i++)
+        {
+            if (!(mask & (1 << i)))
+                continue;
+
+            float offset[4];
+            for (uint32 c = 0; c < 4; c++)
+                offset[c] = (float)pixels[i][c] - mean[c];
+            for (uint32 r = 0; r < 4; r++)
+            {
+                for (uint32 c = 0; c < 4; c++)
+                    covariance[r][c] += offset[r] * offset[c];
+            }
+        }
+
+        // principal axis by power iteration, starting from the bounding box diagonal
+        float axis[4];
+        for (uint32 c = 0; c < 4; c++)
+            axis[c] = maxValues[c] - minValues[c];
+
+        uint32 iterationCount = (quality == BLOCK_COMPRESSION_QUALITY_FAST) ? 4 : 8;
+        for (uint32 iteration = 0; iteration < iterationCount; iteration++)
+        {
+            float nextAxis[4];
+            float largest = 0.0f;
+            for (uint32 r = 0; r < 4; r++)
+            {
+                nextAxis[r] = covariance[r][0] * axis[0] + covariance[r][1] * axis[1] + covariance[r][2] * axis[2] + covariance[r][3] * axis[3];
+                largest = Max(largest, Y_fabs(nextAxis[r]));
+            }
+            if (largest == 0.0f)
+                break;
+
+            for (uint32 c = 0; c < 4; c++)
+                axis[c] = nextAxis[c] / largest;
+        }
+
+        // extents of the block along the axis
+        float axisLengthSquared = axis[0] * axis[0] + axis[1] * axis[1] + axis[2] * axis[2] + axis[3] * axis[3];
+        float minProjection = 0.0f, maxProjection = 0.0f;
+        if (axisLengthSquared > 0.0f)
+        {
+            minProjection = Y_FLT_MAX;
+            maxProjection = -Y_FLT_MAX;
+            for (uint32 i = 0; i < 16; i++)
+            {
+                if (!(mask & (1 << i)))
+                    continue;
+
+                float projection = 0.0f;
+                for (uint32 c = 0; c < 4; c++)
+                    projection += ((float)pixels[i][c] - mean[c]) * axis[c];
+
+                minProjection = Min(minProjection, projection);
+                maxProjection = Max(maxProjection, projection);
+            }
+
+            minProjection /= axisLengthSquared;
+            maxProjection /= axisLengthSquared;
+        }
+
+        float floatEndpoints[2][4];
+        for (uint32 c = 0; c < 4; c++)
+        {
+            floatEndpoints[0][c] = Math::Clamp(mean[c] + axis[c] * minProjection, 0.0f, 255.0f);
+            floatEndpoints[1][c] = Math::Clamp(mean[c] + axis[c] * maxProjection, 0.0f, 255.0f);
+        }
+
+        QuantizeBC7EndpointBestPBit(floatEndpoints[0], endpoints.Values[0]);
+        QuantizeBC7EndpointBestPBit(floatEndpoints[1], endpoints.Values[1]);
+        uint32 bestError = FitBC7Indices(pixels, mask, endpoints, indices);
+
+        // refine the endpoints against the chosen indices, keeping them only if the block improves
+        uint32 refineCount = (quality == BLOCK_COMPRESSION_QUALITY_FAST) ? 0 : ((quality == BLOCK_COMPRESSION_QUALITY_NORMAL) ? 1 : 3);
+        for (uint32 refine = 0; refine < refineCount && bestError > 0; refine++)
+        {
+            if (!RefitBC7Endpoints(pixels, mask, indices, floatEndpoints))
+                break;
+
+            BC7Endpoints refinedEndpoints;
+            uint32 refinedIndices[16];
+            QuantizeBC7EndpointBestPBit(floatEndpoints[0], refinedEndpoints.Values[0]);
+            QuantizeBC7EndpointBestPBit(floatEndpoints[1], refinedEndpoints.Values[1]);
+            uint32 error = FitBC7Indices(pixels, mask, refinedEndpoints, refinedIndices);
+            if (error >= bestError)
+                break;
+
+            endpoints = refinedEndpoints;
+            Y_memcpy(indices, refinedIndices, sizeof(indices));
+            bestError = error;
+        }
+
+        // try every p-bit pair, rounding the endpoints differently
+        if (quality >= BLOCK_COMPRESSION_QUALITY_SLOW && bestError > 0)
+        {
+            for (uint32 pBits = 0; pBits < 4; pBits++)
+            {
+                BC7Endpoints candidateEndpoints;
+                uint32 candidateIndices[16];
+                QuantizeBC7Endpoint(floatEndpoints[0], pBits & 1, candidateEndpoints.Values[0]);
+                QuantizeBC7Endpoint(floatEndpoints[1], pBits >> 1, candidateEndpoints.Values[1]);
+                uint32 error = FitBC7Indices(pixels, mask, candidateEndpoints, candidateIndices);
+                if (error < bestError)
+                {
+                    endpoints = candidateEndpoints;
+                    Y_memcpy(indices, candidateIndices, sizeof(indices));
+                    bestError = error;
+                }
+            }
+        }
+
+        // the anchor index has its high bit implied zero
+        if (indices[0] & 8)
+        {
+            for (uint32 c = 0; c < 4; c++)
+                Swap(endpoints.Values[0][c], endpoints.Values[1][c]);
+            for (uint32 i = 0; i < 16; i++)
+                indices[i] = 15 - indices[i];
+        }
+    }
+
+    // mode bit, endpoints per channel, p-bits, indices
+    uint32 bitPosition = 0;
+    Y_memzero(pBlock, 16);
+    WriteBlockBits(pBlock, bitPosition, 1 << 6, 7);
+    for (uint32 c = 0; c < 4; c++)
+    {
+        WriteBlockBits(pBlock, bitPosition, endpoints.Values[0][c] >> 1, 7);
+        WriteBlockBits(pBlock, bitPosition, endpoints.Values[1][c] >> 1, 7);
+    }
+    WriteBlockBits(pBlock, bitPosition, endpoints.Values[0][0] & 1, 1);
+    WriteBlockBits(pBlock, bitPosition, endpoints.Values[1][0] & 1, 1);
+    WriteBlockBits(pBlock, bitPosition, indices[0], 3);
+    for (uint32 i = 1; i < 16; i++)
+        WriteBlockBits(pBlock, bitPosition, indices[i], 4);
+
+    DebugAssert(bitPosition == 128);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+namespace BlockCompression
+{
+
+bool IsSupportedFormat(PIXEL_FORMAT format)
+{
+    switch (format)
+    {
+#ifdef HAVE_SQUISH
+    case PIXEL_FORMAT_BC1_UNORM:
+    case PIXEL_FORMAT_BC1_UNORM_SRGB:
+    case PIXEL_FORMAT_BC2_UNORM:
+    case PIXEL_FORMAT_BC2_UNORM_SRGB:
+    case PIXEL_FORMAT_BC3_UNORM:
+    case PIXEL_FORMAT_BC3_UNORM_SRGB:
+#endif
+    case PIXEL_FORMAT_BC4_UNORM:
+    case PIXEL_FORMAT_BC5_UNORM:
+    case PIXEL_FORMAT_BC7_UNORM:
+    case PIXEL_FORMAT_BC7_UNORM_SRGB:
+        return true;
+
+    default:
+        return false;
+    }
+}
+
+void EncodeBlock(PIXEL_FORMAT format, BLOCK_COMPRESSION_QUALITY quality, const byte pPixels[64], uint32 mask, void *pBlock)
+{
+    switch (format)
+    {
+#ifdef HAVE_SQUISH
+    case PIXEL_FORMAT_BC1_UNORM:
+    case PIXEL_FORMAT_BC1_UNORM_SRGB:
+    case PIXEL_FORMAT_BC2_UNORM:
+    case PIXEL_FORMAT_BC2_UNORM_SRGB:
+    case PIXEL_FORMAT_BC3_UNORM:
+    case PIXEL_FORMAT_BC3_UNORM_SRGB:
+        {
+            int flags;
+            if (format == PIXEL_FORMAT_BC1_UNORM || format == PIXEL_FORMAT_BC1_UNORM_SRGB)
+                flags = squish::kDxt1;
+            else if (format == PIXEL_FORMAT_BC2_UNORM || format == PIXEL_FORMAT_BC2_UNORM_SRGB)
+                flags = squish::kDxt3;
+            else
+                flags = squish::kDxt5;
+
+            if (quality == BLOCK_COMPRESSION_QUALITY_FAST)
+                flags |= squish::kColourRangeFit;
+            else if (quality == BLOCK_COMPRESSION_QUALITY_NORMAL)
+                flags |= squish::kColourClusterFit;
+            else
+                flags |= squish::kColourIterativeClusterFit;
+
+            squish::CompressMasked((const squish::u8 *)pPixels, (int)mask, pBlock, flags);
+        }
+        break;
+#endif
+
+    case PIXEL_FORMAT_BC4_UNORM:
+        EncodeSingleChannelBlock(quality, pPixels, 0, mask, (byte *)pBlock);
+        break;
+
+    case PIXEL_FORMAT_BC5_UNORM:
+        EncodeSingleChannelBlock(quality, pPixels, 0, mask, (byte *)pBlock);
+        EncodeSingleChannelBlock(quality, pPixels, 1, mask, (byte *)pBlock + 8);
+        break;
+
+    case PIXEL_FORMAT_BC7_UNORM:
+    case PIXEL_FORMAT_BC7_UNORM_SRGB:
+        EncodeBC7Block(quality, pPixels, mask, (byte *)pBlock);
+        break;
+
+    default:
+        UnreachableCode();
+        break;
+    }
+}
+
+bool DecodeBlock(PIXEL_FORMAT format, const void *pBlock, byte pPixels[64])
+{
+    switch (format)
+    {
+    case PIXEL_FORMAT_BC4_UNORM:
+        Y_memset(pPixels, 255, 64);
+        DecodeSingleChannelBlock((const byte *)pBlock, pPixels, 0);
+        return true;
+
+    case PIXEL_FORMAT_BC5_UNORM:
+        Y_memset(pPixels, 255, 64);
+        DecodeSingleChannelBlock((const byte *)pBlock, pPixels, 0);
+        DecodeSingleChannelBlock((const byte *)pBlock + 8, pPixels, 1);
+        return true;
+
+    default:
+        return false;
+    }
+}
+
+// a run of block rows in one image
+struct EncodeStrip
+{
+    uint32 JobIndex;
+    uint32 FirstBlockRow;
+    uint32 BlockRowCount;
+};
+
+// shared between the encoding threads, strips are claimed in order
+struct EncodeContext
+{
+    PIXEL_FORMAT Format;
+    BLOCK_COMPRESSION_QUALITY Quality;
+    const EncodeJob *pJobs;
+    MemArray<EncodeStrip> Strips;
+    std::atomic<uint32> NextStrip;
+};
+
+static void EncodeStripBlocks(const EncodeContext *pContext, const EncodeStrip &strip)
+{
+    const PIXEL_FORMAT_INFO *pFormatInfo = PixelFormat_GetPixelFormatInfo(pContext->Format);
+    const EncodeJob &job = pContext->pJobs[strip.JobIndex];
+    uint32 blocksWide = Max((uint32)1, job.Width / 4);
+
+    for (uint32 blockY = strip.FirstBlockRow; blockY < strip.FirstBlockRow + strip.BlockRowCount; blockY++)
+    {
+        byte *pBlockOut = (byte *)job.pDestinationBlocks + blockY * job.DestinationPitch;
+        for (uint32 blockX = 0; blockX < blocksWide; blockX++)
+        {
+            byte blockPixels[64];
+            uint32 mask = 0;
+            Y_memzero(blockPixels, sizeof(blockPixels));
+            for (uint32 y = 0; y < 4; y++)
+            {
+                uint32 pixelY = blockY * 4 + y;
+                if (pixelY >= job.Height)
+                    break;
+
+                const byte *pSourceRow = (const byte *)job.pSourcePixels + pixelY * job.SourcePitch;
+                for (uint32 x = 0; x < 4; x++)
+                {
+                    uint32 pixelX = blockX * 4 + x;
+                    if (pixelX >= job.Width)
+                        break;
+
+                    Y_memcpy(&blockPixels[(y * 4 + x) * 4], pSourceRow + pixelX * 4, 4);
+                    mask |= 1 << (y * 4 + x);
+                }
+            }
+
+            EncodeBlock(pContext->Format, pContext->Quality, blockPixels, mask, pBlockOut);
+            pBlockOut += pFormatInfo->BytesPerBlock;
+        }
+    }
+}
+
+static void EncodeStrips(EncodeContext *pContext)
+{
+    for (;;)
+    {
+        uint32 stripIndex = pContext->NextStrip.fetch_add(1);
+        if (stripIndex >= pContext->Strips.GetSize())
+            break;
+
+        EncodeStripBlocks(pContext, pContext->Strips[stripIndex]);
+    }
+}
+
+class EncodeThread : public Thread
+{
+public:
+    EncodeThread(EncodeContext *pContext) : m_pContext(pContext) {}
+
+protected:
+    virtual int ThreadEntryPoint() override
+    {
+        Thread::SetDebugName("Block Compression Worker");
+        EncodeStrips(m_pContext);
+        return 0;
+    }
+
+    EncodeContext *m_pContext;
+};
+
+bool EncodeImages(PIXEL_FORMAT format, BLOCK_COMPRESSION_QUALITY quality, const EncodeJob *pJobs, uint32 jobCount, uint32 threadCount /* = 0 */)
+{
+    if (!IsSupportedFormat(format))
+    {
+        Log_ErrorPrintf("BlockCompression::EncodeImages: No encoder for %s.", PixelFormat_GetPixelFormatName(format));
+        return false;
+    }
+
+    // split every image into strips
+    EncodeContext context;
+    context.Format = format;
+    context.Quality = quality;
+    context.pJobs = pJobs;
+    context.NextStrip = 0;
+    for (uint32 jobIndex = 0; jobIndex < jobCount; jobIndex++)
+    {
+        uint32 blocksHigh = Max((uint32)1, pJobs[jobIndex].Height / 4);
+        for (uint32 blockRow = 0; blockRow < blocksHigh; blockRow += BLOCK_ROWS_PER_STRIP)
+        {
+            EncodeStrip strip;
+            strip.JobIndex = jobIndex;
+            strip.FirstBlockRow = blockRow;
+            strip.BlockRowCount = Min(blocksHigh - blockRow, (uint32)BLOCK_ROWS_PER_STRIP);
+            context.Strips.Add(strip);
+        }
+    }
+
+    if (threadCount == 0)
+    {
+        Y_CPUID_RESULT cpuidResult;
+        Y_ReadCPUID(&cpuidResult);
+        threadCount = Max((uint32)cpuidResult.ThreadCount, (uint32)1);
+    }
+
+    // HTML5 has no threads.
+#ifdef Y_PLATFORM_HTML5
+    threadCount = 1;
+#endif
+
+    // the calling thread encodes too, a thread that fails to start just leaves more strips for the others
+    threadCount = Min(threadCount, context.Strips.GetSize());
+    PODArray<EncodeThread *> threads;
+    for (uint32 i = 1; i < threadCount; i++)
+    {
+        EncodeThread *pThread = new EncodeThread(&context);
+        if (!pThread->Start())
+        {
+            Log_WarningPrintf("BlockCompression::EncodeImages: Failed to start worker thread %u", i);
+            delete pThread;
+            break;
+        }
+
+        threads.Add(pThread);
+    }
+
+    EncodeStrips(&context);
+
+    for (uint32 i = 0; i < threads.GetSize(); i++)
+    {
+        threads[i]->Join();
+        delete threads[i];
+    }
+
+    return true;
+}
+
+}
@@ -0,0 +1,45 @@
+#pragma once
+#include "Core/Common.h"
+#include "Core/PixelFormat.h"
+
+enum BLOCK_COMPRESSION_QUALITY
+{
+    BLOCK_COMPRESSION_QUALITY_FAST,
+    BLOCK_COMPRESSION_QUALITY_NORMAL,
+    BLOCK_COMPRESSION_QUALITY_SLOW,
+    BLOCK_COMPRESSION_QUALITY_COUNT,
+};
+
+namespace NameTables {
+    Y_Declare_NameTable(BlockCompressionQuality);
+}
+
+// Encoders for the block compressed formats. BC1-3 are passed to squish when it is available, BC4, BC5 and BC7 are
+// encoded here. BC7 blocks are always written in mode 6 (single subset, rgba endpoints, 4-bit indices).
+// Source pixels are always R8G8B8A8, BC4 takes the red channel, BC5 red and green.
+namespace BlockCompression
+{
+    // One image to encode. Dimensions smaller than a block are padded, the block counts match PixelFormat_CalculateRowPitch.
+    struct EncodeJob
+    {
+        const void *pSourcePixels;
+        uint32 SourcePitch;
+        uint32 Width;
+        uint32 Height;
+        void *pDestinationBlocks;
+        uint32 DestinationPitch;
+    };
+
+    // Returns true if blocks of this format can be encoded.
+    bool IsSupportedFormat(PIXEL_FORMAT format);
+
+    // Encodes a 4x4 block of R8G8B8A8 pixels. Pixels with their bit clear in mask lie outside the image, and are ignored.
+    void EncodeBlock(PIXEL_FORMAT format, BLOCK_COMPRESSION_QUALITY quality, const byte pPixels[64], uint32 mask, void *pBlock);
+
+    // Decodes a BC4 or BC5 block to R8G8B8A8 pixels, the missing channels are set to 255.
+    bool DecodeBlock(PIXEL_FORMAT format, const void *pBlock, byte pPixels[64]);
+
+    // Encodes every image in the list. The images are split into strips of block rows, which are encoded by a pool of
+    // threadCount threads, including the calling thread. A threadCount of zero uses one thread per hardware thread.
+    bool EncodeImages(PIXEL_FORMAT format, BLOCK_COMPRESSION_QUALITY quality, const EncodeJob *pJobs, uint32 jobCount, uint32 threadCount = 0);
+}
@@ -5,6 +5,10 @@
 // A ChunkSize of zero will assume that the chunk is not present.
 #define DF_CHUNKFILE_HEADER_MAGIC 0x4B484359
 
+// Chunk data is written at this alignment relative to the start of the chunk file, so that
+// readers over a mapping can hand out pointers to the chunk data directly.
+#define DF_CHUNKFILE_CHUNK_ALIGNMENT 16
+
 struct DF_CHUNKFILE_HEADER
 {
     uint32 Magic;
@@ -1,6 +1,7 @@
 #include "Core/PrecompiledHeader.h"
 #include "Core/ChunkFileReader.h"
 #include "Core/ChunkDataFormat.h"
+#include "Core/MappedFile.h"
 #include "YBaseLib/ByteStream.h"
 
 ChunkFileReader::ChunkFileReader()
@@ -15,7 +16,11 @@ ChunkFileReader::ChunkFileReader()
       m_pStringData(NULL),
       m_pStringPointers(NULL),
       m_pChunkData(NULL),
-      m_uCurrentChunkSize(0)
+      m_uCurrentChunkSize(0),
+      m_pMappedFile(nullptr),
+      m_pDirectData(nullptr),
+      m_iDirectDataSize(0),
+      m_pCurrentChunkPointer(nullptr)
 {
 
 }
@@ -62,6 +67,16 @@ void ChunkFileReader::Reset()
         m_pChunkData = NULL;
     }
     m_uCurrentChunkSize = 0;
+
+    if (m_pMappedFile != nullptr)
+    {
+        m_pMappedFile->Release();
+        m_pMappedFile = nullptr;
+    }
+
+    m_pDirectData = nullptr;
+    m_iDirectDataSize = 0;
+    m_pCurrentChunkPointer = nullptr;
 }
 
 bool ChunkFileReader::Initialize(ByteStream *pStream)
@@ -84,13 +99,36 @@ bool ChunkFileReader::InitializeFromMemory(const byte *pData, uint32 DataSize, b
     }
     else
     {
-        m_pStream = ByteStream_CreateMemoryStream((void *)pData, DataSize);
+        // the caller keeps the memory alive, so chunks can be referenced in place
+        m_pStream = ByteStream_CreateReadOnlyMemoryStream(pData, DataSize);
         m_bOwnsStream = true;
+        m_pDirectData = pData;
+        m_iDirectDataSize = DataSize;
     }
 
     return InternalInitialize();        
 }
 
+bool ChunkFileReader::InitializeFromMappedFile(MappedFile *pMappedFile, uint64 Offset /* = 0 */)
+{
+    Reset();
+
+    // the stream is only used to parse the header and strings
+    m_pStream = ByteStream_CreateReadOnlyMemoryStream(pMappedFile->GetData(), (uint32)pMappedFile->GetSize());
+    m_bOwnsStream = true;
+    if (Offset > 0 && !m_pStream->SeekAbsolute(Offset))
+    {
+        Reset();
+        return false;
+    }
+
+    m_pMappedFile = pMappedFile;
+    m_pMappedFile->AddRef();
+    m_pDirectData = pMappedFile->GetData();
+    m_iDirectDataSize = pMappedFile->GetSize();
+    return InternalInitialize();
+}
+
 void ChunkFileReader::Close()
 {
     Reset();
@@ -129,12 +167,16 @@ bool ChunkFileReader::InternalInitialize()
 
         m_pChunks[i].Offset = m_iBaseOffset + chunkHeader.ChunkOffset;
         m_pChunks[i].Size = chunkHeader.ChunkSize;
+
+        // in direct mode, chunks have to lie within the data, as they are never read through the stream
+        if (m_pDirectData != nullptr && (m_pChunks[i].Offset + m_pChunks[i].Size) > m_iDirectDataSize)
+            goto FAILURE;
     }
 
-    // alloc space
+    // alloc space, not needed when referencing the data in place
     for (i = 0; i < m_nChunks; i++)
         m_uMaximumChunkSize = Max(m_uMaximumChunkSize, m_pChunks[i].Size);
-    if (m_uMaximumChunkSize > 0)
+    if (m_uMaximumChunkSize > 0 && m_pDirectData == nullptr)
         m_pChunkData = new byte[(size_t)m_uMaximumChunkSize];
 
     // read in strings
@@ -173,16 +215,32 @@ bool ChunkFileReader::LoadChunk(uint32 ChunkIndex)
         return false;
 
     m_uCurrentChunkSize = m_pChunks[ChunkIndex].Size;
+    if (m_pDirectData != nullptr)
+    {
+        m_pCurrentChunkPointer = m_pDirectData + m_pChunks[ChunkIndex].Offset;
+        return true;
+    }
+
     if (!m_pStream->SeekAbsolute(m_pChunks[ChunkIndex].Offset) || !m_pStream->Read2(m_pChunkData, (size_t)m_uCurrentChunkSize))
         return false;
 
+    m_pCurrentChunkPointer = m_pChunkData;
     return true;
 }
 
+const byte *ChunkFileReader::GetChunkPointer(uint32 ChunkIndex) const
+{
+    DebugAssert(m_pDirectData != nullptr);
+    if (ChunkIndex >= m_nChunks || m_pChunks[ChunkIndex].Size == 0)
+        return nullptr;
+
+    return m_pDirectData + m_pChunks[ChunkIndex].Offset;
+}
+
 const byte *ChunkFileReader::GetCurrentChunkPointer() const
 {
     DebugAssert(m_uCurrentChunkSize > 0);
-    return m_pChunkData;
+    return m_pCurrentChunkPointer;
 }
 
 uint32 ChunkFileReader::GetCurrentChunkSize() const
@@ -2,11 +2,15 @@
 #include "Core/Common.h"
 
 class ByteStream;
+class MappedFile;
 
 // Uses the standard chunk header format to create a straightforward way to load chunked files.
 // Only one chunk can be loaded at a time. To avoid memory fragmentation, the size of the largest chunk
 // will be found on initialization, and a memory block of this size will be allocated. This will be
 // used for further chunk loading.
+// When initialized from a mapped file (optionally at an offset, for files with their own header), or from memory without a copy, no chunk buffer is allocated, and
+// chunk pointers reference the source data directly. Chunk data is aligned to DF_CHUNKFILE_CHUNK_ALIGNMENT
+// relative to the start of the chunk file, and the pointers remain valid until the reader is closed.
 
 class ChunkFileReader
 {
@@ -16,6 +20,7 @@ public:
 
     bool Initialize(ByteStream *pStream);
     bool InitializeFromMemory(const byte *pData, uint32 DataSize, bool RequiresOwnCopy);
+    bool InitializeFromMappedFile(MappedFile *pMappedFile, uint64 Offset = 0);
     void Close();
 
     // Gets the total size of the file, including chunk headers.
@@ -27,6 +32,12 @@ public:
     // Loads the requested chunk as the current chunk.
     bool LoadChunk(uint32 ChunkIndex);
 
+    // Returns true if chunks are referenced in place rather than copied.
+    bool IsDirect() const { return (m_pDirectData != nullptr); }
+
+    // Gets a pointer to a chunk without loading it, only available in direct mode.
+    const byte *GetChunkPointer(uint32 ChunkIndex) const;
+
     // Get the currently loaded chunk as a pointer.
     const byte *GetCurrentChunkPointer() const;
     uint32 GetCurrentChunkSize() const;
@@ -72,4 +83,10 @@ private:
 
     byte *m_pChunkData;
     uint32 m_uCurrentChunkSize;
+
+    // direct mode
+    MappedFile *m_pMappedFile;
+    const byte *m_pDirectData;
+    uint64 m_iDirectDataSize;
+    const byte *m_pCurrentChunkPointer;
 };
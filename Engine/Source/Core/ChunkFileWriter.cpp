@@ -139,8 +139,15 @@ void ChunkFileWriter::BeginChunk(uint32 ChunkIndex)
 {
     DebugAssert(m_iCurrentChunk == 0xFFFFFFFF);
 
+    // pad to the chunk alignment
+    static const byte paddingBytes[DF_CHUNKFILE_CHUNK_ALIGNMENT] = { 0 };
+    uint64 currentOffset = m_pStream->GetPosition() - m_iBaseOffset;
+    uint32 paddingSize = (uint32)(((currentOffset + DF_CHUNKFILE_CHUNK_ALIGNMENT - 1) & ~(uint64)(DF_CHUNKFILE_CHUNK_ALIGNMENT - 1)) - currentOffset);
+    if (paddingSize > 0)
+        m_pStream->Write(paddingBytes, paddingSize);
+
     m_iCurrentChunk = ChunkIndex;
-    m_iCurrentChunkOffset = m_pStream->GetPosition() - m_iBaseOffset;
+    m_iCurrentChunkOffset = currentOffset + paddingSize;
     m_iCurrentChunkSize = 0;
 }
 
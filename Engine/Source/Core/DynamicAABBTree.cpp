@@ -0,0 +1,357 @@
+#include "Core/PrecompiledHeader.h"
+#include "Core/DynamicAABBTree.h"
+
+DynamicAABBTree::DynamicAABBTree(float fatMargin /* = 0.1f */)
+    : m_rootIndex(-1),
+      m_freeListIndex(-1),
+      m_proxyCount(0),
+      m_fatMargin(fatMargin)
+{
+
+}
+
+DynamicAABBTree::~DynamicAABBTree()
+{
+
+}
+
+int32 DynamicAABBTree::CreateProxy(const AABox &bounds, void *pUserData)
+{
+    int32 proxyId = AllocateNode();
+
+    Node &node = m_nodes[proxyId];
+    node.Bounds.SetBounds(bounds.GetMinBounds() - m_fatMargin, bounds.GetMaxBounds() + m_fatMargin);
+    node.TightBounds = bounds;
+    node.pUserData = pUserData;
+    node.Height = 0;
+
+    InsertLeaf(proxyId);
+    m_proxyCount++;
+    return proxyId;
+}
+
+void DynamicAABBTree::DestroyProxy(int32 proxyId)
+{
+    DebugAssert(IsProxyValid(proxyId));
+
+    RemoveLeaf(proxyId);
+    FreeNode(proxyId);
+    m_proxyCount--;
+}
+
+bool DynamicAABBTree::MoveProxy(int32 proxyId, const AABox &bounds)
+{
+    DebugAssert(IsProxyValid(proxyId));
+
+    // still inside the fat bounds? no restructuring needed
+    Node &node = m_nodes[proxyId];
+    node.TightBounds = bounds;
+    if (node.Bounds.ContainsAABox(bounds) > 0)
+        return false;
+
+    RemoveLeaf(proxyId);
+    m_nodes[proxyId].Bounds.SetBounds(bounds.GetMinBounds() - m_fatMargin, bounds.GetMaxBounds() + m_fatMargin);
+    InsertLeaf(proxyId);
+    return true;
+}
+
+void DynamicAABBTree::RemoveAll()
+{
+    m_nodes.Clear();
+    m_rootIndex = -1;
+    m_freeListIndex = -1;
+    m_proxyCount = 0;
+}
+
+int32 DynamicAABBTree::AllocateNode()
+{
+    int32 nodeIndex;
+    if (m_freeListIndex >= 0)
+    {
+        nodeIndex = m_freeListIndex;
+        m_freeListIndex = m_nodes[nodeIndex].ParentIndex;
+    }
+    else
+    {
+        Node newNode;
+        m_nodes.Add(newNode);
+        nodeIndex = (int32)m_nodes.GetSize() - 1;
+    }
+
+    Node &node = m_nodes[nodeIndex];
+    node.pUserData = nullptr;
+    node.ParentIndex = -1;
+    node.ChildIndices[0] = -1;
+    node.ChildIndices[1] = -1;
+    node.Height = 0;
+    return nodeIndex;
+}
+
+void DynamicAABBTree::FreeNode(int32 nodeIndex)
+{
+    Node &node = m_nodes[nodeIndex];
+    node.pUserData = nullptr;
+    node.ParentIndex = m_freeListIndex;
+    node.Height = -1;
+    m_freeListIndex = nodeIndex;
+}
+
+float DynamicAABBTree::SurfaceArea(const AABox &box)
+{
+    Vector3f extents(box.GetMaxBounds() - box.GetMinBounds());
+    return 2.0f * (extents.x * extents.y + extents.y * extents.z + extents.z * extents.x);
+}
+
+void DynamicAABBTree::InsertLeaf(int32 leafIndex)
+{
+    if (m_rootIndex < 0)
+    {
+        m_rootIndex = leafIndex;
+        m_nodes[leafIndex].ParentIndex = -1;
+        return;
+    }
+
+    // find the best sibling, using the surface area heuristic
+    const AABox leafBounds(m_nodes[leafIndex].Bounds);
+    int32 index = m_rootIndex;
+    while (m_nodes[index].Height > 0)
+    {
+        const Node &node = m_nodes[index];
+        float area = SurfaceArea(node.Bounds);
+        float combinedArea = SurfaceArea(AABox::Merge(node.Bounds, leafBounds));
+
+        // cost of creating a new parent for this node and the new leaf
+        float cost = 2.0f * combinedArea;
+
+        // minimum cost of pushing the leaf further down the tree
+        float inheritanceCost = 2.0f * (combinedArea - area);
+
+        // cost of descending into each child
+        float childCosts[2];
+        for (uint32 i = 0; i < 2; i++)
+        {
+            const Node &child = m_nodes[node.ChildIndices[i]];
+            float mergedArea = SurfaceArea(AABox::Merge(child.Bounds, leafBounds));
+            if (child.Height == 0)
+                childCosts[i] = mergedArea + inheritanceCost;
+            else
+                childCosts[i] = (mergedArea - SurfaceArea(child.Bounds)) + inheritanceCost;
+        }
+
+        if (cost < childCosts[0] && cost < childCosts[1])
+            break;
+
+        index = (childCosts[0] < childCosts[1]) ? node.ChildIndices[0] : node.ChildIndices[1];
+    }
+
+    // create a new parent for the sibling and the leaf
+    int32 siblingIndex = index;
+    int32 oldParentIndex = m_nodes[siblingIndex].ParentIndex;
+    int32 newParentIndex = AllocateNode();
+    {
+        Node &newParent = m_nodes[newParentIndex];
+        newParent.ParentIndex = oldParentIndex;
+        newParent.Bounds = AABox::Merge(leafBounds, m_nodes[siblingIndex].Bounds);
+        newParent.Height = m_nodes[siblingIndex].Height + 1;
+        newParent.ChildIndices[0] = siblingIndex;
+        newParent.ChildIndices[1] = leafIndex;
+    }
+
+    if (oldParentIndex >= 0)
+    {
+        Node &oldParent = m_nodes[oldParentIndex];
+        if (oldParent.ChildIndices[0] == siblingIndex)
+            oldParent.ChildIndices[0] = newParentIndex;
+        else
+            oldParent.ChildIndices[1] = newParentIndex;
+    }
+    else
+    {
+        m_rootIndex = newParentIndex;
+    }
+
+    m_nodes[siblingIndex].ParentIndex = newParentIndex;
+    m_nodes[leafIndex].ParentIndex = newParentIndex;
+
+    // walk back up the tree fixing heights and bounds
+    index = m_nodes[leafIndex].ParentIndex;
+    while (index >= 0)
+    {
+        index = Balance(index);
+
+        Node &node = m_nodes[index];
+        const Node &child0 = m_nodes[node.ChildIndices[0]];
+        const Node &child1 = m_nodes[node.ChildIndices[1]];
+        node.Height = 1 + Max(child0.Height, child1.Height);
+        node.Bounds = AABox::Merge(child0.Bounds, child1.Bounds);
+        index = node.ParentIndex;
+    }
+}
+
+void DynamicAABBTree::RemoveLeaf(int32 leafIndex)
+{
+    if (leafIndex == m_rootIndex)
+    {
+        m_rootIndex = -1;
+        return;
+    }
+
+    int32 parentIndex = m_nodes[leafIndex].ParentIndex;
+    int32 grandParentIndex = m_nodes[parentIndex].ParentIndex;
+    int32 siblingIndex = (m_nodes[parentIndex].ChildIndices[0] == leafIndex) ? m_nodes[parentIndex].ChildIndices[1] : m_nodes[parentIndex].ChildIndices[0];
+
+    if (grandParentIndex >= 0)
+    {
+        // connect the sibling to the grandparent, and remove the parent
+        Node &grandParent = m_nodes[grandParentIndex];
+        if (grandParent.ChildIndices[0] == parentIndex)
+            grandParent.ChildIndices[0] = siblingIndex;
+        else
+            grandParent.ChildIndices[1] = siblingIndex;
+
+        m_nodes[siblingIndex].ParentIndex = grandParentIndex;
+        FreeNode(parentIndex);
+
+        // fix the bounds and heights of the ancestors
+        int32 index = grandParentIndex;
+        while (index >= 0)
+        {
+            index = Balance(index);
+
+            Node &node = m_nodes[index];
+            const Node &child0 = m_nodes[node.ChildIndices[0]];
+            const Node &child1 = m_nodes[node.ChildIndices[1]];
+            node.Bounds = AABox::Merge(child0.Bounds, child1.Bounds);
+            node.Height = 1 + Max(child0.Height, child1.Height);
+            index = node.ParentIndex;
+        }
+    }
+    else
+    {
+        m_rootIndex = siblingIndex;
+        m_nodes[siblingIndex].ParentIndex = -1;
+        FreeNode(parentIndex);
+    }
+
+    m_nodes[leafIndex].ParentIndex = -1;
+}
+
+int32 DynamicAABBTree::Balance(int32 indexA)
+{
+    // A is the node being balanced, B and C its children, D/E the children of B and F/G the children of C.
+    Node *A = &m_nodes[indexA];
+    if (A->Height < 2)
+        return indexA;
+
+    int32 indexB = A->ChildIndices[0];
+    int32 indexC = A->ChildIndices[1];
+    Node *B = &m_nodes[indexB];
+    Node *C = &m_nodes[indexC];
+    int32 balance = C->Height - B->Height;
+
+    // rotate C up
+    if (balance > 1)
+    {
+        int32 indexF = C->ChildIndices[0];
+        int32 indexG = C->ChildIndices[1];
+        Node *F = &m_nodes[indexF];
+        Node *G = &m_nodes[indexG];
+
+        // swap A and C
+        C->ChildIndices[0] = indexA;
+        C->ParentIndex = A->ParentIndex;
+        A->ParentIndex = indexC;
+
+        // A's old parent should point to C
+        if (C->ParentIndex >= 0)
+        {
+            Node &parent = m_nodes[C->ParentIndex];
+            if (parent.ChildIndices[0] == indexA)
+                parent.ChildIndices[0] = indexC;
+            else
+                parent.ChildIndices[1] = indexC;
+        }
+        else
+        {
+            m_rootIndex = indexC;
+        }
+
+        // rotate the taller grandchild up
+        if (F->Height > G->Height)
+        {
+            C->ChildIndices[1] = indexF;
+            A->ChildIndices[1] = indexG;
+            G->ParentIndex = indexA;
+            A->Bounds = AABox::Merge(B->Bounds, G->Bounds);
+            C->Bounds = AABox::Merge(A->Bounds, F->Bounds);
+            A->Height = 1 + Max(B->Height, G->Height);
+            C->Height = 1 + Max(A->Height, F->Height);
+        }
+        else
+        {
+            C->ChildIndices[1] = indexG;
+            A->ChildIndices[1] = indexF;
+            F->ParentIndex = indexA;
+            A->Bounds = AABox::Merge(B->Bounds, F->Bounds);
+            C->Bounds = AABox::Merge(A->Bounds, G->Bounds);
+            A->Height = 1 + Max(B->Height, F->Height);
+            C->Height = 1 + Max(A->Height, G->Height);
+        }
+
+        return indexC;
+    }
+
+    // rotate B up
+    if (balance < -1)
+    {
+        int32 indexD = B->ChildIndices[0];
+        int32 indexE = B->ChildIndices[1];
+        Node *D = &m_nodes[indexD];
+        Node *E = &m_nodes[indexE];
+
+        // swap A and B
+        B->ChildIndices[0] = indexA;
+        B->ParentIndex = A->ParentIndex;
+        A->ParentIndex = indexB;
+
+        // A's old parent should point to B
+        if (B->ParentIndex >= 0)
+        {
+            Node &parent = m_nodes[B->ParentIndex];
+            if (parent.ChildIndices[0] == indexA)
+                parent.ChildIndices[0] = indexB;
+            else
+                parent.ChildIndices[1] = indexB;
+        }
+        else
+        {
+            m_rootIndex = indexB;
+        }
+
+        // rotate the taller grandchild up
+        if (D->Height > E->Height)
+        {
+            B->ChildIndices[1] = indexD;
+            A->ChildIndices[0] = indexE;
+            E->ParentIndex = indexA;
+            A->Bounds = AABox::Merge(C->Bounds, E->Bounds);
+            B->Bounds = AABox::Merge(A->Bounds, D->Bounds);
+            A->Height = 1 + Max(C->Height, E->Height);
+            B->Height = 1 + Max(A->Height, D->Height);
+        }
+        else
+        {
+            B->ChildIndices[1] = indexE;
+            A->ChildIndices[0] = indexD;
+            D->ParentIndex = indexA;
+            A->Bounds = AABox::Merge(C->Bounds, D->Bounds);
+            B->Bounds = AABox::Merge(A->Bounds, E->Bounds);
+            A->Height = 1 + Max(C->Height, D->Height);
+            B->Height = 1 + Max(A->Height, E->Height);
+        }
+
+        return indexB;
+    }
+
+    return indexA;
+}
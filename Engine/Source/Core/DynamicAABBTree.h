@@ -0,0 +1,187 @@
+#pragma once
+#include "Core/Common.h"
+#include "MathLib/AABox.h"
+#include "MathLib/Frustum.h"
+#include "MathLib/Ray.h"
+#include "YBaseLib/MemArray.h"
+
+// Dynamic bounding volume hierarchy using incremental insertion and tree rotations.
+// Leaves store an enlarged ("fat") box, so small movements of an object do not require
+// the tree to be restructured. Nodes are referenced by index, as the node array can be reallocated.
+class DynamicAABBTree
+{
+public:
+    DynamicAABBTree(float fatMargin = 0.1f);
+    ~DynamicAABBTree();
+
+    // Creates a leaf for the specified bounds, returning the proxy id.
+    int32 CreateProxy(const AABox &bounds, void *pUserData);
+
+    // Removes a leaf from the tree.
+    void DestroyProxy(int32 proxyId);
+
+    // Updates the bounds of a leaf. Returns false if the fat bounds still contain the new bounds, and the tree was not modified.
+    bool MoveProxy(int32 proxyId, const AABox &bounds);
+
+    // Removes all leaves from the tree.
+    void RemoveAll();
+
+    // Accessors
+    void *GetUserData(int32 proxyId) const { DebugAssert(IsProxyValid(proxyId)); return m_nodes[proxyId].pUserData; }
+    const AABox &GetBounds(int32 proxyId) const { DebugAssert(IsProxyValid(proxyId)); return m_nodes[proxyId].TightBounds; }
+    const AABox &GetFatBounds(int32 proxyId) const { DebugAssert(IsProxyValid(proxyId)); return m_nodes[proxyId].Bounds; }
+    uint32 GetProxyCount() const { return m_proxyCount; }
+    int32 GetHeight() const { return (m_rootIndex >= 0) ? m_nodes[m_rootIndex].Height : 0; }
+    float GetFatMargin() const { return m_fatMargin; }
+
+    // Enumerates every leaf in the tree.
+    template<typename T>
+    void EnumerateAll(T Callback) const
+    {
+        for (uint32 i = 0; i < m_nodes.GetSize(); i++)
+        {
+            const Node &node = m_nodes[i];
+            if (node.Height == 0)
+                Callback(node.pUserData);
+        }
+    }
+
+    // Enumerates leaves whose bounds intersect the box.
+    template<typename T>
+    void EnumerateInAABox(const AABox &box, T Callback) const
+    {
+        if (m_rootIndex < 0)
+            return;
+
+        int32 stack[STACK_SIZE];
+        uint32 stackSize = 0;
+        stack[stackSize++] = m_rootIndex;
+        while (stackSize > 0)
+        {
+            const Node &node = m_nodes[stack[--stackSize]];
+            if (node.Height == 0)
+            {
+                if (box.AABoxIntersection(node.TightBounds))
+                    Callback(node.pUserData);
+            }
+            else if (box.AABoxIntersection(node.Bounds))
+            {
+                DebugAssert((stackSize + 2) <= STACK_SIZE);
+                stack[stackSize++] = node.ChildIndices[0];
+                stack[stackSize++] = node.ChildIndices[1];
+            }
+        }
+    }
+
+    // Enumerates leaves whose bounds intersect the frustum. Subtrees that are completely
+    // contained in the frustum are enumerated without any further plane tests.
+    template<typename T>
+    void EnumerateInFrustum(const Frustum &frustum, T Callback) const
+    {
+        if (m_rootIndex < 0)
+            return;
+
+        // the top bit of the stack entry indicates the node is already known to be inside the frustum
+        int32 stack[STACK_SIZE];
+        uint32 stackSize = 0;
+        stack[stackSize++] = m_rootIndex;
+        while (stackSize > 0)
+        {
+            int32 entry = stack[--stackSize];
+            bool inside = ((entry & INSIDE_FLAG) != 0);
+            const Node &node = m_nodes[entry & ~INSIDE_FLAG];
+            if (node.Height == 0)
+            {
+                if (inside || frustum.AABoxIntersection(node.TightBounds))
+                    Callback(node.pUserData);
+
+                continue;
+            }
+
+            if (!inside)
+            {
+                Frustum::IntersectionType intersectionType = frustum.AABoxIntersectionType(node.Bounds);
+                if (intersectionType == Frustum::INTERSECTION_TYPE_OUTSIDE)
+                    continue;
+
+                inside = (intersectionType == Frustum::INTERSECTION_TYPE_INSIDE);
+            }
+
+            DebugAssert((stackSize + 2) <= STACK_SIZE);
+            stack[stackSize++] = node.ChildIndices[0] | ((inside) ? INSIDE_FLAG : 0);
+            stack[stackSize++] = node.ChildIndices[1] | ((inside) ? INSIDE_FLAG : 0);
+        }
+    }
+
+    // Enumerates leaves whose bounds are hit by the ray.
+    template<typename T>
+    void EnumerateIntersectingRay(const Ray &ray, T Callback) const
+    {
+        if (m_rootIndex < 0)
+            return;
+
+        int32 stack[STACK_SIZE];
+        uint32 stackSize = 0;
+        stack[stackSize++] = m_rootIndex;
+        while (stackSize > 0)
+        {
+            const Node &node = m_nodes[stack[--stackSize]];
+            if (node.Height == 0)
+            {
+                if (ray.AABoxIntersection(node.TightBounds))
+                    Callback(node.pUserData);
+            }
+            else if (ray.AABoxIntersection(node.Bounds))
+            {
+                DebugAssert((stackSize + 2) <= STACK_SIZE);
+                stack[stackSize++] = node.ChildIndices[0];
+                stack[stackSize++] = node.ChildIndices[1];
+            }
+        }
+    }
+
+private:
+    // a balanced tree of 2^32 leaves won't come close to this
+    static const uint32 STACK_SIZE = 256;
+    static const int32 INSIDE_FLAG = (int32)0x40000000;
+
+    struct Node
+    {
+        // for leaves, this is the fat bounds, for internal nodes the union of the children
+        AABox Bounds;
+
+        // the actual bounds of the object, only valid for leaves
+        AABox TightBounds;
+
+        void *pUserData;
+
+        // the parent index is reused as the next pointer in the free list
+        int32 ParentIndex;
+        int32 ChildIndices[2];
+
+        // 0 for leaves, -1 for free nodes
+        int32 Height;
+    };
+
+    typedef MemArray<Node> NodeArray;
+
+    bool IsProxyValid(int32 proxyId) const { return (proxyId >= 0 && (uint32)proxyId < m_nodes.GetSize() && m_nodes[proxyId].Height == 0); }
+
+    int32 AllocateNode();
+    void FreeNode(int32 nodeIndex);
+
+    void InsertLeaf(int32 leafIndex);
+    void RemoveLeaf(int32 leafIndex);
+
+    // Performs a left or right rotation if the node is imbalanced, returns the new subtree root.
+    int32 Balance(int32 nodeIndex);
+
+    static float SurfaceArea(const AABox &box);
+
+    NodeArray m_nodes;
+    int32 m_rootIndex;
+    int32 m_freeListIndex;
+    uint32 m_proxyCount;
+    float m_fatMargin;
+};
+
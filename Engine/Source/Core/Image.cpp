@@ -1,5 +1,6 @@
 #include "Core/PrecompiledHeader.h"
 #include "Core/Image.h"
+#include "Core/ImageResampler.h"
 #include "YBaseLib/Assert.h"
 #include "YBaseLib/Memory.h"
 #include "YBaseLib/Log.h"
@@ -13,6 +14,7 @@ namespace NameTables {
         Y_NameTable_VEntry(IMAGE_RESIZE_FILTER_BSPLINE, "BSpline")
         Y_NameTable_VEntry(IMAGE_RESIZE_FILTER_CATMULLROM, "Catmullrom")
         Y_NameTable_VEntry(IMAGE_RESIZE_FILTER_LANCZOS3, "Lanczos3")
+        Y_NameTable_VEntry(IMAGE_RESIZE_FILTER_KAISER, "Kaiser")
     Y_NameTable_End()
 }
 
@@ -170,39 +172,27 @@ bool Image::CopyAndConvertPixelFormat(const Image &rCopy, PIXEL_FORMAT NewFormat
 
 bool Image::CopyAndResize(const Image &rCopy, IMAGE_RESIZE_FILTER resizeFilter, uint32 newWidth, uint32 newHeight, uint32 newDepth)
 {
-    // todo: optimize me
-    Image tempImage;
-    tempImage.Copy(rCopy);
-    if (!tempImage.Resize(resizeFilter, newWidth, newHeight, newDepth))
-        return false;
-
-    Copy(tempImage);
-    return true;
+    return ImageResampler::ResizeImage(this, &rCopy, resizeFilter, newWidth, newHeight, newDepth, false);
 }
 
-#ifdef HAVE_FREEIMAGE
-extern bool __ImageCodecFreeImage_ResizeImage(IMAGE_RESIZE_FILTER resizeFilter, PIXEL_FORMAT pixelFormat, uint32 width, uint32 height, uint32 newWidth, uint32 newHeight, const byte *pInImageData, byte *pOutImageData);
-#endif
-
 bool Image::Resize(IMAGE_RESIZE_FILTER resizeFilter, uint32 newWidth, uint32 newHeight, uint32 newDepth)
 {
-#ifdef HAVE_FREEIMAGE
-    DebugAssert(m_uDepth == 1);
     DebugAssert(IsValidImage());
 
     Image tempImage;
-    tempImage.Create(m_ePixelFormat, newWidth, newHeight, newDepth);
-
-    //if (!__ImageCodecDevIL_ResizeImage(resizeFilter, m_ePixelFormat, m_uWidth, m_uHeight, newWidth, newHeight, m_pData, tempImage.GetData()))
-    if (!__ImageCodecFreeImage_ResizeImage(resizeFilter, m_ePixelFormat, m_uWidth, m_uHeight, newWidth, newHeight, m_pData, tempImage.GetData()))
+    if (!ImageResampler::ResizeImage(&tempImage, this, resizeFilter, newWidth, newHeight, newDepth, false))
         return false;
 
-    Copy(tempImage);
+    // take the resized pixels rather than copying them, the temporary frees ours
+    Swap(m_ePixelFormat, tempImage.m_ePixelFormat);
+    Swap(m_uWidth, tempImage.m_uWidth);
+    Swap(m_uHeight, tempImage.m_uHeight);
+    Swap(m_uDepth, tempImage.m_uDepth);
+    Swap(m_pData, tempImage.m_pData);
+    Swap(m_uDataSize, tempImage.m_uDataSize);
+    Swap(m_uDataRowPitch, tempImage.m_uDataRowPitch);
+    Swap(m_uDataSlicePitch, tempImage.m_uDataSlicePitch);
     return true;
-#else
-    Log_ErrorPrintf("Image::Resize: Not compiled with FreeImage support.");
-    return false;
-#endif
 }
 
 bool Image::Blit(uint32 dx, uint32 dy, const Image &sourceImage, uint32 sx, uint32 sy, uint32 width, uint32 height)
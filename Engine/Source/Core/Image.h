@@ -10,6 +10,7 @@ enum IMAGE_RESIZE_FILTER
     IMAGE_RESIZE_FILTER_BSPLINE,
     IMAGE_RESIZE_FILTER_CATMULLROM,
     IMAGE_RESIZE_FILTER_LANCZOS3,
+    IMAGE_RESIZE_FILTER_KAISER,
     IMAGE_RESIZE_FILTER_COUNT,
 };
 
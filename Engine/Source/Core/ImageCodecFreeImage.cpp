@@ -364,62 +364,6 @@ bool __FreeImagePC_WriteBitmap(FIBITMAP **ppOutputBitmap, const Image *pInputIma
     return result;
 }
 
-///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-// Resize wrapper
-///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-
-bool __ImageCodecFreeImage_ResizeImage(IMAGE_RESIZE_FILTER resizeFilter, PIXEL_FORMAT pixelFormat, uint32 width, uint32 height, uint32 newWidth, uint32 newHeight, const byte *pInImageData, byte *pOutImageData)
-{
-    static const FREE_IMAGE_FILTER imageResizeFilterToFIFilter[IMAGE_RESIZE_FILTER_COUNT] =
-    {
-        FILTER_BOX,         // IMAGE_RESIZE_FILTER_BOX
-        FILTER_BILINEAR,    // IMAGE_RESIZE_FILTER_BILINEAR
-        FILTER_BICUBIC,     // IMAGE_RESIZE_FILTER_BICUBIC
-        FILTER_BSPLINE,     // IMAGE_RESIZE_FILTER_BSPLINE
-        FILTER_CATMULLROM,  // IMAGE_RESIZE_FILTER_CATMULLROM
-        FILTER_LANCZOS3,    // IMAGE_RESIZE_FILTER_LANCZOS3
-    };
-
-    // ugh, extra copies.. optimize me at some point?
-    Image temporaryImage;
-    temporaryImage.Create(pixelFormat, width, height, 1);
-    Y_memcpy(temporaryImage.GetData(), pInImageData, temporaryImage.GetDataSize());
-
-    // copy into a freeimage bitmap
-    FIBITMAP *pInputBitmap;
-    if (!__FreeImagePC_WriteBitmap(&pInputBitmap, &temporaryImage))
-        return false;
-
-    // invoke the resize
-    DebugAssert(resizeFilter < IMAGE_RESIZE_FILTER_COUNT);
-    FIBITMAP *pRescaledBitmap = FreeImage_Rescale(pInputBitmap, newWidth, newHeight, imageResizeFilterToFIFilter[resizeFilter]);
-
-    // success?
-    bool result = false;
-    if (pRescaledBitmap != NULL)
-    {
-        temporaryImage.Delete();
-        result = __FreeImagePC_ReadBitmap(&temporaryImage, pRescaledBitmap);
-        if (result)
-        {
-            if (temporaryImage.GetPixelFormat() == pixelFormat)
-                Y_memcpy(pOutImageData, temporaryImage.GetData(), temporaryImage.GetDataSize());
-            else
-                result = false;
-
-            temporaryImage.Delete();
-        }
-
-        FreeImage_Unload(pRescaledBitmap);
-    }
-
-    // kill original bitmap
-    FreeImage_Unload(pInputBitmap);
-
-    // done
-    return result;
-}
-
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // Codec Class
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,669 @@
+#include "Core/PrecompiledHeader.h"
+#include "Core/ImageResampler.h"
+#include "MathLib/SIMDVectorf.h"
+#include "YBaseLib/PODArray.h"
+#include "YBaseLib/Thread.h"
+#include "YBaseLib/CPUID.h"
+#include "YBaseLib/Assert.h"
+#include "YBaseLib/Log.h"
+#include <atomic>
+Log_SetChannel(ImageResampler);
+
+namespace ImageResampler {
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// filter kernels, x is the distance from the sample centre in destination-scaled source pixels
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+static float BoxFilter(float x)
+{
+    return (x >= -0.5f && x < 0.5f) ? 1.0f : 0.0f;
+}
+
+static float TriangleFilter(float x)
+{
+    x = Y_fabs(x);
+    return (x < 1.0f) ? (1.0f - x) : 0.0f;
+}
+
+// Mitchell-Netravali family
+static float CubicFilter(float x, float B, float C)
+{
+    x = Y_fabs(x);
+    float x2 = x * x;
+    float x3 = x2 * x;
+    if (x < 1.0f)
+        return ((12.0f - 9.0f * B - 6.0f * C) * x3 + (-18.0f + 12.0f * B + 6.0f * C) * x2 + (6.0f - 2.0f * B)) / 6.0f;
+    else if (x < 2.0f)
+        return ((-B - 6.0f * C) * x3 + (6.0f * B + 30.0f * C) * x2 + (-12.0f * B - 48.0f * C) * x + (8.0f * B + 24.0f * C)) / 6.0f;
+    else
+        return 0.0f;
+}
+
+static float MitchellFilter(float x)
+{
+    return CubicFilter(x, 1.0f / 3.0f, 1.0f / 3.0f);
+}
+
+static float BSplineFilter(float x)
+{
+    return CubicFilter(x, 1.0f, 0.0f);
+}
+
+static float CatmullRomFilter(float x)
+{
+    return CubicFilter(x, 0.0f, 0.5f);
+}
+
+static float Sinc(float x)
+{
+    if (Y_fabs(x) < 1e-6f)
+        return 1.0f;
+
+    x *= (float)Y_PI;
+    return Math::Sin(x) / x;
+}
+
+static float Lanczos3Filter(float x)
+{
+    return (Y_fabs(x) < 3.0f) ? (Sinc(x) * Sinc(x / 3.0f)) : 0.0f;
+}
+
+// zeroth order modified bessel function of the first kind, for the kaiser window
+static float BesselI0(float x)
+{
+    float sum = 1.0f;
+    float term = 1.0f;
+    float halfX = x * 0.5f;
+    for (uint32 k = 1; k < 32; k++)
+    {
+        term *= halfX / (float)k;
+        float squaredTerm = term * term;
+        sum += squaredTerm;
+        if (squaredTerm < sum * 1e-8f)
+            break;
+    }
+
+    return sum;
+}
+
+// sinc with a kaiser window, three lobes wide
+static const float KAISER_WIDTH = 3.0f;
+static const float KAISER_ALPHA = 4.0f;
+
+static float KaiserFilter(float x)
+{
+    float t = x / KAISER_WIDTH;
+    if (Y_fabs(t) >= 1.0f)
+        return 0.0f;
+
+    return Sinc(x) * BesselI0(KAISER_ALPHA * Math::Sqrt(1.0f - t * t)) / BesselI0(KAISER_ALPHA);
+}
+
+struct ResizeFilterInfo
+{
+    float(*Function)(float x);
+    float Support;
+};
+
+static const ResizeFilterInfo g_ResizeFilters[IMAGE_RESIZE_FILTER_COUNT] =
+{
+    { BoxFilter,            0.5f },     // IMAGE_RESIZE_FILTER_BOX
+    { TriangleFilter,       1.0f },     // IMAGE_RESIZE_FILTER_BILINEAR
+    { MitchellFilter,       2.0f },     // IMAGE_RESIZE_FILTER_BICUBIC
+    { BSplineFilter,        2.0f },     // IMAGE_RESIZE_FILTER_BSPLINE
+    { CatmullRomFilter,     2.0f },     // IMAGE_RESIZE_FILTER_CATMULLROM
+    { Lanczos3Filter,       3.0f },     // IMAGE_RESIZE_FILTER_LANCZOS3
+    { KaiserFilter,         3.0f },     // IMAGE_RESIZE_FILTER_KAISER
+};
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// separable passes
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// taps for resampling one axis. every sample reads TapsPerSample source pixels from its first tap, unused taps are zero.
+struct FilterWeights
+{
+    uint32 TapsPerSample;
+    PODArray<uint32> FirstTaps;
+    PODArray<float> Weights;
+};
+
+static void CalculateFilterWeights(FilterWeights *pWeights, const ResizeFilterInfo *pFilter, uint32 sourceSize, uint32 destinationSize)
+{
+    // unchanged axes are copied
+    if (sourceSize == destinationSize)
+    {
+        pWeights->TapsPerSample = 1;
+        pWeights->FirstTaps.Resize(destinationSize);
+        pWeights->Weights.Resize(destinationSize);
+        for (uint32 i = 0; i < destinationSize; i++)
+        {
+            pWeights->FirstTaps[i] = i;
+            pWeights->Weights[i] = 1.0f;
+        }
+
+        return;
+    }
+
+    // minifying widens the kernel to cover every source pixel under the destination pixel
+    float scale = (float)sourceSize / (float)destinationSize;
+    float filterScale = Max(scale, 1.0f);
+    float radius = pFilter->Support * filterScale;
+    uint32 tapsPerSample = Min((uint32)Y_ceilf(radius * 2.0f) + 2, sourceSize);
+
+    pWeights->TapsPerSample = tapsPerSample;
+    pWeights->FirstTaps.Resize(destinationSize);
+    pWeights->Weights.Resize(destinationSize * tapsPerSample);
+    Y_memzero(pWeights->Weights.GetBasePointer(), sizeof(float) * destinationSize * tapsPerSample);
+
+    for (uint32 i = 0; i < destinationSize; i++)
+    {
+        float center = ((float)i + 0.5f) * scale;
+        int32 left = (int32)Y_floorf(center - radius);
+        int32 right = (int32)Y_ceilf(center + radius);
+
+        // taps past the edges are clamped to the edge pixel, and the window is kept inside the image
+        int32 firstTap = Min(Max(left, (int32)0), (int32)(sourceSize - tapsPerSample));
+        float *pSampleWeights = &pWeights->Weights[i * tapsPerSample];
+        float weightSum = 0.0f;
+        for (int32 j = left; j <= right; j++)
+        {
+            float weight = pFilter->Function(((float)j + 0.5f - center) / filterScale);
+            if (weight == 0.0f)
+                continue;
+
+            int32 tap = Math::Clamp(j, (int32)0, (int32)sourceSize - 1);
+            DebugAssert(tap >= firstTap && (tap - firstTap) < (int32)tapsPerSample);
+            pSampleWeights[tap - firstTap] += weight;
+            weightSum += weight;
+        }
+
+        // a kernel that missed every pixel falls back to point sampling
+        if (weightSum != 0.0f)
+        {
+            float invWeightSum = 1.0f / weightSum;
+            for (uint32 t = 0; t < tapsPerSample; t++)
+                pSampleWeights[t] *= invWeightSum;
+        }
+        else
+        {
+            pSampleWeights[Min((uint32)center, sourceSize - 1) - (uint32)firstTap] = 1.0f;
+        }
+
+        pWeights->FirstTaps[i] = (uint32)firstTap;
+    }
+}
+
+// filters a row of R32G32B32A32 pixels along x, one pixel per vector
+static void FilterRow(float *pOutPixels, const float *pInPixels, const FilterWeights &weights, uint32 outWidth)
+{
+    const float *pSampleWeights = weights.Weights.GetBasePointer();
+    for (uint32 x = 0; x < outWidth; x++)
+    {
+        const float *pTap = pInPixels + weights.FirstTaps[x] * 4;
+        SIMDVector4f sum(SIMDVector4f::Zero);
+        for (uint32 t = 0; t < weights.TapsPerSample; t++)
+            sum += SIMDVector4f(pTap + t * 4) * pSampleWeights[t];
+
+        sum.Store(pOutPixels + x * 4);
+        pSampleWeights += weights.TapsPerSample;
+    }
+}
+
+// sums whole rows weighted by the taps of one sample, for filtering along y and z
+static void FilterLines(float *pOutLine, const float *pInLines, uint32 lineStride, const float *pTapWeights, uint32 tapCount, uint32 floatCount)
+{
+    for (uint32 i = 0; i < floatCount; i += 4)
+    {
+        const float *pTap = pInLines + i;
+        SIMDVector4f sum(SIMDVector4f::Zero);
+        for (uint32 t = 0; t < tapCount; t++)
+        {
+            sum += SIMDVector4f(pTap) * pTapWeights[t];
+            pTap += lineStride;
+        }
+
+        sum.Store(pOutLine + i);
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// conversion to and from linear floats
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+struct ResampleFormat
+{
+    PIXEL_FORMAT Format;
+    PIXEL_FORMAT StorageFormat;     // linear twin of sRGB formats, which the pixel converters understand
+    bool SRGB;
+    bool ByteChannels;
+    bool ClampOutput;
+    float SRGBToLinear[256];
+};
+
+static bool IsByteChannelFormat(PIXEL_FORMAT format)
+{
+    switch (format)
+    {
+    case PIXEL_FORMAT_R8_UNORM:
+    case PIXEL_FORMAT_R8G8_UNORM:
+    case PIXEL_FORMAT_R8G8B8_UNORM:
+    case PIXEL_FORMAT_R8G8B8A8_UNORM:
+    case PIXEL_FORMAT_B8G8R8_UNORM:
+    case PIXEL_FORMAT_B8G8R8A8_UNORM:
+    case PIXEL_FORMAT_B8G8R8X8_UNORM:
+        return true;
+
+    default:
+        return false;
+    }
+}
+
+static bool IsFloatFormat(PIXEL_FORMAT format)
+{
+    switch (format)
+    {
+    case PIXEL_FORMAT_R16_FLOAT:
+    case PIXEL_FORMAT_R16G16B16A16_FLOAT:
+    case PIXEL_FORMAT_R32_FLOAT:
+    case PIXEL_FORMAT_R32G32B32A32_FLOAT:
+        return true;
+
+    default:
+        return false;
+    }
+}
+
+bool IsSupportedFormat(PIXEL_FORMAT format)
+{
+    PIXEL_FORMAT storageFormat = PixelFormatHelpers::GetLinearFormat(format);
+    return IsByteChannelFormat(storageFormat) || IsFloatFormat(storageFormat);
+}
+
+static void InitializeResampleFormat(ResampleFormat *pFormat, PIXEL_FORMAT format, bool sourceSRGB)
+{
+    pFormat->Format = format;
+    pFormat->StorageFormat = PixelFormatHelpers::GetLinearFormat(format);
+    pFormat->SRGB = (sourceSRGB || PixelFormatHelpers::IsSRGBFormat(format));
+    pFormat->ByteChannels = IsByteChannelFormat(pFormat->StorageFormat);
+    pFormat->ClampOutput = !IsFloatFormat(pFormat->StorageFormat);
+
+    // byte channels look up their linear value
+    if (pFormat->SRGB && pFormat->ByteChannels)
+    {
+        for (uint32 i = 0; i < 256; i++)
+        {
+            float cs = (float)i / 255.0f;
+            pFormat->SRGBToLinear[i] = (cs <= 0.04045f) ? (cs / 12.92f) : Math::Pow((cs + 0.055f) / 1.055f, 2.4f);
+        }
+    }
+}
+
+// decodes one row of the image to linear R32G32B32A32
+static bool DecodeRow(const ResampleFormat &format, const byte *pRow, uint32 width, float *pOutPixels)
+{
+    uint32 outSize = sizeof(float) * 4 * width;
+    if (format.StorageFormat == PIXEL_FORMAT_R32G32B32A32_FLOAT)
+        Y_memcpy(pOutPixels, pRow, outSize);
+    else if (!PixelFormat_ConvertPixels(width, 1, pRow, PixelFormat_CalculateRowPitch(format.StorageFormat, width), format.StorageFormat, pOutPixels, outSize, PIXEL_FORMAT_R32G32B32A32_FLOAT, &outSize))
+        return false;
+
+    if (format.SRGB)
+    {
+        float *pPixel = pOutPixels;
+        for (uint32 x = 0; x < width; x++, pPixel += 4)
+        {
+            if (format.ByteChannels)
+            {
+                pPixel[0] = format.SRGBToLinear[(uint32)(pPixel[0] * 255.0f + 0.5f)];
+                pPixel[1] = format.SRGBToLinear[(uint32)(pPixel[1] * 255.0f + 0.5f)];
+                pPixel[2] = format.SRGBToLinear[(uint32)(pPixel[2] * 255.0f + 0.5f)];
+            }
+            else
+            {
+                Vector3f linearColor(PixelFormatHelpers::ConvertSRGBToLinear(Vector3f(pPixel[0], pPixel[1], pPixel[2])));
+                pPixel[0] = linearColor.x;
+                pPixel[1] = linearColor.y;
+                pPixel[2] = linearColor.z;
+            }
+        }
+    }
+
+    return true;
+}
+
+// encodes one row of linear R32G32B32A32 to the image, pScratchPixels holds a row
+static bool EncodeRow(const ResampleFormat &format, const float *pPixels, uint32 width, float *pScratchPixels, byte *pOutRow)
+{
+    const SIMDVector4f &minValue = SIMDVector4f::Zero;
+    const SIMDVector4f &maxValue = SIMDVector4f::One;
+
+    // the byte encoders truncate, so bias by half a step to round instead
+    const float roundBias = (format.ByteChannels) ? (0.5f / 255.0f) : 0.0f;
+    const SIMDVector4f bias(roundBias, roundBias, roundBias, roundBias);
+
+    for (uint32 x = 0; x < width; x++)
+    {
+        SIMDVector4f pixel(pPixels + x * 4);
+        if (format.SRGB)
+        {
+            float linearColor[4];
+            pixel.Store(linearColor);
+            Vector3f srgbColor(PixelFormatHelpers::ConvertLinearToSRGB(Vector3f(linearColor[0], linearColor[1], linearColor[2])));
+            pixel.Set(srgbColor.x, srgbColor.y, srgbColor.z, linearColor[3]);
+        }
+
+        if (format.ClampOutput)
+            pixel = pixel.Max(minValue).Min(maxValue) + bias;
+
+        pixel.Store(pScratchPixels + x * 4);
+    }
+
+    uint32 outSize = PixelFormat_CalculateRowPitch(format.StorageFormat, width);
+    if (format.StorageFormat == PIXEL_FORMAT_R32G32B32A32_FLOAT)
+    {
+        Y_memcpy(pOutRow, pScratchPixels, outSize);
+        return true;
+    }
+
+    return PixelFormat_ConvertPixels(width, 1, pScratchPixels, sizeof(float) * 4 * width, PIXEL_FORMAT_R32G32B32A32_FLOAT, pOutRow, outSize, format.StorageFormat, &outSize);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// resampling
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// pixels to resample, either an image decoded a row at a time, or the linear pixels of a previous mip level
+struct ResampleSource
+{
+    const Image *pImage;
+    const float *pPixels;
+    uint32 Width;
+    uint32 Height;
+    uint32 Depth;
+};
+
+static bool ResampleToFloat(const ResampleFormat &format, const ResampleSource &source, const ResizeFilterInfo *pFilter, uint32 newWidth, uint32 newHeight, uint32 newDepth, PODArray<float> *pOutPixels)
+{
+    FilterWeights horizontalWeights;
+    FilterWeights verticalWeights;
+    CalculateFilterWeights(&horizontalWeights, pFilter, source.Width, newWidth);
+    CalculateFilterWeights(&verticalWeights, pFilter, source.Height, newHeight);
+
+    // width and height are filtered one source slice at a time, depth afterwards across the filtered slices
+    uint32 sourceRowFloats = source.Width * 4;
+    uint32 rowFloats = newWidth * 4;
+    uint32 sliceFloats = rowFloats * newHeight;
+    bool filterDepth = (newDepth != source.Depth);
+
+    PODArray<float> filteredSlices;
+    float *pSlicePixels;
+    if (filterDepth)
+    {
+        filteredSlices.Resize(sliceFloats * source.Depth);
+        pSlicePixels = filteredSlices.GetBasePointer();
+    }
+    else
+    {
+        pOutPixels->Resize(sliceFloats * newDepth);
+        pSlicePixels = pOutPixels->GetBasePointer();
+    }
+
+    PODArray<float> decodedRow;
+    PODArray<float> horizontalRows;
+    decodedRow.Resize(sourceRowFloats);
+    horizontalRows.Resize(rowFloats * source.Height);
+
+    for (uint32 z = 0; z < source.Depth; z++)
+    {
+        for (uint32 y = 0; y < source.Height; y++)
+        {
+            const float *pSourceRow;
+            if (source.pImage != NULL)
+            {
+                const byte *pImageRow = source.pImage->GetData() + z * source.pImage->GetDataSlicePitch() + y * source.pImage->GetDataRowPitch();
+                if (!DecodeRow(format, pImageRow, source.Width, decodedRow.GetBasePointer()))
+                    return false;
+
+                pSourceRow = decodedRow.GetBasePointer();
+            }
+            else
+            {
+                pSourceRow = source.pPixels + (z * source.Height + y) * sourceRowFloats;
+            }
+
+            FilterRow(&horizontalRows[y * rowFloats], pSourceRow, horizontalWeights, newWidth);
+        }
+
+        float *pSliceOut = pSlicePixels + z * sliceFloats;
+        for (uint32 y = 0; y < newHeight; y++)
+        {
+            FilterLines(pSliceOut + y * rowFloats, &horizontalRows[verticalWeights.FirstTaps[y] * rowFloats], rowFloats,
+                        &verticalWeights.Weights[y * verticalWeights.TapsPerSample], verticalWeights.TapsPerSample, rowFloats);
+        }
+    }
+
+    if (filterDepth)
+    {
+        FilterWeights depthWeights;
+        CalculateFilterWeights(&depthWeights, pFilter, source.Depth, newDepth);
+        pOutPixels->Resize(sliceFloats * newDepth);
+        for (uint32 z = 0; z < newDepth; z++)
+        {
+            FilterLines(pOutPixels->GetBasePointer() + z * sliceFloats, &filteredSlices[depthWeights.FirstTaps[z] * sliceFloats], sliceFloats,
+                        &depthWeights.Weights[z * depthWeights.TapsPerSample], depthWeights.TapsPerSample, sliceFloats);
+        }
+    }
+
+    return true;
+}
+
+static bool EncodeImage(const ResampleFormat &format, const float *pPixels, uint32 width, uint32 height, uint32 depth, Image *pImage)
+{
+    pImage->Create(format.Format, width, height, depth);
+
+    PODArray<float> scratchRow;
+    scratchRow.Resize(width * 4);
+    for (uint32 z = 0; z < depth; z++)
+    {
+        for (uint32 y = 0; y < height; y++)
+        {
+            byte *pImageRow = pImage->GetData() + z * pImage->GetDataSlicePitch() + y * pImage->GetDataRowPitch();
+            if (!EncodeRow(format, pPixels + ((z * height + y) * width * 4), width, scratchRow.GetBasePointer(), pImageRow))
+                return false;
+        }
+    }
+
+    return true;
+}
+
+bool ResizeImage(Image *pDestinationImage, const Image *pSourceImage, IMAGE_RESIZE_FILTER filter, uint32 newWidth, uint32 newHeight, uint32 newDepth, bool sourceSRGB)
+{
+    DebugAssert(pDestinationImage != pSourceImage && pSourceImage->IsValidImage());
+    DebugAssert(filter < IMAGE_RESIZE_FILTER_COUNT && newWidth > 0 && newHeight > 0 && newDepth > 0);
+    if (!IsSupportedFormat(pSourceImage->GetPixelFormat()))
+    {
+        Log_ErrorPrintf("ImageResampler::ResizeImage: Cannot resample %s images.", PixelFormat_GetPixelFormatName(pSourceImage->GetPixelFormat()));
+        return false;
+    }
+
+    ResampleFormat format;
+    InitializeResampleFormat(&format, pSourceImage->GetPixelFormat(), sourceSRGB);
+
+    ResampleSource source;
+    source.pImage = pSourceImage;
+    source.pPixels = NULL;
+    source.Width = pSourceImage->GetWidth();
+    source.Height = pSourceImage->GetHeight();
+    source.Depth = pSourceImage->GetDepth();
+
+    PODArray<float> pixels;
+    if (!ResampleToFloat(format, source, &g_ResizeFilters[filter], newWidth, newHeight, newDepth, &pixels))
+        return false;
+
+    return EncodeImage(format, pixels.GetBasePointer(), newWidth, newHeight, newDepth, pDestinationImage);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// mip chains
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+static bool BuildMipChain(IMAGE_RESIZE_FILTER filter, bool sourceSRGB, bool cascade, const MipChainJob &job)
+{
+    const Image *pBaseImage = job.pBaseImage;
+    job.pMipImages[0].Copy(*pBaseImage);
+
+    ResampleFormat format;
+    InitializeResampleFormat(&format, pBaseImage->GetPixelFormat(), sourceSRGB);
+
+    // the first level always comes from the base image, cascaded levels then come from the previous level's floats
+    PODArray<float> previousPixels;
+    PODArray<float> currentPixels;
+    uint32 width = pBaseImage->GetWidth();
+    uint32 height = pBaseImage->GetHeight();
+    uint32 depth = pBaseImage->GetDepth();
+    for (uint32 level = 1; level < job.MipCount; level++)
+    {
+        ResampleSource source;
+        if (cascade && level > 1)
+        {
+            source.pImage = NULL;
+            source.pPixels = previousPixels.GetBasePointer();
+            source.Width = width;
+            source.Height = height;
+            source.Depth = depth;
+        }
+        else
+        {
+            source.pImage = pBaseImage;
+            source.pPixels = NULL;
+            source.Width = pBaseImage->GetWidth();
+            source.Height = pBaseImage->GetHeight();
+            source.Depth = pBaseImage->GetDepth();
+        }
+
+        width = Max(width / 2, (uint32)1);
+        height = Max(height / 2, (uint32)1);
+        depth = Max(depth / 2, (uint32)1);
+        if (!ResampleToFloat(format, source, &g_ResizeFilters[filter], width, height, depth, &currentPixels) ||
+            !EncodeImage(format, currentPixels.GetBasePointer(), width, height, depth, &job.pMipImages[level]))
+        {
+            return false;
+        }
+
+        if (cascade)
+            previousPixels.Swap(currentPixels);
+    }
+
+    return true;
+}
+
+// shared between the mip threads, chains are claimed in order
+struct MipChainContext
+{
+    IMAGE_RESIZE_FILTER Filter;
+    bool SourceSRGB;
+    bool Cascade;
+    const MipChainJob *pJobs;
+    uint32 JobCount;
+    std::atomic<uint32> NextJob;
+    std::atomic<uint32> FailedJobs;
+};
+
+static void BuildMipChains(MipChainContext *pContext)
+{
+    for (;;)
+    {
+        uint32 jobIndex = pContext->NextJob.fetch_add(1);
+        if (jobIndex >= pContext->JobCount)
+            break;
+
+        if (!BuildMipChain(pContext->Filter, pContext->SourceSRGB, pContext->Cascade, pContext->pJobs[jobIndex]))
+            pContext->FailedJobs.fetch_add(1);
+    }
+}
+
+class MipChainThread : public Thread
+{
+public:
+    MipChainThread(MipChainContext *pContext) : m_pContext(pContext) {}
+
+protected:
+    virtual int ThreadEntryPoint() override
+    {
+        Thread::SetDebugName("Mipmap Worker");
+        BuildMipChains(m_pContext);
+        return 0;
+    }
+
+    MipChainContext *m_pContext;
+};
+
+bool GenerateMipChains(IMAGE_RESIZE_FILTER filter, bool sourceSRGB, bool cascade, const MipChainJob *pJobs, uint32 jobCount, uint32 threadCount /* = 0 */)
+{
+    DebugAssert(filter < IMAGE_RESIZE_FILTER_COUNT);
+    for (uint32 jobIndex = 0; jobIndex < jobCount; jobIndex++)
+    {
+        if (!IsSupportedFormat(pJobs[jobIndex].pBaseImage->GetPixelFormat()))
+        {
+            Log_ErrorPrintf("ImageResampler::GenerateMipChains: Cannot resample %s images.", PixelFormat_GetPixelFormatName(pJobs[jobIndex].pBaseImage->GetPixelFormat()));
+            return false;
+        }
+    }
+
+    MipChainContext context;
+    context.Filter = filter;
+    context.SourceSRGB = sourceSRGB;
+    context.Cascade = cascade;
+    context.pJobs = pJobs;
+    context.JobCount = jobCount;
+    context.NextJob = 0;
+    context.FailedJobs = 0;
+
+    if (threadCount == 0)
+    {
+        Y_CPUID_RESULT cpuidResult;
+        Y_ReadCPUID(&cpuidResult);
+        threadCount = Max((uint32)cpuidResult.ThreadCount, (uint32)1);
+    }
+
+    // HTML5 has no threads.
+#ifdef Y_PLATFORM_HTML5
+    threadCount = 1;
+#endif
+
+    // the calling thread builds chains too
+    threadCount = Min(threadCount, jobCount);
+    PODArray<MipChainThread *> threads;
+    for (uint32 i = 1; i < threadCount; i++)
+    {
+        MipChainThread *pThread = new MipChainThread(&context);
+        if (!pThread->Start())
+        {
+            Log_WarningPrintf("ImageResampler::GenerateMipChains: Failed to start worker thread %u", i);
+            delete pThread;
+            break;
+        }
+
+        threads.Add(pThread);
+    }
+
+    BuildMipChains(&context);
+
+    for (uint32 i = 0; i < threads.GetSize(); i++)
+    {
+        threads[i]->Join();
+        delete threads[i];
+    }
+
+    if (context.FailedJobs != 0)
+    {
+        Log_ErrorPrintf("ImageResampler::GenerateMipChains: %u of %u chains failed.", (uint32)context.FailedJobs, jobCount);
+        return false;
+    }
+
+    return true;
+}
+
+}
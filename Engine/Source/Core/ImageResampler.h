@@ -0,0 +1,29 @@
+#pragma once
+#include "Core/Common.h"
+#include "Core/Image.h"
+
+// Separable resampling of uncompressed images, without going through an image codec. Pixels are filtered as linear
+// R32G32B32A32 values, sRGB colour is converted to linear and back around the filter, alpha is always linear.
+// Results are clamped to [0, 1] for non-float formats, as the sharper filters overshoot.
+namespace ImageResampler
+{
+    // One mip chain to build. pMipImages holds MipCount images, level 0 is a copy of the base image.
+    struct MipChainJob
+    {
+        const Image *pBaseImage;
+        Image *pMipImages;
+        uint32 MipCount;
+    };
+
+    // Returns true if images of this format can be resampled.
+    bool IsSupportedFormat(PIXEL_FORMAT format);
+
+    // Resizes pSourceImage into pDestinationImage, which is recreated. Depth is filtered as a third pass when it changes.
+    // sourceSRGB treats the colour channels of a linear format as sRGB, sRGB formats always are.
+    bool ResizeImage(Image *pDestinationImage, const Image *pSourceImage, IMAGE_RESIZE_FILTER filter, uint32 newWidth, uint32 newHeight, uint32 newDepth, bool sourceSRGB);
+
+    // Builds every chain in the list, each halving the previous level. Cascaded chains filter each level from the
+    // previous one, which is kept at float precision, otherwise every level is filtered from the base image.
+    // Chains are spread over threadCount threads including the calling thread, zero uses one per hardware thread.
+    bool GenerateMipChains(IMAGE_RESIZE_FILTER filter, bool sourceSRGB, bool cascade, const MipChainJob *pJobs, uint32 jobCount, uint32 threadCount = 0);
+}
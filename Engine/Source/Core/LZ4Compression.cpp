@@ -0,0 +1,223 @@
+#include "Core/PrecompiledHeader.h"
+#include "Core/LZ4Compression.h"
+
+// format constants, see the lz4 block format description
+static const uint32 MIN_MATCH_LENGTH = 4;
+static const uint32 LAST_LITERALS = 5;
+static const uint32 MATCH_FIND_LIMIT = 12;
+static const uint32 MAX_MATCH_OFFSET = 65535;
+static const uint32 RUN_MASK = 15;
+
+// compressor hash table size
+static const uint32 HASH_BITS = 12;
+static const uint32 HASH_TABLE_SIZE = (1 << HASH_BITS);
+static const uint32 INVALID_POSITION = 0xFFFFFFFF;
+
+static inline uint32 ReadUInt32(const byte *pData)
+{
+    uint32 value;
+    Y_memcpy(&value, pData, sizeof(value));
+    return value;
+}
+
+static inline uint32 HashSequence(uint32 sequence)
+{
+    return (sequence * 2654435761u) >> (32 - HASH_BITS);
+}
+
+static byte *WriteLengthBytes(byte *pOut, byte *pOutEnd, uint32 length)
+{
+    // length has already had RUN_MASK subtracted
+    while (length >= 255)
+    {
+        if (pOut >= pOutEnd)
+            return nullptr;
+
+        *(pOut++) = 255;
+        length -= 255;
+    }
+
+    if (pOut >= pOutEnd)
+        return nullptr;
+
+    *(pOut++) = (byte)length;
+    return pOut;
+}
+
+static byte *WriteSequence(byte *pOut, byte *pOutEnd, const byte *pLiterals, uint32 literalLength, uint32 matchOffset, uint32 matchLength)
+{
+    if (pOut >= pOutEnd)
+        return nullptr;
+
+    byte *pToken = pOut++;
+    byte token = (byte)(Min(literalLength, RUN_MASK) << 4);
+    if (literalLength >= RUN_MASK && (pOut = WriteLengthBytes(pOut, pOutEnd, literalLength - RUN_MASK)) == nullptr)
+        return nullptr;
+
+    if ((uint32)(pOutEnd - pOut) < literalLength)
+        return nullptr;
+
+    Y_memcpy(pOut, pLiterals, literalLength);
+    pOut += literalLength;
+
+    // the last sequence only contains literals
+    if (matchLength > 0)
+    {
+        if ((pOutEnd - pOut) < 2)
+            return nullptr;
+
+        *(pOut++) = (byte)(matchOffset & 0xFF);
+        *(pOut++) = (byte)(matchOffset >> 8);
+
+        uint32 matchCode = matchLength - MIN_MATCH_LENGTH;
+        token |= (byte)Min(matchCode, RUN_MASK);
+        if (matchCode >= RUN_MASK && (pOut = WriteLengthBytes(pOut, pOutEnd, matchCode - RUN_MASK)) == nullptr)
+            return nullptr;
+    }
+
+    *pToken = token;
+    return pOut;
+}
+
+uint32 LZ4Compression::GetMaxCompressedSize(uint32 inputSize)
+{
+    return inputSize + (inputSize / 255) + 16;
+}
+
+uint32 LZ4Compression::Compress(const void *pSource, uint32 sourceSize, void *pDestination, uint32 destinationSize)
+{
+    const byte *pIn = reinterpret_cast<const byte *>(pSource);
+    const byte *pInEnd = pIn + sourceSize;
+    const byte *pAnchor = pIn;
+    byte *pOut = reinterpret_cast<byte *>(pDestination);
+    byte *pOutEnd = pOut + destinationSize;
+
+    // blocks smaller than this are stored as literals
+    if (sourceSize > MATCH_FIND_LIMIT)
+    {
+        uint32 hashTable[HASH_TABLE_SIZE];
+        for (uint32 i = 0; i < HASH_TABLE_SIZE; i++)
+            hashTable[i] = INVALID_POSITION;
+
+        // matches can't start in the last 12 bytes, or extend into the last 5 bytes
+        const byte *pMatchStartLimit = pInEnd - MATCH_FIND_LIMIT;
+        const byte *pMatchEndLimit = pInEnd - LAST_LITERALS;
+        const byte *pCurrent = pIn;
+        while (pCurrent < pMatchStartLimit)
+        {
+            uint32 sequence = ReadUInt32(pCurrent);
+            uint32 hash = HashSequence(sequence);
+            uint32 position = (uint32)(pCurrent - pIn);
+            uint32 candidatePosition = hashTable[hash];
+            hashTable[hash] = position;
+
+            if (candidatePosition == INVALID_POSITION || (position - candidatePosition) > MAX_MATCH_OFFSET || ReadUInt32(pIn + candidatePosition) != sequence)
+            {
+                pCurrent++;
+                continue;
+            }
+
+            // extend the match forwards, then backwards into the pending literals
+            const byte *pMatch = pIn + candidatePosition;
+            uint32 matchLength = MIN_MATCH_LENGTH;
+            while ((pCurrent + matchLength) < pMatchEndLimit && pCurrent[matchLength] == pMatch[matchLength])
+                matchLength++;
+            while (pCurrent > pAnchor && pMatch > pIn && pCurrent[-1] == pMatch[-1])
+            {
+                pCurrent--;
+                pMatch--;
+                matchLength++;
+            }
+
+            pOut = WriteSequence(pOut, pOutEnd, pAnchor, (uint32)(pCurrent - pAnchor), (uint32)(pCurrent - pMatch), matchLength);
+            if (pOut == nullptr)
+                return 0;
+
+            pCurrent += matchLength;
+            pAnchor = pCurrent;
+        }
+    }
+
+    // remaining literals
+    pOut = WriteSequence(pOut, pOutEnd, pAnchor, (uint32)(pInEnd - pAnchor), 0, 0);
+    if (pOut == nullptr)
+        return 0;
+
+    return (uint32)(pOut - reinterpret_cast<byte *>(pDestination));
+}
+
+static bool ReadLengthBytes(const byte *&pIn, const byte *pInEnd, uint32 &length)
+{
+    byte value;
+    do
+    {
+        if (pIn >= pInEnd)
+            return false;
+
+        value = *(pIn++);
+        length += value;
+    } while (value == 255);
+
+    return true;
+}
+
+bool LZ4Compression::Decompress(const void *pSource, uint32 sourceSize, void *pDestination, uint32 destinationSize)
+{
+    const byte *pIn = reinterpret_cast<const byte *>(pSource);
+    const byte *pInEnd = pIn + sourceSize;
+    byte *pOutStart = reinterpret_cast<byte *>(pDestination);
+    byte *pOut = pOutStart;
+    byte *pOutEnd = pOutStart + destinationSize;
+
+    while (pIn < pInEnd)
+    {
+        uint32 token = *(pIn++);
+
+        // literals
+        uint32 literalLength = token >> 4;
+        if (literalLength == RUN_MASK && !ReadLengthBytes(pIn, pInEnd, literalLength))
+            return false;
+        if ((uint32)(pInEnd - pIn) < literalLength || (uint32)(pOutEnd - pOut) < literalLength)
+            return false;
+
+        Y_memcpy(pOut, pIn, literalLength);
+        pIn += literalLength;
+        pOut += literalLength;
+
+        // the last sequence has no match
+        if (pIn == pInEnd)
+            break;
+
+        // match
+        if ((pInEnd - pIn) < 2)
+            return false;
+
+        uint32 matchOffset = (uint32)pIn[0] | ((uint32)pIn[1] << 8);
+        pIn += 2;
+        if (matchOffset == 0 || matchOffset > (uint32)(pOut - pOutStart))
+            return false;
+
+        uint32 matchLength = token & RUN_MASK;
+        if (matchLength == RUN_MASK && !ReadLengthBytes(pIn, pInEnd, matchLength))
+            return false;
+
+        matchLength += MIN_MATCH_LENGTH;
+        if ((uint32)(pOutEnd - pOut) < matchLength)
+            return false;
+
+        // overlapping matches repeat the last offset bytes, so have to be copied a byte at a time
+        const byte *pMatch = pOut - matchOffset;
+        if (matchOffset >= matchLength)
+        {
+            Y_memcpy(pOut, pMatch, matchLength);
+            pOut += matchLength;
+        }
+        else
+        {
+            for (uint32 i = 0; i < matchLength; i++)
+                *(pOut++) = *(pMatch++);
+        }
+    }
+
+    return (pOut == pOutEnd);
+}
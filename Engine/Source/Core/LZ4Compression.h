@@ -0,0 +1,16 @@
+#pragma once
+#include "Core/Common.h"
+
+// Compressor/decompressor for the LZ4 block format. Favours decompression speed over ratio,
+// the compressor is a simple greedy matcher, and the output can be read by any LZ4 block decoder.
+namespace LZ4Compression
+{
+    // Worst case size of the compressed data for the specified input size.
+    uint32 GetMaxCompressedSize(uint32 inputSize);
+
+    // Compresses the source data, returning the compressed size, or zero if it does not fit in the destination buffer.
+    uint32 Compress(const void *pSource, uint32 sourceSize, void *pDestination, uint32 destinationSize);
+
+    // Decompresses the source data. Fails if the data is corrupted, or does not decompress to exactly destinationSize bytes.
+    bool Decompress(const void *pSource, uint32 sourceSize, void *pDestination, uint32 destinationSize);
+}
@@ -0,0 +1,146 @@
+#include "Core/PrecompiledHeader.h"
+#include "Core/MappedFile.h"
+#include "YBaseLib/FileSystem.h"
+#include "YBaseLib/ByteStream.h"
+
+#if Y_PLATFORM_WINDOWS
+    #include <windows.h>
+#elif !Y_PLATFORM_HTML5
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <fcntl.h>
+    #include <unistd.h>
+    #define HAVE_POSIX_MMAP 1
+#endif
+
+MappedFile::MappedFile()
+    : m_pData(nullptr),
+      m_size(0),
+      m_memoryMapped(false),
+      m_pOwner(nullptr)
+{
+#if Y_PLATFORM_WINDOWS
+    m_hFile = INVALID_HANDLE_VALUE;
+    m_hMapping = nullptr;
+#endif
+}
+
+MappedFile::~MappedFile()
+{
+    if (m_pOwner != nullptr)
+    {
+        m_pOwner->Release();
+    }
+    else if (m_memoryMapped)
+    {
+#if Y_PLATFORM_WINDOWS
+        UnmapViewOfFile(m_pData);
+        CloseHandle((HANDLE)m_hMapping);
+        CloseHandle((HANDLE)m_hFile);
+#elif HAVE_POSIX_MMAP
+        munmap(const_cast<byte *>(m_pData), (size_t)m_size);
+#endif
+    }
+    else
+    {
+        Y_free(const_cast<byte *>(m_pData));
+    }
+}
+
+static byte *ReadWholeFile(const char *osFileName, uint64 *pSize)
+{
+    ByteStream *pStream = FileSystem::OpenFile(osFileName, BYTESTREAM_OPEN_READ | BYTESTREAM_OPEN_STREAMED);
+    if (pStream == nullptr)
+        return nullptr;
+
+    uint64 size = pStream->GetSize();
+    byte *pData = (byte *)Y_malloc(Max(size, (uint64)1));
+    if (size > 0 && !pStream->Read2(pData, (uint32)size))
+    {
+        Y_free(pData);
+        pStream->Release();
+        return nullptr;
+    }
+
+    pStream->Release();
+    *pSize = size;
+    return pData;
+}
+
+MappedFile *MappedFile::Open(const char *osFileName)
+{
+    MappedFile *pMappedFile = new MappedFile();
+
+#if Y_PLATFORM_WINDOWS
+    HANDLE hFile = CreateFileA(osFileName, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (hFile == INVALID_HANDLE_VALUE)
+    {
+        pMappedFile->Release();
+        return nullptr;
+    }
+
+    LARGE_INTEGER fileSize;
+    HANDLE hMapping = nullptr;
+    const void *pView = nullptr;
+    if (GetFileSizeEx(hFile, &fileSize) && fileSize.QuadPart > 0 &&
+        (hMapping = CreateFileMappingA(hFile, nullptr, PAGE_READONLY, 0, 0, nullptr)) != nullptr &&
+        (pView = MapViewOfFile(hMapping, FILE_MAP_READ, 0, 0, 0)) != nullptr)
+    {
+        pMappedFile->m_hFile = hFile;
+        pMappedFile->m_hMapping = hMapping;
+        pMappedFile->m_pData = reinterpret_cast<const byte *>(pView);
+        pMappedFile->m_size = (uint64)fileSize.QuadPart;
+        pMappedFile->m_memoryMapped = true;
+        return pMappedFile;
+    }
+
+    if (hMapping != nullptr)
+        CloseHandle(hMapping);
+    CloseHandle(hFile);
+
+#elif HAVE_POSIX_MMAP
+    int fd = open(osFileName, O_RDONLY);
+    if (fd < 0)
+    {
+        pMappedFile->Release();
+        return nullptr;
+    }
+
+    struct stat statBuf;
+    if (fstat(fd, &statBuf) == 0 && statBuf.st_size > 0)
+    {
+        void *pView = mmap(nullptr, (size_t)statBuf.st_size, PROT_READ, MAP_SHARED, fd, 0);
+        if (pView != MAP_FAILED)
+        {
+            // the mapping holds its own reference to the file
+            close(fd);
+            pMappedFile->m_pData = reinterpret_cast<const byte *>(pView);
+            pMappedFile->m_size = (uint64)statBuf.st_size;
+            pMappedFile->m_memoryMapped = true;
+            return pMappedFile;
+        }
+    }
+
+    close(fd);
+
+#endif
+
+    // no mapping support, or mapping failed (eg empty file), so read it into memory instead
+    if ((pMappedFile->m_pData = ReadWholeFile(osFileName, &pMappedFile->m_size)) == nullptr)
+    {
+        pMappedFile->Release();
+        return nullptr;
+    }
+
+    return pMappedFile;
+}
+
+MappedFile *MappedFile::CreateView(ReferenceCounted *pOwner, const byte *pData, uint64 size)
+{
+    MappedFile *pMappedFile = new MappedFile();
+    pMappedFile->m_pData = pData;
+    pMappedFile->m_size = size;
+    pMappedFile->m_pOwner = pOwner;
+    pOwner->AddRef();
+    return pMappedFile;
+}
@@ -0,0 +1,35 @@
+#pragma once
+#include "Core/Common.h"
+#include "YBaseLib/ReferenceCounted.h"
+
+// Read-only view of an entire file. Platforms without file mapping fall back to reading the file into memory.
+// Views can also reference a range of memory owned by another object, eg a file within a mapped pack file.
+class MappedFile : public ReferenceCounted
+{
+public:
+    ~MappedFile();
+
+    const byte *GetData() const { return m_pData; }
+    uint64 GetSize() const { return m_size; }
+    bool IsMemoryMapped() const { return m_memoryMapped; }
+
+    // opens a file by OS path, returns nullptr on failure
+    static MappedFile *Open(const char *osFileName);
+
+    // creates a view of memory owned by pOwner, which is kept alive by the view
+    static MappedFile *CreateView(ReferenceCounted *pOwner, const byte *pData, uint64 size);
+
+private:
+    MappedFile();
+
+    const byte *m_pData;
+    uint64 m_size;
+    bool m_memoryMapped;
+    ReferenceCounted *m_pOwner;
+
+#if Y_PLATFORM_WINDOWS
+    void *m_hFile;
+    void *m_hMapping;
+#endif
+};
+
@@ -2,6 +2,8 @@
 #include "Core/MeshUtilties.h"
 #include "YBaseLib/Memory.h"
 #include "YBaseLib/Assert.h"
+#include "YBaseLib/MemArray.h"
+#include "YBaseLib/PODArray.h"
 #include "MathLib/SIMDVectorf.h"
 
 namespace MeshUtilites
@@ -403,4 +405,598 @@ namespace MeshUtilites
         outTangent = newTangent;
         outBinormalSign = (dp < 0.0f) ? -1.0f : 1.0f;
     }
+
+    // quadric of the squared distance to a set of planes, the upper triangle of a symmetric 4x4 matrix, and the total
+    // weight of the planes so the error can be turned back into a distance
+    struct SimplifyQuadric
+    {
+        double a00, a01, a02, a03, a11, a12, a13, a22, a23, a33;
+        double weight;
+
+        void SetZero()
+        {
+            a00 = a01 = a02 = a03 = a11 = a12 = a13 = a22 = a23 = a33 = 0.0;
+            weight = 0.0;
+        }
+
+        void AddPlane(double a, double b, double c, double d, double weight)
+        {
+            a00 += weight * a * a; a01 += weight * a * b; a02 += weight * a * c; a03 += weight * a * d;
+            a11 += weight * b * b; a12 += weight * b * c; a13 += weight * b * d;
+            a22 += weight * c * c; a23 += weight * c * d;
+            a33 += weight * d * d;
+            this->weight += weight;
+        }
+
+        void Add(const SimplifyQuadric &quadric)
+        {
+            a00 += quadric.a00; a01 += quadric.a01; a02 += quadric.a02; a03 += quadric.a03;
+            a11 += quadric.a11; a12 += quadric.a12; a13 += quadric.a13;
+            a22 += quadric.a22; a23 += quadric.a23;
+            a33 += quadric.a33;
+            weight += quadric.weight;
+        }
+
+        double Evaluate(const Vector3f &p) const
+        {
+            double x = p.x, y = p.y, z = p.z;
+            return a00 * x * x + 2.0 * a01 * x * y + 2.0 * a02 * x * z + 2.0 * a03 * x +
+                   a11 * y * y + 2.0 * a12 * y * z + 2.0 * a13 * y +
+                   a22 * z * z + 2.0 * a23 * z +
+                   a33;
+        }
+
+        // root mean square distance of a point to the planes
+        float EvaluateDistance(const Vector3f &p) const
+        {
+            if (weight <= 0.0)
+                return 0.0f;
+
+            return Math::Sqrt((float)(Max(Evaluate(p), 0.0) / weight));
+        }
+    };
+
+    // a candidate collapse of one vertex into another. the versions are the vertices' versions when the cost was
+    // worked out, if either has changed since then the entry is stale and skipped.
+    struct SimplifyCollapse
+    {
+        float Cost;
+        uint32 FromVertex;
+        uint32 ToVertex;
+        uint32 FromVersion;
+        uint32 ToVersion;
+    };
+
+    static void SimplifyHeapPush(MemArray<SimplifyCollapse> &heap, const SimplifyCollapse &collapse)
+    {
+        uint32 index = heap.GetSize();
+        heap.Add(collapse);
+        while (index > 0)
+        {
+            uint32 parentIndex = (index - 1) / 2;
+            if (heap[parentIndex].Cost <= heap[index].Cost)
+                break;
+
+            Swap(heap[parentIndex], heap[index]);
+            index = parentIndex;
+        }
+    }
+
+    static SimplifyCollapse SimplifyHeapPop(MemArray<SimplifyCollapse> &heap)
+    {
+        SimplifyCollapse top = heap[0];
+        SimplifyCollapse last = heap.PopBack();
+        uint32 size = heap.GetSize();
+        if (size > 0)
+        {
+            heap[0] = last;
+
+            uint32 index = 0;
+            for (;;)
+            {
+                uint32 smallestIndex = index;
+                uint32 leftIndex = index * 2 + 1;
+                uint32 rightIndex = leftIndex + 1;
+                if (leftIndex < size && heap[leftIndex].Cost < heap[smallestIndex].Cost)
+                    smallestIndex = leftIndex;
+                if (rightIndex < size && heap[rightIndex].Cost < heap[smallestIndex].Cost)
+                    smallestIndex = rightIndex;
+                if (smallestIndex == index)
+                    break;
+
+                Swap(heap[index], heap[smallestIndex]);
+                index = smallestIndex;
+            }
+        }
+
+        return top;
+    }
+
+    static inline uint32 SimplifyHashPosition(const Vector3f &position)
+    {
+        uint32 bits[3];
+        Y_memcpy(bits, &position, sizeof(bits));
+        return (bits[0] * 73856093u) ^ (bits[1] * 19349663u) ^ (bits[2] * 83492791u);
+    }
+
+    uint32 SimplifyMesh(const void *pInVertices, uint32 uVertexStride, uint32 nVertices, const void *pInTriangles, uint32 uTriangleStride, uint32 nTriangles, const bool *pLockedVertices, uint32 nTargetTriangles, float fMaxError, void *pOutTriangles, uint32 uOutTriangleStride, uint32 *pOutSourceTriangles)
+    {
+        const byte *pInVerticesBytePtr = (const byte *)pInVertices;
+        const byte *pInTrianglesBytePtr = (const byte *)pInTriangles;
+        byte *pOutTrianglesBytePtr = (byte *)pOutTriangles;
+        uint32 i, j, k;
+
+        // gather the positions and triangles
+        MemArray<Vector3f> positions;
+        positions.Resize(nVertices);
+        for (i = 0; i < nVertices; i++)
+            positions[i] = *reinterpret_cast<const Vector3f *>(pInVerticesBytePtr + i * uVertexStride);
+
+        MemArray<uint32> indices;
+        indices.Resize(nTriangles * 3);
+        for (i = 0; i < nTriangles; i++)
+        {
+            const uint32 *pTriangle = reinterpret_cast<const uint32 *>(pInTrianglesBytePtr + i * uTriangleStride);
+            DebugAssert(pTriangle[0] < nVertices && pTriangle[1] < nVertices && pTriangle[2] < nVertices);
+            indices[i * 3 + 0] = pTriangle[0];
+            indices[i * 3 + 1] = pTriangle[1];
+            indices[i * 3 + 2] = pTriangle[2];
+        }
+
+        // weld vertices with the same position, so that seams in the other attributes don't look like holes. the
+        // vertices sharing a position are also linked in a ring.
+        MemArray<uint32> weldedVertex, nextWedge;
+        weldedVertex.Resize(nVertices);
+        nextWedge.Resize(nVertices);
+        {
+            uint32 hashTableSize = 1;
+            while (hashTableSize < nVertices * 2)
+                hashTableSize <<= 1;
+
+            MemArray<uint32> hashTable;
+            hashTable.Resize(hashTableSize);
+            for (i = 0; i < hashTableSize; i++)
+                hashTable[i] = 0xFFFFFFFF;
+
+            for (i = 0; i < nVertices; i++)
+            {
+                uint32 slot = SimplifyHashPosition(positions[i]) & (hashTableSize - 1);
+                for (;;)
+                {
+                    if (hashTable[slot] == 0xFFFFFFFF)
+                    {
+                        hashTable[slot] = i;
+                        weldedVertex[i] = i;
+                        nextWedge[i] = i;
+                        break;
+                    }
+                    else if (Y_memcmp(&positions[hashTable[slot]], &positions[i], sizeof(Vector3f)) == 0)
+                    {
+                        weldedVertex[i] = hashTable[slot];
+                        nextWedge[i] = nextWedge[hashTable[slot]];
+                        nextWedge[hashTable[slot]] = i;
+                        break;
+                    }
+
+                    slot = (slot + 1) & (hashTableSize - 1);
+                }
+            }
+        }
+
+        // positions that can't be moved, a locked vertex locks every vertex sharing its position. everything from
+        // here on works on positions, identified by the first vertex at the position, with the vertices at a position
+        // (wedges) moving together.
+        MemArray<bool> locked;
+        locked.Resize(nVertices);
+        for (i = 0; i < nVertices; i++)
+            locked[i] = false;
+        for (i = 0; i < nVertices; i++)
+        {
+            if (pLockedVertices != nullptr && pLockedVertices[i])
+                locked[weldedVertex[i]] = true;
+        }
+
+        // triangles around each vertex, and around each welded vertex
+        MemArray<uint32> vertexTriangleStart, vertexTriangles;
+        MemArray<uint32> weldedTriangleStart, weldedTriangles;
+        vertexTriangleStart.Resize(nVertices + 1);
+        weldedTriangleStart.Resize(nVertices + 1);
+        for (i = 0; i <= nVertices; i++)
+            vertexTriangleStart[i] = weldedTriangleStart[i] = 0;
+        for (i = 0; i < nTriangles * 3; i++)
+        {
+            vertexTriangleStart[indices[i] + 1]++;
+            weldedTriangleStart[weldedVertex[indices[i]] + 1]++;
+        }
+        for (i = 0; i < nVertices; i++)
+        {
+            vertexTriangleStart[i + 1] += vertexTriangleStart[i];
+            weldedTriangleStart[i + 1] += weldedTriangleStart[i];
+        }
+
+        vertexTriangles.Resize(nTriangles * 3);
+        weldedTriangles.Resize(nTriangles * 3);
+        {
+            MemArray<uint32> vertexFill, weldedFill;
+            vertexFill.Resize(nVertices);
+            weldedFill.Resize(nVertices);
+            for (i = 0; i < nVertices; i++)
+            {
+                vertexFill[i] = vertexTriangleStart[i];
+                weldedFill[i] = weldedTriangleStart[i];
+            }
+
+            for (i = 0; i < nTriangles * 3; i++)
+            {
+                vertexTriangles[vertexFill[indices[i]]++] = i / 3;
+                weldedTriangles[weldedFill[weldedVertex[indices[i]]]++] = i / 3;
+            }
+        }
+
+        // edges used by only one triangle are on the open boundary of the mesh, lock both ends so it keeps its outline
+        for (i = 0; i < nTriangles; i++)
+        {
+            for (j = 0; j < 3; j++)
+            {
+                uint32 edgeStart = weldedVertex[indices[i * 3 + j]];
+                uint32 edgeEnd = weldedVertex[indices[i * 3 + (j + 1) % 3]];
+                uint32 edgeTriangleCount = 0;
+                for (k = weldedTriangleStart[edgeStart]; k < weldedTriangleStart[edgeStart + 1]; k++)
+                {
+                    uint32 otherTriangle = weldedTriangles[k];
+                    if (weldedVertex[indices[otherTriangle * 3 + 0]] == edgeEnd ||
+                        weldedVertex[indices[otherTriangle * 3 + 1]] == edgeEnd ||
+                        weldedVertex[indices[otherTriangle * 3 + 2]] == edgeEnd)
+                    {
+                        edgeTriangleCount++;
+                    }
+                }
+
+                if (edgeTriangleCount == 1)
+                {
+                    locked[edgeStart] = true;
+                    locked[edgeEnd] = true;
+                }
+            }
+        }
+
+        // sum the planes of the triangles around each position, weighted by area so small slivers don't dominate
+        MemArray<SimplifyQuadric> quadrics;
+        quadrics.Resize(nVertices);
+        for (i = 0; i < nVertices; i++)
+            quadrics[i].SetZero();
+        for (i = 0; i < nTriangles; i++)
+        {
+            const Vector3f &p0 = positions[indices[i * 3 + 0]];
+            Vector3f normal((positions[indices[i * 3 + 1]] - p0).Cross(positions[indices[i * 3 + 2]] - p0));
+            float doubleArea = normal.Length();
+            if (doubleArea <= 0.0f)
+                continue;
+
+            normal /= doubleArea;
+            double distance = -(double)normal.Dot(p0);
+            for (j = 0; j < 3; j++)
+                quadrics[weldedVertex[indices[i * 3 + j]]].AddPlane(normal.x, normal.y, normal.z, distance, (double)doubleArea * 0.5);
+        }
+
+        // vertices collapsed into each other form a ring, so the triangles around a vertex are the triangles of all
+        // the vertices in its ring. removed vertices point at the vertex they were collapsed into. versions are kept
+        // per position.
+        MemArray<uint32> nextInRing, collapsedInto, versions;
+        MemArray<bool> removedTriangles;
+        nextInRing.Resize(nVertices);
+        collapsedInto.Resize(nVertices);
+        versions.Resize(nVertices);
+        removedTriangles.Resize(nTriangles);
+        for (i = 0; i < nVertices; i++)
+        {
+            nextInRing[i] = i;
+            collapsedInto[i] = i;
+            versions[i] = 0;
+        }
+
+        // drop degenerate triangles up front
+        uint32 liveTriangleCount = 0;
+        for (i = 0; i < nTriangles; i++)
+        {
+            removedTriangles[i] = (indices[i * 3 + 0] == indices[i * 3 + 1] || indices[i * 3 + 1] == indices[i * 3 + 2] || indices[i * 3 + 2] == indices[i * 3 + 0]);
+            liveTriangleCount += (removedTriangles[i]) ? 0 : 1;
+        }
+
+        // gathers the positions sharing a triangle with a position, over every vertex at the position
+        auto gatherWeldedNeighbours = [&](uint32 weldedIndex, PODArray<uint32> &neighbours)
+        {
+            neighbours.Clear();
+            uint32 wedgeVertex = weldedIndex;
+            do
+            {
+                uint32 ringVertex = wedgeVertex;
+                do
+                {
+                    for (uint32 ti = vertexTriangleStart[ringVertex]; ti < vertexTriangleStart[ringVertex + 1]; ti++)
+                    {
+                        uint32 triangle = vertexTriangles[ti];
+                        if (removedTriangles[triangle])
+                            continue;
+
+                        for (uint32 corner = 0; corner < 3; corner++)
+                        {
+                            uint32 neighbour = weldedVertex[indices[triangle * 3 + corner]];
+                            if (neighbour != weldedIndex && neighbours.IndexOf(neighbour) < 0)
+                                neighbours.Add(neighbour);
+                        }
+                    }
+
+                    ringVertex = nextInRing[ringVertex];
+                }
+                while (ringVertex != wedgeVertex);
+
+                wedgeVertex = nextWedge[wedgeVertex];
+            }
+            while (wedgeVertex != weldedIndex);
+        };
+
+        // works out which vertex at the other end each vertex at fromWelded moves into, the one it shares the edge's
+        // triangles with. a vertex that shares no triangle with the other end, or shares them with more than one vertex
+        // there, would pull its attributes across a seam, so the collapse isn't allowed. vertices without any triangles
+        // left are given no target.
+        PODArray<uint32> wedgeTargets;
+        auto findWedgeTargets = [&](uint32 fromWelded, uint32 toWelded) -> bool
+        {
+            wedgeTargets.Clear();
+            uint32 wedgeVertex = fromWelded;
+            do
+            {
+                uint32 target = 0xFFFFFFFF;
+                bool hasTriangles = false;
+                uint32 ringVertex = wedgeVertex;
+                do
+                {
+                    for (uint32 ti = vertexTriangleStart[ringVertex]; ti < vertexTriangleStart[ringVertex + 1]; ti++)
+                    {
+                        uint32 triangle = vertexTriangles[ti];
+                        if (removedTriangles[triangle])
+                            continue;
+
+                        hasTriangles = true;
+                        for (uint32 corner = 0; corner < 3; corner++)
+                        {
+                            uint32 cornerVertex = indices[triangle * 3 + corner];
+                            if (weldedVertex[cornerVertex] != toWelded)
+                                continue;
+
+                            if (target != 0xFFFFFFFF && target != cornerVertex)
+                                return false;
+
+                            target = cornerVertex;
+                        }
+                    }
+
+                    ringVertex = nextInRing[ringVertex];
+                }
+                while (ringVertex != wedgeVertex);
+
+                if (hasTriangles && target == 0xFFFFFFFF)
+                    return false;
+
+                wedgeTargets.Add(target);
+                wedgeVertex = nextWedge[wedgeVertex];
+            }
+            while (wedgeVertex != fromWelded);
+
+            return true;
+        };
+
+        // checks that collapsing the position fromWelded into toWelded keeps the surface a manifold, and doesn't flip or
+        // squash any of the triangles that would remain
+        PODArray<uint32> fromNeighbours, toNeighbours;
+        auto isCollapseValid = [&](uint32 fromWelded, uint32 toWelded) -> bool
+        {
+            const Vector3f &toPosition = positions[toWelded];
+            uint32 edgeTriangleCount = 0;
+            uint32 wedgeVertex = fromWelded;
+            do
+            {
+                uint32 ringVertex = wedgeVertex;
+                do
+                {
+                    for (uint32 ti = vertexTriangleStart[ringVertex]; ti < vertexTriangleStart[ringVertex + 1]; ti++)
+                    {
+                        uint32 triangle = vertexTriangles[ti];
+                        if (removedTriangles[triangle])
+                            continue;
+
+                        const uint32 *pTriangle = &indices[triangle * 3];
+                        bool corner0Moves = (weldedVertex[pTriangle[0]] == fromWelded);
+                        bool corner1Moves = (weldedVertex[pTriangle[1]] == fromWelded);
+                        bool corner2Moves = (weldedVertex[pTriangle[2]] == fromWelded);
+                        if (weldedVertex[pTriangle[0]] == toWelded || weldedVertex[pTriangle[1]] == toWelded || weldedVertex[pTriangle[2]] == toWelded)
+                        {
+                            edgeTriangleCount++;
+                            continue;
+                        }
+
+                        const Vector3f &p0 = positions[pTriangle[0]];
+                        const Vector3f &p1 = positions[pTriangle[1]];
+                        const Vector3f &p2 = positions[pTriangle[2]];
+                        Vector3f oldNormal((p1 - p0).Cross(p2 - p0));
+                        Vector3f newNormal(((corner1Moves) ? toPosition : p1) - ((corner0Moves) ? toPosition : p0));
+                        newNormal = newNormal.Cross(((corner2Moves) ? toPosition : p2) - ((corner0Moves) ? toPosition : p0));
+
+                        // the new triangle must face the same way, and not collapse to a sliver
+                        float oldLength = oldNormal.Length();
+                        float newLength = newNormal.Length();
+                        if (newLength <= oldLength * 1e-3f || oldNormal.Dot(newNormal) <= oldLength * newLength * 0.2f)
+                            return false;
+                    }
+
+                    ringVertex = nextInRing[ringVertex];
+                }
+                while (ringVertex != wedgeVertex);
+
+                wedgeVertex = nextWedge[wedgeVertex];
+            }
+            while (wedgeVertex != fromWelded);
+
+            // the only positions both ends can share are the opposite corners of the triangles on the edge, any other
+            // would end up with two triangles folded onto each other. triangles on a seam are counted once per side,
+            // as are their opposite corners.
+            gatherWeldedNeighbours(fromWelded, fromNeighbours);
+            gatherWeldedNeighbours(toWelded, toNeighbours);
+            uint32 sharedNeighbourCount = 0;
+            for (uint32 ni = 0; ni < fromNeighbours.GetSize(); ni++)
+            {
+                if (toNeighbours.IndexOf(fromNeighbours[ni]) >= 0)
+                    sharedNeighbourCount++;
+            }
+
+            return (sharedNeighbourCount == edgeTriangleCount);
+        };
+
+        // queues the cheaper direction of collapsing an edge, if either end can move
+        MemArray<SimplifyCollapse> heap;
+        auto queueEdge = [&](uint32 weldedA, uint32 weldedB)
+        {
+            if (locked[weldedA] && locked[weldedB])
+                return;
+
+            SimplifyQuadric edgeQuadric(quadrics[weldedA]);
+            edgeQuadric.Add(quadrics[weldedB]);
+
+            // at least one direction is allowed, so the collapse is always filled in
+            SimplifyCollapse collapse;
+            if (!locked[weldedA])
+            {
+                collapse.Cost = edgeQuadric.EvaluateDistance(positions[weldedB]);
+                collapse.FromVertex = weldedA;
+                collapse.ToVertex = weldedB;
+            }
+            if (!locked[weldedB])
+            {
+                float cost = edgeQuadric.EvaluateDistance(positions[weldedA]);
+                if (locked[weldedA] || cost < collapse.Cost)
+                {
+                    collapse.Cost = cost;
+                    collapse.FromVertex = weldedB;
+                    collapse.ToVertex = weldedA;
+                }
+            }
+            if (collapse.Cost > fMaxError)
+                return;
+
+            collapse.FromVersion = versions[collapse.FromVertex];
+            collapse.ToVersion = versions[collapse.ToVertex];
+            SimplifyHeapPush(heap, collapse);
+        };
+
+        // each edge is queued from the triangle that has it in ascending order, or both if it's used both ways
+        for (i = 0; i < nTriangles; i++)
+        {
+            if (removedTriangles[i])
+                continue;
+
+            for (j = 0; j < 3; j++)
+            {
+                uint32 weldedA = weldedVertex[indices[i * 3 + j]];
+                uint32 weldedB = weldedVertex[indices[i * 3 + (j + 1) % 3]];
+                if (weldedA < weldedB)
+                    queueEdge(weldedA, weldedB);
+            }
+        }
+
+        // collapse the cheapest edges until the target is reached, edges costing more than the error limit were never queued
+        PODArray<uint32> neighbours;
+        while (liveTriangleCount > nTargetTriangles && heap.GetSize() > 0)
+        {
+            SimplifyCollapse collapse = SimplifyHeapPop(heap);
+            uint32 fromWelded = collapse.FromVertex;
+            uint32 toWelded = collapse.ToVertex;
+            if (collapsedInto[fromWelded] != fromWelded || collapsedInto[toWelded] != toWelded ||
+                versions[fromWelded] != collapse.FromVersion || versions[toWelded] != collapse.ToVersion)
+            {
+                continue;
+            }
+
+            if (!findWedgeTargets(fromWelded, toWelded) || !isCollapseValid(fromWelded, toWelded))
+                continue;
+
+            // move each vertex's triangles over to its target, the ones along the edge disappear
+            uint32 wedgeVertex = fromWelded;
+            uint32 wedgeIndex = 0;
+            do
+            {
+                uint32 nextWedgeVertex = nextWedge[wedgeVertex];
+                uint32 targetVertex = wedgeTargets[wedgeIndex++];
+                if (targetVertex == 0xFFFFFFFF)
+                {
+                    // nothing references it any more
+                    collapsedInto[wedgeVertex] = toWelded;
+                    wedgeVertex = nextWedgeVertex;
+                    continue;
+                }
+
+                uint32 ringVertex = wedgeVertex;
+                do
+                {
+                    for (uint32 ti = vertexTriangleStart[ringVertex]; ti < vertexTriangleStart[ringVertex + 1]; ti++)
+                    {
+                        uint32 triangle = vertexTriangles[ti];
+                        if (removedTriangles[triangle])
+                            continue;
+
+                        uint32 *pTriangle = &indices[triangle * 3];
+                        if (weldedVertex[pTriangle[0]] == toWelded || weldedVertex[pTriangle[1]] == toWelded || weldedVertex[pTriangle[2]] == toWelded)
+                        {
+                            removedTriangles[triangle] = true;
+                            liveTriangleCount--;
+                            continue;
+                        }
+
+                        for (k = 0; k < 3; k++)
+                        {
+                            if (pTriangle[k] == wedgeVertex)
+                                pTriangle[k] = targetVertex;
+                        }
+                    }
+
+                    ringVertex = nextInRing[ringVertex];
+                }
+                while (ringVertex != wedgeVertex);
+
+                // merge the rings
+                Swap(nextInRing[wedgeVertex], nextInRing[targetVertex]);
+                collapsedInto[wedgeVertex] = targetVertex;
+                wedgeVertex = nextWedgeVertex;
+            }
+            while (wedgeVertex != fromWelded);
+
+            // merge the quadrics, the version bump drops the queued edges of both ends
+            quadrics[toWelded].Add(quadrics[fromWelded]);
+            versions[toWelded]++;
+
+            // requeue the edges around the merged position, their costs have changed
+            gatherWeldedNeighbours(toWelded, neighbours);
+            for (k = 0; k < neighbours.GetSize(); k++)
+                queueEdge(toWelded, neighbours[k]);
+        }
+
+        // write out what is left
+        uint32 nOutTriangles = 0;
+        for (i = 0; i < nTriangles; i++)
+        {
+            if (removedTriangles[i])
+                continue;
+
+            uint32 *pOutTriangle = reinterpret_cast<uint32 *>(pOutTrianglesBytePtr + nOutTriangles * uOutTriangleStride);
+            pOutTriangle[0] = indices[i * 3 + 0];
+            pOutTriangle[1] = indices[i * 3 + 1];
+            pOutTriangle[2] = indices[i * 3 + 2];
+            if (pOutSourceTriangles != nullptr)
+                pOutSourceTriangles[nOutTriangles] = i;
+
+            nOutTriangles++;
+        }
+
+        return nOutTriangles;
+    }
 }
@@ -43,5 +43,18 @@ namespace MeshUtilites
     bool PointInTriangle(const Vector3f &p, const Vector3f &v0, const Vector3f &v1, const Vector3f &v2, const Vector3f &normal);
 
     void OrthogonalizeTangent(const Vector3f &inTangent, const Vector3f &inBinormal, const Vector3f &inNormal, Vector3f &outTangent, float &outBinormalSign);
+
+    // Simplify a triangle mesh with quadric error metrics, collapsing the cheapest edges until there are at most
+    // nTargetTriangles triangles left, or no edge can be collapsed without flipping a triangle or moving the surface
+    // further than fMaxError (in the units of the positions, Y_FLT_MAX for no limit).
+    // Vertices are read as three floats (x, y, z) at the start of each vertex, indices are 32-bit integers.
+    // Vertices are only ever merged into other vertices, so the result indexes the same vertex buffer.
+    // Vertices sharing a position (attribute seams, hard edges) move together, each into the vertex at the other end
+    // of the edge that it shares triangles with, so collapses can run along a seam but never across one.
+    // Vertices on open edges, and vertices sharing a position with one set in pLockedVertices (may be NULL), never move.
+    // pOutTriangles should have space for nTriangles triangles. If pOutSourceTriangles is not NULL, the index of the
+    // input triangle each output triangle came from is written to it.
+    // Returns the number of triangles written.
+    uint32 SimplifyMesh(const void *pInVertices, uint32 uVertexStride, uint32 nVertices, const void *pInTriangles, uint32 uTriangleStride, uint32 nTriangles, const bool *pLockedVertices, uint32 nTargetTriangles, float fMaxError, void *pOutTriangles, uint32 uOutTriangleStride, uint32 *pOutSourceTriangles);
 }
 
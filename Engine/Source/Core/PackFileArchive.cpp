@@ -0,0 +1,508 @@
+#include "Core/PrecompiledHeader.h"
+#include "Core/PackFileArchive.h"
+#include "Core/MappedFile.h"
+#include "Core/LZ4Compression.h"
+#include "YBaseLib/BinaryBlob.h"
+#include "YBaseLib/Log.h"
+Log_SetChannel(PackFileArchive);
+
+// Read-only stream over a range of memory owned by a mapping or blob, which is kept alive by the stream.
+class PackFileStream : public ByteStream
+{
+public:
+    PackFileStream(ReferenceCounted *pOwner, const byte *pData, uint32 size)
+        : m_pOwner(pOwner),
+          m_pData(pData),
+          m_size(size),
+          m_position(0)
+    {
+        m_pOwner->AddRef();
+    }
+
+    ~PackFileStream()
+    {
+        m_pOwner->Release();
+    }
+
+    virtual uint32 Read(void *pDestination, uint32 ByteCount) override
+    {
+        uint32 nBytes = Min(ByteCount, m_size - m_position);
+        Y_memcpy(pDestination, m_pData + m_position, nBytes);
+        m_position += nBytes;
+        return nBytes;
+    }
+
+    virtual bool ReadByte(byte *pDestByte) override
+    {
+        return (Read(reinterpret_cast<void *>(pDestByte), sizeof(byte)) == sizeof(byte));
+    }
+
+    virtual bool Read2(void *pDestination, uint32 ByteCount, uint32 *pNumberOfBytesRead = nullptr) override
+    {
+        uint32 nBytes = Read(pDestination, ByteCount);
+        if (pNumberOfBytesRead != nullptr)
+            *pNumberOfBytesRead = nBytes;
+
+        return (nBytes == ByteCount);
+    }
+
+    virtual uint32 Write(const void *pSource, uint32 ByteCount) override
+    {
+        m_errorState = true;
+        return 0;
+    }
+
+    virtual bool WriteByte(byte SourceByte) override
+    {
+        m_errorState = true;
+        return false;
+    }
+
+    virtual bool Write2(const void *pSource, uint32 ByteCount, uint32 *pNumberOfBytesWritten = nullptr) override
+    {
+        if (pNumberOfBytesWritten != nullptr)
+            *pNumberOfBytesWritten = 0;
+
+        m_errorState = true;
+        return false;
+    }
+
+    virtual bool SeekAbsolute(uint64 Offset) override
+    {
+        if (Offset > (uint64)m_size)
+            return false;
+
+        m_position = (uint32)Offset;
+        return true;
+    }
+
+    virtual bool SeekRelative(int64 Offset) override
+    {
+        int64 newPosition = (int64)m_position + Offset;
+        if (newPosition < 0 || newPosition > (int64)m_size)
+            return false;
+
+        m_position = (uint32)newPosition;
+        return true;
+    }
+
+    virtual bool SeekToEnd() override
+    {
+        m_position = m_size;
+        return true;
+    }
+
+    virtual uint64 GetPosition() const override
+    {
+        return m_position;
+    }
+
+    virtual uint64 GetSize() const override
+    {
+        return m_size;
+    }
+
+    virtual bool Flush() override
+    {
+        return true;
+    }
+
+    virtual bool Discard() override
+    {
+        return false;
+    }
+
+    virtual bool Commit() override
+    {
+        return true;
+    }
+
+private:
+    ReferenceCounted *m_pOwner;
+    const byte *m_pData;
+    uint32 m_size;
+    uint32 m_position;
+};
+
+static inline char CanonicalizeFileNameCharacter(char ch)
+{
+    if (ch == '\\')
+        return '/';
+    else if (ch >= 'A' && ch <= 'Z')
+        return ch - 'A' + 'a';
+    else
+        return ch;
+}
+
+static const char *SkipLeadingSlashes(const char *fileName)
+{
+    while (*fileName == '/' || *fileName == '\\')
+        fileName++;
+
+    return fileName;
+}
+
+// case-insensitive match of * and ? wildcards
+static bool MatchWildcard(const char *pattern, const char *str)
+{
+    const char *pStarPattern = nullptr;
+    const char *pStarString = nullptr;
+    while (*str != '\0')
+    {
+        if (*pattern == '*')
+        {
+            pStarPattern = ++pattern;
+            pStarString = str;
+        }
+        else if (*pattern == '?' || (*pattern != '\0' && CanonicalizeFileNameCharacter(*pattern) == CanonicalizeFileNameCharacter(*str)))
+        {
+            pattern++;
+            str++;
+        }
+        else if (pStarPattern != nullptr)
+        {
+            pattern = pStarPattern;
+            str = ++pStarString;
+        }
+        else
+        {
+            return false;
+        }
+    }
+
+    while (*pattern == '*')
+        pattern++;
+
+    return (*pattern == '\0');
+}
+
+// returns the part of the entry name under the directory, or nullptr if it is not contained in it
+static const char *GetPathRelativeToDirectory(const char *entryName, const char *directory, uint32 directoryLength)
+{
+    if (directoryLength == 0)
+        return entryName;
+
+    if (Y_strnicmp(entryName, directory, directoryLength) != 0 || entryName[directoryLength] != '/')
+        return nullptr;
+
+    return entryName + directoryLength + 1;
+}
+
+uint32 PackFileArchive::HashFileName(const char *fileName, uint32 *pNameLength /* = nullptr */)
+{
+    // fnv-1a over the canonical name
+    const char *pCurrent = SkipLeadingSlashes(fileName);
+    uint32 hash = 2166136261u;
+    uint32 length = 0;
+    for (; *pCurrent != '\0'; pCurrent++, length++)
+    {
+        hash ^= (uint32)(byte)CanonicalizeFileNameCharacter(*pCurrent);
+        hash *= 16777619u;
+    }
+
+    if (pNameLength != nullptr)
+        *pNameLength = length;
+
+    return hash;
+}
+
+PackFileArchive::PackFileArchive(MappedFile *pMappedFile)
+    : m_pMappedFile(pMappedFile),
+      m_pHeader(nullptr),
+      m_pBuckets(nullptr),
+      m_pEntries(nullptr),
+      m_pStrings(nullptr),
+      m_bucketShift(32)
+{
+    m_pMappedFile->AddRef();
+}
+
+PackFileArchive::~PackFileArchive()
+{
+    // any streams still open hold their own reference to the mapping
+    m_pMappedFile->Release();
+}
+
+PackFileArchive *PackFileArchive::Open(const char *osFileName)
+{
+    MappedFile *pMappedFile = MappedFile::Open(osFileName);
+    if (pMappedFile == nullptr)
+        return nullptr;
+
+    PackFileArchive *pArchive = new PackFileArchive(pMappedFile);
+    pMappedFile->Release();
+
+    if (!pArchive->ParseIndex())
+    {
+        Log_ErrorPrintf("PackFileArchive::Open: '%s' is not a valid pack file", osFileName);
+        delete pArchive;
+        return nullptr;
+    }
+
+    return pArchive;
+}
+
+bool PackFileArchive::ParseIndex()
+{
+    const byte *pData = m_pMappedFile->GetData();
+    uint64 fileSize = m_pMappedFile->GetSize();
+    if (fileSize < sizeof(DF_PACKFILE_HEADER))
+        return false;
+
+    const DF_PACKFILE_HEADER *pHeader = reinterpret_cast<const DF_PACKFILE_HEADER *>(pData);
+    if (pHeader->Magic != DF_PACKFILE_HEADER_MAGIC || pHeader->HeaderSize != sizeof(DF_PACKFILE_HEADER) ||
+        pHeader->Version != DF_PACKFILE_VERSION || pHeader->TotalSize != fileSize ||
+        pHeader->HashBucketBits > DF_PACKFILE_MAX_HASH_BUCKET_BITS)
+    {
+        return false;
+    }
+
+    uint32 bucketCount = 1 << pHeader->HashBucketBits;
+    if ((pHeader->BucketsOffset + sizeof(uint32) * (bucketCount + 1)) > fileSize ||
+        (pHeader->EntriesOffset + sizeof(DF_PACKFILE_ENTRY) * (uint64)pHeader->EntryCount) > fileSize ||
+        (pHeader->StringsOffset + pHeader->StringsSize) > fileSize)
+    {
+        return false;
+    }
+
+    m_pHeader = pHeader;
+    m_pBuckets = reinterpret_cast<const uint32 *>(pData + pHeader->BucketsOffset);
+    m_pEntries = reinterpret_cast<const DF_PACKFILE_ENTRY *>(pData + pHeader->EntriesOffset);
+    m_pStrings = reinterpret_cast<const char *>(pData + pHeader->StringsOffset);
+    m_bucketShift = 32 - pHeader->HashBucketBits;
+
+    // validate the index up front, so lookups don't have to
+    if (m_pBuckets[bucketCount] != pHeader->EntryCount)
+        return false;
+    for (uint32 i = 0; i < bucketCount; i++)
+    {
+        if (m_pBuckets[i] > m_pBuckets[i + 1])
+            return false;
+    }
+    for (uint32 i = 0; i < pHeader->EntryCount; i++)
+    {
+        const DF_PACKFILE_ENTRY *pEntry = &m_pEntries[i];
+        if (((uint64)pEntry->NameOffset + pEntry->NameLength) >= pHeader->StringsSize || m_pStrings[pEntry->NameOffset + pEntry->NameLength] != '\0' ||
+            (pEntry->DataOffset + pEntry->DataSize) > fileSize)
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+const DF_PACKFILE_ENTRY *PackFileArchive::FindEntry(const char *fileName) const
+{
+    uint32 nameLength;
+    uint32 hash = HashFileName(fileName, &nameLength);
+    fileName = SkipLeadingSlashes(fileName);
+
+    // 64-bit shift so that a single bucket (shift of 32) works
+    uint32 bucket = (uint32)((uint64)hash >> m_bucketShift);
+    for (uint32 i = m_pBuckets[bucket]; i < m_pBuckets[bucket + 1]; i++)
+    {
+        const DF_PACKFILE_ENTRY *pEntry = &m_pEntries[i];
+        if (pEntry->NameHash != hash || pEntry->NameLength != nameLength)
+            continue;
+
+        // compare with slashes canonicalized, the hash alone is not enough
+        const char *pEntryName = m_pStrings + pEntry->NameOffset;
+        uint32 j;
+        for (j = 0; j < nameLength; j++)
+        {
+            if (CanonicalizeFileNameCharacter(pEntryName[j]) != CanonicalizeFileNameCharacter(fileName[j]))
+                break;
+        }
+        if (j == nameLength)
+            return pEntry;
+    }
+
+    return nullptr;
+}
+
+bool PackFileArchive::FindFiles(const char *Path, const char *Pattern, uint32 Flags, FileSystem::FindResultsArray *pResults)
+{
+    if (!(Flags & FILESYSTEM_FIND_KEEP_ARRAY))
+        pResults->Clear();
+
+    // strip leading and trailing slashes from the directory
+    const char *directory = SkipLeadingSlashes(Path);
+    uint32 directoryLength = Y_strlen(directory);
+    while (directoryLength > 0 && (directory[directoryLength - 1] == '/' || directory[directoryLength - 1] == '\\'))
+        directoryLength--;
+
+    uint32 startResultCount = pResults->GetSize();
+    bool foundDirectory = (directoryLength == 0);
+    for (uint32 entryIndex = 0; entryIndex < m_pHeader->EntryCount; entryIndex++)
+    {
+        const DF_PACKFILE_ENTRY *pEntry = &m_pEntries[entryIndex];
+        const char *entryName = m_pStrings + pEntry->NameOffset;
+        const char *relativeName = GetPathRelativeToDirectory(entryName, directory, directoryLength);
+        if (relativeName == nullptr)
+            continue;
+
+        foundDirectory = true;
+
+        // entries in subdirectories produce the directory names, and the files themselves if recursive
+        const char *pSeparator = Y_strchr(relativeName, '/');
+        for (; pSeparator != nullptr; pSeparator = (Flags & FILESYSTEM_FIND_RECURSIVE) ? Y_strchr(pSeparator + 1, '/') : nullptr)
+        {
+            if (!(Flags & FILESYSTEM_FIND_FOLDERS))
+                continue;
+
+            PathString folderName;
+            folderName.AppendSubString(relativeName, 0, (int32)(pSeparator - relativeName));
+            const char *folderTitle = Y_strrchr(folderName.GetCharArray(), '/');
+            if (!MatchWildcard(Pattern, (folderTitle != nullptr) ? (folderTitle + 1) : folderName.GetCharArray()))
+                continue;
+
+            PathString resultName;
+            if (Flags & FILESYSTEM_FIND_RELATIVE_PATHS || directoryLength == 0)
+                resultName = folderName;
+            else
+                resultName.Format("%.*s/%s", directoryLength, directory, folderName.GetCharArray());
+
+            // many entries share the same folder
+            uint32 i;
+            for (i = startResultCount; i < pResults->GetSize(); i++)
+            {
+                if (Y_stricmp(pResults->GetElement(i).FileName, resultName) == 0)
+                    break;
+            }
+            if (i != pResults->GetSize())
+                continue;
+
+            FILESYSTEM_FIND_DATA findData;
+            Y_memzero(&findData, sizeof(findData));
+            Y_strncpy(findData.FileName, countof(findData.FileName), resultName);
+            findData.Attributes = FILESYSTEM_FILE_ATTRIBUTE_DIRECTORY;
+            pResults->Add(findData);
+        }
+
+        if (!(Flags & FILESYSTEM_FIND_FILES) || (!(Flags & FILESYSTEM_FIND_RECURSIVE) && Y_strchr(relativeName, '/') != nullptr))
+            continue;
+
+        const char *fileTitle = Y_strrchr(relativeName, '/');
+        if (!MatchWildcard(Pattern, (fileTitle != nullptr) ? (fileTitle + 1) : relativeName))
+            continue;
+
+        FILESYSTEM_FIND_DATA findData;
+        Y_memzero(&findData, sizeof(findData));
+        Y_strncpy(findData.FileName, countof(findData.FileName), (Flags & FILESYSTEM_FIND_RELATIVE_PATHS) ? relativeName : entryName);
+        findData.Attributes = (pEntry->Flags & DF_PACKFILE_ENTRY_FLAG_COMPRESSED_LZ4) ? FILESYSTEM_FILE_ATTRIBUTE_COMPRESSED : 0;
+        findData.ModificationTime.SetUnixTimestamp(pEntry->ModificationTime);
+        findData.Size = pEntry->UncompressedSize;
+        pResults->Add(findData);
+    }
+
+    return foundDirectory;
+}
+
+bool PackFileArchive::StatFile(const char *Path, FILESYSTEM_STAT_DATA *pStatData)
+{
+    const DF_PACKFILE_ENTRY *pEntry = FindEntry(Path);
+    if (pEntry != nullptr)
+    {
+        pStatData->Attributes = (pEntry->Flags & DF_PACKFILE_ENTRY_FLAG_COMPRESSED_LZ4) ? FILESYSTEM_FILE_ATTRIBUTE_COMPRESSED : 0;
+        pStatData->ModificationTime.SetUnixTimestamp(pEntry->ModificationTime);
+        pStatData->Size = pEntry->UncompressedSize;
+        return true;
+    }
+
+    // directories aren't stored, so check if any entry is under this path
+    const char *directory = SkipLeadingSlashes(Path);
+    uint32 directoryLength = Y_strlen(directory);
+    while (directoryLength > 0 && (directory[directoryLength - 1] == '/' || directory[directoryLength - 1] == '\\'))
+        directoryLength--;
+
+    for (uint32 entryIndex = 0; entryIndex < m_pHeader->EntryCount; entryIndex++)
+    {
+        if (GetPathRelativeToDirectory(m_pStrings + m_pEntries[entryIndex].NameOffset, directory, directoryLength) != nullptr)
+        {
+            pStatData->Attributes = FILESYSTEM_FILE_ATTRIBUTE_DIRECTORY;
+            pStatData->ModificationTime.SetUnixTimestamp(0);
+            pStatData->Size = 0;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+bool PackFileArchive::GetFileName(String &Destination, const char *FileName)
+{
+    const DF_PACKFILE_ENTRY *pEntry = FindEntry(FileName);
+    if (pEntry == nullptr)
+        return false;
+
+    Destination = m_pStrings + pEntry->NameOffset;
+    return true;
+}
+
+ByteStream *PackFileArchive::OpenFile(const char *FileName, uint32 Flags)
+{
+    // pack files are read-only
+    if (Flags & (BYTESTREAM_OPEN_WRITE | BYTESTREAM_OPEN_CREATE))
+        return nullptr;
+
+    const DF_PACKFILE_ENTRY *pEntry = FindEntry(FileName);
+    if (pEntry == nullptr)
+        return nullptr;
+
+    const byte *pEntryData = m_pMappedFile->GetData() + pEntry->DataOffset;
+    if (!(pEntry->Flags & DF_PACKFILE_ENTRY_FLAG_COMPRESSED_LZ4))
+        return new PackFileStream(m_pMappedFile, pEntryData, pEntry->DataSize);
+
+    BinaryBlob *pBlob = BinaryBlob::Allocate(pEntry->UncompressedSize);
+    if (!LZ4Compression::Decompress(pEntryData, pEntry->DataSize, pBlob->GetDataPointer(), pEntry->UncompressedSize))
+    {
+        Log_ErrorPrintf("PackFileArchive::OpenFile: Failed to decompress '%s'", m_pStrings + pEntry->NameOffset);
+        pBlob->Release();
+        return nullptr;
+    }
+
+    // the stream takes its own reference to the blob
+    ByteStream *pStream = new PackFileStream(pBlob, reinterpret_cast<const byte *>(pBlob->GetDataPointer()), pEntry->UncompressedSize);
+    pBlob->Release();
+    return pStream;
+}
+
+MappedFile *PackFileArchive::MapFile(const char *FileName)
+{
+    const DF_PACKFILE_ENTRY *pEntry = FindEntry(FileName);
+    if (pEntry == nullptr)
+        return nullptr;
+
+    // stored entries are a view of the pack mapping itself
+    const byte *pEntryData = m_pMappedFile->GetData() + pEntry->DataOffset;
+    if (!(pEntry->Flags & DF_PACKFILE_ENTRY_FLAG_COMPRESSED_LZ4))
+        return MappedFile::CreateView(m_pMappedFile, pEntryData, pEntry->DataSize);
+
+    BinaryBlob *pBlob = BinaryBlob::Allocate(pEntry->UncompressedSize);
+    if (!LZ4Compression::Decompress(pEntryData, pEntry->DataSize, pBlob->GetDataPointer(), pEntry->UncompressedSize))
+    {
+        Log_ErrorPrintf("PackFileArchive::MapFile: Failed to decompress '%s'", m_pStrings + pEntry->NameOffset);
+        pBlob->Release();
+        return nullptr;
+    }
+
+    MappedFile *pMappedFile = MappedFile::CreateView(pBlob, reinterpret_cast<const byte *>(pBlob->GetDataPointer()), pEntry->UncompressedSize);
+    pBlob->Release();
+    return pMappedFile;
+}
+
+bool PackFileArchive::DeleteFile(const char *FileName)
+{
+    return false;
+}
+
+bool PackFileArchive::DeleteDirectory(const char *FileName, bool recursive)
+{
+    return false;
+}
+
+FileSystem::ChangeNotifier *PackFileArchive::CreateChangeNotifier(const String &directoryPath)
+{
+    return nullptr;
+}
@@ -0,0 +1,49 @@
+#pragma once
+#include "Core/Common.h"
+#include "Core/VirtualFileSystem.h"
+#include "Core/PackFileDataFormat.h"
+
+class MappedFile;
+
+// Read-only archive over a memory-mapped pack file. Stored entries are read directly from the mapping,
+// compressed entries are decompressed into memory on open.
+class PackFileArchive : public VirtualFileSystemArchive
+{
+public:
+    ~PackFileArchive();
+
+    // opens a pack file by OS path, returns nullptr if it is missing or invalid
+    static PackFileArchive *Open(const char *osFileName);
+
+    // hash used for the entry table, names are case-insensitive and use forward slashes
+    static uint32 HashFileName(const char *fileName, uint32 *pNameLength = nullptr);
+
+    // entry access
+    uint32 GetEntryCount() const { return m_pHeader->EntryCount; }
+    const DF_PACKFILE_ENTRY *GetEntry(uint32 index) const { return &m_pEntries[index]; }
+    const char *GetEntryName(const DF_PACKFILE_ENTRY *pEntry) const { return m_pStrings + pEntry->NameOffset; }
+    const DF_PACKFILE_ENTRY *FindEntry(const char *fileName) const;
+
+    // VirtualFileSystemArchive
+    virtual const char *GetArchiveTypeName() const override { return "PackFileArchive"; }
+    virtual bool FindFiles(const char *Path, const char *Pattern, uint32 Flags, FileSystem::FindResultsArray *pResults) override;
+    virtual bool StatFile(const char *Path, FILESYSTEM_STAT_DATA *pStatData) override;
+    virtual bool GetFileName(String &Destination, const char *FileName) override;
+    virtual ByteStream *OpenFile(const char *FileName, uint32 Flags) override;
+    virtual MappedFile *MapFile(const char *FileName) override;
+    virtual bool DeleteFile(const char *FileName) override;
+    virtual bool DeleteDirectory(const char *FileName, bool recursive) override;
+    virtual FileSystem::ChangeNotifier *CreateChangeNotifier(const String &directoryPath) override;
+
+private:
+    PackFileArchive(MappedFile *pMappedFile);
+    bool ParseIndex();
+
+    MappedFile *m_pMappedFile;
+    const DF_PACKFILE_HEADER *m_pHeader;
+    const uint32 *m_pBuckets;
+    const DF_PACKFILE_ENTRY *m_pEntries;
+    const char *m_pStrings;
+    uint32 m_bucketShift;
+};
+
@@ -0,0 +1,51 @@
+#pragma once
+#include "Core/Common.h"
+
+// Pack file layout:
+//   header
+//   file data, each entry starting on a DF_PACKFILE_DATA_ALIGNMENT boundary
+//   bucket table, BucketCount + 1 entry indices
+//   entry table, sorted by NameHash
+//   string table, null-terminated file names
+// Entries with the same top HashBucketBits bits of their name hash are stored contiguously, so a lookup only
+// has to search the range [Buckets[bucket], Buckets[bucket + 1]) of the entry table.
+#define DF_PACKFILE_HEADER_MAGIC 0x4B415059
+#define DF_PACKFILE_VERSION 1
+#define DF_PACKFILE_DATA_ALIGNMENT 4096
+#define DF_PACKFILE_MAX_HASH_BUCKET_BITS 20
+
+#pragma pack(push, 4)
+
+enum DF_PACKFILE_ENTRY_FLAGS
+{
+    DF_PACKFILE_ENTRY_FLAG_COMPRESSED_LZ4       = (1 << 0),
+};
+
+struct DF_PACKFILE_HEADER
+{
+    uint32 Magic;
+    uint32 HeaderSize;
+    uint32 Version;
+    uint32 EntryCount;
+    uint32 HashBucketBits;
+    uint32 StringsSize;
+    uint64 BucketsOffset;
+    uint64 EntriesOffset;
+    uint64 StringsOffset;
+    uint64 TotalSize;
+};
+
+struct DF_PACKFILE_ENTRY
+{
+    uint32 NameHash;
+    uint32 NameOffset;
+    uint32 NameLength;
+    uint32 Flags;
+    uint64 DataOffset;
+    uint32 DataSize;
+    uint32 UncompressedSize;
+    uint64 ModificationTime;
+};
+
+#pragma pack(pop)
+
@@ -0,0 +1,206 @@
+#include "Core/PrecompiledHeader.h"
+#include "Core/PackFileWriter.h"
+#include "Core/PackFileArchive.h"
+#include "Core/LZ4Compression.h"
+#include "YBaseLib/ByteStream.h"
+#include "YBaseLib/Log.h"
+Log_SetChannel(PackFileWriter);
+
+// compressed entries have to be at least this much smaller than the original to be stored compressed,
+// otherwise the decompression cost isn't worth it, and the entry can't be read straight from the mapping
+static const float PACKFILE_MINIMUM_COMPRESSION_RATIO = 0.9f;
+
+PackFileWriter::PackFileWriter()
+    : m_pStream(nullptr),
+      m_compressedEntryCount(0),
+      m_uncompressedDataSize(0),
+      m_storedDataSize(0)
+{
+
+}
+
+PackFileWriter::~PackFileWriter()
+{
+    if (m_pStream != nullptr)
+        Close();
+}
+
+bool PackFileWriter::Initialize(ByteStream *pStream)
+{
+    DebugAssert(m_pStream == nullptr);
+    if (pStream->GetPosition() != 0)
+    {
+        Log_ErrorPrintf("PackFileWriter::Initialize: Stream must be empty");
+        return false;
+    }
+
+    m_pStream = pStream;
+    m_pStream->AddRef();
+
+    // placeholder header, rewritten on close
+    DF_PACKFILE_HEADER emptyHeader;
+    Y_memzero(&emptyHeader, sizeof(emptyHeader));
+    emptyHeader.Magic = ~(uint32)DF_PACKFILE_HEADER_MAGIC;
+    m_pStream->Write2(&emptyHeader, sizeof(emptyHeader));
+    return !m_pStream->InErrorState();
+}
+
+bool PackFileWriter::WritePadding(uint32 alignment)
+{
+    static const byte zeroBytes[256] = { 0 };
+
+    uint64 position = m_pStream->GetPosition();
+    uint32 paddingSize = (uint32)(((position + alignment - 1) & ~(uint64)(alignment - 1)) - position);
+    while (paddingSize > 0)
+    {
+        uint32 writeSize = Min(paddingSize, (uint32)sizeof(zeroBytes));
+        if (!m_pStream->Write2(zeroBytes, writeSize))
+            return false;
+
+        paddingSize -= writeSize;
+    }
+
+    return true;
+}
+
+bool PackFileWriter::AddFile(const char *fileName, const void *pData, uint32 dataSize, uint64 modificationTime, bool compress)
+{
+    DebugAssert(m_pStream != nullptr);
+
+    // names are stored without leading slashes, and with forward slashes
+    while (*fileName == '/' || *fileName == '\\')
+        fileName++;
+
+    uint32 nameLength;
+    uint32 nameHash = PackFileArchive::HashFileName(fileName, &nameLength);
+    if (nameLength == 0)
+        return false;
+
+    for (uint32 i = 0; i < m_entries.GetSize(); i++)
+    {
+        if (m_entries[i].NameHash == nameHash && Y_stricmp(m_stringData.GetBasePointer() + m_entries[i].NameOffset, fileName) == 0)
+        {
+            Log_ErrorPrintf("PackFileWriter::AddFile: Duplicate file '%s'", fileName);
+            return false;
+        }
+    }
+
+    // try compressing it
+    byte *pCompressedData = nullptr;
+    uint32 compressedSize = 0;
+    if (compress && dataSize > 0)
+    {
+        uint32 compressedBufferSize = LZ4Compression::GetMaxCompressedSize(dataSize);
+        pCompressedData = (byte *)Y_malloc(compressedBufferSize);
+        compressedSize = LZ4Compression::Compress(pData, dataSize, pCompressedData, compressedBufferSize);
+        if (compressedSize == 0 || (float)compressedSize > ((float)dataSize * PACKFILE_MINIMUM_COMPRESSION_RATIO))
+        {
+            Y_free(pCompressedData);
+            pCompressedData = nullptr;
+        }
+    }
+
+    // data is page aligned so it can be handed out straight from the mapping
+    if (!WritePadding(DF_PACKFILE_DATA_ALIGNMENT))
+    {
+        Y_free(pCompressedData);
+        return false;
+    }
+
+    DF_PACKFILE_ENTRY entry;
+    entry.NameHash = nameHash;
+    entry.NameOffset = m_stringData.GetSize();
+    entry.NameLength = nameLength;
+    entry.Flags = (pCompressedData != nullptr) ? DF_PACKFILE_ENTRY_FLAG_COMPRESSED_LZ4 : 0;
+    entry.DataOffset = m_pStream->GetPosition();
+    entry.DataSize = (pCompressedData != nullptr) ? compressedSize : dataSize;
+    entry.UncompressedSize = dataSize;
+    entry.ModificationTime = modificationTime;
+
+    bool writeResult = m_pStream->Write2((pCompressedData != nullptr) ? pCompressedData : pData, entry.DataSize);
+    Y_free(pCompressedData);
+    if (!writeResult)
+        return false;
+
+    // store the name, with separators fixed, and the terminator
+    for (uint32 i = 0; i < nameLength; i++)
+        m_stringData.Add((fileName[i] == '\\') ? '/' : fileName[i]);
+    m_stringData.Add('\0');
+    m_entries.Add(entry);
+
+    if (entry.Flags & DF_PACKFILE_ENTRY_FLAG_COMPRESSED_LZ4)
+        m_compressedEntryCount++;
+    m_uncompressedDataSize += entry.UncompressedSize;
+    m_storedDataSize += entry.DataSize;
+    return true;
+}
+
+static int EntryCompareFunction(const DF_PACKFILE_ENTRY *pLeft, const DF_PACKFILE_ENTRY *pRight)
+{
+    // ties on hash fall back to insertion order, so the output is deterministic
+    if (pLeft->NameHash != pRight->NameHash)
+        return (pLeft->NameHash < pRight->NameHash) ? -1 : 1;
+    else
+        return (pLeft->NameOffset < pRight->NameOffset) ? -1 : ((pLeft->NameOffset > pRight->NameOffset) ? 1 : 0);
+}
+
+bool PackFileWriter::Close()
+{
+    DebugAssert(m_pStream != nullptr);
+
+    // aim for roughly one entry per bucket
+    uint32 hashBucketBits = 0;
+    while (hashBucketBits < DF_PACKFILE_MAX_HASH_BUCKET_BITS && (1u << hashBucketBits) < m_entries.GetSize())
+        hashBucketBits++;
+
+    uint32 bucketCount = 1 << hashBucketBits;
+    m_entries.Sort(EntryCompareFunction);
+
+    // sorted by hash, so each bucket is a contiguous range of entries
+    uint32 *pBuckets = new uint32[bucketCount + 1];
+    uint32 entryIndex = 0;
+    for (uint32 bucket = 0; bucket < bucketCount; bucket++)
+    {
+        pBuckets[bucket] = entryIndex;
+        while (entryIndex < m_entries.GetSize() && (uint32)((uint64)m_entries[entryIndex].NameHash >> (32 - hashBucketBits)) == bucket)
+            entryIndex++;
+    }
+    pBuckets[bucketCount] = entryIndex;
+    DebugAssert(entryIndex == m_entries.GetSize());
+
+    DF_PACKFILE_HEADER header;
+    header.Magic = DF_PACKFILE_HEADER_MAGIC;
+    header.HeaderSize = sizeof(header);
+    header.Version = DF_PACKFILE_VERSION;
+    header.EntryCount = m_entries.GetSize();
+    header.HashBucketBits = hashBucketBits;
+    header.StringsSize = m_stringData.GetSize();
+
+    WritePadding(sizeof(uint64));
+    header.BucketsOffset = m_pStream->GetPosition();
+    m_pStream->Write2(pBuckets, sizeof(uint32) * (bucketCount + 1));
+    delete[] pBuckets;
+
+    WritePadding(sizeof(uint64));
+    header.EntriesOffset = m_pStream->GetPosition();
+    if (m_entries.GetSize() > 0)
+        m_pStream->Write2(m_entries.GetBasePointer(), sizeof(DF_PACKFILE_ENTRY) * m_entries.GetSize());
+
+    header.StringsOffset = m_pStream->GetPosition();
+    if (m_stringData.GetSize() > 0)
+        m_pStream->Write2(m_stringData.GetBasePointer(), m_stringData.GetSize());
+
+    header.TotalSize = m_pStream->GetPosition();
+
+    // rewrite header
+    m_pStream->SeekAbsolute(0);
+    m_pStream->Write2(&header, sizeof(header));
+    m_pStream->SeekAbsolute(header.TotalSize);
+
+    bool closeResult = !m_pStream->InErrorState();
+    m_pStream->Release();
+    m_pStream = nullptr;
+    m_entries.Obliterate();
+    m_stringData.Obliterate();
+    return closeResult;
+}
@@ -0,0 +1,39 @@
+#pragma once
+#include "Core/Common.h"
+#include "Core/PackFileDataFormat.h"
+#include "YBaseLib/MemArray.h"
+#include "YBaseLib/PODArray.h"
+
+class ByteStream;
+
+// Builds a pack file readable by PackFileArchive. The stream should be empty, as entry offsets are absolute.
+class PackFileWriter
+{
+public:
+    PackFileWriter();
+    ~PackFileWriter();
+
+    bool Initialize(ByteStream *pStream);
+    bool Close();
+
+    // adds a file, if compress is set the entry is only stored compressed if it saves space
+    bool AddFile(const char *fileName, const void *pData, uint32 dataSize, uint64 modificationTime, bool compress);
+
+    // statistics
+    uint32 GetEntryCount() const { return m_entries.GetSize(); }
+    uint32 GetCompressedEntryCount() const { return m_compressedEntryCount; }
+    uint64 GetUncompressedDataSize() const { return m_uncompressedDataSize; }
+    uint64 GetStoredDataSize() const { return m_storedDataSize; }
+
+private:
+    bool WritePadding(uint32 alignment);
+
+    ByteStream *m_pStream;
+    MemArray<DF_PACKFILE_ENTRY> m_entries;
+    PODArray<char> m_stringData;
+
+    uint32 m_compressedEntryCount;
+    uint64 m_uncompressedDataSize;
+    uint64 m_storedDataSize;
+};
+
@@ -61,10 +61,10 @@ static const PIXEL_FORMAT_INFO g_PixelFormatInfo[PIXEL_FORMAT_COUNT] =
     { "PIXEL_FORMAT_BC2_UNORM_SRGB",            4,              true,           true,       true,               16,             4,          PIXEL_FORMAT_R8G8B8A8_UNORM_SRGB,   PIXEL_FORMAT_BC2_UNORM,             0x00000000,     0x00000000,     0x00000000,     0x00000000,     4,          0,          0           },
     { "PIXEL_FORMAT_BC3_UNORM",                 8,              true,           true,       true,               16,             4,          PIXEL_FORMAT_R8G8B8A8_UNORM,        PIXEL_FORMAT_BC3_UNORM,             0x00000000,     0x00000000,     0x00000000,     0x00000000,     8,          0,          0           },
     { "PIXEL_FORMAT_BC3_UNORM_SRGB",            8,              true,           true,       true,               16,             4,          PIXEL_FORMAT_R8G8B8A8_UNORM_SRGB,   PIXEL_FORMAT_BC3_UNORM,             0x00000000,     0x00000000,     0x00000000,     0x00000000,     8,          0,          0           },
-    { "PIXEL_FORMAT_BC4_UNORM",                 8,              true,           true,       true,               16,             4,          PIXEL_FORMAT_R16_UNORM,             PIXEL_FORMAT_BC4_UNORM,             0x00000000,     0x00000000,     0x00000000,     0x00000000,     8,          0,          0           },
-    { "PIXEL_FORMAT_BC4_SNORM",                 8,              true,           true,       true,               16,             4,          PIXEL_FORMAT_R16_SNORM,             PIXEL_FORMAT_BC4_SNORM,             0x00000000,     0x00000000,     0x00000000,     0x00000000,     8,          0,          0           },
-    { "PIXEL_FORMAT_BC5_UNORM",                 8,              true,           true,       true,               16,             4,          PIXEL_FORMAT_R16G16_UNORM,          PIXEL_FORMAT_BC5_UNORM,             0x00000000,     0x00000000,     0x00000000,     0x00000000,     8,          0,          0           },
-    { "PIXEL_FORMAT_BC5_SNORM",                 8,              true,           true,       true,               16,             4,          PIXEL_FORMAT_R16G16_SNORM,          PIXEL_FORMAT_BC5_SNORM,             0x00000000,     0x00000000,     0x00000000,     0x00000000,     8,          0,          0           },
+    { "PIXEL_FORMAT_BC4_UNORM",                 4,              true,           false,      true,               8,              4,          PIXEL_FORMAT_R8_UNORM,              PIXEL_FORMAT_BC4_UNORM,             0x00000000,     0x00000000,     0x00000000,     0x00000000,     4,          0,          0           },
+    { "PIXEL_FORMAT_BC4_SNORM",                 4,              true,           false,      true,               8,              4,          PIXEL_FORMAT_R8_SNORM,              PIXEL_FORMAT_BC4_SNORM,             0x00000000,     0x00000000,     0x00000000,     0x00000000,     4,          0,          0           },
+    { "PIXEL_FORMAT_BC5_UNORM",                 8,              true,           false,      true,               16,             4,          PIXEL_FORMAT_R8G8_UNORM,            PIXEL_FORMAT_BC5_UNORM,             0x00000000,     0x00000000,     0x00000000,     0x00000000,     8,          0,          0           },
+    { "PIXEL_FORMAT_BC5_SNORM",                 8,              true,           false,      true,               16,             4,          PIXEL_FORMAT_R8G8_SNORM,            PIXEL_FORMAT_BC5_SNORM,             0x00000000,     0x00000000,     0x00000000,     0x00000000,     8,          0,          0           },
     { "PIXEL_FORMAT_BC6H_UF16",                 8,              false,          true,       true,               16,             4,          PIXEL_FORMAT_R16G16_UNORM,          PIXEL_FORMAT_BC6H_UF16,             0x00000000,     0x00000000,     0x00000000,     0x00000000,     8,          0,          0           },
     { "PIXEL_FORMAT_BC6H_SF16",                 8,              false,          true,       true,               16,             4,          PIXEL_FORMAT_R16G16_SNORM,          PIXEL_FORMAT_BC6H_SF16,             0x00000000,     0x00000000,     0x00000000,     0x00000000,     8,          0,          0           },
     { "PIXEL_FORMAT_BC7_UNORM",                 8,              true,           true,       true,               16,             4,          PIXEL_FORMAT_R8G8B8A8_UNORM,        PIXEL_FORMAT_BC7_UNORM,             0x00000000,     0x00000000,     0x00000000,     0x00000000,     8,          0,          0           },
@@ -136,6 +136,8 @@ uint32 PixelFormat_CalculateSlicePitch(PIXEL_FORMAT Format, uint32 uWidth, uint3
 uint32 PixelFormat_CalculateImageNumRows(PIXEL_FORMAT Format, uint32 Width, uint32 Height);
 uint32 PixelFormat_CalculateImageSize(PIXEL_FORMAT Format, uint32 uWidth, uint32 uHeight, uint32 uDepth);
 bool PixelFormat_ConvertPixels(uint32 Width, uint32 Height, const void *SourcePixels, uint32 SourcePitch, PIXEL_FORMAT SourceFormat, void *DestinationPixels, uint32 DestinationPitch, PIXEL_FORMAT DestinationFormat, uint32 *DestinationPixelSize);
+// Always converts via the decode/encode functions, skipping the direct converters. Used by PixelFormat_ConvertPixels for uncommon pairs.
+bool PixelFormat_ConvertPixelsThroughFloat(uint32 Width, uint32 Height, const void *SourcePixels, uint32 SourcePitch, PIXEL_FORMAT SourceFormat, void *DestinationPixels, uint32 DestinationPitch, PIXEL_FORMAT DestinationFormat, uint32 *DestinationPixelSize);
 void PixelFormat_FlipImageInPlace(void *pPixels, uint32 rowPitch, uint32 rowCount);
 void PixelFormat_FlipImage(void *pDestinationPixels, const void *pPixels, uint32 rowPitch, uint32 rowCount);
 
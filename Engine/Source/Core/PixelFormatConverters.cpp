@@ -1,11 +1,15 @@
 #include "Core/PrecompiledHeader.h"
 #include "Core/PixelFormat.h"
+#include "Core/BlockCompression.h"
 #include "YBaseLib/Assert.h"
 #include "YBaseLib/Memory.h"
 #include "YBaseLib/Log.h"
+#if Y_CPU_SSE_LEVEL > 0
+    #include <intrin.h>
+#endif
 Log_SetChannel(PixelFormatConverters);
 
-// kinda a crappy converter, but basically we just convert each pixel to a R32G32B32A32 pixel, then back to the destination format
+// common pairs have direct converters, anything else is decoded to R32G32B32A32 pixels in strips, then encoded to the destination format
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 static void DecodeR8G8B8A8(const void *pInPixels, float *pOutPixels, uint32 Width, uint32 Height, uint32 SourcePitch, PIXEL_FORMAT SourceFormat)
 {
@@ -57,10 +61,10 @@ static void DecodeB8G8R8A8(const void *pInPixels, float *pOutPixels, uint32 Widt
     {
         for (j = 0; j < Width; j++)
         {
-            pOutRow[j * 4 + 0] = float(pInBytes[j * 4 + 3]) / 255.0f;
-            pOutRow[j * 4 + 1] = float(pInBytes[j * 4 + 2]) / 255.0f;
-            pOutRow[j * 4 + 2] = float(pInBytes[j * 4 + 1]) / 255.0f;
-            pOutRow[j * 4 + 3] = float(pInBytes[j * 4 + 0]) / 255.0f;
+            pOutRow[j * 4 + 0] = float(pInBytes[j * 4 + 2]) / 255.0f;
+            pOutRow[j * 4 + 1] = float(pInBytes[j * 4 + 1]) / 255.0f;
+            pOutRow[j * 4 + 2] = float(pInBytes[j * 4 + 0]) / 255.0f;
+            pOutRow[j * 4 + 3] = float(pInBytes[j * 4 + 3]) / 255.0f;
         }
         pInBytes += SourcePitch;
         pOutRow += Width * 4;
@@ -77,9 +81,9 @@ static void DecodeB8G8R8(const void *pInPixels, float *pOutPixels, uint32 Width,
     {
         for (j = 0; j < Width; j++)
         {
-            pOutRow[j * 4 + 0] = float(pInBytes[j * 3 + 3]) / 255.0f;
-            pOutRow[j * 4 + 1] = float(pInBytes[j * 3 + 2]) / 255.0f;
-            pOutRow[j * 4 + 2] = float(pInBytes[j * 3 + 1]) / 255.0f;
+            pOutRow[j * 4 + 0] = float(pInBytes[j * 3 + 2]) / 255.0f;
+            pOutRow[j * 4 + 1] = float(pInBytes[j * 3 + 1]) / 255.0f;
+            pOutRow[j * 4 + 2] = float(pInBytes[j * 3 + 0]) / 255.0f;
             pOutRow[j * 4 + 3] = 1.0f;
         }
         pInBytes += SourcePitch;
@@ -97,9 +101,9 @@ static void DecodeB8G8R8X8(const void *pInPixels, float *pOutPixels, uint32 Widt
     {
         for (j = 0; j < Width; j++)
         {
-            pOutRow[j * 4 + 0] = float(pInBytes[j * 4 + 3]) / 255.0f;
-            pOutRow[j * 4 + 1] = float(pInBytes[j * 4 + 2]) / 255.0f;
-            pOutRow[j * 4 + 2] = float(pInBytes[j * 4 + 1]) / 255.0f;
+            pOutRow[j * 4 + 0] = float(pInBytes[j * 4 + 2]) / 255.0f;
+            pOutRow[j * 4 + 1] = float(pInBytes[j * 4 + 1]) / 255.0f;
+            pOutRow[j * 4 + 2] = float(pInBytes[j * 4 + 0]) / 255.0f;
             pOutRow[j * 4 + 3] = 1.0f;
         }
         pInBytes += SourcePitch;
@@ -127,6 +131,26 @@ static void DecodeR8(const void *pInPixels, float *pOutPixels, uint32 Width, uin
     }
 }
 
+static void DecodeR8G8(const void *pInPixels, float *pOutPixels, uint32 Width, uint32 Height, uint32 SourcePitch, PIXEL_FORMAT SourceFormat)
+{
+    const byte *pInBytes = (const byte *)pInPixels;
+    float *pOutRow = pOutPixels;
+    uint32 i, j;
+
+    for (i = 0; i < Height; i++)
+    {
+        for (j = 0; j < Width; j++)
+        {
+            pOutRow[j * 4 + 0] = float(pInBytes[j * 2 + 0]) / 255.0f;
+            pOutRow[j * 4 + 1] = float(pInBytes[j * 2 + 1]) / 255.0f;
+            pOutRow[j * 4 + 2] = 1.0f;
+            pOutRow[j * 4 + 3] = 1.0f;
+        }
+        pInBytes += SourcePitch;
+        pOutRow += Width * 4;
+    }
+}
+
 static void DecodeR32G32B32A32F(const void *pInPixels, float *pOutPixels, uint32 Width, uint32 Height, uint32 SourcePitch, PIXEL_FORMAT SourceFormat)
 {
     const byte *pInBytes = (const byte *)pInPixels;
@@ -374,6 +398,24 @@ static void EncodeR8(const float *pInPixels, void *pOutPixels, uint32 Width, uin
     }
 }
 
+static void EncodeR8G8(const float *pInPixels, void *pOutPixels, uint32 Width, uint32 Height, uint32 DestinationPitch, PIXEL_FORMAT DestinationFormat)
+{
+    byte *pOutBytes = (byte *)pOutPixels;
+    const float *pInRow = pInPixels;
+    uint32 i, j;
+
+    for (i = 0; i < Height; i++)
+    {
+        for (j = 0; j < Width; j++)
+        {
+            pOutBytes[j * 2 + 0] = (byte)(pInRow[j * 4 + 0] * 255.0f);
+            pOutBytes[j * 2 + 1] = (byte)(pInRow[j * 4 + 1] * 255.0f);
+        }
+        pOutBytes += DestinationPitch;
+        pInRow += Width * 4;
+    }
+}
+
 static void EncodeR32G32B32A32F(const float *pInPixels, void *pOutPixels, uint32 Width, uint32 Height, uint32 DestinationPitch, PIXEL_FORMAT DestinationFormat)
 {
     byte *pOutBytes = (byte *)pOutPixels;
@@ -468,70 +510,40 @@ static void EncodeR16F(const float *pInPixels, void *pOutPixels, uint32 Width, u
 //     }
 // }
 
-#ifdef HAVE_SQUISH
-
-#include <squish.h>
-
-static void EncodeBC123(const float *pInPixels, void *pOutPixels, uint32 Width, uint32 Height, uint32 DestinationPitch, PIXEL_FORMAT DestinationFormat)
+static void DecodeBC45(const void *pInPixels, float *pOutPixels, uint32 width, uint32 height, uint32 sourcePitch, PIXEL_FORMAT sourceFormat)
 {
-//    static const float *ZeroPixel = { 0, 0, 0, 0 };
-//#define GETPIXEL(row, col) ((row < Width && col < Height) ? ((float *)(((byte *)pInPixels) + ((row * Width) + col) * DestinationPitch)) : ZeroPixel;
-    //static const uint32 *ZeroPixel = { 0, 0, 0, 0xFF };
-
-    const PIXEL_FORMAT_INFO *pFormatInfo = PixelFormat_GetPixelFormatInfo(DestinationFormat);
-    uint32 BlocksWide = Max((uint32)1, Width / pFormatInfo->BlockSize);
-    uint32 BlocksHigh = Max((uint32)1, Height / pFormatInfo->BlockSize);
-    byte *pOutBytes = (byte *)pOutPixels;
-
-    uint32 BlockIn[16];
-
-    //uint32 Flags = squish::kColourRangeFit;
-    uint32 Flags = squish::kColourIterativeClusterFit;
-    if (DestinationFormat == PIXEL_FORMAT_BC1_UNORM)
-        Flags |= squish::kDxt1;
-    else if (DestinationFormat == PIXEL_FORMAT_BC2_UNORM)
-        Flags |= squish::kDxt3;
-    else if (DestinationFormat == PIXEL_FORMAT_BC3_UNORM)
-        Flags |= squish::kDxt5;
+    const PIXEL_FORMAT_INFO *pFormatInfo = PixelFormat_GetPixelFormatInfo(sourceFormat);
+    uint32 blocksWide = Max((uint32)1, width / 4);
+    uint32 blocksHigh = Max((uint32)1, height / 4);
 
-    for (uint32 i = 0; i < BlocksHigh; i++)
+    for (uint32 by = 0; by < blocksHigh; by++)
     {
-        for (uint32 j = 0; j < BlocksWide; j++)
+        const byte *pSourcePointer = reinterpret_cast<const byte *>(pInPixels) + (sourcePitch * by);
+        for (uint32 bx = 0; bx < blocksWide; bx++)
         {
-            uint32 mask = 0;
-            uint32 maskPos = 0;
+            byte blockRGBA[16 * 4];
+            BlockCompression::DecodeBlock(sourceFormat, pSourcePointer, blockRGBA);
 
-            for (uint32 y = 0; y < 4; y++)
+            for (uint32 y = 0; y < 4 && (by * 4 + y) < height; y++)
             {
-                for (uint32 x = 0; x < 4; x++)
+                for (uint32 x = 0; x < 4 && (bx * 4 + x) < width; x++)
                 {
-                    uint32 rx = j * pFormatInfo->BlockSize + x;
-                    uint32 ry = i * pFormatInfo->BlockSize + y;
-
-                    if (rx < Width && ry < Height)
-                    {
-                        const float *pSrcPixel = &pInPixels[(ry * Width + rx) * 4];
-                        byte *pDstPixel = (byte *)&BlockIn[y * 4 + x];
-                        pDstPixel[0] = Min((byte)255, (byte)(pSrcPixel[0] * 255.0f));
-                        pDstPixel[1] = Min((byte)255, (byte)(pSrcPixel[1] * 255.0f));
-                        pDstPixel[2] = Min((byte)255, (byte)(pSrcPixel[2] * 255.0f));
-                        pDstPixel[3] = Min((byte)255, (byte)(pSrcPixel[3] * 255.0f));
-
-                        mask |= 1 << maskPos;
-                    }
-
-                    maskPos++;
+                    const byte *pBlockPixel = &blockRGBA[(y * 4 + x) * 4];
+                    float *pDstPixel = &pOutPixels[((by * 4 + y) * width + bx * 4 + x) * 4];
+                    for (uint32 c = 0; c < 4; c++)
+                        pDstPixel[c] = (float)pBlockPixel[c] / 255.0f;
                 }
             }
 
-            byte *BlockOut = pOutBytes + (j * pFormatInfo->BytesPerBlock);
-            //squish::Compress((const squish::u8 *)BlockIn, (squish::u8 *)BlockOut, Flags);
-            squish::CompressMasked((const squish::u8 *)BlockIn, mask, (squish::u8 *)BlockOut, Flags);
+            pSourcePointer += pFormatInfo->BytesPerBlock;
         }
-        pOutBytes += DestinationPitch;
     }
 }
 
+#ifdef HAVE_SQUISH
+
+#include <squish.h>
+
 static void DecodeBC123(const void *pInPixels, float *pOutPixels, uint32 width, uint32 height, uint32 sourcePitch, PIXEL_FORMAT sourceFormat)
 {
     const PIXEL_FORMAT_INFO *pFormatInfo = PixelFormat_GetPixelFormatInfo(sourceFormat);
@@ -575,10 +587,10 @@ static void DecodeBC123(const void *pInPixels, float *pOutPixels, uint32 width,
                     if (x >= width)
                         break;
 
-                    *(pDstPixel++) = (float)*(pBlockPtr++) * 255.0f;
-                    *(pDstPixel++) = (float)*(pBlockPtr++) * 255.0f;
-                    *(pDstPixel++) = (float)*(pBlockPtr++) * 255.0f;
-                    *(pDstPixel++) = (float)*(pBlockPtr++) * 255.0f;
+                    *(pDstPixel++) = (float)*(pBlockPtr++) / 255.0f;
+                    *(pDstPixel++) = (float)*(pBlockPtr++) / 255.0f;
+                    *(pDstPixel++) = (float)*(pBlockPtr++) / 255.0f;
+                    *(pDstPixel++) = (float)*(pBlockPtr++) / 255.0f;
                 }
 
                 DebugAssert(pNextBlockPtr >= pBlockPtr);
@@ -592,6 +604,243 @@ static void DecodeBC123(const void *pInPixels, float *pOutPixels, uint32 width,
 
 #endif      // HAVE_SQUISH
 
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// direct converters, these skip the float intermediate for the common pairs and convert a row at a time.
+// results match the decode/encode path, apart from out-of-range floats which are saturated instead of wrapped.
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// F16C is only used when the compiler targets it, there's no runtime dispatch in the engine
+#if Y_CPU_SSE_LEVEL >= 2 && (defined(__F16C__) || defined(__AVX2__))
+    #define PIXEL_FORMAT_CONVERTERS_F16C 1
+#endif
+
+// swizzle channel indices, values below zero fill the channel instead of reading it
+enum SWIZZLE_FILL
+{
+    SWIZZLE_ZERO = -1,
+    SWIZZLE_ONE = -2,
+};
+
+static inline byte SwizzleChannel(const byte *pPixel, int32 channel)
+{
+    return (channel >= 0) ? pPixel[channel] : ((channel == SWIZZLE_ONE) ? 255 : 0);
+}
+
+#if Y_CPU_SSE_LEVEL >= 4
+
+// builds the pshufb mask for four pixels, filled channels are zeroed by the shuffle then or'ed in from pFill
+static inline __m128i MakeSwizzleShuffleMask(uint32 sourceBytes, uint32 destinationBytes, const int32 *pChannels, __m128i *pFill)
+{
+    byte mask[16];
+    byte fill[16];
+    for (uint32 i = 0; i < 16; i++)
+    {
+        uint32 pixel = i / destinationBytes;
+        int32 channel = pChannels[i % destinationBytes];
+        if (pixel >= 4 || channel < 0)
+        {
+            mask[i] = 0x80;
+            fill[i] = (pixel < 4 && channel == SWIZZLE_ONE) ? 0xFF : 0x00;
+        }
+        else
+        {
+            mask[i] = (byte)(pixel * sourceBytes + (uint32)channel);
+            fill[i] = 0x00;
+        }
+    }
+
+    *pFill = _mm_loadu_si128(reinterpret_cast<const __m128i *>(fill));
+    return _mm_loadu_si128(reinterpret_cast<const __m128i *>(mask));
+}
+
+#endif
+
+// reorders 8-bit channels, each destination channel comes from source channel Cn or a fill value
+template<uint32 SOURCE_BYTES, uint32 DESTINATION_BYTES, int32 C0, int32 C1, int32 C2, int32 C3>
+static void SwizzleRow(const void *pInPixels, void *pOutPixels, uint32 Width)
+{
+    const byte *pInBytes = reinterpret_cast<const byte *>(pInPixels);
+    byte *pOutBytes = reinterpret_cast<byte *>(pOutPixels);
+    uint32 j = 0;
+
+#if Y_CPU_SSE_LEVEL >= 4
+    // four pixels per shuffle. the load is always 16 bytes, so with 3-byte sources stop while a whole load still fits.
+    if (SOURCE_BYTES >= 3 && DESTINATION_BYTES >= 3)
+    {
+        const int32 channels[4] = { C0, C1, C2, C3 };
+        __m128i fill;
+        __m128i shuffleMask = MakeSwizzleShuffleMask(SOURCE_BYTES, DESTINATION_BYTES, channels, &fill);
+        for (; j + (16 + SOURCE_BYTES - 1) / SOURCE_BYTES <= Width; j += 4)
+        {
+            __m128i pixels = _mm_loadu_si128(reinterpret_cast<const __m128i *>(pInBytes + j * SOURCE_BYTES));
+            pixels = _mm_or_si128(_mm_shuffle_epi8(pixels, shuffleMask), fill);
+            if (DESTINATION_BYTES == 4)
+            {
+                _mm_storeu_si128(reinterpret_cast<__m128i *>(pOutBytes + j * 4), pixels);
+            }
+            else
+            {
+                // 12 bytes, don't touch the pixel after the last one
+                int32 lastBytes = _mm_cvtsi128_si32(_mm_srli_si128(pixels, 8));
+                _mm_storel_epi64(reinterpret_cast<__m128i *>(pOutBytes + j * 3), pixels);
+                Y_memcpy(pOutBytes + j * 3 + 8, &lastBytes, sizeof(lastBytes));
+            }
+        }
+    }
+#elif Y_CPU_SSE_LEVEL >= 2
+    // without pshufb only the red/blue swap between 4-byte formats is worth doing, with shifts and masks
+    if (SOURCE_BYTES == 4 && DESTINATION_BYTES == 4 && C0 == 2 && C1 == 1 && C2 == 0)
+    {
+        const __m128i lowMask = _mm_set1_epi32(0x000000FF);
+        const __m128i highMask = _mm_set1_epi32(0x00FF0000);
+        const __m128i keepMask = _mm_set1_epi32((C3 == 3) ? (int32)0xFF00FF00 : 0x0000FF00);
+        const __m128i fill = _mm_set1_epi32((C3 == SWIZZLE_ONE) ? (int32)0xFF000000 : 0);
+        for (; j + 4 <= Width; j += 4)
+        {
+            __m128i pixels = _mm_loadu_si128(reinterpret_cast<const __m128i *>(pInBytes + j * 4));
+            __m128i low = _mm_and_si128(_mm_srli_epi32(pixels, 16), lowMask);
+            __m128i high = _mm_and_si128(_mm_slli_epi32(pixels, 16), highMask);
+            __m128i kept = _mm_or_si128(_mm_and_si128(pixels, keepMask), fill);
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(pOutBytes + j * 4), _mm_or_si128(_mm_or_si128(low, high), kept));
+        }
+    }
+#endif
+
+    for (; j < Width; j++)
+    {
+        const byte *pInPixel = pInBytes + j * SOURCE_BYTES;
+        byte *pOutPixel = pOutBytes + j * DESTINATION_BYTES;
+        pOutPixel[0] = SwizzleChannel(pInPixel, C0);
+        if (DESTINATION_BYTES > 1)
+            pOutPixel[1] = SwizzleChannel(pInPixel, C1);
+        if (DESTINATION_BYTES > 2)
+            pOutPixel[2] = SwizzleChannel(pInPixel, C2);
+        if (DESTINATION_BYTES > 3)
+            pOutPixel[3] = SwizzleChannel(pInPixel, C3);
+    }
+}
+
+static void ConvertRowR8G8B8A8ToR32G32B32A32F(const void *pInPixels, void *pOutPixels, uint32 Width)
+{
+    const byte *pInBytes = reinterpret_cast<const byte *>(pInPixels);
+    float *pOutValues = reinterpret_cast<float *>(pOutPixels);
+    uint32 count = Width * 4;
+    uint32 i = 0;
+
+#if Y_CPU_SSE_LEVEL >= 2
+    // divide rather than multiply by the reciprocal, so the results match DecodeR8G8B8A8 exactly
+    const __m128i zero = _mm_setzero_si128();
+    const __m128 scale = _mm_set1_ps(255.0f);
+    for (; i + 16 <= count; i += 16)
+    {
+        __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i *>(pInBytes + i));
+        __m128i words0 = _mm_unpacklo_epi8(bytes, zero);
+        __m128i words1 = _mm_unpackhi_epi8(bytes, zero);
+        _mm_storeu_ps(pOutValues + i + 0, _mm_div_ps(_mm_cvtepi32_ps(_mm_unpacklo_epi16(words0, zero)), scale));
+        _mm_storeu_ps(pOutValues + i + 4, _mm_div_ps(_mm_cvtepi32_ps(_mm_unpackhi_epi16(words0, zero)), scale));
+        _mm_storeu_ps(pOutValues + i + 8, _mm_div_ps(_mm_cvtepi32_ps(_mm_unpacklo_epi16(words1, zero)), scale));
+        _mm_storeu_ps(pOutValues + i + 12, _mm_div_ps(_mm_cvtepi32_ps(_mm_unpackhi_epi16(words1, zero)), scale));
+    }
+#endif
+
+    for (; i < count; i++)
+        pOutValues[i] = float(pInBytes[i]) / 255.0f;
+}
+
+static void ConvertRowR32G32B32A32FToR8G8B8A8(const void *pInPixels, void *pOutPixels, uint32 Width)
+{
+    const float *pInValues = reinterpret_cast<const float *>(pInPixels);
+    byte *pOutBytes = reinterpret_cast<byte *>(pOutPixels);
+    uint32 count = Width * 4;
+    uint32 i = 0;
+
+#if Y_CPU_SSE_LEVEL >= 2
+    // truncates like EncodeR8G8B8A8, the packs saturate
+    const __m128 scale = _mm_set1_ps(255.0f);
+    for (; i + 16 <= count; i += 16)
+    {
+        __m128i values0 = _mm_cvttps_epi32(_mm_mul_ps(_mm_loadu_ps(pInValues + i + 0), scale));
+        __m128i values1 = _mm_cvttps_epi32(_mm_mul_ps(_mm_loadu_ps(pInValues + i + 4), scale));
+        __m128i values2 = _mm_cvttps_epi32(_mm_mul_ps(_mm_loadu_ps(pInValues + i + 8), scale));
+        __m128i values3 = _mm_cvttps_epi32(_mm_mul_ps(_mm_loadu_ps(pInValues + i + 12), scale));
+        __m128i bytes = _mm_packus_epi16(_mm_packs_epi32(values0, values1), _mm_packs_epi32(values2, values3));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(pOutBytes + i), bytes);
+    }
+#endif
+
+    for (; i < count; i++)
+        pOutBytes[i] = (byte)(pInValues[i] * 255.0f);
+}
+
+template<uint32 COMPONENTS>
+static void ConvertRowFloatToHalf(const void *pInPixels, void *pOutPixels, uint32 Width)
+{
+    const float *pInValues = reinterpret_cast<const float *>(pInPixels);
+    uint16 *pOutValues = reinterpret_cast<uint16 *>(pOutPixels);
+    uint32 count = Width * COMPONENTS;
+    uint32 i = 0;
+
+#ifdef PIXEL_FORMAT_CONVERTERS_F16C
+    for (; i + 4 <= count; i += 4)
+        _mm_storel_epi64(reinterpret_cast<__m128i *>(pOutValues + i), _mm_cvtps_ph(_mm_loadu_ps(pInValues + i), 0));
+#endif
+
+    for (; i < count; i++)
+        pOutValues[i] = Math::FloatToHalf(pInValues[i]);
+}
+
+template<uint32 COMPONENTS>
+static void ConvertRowHalfToFloat(const void *pInPixels, void *pOutPixels, uint32 Width)
+{
+    const uint16 *pInValues = reinterpret_cast<const uint16 *>(pInPixels);
+    float *pOutValues = reinterpret_cast<float *>(pOutPixels);
+    uint32 count = Width * COMPONENTS;
+    uint32 i = 0;
+
+#ifdef PIXEL_FORMAT_CONVERTERS_F16C
+    for (; i + 4 <= count; i += 4)
+        _mm_storeu_ps(pOutValues + i, _mm_cvtph_ps(_mm_loadl_epi64(reinterpret_cast<const __m128i *>(pInValues + i))));
+#endif
+
+    for (; i < count; i++)
+        pOutValues[i] = Math::HalfToFloat(pInValues[i]);
+}
+
+struct PixelFormatDirectConverter
+{
+    typedef void(*ConvertRowFunctionType)(const void *pInPixels, void *pOutPixels, uint32 Width);
+
+    PIXEL_FORMAT SourceFormat;
+    PIXEL_FORMAT DestinationFormat;
+    ConvertRowFunctionType ConvertRowFunction;
+};
+
+static const PixelFormatDirectConverter g_PixelFormatDirectConverters[] =
+{
+    { PIXEL_FORMAT_R8G8B8A8_UNORM,      PIXEL_FORMAT_B8G8R8A8_UNORM,        SwizzleRow<4, 4, 2, 1, 0, 3>                                },
+    { PIXEL_FORMAT_B8G8R8A8_UNORM,      PIXEL_FORMAT_R8G8B8A8_UNORM,        SwizzleRow<4, 4, 2, 1, 0, 3>                                },
+    { PIXEL_FORMAT_R8G8B8A8_UNORM,      PIXEL_FORMAT_B8G8R8X8_UNORM,        SwizzleRow<4, 4, 2, 1, 0, SWIZZLE_ZERO>                     },
+    { PIXEL_FORMAT_B8G8R8X8_UNORM,      PIXEL_FORMAT_R8G8B8A8_UNORM,        SwizzleRow<4, 4, 2, 1, 0, SWIZZLE_ONE>                      },
+    { PIXEL_FORMAT_R8G8B8_UNORM,        PIXEL_FORMAT_R8G8B8A8_UNORM,        SwizzleRow<3, 4, 0, 1, 2, SWIZZLE_ONE>                      },
+    { PIXEL_FORMAT_R8G8B8A8_UNORM,      PIXEL_FORMAT_R8G8B8_UNORM,          SwizzleRow<4, 3, 0, 1, 2, SWIZZLE_ZERO>                     },
+    { PIXEL_FORMAT_B8G8R8_UNORM,        PIXEL_FORMAT_R8G8B8A8_UNORM,        SwizzleRow<3, 4, 2, 1, 0, SWIZZLE_ONE>                      },
+    { PIXEL_FORMAT_R8G8B8A8_UNORM,      PIXEL_FORMAT_B8G8R8_UNORM,          SwizzleRow<4, 3, 2, 1, 0, SWIZZLE_ZERO>                     },
+    { PIXEL_FORMAT_B8G8R8_UNORM,        PIXEL_FORMAT_R8G8B8_UNORM,          SwizzleRow<3, 3, 2, 1, 0, SWIZZLE_ZERO>                     },
+    { PIXEL_FORMAT_R8G8B8_UNORM,        PIXEL_FORMAT_B8G8R8_UNORM,          SwizzleRow<3, 3, 2, 1, 0, SWIZZLE_ZERO>                     },
+    { PIXEL_FORMAT_B8G8R8A8_UNORM,      PIXEL_FORMAT_R8G8B8_UNORM,          SwizzleRow<4, 3, 2, 1, 0, SWIZZLE_ZERO>                     },
+    { PIXEL_FORMAT_B8G8R8X8_UNORM,      PIXEL_FORMAT_R8G8B8_UNORM,          SwizzleRow<4, 3, 2, 1, 0, SWIZZLE_ZERO>                     },
+    { PIXEL_FORMAT_R8G8B8_UNORM,        PIXEL_FORMAT_B8G8R8A8_UNORM,        SwizzleRow<3, 4, 2, 1, 0, SWIZZLE_ONE>                      },
+    { PIXEL_FORMAT_R8G8B8_UNORM,        PIXEL_FORMAT_B8G8R8X8_UNORM,        SwizzleRow<3, 4, 2, 1, 0, SWIZZLE_ZERO>                     },
+    { PIXEL_FORMAT_R8_UNORM,            PIXEL_FORMAT_R8G8B8A8_UNORM,        SwizzleRow<1, 4, 0, SWIZZLE_ONE, SWIZZLE_ONE, SWIZZLE_ONE>  },
+    { PIXEL_FORMAT_R8G8B8A8_UNORM,      PIXEL_FORMAT_R8_UNORM,              SwizzleRow<4, 1, 0, SWIZZLE_ZERO, SWIZZLE_ZERO, SWIZZLE_ZERO> },
+    { PIXEL_FORMAT_R8G8B8A8_UNORM,      PIXEL_FORMAT_R32G32B32A32_FLOAT,    ConvertRowR8G8B8A8ToR32G32B32A32F                           },
+    { PIXEL_FORMAT_R32G32B32A32_FLOAT,  PIXEL_FORMAT_R8G8B8A8_UNORM,        ConvertRowR32G32B32A32FToR8G8B8A8                           },
+    { PIXEL_FORMAT_R32G32B32A32_FLOAT,  PIXEL_FORMAT_R16G16B16A16_FLOAT,    ConvertRowFloatToHalf<4>                                    },
+    { PIXEL_FORMAT_R16G16B16A16_FLOAT,  PIXEL_FORMAT_R32G32B32A32_FLOAT,    ConvertRowHalfToFloat<4>                                    },
+    { PIXEL_FORMAT_R32_FLOAT,           PIXEL_FORMAT_R16_FLOAT,             ConvertRowFloatToHalf<1>                                    },
+    { PIXEL_FORMAT_R16_FLOAT,           PIXEL_FORMAT_R32_FLOAT,             ConvertRowHalfToFloat<1>                                    },
+};
+
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 struct PixelFormatEncodeDecode
 {
@@ -611,26 +860,31 @@ static const PixelFormatEncodeDecode g_PixelFormatEncodeDecode[] =
     { PIXEL_FORMAT_B8G8R8X8_UNORM,          EncodeB8G8R8X8,         DecodeB8G8R8X8      },
     { PIXEL_FORMAT_B8G8R8_UNORM,            EncodeB8G8R8,           DecodeB8G8R8        },
     { PIXEL_FORMAT_R8_UNORM,                EncodeR8,               DecodeR8            },
+    { PIXEL_FORMAT_R8G8_UNORM,              EncodeR8G8,             DecodeR8G8          },
     { PIXEL_FORMAT_R32G32B32A32_FLOAT,      EncodeR32G32B32A32F,    DecodeR32G32B32A32F },
     { PIXEL_FORMAT_R16G16B16A16_FLOAT,      EncodeR16G16B16A16F,    DecodeR16G16B16A16F },
     { PIXEL_FORMAT_R32_FLOAT,               EncodeR32F,             DecodeR32F          },
     { PIXEL_FORMAT_R16_FLOAT,               EncodeR16F,             DecodeR16F          },
+    // block compressed destinations go to BlockCompression before this table is used
 #ifdef HAVE_SQUISH
-    { PIXEL_FORMAT_BC1_UNORM,               EncodeBC123,            DecodeBC123         },
-    { PIXEL_FORMAT_BC2_UNORM,               EncodeBC123,            DecodeBC123         },
-    { PIXEL_FORMAT_BC3_UNORM,               EncodeBC123,            DecodeBC123         },
+    { PIXEL_FORMAT_BC1_UNORM,               NULL,                   DecodeBC123         },
+    { PIXEL_FORMAT_BC2_UNORM,               NULL,                   DecodeBC123         },
+    { PIXEL_FORMAT_BC3_UNORM,               NULL,                   DecodeBC123         },
 #endif
+    { PIXEL_FORMAT_BC4_UNORM,               NULL,                   DecodeBC45          },
+    { PIXEL_FORMAT_BC5_UNORM,               NULL,                   DecodeBC45          },
 };
 
-bool PixelFormat_ConvertPixels(uint32 Width, uint32 Height, const void *SourcePixels, uint32 SourcePitch, PIXEL_FORMAT SourceFormat, void *DestinationPixels, uint32 DestinationPitch, PIXEL_FORMAT DestinationFormat, uint32 *DestinationPixelSize)
+// size of the float intermediate per strip when streaming through the decode/encode functions, sized to stay in L2
+static const uint32 STREAMING_STRIP_SIZE = 256 * 1024;
+
+bool PixelFormat_ConvertPixelsThroughFloat(uint32 Width, uint32 Height, const void *SourcePixels, uint32 SourcePitch, PIXEL_FORMAT SourceFormat, void *DestinationPixels, uint32 DestinationPitch, PIXEL_FORMAT DestinationFormat, uint32 *DestinationPixelSize)
 {
     uint32 i;
 
     DebugAssert(SourceFormat < PIXEL_FORMAT_COUNT && DestinationFormat < PIXEL_FORMAT_COUNT);
     DebugAssert(SourceFormat != DestinationFormat);
 
-    //Log_DevPrintf("PixelFormat_ConvertPixels: Converting %ux%u image from %s to %s...", Width, Height, PixelFormat_GetPixelFormatInfo(SourceFormat)->Name, PixelFormat_GetPixelFormatInfo(DestinationFormat)->Name);
-
     PixelFormatEncodeDecode::DecodeFunctionType DecodeFunction = NULL;
     PixelFormatEncodeDecode::EncodeFunctionType EncodeFunction = NULL;
 
@@ -661,19 +915,123 @@ bool PixelFormat_ConvertPixels(uint32 Width, uint32 Height, const void *SourcePi
         return false;
     }
 
-    // allocate memory for temp pixels (ouch)
-    //Log_DevPrintf("PixelFormat_ConvertPixels: Temporary array consumes %u bytes of memory...", sizeof(float) * Width * Height * 4);
-    float *pTempPixels = Y_mallocT<float>(Width * Height * 4);
+    // strips have to cover whole block rows when either side is block compressed, pitches are then per block row
+    const PIXEL_FORMAT_INFO *pSourceFormatInfo = PixelFormat_GetPixelFormatInfo(SourceFormat);
+    const PIXEL_FORMAT_INFO *pDestinationFormatInfo = PixelFormat_GetPixelFormatInfo(DestinationFormat);
+    uint32 SourceRowsPerPitch = (pSourceFormatInfo->IsBlockCompressed) ? pSourceFormatInfo->BlockSize : 1;
+    uint32 DestinationRowsPerPitch = (pDestinationFormatInfo->IsBlockCompressed) ? pDestinationFormatInfo->BlockSize : 1;
+    uint32 RowAlignment = Max(SourceRowsPerPitch, DestinationRowsPerPitch);
+    uint32 StripRows = Max((uint32)1, STREAMING_STRIP_SIZE / (Width * (uint32)sizeof(float) * 4));
+    StripRows = Max(RowAlignment, StripRows - (StripRows % RowAlignment));
+
+    // the last strip can pick up a partial block row, and the block decoders write whole blocks
+    float *pTempPixels = Y_mallocT<float>(Width * (StripRows + RowAlignment - 1) * 4);
+    Y_memzero(pTempPixels, sizeof(float) * Width * (StripRows + RowAlignment - 1) * 4);
+
+    const byte *pSourceStrip = reinterpret_cast<const byte *>(SourcePixels);
+    byte *pDestinationStrip = reinterpret_cast<byte *>(DestinationPixels);
+    for (uint32 StartRow = 0; StartRow < Height; )
+    {
+        // a remainder smaller than a block row is folded into this strip
+        uint32 RowCount = Min(StripRows, Height - StartRow);
+        if ((Height - StartRow - RowCount) < RowAlignment)
+            RowCount = Height - StartRow;
 
-    // decode pixels to 32f
-    DecodeFunction(SourcePixels, pTempPixels, Width, Height, SourcePitch, SourceFormat);
+        DecodeFunction(pSourceStrip, pTempPixels, Width, RowCount, SourcePitch, SourceFormat);
+        EncodeFunction(pTempPixels, pDestinationStrip, Width, RowCount, DestinationPitch, DestinationFormat);
 
-    // now encode them to the dest format
-    EncodeFunction(pTempPixels, DestinationPixels, Width, Height, DestinationPitch, DestinationFormat);
+        pSourceStrip += SourcePitch * (RowCount / SourceRowsPerPitch);
+        pDestinationStrip += DestinationPitch * (RowCount / DestinationRowsPerPitch);
+        StartRow += RowCount;
+    }
 
-    // log/free/return
     Y_free(pTempPixels);
     *DestinationPixelSize = CalculatedDestinationPixelSize;
     return true;
 }
 
+// block compressed destinations are encoded from R8G8B8A8 in one go, so the encoder can spread the whole image across threads
+static bool ConvertPixelsToBlockCompressed(uint32 Width, uint32 Height, const void *SourcePixels, uint32 SourcePitch, PIXEL_FORMAT SourceFormat, void *DestinationPixels, uint32 DestinationPitch, PIXEL_FORMAT DestinationFormat)
+{
+    const void *pRGBAPixels = SourcePixels;
+    uint32 RGBAPitch = SourcePitch;
+    byte *pTempPixels = NULL;
+    if (SourceFormat != PIXEL_FORMAT_R8G8B8A8_UNORM)
+    {
+        RGBAPitch = Width * 4;
+        uint32 TempPixelsSize = RGBAPitch * Height;
+        pTempPixels = Y_mallocT<byte>(TempPixelsSize);
+        if (!PixelFormat_ConvertPixels(Width, Height, SourcePixels, SourcePitch, SourceFormat, pTempPixels, RGBAPitch, PIXEL_FORMAT_R8G8B8A8_UNORM, &TempPixelsSize))
+        {
+            Y_free(pTempPixels);
+            return false;
+        }
+
+        pRGBAPixels = pTempPixels;
+    }
+
+    BlockCompression::EncodeJob job;
+    job.pSourcePixels = pRGBAPixels;
+    job.SourcePitch = RGBAPitch;
+    job.Width = Width;
+    job.Height = Height;
+    job.pDestinationBlocks = DestinationPixels;
+    job.DestinationPitch = DestinationPitch;
+    bool result = BlockCompression::EncodeImages(DestinationFormat, BLOCK_COMPRESSION_QUALITY_NORMAL, &job, 1);
+
+    if (pTempPixels != NULL)
+        Y_free(pTempPixels);
+
+    return result;
+}
+
+bool PixelFormat_ConvertPixels(uint32 Width, uint32 Height, const void *SourcePixels, uint32 SourcePitch, PIXEL_FORMAT SourceFormat, void *DestinationPixels, uint32 DestinationPitch, PIXEL_FORMAT DestinationFormat, uint32 *DestinationPixelSize)
+{
+    uint32 i;
+
+    DebugAssert(SourceFormat < PIXEL_FORMAT_COUNT && DestinationFormat < PIXEL_FORMAT_COUNT);
+    DebugAssert(SourceFormat != DestinationFormat);
+
+    //Log_DevPrintf("PixelFormat_ConvertPixels: Converting %ux%u image from %s to %s...", Width, Height, PixelFormat_GetPixelFormatInfo(SourceFormat)->Name, PixelFormat_GetPixelFormatInfo(DestinationFormat)->Name);
+
+    uint32 CalculatedDestinationPixelSize = PixelFormat_CalculateImageSize(DestinationFormat, Width, Height, 1);
+    if (*DestinationPixelSize < CalculatedDestinationPixelSize)
+    {
+        Log_ErrorPrintf("PixelFormat_ConvertPixels: DestinationPixelSize too small (%u), %u required.", *DestinationPixelSize, CalculatedDestinationPixelSize);
+        return false;
+    }
+
+    // direct converter?
+    for (i = 0; i < countof(g_PixelFormatDirectConverters); i++)
+    {
+        const PixelFormatDirectConverter *pConverter = &g_PixelFormatDirectConverters[i];
+        if (pConverter->SourceFormat != SourceFormat || pConverter->DestinationFormat != DestinationFormat)
+            continue;
+
+        const byte *pSourceRow = reinterpret_cast<const byte *>(SourcePixels);
+        byte *pDestinationRow = reinterpret_cast<byte *>(DestinationPixels);
+        for (uint32 y = 0; y < Height; y++)
+        {
+            pConverter->ConvertRowFunction(pSourceRow, pDestinationRow, Width);
+            pSourceRow += SourcePitch;
+            pDestinationRow += DestinationPitch;
+        }
+
+        *DestinationPixelSize = CalculatedDestinationPixelSize;
+        return true;
+    }
+
+    // block compressed destination?
+    if (BlockCompression::IsSupportedFormat(DestinationFormat))
+    {
+        if (!ConvertPixelsToBlockCompressed(Width, Height, SourcePixels, SourcePitch, SourceFormat, DestinationPixels, DestinationPitch, DestinationFormat))
+            return false;
+
+        *DestinationPixelSize = CalculatedDestinationPixelSize;
+        return true;
+    }
+
+    // fall back to streaming through floats
+    return PixelFormat_ConvertPixelsThroughFloat(Width, Height, SourcePixels, SourcePitch, SourceFormat, DestinationPixels, DestinationPitch, DestinationFormat, DestinationPixelSize);
+}
+
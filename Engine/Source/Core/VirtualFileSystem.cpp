@@ -1,6 +1,8 @@
 #include "Core/PrecompiledHeader.h"
 #include "Core/VirtualFileSystem.h"
 #include "Core/Console.h"
+#include "Core/PackFileArchive.h"
+#include "Core/MappedFile.h"
 #include "YBaseLib/Platform.h"
 #include "YBaseLib/Log.h"
 
@@ -15,6 +17,24 @@ namespace CVars {
     CVar vfs_gamedir("vfs_gamedir", CVAR_FLAG_NO_ARCHIVE | CVAR_FLAG_REQUIRE_APP_RESTART, "BlockGame", "virtual file system game directory name", "string");
     CVar vfs_mount_gamedata_rw("vfs_mount_gamedata_rw", CVAR_FLAG_NO_ARCHIVE | CVAR_FLAG_REQUIRE_APP_RESTART, "false", "mount the game data directory read-write (default read-only, only will work with developer directory structure)", "string");
     CVar vfs_gitlayout("vfs_gitlayout", CVAR_FLAG_NO_ARCHIVE | CVAR_FLAG_REQUIRE_APP_RESTART, "false", "use repository-style directory structure", "bool");
+    CVar vfs_mount_pack_files("vfs_mount_pack_files", CVAR_FLAG_NO_ARCHIVE | CVAR_FLAG_REQUIRE_APP_RESTART, "true", "mount pack files found in the data directories, behind loose files", "bool");
+}
+
+MappedFile *VirtualFileSystemArchive::MapFile(const char *FileName)
+{
+    // archives without a better option read the file into memory, and hand out a view of that
+    ByteStream *pStream = OpenFile(FileName, BYTESTREAM_OPEN_READ | BYTESTREAM_OPEN_STREAMED);
+    if (pStream == nullptr)
+        return nullptr;
+
+    BinaryBlob *pBlob = BinaryBlob::CreateFromStream(pStream);
+    pStream->Release();
+    if (pBlob == nullptr)
+        return nullptr;
+
+    MappedFile *pMappedFile = MappedFile::CreateView(pBlob, pBlob->GetDataPointer(), pBlob->GetDataSize());
+    pBlob->Release();
+    return pMappedFile;
 }
 
 class LocalVirtualFileSystemArchive : public VirtualFileSystemArchive
@@ -166,6 +186,19 @@ public:
         return FileSystem::OpenFile(fullPath, Flags);
     }
 
+    MappedFile *MapFile(const char *FileName)
+    {
+        PathString fullPath;
+        BuildFullPath(fullPath, FileName);
+        FileSystem::BuildOSPath(fullPath);
+
+        FILESYSTEM_STAT_DATA statData;
+        if (!FileSystem::StatFile(fullPath, &statData) || statData.Attributes & FILESYSTEM_FILE_ATTRIBUTE_DIRECTORY)
+            return nullptr;
+
+        return MappedFile::Open(fullPath);
+    }
+
     bool DeleteFile(const char *FileName)
     {
         if (m_bReadOnly)
@@ -314,6 +347,7 @@ bool VirtualFileSystem::Initialize()
     String userPath = CVars::vfs_userpath.GetString();
     String gameDirectory = CVars::vfs_gamedir.GetString();
     bool mountDataDirectoriesReadWrite = CVars::vfs_mount_gamedata_rw.GetBool();
+    bool mountPackFiles = CVars::vfs_mount_pack_files.GetBool();
     bool shippingDirectoryStructure = true;
 
     // log start
@@ -381,11 +415,15 @@ bool VirtualFileSystem::Initialize()
             currentSearchPath.Format("%s/Engine/Data", basePath.GetCharArray());
             FileSystem::BuildOSPath(currentSearchPath);
             AddDirectory(currentSearchPath, 30, !mountDataDirectoriesReadWrite, false);
+            if (mountPackFiles)
+                AddPackFiles(currentSearchPath, 31);
 
             // mount game data
             currentSearchPath.Format("%s/%s/Data", basePath.GetCharArray(), gameDirectory.GetCharArray());
             FileSystem::BuildOSPath(currentSearchPath);
             AddDirectory(currentSearchPath, 20, !mountDataDirectoriesReadWrite, false);
+            if (mountPackFiles)
+                AddPackFiles(currentSearchPath, 21);
         }
         else
         {
@@ -409,6 +447,8 @@ bool VirtualFileSystem::Initialize()
             Log_ErrorPrintf("VirtualFileSystem: Could not mount engine data directory (detected as '%s')", currentSearchPath.GetCharArray());
             return false;
         }
+        if (mountPackFiles)
+            AddPackFiles(currentSearchPath, 31);
 
         // game data directory should be at <base data path>/<game name>
         currentSearchPath.Format("%s/Data/%s", basePath.GetCharArray(), gameDirectory.GetCharArray());
@@ -418,6 +458,8 @@ bool VirtualFileSystem::Initialize()
             Log_ErrorPrintf("VirtualFileSystem: Could not mount game data directory (detected as '%s')", currentSearchPath.GetCharArray());
             return false;
         }
+        if (mountPackFiles)
+            AddPackFiles(currentSearchPath, 21);
     }
 
     // mount user data
@@ -587,6 +629,18 @@ ByteStream *VirtualFileSystem::OpenFile(const char *FileName, uint32 Flags)
     return NULL;
 }
 
+MappedFile *VirtualFileSystem::MapFile(const char *FileName)
+{
+    MappedFile *pMappedFile;
+    for (ArchiveList::Iterator itr = m_liArchives.Begin(); !itr.AtEnd(); itr.Forward())
+    {
+        if ((pMappedFile = itr->pArchiveInterface->MapFile(FileName)) != nullptr)
+            return pMappedFile;
+    }
+
+    return nullptr;
+}
+
 bool VirtualFileSystem::DeleteFile(const char *FileName)
 {
     for (ArchiveList::Iterator itr = m_liArchives.Begin(); !itr.AtEnd(); itr.Forward())
@@ -694,6 +748,35 @@ bool VirtualFileSystem::AddDirectory(const char *Path, int32 Priority, bool Read
     return true;
 }
 
+uint32 VirtualFileSystem::AddPackFiles(const char *Path, int32 Priority)
+{
+    FileSystem::FindResultsArray findResults;
+    if (!FileSystem::FindFiles(Path, "*.pak", FILESYSTEM_FIND_FILES | FILESYSTEM_FIND_RELATIVE_PATHS, &findResults))
+        return 0;
+
+    // packs at the same priority are ordered by file name
+    uint32 mountedCount = 0;
+    for (uint32 i = 0; i < findResults.GetSize(); i++)
+    {
+        PathString packFileName;
+        packFileName.Format("%s/%s", Path, findResults[i].FileName);
+        FileSystem::BuildOSPath(packFileName);
+
+        PackFileArchive *pArchive = PackFileArchive::Open(packFileName);
+        if (pArchive == nullptr)
+        {
+            Log_WarningPrintf("VirtualFileSystem: Failed to open pack file '%s'", packFileName.GetCharArray());
+            continue;
+        }
+
+        AddArchive(pArchive, String(findResults[i].FileName), Priority);
+        Log_InfoPrintf("Mounted pack file '%s' into VFS, at priority %d, with %u files.", packFileName.GetCharArray(), Priority, pArchive->GetEntryCount());
+        mountedCount++;
+    }
+
+    return mountedCount;
+}
+
 void VirtualFileSystem::AddArchive(VirtualFileSystemArchive *pArchiveInterface, const String &SortKey, int32 Priority)
 {
     VirtualFileSystemArchiveEntry archiveEntry;
@@ -5,6 +5,8 @@
 #include "YBaseLib/BinaryBlob.h"
 #include "YBaseLib/LinkedList.h"
 
+class MappedFile;
+
 class VirtualFileSystemArchive
 {
 public:
@@ -14,6 +16,7 @@ public:
     virtual bool StatFile(const char *Path, FILESYSTEM_STAT_DATA *pStatData) = 0;
     virtual bool GetFileName(String &Destination, const char *FileName) = 0;
     virtual ByteStream *OpenFile(const char *FileName, uint32 Flags) = 0;
+    virtual MappedFile *MapFile(const char *FileName);
     virtual bool DeleteFile(const char *FileName) = 0;
     virtual bool DeleteDirectory(const char *FileName, bool recursive) = 0;
     virtual FileSystem::ChangeNotifier *CreateChangeNotifier(const String &directoryPath) = 0;
@@ -48,6 +51,9 @@ public:
     // open files
     ByteStream *OpenFile(const char *FileName, uint32 Flags);
 
+    // map a file read-only, the contents can be referenced directly for as long as the mapping is held
+    MappedFile *MapFile(const char *FileName);
+
     // delete files
     bool DeleteFile(const char *FileName);
 
@@ -65,7 +71,7 @@ public:
 
 private:
     // searches the path for any pack files, and mounts them at the specified priority
-    //void AddPackFiles(const char *Path, int32 Priority);
+    uint32 AddPackFiles(const char *Path, int32 Priority);
 
     // mounts a local file system at this path
     bool AddDirectory(const char *Path, int32 Priority, bool ReadOnly, bool AddNonexistantDirectories);
@@ -177,8 +177,8 @@ bool BlockMesh::Load(const char *resourceName, ByteStream *pStream)
         return false;
     }
 
-    // create on gpu
-    if (!CreateGPUResources())
+    // create on gpu, unless it is being loaded asynchronously
+    if (!ResourceManager::IsDeviceResourceCreationDeferred() && !CreateGPUResources())
     {
         Log_ErrorPrintf("GPU upload failed.");
         return false;
@@ -5,6 +5,7 @@
 #include "Engine/DataFormats.h"
 #include "Renderer/Renderer.h"
 #include "Core/ChunkFileReader.h"
+#include "Core/MappedFile.h"
 Log_SetChannel(BlockPalette);
 
 BlockPalette::BlockPalette()
@@ -61,6 +62,19 @@ BlockPalette::~BlockPalette()
 }
 
 bool BlockPalette::Load(const char *FileName, ByteStream *pStream)
+{
+    return InternalLoad(FileName, pStream, nullptr);
+}
+
+bool BlockPalette::LoadFromMapping(const char *FileName, MappedFile *pMappedFile)
+{
+    ByteStream *pStream = ByteStream_CreateReadOnlyMemoryStream(pMappedFile->GetData(), (uint32)pMappedFile->GetSize());
+    bool result = InternalLoad(FileName, pStream, pMappedFile);
+    pStream->Release();
+    return result;
+}
+
+bool BlockPalette::InternalLoad(const char *FileName, ByteStream *pStream, MappedFile *pMappedFile)
 {
     PathString tempString;  
 
@@ -83,7 +97,7 @@ bool BlockPalette::Load(const char *FileName, ByteStream *pStream)
 
     // init chunkloader
     ChunkFileReader chunkReader;
-    if (!chunkReader.Initialize(pStream))
+    if (!((pMappedFile != nullptr) ? chunkReader.InitializeFromMappedFile(pMappedFile, pStream->GetPosition()) : chunkReader.Initialize(pStream)))
         return false;
 
     // load block types
@@ -459,7 +473,7 @@ bool BlockPalette::Load(const char *FileName, ByteStream *pStream)
 #undef ABORTREASON
 
     // create on gpu
-    if (g_pRenderer != nullptr && !CreateGPUResources())
+    if (g_pRenderer != nullptr && !ResourceManager::IsDeviceResourceCreationDeferred() && !CreateGPUResources())
     {
         Log_ErrorPrintf("GPU upload failed.");
         return false;
@@ -140,6 +140,9 @@ public:
     // serialization
     bool Load(const char *FileName, ByteStream *pStream);
 
+    // loads from a mapped file, chunks are read in place rather than copied
+    bool LoadFromMapping(const char *FileName, MappedFile *pMappedFile);
+
     // accessors
     const BlockPalette::BlockType *GetBlockType(uint32 i) const { DebugAssert(i < BLOCK_MESH_MAX_BLOCK_TYPES); return &m_BlockTypes[i]; }
     const Texture *GetTexture(uint32 i) const { DebugAssert(i < m_textures.GetSize()); return m_textures[i]; }
@@ -157,6 +160,8 @@ public:
     void ReleaseGPUResources() const;
 
 private:
+    bool InternalLoad(const char *FileName, ByteStream *pStream, MappedFile *pMappedFile);
+
     BlockPalette::BlockType m_BlockTypes[BLOCK_MESH_MAX_BLOCK_TYPES];
     PODArray<const Texture *> m_textures;
     PODArray<const Material *> m_materials;
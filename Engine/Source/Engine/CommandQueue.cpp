@@ -1,14 +1,27 @@
 #include "Engine/PrecompiledHeader.h"
 #include "Engine/CommandQueue.h"
+#include "Engine/Profiling.h"
 
 CommandQueue::CommandQueue()
     : m_creatorThreadID(0),
       m_workerThreadExitFlag(true),
+      m_workersPaused(false),
+      m_sleepingWorkerThreads(0),
+      m_pThreadPool(nullptr),
       m_activeThreadPoolTasks(0),
       m_threadPoolYieldToOtherJobs(false),
-      m_activeWorkerThreads(0),
+      m_pSlotMemory(nullptr),
+      m_slotMask(0),
+      m_enqueuePosition(0),
+      m_dequeuePosition(0),
+      m_pendingCommands(0),
       m_commandQueueSize(0),
-      m_barrier(2)
+      m_peakQueueDepth(0),
+      m_commandsQueued(0),
+      m_commandsExecuted(0),
+      m_heapAllocatedCommands(0),
+      m_stallCount(0),
+      m_stallTimeMicroseconds(0)
 {
 
 }
@@ -18,17 +31,9 @@ CommandQueue::~CommandQueue()
     // cleanup thread pool tasks
     if (m_pThreadPool != nullptr)
     {
-        for (;;)
-        {
-            m_queueLock.Lock();
-            if (m_activeThreadPoolTasks == 0)
-                break;
-
-            // loop until empty
-            m_queueLock.Unlock();
+        // loop until the tasks have finished
+        while (m_activeThreadPoolTasks.load() > 0)
             Thread::Yield();
-            continue;
-        }
 
         // tasks are now done, so kill off the references
         while (m_threadPoolTasks.GetSize() > 0)
@@ -36,9 +41,6 @@ CommandQueue::~CommandQueue()
             ThreadPoolTask *pTask = m_threadPoolTasks.PopBack();
             pTask->Release();
         }
-
-        // release lock
-        m_queueLock.Unlock();
     }
 
     // cleanup queue and end threads
@@ -46,6 +48,8 @@ CommandQueue::~CommandQueue()
 
     // the queue should be empty at this point
     DebugAssert(FifoIsEmpty());
+    if (m_pSlotMemory != nullptr)
+        Y_aligned_free(m_pSlotMemory);
 }
 
 bool CommandQueue::Initialize(uint32 commandQueueSize /* = DEFAULT_COMMAND_QUEUE_SIZE */, uint32 workerThreadCount /* = 1 */)
@@ -108,7 +112,22 @@ void CommandQueue::AllocateQueue(uint32 size)
     m_commandQueueSize = size;
     if (size > 0)
     {
-        // todo: allocate fifo
+        // slot count has to be a power of two so positions can be masked
+        uint32 slotCount = 2;
+        while ((slotCount * 2 * COMMAND_SLOT_SIZE) <= size)
+            slotCount *= 2;
+
+        // each slot starts out free for the first lap
+        m_pSlotMemory = (byte *)Y_aligned_malloc(slotCount * COMMAND_SLOT_SIZE, 64);
+        m_slotMask = slotCount - 1;
+        for (uint32 i = 0; i < slotCount; i++)
+        {
+            FifoSlot *pSlot = GetSlot(i);
+            new (&pSlot->Sequence) std::atomic<size_t>(i);
+            pSlot->pCommand = nullptr;
+            pSlot->pCompletionFlag = nullptr;
+            pSlot->HeapAllocated = false;
+        }
     }
 }
 
@@ -121,13 +140,16 @@ void CommandQueue::ExitWorkers()
         return;
     }
 
-    // pause the workers, draining the queue
-    PauseWorkers();
+    // wait for the workers to drain the queue
+    while (m_pendingCommands.load() > 0)
+        Thread::Yield();
 
     // set the worker exit flag, and wake all workers
+    m_workerLock.Lock();
     m_workerThreadExitFlag = true;
+    m_workersPaused = false;
     m_conditionVariable.WakeAll();
-    ResumeWorkers();
+    m_workerLock.Unlock();
 
     // join each thread
     while (m_workerThreads.GetSize() > 0)
@@ -146,29 +168,15 @@ void CommandQueue::PauseWorkers()
         return;
     }
 
-    // drain the queue, then pause the thread by holding the lock
-    for (;;)
-    {
-        m_queueLock.Lock();
+    // drain the queue
+    while (m_pendingCommands.load() > 0)
+        Thread::Yield();
 
-        // queue has entries? wait for the worker to sleep
-        if (!FifoIsEmpty() || m_activeWorkerThreads > 0)
-        {
-            if (m_activeWorkerThreads == 0)
-            {
-                m_conditionVariable.Wake();
-                //Log::GetInstance().Write("w", LOGLEVEL_DEV, "Woke CV");
-            }
-            m_queueLock.Unlock();
-            Thread::Yield();
-            continue;
-        }
-        else
-        {
-            // leave the queue locked
-            break;
-        }
-    }
+    // stop workers claiming new commands, and wait for them to all go to sleep
+    m_workersPaused = true;
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    while (m_sleepingWorkerThreads.load() < m_workerThreads.GetSize())
+        Thread::Yield();
 }
 
 void CommandQueue::ResumeWorkers()
@@ -176,8 +184,11 @@ void CommandQueue::ResumeWorkers()
     if (m_workerThreads.IsEmpty())
         return;
 
-    // unlock queue, any workers that were woken should be allowed to continue
-    m_queueLock.Unlock();
+    // any commands queued while paused will be picked up once woken
+    m_workerLock.Lock();
+    m_workersPaused = false;
+    m_conditionVariable.WakeAll();
+    m_workerLock.Unlock();
 }
 
 void CommandQueue::QueueCommand(CommandBase *pCommand, uint32 commandSize)
@@ -188,79 +199,95 @@ void CommandQueue::QueueCommand(CommandBase *pCommand, uint32 commandSize)
         return;
     }
 
-    LockQueueForNewCommand();
-
-    void *command = FifoAllocateCommand(commandSize, false);
-    Y_memcpy(command, pCommand, commandSize);
-
-    UnlockQueueForNewCommand();
+    FifoSlot *pSlot = FifoAllocateCommand(commandSize, nullptr);
+    Y_memcpy(pSlot->pCommand, pCommand, commandSize);
+    FifoPublishCommand(pSlot);
 }
 
 void CommandQueue::QueueBlockingCommand(CommandBase *pCommand, uint32 commandSize)
 {
-    if (m_commandQueueSize == 0 || m_workerThreads.IsEmpty())
+    if (m_commandQueueSize == 0 || (m_workerThreads.IsEmpty() && m_pThreadPool == nullptr))
     {
         pCommand->Execute();
         return;
     }
 
-    // currently blocking events are only supported coming from the main thread
-    DebugAssert(Thread::GetCurrentThreadId() == m_creatorThreadID);
-
-    // lock before write
-    LockQueueForNewCommand();
-
     // write
-    void *command = FifoAllocateCommand(commandSize, true);
-    Y_memcpy(command, pCommand, commandSize);
-
-    // unlock
-    UnlockQueueForNewCommand();
+    std::atomic<bool> completed(false);
+    FifoSlot *pSlot = FifoAllocateCommand(commandSize, &completed);
+    Y_memcpy(pSlot->pCommand, pCommand, commandSize);
+    FifoPublishCommand(pSlot);
 
     // block
-    m_barrier.Wait();
+    WaitForCompletion(&completed);
 }
 
 bool CommandQueue::ExecuteQueuedCommands()
 {
-    bool result = false;
-    m_queueLock.Lock();
+    if (m_commandQueueSize == 0)
+        return false;
 
-    // loop
+    // only wait for commands running elsewhere if there is anywhere else for them to run. claiming in batches is
+    // only safe when nothing else is consuming.
+    bool hasOtherConsumers = (!m_workerThreads.IsEmpty() || m_pThreadPool != nullptr);
+    uint32 batchSize = (hasOtherConsumers) ? 1 : DRAIN_BATCH_SIZE;
+    bool result = false;
     for (;;)
     {
-        FifoQueueEntryHeader *commandHdr = FifoGetNextCommand();
-        if (commandHdr == nullptr)
+        if (ExecuteCommands(batchSize))
         {
-            // if there's still outstanding commands, yield and search again
-            if (m_activeWorkerThreads > 0 || m_activeThreadPoolTasks > 0)
-            {
-                m_queueLock.Unlock();
-                Thread::Yield();
-                m_queueLock.Lock();
-                continue;
-            }
+            result = true;
+            continue;
+        }
 
-            // all commands done
-            break;
+        // if there's still outstanding commands, yield and search again
+        if (hasOtherConsumers && m_pendingCommands.load() > 0)
+        {
+            Thread::Yield();
+            continue;
         }
 
-        // unlock queue while the command runs
-        m_queueLock.Unlock();
+        // all commands done
+        break;
+    }
 
-        // run command
-        commandHdr->pCommand->Execute();
+    return result;
+}
 
-        // re-lock queue
-        m_queueLock.Lock();
+void CommandQueue::GetStatistics(Statistics *pStatistics) const
+{
+    pStatistics->QueueDepth = m_pendingCommands.load(std::memory_order_relaxed);
+    pStatistics->PeakQueueDepth = m_peakQueueDepth.load(std::memory_order_relaxed);
+    pStatistics->CommandsQueued = m_commandsQueued.load(std::memory_order_relaxed);
+    pStatistics->CommandsExecuted = m_commandsExecuted.load(std::memory_order_relaxed);
+    pStatistics->HeapAllocatedCommands = m_heapAllocatedCommands.load(std::memory_order_relaxed);
+    pStatistics->StallCount = m_stallCount.load(std::memory_order_relaxed);
+    pStatistics->StallTime = (double)m_stallTimeMicroseconds.load(std::memory_order_relaxed) / 1000000.0;
+}
 
-        // pop the command off the queue
-        FifoReleaseCommand(commandHdr);
-        result = true;
-    }
+void CommandQueue::ResetStatistics()
+{
+    m_peakQueueDepth.store(0, std::memory_order_relaxed);
+    m_commandsQueued.store(0, std::memory_order_relaxed);
+    m_commandsExecuted.store(0, std::memory_order_relaxed);
+    m_heapAllocatedCommands.store(0, std::memory_order_relaxed);
+    m_stallCount.store(0, std::memory_order_relaxed);
+    m_stallTimeMicroseconds.store(0, std::memory_order_relaxed);
+}
 
-    m_queueLock.Unlock();
-    return result;
+void CommandQueue::UpdateProfilerCounters(const char *name) const
+{
+#ifdef WITH_PROFILER
+    SmallString counterName;
+    counterName.Format("commandqueue/%s/depth", name);
+    MicroProfileCounterSet(MicroProfileGetCounterToken(counterName), (int64_t)m_pendingCommands.load(std::memory_order_relaxed));
+    counterName.Format("commandqueue/%s/peak_depth", name);
+    MicroProfileCounterSet(MicroProfileGetCounterToken(counterName), (int64_t)m_peakQueueDepth.load(std::memory_order_relaxed));
+    counterName.Format("commandqueue/%s/executed", name);
+    MicroProfileCounterSet(MicroProfileGetCounterToken(counterName), (int64_t)m_commandsExecuted.load(std::memory_order_relaxed));
+    counterName.Format("commandqueue/%s/stall_us", name);
+    MicroProfileCounterSet(MicroProfileGetCounterToken(counterName), (int64_t)m_stallTimeMicroseconds.load(std::memory_order_relaxed));
+#endif
 }
 
 CommandQueue::WorkerThread::WorkerThread(CommandQueue *pParent)
@@ -274,54 +301,34 @@ int CommandQueue::WorkerThread::ThreadEntryPoint()
     // initialize thread name
     Thread::SetDebugName(String::FromFormat("Command Queue %p Worker", m_this));
 
-    // start with it locked
-    m_this->m_queueLock.Lock();
-    m_this->m_activeWorkerThreads++;
-    MemoryBarrier();
-
     // loop
     for (;;)
     {
-        // get the next command
-        FifoQueueEntryHeader *commandHdr = m_this->FifoGetNextCommand();
-        if (commandHdr == nullptr)
-        {
-            // no next command, are we exiting?
-            if (m_this->m_workerThreadExitFlag)
-                break;
-
-            // this thread is now inactive
-            m_this->m_activeWorkerThreads--;
-            MemoryBarrier();
-
-            // wait until there is a new event
-            m_this->m_conditionVariable.SleepAndRelease(&m_this->m_queueLock);
-
-            // this thread is now active
-            m_this->m_activeWorkerThreads++;
-            MemoryBarrier();
+        // run commands until there are none left
+        if (!m_this->m_workersPaused && m_this->ExecuteCommands(1))
             continue;
-        }
 
-        // release queue lock
-        m_this->m_queueLock.Unlock();
+        // go to sleep, the producer checks the sleeping count after publishing, so re-check the queue after incrementing it
+        m_this->m_workerLock.Lock();
+        m_this->m_sleepingWorkerThreads.fetch_add(1);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
 
-        // run the command
-        commandHdr->pCommand->Execute();
-        if (commandHdr->BlockingEvent)
-            m_this->m_barrier.Wait();
+        // no next command, are we exiting?
+        if (m_this->m_workerThreadExitFlag && m_this->FifoIsEmpty())
+        {
+            m_this->m_sleepingWorkerThreads.fetch_sub(1);
+            m_this->m_workerLock.Unlock();
+            break;
+        }
 
-        // hold lock again
-        m_this->m_queueLock.Lock();
+        // wait until there is a new command
+        if (m_this->m_workersPaused || m_this->FifoIsEmpty())
+            m_this->m_conditionVariable.SleepAndRelease(&m_this->m_workerLock);
 
-        // destruct the command
-        m_this->FifoReleaseCommand(commandHdr);
+        m_this->m_sleepingWorkerThreads.fetch_sub(1);
+        m_this->m_workerLock.Unlock();
     }
 
-    m_this->m_activeWorkerThreads--;
-    MemoryBarrier();
-
-    m_this->m_queueLock.Unlock();
     return 0;
 }
 
@@ -335,115 +342,243 @@ CommandQueue::ThreadPoolTask::ThreadPoolTask(CommandQueue *pParent)
 
 int32 CommandQueue::ThreadPoolTask::ProcessWork()
 {
-    m_this->m_queueLock.Lock();
-
-    // loop until there are no tasks left
+    bool yielded = false;
     for (;;)
     {
-        // get the next command
-        FifoQueueEntryHeader *commandHdr = m_this->FifoGetNextCommand();
-        if (commandHdr == nullptr)
+        // loop until there are no tasks left
+        while (m_this->ExecuteCommands(1))
+        {
+            // check if we should yield
+            if (m_this->m_threadPoolYieldToOtherJobs && m_this->m_pThreadPool->ShouldYieldToOtherTask())
+            {
+                yielded = true;
+                break;
+            }
+        }
+
+        // a producer may have seen this task active just before it went inactive, so check for anything left behind
+        SetInactive();
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (yielded || m_this->FifoIsEmpty())
             break;
 
-        // release queue lock
-        m_this->m_queueLock.Unlock();
+        // if a producer has already re-activated us, the pool will run us again
+        if (!TryActivate())
+            break;
+    }
 
-        // run the command
-        commandHdr->pCommand->Execute();
-        if (commandHdr->BlockingEvent)
-            m_this->m_barrier.Wait();
+    // when yielding, put a task at the back of the pool's queue rather than continuing
+    if (yielded && !m_this->FifoIsEmpty())
+        m_this->ActivateThreadPoolTask();
 
-        // hold lock again
-        m_this->m_queueLock.Lock();
+    // this task is no longer active, the queue can be destroyed after this so nothing can be touched
+    DebugAssert(m_this->m_activeThreadPoolTasks.load() > 0);
+    m_this->m_activeThreadPoolTasks.fetch_sub(1);
+    return 0;
+}
 
-        // destruct the command
-        m_this->FifoReleaseCommand(commandHdr);
+CommandQueue::FifoSlot *CommandQueue::FifoAllocateCommand(uint32 size, std::atomic<bool> *pCompletionFlag)
+{
+    FifoSlot *pSlot;
+    size_t position = m_enqueuePosition.load(std::memory_order_relaxed);
+    for (;;)
+    {
+        pSlot = GetSlot(position);
+        intptr_t difference = (intptr_t)pSlot->Sequence.load(std::memory_order_acquire) - (intptr_t)position;
+        if (difference == 0)
+        {
+            // slot is free for this lap, try to claim it
+            if (m_enqueuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+                break;
+        }
+        else if (difference < 0)
+        {
+            // queue is full, the slot is still in use from the previous lap
+            Timer stallTimer;
+            m_stallCount.fetch_add(1, std::memory_order_relaxed);
+            while ((intptr_t)pSlot->Sequence.load(std::memory_order_acquire) - (intptr_t)position < 0 && m_enqueuePosition.load(std::memory_order_relaxed) == position)
+            {
+                // help drain the queue if commands are allowed to run here, otherwise wait for a consumer
+                if (!CanExecuteOnCurrentThread() || !ExecuteCommands(1))
+                    Thread::Yield();
+            }
 
-        // check if we should yield
-        if (m_this->m_threadPoolYieldToOtherJobs && m_this->m_pThreadPool->ShouldYieldToOtherTask())
-            break;
+            m_stallTimeMicroseconds.fetch_add((uint64)(stallTimer.GetTimeSeconds() * 1000000.0), std::memory_order_relaxed);
+            position = m_enqueuePosition.load(std::memory_order_relaxed);
+        }
+        else
+        {
+            // another producer claimed it
+            position = m_enqueuePosition.load(std::memory_order_relaxed);
+        }
     }
 
-    // this task is no longer active
-    DebugAssert(m_this->m_activeThreadPoolTasks > 0);
-    m_this->m_activeThreadPoolTasks--;
-    m_active = false;
+    // construct in the slot if it fits
+    if (size <= COMMAND_SLOT_INLINE_SIZE)
+    {
+        pSlot->pCommand = reinterpret_cast<CommandBase *>(GetSlotInlineStorage(pSlot));
+        pSlot->HeapAllocated = false;
+    }
+    else
+    {
+        pSlot->pCommand = reinterpret_cast<CommandBase *>(Y_malloc(size));
+        pSlot->HeapAllocated = true;
+        m_heapAllocatedCommands.fetch_add(1, std::memory_order_relaxed);
+    }
 
-    // end of this task's work
-    m_this->m_queueLock.Unlock();
-    return 0;
+    pSlot->pCompletionFlag = pCompletionFlag;
+
+    // track depth
+    uint32 depth = m_pendingCommands.fetch_add(1) + 1;
+    uint32 peakDepth = m_peakQueueDepth.load(std::memory_order_relaxed);
+    while (depth > peakDepth && !m_peakQueueDepth.compare_exchange_weak(peakDepth, depth, std::memory_order_relaxed));
+    m_commandsQueued.fetch_add(1, std::memory_order_relaxed);
+    return pSlot;
 }
 
+void CommandQueue::FifoPublishCommand(FifoSlot *pSlot)
+{
+    // the sequence still holds the position it was claimed at, bumping it hands the slot to consumers
+    pSlot->Sequence.store(pSlot->Sequence.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    WakeConsumer();
+}
 
-void CommandQueue::LockQueueForNewCommand()
+bool CommandQueue::FifoIsEmpty() const
 {
-    m_queueLock.Lock();
+    if (m_pSlotMemory == nullptr)
+        return true;
+
+    size_t position = m_dequeuePosition.load(std::memory_order_acquire);
+    return ((intptr_t)GetSlot(position)->Sequence.load(std::memory_order_acquire) - (intptr_t)(position + 1) < 0);
 }
 
-void CommandQueue::UnlockQueueForNewCommand()
+uint32 CommandQueue::FifoClaimCommands(size_t *pFirstPosition, uint32 maxCount)
 {
-    DebugAssert(m_commandQueue.GetSize() > 0);
+    if (m_pSlotMemory == nullptr)
+        return 0;
 
-    if (m_pThreadPool != nullptr)
+    size_t position = m_dequeuePosition.load(std::memory_order_relaxed);
+    for (;;)
     {
-        bool queueTask = (m_activeThreadPoolTasks < m_threadPoolTasks.GetSize());
-        if (queueTask)
+        // count how many consecutive commands are ready from here
+        uint32 count = 0;
+        while (count < maxCount && GetSlot(position + count)->Sequence.load(std::memory_order_acquire) == (position + count + 1))
+            count++;
+
+        if (count == 0)
         {
-            // find a free task
-            for (uint32 i = 0; i < m_threadPoolTasks.GetSize(); i++)
-            {
-                ThreadPoolTask *pTask = m_threadPoolTasks[i];
-                if (!pTask->IsActive())
-                {
-                    // enqueue it
-                    pTask->SetActive();
-                    m_activeThreadPoolTasks++;
-                    m_pThreadPool->EnqueueWorkItem(pTask);
-                    break;
-                }
-            }
+            // empty, or another consumer has already moved past this position
+            intptr_t difference = (intptr_t)GetSlot(position)->Sequence.load(std::memory_order_acquire) - (intptr_t)(position + 1);
+            if (difference < 0)
+                return 0;
+
+            position = m_dequeuePosition.load(std::memory_order_relaxed);
+            continue;
+        }
+
+        // claim the whole batch at once
+        if (m_dequeuePosition.compare_exchange_weak(position, position + count, std::memory_order_relaxed))
+        {
+            *pFirstPosition = position;
+            return count;
         }
-        
-        // release lock
-        m_queueLock.Unlock();
     }
-    else
+}
+
+void CommandQueue::FifoExecuteCommands(size_t firstPosition, uint32 count)
+{
+    for (uint32 i = 0; i < count; i++)
     {
-        if (m_activeWorkerThreads < m_workerThreads.GetSize())
-            m_conditionVariable.Wake();
+        size_t position = firstPosition + i;
+        FifoSlot *pSlot = GetSlot(position);
 
-        m_queueLock.Unlock();
+        // run command
+        pSlot->pCommand->Execute();
+
+        // destruct the command
+        pSlot->pCommand->~CommandBase();
+        if (pSlot->HeapAllocated)
+            Y_free(pSlot->pCommand);
+
+        // let the producer continue, if it's waiting
+        std::atomic<bool> *pCompletionFlag = pSlot->pCompletionFlag;
+        pSlot->pCommand = nullptr;
+        pSlot->pCompletionFlag = nullptr;
+
+        // hand the slot back to producers for the next lap
+        pSlot->Sequence.store(position + m_slotMask + 1, std::memory_order_release);
+        m_pendingCommands.fetch_sub(1);
+        m_commandsExecuted.fetch_add(1, std::memory_order_relaxed);
+
+        if (pCompletionFlag != nullptr)
+            pCompletionFlag->store(true, std::memory_order_release);
     }
 }
 
-void *CommandQueue::FifoAllocateCommand(uint32 size, bool blockingEvent)
+bool CommandQueue::ExecuteCommands(uint32 maxCount)
 {
-    // allocate entry
-    FifoQueueEntryHeader *hdr = (FifoQueueEntryHeader *)Y_malloc(sizeof(FifoQueueEntryHeader) + size);
-    hdr->pCommand = reinterpret_cast<CommandBase *>(hdr + 1);
-    hdr->Size = size;
-    hdr->BlockingEvent = blockingEvent;
-    m_commandQueue.Add(hdr);
-    return hdr->pCommand;
+    size_t firstPosition;
+    uint32 count = FifoClaimCommands(&firstPosition, maxCount);
+    if (count == 0)
+        return false;
+
+    FifoExecuteCommands(firstPosition, count);
+    return true;
 }
 
-bool CommandQueue::FifoIsEmpty() const
+bool CommandQueue::CanExecuteOnCurrentThread() const
+{
+    // thread pool commands can run anywhere, queues without workers are run by their creator
+    if (m_pThreadPool != nullptr)
+        return true;
+    else
+        return (m_workerThreads.IsEmpty() && Thread::GetCurrentThreadId() == m_creatorThreadID);
+}
+
+void CommandQueue::WakeConsumer()
 {
-    return m_commandQueue.IsEmpty();
+    if (m_pThreadPool != nullptr)
+    {
+        ActivateThreadPoolTask();
+        return;
+    }
+
+    // pairs with the fence in the worker before it re-checks the queue
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (m_sleepingWorkerThreads.load() > 0)
+    {
+        m_workerLock.Lock();
+        m_conditionVariable.Wake();
+        m_workerLock.Unlock();
+    }
 }
 
-CommandQueue::FifoQueueEntryHeader *CommandQueue::FifoGetNextCommand()
+void CommandQueue::ActivateThreadPoolTask()
 {
-    if (m_commandQueue.GetSize() == 0)
-        return nullptr;
+    // pairs with the fence in the task after it goes inactive
+    std::atomic_thread_fence(std::memory_order_seq_cst);
 
-    return m_commandQueue.PopFront();
+    // find a free task
+    for (uint32 i = 0; i < m_threadPoolTasks.GetSize(); i++)
+    {
+        ThreadPoolTask *pTask = m_threadPoolTasks[i];
+        if (!pTask->IsActive() && pTask->TryActivate())
+        {
+            // enqueue it
+            m_activeThreadPoolTasks.fetch_add(1);
+            m_pThreadPool->EnqueueWorkItem(pTask);
+            break;
+        }
+    }
 }
 
-void CommandQueue::FifoReleaseCommand(FifoQueueEntryHeader *commandHdr)
+void CommandQueue::WaitForCompletion(std::atomic<bool> *pCompletionFlag)
 {
-    // destruct the command
-    commandHdr->pCommand->~CommandBase();
-    Y_free(commandHdr);
+    while (!pCompletionFlag->load(std::memory_order_acquire))
+    {
+        // if the command could run here, help out rather than risk waiting on ourselves
+        if (!CanExecuteOnCurrentThread() || !ExecuteCommands(1))
+            Thread::Yield();
+    }
 }
 
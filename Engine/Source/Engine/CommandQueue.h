@@ -1,12 +1,36 @@
 #pragma once
 #include "Engine/Common.h"
+#include <atomic>
 
+// Multi-producer command queue. Commands are stored in a bounded lock-free ring (Vyukov style), so producers
+// on any thread never take a lock unless a worker has to be woken. Commands small enough to fit in a slot are
+// constructed in place, larger ones fall back to a heap allocation.
 class CommandQueue
 {
 public:
     // 1MiB default queue size
     static const uint32 DEFAULT_COMMAND_QUEUE_SIZE = 1048576;
 
+    // size of each slot in the ring, the command queue size is divided by this to get the slot count
+    static const uint32 COMMAND_SLOT_SIZE = 128;
+
+    // maximum number of commands claimed at once when draining a queue that has no other consumers. worker threads
+    // and pool tasks claim one at a time, so independent commands spread across them, and a command waiting on a
+    // later one can't end up stuck behind itself.
+    static const uint32 DRAIN_BATCH_SIZE = 32;
+
+    // queue statistics
+    struct Statistics
+    {
+        uint32 QueueDepth;
+        uint32 PeakQueueDepth;
+        uint64 CommandsQueued;
+        uint64 CommandsExecuted;
+        uint64 HeapAllocatedCommands;
+        uint64 StallCount;
+        double StallTime;
+    };
+
 private:
     struct CommandBase
     {
@@ -60,59 +84,56 @@ public:
             return;
         }
 
-        LockQueueForNewCommand();
-
-        CommandLambdaTrampoline<T> *trampoline = (CommandLambdaTrampoline<T> *)FifoAllocateCommand(sizeof(CommandLambdaTrampoline<T>), false);
-        new (trampoline)CommandLambdaTrampoline<T>(lambda);
-
-        UnlockQueueForNewCommand();
+        FifoSlot *pSlot = FifoAllocateCommand(sizeof(CommandLambdaTrampoline<T>), nullptr);
+        new (pSlot->pCommand) CommandLambdaTrampoline<T>(lambda);
+        FifoPublishCommand(pSlot);
     }
 
     // Queue lambda command using move semantics
     template<class T> void QueueLambdaCommand(T &&lambda)
     {
+        typedef CommandLambdaTrampoline<typename std::remove_reference<T>::type> TrampolineType;
         if (m_commandQueueSize == 0)
         {
             lambda();
             return;
         }
 
-        LockQueueForNewCommand();
-
-        CommandLambdaTrampoline<T> *trampoline = (CommandLambdaTrampoline<T> *)FifoAllocateCommand(sizeof(CommandLambdaTrampoline<T>), false);
-        new (trampoline) CommandLambdaTrampoline<T>(std::move(lambda));
-
-        UnlockQueueForNewCommand();
+        FifoSlot *pSlot = FifoAllocateCommand(sizeof(TrampolineType), nullptr);
+        new (pSlot->pCommand) TrampolineType(std::move(lambda));
+        FifoPublishCommand(pSlot);
     }
 
-    // blocking variants
+    // blocking variants, can be called from any thread other than a worker of this queue
     void QueueBlockingCommand(CommandBase *pCommand, uint32 commandSize);
     template<class T> void QueueBlockingLambdaCommand(const T &lambda)
     {
-        if (m_commandQueueSize == 0 || m_workerThreads.IsEmpty())
+        if (m_commandQueueSize == 0 || (m_workerThreads.IsEmpty() && m_pThreadPool == nullptr))
         {
             lambda();
             return;
         }
 
-        // currently blocking events are only supported coming from the main thread
-        DebugAssert(Thread::GetCurrentThreadId() == m_creatorThreadID);
-
-        LockQueueForNewCommand();
-
-        CommandLambdaTrampoline<T> *trampoline = (CommandLambdaTrampoline<T> *)FifoAllocateCommand(sizeof(CommandLambdaTrampoline<T>), true);
-        new (trampoline)CommandLambdaTrampoline<T>(lambda);
-
-        UnlockQueueForNewCommand();
+        std::atomic<bool> completed(false);
+        FifoSlot *pSlot = FifoAllocateCommand(sizeof(CommandLambdaTrampoline<T>), &completed);
+        new (pSlot->pCommand) CommandLambdaTrampoline<T>(lambda);
+        FifoPublishCommand(pSlot);
 
         // block
-        m_barrier.Wait();
+        WaitForCompletion(&completed);
     }
 
     // when not using a render thread, executes any pending commands, and blocks until the queue is empty
     // returns true if a command was executed, false if the queue was empty
     bool ExecuteQueuedCommands();
 
+    // statistics access, stall time is the time producers spent waiting for space in the queue
+    void GetStatistics(Statistics *pStatistics) const;
+    void ResetStatistics();
+
+    // publishes depth/stall counters to the profiler under commandqueue/<name>/
+    void UpdateProfilerCounters(const char *name) const;
+
 private:
     // worker thread class
     class WorkerThread : public Thread
@@ -131,69 +152,98 @@ private:
     public:
         ThreadPoolTask(CommandQueue *pParent);
 
-        bool IsActive() const { return m_active; }
-        void SetActive() { m_active = true; }
+        bool IsActive() const { return m_active.load(); }
+        bool TryActivate() { bool expected = false; return m_active.compare_exchange_strong(expected, true); }
+        void SetInactive() { m_active.store(false); }
 
     protected:
         virtual int32 ProcessWork() override;
         CommandQueue *m_this;
-        bool m_active;
+        std::atomic<bool> m_active;
     };
 
     // so the tasks can call our internal methods
     friend WorkerThread;
     friend ThreadPoolTask;
 
-    // fifo queue entry
-    struct FifoQueueEntryHeader
+    // ring slot, the sequence number tells producers and consumers whether the slot is theirs
+    struct FifoSlot
     {
+        std::atomic<size_t> Sequence;
         CommandBase *pCommand;
-        uint32 Size;
-        bool BlockingEvent;
+        std::atomic<bool> *pCompletionFlag;
+        bool HeapAllocated;
     };
 
+    // space left in each slot for inline commands
+    static const uint32 COMMAND_SLOT_INLINE_SIZE = COMMAND_SLOT_SIZE - ((sizeof(FifoSlot) + 15) & ~15u);
+
     // allocate the queue
     void AllocateQueue(uint32 size);
-    
-    // lock the queue
-    void LockQueueForNewCommand();
 
-    // unlock the queue, call this variant if no additional commands were added
-    void UnlockQueueForNewCommand();
+    // slot access
+    FifoSlot *GetSlot(size_t position) const { return reinterpret_cast<FifoSlot *>(m_pSlotMemory + (position & m_slotMask) * COMMAND_SLOT_SIZE); }
+    byte *GetSlotInlineStorage(FifoSlot *pSlot) const { return reinterpret_cast<byte *>(pSlot) + (COMMAND_SLOT_SIZE - COMMAND_SLOT_INLINE_SIZE); }
+
+    // claims a slot and space for the command, waiting if the queue is full
+    FifoSlot *FifoAllocateCommand(uint32 size, std::atomic<bool> *pCompletionFlag);
 
-    // allocate bytes in the queue, assumes that the queue lock is held
-    void *FifoAllocateCommand(uint32 size, bool blockingEvent);
+    // makes a command visible to consumers, and wakes a worker if needed
+    void FifoPublishCommand(FifoSlot *pSlot);
 
     // fifo is empty?
     bool FifoIsEmpty() const;
 
-    // retreives the first command off the fifo, but does not destroy it yet
-    FifoQueueEntryHeader *FifoGetNextCommand();
+    // claims up to maxCount consecutive commands off the fifo, returns the count and first position
+    uint32 FifoClaimCommands(size_t *pFirstPosition, uint32 maxCount);
+
+    // runs and releases claimed commands
+    void FifoExecuteCommands(size_t firstPosition, uint32 count);
+
+    // consumer helpers, return true if anything was executed
+    bool ExecuteCommands(uint32 maxCount);
+    bool CanExecuteOnCurrentThread() const;
+
+    // wakes a consumer after a command has been published
+    void WakeConsumer();
+    void ActivateThreadPoolTask();
+
+    // waits for a blocking command to complete
+    void WaitForCompletion(std::atomic<bool> *pCompletionFlag);
 
-    // release a fifo command
-    void FifoReleaseCommand(FifoQueueEntryHeader *commandHdr);
-     
     // creator thread
     Thread::ThreadIdType m_creatorThreadID;
-    
+
     // worker thread
     PODArray<WorkerThread *> m_workerThreads;
-    bool m_workerThreadExitFlag;
+    volatile bool m_workerThreadExitFlag;
+    std::atomic<bool> m_workersPaused;
+    std::atomic<uint32> m_sleepingWorkerThreads;
 
     // thread pool
     PODArray<ThreadPoolTask *> m_threadPoolTasks;
     ThreadPool *m_pThreadPool;
-    volatile uint32 m_activeThreadPoolTasks;
+    std::atomic<uint32> m_activeThreadPoolTasks;
     bool m_threadPoolYieldToOtherJobs;
 
-    // fifo members
-    PODArray<FifoQueueEntryHeader *> m_commandQueue;
-    RecursiveMutex m_queueLock;
-    volatile uint32 m_activeWorkerThreads;
+    // ring members, positions increase forever and are masked to get the slot
+    byte *m_pSlotMemory;
+    size_t m_slotMask;
+    std::atomic<size_t> m_enqueuePosition;
+    std::atomic<size_t> m_dequeuePosition;
+    std::atomic<uint32> m_pendingCommands;
     uint32 m_commandQueueSize;
 
-    // events
+    // statistics
+    std::atomic<uint32> m_peakQueueDepth;
+    std::atomic<uint64> m_commandsQueued;
+    std::atomic<uint64> m_commandsExecuted;
+    std::atomic<uint64> m_heapAllocatedCommands;
+    std::atomic<uint64> m_stallCount;
+    std::atomic<uint64> m_stallTimeMicroseconds;
+
+    // sleeping workers wait on this
+    RecursiveMutex m_workerLock;
     ConditionVariable m_conditionVariable;
-    Barrier m_barrier;
 };
 
@@ -51,7 +51,7 @@ struct DF_FONT_TEXTURE
 };
 
 //--------------------------------------- .staticmesh file -------------------------------------
-#define DF_STATICMESH_HEADER_MAGIC ((uint32)'STM2')
+#define DF_STATICMESH_HEADER_MAGIC ((uint32)'STM3')
 
 enum DF_STATICMESH_VERTEX_FLAGS
 {
@@ -88,6 +88,7 @@ struct DF_STATICMESH_LOD_HEADER
     uint32 IndicesOffset;
     uint32 BatchCount;
     uint32 BatchesOffset;
+    float ScreenSize;
 };
 
 struct DF_STATICMESH_VERTEX
@@ -218,7 +219,7 @@ struct DF_SKELETALMESH_BATCH
 };
 
 //--------------------------------------- .ska file -------------------------------------
-#define DF_SKELETALANIMATION_HEADER_MAGIC ((uint32)'ANM3')
+#define DF_SKELETALANIMATION_HEADER_MAGIC ((uint32)'ANM4')
 
 struct DF_SKELETALANIMATION_HEADER
 {
@@ -234,25 +235,34 @@ struct DF_SKELETALANIMATION_HEADER
     uint32 RootMotionOffset;
 };
 
-struct DF_SKELETALANIMATION_TRANSFORM_TRACK_KEYFRAME
+// Each track header is followed by its position, rotation and scale streams, in that order. A stream is the key times
+// followed by the values, and a stream with one key is constant for the whole track.
+//   float PositionKeyTimes[PositionKeyCount], float Positions[PositionKeyCount][3]
+//   float RotationKeyTimes[RotationKeyCount], DF_SKELETALANIMATION_PACKED_ROTATION Rotations[RotationKeyCount]
+//   float ScaleKeyTimes[ScaleKeyCount], float Scales[ScaleKeyCount][3]
+
+// smallest three: the largest component is dropped and rebuilt from the others, which are stored in 15 bits each.
+// the index of the dropped component is kept in the top bit of the first two values.
+struct DF_SKELETALANIMATION_PACKED_ROTATION
 {
-    float Time;
-    float Position[3];
-    float Rotation[4];
-    float Scale[3];
+    uint16 Components[3];
 };
 
 struct DF_SKELETALANIMATION_BONE_TRACK_HEADER
 {
     uint32 BoneIndex;
     float Duration;
-    uint32 KeyFrameCount;
+    uint32 PositionKeyCount;
+    uint32 RotationKeyCount;
+    uint32 ScaleKeyCount;
 };
 
 struct DF_SKELETALANIMATION_ROOT_MOTION_TRACK_HEADER
 {
     float Duration;
-    uint32 KeyFrameCount;
+    uint32 PositionKeyCount;
+    uint32 RotationKeyCount;
+    uint32 ScaleKeyCount;
 };
 
 //--------------------------------------- .tex file -------------------------------------
@@ -778,6 +788,43 @@ struct DF_SHADER_PROGRAM_COMMON_HEADER
     uint32 MaterialShaderCRC;
 };
 
+//---------------------------------  shader cache ---------------------------------
+#define DF_SHADER_CACHE_HEADER_MAGIC 0x48435359 // YSCH
+#define DF_SHADER_CACHE_HEADER_VERSION 1
+#define DF_SHADER_CACHE_ENTRY_MAGIC 0x45435359 // YSCE
+#define DF_SHADER_CACHE_ENTRY_ALIGNMENT 4
+struct DF_SHADER_CACHE_HEADER
+{
+    uint32 Magic;
+    uint32 Version;
+};
+
+// followed by DataSize bytes (common header + bytecode), padded to the entry alignment
+struct DF_SHADER_CACHE_ENTRY_HEADER
+{
+    uint32 Magic;
+    uint8 HashCode[16];
+    uint32 DataSize;
+};
+
+#define DF_SHADER_PERMUTATION_LIST_HEADER_MAGIC 0x4C505359 // YSPL
+#define DF_SHADER_PERMUTATION_LIST_HEADER_VERSION 1
+struct DF_SHADER_PERMUTATION_LIST_HEADER
+{
+    uint32 Magic;
+    uint32 Version;
+};
+
+// followed by the base shader, vertex factory and material shader names as C strings, empty for none
+struct DF_SHADER_PERMUTATION_LIST_ENTRY
+{
+    uint8 HashCode[16];
+    uint32 GlobalShaderFlags;
+    uint32 BaseShaderFlags;
+    uint32 VertexFactoryFlags;
+    uint32 MaterialShaderFlags;
+};
+
 //--------------------------------- .map file ---------------------------------
 //#define DF_MAP_HEADER_MAGIC 0x50414D59 // YMAP
 //#define DF_MAP_TERRAIN_HEADER_MAGIC 0x50414D60 // YMAP
@@ -5,8 +5,12 @@
 #include "Engine/Entity.h"
 #include "Renderer/RenderWorld.h"
 
+// size of the cells in the entity grid, in world units
+static const float ENTITY_GRID_CELL_SIZE = 16.0f;
+
 DynamicWorld::DynamicWorld()
-    : World()
+    : World(),
+      m_entityGrid(ENTITY_GRID_CELL_SIZE)
 {
 
 }
@@ -37,7 +41,7 @@ DynamicWorld::~DynamicWorld()
         }
 
         // as OnRemoveFromWorld could invoke an entity lookup/search, we have to remove the entity from the list *now*
-        m_entities.RemoveBack();
+        RemoveEntityData(m_entities.GetSize() - 1);
 
         // invoke handler and cleanup
         pEntity->OnRemoveFromWorld(this);
@@ -56,13 +60,29 @@ DynamicWorld::~DynamicWorld()
 
 DynamicWorld::EntityData *DynamicWorld::GetEntityData(const Entity *pEntity)
 {
-    for (uint32 i = 0; i < m_entities.GetSize(); i++)
+    const EntityIndexHashTable::Member *pMember = m_entityIndexHashTable.Find(pEntity->GetEntityID());
+    if (pMember == nullptr || m_entities[pMember->Value].pEntity != pEntity)
+        return nullptr;
+
+    return &m_entities[pMember->Value];
+}
+
+void DynamicWorld::RemoveEntityData(uint32 index)
+{
+    EntityData &data = m_entities[index];
+    m_entityGrid.Remove(data.GridHandle);
+    m_entityIndexHashTable.Remove(m_entityIndexHashTable.Find(data.EntityID));
+
+    // the last entity is moved into this slot, so update its lookups
+    uint32 lastIndex = m_entities.GetSize() - 1;
+    if (index != lastIndex)
     {
-        if (m_entities[i].pEntity == pEntity)
-            return &m_entities[i];
+        const EntityData &lastData = m_entities[lastIndex];
+        m_entityGrid.SetUserData(lastData.GridHandle, index);
+        m_entityIndexHashTable.Find(lastData.EntityID)->Value = index;
     }
 
-    return nullptr;
+    m_entities.FastRemove(index);
 }
 
 void DynamicWorld::AddBrush(Brush *pObject)
@@ -103,26 +123,22 @@ const Entity *DynamicWorld::GetEntityByID(uint32 EntityId) const
 {
     DebugAssert(EntityId != 0);
 
-    for (uint32 i = 0; i < m_entities.GetSize(); i++)
-    {
-        if (m_entities[i].EntityID == EntityId)
-            return m_entities[i].pEntity->Cast<Entity>();
-    }
+    const EntityIndexHashTable::Member *pMember = m_entityIndexHashTable.Find(EntityId);
+    if (pMember == nullptr)
+        return nullptr;
 
-    return nullptr;
+    return m_entities[pMember->Value].pEntity->Cast<Entity>();
 }
 
 Entity *DynamicWorld::GetEntityByID(uint32 EntityId)
 {
     DebugAssert(EntityId != 0);
 
-    for (uint32 i = 0; i < m_entities.GetSize(); i++)
-    {
-        if (m_entities[i].EntityID == EntityId)
-            return m_entities[i].pEntity->Cast<Entity>();
-    }
+    const EntityIndexHashTable::Member *pMember = m_entityIndexHashTable.Find(EntityId);
+    if (pMember == nullptr)
+        return nullptr;
 
-    return nullptr;
+    return m_entities[pMember->Value].pEntity->Cast<Entity>();
 }
 
 void DynamicWorld::AddEntity(Entity *pEntity)
@@ -139,6 +155,8 @@ void DynamicWorld::AddEntity(Entity *pEntity)
     data.EntityID = pEntity->GetEntityID();
     data.BoundingBox = pEntity->GetBoundingBox();
     data.BoundingSphere = pEntity->GetBoundingSphere();
+    data.GridHandle = m_entityGrid.Insert(data.BoundingBox, m_entities.GetSize());
+    m_entityIndexHashTable.Insert(data.EntityID, m_entities.GetSize());
     m_entities.Add(data);
 
     // invoke added function
@@ -151,21 +169,16 @@ void DynamicWorld::AddEntity(Entity *pEntity)
 
 void DynamicWorld::MoveEntity(Entity *pEntity)
 {
-    for (uint32 i = 0; i < m_entities.GetSize(); i++)
-    {
-        EntityData &data = m_entities[i];
-        if (data.pEntity == pEntity)
-        {
-            data.BoundingBox = pEntity->GetBoundingBox();
-            data.BoundingSphere = pEntity->GetBoundingSphere();
+    EntityData *pData = GetEntityData(pEntity);
+    if (pData == nullptr)
+        Panic("attempted to move entity in world where it does not exist");
 
-            m_worldBoundingBox.Merge(pEntity->GetBoundingBox());
-            m_worldBoundingSphere.Merge(pEntity->GetBoundingSphere());
-            return;
-        }
-    }
+    pData->BoundingBox = pEntity->GetBoundingBox();
+    pData->BoundingSphere = pEntity->GetBoundingSphere();
+    m_entityGrid.Move(pData->GridHandle, pData->BoundingBox);
 
-    Panic("attempted to move entity in world where it does not exist");
+    m_worldBoundingBox.Merge(pEntity->GetBoundingBox());
+    m_worldBoundingSphere.Merge(pEntity->GetBoundingSphere());
 }
 
 void DynamicWorld::UpdateEntity(Entity *pEntity)
@@ -175,56 +188,51 @@ void DynamicWorld::UpdateEntity(Entity *pEntity)
 
 void DynamicWorld::RemoveEntity(Entity *pEntity)
 {
-    for (uint32 i = 0; i < m_entities.GetSize(); i++)
-    {
-        EntityData &data = m_entities[i];
-        if (data.pEntity == pEntity)
-        {
-            // ensure it isn't active
-            for (uint32 j = 0; j < m_activeEntities.GetSize(); j++)
-            {
-                if (m_activeEntities[j].pEntity == pEntity)
-                {
-                    m_activeEntities.FastRemove(j);
-                    SortActiveEntities();
-                    break;
-                }
-            }
+    EntityData *pData = GetEntityData(pEntity);
+    if (pData == nullptr)
+        Panic("attempted to remove entity from world where it does not exist");
 
-            for (uint32 j = 0; j < m_activeAsyncEntities.GetSize(); j++)
-            {
-                if (m_activeAsyncEntities[j].pEntity == pEntity)
-                {
-                    m_activeAsyncEntities.FastRemove(j);
-                    SortActiveAsyncEntities();
-                    break;
-                }
-            }
-
-            // ensure it isn't queued for removal
-            for (uint32 j = 0; j < m_removeQueue.GetSize(); j++)
-            {
-                if (m_removeQueue[j] == pEntity)
-                {
-                    m_removeQueue.FastRemove(j);
-                    break;
-                }
-            }
+    uint32 index = (uint32)(pData - m_entities.GetBasePointer());
 
-            // remove from list
-            m_entities.FastRemove(i);
+    // ensure it isn't active
+    for (uint32 j = 0; j < m_activeEntities.GetSize(); j++)
+    {
+        if (m_activeEntities[j].pEntity == pEntity)
+        {
+            m_activeEntities.FastRemove(j);
+            SortActiveEntities();
+            break;
+        }
+    }
 
-            // invoke removed function
-            pEntity->OnRemoveFromWorld(this);
+    for (uint32 j = 0; j < m_activeAsyncEntities.GetSize(); j++)
+    {
+        if (m_activeAsyncEntities[j].pEntity == pEntity)
+        {
+            m_activeAsyncEntities.FastRemove(j);
+            SortActiveAsyncEntities();
+            break;
+        }
+    }
 
-            // remove object
-            pEntity->Release();
-            return;
+    // ensure it isn't queued for removal
+    for (uint32 j = 0; j < m_removeQueue.GetSize(); j++)
+    {
+        if (m_removeQueue[j] == pEntity)
+        {
+            m_removeQueue.FastRemove(j);
+            break;
         }
     }
 
-    // should not get reached
-    Panic("attempted to remove entity from world where it does not exist");
+    // remove from list
+    RemoveEntityData(index);
+
+    // invoke removed function
+    pEntity->OnRemoveFromWorld(this);
+
+    // remove object
+    pEntity->Release();
 }
 
 void DynamicWorld::BeginFrame(float deltaTime)
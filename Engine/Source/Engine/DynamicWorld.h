@@ -1,6 +1,7 @@
 #pragma once
 #include "Engine/World.h"
 #include "Engine/Entity.h"
+#include "Engine/SpatialHashGrid.h"
 
 class DynamicWorld : public World
 {
@@ -32,20 +33,30 @@ private:
         uint32 EntityID;
         AABox BoundingBox;
         Sphere BoundingSphere;
+        uint32 GridHandle;
     };
 
     // array types
     typedef PODArray<Brush *> StaticObjectArray;
     typedef MemArray<EntityData> EntityDataArray;
     typedef PODArray<Entity *> EntityArray;
+    typedef HashTable<uint32, uint32> EntityIndexHashTable;
 
     // get object data for a specified entity
     EntityData *GetEntityData(const Entity *pEntity);
 
-    // we could probably binary sort these with the uint32 id
+    // removes the entity at the specified index, keeping the lookups in sync
+    void RemoveEntityData(uint32 index);
+
     StaticObjectArray m_brushes;
     EntityDataArray m_entities;
 
+    // entity id -> index in m_entities
+    EntityIndexHashTable m_entityIndexHashTable;
+
+    // entity bounds, user data is the index in m_entities
+    SpatialHashGrid m_entityGrid;
+
 public:
     // Finds all entity in the world.
     template<typename T>
@@ -68,62 +79,61 @@ public:
     }
 
     // Finds objects inside the specified frustum.
+    // The query callbacks must not add, move or remove entities, use QueueRemoveEntity, and move entities after the query returns.
     template<typename T>
     void EnumerateEntitiesInFrustum(const Frustum &frustum, T Callback)
     {
-        for (uint32 i = 0; i < m_entities.GetSize(); i++)
+        m_entityGrid.EnumerateAABox(frustum.GetBoundingAABox(), [this, &frustum, &Callback](uint32 index)
         {
-            if (m_entities[i].EntityID != 0 && frustum.AABoxIntersection(m_entities[i].BoundingBox))
-                Callback(m_entities[i].pEntity->Cast<Entity>());
-        }
+            if (frustum.AABoxIntersection(m_entities[index].BoundingBox))
+                Callback(m_entities[index].pEntity->Cast<Entity>());
+        });
     }
     template<typename T>
     void EnumerateEntitiesInFrustum(const Frustum &frustum, T Callback) const
     {
-        for (uint32 i = 0; i < m_entities.GetSize(); i++)
+        m_entityGrid.EnumerateAABox(frustum.GetBoundingAABox(), [this, &frustum, &Callback](uint32 index)
         {
-            if (m_entities[i].EntityID != 0 && frustum.AABoxIntersection(m_entities[i].BoundingBox))
-                Callback(m_entities[i].pEntity->Cast<Entity>());
-        }
+            if (frustum.AABoxIntersection(m_entities[index].BoundingBox))
+                Callback(m_entities[index].pEntity->Cast<Entity>());
+        });
     }
 
     // Finds objects inside the specified axis-aligned box.
     template<typename T>
     void EnumerateEntitiesInAABox(const AABox &box, T Callback)
     {
-        for (uint32 i = 0; i < m_entities.GetSize(); i++)
+        m_entityGrid.EnumerateAABox(box, [this, &Callback](uint32 index)
         {
-            if (m_entities[i].EntityID != 0 && box.AABoxIntersection(m_entities[i].BoundingBox))
-                Callback(m_entities[i].pEntity->Cast<Entity>());
-        }
+            Callback(m_entities[index].pEntity->Cast<Entity>());
+        });
     }
     template<typename T>
     void EnumerateEntitiesInAABox(const AABox &box, T Callback) const
     {
-        for (uint32 i = 0; i < m_entities.GetSize(); i++)
+        m_entityGrid.EnumerateAABox(box, [this, &Callback](uint32 index)
         {
-            if (m_entities[i].EntityID != 0 && box.AABoxIntersection(m_entities[i].BoundingBox))
-                Callback(m_entities[i].pEntity->Cast<Entity>());
-        }
+            Callback(m_entities[index].pEntity->Cast<Entity>());
+        });
     }
 
     // Finds objects inside the specified sphere.
     template<typename T>
     void EnumerateEntitiesInSphere(const Sphere &sphere, T Callback)
     {
-        for (uint32 i = 0; i < m_entities.GetSize(); i++)
+        m_entityGrid.EnumerateAABox(AABox::FromSphere(sphere), [this, &sphere, &Callback](uint32 index)
         {
-            if (m_entities[i].EntityID != 0 && sphere.SphereIntersection(m_entities[i].BoundingSphere))
-                Callback(m_entities[i].pEntity->Cast<Entity>());
-        }
+            if (sphere.SphereIntersection(m_entities[index].BoundingSphere))
+                Callback(m_entities[index].pEntity->Cast<Entity>());
+        });
     }
     template<typename T>
     void EnumerateEntitiesInSphere(const Sphere &sphere, T Callback) const
     {
-        for (uint32 i = 0; i < m_entities.GetSize(); i++)
+        m_entityGrid.EnumerateAABox(AABox::FromSphere(sphere), [this, &sphere, &Callback](uint32 index)
         {
-            if (m_entities[i].EntityID != 0 && sphere.SphereIntersection(m_entities[i].BoundingSphere))
-                Callback(m_entities[i].pEntity->Cast<Entity>());
-        }
+            if (sphere.SphereIntersection(m_entities[index].BoundingSphere))
+                Callback(m_entities[index].pEntity->Cast<Entity>());
+        });
     }
 };
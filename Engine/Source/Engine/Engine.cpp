@@ -71,12 +71,17 @@ bool Engine::Startup()
     workerThreadCount = 0;
 #endif
 
+    // the thread pool and job system share the budget rather than both running a thread per core. the pool only
+    // runs async/background commands, which spend much of their time waiting on io, so it gets the smaller share.
+    int32 poolThreadCount = (workerThreadCount > 0) ? Max(workerThreadCount / 4, (int32)1) : 0;
+    int32 jobWorkerThreadCount = workerThreadCount - poolThreadCount;
+
     if (workerThreadCount > 0)
     {
-        Log_InfoPrintf("Creating %u worker threads...", workerThreadCount);
+        Log_InfoPrintf("Creating %u worker threads (%u thread pool, %u job system)...", workerThreadCount, poolThreadCount, jobWorkerThreadCount);
 
         // create threadpool
-        m_pWorkerThreadPool = new ThreadPool(workerThreadCount);
+        m_pWorkerThreadPool = new ThreadPool(poolThreadCount);
 
         // create async command queue
         if (!m_asyncCommandQueue.Initialize(m_pWorkerThreadPool, CommandQueue::DEFAULT_COMMAND_QUEUE_SIZE))
@@ -125,19 +130,37 @@ bool Engine::Startup()
         }
     }
 
+    // create job system, with no workers jobs run inline
+    if (!m_jobSystem.Initialize((uint32)Max(jobWorkerThreadCount, (int32)0)))
+    {
+        Log_ErrorPrintf("Engine::Startup: Failed to initialize job system.");
+        return false;
+    }
+
     // done
     return true;
 }
 
+void Engine::UpdateCommandQueueProfilerCounters()
+{
+    m_mainThreadCommandQueue.UpdateProfilerCounters("main");
+    m_asyncCommandQueue.UpdateProfilerCounters("async");
+    m_backgroundCommandQueue.UpdateProfilerCounters("background");
+    m_jobSystem.UpdateProfilerCounters();
+}
+
 void Engine::Shutdown()
 {
+    // Run any outstanding jobs, and end the job workers
+    m_jobSystem.Shutdown();
+
     // Shutdown async workers, run any remaining callbacks
     for (;;)
     {
         bool result;
-        result = m_asyncCommandQueue.ExecuteQueuedTasks();
-        result |= m_backgroundCommandQueue.ExecuteQueuedTasks();
-        result |= m_mainThreadCommandQueue.ExecuteQueuedTasks();
+        result = m_asyncCommandQueue.ExecuteQueuedCommands();
+        result |= m_backgroundCommandQueue.ExecuteQueuedCommands();
+        result |= m_mainThreadCommandQueue.ExecuteQueuedCommands();
         if (result)
             continue;
         else
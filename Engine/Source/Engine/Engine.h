@@ -1,8 +1,8 @@
 #pragma once
 #include "Engine/Common.h"
 #include "Engine/CommandQueue.h"
+#include "Engine/JobSystem.h"
 #include "Core/RandomNumberGenerator.h"
-#include "YBaseLib/TaskQueue.h"
 
 class Font;
 
@@ -46,9 +46,15 @@ public:
     virtual void Shutdown();
 
     // command queue access
-    TaskQueue *GetMainThreadCommandQueue() { return &m_mainThreadCommandQueue; }
-    TaskQueue *GetAsyncCommandQueue() { return &m_asyncCommandQueue; }
-    TaskQueue *GetBackgroundCommandQueue() { return &m_backgroundCommandQueue; }
+    CommandQueue *GetMainThreadCommandQueue() { return &m_mainThreadCommandQueue; }
+    CommandQueue *GetAsyncCommandQueue() { return &m_asyncCommandQueue; }
+    CommandQueue *GetBackgroundCommandQueue() { return &m_backgroundCommandQueue; }
+
+    // publishes command queue statistics to the profiler, called once per frame
+    void UpdateCommandQueueProfilerCounters();
+
+    // job system access
+    JobSystem *GetJobSystem() { return &m_jobSystem; }
 
     // game thread random number generator
     // can only be accessed from game thread!
@@ -85,13 +91,16 @@ private:
     ThreadPool *m_pWorkerThreadPool;
 
     // main thread command queue
-    TaskQueue m_mainThreadCommandQueue;
+    CommandQueue m_mainThreadCommandQueue;
 
     // async command queue
-    TaskQueue m_asyncCommandQueue;
+    CommandQueue m_asyncCommandQueue;
 
     // background command queue
-    TaskQueue m_backgroundCommandQueue;
+    CommandQueue m_backgroundCommandQueue;
+
+    // job system, runs on its own workers
+    JobSystem m_jobSystem;
 
     // random number generator
     RandomNumberGenerator m_randomNumberGenerator;
@@ -100,9 +109,9 @@ private:
 extern Engine *g_pEngine;
 
 // command queue helper macros
-#define QUEUE_MAIN_THREAD_COMMAND(obj) g_pEngine->GetMainThreadCommandQueue()->QueueTask(&obj, sizeof(obj))
-#define QUEUE_MAIN_THREAD_LAMBDA_COMMAND g_pEngine->GetMainThreadCommandQueue()->QueueLambdaTask
-#define QUEUE_ASYNC_COMMAND(obj) g_pEngine->GetAsyncCommandQueue()->QueueTask(&obj, sizeof(obj))
-#define QUEUE_ASYNC_LAMBDA_COMMAND g_pEngine->GetAsyncCommandQueue()->QueueLambdaTask
-#define QUEUE_BACKGROUND_COMMAND(obj) g_pEngine->GetBackgroundCommandQueue()->QueueTask(&obj, sizeof(obj))
-#define QUEUE_BACKGROUND_LAMBDA_COMMAND g_pEngine->GetBackgroundCommandQueue()->QueueLambdaTask
+#define QUEUE_MAIN_THREAD_COMMAND(obj) g_pEngine->GetMainThreadCommandQueue()->QueueCommand(&obj, sizeof(obj))
+#define QUEUE_MAIN_THREAD_LAMBDA_COMMAND g_pEngine->GetMainThreadCommandQueue()->QueueLambdaCommand
+#define QUEUE_ASYNC_COMMAND(obj) g_pEngine->GetAsyncCommandQueue()->QueueCommand(&obj, sizeof(obj))
+#define QUEUE_ASYNC_LAMBDA_COMMAND g_pEngine->GetAsyncCommandQueue()->QueueLambdaCommand
+#define QUEUE_BACKGROUND_COMMAND(obj) g_pEngine->GetBackgroundCommandQueue()->QueueCommand(&obj, sizeof(obj))
+#define QUEUE_BACKGROUND_LAMBDA_COMMAND g_pEngine->GetBackgroundCommandQueue()->QueueLambdaCommand
@@ -11,15 +11,24 @@ namespace CVars
 {
     // Engine cvars
     CVar e_worker_threads("e_worker_threads", CVAR_FLAG_REQUIRE_APP_RESTART, "-1", "number of worker threads, -1 to automatically decide, or 0 for none", "int");
+    CVar e_parallel_entity_update("e_parallel_entity_update", 0, "1", "Update entities whose type is flagged as parallel update safe across the job system workers", "bool");
+    CVar e_parallel_entity_update_batch_size("e_parallel_entity_update_batch_size", 0, "16", "Number of entities updated by each parallel update job", "uint:1-1024");
 
     // Resource manager cvars
     CVar rm_enable_resource_compilation("rm_enable_resource_compilation", 0, "1", "Load uncompiled resources, if the modification time is newer than the compiled version.", "bool");
     CVar rm_maintenance_interval("rm_maintenance_interval", 0, "1", "Delay in seconds between resource manager maintenance calls");
     CVar rm_remote_resource_compiler_close_delay("rm_remote_resource_compiler_close_delay", 0, "15", "Delay in seconds between a resource compiler being created and then closed", "uint");
+    CVar rm_async_load_threads("rm_async_load_threads", CVAR_FLAG_REQUIRE_APP_RESTART, "2", "Number of threads used to load resources requested asynchronously, or 0 to load them on the main thread", "uint:0-16");
+    CVar rm_async_upload_batch_size("rm_async_upload_batch_size", 0, "32", "Maximum number of asynchronously loaded resources uploaded to the GPU per frame, or 0 for no limit", "uint");
 
     // Physics cvars
     CVar physics_fps("physics_fps", 0, "60.0", "The (fixed) frame rate that physics simulates at.", "float:0-999");
 
+    // Map cvars
+    CVar map_async_streaming("map_async_streaming", 0, "true", "Read and decode map regions on the job system instead of the main thread", "bool");
+    CVar map_streaming_activation_time_budget("map_streaming_activation_time_budget", 0, "2", "Milliseconds per frame to spend adding streamed regions to the world, 0 for no limit", "float:0-100");
+    CVar map_streaming_prefetch_time("map_streaming_prefetch_time", 0, "1.5", "Seconds ahead of moving observers to request regions, 0 to disable prefetching", "float:0-10");
+
     // Renderer cvars
     CVar r_platform("r_platform", CVAR_FLAG_REQUIRE_APP_RESTART, "", "Rendering API to use, empty is default for platform", "string:D3D9|D3D11|OPENGL|OPENGL_ES");
     CVar r_use_render_thread("r_use_render_thread", CVAR_FLAG_REQUIRE_APP_RESTART, "true", "Enable off-main-thread rendering", "bool");
@@ -66,9 +75,14 @@ namespace CVars
     CVar r_use_debug_device("r_use_debug_device", CVAR_FLAG_REQUIRE_APP_RESTART, ENABLED_BOOL_ON_DEBUG_BUILD, "If set, a debug device is created for the renderer (huge performance cost).", "bool");
     CVar r_use_debug_shaders("r_use_debug_shaders", CVAR_FLAG_REQUIRE_APP_RESTART, ENABLED_BOOL_ON_DEBUG_BUILD, "If set, debug shaders are used instead of release (optimized) shaders.", "bool");
     CVar r_dump_shaders("r_dump_shaders", CVAR_FLAG_REQUIRE_APP_RESTART, "0", "If set, shader source code will be dumped to a file.", "bool");
+    CVar r_record_shader_permutations("r_record_shader_permutations", 0, "0", "If set, every shader permutation requested is added to the shader cache permutation list, for precompiling on the next run.", "bool");
+    CVar r_precompile_shaders("r_precompile_shaders", 0, "1", "If set, recorded shader permutations are compiled and created behind a loading screen at startup.", "bool");
     CVar r_enable_multithreaded_resource_creation("r_enable_multithreaded_resource_creation", CVAR_FLAG_REQUIRE_APP_RESTART, "0", "Enabled multithreaded resource creation, if supported", "bool");
     CVar r_sprite_draw_instanced_quads("r_sprite_draw_instanced_quads", CVAR_FLAG_REQUIRE_APP_RESTART, "1", "Enable usage of instanced quads for sprite rendering", "bool");
     CVar r_emulate_mobile("r_emulate_mobile", CVAR_FLAG_REQUIRE_RENDER_RESTART, "0", "Emulate mobile rendering on desktop", "bool");
+    CVar r_render_world_spatial_index("r_render_world_spatial_index", CVAR_FLAG_PAUSE_RENDER_THREAD, "1", "Use the bounding volume hierarchy for render world queries, instead of testing every renderable", "bool");
+    CVar r_static_mesh_lod_bias("r_static_mesh_lod_bias", CVAR_FLAG_PAUSE_RENDER_THREAD, "0", "Offset added to the static mesh lod selected by screen size, positive values draw less detail", "int");
+    CVar r_static_mesh_lod_hysteresis("r_static_mesh_lod_hysteresis", CVAR_FLAG_PAUSE_RENDER_THREAD, "0.1", "Fraction a static mesh must grow past a lod's screen size before switching back to the more detailed lod", "float:0-1");
 
     // Renderer debug cvars
     CVar r_show_cascades("r_show_cascades", CVAR_FLAG_REQUIRE_RENDER_RESTART, "false", "Enable visualization of cascade selection", "bool");
@@ -5,15 +5,24 @@ namespace CVars
 {
     // Engine cvars
     extern CVar e_worker_threads;
+    extern CVar e_parallel_entity_update;
+    extern CVar e_parallel_entity_update_batch_size;
 
     // Resource manager cvars
     extern CVar rm_enable_resource_compilation;
     extern CVar rm_maintenance_interval;
     extern CVar rm_remote_resource_compiler_close_delay;
+    extern CVar rm_async_load_threads;
+    extern CVar rm_async_upload_batch_size;
 
     // Physics cvars
     extern CVar physics_fps;
 
+    // Map cvars
+    extern CVar map_async_streaming;
+    extern CVar map_streaming_activation_time_budget;
+    extern CVar map_streaming_prefetch_time;
+
     // Renderer cvars
     extern CVar r_platform;
     extern CVar r_use_render_thread;
@@ -60,9 +69,14 @@ namespace CVars
     extern CVar r_use_debug_device;
     extern CVar r_use_debug_shaders;
     extern CVar r_dump_shaders;
+    extern CVar r_record_shader_permutations;
+    extern CVar r_precompile_shaders;
     extern CVar r_enable_multithreaded_resource_creation;
     extern CVar r_sprite_draw_instanced_quads;
     extern CVar r_emulate_mobile;
+    extern CVar r_render_world_spatial_index;
+    extern CVar r_static_mesh_lod_bias;
+    extern CVar r_static_mesh_lod_hysteresis;
 
     // Renderer debug cvars
     extern CVar r_show_cascades;
@@ -90,6 +90,9 @@ void Engine::RegisterEngineEntityTypes()
     REGISTER_TYPE(BlockMeshEntity);
     REGISTER_TYPE(StaticMeshRigidBodyEntity);
     REGISTER_TYPE(ParticleEmitterEntity);
+
+    // particle emitters only simulate their own instance data, their render updates and moves are queued
+    ParticleEmitterEntity::StaticMutableTypeInfo()->SetParallelUpdateSafe(true);
 }
 
 void Engine::RegisterExternalTypes()
@@ -320,7 +320,7 @@ void Entity::SetBounds(const AABox &boundingBox, const Sphere &boundingSphere, b
             m_boundingSphere = mergedBoundingSphere;
 
             if (m_pWorld != nullptr)
-                m_pWorld->MoveEntity(this);
+                m_pWorld->RequestMoveEntity(this);
         }
     }
     else
@@ -331,7 +331,7 @@ void Entity::SetBounds(const AABox &boundingBox, const Sphere &boundingSphere, b
             m_boundingSphere = boundingSphere;
 
             if (m_pWorld != nullptr)
-                m_pWorld->MoveEntity(this);
+                m_pWorld->RequestMoveEntity(this);
         }
     }
 }
@@ -3,7 +3,8 @@
 #include "Engine/Entity.h"
 
 EntityTypeInfo::EntityTypeInfo(const char *TypeName, const ObjectTypeInfo *pParentTypeInfo, const PROPERTY_DECLARATION *pPropertyDeclarations, ObjectFactory *pFactory, uint32 scriptFlags, const SCRIPT_FUNCTION_TABLE_ENTRY *pScriptFunctions)
-    : ScriptObjectTypeInfo(TypeName, pParentTypeInfo, pPropertyDeclarations, pFactory, scriptFlags, pScriptFunctions)
+    : ScriptObjectTypeInfo(TypeName, pParentTypeInfo, pPropertyDeclarations, pFactory, scriptFlags, pScriptFunctions),
+      m_parallelUpdateSafe(false)
 {
 
 }
@@ -10,6 +10,16 @@ public:
     // type registration
     virtual void RegisterType() override;
     virtual void UnregisterType() override;
+
+    // Entities of this type can be updated concurrently with other parallel-safe entities. Their Update/UpdateAsync
+    // may only touch their own state and components, read the world, move themselves and queue removals. Anything
+    // shared, such as physics objects or the active entity lists, is off limits.
+    // Not inherited, each derived type has to opt in separately.
+    bool IsParallelUpdateSafe() const { return m_parallelUpdateSafe; }
+    void SetParallelUpdateSafe(bool parallelUpdateSafe) { m_parallelUpdateSafe = parallelUpdateSafe; }
+
+private:
+    bool m_parallelUpdateSafe;
 };
 
 // Macros
@@ -0,0 +1,404 @@
+#include "Engine/PrecompiledHeader.h"
+#include "Engine/JobSystem.h"
+#include "Engine/Profiling.h"
+Log_SetChannel(JobSystem);
+
+// set by each worker on startup, so looking up the calling worker doesn't have to scan the thread ids
+Y_DECLARE_THREAD_LOCAL(JobSystem *) s_pCurrentThreadJobSystem = nullptr;
+Y_DECLARE_THREAD_LOCAL(int32) s_currentThreadWorkerIndex = -1;
+
+JobCounter::JobCounter()
+    : m_value(0)
+{
+
+}
+
+JobCounter::~JobCounter()
+{
+    // anything still waiting on us will never run
+    DebugAssert(m_continuations.IsEmpty());
+}
+
+void JobSystem::JobQueue::Push(JobBase *pJob)
+{
+    MutexLock lock(Lock);
+    Jobs.Add(pJob);
+}
+
+JobBase *JobSystem::JobQueue::PopBack()
+{
+    MutexLock lock(Lock);
+    if (Jobs.GetSize() == Head)
+        return nullptr;
+
+    JobBase *pJob = Jobs.PopBack();
+    if (Jobs.GetSize() == Head)
+    {
+        Jobs.Clear();
+        Head = 0;
+    }
+
+    return pJob;
+}
+
+JobBase *JobSystem::JobQueue::PopFront()
+{
+    MutexLock lock(Lock);
+    if (Jobs.GetSize() == Head)
+        return nullptr;
+
+    // the consumed part of the array is reclaimed once the queue empties
+    JobBase *pJob = Jobs[Head++];
+    if (Jobs.GetSize() == Head)
+    {
+        Jobs.Clear();
+        Head = 0;
+    }
+
+    return pJob;
+}
+
+JobSystem::JobSystem()
+    : m_mainThreadID(0),
+      m_exitFlag(false),
+      m_pendingJobs(0),
+      m_jobsExecuted(0),
+      m_jobsStolen(0),
+      m_sleepingWorkers(0)
+{
+
+}
+
+JobSystem::~JobSystem()
+{
+    DebugAssert(m_workers.IsEmpty());
+}
+
+bool JobSystem::Initialize(uint32 workerThreadCount)
+{
+    DebugAssert(m_workers.IsEmpty());
+    m_mainThreadID = Thread::GetCurrentThreadId();
+    m_exitFlag = false;
+
+    // queues have to exist before any worker can steal from them
+    m_workerQueues.Resize(workerThreadCount);
+    for (uint32 i = 0; i < workerThreadCount; i++)
+        m_workerQueues[i] = new JobQueue();
+
+    for (uint32 i = 0; i < workerThreadCount; i++)
+    {
+        WorkerThread *pThread = new WorkerThread(this, i);
+        if (!pThread->Start())
+        {
+            Log_ErrorPrintf("JobSystem::Initialize: Failed to start worker thread %u", i);
+            delete pThread;
+            Shutdown();
+            return false;
+        }
+
+        m_workers.Add(pThread);
+    }
+
+    return true;
+}
+
+void JobSystem::Shutdown()
+{
+    // run everything that is left, including continuations that are released along the way
+    for (;;)
+    {
+        bool result = ExecuteMainThreadJobs();
+        if (m_pendingJobs.load() > 0)
+        {
+            JobBase *pJob = FindJob(-1);
+            if (pJob != nullptr)
+                ExecuteJob(pJob);
+            else
+                Thread::Yield();
+
+            continue;
+        }
+
+        if (!result)
+            break;
+    }
+
+    // set the exit flag, and wake all workers
+    m_sleepLock.Lock();
+    m_exitFlag = true;
+    m_sleepConditionVariable.WakeAll();
+    m_sleepLock.Unlock();
+
+    while (m_workers.GetSize() > 0)
+    {
+        WorkerThread *pThread = m_workers.PopBack();
+        pThread->Join();
+        delete pThread;
+    }
+
+    while (m_workerQueues.GetSize() > 0)
+        delete m_workerQueues.PopBack();
+}
+
+JobBase *JobSystem::InitializeJob(JobBase *pJob, JobCounter *pCounter, JOB_AFFINITY affinity)
+{
+    pJob->pCounter = pCounter;
+    pJob->Affinity = affinity;
+    if (pCounter != nullptr)
+    {
+        pCounter->AddRef();
+        pCounter->m_value.fetch_add(1);
+    }
+
+    return pJob;
+}
+
+void JobSystem::Submit(JobBase *pJob)
+{
+    if (pJob->Affinity == JOB_AFFINITY_MAIN_THREAD)
+    {
+        m_mainThreadQueue.Push(pJob);
+        return;
+    }
+
+    // without workers, jobs run immediately
+    if (m_workers.IsEmpty())
+    {
+        ExecuteJob(pJob);
+        return;
+    }
+
+    // the pending count goes up first, so a worker never sees the job before the count
+    m_pendingJobs.fetch_add(1);
+
+    // workers push to their own deque, everyone else goes through the injection queue
+    int32 workerIndex = GetCurrentWorkerIndex();
+    if (workerIndex >= 0)
+        m_workerQueues[workerIndex]->Push(pJob);
+    else
+        m_injectionQueue.Push(pJob);
+
+    WakeWorker();
+}
+
+void JobSystem::SubmitAfter(JobCounter *pDependency, JobBase *pJob)
+{
+    // the dependency can't complete while we hold the lock, see SignalCounter
+    pDependency->m_continuationLock.Lock();
+    if (pDependency->m_value.load() != 0)
+    {
+        pDependency->m_continuations.Add(pJob);
+        pDependency->m_continuationLock.Unlock();
+        return;
+    }
+
+    pDependency->m_continuationLock.Unlock();
+    Submit(pJob);
+}
+
+void JobSystem::ExecuteJob(JobBase *pJob)
+{
+    JobCounter *pCounter = pJob->pCounter;
+    pJob->Execute();
+    delete pJob;
+
+    m_jobsExecuted.fetch_add(1, std::memory_order_relaxed);
+    if (pCounter != nullptr)
+        SignalCounter(pCounter);
+}
+
+void JobSystem::SignalCounter(JobCounter *pCounter)
+{
+    if (pCounter->m_value.fetch_sub(1) == 1)
+    {
+        // take the continuations, unless another job was started against the counter in the meantime,
+        // in which case they are left for when that one completes
+        PODArray<JobBase *> continuations;
+        pCounter->m_continuationLock.Lock();
+        if (pCounter->m_value.load() == 0)
+        {
+            for (uint32 i = 0; i < pCounter->m_continuations.GetSize(); i++)
+                continuations.Add(pCounter->m_continuations[i]);
+
+            pCounter->m_continuations.Clear();
+        }
+        pCounter->m_continuationLock.Unlock();
+
+        for (uint32 i = 0; i < continuations.GetSize(); i++)
+            Submit(continuations[i]);
+
+        // wake anything sleeping in WaitFor, paired with the fence there
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (m_sleepingWorkers.load() > 0)
+        {
+            m_sleepLock.Lock();
+            m_sleepConditionVariable.WakeAll();
+            m_sleepLock.Unlock();
+        }
+    }
+
+    pCounter->Release();
+}
+
+void JobSystem::WaitFor(JobCounter *pCounter)
+{
+    int32 workerIndex = GetCurrentWorkerIndex();
+    bool isMainThread = IsMainThread();
+    while (!pCounter->IsComplete())
+    {
+        JobBase *pJob;
+        if (isMainThread && (pJob = m_mainThreadQueue.PopFront()) != nullptr)
+        {
+            ExecuteJob(pJob);
+            continue;
+        }
+
+        if (m_pendingJobs.load() > 0 && (pJob = FindJob(workerIndex)) != nullptr)
+        {
+            ExecuteJob(pJob);
+            continue;
+        }
+
+        // the remaining jobs are running elsewhere, the main thread keeps polling as some may be waiting for it
+        if (isMainThread)
+        {
+            Thread::Yield();
+            continue;
+        }
+
+        // anyone else sleeps until a job is queued or a counter completes, rather than spinning on main thread jobs
+        m_sleepLock.Lock();
+        m_sleepingWorkers.fetch_add(1);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (!pCounter->IsComplete() && m_pendingJobs.load() == 0)
+            m_sleepConditionVariable.SleepAndRelease(&m_sleepLock);
+
+        m_sleepingWorkers.fetch_sub(1);
+        m_sleepLock.Unlock();
+    }
+}
+
+bool JobSystem::ExecuteMainThreadJobs()
+{
+    DebugAssert(IsMainThread());
+
+    bool result = false;
+    JobBase *pJob;
+    while ((pJob = m_mainThreadQueue.PopFront()) != nullptr)
+    {
+        ExecuteJob(pJob);
+        result = true;
+    }
+
+    return result;
+}
+
+int32 JobSystem::GetCurrentWorkerIndex() const
+{
+    return (s_pCurrentThreadJobSystem == this) ? s_currentThreadWorkerIndex : -1;
+}
+
+JobBase *JobSystem::FindJob(int32 workerIndex)
+{
+    JobBase *pJob;
+
+    // own deque first, newest job is the most likely to have its data in cache
+    if (workerIndex >= 0 && (pJob = m_workerQueues[workerIndex]->PopBack()) != nullptr)
+    {
+        m_pendingJobs.fetch_sub(1);
+        return pJob;
+    }
+
+    // then anything submitted from outside
+    if ((pJob = m_injectionQueue.PopFront()) != nullptr)
+    {
+        m_pendingJobs.fetch_sub(1);
+        return pJob;
+    }
+
+    // steal the oldest job from another worker, starting at our neighbour so thieves spread out
+    uint32 queueCount = m_workerQueues.GetSize();
+    uint32 startIndex = (workerIndex >= 0) ? (uint32)workerIndex + 1 : 0;
+    for (uint32 i = 0; i < queueCount; i++)
+    {
+        uint32 victimIndex = (startIndex + i) % queueCount;
+        if ((int32)victimIndex == workerIndex)
+            continue;
+
+        if ((pJob = m_workerQueues[victimIndex]->PopFront()) != nullptr)
+        {
+            m_pendingJobs.fetch_sub(1);
+            m_jobsStolen.fetch_add(1, std::memory_order_relaxed);
+            return pJob;
+        }
+    }
+
+    return nullptr;
+}
+
+void JobSystem::WakeWorker()
+{
+    // paired with the fence in the worker, either the worker sees the new job or we see it sleeping
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (m_sleepingWorkers.load() > 0)
+    {
+        m_sleepLock.Lock();
+        m_sleepConditionVariable.Wake();
+        m_sleepLock.Unlock();
+    }
+}
+
+void JobSystem::UpdateProfilerCounters() const
+{
+#ifdef WITH_PROFILER
+    MicroProfileCounterSet(MicroProfileGetCounterToken("jobsystem/pending"), (int64_t)m_pendingJobs.load(std::memory_order_relaxed));
+    MicroProfileCounterSet(MicroProfileGetCounterToken("jobsystem/executed"), (int64_t)m_jobsExecuted.load(std::memory_order_relaxed));
+    MicroProfileCounterSet(MicroProfileGetCounterToken("jobsystem/stolen"), (int64_t)m_jobsStolen.load(std::memory_order_relaxed));
+#endif
+}
+
+JobSystem::WorkerThread::WorkerThread(JobSystem *pParent, uint32 index)
+    : m_this(pParent),
+      m_index(index)
+{
+
+}
+
+int JobSystem::WorkerThread::ThreadEntryPoint()
+{
+    // initialize thread name
+    Thread::SetDebugName(String::FromFormat("Job System Worker %u", m_index));
+    s_pCurrentThreadJobSystem = m_this;
+    s_currentThreadWorkerIndex = (int32)m_index;
+
+    for (;;)
+    {
+        // run jobs until there are none left
+        JobBase *pJob = m_this->FindJob((int32)m_index);
+        if (pJob != nullptr)
+        {
+            m_this->ExecuteJob(pJob);
+            continue;
+        }
+
+        // go to sleep, submitters check the sleeping count after queueing, so re-check after incrementing it
+        m_this->m_sleepLock.Lock();
+        m_this->m_sleepingWorkers.fetch_add(1);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+
+        if (m_this->m_exitFlag.load() && m_this->m_pendingJobs.load() == 0)
+        {
+            m_this->m_sleepingWorkers.fetch_sub(1);
+            m_this->m_sleepLock.Unlock();
+            break;
+        }
+
+        if (m_this->m_pendingJobs.load() == 0)
+            m_this->m_sleepConditionVariable.SleepAndRelease(&m_this->m_sleepLock);
+
+        m_this->m_sleepingWorkers.fetch_sub(1);
+        m_this->m_sleepLock.Unlock();
+    }
+
+    return 0;
+}
@@ -0,0 +1,212 @@
+#pragma once
+#include "Engine/Common.h"
+#include "YBaseLib/ReferenceCounted.h"
+#include <atomic>
+
+class JobSystem;
+class JobCounter;
+
+// Where a job is allowed to run
+enum JOB_AFFINITY
+{
+    JOB_AFFINITY_ANY,                       // any worker, or a thread waiting on a counter
+    JOB_AFFINITY_MAIN_THREAD,               // only the thread that initialized the job system
+    JOB_AFFINITY_COUNT,
+};
+
+// Base of all queued jobs, lambdas are wrapped by JobSystem::Run
+struct JobBase
+{
+    JobBase() : pCounter(nullptr), Affinity(JOB_AFFINITY_ANY) {}
+    virtual ~JobBase() {}
+    virtual void Execute() = 0;
+
+    JobCounter *pCounter;
+    JOB_AFFINITY Affinity;
+};
+
+// Tracks a group of outstanding jobs. The count is incremented when a job is submitted against the counter, and
+// decremented when it completes. Jobs queued with RunAfter() are held on the counter until it next reaches zero.
+// Counters must be heap allocated, as the last job to complete may still be touching it when a waiter wakes up.
+class JobCounter : public ReferenceCounted
+{
+    friend JobSystem;
+
+public:
+    JobCounter();
+    ~JobCounter();
+
+    // number of jobs not yet completed
+    uint32 GetValue() const { return m_value.load(); }
+    bool IsComplete() const { return (m_value.load() == 0); }
+
+private:
+    std::atomic<uint32> m_value;
+    Mutex m_continuationLock;
+    PODArray<JobBase *> m_continuations;
+};
+
+// Work-stealing job scheduler. Each worker owns a deque, jobs submitted from a worker are pushed to the back of
+// its own deque and popped LIFO, idle workers steal from the front of the other deques. Jobs submitted from other
+// threads go through a shared injection queue. Waiting on a counter runs other jobs instead of blocking.
+class JobSystem
+{
+private:
+    template<class T>
+    struct JobLambdaTrampoline : public JobBase
+    {
+        T m_callback;
+
+        JobLambdaTrampoline(const T &callback) : m_callback(callback) {}
+        JobLambdaTrampoline(T &&callback) : m_callback(std::move(callback)) {}
+        virtual ~JobLambdaTrampoline() {}
+
+        virtual void Execute() override { m_callback(); }
+    };
+
+    template<class T>
+    struct ParallelForRange
+    {
+        const T *pCallback;
+        uint32 Start;
+        uint32 End;
+
+        void operator()() const { (*pCallback)(Start, End); }
+    };
+
+public:
+    JobSystem();
+    ~JobSystem();
+
+    // starts the workers, with no workers jobs are executed at submission time
+    bool Initialize(uint32 workerThreadCount);
+
+    // runs all outstanding jobs, and ends the worker threads
+    void Shutdown();
+
+    // worker info
+    uint32 GetWorkerThreadCount() const { return m_workers.GetSize(); }
+    bool IsMainThread() const { return (Thread::GetCurrentThreadId() == m_mainThreadID); }
+
+    // index of the calling worker thread, or -1 for threads not owned by the job system
+    int32 GetCurrentWorkerIndex() const;
+
+    // submits a job, optionally incrementing a counter which is decremented when the job completes
+    template<class T> void Run(T &&lambda, JobCounter *pCounter = nullptr, JOB_AFFINITY affinity = JOB_AFFINITY_ANY)
+    {
+        typedef JobLambdaTrampoline<typename std::remove_reference<T>::type> TrampolineType;
+        Submit(InitializeJob(new TrampolineType(std::forward<T>(lambda)), pCounter, affinity));
+    }
+
+    // submits a job once the dependency counter reaches zero, pCounter is incremented immediately
+    template<class T> void RunAfter(JobCounter *pDependency, T &&lambda, JobCounter *pCounter = nullptr, JOB_AFFINITY affinity = JOB_AFFINITY_ANY)
+    {
+        typedef JobLambdaTrampoline<typename std::remove_reference<T>::type> TrampolineType;
+        SubmitAfter(pDependency, InitializeJob(new TrampolineType(std::forward<T>(lambda)), pCounter, affinity));
+    }
+
+    // runs other jobs until the counter reaches zero. on the main thread, main thread jobs are also executed,
+    // other threads sleep when there is nothing they can run, as the rest may be waiting for the main thread.
+    void WaitFor(JobCounter *pCounter);
+
+    // calls lambda(start, end) for each batch of the range [0, count), and waits for all batches to complete
+    template<class T> void ParallelFor(uint32 count, uint32 batchSize, const T &lambda)
+    {
+        batchSize = Max(batchSize, (uint32)1);
+        if (count <= batchSize || m_workers.IsEmpty())
+        {
+            if (count > 0)
+                lambda(0, count);
+
+            return;
+        }
+
+        // the first batch is run by the calling thread
+        JobCounter *pCounter = new JobCounter();
+        for (uint32 start = batchSize; start < count; start += batchSize)
+        {
+            ParallelForRange<T> range = { &lambda, start, Min(start + batchSize, count) };
+            Run(range, pCounter);
+        }
+
+        lambda(0, batchSize);
+        WaitFor(pCounter);
+        pCounter->Release();
+    }
+
+    // runs jobs with main thread affinity, must be called from the main thread
+    // returns true if any jobs were executed
+    bool ExecuteMainThreadJobs();
+
+    // publishes job counts to the profiler under jobsystem/
+    void UpdateProfilerCounters() const;
+
+private:
+    // deque of jobs, the owner pushes/pops at the back, thieves take from the front
+    struct JobQueue
+    {
+        JobQueue() : Head(0) {}
+
+        void Push(JobBase *pJob);
+        JobBase *PopBack();
+        JobBase *PopFront();
+
+        PODArray<JobBase *> Jobs;
+        uint32 Head;
+        Mutex Lock;
+    };
+
+    // worker thread class
+    class WorkerThread : public Thread
+    {
+    public:
+        WorkerThread(JobSystem *pParent, uint32 index);
+
+    protected:
+        virtual int ThreadEntryPoint() override;
+        JobSystem *m_this;
+        uint32 m_index;
+    };
+
+    friend WorkerThread;
+
+    // binds the counter to the job
+    JobBase *InitializeJob(JobBase *pJob, JobCounter *pCounter, JOB_AFFINITY affinity);
+
+    // queues a job whose dependencies are satisfied
+    void Submit(JobBase *pJob);
+    void SubmitAfter(JobCounter *pDependency, JobBase *pJob);
+
+    // runs and releases the job, then signals its counter
+    void ExecuteJob(JobBase *pJob);
+    void SignalCounter(JobCounter *pCounter);
+
+    // finds a job for the thread, workerIndex is -1 for non-worker threads
+    JobBase *FindJob(int32 workerIndex);
+
+    // wakes a worker after a job was queued
+    void WakeWorker();
+
+    // workers
+    PODArray<WorkerThread *> m_workers;
+    PODArray<JobQueue *> m_workerQueues;
+    Thread::ThreadIdType m_mainThreadID;
+    std::atomic<bool> m_exitFlag;
+
+    // jobs submitted from non-worker threads
+    JobQueue m_injectionQueue;
+
+    // jobs that have to run on the main thread
+    JobQueue m_mainThreadQueue;
+
+    // number of jobs sitting in worker/injection queues
+    std::atomic<uint32> m_pendingJobs;
+    std::atomic<uint64> m_jobsExecuted;
+    std::atomic<uint64> m_jobsStolen;
+
+    // sleeping workers and waiters wait on this
+    std::atomic<uint32> m_sleepingWorkers;
+    RecursiveMutex m_sleepLock;
+    ConditionVariable m_sleepConditionVariable;
+};
+
@@ -1,6 +1,8 @@
 #include "Engine/PrecompiledHeader.h"
 #include "Engine/Map.h"
+#include "Engine/Engine.h"
 #include "Engine/EngineCVars.h"
+#include "Engine/Profiling.h"
 #include "Engine/DataFormats.h"
 #include "Engine/ResourceManager.h"
 #include "Engine/Camera.h"
@@ -23,16 +25,18 @@ Log_SetChannel(Map);
 Map::Map()
     : m_pMapArchive(nullptr),
       m_pClassTable(nullptr),
+      m_pRegionLoadJobCounter(new JobCounter()),
       m_pWorld(nullptr),
       m_pTerrainLayerList(nullptr),
       m_pTerrainRenderer(nullptr)
 {
-
+    Y_memzero(&m_streamingStats, sizeof(m_streamingStats));
 }
 
 Map::~Map()
 {
     UnloadAllRegions();
+    m_pRegionLoadJobCounter->Release();
 
     // we don't call the remove method for terrain entities since they'll be dropped in the remove queue
     // anyway, but they'll be cleaned up when the world is deleted
@@ -173,6 +177,7 @@ bool Map::LoadMap(const char *mapName, const float3 *pInitialPositionOverride, P
     pProgressCallbacks->PushState();
     m_pWorld->AddObserver(this, initialStreamingPosition);
     HandleStreaming(pProgressCallbacks);
+    FinishStreaming();
     m_pWorld->RemoveObserver(this);
     pProgressCallbacks->PopState();
     pProgressCallbacks->SetProgressValue(1);
@@ -211,6 +216,9 @@ void Map::LoadAllRegions(ProgressCallbacks *pProgressCallbacks /*= ProgressCallb
     
 void Map::UnloadAllRegions()
 {
+    // loads still in flight are completed and thrown away
+    CancelPendingRegionLoads();
+
     for (MapRegionTable::Iterator itr = m_regions.Begin(); !itr.AtEnd(); itr.Forward())
     {
         Vector2i regionPosition(itr->Key);
@@ -224,23 +232,32 @@ void Map::HandleStreaming(ProgressCallbacks *pProgressCallbacks /* = ProgressCal
 {
     const uint32 observerCount = m_pWorld->GetObserverCount();
     if (observerCount == 0)
+    {
+        ActivatePendingRegions(CVars::map_streaming_activation_time_budget.GetFloat());
         return;
+    }
 
     const int32 loadRadius = (int32)m_regionLoadRadius;
+    const bool asyncStreaming = CVars::map_async_streaming.GetBool();
     pProgressCallbacks->SetProgressRange(m_regions.GetMemberCount());
     pProgressCallbacks->SetProgressValue(0);
 
-    // get region for camera position
-    int2 *pObserverRegions = (int2 *)alloca(sizeof(int2) * observerCount);
+    // get region for camera position, and where it is heading
+    UpdateObserverPredictions();
+    const uint32 streamingPositionCount = observerCount * 2;
+    int2 *pObserverRegions = (int2 *)alloca(sizeof(int2) * streamingPositionCount);
     for (uint32 i = 0; i < observerCount; i++)
-        pObserverRegions[i] = GetRegionForPosition(m_pWorld->GetObserverLocation(i));
+    {
+        pObserverRegions[i * 2 + 0] = GetRegionForPosition(m_pWorld->GetObserverLocation(i));
+        pObserverRegions[i * 2 + 1] = GetRegionForPosition(m_observerPredictions[i].PredictedLocation);
+    }
 
     // load any regions that are within distance of the camera, unload anything that's not
     for (MapRegionTable::Iterator itr = m_regions.Begin(); !itr.AtEnd(); itr.Forward())
     {
         const int2 &regionPosition = itr->Key;
         int32 regionsFromCamera = Y_INT32_MAX;
-        for (uint32 i = 0; i < observerCount; i++)
+        for (uint32 i = 0; i < streamingPositionCount; i++)
             regionsFromCamera = Min(regionsFromCamera, Max(Math::Abs(pObserverRegions[i].x - regionPosition.x), Math::Abs(pObserverRegions[i].y - regionPosition.y)));
 
         // determine the lod level applicable for this region
@@ -261,15 +278,26 @@ void Map::HandleStreaming(ProgressCallbacks *pProgressCallbacks /* = ProgressCal
         if (lodLevelForRegion == (int32)m_regionLODLevels)
             lodLevelForRegion = -1;
 
-        const MapRegion *pRegion = itr->Value;
+        MapRegion *pRegion = itr->Value;
         DebugAssert(pRegion != NULL);
 
+        // regions with a load in flight are looked at again once it has been activated
+        if (pRegion->IsLoadPending())
+            continue;
+
         // matches?
         if (pRegion->GetLoadedLODLevel() == lodLevelForRegion)
             continue;
 
         // switch the lod level
         Log_PerfPrintf("Map::HandleStreaming: Region (%i, %i) transitioning from LOD %i to %i...", regionPosition.x, regionPosition.y, pRegion->GetLoadedLODLevel(), lodLevelForRegion);
+        if (asyncStreaming && lodLevelForRegion >= 0)
+        {
+            // the current data stays in the world until the new level of detail is ready
+            QueueRegionLoad(pRegion, lodLevelForRegion);
+            continue;
+        }
+
         if (!ChangeRegionLOD(regionPosition.x, regionPosition.y, lodLevelForRegion))
         {
             Log_WarningPrintf("Map::HandleStreaming: Failed to transition region (%i, %i) from LOD %i to %i", regionPosition.x, regionPosition.y, pRegion->GetLoadedLODLevel(), lodLevelForRegion);
@@ -278,6 +306,148 @@ void Map::HandleStreaming(ProgressCallbacks *pProgressCallbacks /* = ProgressCal
 
         pProgressCallbacks->IncrementProgressValue();
     }
+
+    // add whatever has finished decoding
+    ActivatePendingRegions(CVars::map_streaming_activation_time_budget.GetFloat());
+
+#ifdef WITH_PROFILER
+    MicroProfileCounterSet(MicroProfileGetCounterToken("map/pending_region_loads"), (int64_t)m_streamingStats.PendingRegionLoads);
+    MicroProfileCounterSet(MicroProfileGetCounterToken("map/region_load_latency_ms"), (int64_t)m_streamingStats.LastLoadLatency);
+#endif
+}
+
+void Map::FinishStreaming()
+{
+    g_pEngine->GetJobSystem()->WaitFor(m_pRegionLoadJobCounter);
+    ActivatePendingRegions(0.0f);
+    DebugAssert(m_streamingStats.PendingRegionLoads == 0);
+}
+
+void Map::UpdateObserverPredictions()
+{
+    // the velocity since the last update is extrapolated over the prefetch time, capped to the load radius
+    float timeDelta = (float)m_observerPredictionTimer.GetTimeSeconds();
+    float prefetchTime = CVars::map_streaming_prefetch_time.GetFloat();
+    float maxPrefetchDistance = (float)(m_regionSize * m_regionLoadRadius);
+    m_observerPredictionTimer.Reset();
+
+    MemArray<ObserverPrediction> predictions;
+    for (uint32 i = 0; i < m_pWorld->GetObserverCount(); i++)
+    {
+        ObserverPrediction prediction;
+        prediction.Identifier = m_pWorld->GetObserverIdentifier(i);
+        prediction.LastLocation = m_pWorld->GetObserverLocation(i);
+        prediction.PredictedLocation = prediction.LastLocation;
+
+        // new observers have no velocity yet
+        for (uint32 j = 0; j < m_observerPredictions.GetSize(); j++)
+        {
+            if (m_observerPredictions[j].Identifier != prediction.Identifier)
+                continue;
+
+            if (timeDelta > 0.0f && prefetchTime > 0.0f)
+            {
+                float3 prefetchOffset((prediction.LastLocation - m_observerPredictions[j].LastLocation) * (prefetchTime / timeDelta));
+                float prefetchDistance = prefetchOffset.Length();
+                if (prefetchDistance > maxPrefetchDistance)
+                    prefetchOffset *= maxPrefetchDistance / prefetchDistance;
+
+                prediction.PredictedLocation += prefetchOffset;
+            }
+
+            break;
+        }
+
+        predictions.Add(prediction);
+    }
+
+    m_observerPredictions.Swap(predictions);
+}
+
+ByteStream *Map::ReadRegionFile(int32 regionX, int32 regionY, int32 lodLevel)
+{
+    PathString fileName;
+    fileName.Format("region_%i_%i.%i", regionX, regionY, lodLevel);
+
+    // the whole file is decompressed into memory while holding the archive, so parsing it doesn't hold up other loads
+    MutexLock lock(m_archiveLock);
+    AutoReleasePtr<ByteStream> pFileStream = m_pMapArchive->OpenFile(fileName, BYTESTREAM_OPEN_READ | BYTESTREAM_OPEN_STREAMED);
+    if (pFileStream == NULL)
+    {
+        Log_WarningPrintf("Map::ReadRegionFile: Could not open region file for (%i, %i, LOD %i), '%s'", regionX, regionY, lodLevel, fileName.GetCharArray());
+        return nullptr;
+    }
+
+    ByteStream *pStream = ByteStream_CreateGrowableMemoryStream();
+    if (!ByteStream_AppendStream(pFileStream, pStream) || !pStream->SeekAbsolute(0))
+    {
+        Log_WarningPrintf("Map::ReadRegionFile: Could not read region file '%s'", fileName.GetCharArray());
+        pStream->Release();
+        return nullptr;
+    }
+
+    return pStream;
+}
+
+void Map::QueueRegionLoad(MapRegion *pRegion, int32 lodLevel)
+{
+    pRegion->BeginPendingLoad(lodLevel);
+    m_streamingStats.PendingRegionLoads++;
+
+    // read and decode on a worker, then hand the region back to the main thread for activation
+    JobSystem *pJobSystem = g_pEngine->GetJobSystem();
+    pJobSystem->Run([this, pJobSystem, pRegion]()
+    {
+        pRegion->DecodePendingLoad();
+
+        pJobSystem->Run([this, pRegion]()
+        {
+            m_regionsToActivate.Add(pRegion);
+        }, m_pRegionLoadJobCounter, JOB_AFFINITY_MAIN_THREAD);
+    }, m_pRegionLoadJobCounter);
+}
+
+void Map::ActivatePendingRegions(float timeBudget)
+{
+    // decoded regions are added to the list by main thread jobs, so no locking is needed
+    if (m_regionsToActivate.IsEmpty())
+        return;
+
+    Timer budgetTimer;
+    uint32 regionIndex = 0;
+    for (; regionIndex < m_regionsToActivate.GetSize(); regionIndex++)
+    {
+        // a region that runs out of budget is continued next frame
+        float loadLatency;
+        if (!m_regionsToActivate[regionIndex]->ActivatePendingLoad(budgetTimer, timeBudget, &loadLatency))
+            break;
+
+        m_streamingStats.PendingRegionLoads--;
+        if (loadLatency >= 0.0f)
+            UpdateStreamingStats(loadLatency);
+    }
+
+    if (regionIndex != 0)
+        m_regionsToActivate.RemoveRange(0, regionIndex);
+}
+
+void Map::CancelPendingRegionLoads()
+{
+    // the jobs hold pointers to the regions, so they have to finish first
+    g_pEngine->GetJobSystem()->WaitFor(m_pRegionLoadJobCounter);
+    for (uint32 i = 0; i < m_regionsToActivate.GetSize(); i++)
+        m_regionsToActivate[i]->CancelPendingLoad();
+
+    m_regionsToActivate.Clear();
+    m_streamingStats.PendingRegionLoads = 0;
+}
+
+void Map::UpdateStreamingStats(float loadLatency)
+{
+    m_streamingStats.RegionsLoaded++;
+    m_streamingStats.LastLoadLatency = loadLatency;
+    m_streamingStats.AverageLoadLatency += (loadLatency - m_streamingStats.AverageLoadLatency) / (float)m_streamingStats.RegionsLoaded;
+    m_streamingStats.MaxLoadLatency = Max(m_streamingStats.MaxLoadLatency, loadLatency);
 }
 
 bool Map::LoadRegionsHeader(ProgressCallbacks *pProgressCallbacks)
@@ -398,12 +568,6 @@ bool Map::LoadGlobalEntities(ProgressCallbacks *pProgressCallbacks)
 
 uint32 Map::CreateEntitiesFromStream(ByteStream *pStream, uint32 entityCount, uint32 entityDataSize, PODArray<uint32> *pOutDynamicEntityIDArray, PODArray<Brush *> *pOutStaticObjectsArray, ProgressCallbacks *pProgressCallbacks)
 {
-    SmallString objectName;
-    SmallString componentName;
-
-    // create reader
-    BinaryReader binaryReader(pStream);
-
     // initalize progress
     pProgressCallbacks->SetProgressRange(entityCount);
     pProgressCallbacks->SetProgressValue(0);
@@ -412,196 +576,192 @@ uint32 Map::CreateEntitiesFromStream(ByteStream *pStream, uint32 entityCount, ui
     uint32 createdEntityCount = 0;
     for (uint32 i = 0; i < entityCount; i++)
     {
-        DF_MAP_ENTITY_HEADER entityHeader;
-        if (!binaryReader.SafeReadType(&entityHeader) || entityHeader.HeaderSize != sizeof(entityHeader))
+        if (!CreateEntityFromStream(pStream, pOutDynamicEntityIDArray, pOutStaticObjectsArray, pProgressCallbacks, &createdEntityCount))
             return createdEntityCount;
+    }
 
-        // calculate offset to next entity
-        uint64 nextEntityOffset = binaryReader.GetStreamPosition() + entityHeader.EntitySize + entityHeader.ComponentsSize;
+    // ok
+    return createdEntityCount;
+}
 
-        // read the entity name
-        if (!binaryReader.SafeReadFixedString(entityHeader.EntityNameLength, &objectName))
-            return createdEntityCount;
+bool Map::CreateEntityFromStream(ByteStream *pStream, PODArray<uint32> *pOutDynamicEntityIDArray, PODArray<Brush *> *pOutStaticObjectsArray, ProgressCallbacks *pProgressCallbacks, uint32 *pCreatedEntityCount)
+{
+    SmallString objectName;
+    SmallString componentName;
+
+    // create reader
+    BinaryReader binaryReader(pStream);
+
+    DF_MAP_ENTITY_HEADER entityHeader;
+    if (!binaryReader.SafeReadType(&entityHeader) || entityHeader.HeaderSize != sizeof(entityHeader))
+        return false;
+
+    // calculate offset to next entity
+    uint64 nextEntityOffset = binaryReader.GetStreamPosition() + entityHeader.EntitySize + entityHeader.ComponentsSize;
+
+    // read the entity name
+    if (!binaryReader.SafeReadFixedString(entityHeader.EntityNameLength, &objectName))
+        return false;
+
+    // deserialize the entity object
+    Object *pObject = m_pClassTable->UnserializeObject(pStream, entityHeader.EntityTypeIndex);
+    if (pObject == nullptr)
+    {
+        // creation failed.. or corruption.. could be either.
+        pProgressCallbacks->DisplayFormattedWarning("Failed to deserialize object '%s' (type index %u)", objectName.GetCharArray(), entityHeader.EntityTypeIndex);
+        return binaryReader.SafeSeekAbsolute(nextEntityOffset);
+    }
+
+    // should be the correct type
+    if (pObject->IsDerived(OBJECT_TYPEINFO(Brush)))
+    {
+        Brush *pBrush = pObject->Cast<Brush>();
 
-        // deserialize the entity object
-        Object *pObject = m_pClassTable->UnserializeObject(pStream, entityHeader.EntityTypeIndex);
-        if (pObject == nullptr)
+        // shouldn't have any components
+        if (entityHeader.ComponentCount > 0)
         {
-            // creation failed.. or corruption.. could be either.
-            pProgressCallbacks->DisplayFormattedWarning("Failed to deserialize object '%s' (type index %u)", objectName.GetCharArray(), entityHeader.EntityTypeIndex);
-            if (!binaryReader.SafeSeekAbsolute(nextEntityOffset))
-                return createdEntityCount;
-            else
-                continue;
+            pProgressCallbacks->DisplayFormattedWarning("Brush '%s' has components on a brush type.", objectName.GetCharArray());
+            pBrush->Release();
+
+            return binaryReader.SafeSeekAbsolute(nextEntityOffset);
         }
 
-        // should be the correct type
-        if (pObject->IsDerived(OBJECT_TYPEINFO(Brush)))
+        // finalize it
+        if (!pBrush->Initialize())
         {
-            Brush *pBrush = pObject->Cast<Brush>();
+            pProgressCallbacks->DisplayFormattedWarning("Failed to initialize Brush '%s'.", objectName.GetCharArray());
+            pBrush->Release();
 
-            // shouldn't have any components
-            if (entityHeader.ComponentCount > 0)
-            {
-                pProgressCallbacks->DisplayFormattedWarning("Brush '%s' has components on a brush type.", objectName.GetCharArray());
-                pBrush->Release();
+            return binaryReader.SafeSeekAbsolute(nextEntityOffset);
+        }
 
-                if (!binaryReader.SafeSeekAbsolute(nextEntityOffset))
-                    return createdEntityCount;
-                else
-                    continue;
-            }
+        // store it
+        if (pOutStaticObjectsArray != nullptr)
+        {
+            pBrush->AddRef();
+            pOutStaticObjectsArray->Add(pBrush);
+        }
 
-            // finalize it
-            if (!pBrush->Initialize())
-            {
-                pProgressCallbacks->DisplayFormattedWarning("Failed to initialize Brush '%s'.", objectName.GetCharArray());
-                pBrush->Release();
+        // and add it to the world
+        m_pWorld->AddBrush(pBrush);
+        pBrush->Release();
+        (*pCreatedEntityCount)++;
+    }
+    else if (pObject->IsDerived(OBJECT_TYPEINFO(Entity)))
+    {
+        Entity *pEntity = pObject->Cast<Entity>();
+        uint32 entityID = m_pWorld->AllocateEntityID();
 
-                if (!binaryReader.SafeSeekAbsolute(nextEntityOffset))
-                    return createdEntityCount;
-                else
-                    continue;
-            }
+        // construct the entity
+        if (!pEntity->Initialize(entityID, objectName))
+        {
+            pProgressCallbacks->DisplayFormattedWarning("Failed to initialize Entity '%s'.", objectName.GetCharArray());
+            pEntity->Release();
 
-            // store it
-            if (pOutStaticObjectsArray != nullptr)
+            return binaryReader.SafeSeekAbsolute(nextEntityOffset);
+        }
+
+        // deserialize any components
+        for (uint32 componentIndex = 0; componentIndex < entityHeader.ComponentCount; componentIndex++)
+        {
+            DF_MAP_ENTITY_COMPONENT_HEADER componentHeader;
+            if (!binaryReader.SafeReadType(&componentHeader))
             {
-                pBrush->AddRef();
-                pOutStaticObjectsArray->Add(pBrush);
+                pEntity->Release();
+                return false;
             }
 
-            // and add it to the world
-            m_pWorld->AddBrush(pBrush);
-            pBrush->Release();
-            createdEntityCount++;
-        }
-        else if (pObject->IsDerived(OBJECT_TYPEINFO(Entity)))
-        {
-            Entity *pEntity = pObject->Cast<Entity>();
-            uint32 entityID = m_pWorld->AllocateEntityID();
+            // calc offset to next component
+            uint64 nextComponentOffset = binaryReader.GetStreamPosition() + componentHeader.ComponentSize;
 
-            // construct the entity
-            if (!pEntity->Initialize(entityID, objectName))
+            // read component name
+            if (!binaryReader.SafeReadFixedString(componentHeader.ComponentNameLength, &componentName))
             {
-                pProgressCallbacks->DisplayFormattedWarning("Failed to initialize Entity '%s'.", objectName.GetCharArray());
                 pEntity->Release();
-
-                if (!binaryReader.SafeSeekAbsolute(nextEntityOffset))
-                    return createdEntityCount;
-                else
-                    continue;
+                return false;
             }
 
-            // deserialize any components
-            for (uint32 componentIndex = 0; componentIndex < entityHeader.ComponentCount; componentIndex++)
+            // deserialize the component object
+            Object *pComponentObject = m_pClassTable->UnserializeObject(pStream, componentHeader.ComponentTypeIndex);
+            if (pComponentObject == nullptr)
             {
-                DF_MAP_ENTITY_COMPONENT_HEADER componentHeader;
-                if (!binaryReader.SafeReadType(&componentHeader))
-                {
-                    pEntity->Release();
-                    return createdEntityCount;
-                }
+                pProgressCallbacks->DisplayFormattedWarning("Failed to deserialize component '%s' of entity '%s'.", componentName.GetCharArray(), objectName.GetCharArray());
 
-                // calc offset to next component
-                uint64 nextComponentOffset = binaryReader.GetStreamPosition() + componentHeader.ComponentSize;
-
-                // read component name
-                if (!binaryReader.SafeReadFixedString(componentHeader.ComponentNameLength, &componentName))
+                if (!binaryReader.SafeSeekAbsolute(nextComponentOffset))
                 {
                     pEntity->Release();
-                    return createdEntityCount;
+                    return false;
                 }
-
-                // deserialize the component object
-                Object *pComponentObject = m_pClassTable->UnserializeObject(pStream, componentHeader.ComponentTypeIndex);
-                if (pComponentObject == nullptr)
+                else
                 {
-                    pProgressCallbacks->DisplayFormattedWarning("Failed to deserialize component '%s' of entity '%s'.", componentName.GetCharArray(), objectName.GetCharArray());
-
-                    if (!binaryReader.SafeSeekAbsolute(nextComponentOffset))
-                    {
-                        pEntity->Release();
-                        return createdEntityCount;
-                    }
-                    else
-                    {
-                        continue;
-                    }
+                    continue;
                 }
+            }
 
-                // if not a component, skip it
-                if (!pComponentObject->IsDerived(OBJECT_TYPEINFO(Component)))
+            // if not a component, skip it
+            if (!pComponentObject->IsDerived(OBJECT_TYPEINFO(Component)))
+            {
+                pProgressCallbacks->DisplayFormattedWarning("Failed to deserialize component '%s' of entity '%s' is an invalid type '%s'.", componentName.GetCharArray(), objectName.GetCharArray(), pComponentObject->GetObjectTypeInfo()->GetTypeName());
+                pComponentObject->GetObjectTypeInfo()->GetFactory()->DeleteObject(pComponentObject);
+
+                if (!binaryReader.SafeSeekAbsolute(nextComponentOffset))
                 {
-                    pProgressCallbacks->DisplayFormattedWarning("Failed to deserialize component '%s' of entity '%s' is an invalid type '%s'.", componentName.GetCharArray(), objectName.GetCharArray(), pComponentObject->GetObjectTypeInfo()->GetTypeName());
-                    pComponentObject->GetObjectTypeInfo()->GetFactory()->DeleteObject(pComponentObject);
-
-                    if (!binaryReader.SafeSeekAbsolute(nextComponentOffset))
-                    {
-                        pEntity->Release();
-                        return createdEntityCount;
-                    }
-                    else
-                    {
-                        continue;
-                    }
+                    pEntity->Release();
+                    return false;
                 }
-
-                // initialize the component
-                Component *pComponent = pComponentObject->Cast<Component>();
-                if (!pComponent->Initialize())
+                else
                 {
-                    pProgressCallbacks->DisplayFormattedWarning("Failed to initialize Component '%s' of entity '%s'.", componentName.GetCharArray(), objectName.GetCharArray());
-                    pComponent->Release();
-
-                    if (!binaryReader.SafeSeekAbsolute(nextComponentOffset))
-                    {
-                        pEntity->Release();
-                        return createdEntityCount;
-                    }
-                    else
-                    {
-                        continue;
-                    }
+                    continue;
                 }
+            }
 
-                // add it to the entity
-                pEntity->AddComponent(pComponent);
+            // initialize the component
+            Component *pComponent = pComponentObject->Cast<Component>();
+            if (!pComponent->Initialize())
+            {
+                pProgressCallbacks->DisplayFormattedWarning("Failed to initialize Component '%s' of entity '%s'.", componentName.GetCharArray(), objectName.GetCharArray());
                 pComponent->Release();
 
-                // seek to next
                 if (!binaryReader.SafeSeekAbsolute(nextComponentOffset))
                 {
                     pEntity->Release();
-                    return createdEntityCount;
+                    return false;
+                }
+                else
+                {
+                    continue;
                 }
             }
 
-            if (pOutDynamicEntityIDArray != nullptr)
-                pOutDynamicEntityIDArray->Add(pEntity->GetEntityID());
+            // add it to the entity
+            pEntity->AddComponent(pComponent);
+            pComponent->Release();
 
-            m_pWorld->AddEntity(pEntity);
-            createdEntityCount++;
-            pEntity->Release();
+            // seek to next
+            if (!binaryReader.SafeSeekAbsolute(nextComponentOffset))
+            {
+                pEntity->Release();
+                return false;
+            }
         }
-        else
-        {
-            pProgressCallbacks->DisplayFormattedWarning("Object '%s' is an invalid type '%s'.", objectName.GetCharArray(), pObject->GetObjectTypeInfo()->GetTypeName());
-            pObject->GetObjectTypeInfo()->GetFactory()->DeleteObject(pObject);
 
-            if (!binaryReader.SafeSeekAbsolute(nextEntityOffset))
-                return createdEntityCount;
-            else
-                continue;
-        }
+        if (pOutDynamicEntityIDArray != nullptr)
+            pOutDynamicEntityIDArray->Add(pEntity->GetEntityID());
 
-        // seek to the next object
-        if (!binaryReader.SafeSeekAbsolute(nextEntityOffset))
-            return createdEntityCount;
+        m_pWorld->AddEntity(pEntity);
+        (*pCreatedEntityCount)++;
+        pEntity->Release();
     }
+    else
+    {
+        pProgressCallbacks->DisplayFormattedWarning("Object '%s' is an invalid type '%s'.", objectName.GetCharArray(), pObject->GetObjectTypeInfo()->GetTypeName());
+        pObject->GetObjectTypeInfo()->GetFactory()->DeleteObject(pObject);
 
-    // ok
-    return createdEntityCount;
+        return binaryReader.SafeSeekAbsolute(nextEntityOffset);
+    }
+
+    // seek to the next object
+    return binaryReader.SafeSeekAbsolute(nextEntityOffset);
 }
 
 bool Map::LoadRegion(int32 regionX, int32 regionY, ProgressCallbacks *pProgressCallbacks /* = ProgressCallbacks::NullProgressCallback */)
@@ -615,17 +775,14 @@ bool Map::LoadRegion(int32 regionX, int32 regionY, ProgressCallbacks *pProgressC
     }
 
     MapRegion *pRegion = pMember->Value;
+    if (pRegion->IsLoadPending())
+        FinishStreaming();
+
     if (!pRegion->IsLoaded())
     {
-        PathString fileName;
-        fileName.Format("region_%i_%i.0", regionX, regionY);
-
-        AutoReleasePtr<ByteStream> pStream = m_pMapArchive->OpenFile(fileName, BYTESTREAM_OPEN_READ | BYTESTREAM_OPEN_STREAMED);
+        AutoReleasePtr<ByteStream> pStream = ReadRegionFile(regionX, regionY, 0);
         if (pStream == NULL)
-        {
-            Log_WarningPrintf("Map::LoadRegion: Could not open region file for (%i, %i) '%s'", regionX, regionY, fileName.GetCharArray());
             return false;
-        }
 
         if (!pRegion->LoadRegion(pStream, 0, pProgressCallbacks))
         {
@@ -649,6 +806,9 @@ bool Map::ChangeRegionLOD(int32 regionX, int32 regionY, int32 newLOD, ProgressCa
     }
 
     MapRegion *pRegion = pMember->Value;
+    if (pRegion->IsLoadPending())
+        FinishStreaming();
+
     if (pRegion->GetLoadedLODLevel() == newLOD)
         return true;
 
@@ -662,15 +822,9 @@ bool Map::ChangeRegionLOD(int32 regionX, int32 regionY, int32 newLOD, ProgressCa
     // handle new data
     if (newLOD >= 0)
     {
-        PathString fileName;
-        fileName.Format("region_%i_%i.%u", regionX, regionY, newLOD);
-
-        AutoReleasePtr<ByteStream> pStream = m_pMapArchive->OpenFile(fileName, BYTESTREAM_OPEN_READ | BYTESTREAM_OPEN_STREAMED);
+        AutoReleasePtr<ByteStream> pStream = ReadRegionFile(regionX, regionY, newLOD);
         if (pStream == NULL)
-        {
-            Log_WarningPrintf("Map::LoadRegion: Could not open region file for (%i, %i, LOD %i), '%s'", regionX, regionY, newLOD, fileName.GetCharArray());
             return false;
-        }
 
         if (!pRegion->LoadRegion(pStream, (uint32)newLOD, pProgressCallbacks))
         {
@@ -694,6 +848,9 @@ void Map::UnloadRegion(int32 regionX, int32 regionY)
     }
 
     MapRegion *pRegion = pMember->Value;
+    if (pRegion->IsLoadPending())
+        FinishStreaming();
+
     if (pRegion->IsLoaded())
         pRegion->UnloadRegion();
 }
@@ -702,145 +859,279 @@ MapRegion::MapRegion(Map *pMap, int32 regionX, int32 regionY)
     : m_pMap(pMap),
       m_regionX(regionX),
       m_regionY(regionY),
-      m_loadedLODLevel(-1)
+      m_loadedLODLevel(-1),
+      m_pPendingLoad(nullptr)
 {
 
 }
 
 MapRegion::~MapRegion()
 {
-
+    if (m_pPendingLoad != nullptr)
+        CancelPendingLoad();
 }
 
 bool MapRegion::LoadRegion(ByteStream *pStream, uint32 lodLevel, ProgressCallbacks *pProgressCallbacks)
 {
-    uint64 nextChunkPosition;
-    DebugAssert(m_loadedLODLevel < 0);
+    DebugAssert(m_loadedLODLevel < 0 && m_pPendingLoad == nullptr);
+
+    // same path as streaming, without a time budget
+    PendingLoad load((int32)lodLevel);
+    load.pStream = pStream;
+    load.pStream->AddRef();
+    if (!DecodeRegion(&load))
+        load.Failed = true;
+    else
+        ActivateRegion(&load, Timer(), 0.0f, pProgressCallbacks);
+
+    bool result = !load.Failed;
+    ReleasePendingLoad(&load);
+    return result;
+}
+
+bool MapRegion::DecodeRegion(PendingLoad *pLoad)
+{
+    ByteStream *pStream = pLoad->pStream;
 
-    // prevent any double loading
-    m_loadedLODLevel = (int32)lodLevel;
-    
     // load header
     DF_MAP_REGION_HEADER regionHeader;
     if (!pStream->Read2(&regionHeader, sizeof(regionHeader)) || regionHeader.HeaderSize != sizeof(regionHeader))
     {
-        Log_ErrorPrintf("MapRegion::LoadRegion: Invalid region header");
+        Log_ErrorPrintf("MapRegion::DecodeRegion: Invalid region header");
         return false;
     }
 
     // bit of validation
-    if (regionHeader.RegionX != m_regionX || regionHeader.RegionY != m_regionY || regionHeader.LODLevel != lodLevel)
+    if (regionHeader.RegionX != m_regionX || regionHeader.RegionY != m_regionY || regionHeader.LODLevel != (uint32)pLoad->LODLevel)
     {
-        Log_ErrorPrintf("MapRegion::LoadRegion: Invalid region header");
+        Log_ErrorPrintf("MapRegion::DecodeRegion: Invalid region header");
         return false;
     }
 
     // read terrain sections
-    nextChunkPosition = pStream->GetPosition() + (uint64)regionHeader.TerrainDataSize;
-    if (regionHeader.TerrainSectionCount > 0)
+    uint64 nextChunkPosition = pStream->GetPosition() + (uint64)regionHeader.TerrainDataSize;
+    for (uint32 i = 0; i < regionHeader.TerrainSectionCount; i++)
     {
-        for (uint32 i = 0; i < regionHeader.TerrainSectionCount; i++)
+        DF_MAP_REGION_TERRAIN_SECTION_HEADER terrainSectionHeader;
+        if (!pStream->Read2(&terrainSectionHeader, sizeof(terrainSectionHeader)))
         {
-            DF_MAP_REGION_TERRAIN_SECTION_HEADER terrainSectionHeader;
-            if (!pStream->Read2(&terrainSectionHeader, sizeof(terrainSectionHeader)))
-            {
-                Log_ErrorPrintf("MapRegion::LoadRegion: Failed to read terrain section header.");
-                return false;
-            }
+            Log_ErrorPrintf("MapRegion::DecodeRegion: Failed to read terrain section header.");
+            return false;
+        }
 
-            TerrainSection *pTerrainSection = new TerrainSection(&m_pMap->m_terrainParameters, terrainSectionHeader.SectionX, terrainSectionHeader.SectionY, terrainSectionHeader.LODLevel);
-            if (!pTerrainSection->LoadFromStream(pStream))
-            {
-                Log_ErrorPrintf("MapRegion::LoadRegion: Failed to load terrain section.");
-                delete pTerrainSection;
-                return false;
-            }
+        TerrainSection *pTerrainSection = new TerrainSection(&m_pMap->m_terrainParameters, terrainSectionHeader.SectionX, terrainSectionHeader.SectionY, terrainSectionHeader.LODLevel);
+        if (!pTerrainSection->LoadFromStream(pStream))
+        {
+            Log_ErrorPrintf("MapRegion::DecodeRegion: Failed to load terrain section.");
+            delete pTerrainSection;
+            return false;
+        }
 
-            // remove me
-            if (terrainSectionHeader.SectionX == 0 && terrainSectionHeader.SectionY == 0)
-            {
-                AutoReleasePtr<const StaticMesh> pStaticMesh = g_pResourceManager->GetStaticMesh("models/terrain/grass_blades");
-                int32 idx = pTerrainSection->AddDetailMesh(pStaticMesh, 30.0f);
-                const uint32 XN = 200;
-                const uint32 YN = 300;
-                for (uint32 x = 0; x < XN; x++)
-                {
-                    for (uint32 y = 0; y < YN; y++)
-                    {
-                        pTerrainSection->AddDetailMeshInstance(idx, x / (float)XN, y / (float)YN, 1.0f, (float)((x * y) % 360));
-                    }
-                }
-            }
+        // create data struct
+        RegionTerrainSection sectionData;
+        sectionData.pData = pTerrainSection;
 
-            // create data struct
-            RegionTerrainSection sectionData;
-            sectionData.pData = pTerrainSection;
+        // create collision shape and object, the translation is the base position of the section with no height modification
+        sectionData.pCollisionShape = new TerrainSectionCollisionShape(&m_pMap->m_terrainParameters, pTerrainSection);
+        sectionData.pCollisionObject = new Physics::StaticObject(0, sectionData.pCollisionShape, TerrainSectionCollisionShape::GetSectionTransform(&m_pMap->m_terrainParameters, pTerrainSection));
+        sectionData.pRenderProxy = nullptr;
 
-            // create collision shape and insert the object, the translation is the base position of the section with no height modification
-            sectionData.pCollisionShape = new TerrainSectionCollisionShape(&m_pMap->m_terrainParameters, pTerrainSection);
-            sectionData.pCollisionObject = new Physics::StaticObject(0, sectionData.pCollisionShape, TerrainSectionCollisionShape::GetSectionTransform(&m_pMap->m_terrainParameters, pTerrainSection));
-            m_pMap->m_pWorld->GetPhysicsWorld()->AddObject(sectionData.pCollisionObject);               
+        // store it, it is added to the world on the main thread
+        pLoad->TerrainSections.Add(sectionData);
+    }
 
-            // create renderer
-            if (m_pMap->m_pTerrainRenderer != nullptr)
+    // check position
+    if (pStream->GetPosition() != nextChunkPosition && !pStream->SeekAbsolute(nextChunkPosition))
+    {
+        Log_ErrorPrintf("MapRegion::DecodeRegion: Stream not in correct position after terrain load, and seek failed.");
+        return false;
+    }
+
+    // entities are created when the region is activated
+    pLoad->EntityCount = regionHeader.EntityCount;
+    pLoad->EntityDataEnd = pStream->GetPosition() + (uint64)regionHeader.EntityDataSize;
+    return true;
+}
+
+bool MapRegion::ActivateRegion(PendingLoad *pLoad, const Timer &budgetTimer, float timeBudget, ProgressCallbacks *pProgressCallbacks)
+{
+    // the old level of detail stays in the world until the new one is completely in, so the region never has a hole in it
+
+    // terrain sections
+    while (pLoad->ActivatedTerrainSections < pLoad->TerrainSections.GetSize())
+    {
+        if (timeBudget > 0.0f && budgetTimer.GetTimeMilliseconds() >= timeBudget)
+            return false;
+
+        ActivateTerrainSection(&pLoad->TerrainSections[pLoad->ActivatedTerrainSections++]);
+    }
+
+    // entities, one at a time so the budget can be checked between them
+    if (pLoad->ActivatedEntities < pLoad->EntityCount)
+    {
+        pProgressCallbacks->PushState();
+        pProgressCallbacks->SetProgressRange(pLoad->EntityCount);
+        pProgressCallbacks->SetProgressValue(pLoad->ActivatedEntities);
+
+        uint32 createdEntityCount = 0;
+        while (pLoad->ActivatedEntities < pLoad->EntityCount)
+        {
+            if (timeBudget > 0.0f && budgetTimer.GetTimeMilliseconds() >= timeBudget)
             {
-                sectionData.pRenderProxy = m_pMap->m_pTerrainRenderer->CreateSectionRenderProxy(0, pTerrainSection);
-                if (sectionData.pRenderProxy == nullptr)
-                    Log_WarningPrintf("MapRegion::LoadRegion: Failed to create terrain section render proxy [%i, %i: %i, %i]", m_regionX, m_regionY, pTerrainSection->GetSectionX(), pTerrainSection->GetSectionY());
-                else
-                    m_pMap->m_pWorld->GetRenderWorld()->AddRenderable(sectionData.pRenderProxy);
+                pProgressCallbacks->PopState();
+                return false;
             }
-            else
+
+            // corrupt entity data, skip the rest of it
+            if (!m_pMap->CreateEntityFromStream(pLoad->pStream, &pLoad->EntityIDs, &pLoad->StaticObjects, pProgressCallbacks, &createdEntityCount))
             {
-                sectionData.pRenderProxy = nullptr;
+                Log_ErrorPrintf("MapRegion::ActivateRegion: Failed to read entity %u of region (%i, %i).", pLoad->ActivatedEntities, m_regionX, m_regionY);
+                pLoad->ActivatedEntities = pLoad->EntityCount;
+                break;
             }
 
-            // store it
-            m_terrainSections.Add(sectionData);
+            pLoad->ActivatedEntities++;
+            pProgressCallbacks->SetProgressValue(pLoad->ActivatedEntities);
         }
+
+        pProgressCallbacks->PopState();
     }
 
     // check position
-    if (pStream->GetPosition() != nextChunkPosition && !pStream->SeekAbsolute(nextChunkPosition))
+    if (pLoad->pStream->GetPosition() != pLoad->EntityDataEnd && !pLoad->pStream->SeekAbsolute(pLoad->EntityDataEnd))
     {
-        Log_ErrorPrintf("MapRegion::LoadRegion: Stream not in correct position after terrain load, and seek failed.");
-        return false;
+        Log_ErrorPrintf("MapRegion::ActivateRegion: Stream not in correct position after entity load, and seek failed.");
+        pLoad->Failed = true;
     }
 
-    // read entities
-    nextChunkPosition = pStream->GetPosition() + (uint64)regionHeader.EntityDataSize;
-    if (regionHeader.EntityCount > 0)
+    // everything is in, swap the old level of detail out
+    if (m_loadedLODLevel >= 0)
+        UnloadRegion();
+
+    for (uint32 i = 0; i < pLoad->TerrainSections.GetSize(); i++)
+        m_terrainSections.Add(pLoad->TerrainSections[i]);
+    for (uint32 i = 0; i < pLoad->EntityIDs.GetSize(); i++)
+        m_loadedEntityIDs.Add(pLoad->EntityIDs[i]);
+    for (uint32 i = 0; i < pLoad->StaticObjects.GetSize(); i++)
+        m_loadedStaticObjects.Add(pLoad->StaticObjects[i]);
+
+    // the region owns them now
+    pLoad->TerrainSections.Obliterate();
+    pLoad->ActivatedTerrainSections = 0;
+    pLoad->EntityIDs.Obliterate();
+    pLoad->StaticObjects.Obliterate();
+    m_loadedLODLevel = pLoad->LODLevel;
+    return true;
+}
+
+void MapRegion::ActivateTerrainSection(RegionTerrainSection *pSection)
+{
+    TerrainSection *pTerrainSection = pSection->pData;
+
+    // remove me
+    if (pTerrainSection->GetSectionX() == 0 && pTerrainSection->GetSectionY() == 0)
     {
-        pProgressCallbacks->PushState();
-        m_pMap->CreateEntitiesFromStream(pStream, regionHeader.EntityCount, regionHeader.EntityDataSize, &m_loadedEntityIDs, &m_loadedStaticObjects, pProgressCallbacks);
-        pProgressCallbacks->PopState();
+        AutoReleasePtr<const StaticMesh> pStaticMesh = g_pResourceManager->GetStaticMesh("models/terrain/grass_blades");
+        int32 idx = pTerrainSection->AddDetailMesh(pStaticMesh, 30.0f);
+        const uint32 XN = 200;
+        const uint32 YN = 300;
+        for (uint32 x = 0; x < XN; x++)
+        {
+            for (uint32 y = 0; y < YN; y++)
+            {
+                pTerrainSection->AddDetailMeshInstance(idx, x / (float)XN, y / (float)YN, 1.0f, (float)((x * y) % 360));
+            }
+        }
     }
 
-    // check position
-    if (pStream->GetPosition() != nextChunkPosition && !pStream->SeekAbsolute(nextChunkPosition))
+    // insert the collision object
+    m_pMap->m_pWorld->GetPhysicsWorld()->AddObject(pSection->pCollisionObject);
+
+    // create renderer
+    if (m_pMap->m_pTerrainRenderer != nullptr)
     {
-        Log_ErrorPrintf("MapRegion::LoadRegion: Stream not in correct position after entity load, and seek failed.");
-        return false;
+        pSection->pRenderProxy = m_pMap->m_pTerrainRenderer->CreateSectionRenderProxy(0, pTerrainSection);
+        if (pSection->pRenderProxy == nullptr)
+            Log_WarningPrintf("MapRegion::ActivateTerrainSection: Failed to create terrain section render proxy [%i, %i: %i, %i]", m_regionX, m_regionY, pTerrainSection->GetSectionX(), pTerrainSection->GetSectionY());
+        else
+            m_pMap->m_pWorld->GetRenderWorld()->AddRenderable(pSection->pRenderProxy);
     }
+}
 
-    // done
+void MapRegion::BeginPendingLoad(int32 lodLevel)
+{
+    DebugAssert(m_pPendingLoad == nullptr);
+    m_pPendingLoad = new PendingLoad(lodLevel);
+}
+
+void MapRegion::DecodePendingLoad()
+{
+    // runs on a worker, nothing here may touch the world
+    DebugAssert(m_pPendingLoad != nullptr);
+    m_pPendingLoad->pStream = m_pMap->ReadRegionFile(m_regionX, m_regionY, m_pPendingLoad->LODLevel);
+    if (m_pPendingLoad->pStream == nullptr || !DecodeRegion(m_pPendingLoad))
+        m_pPendingLoad->Failed = true;
+}
+
+bool MapRegion::ActivatePendingLoad(const Timer &budgetTimer, float timeBudget, float *pLoadLatency)
+{
+    DebugAssert(m_pPendingLoad != nullptr);
+
+    // failed loads leave the region as it was, it'll be tried again the next time it transitions
+    if (m_pPendingLoad->Failed)
+    {
+        Log_WarningPrintf("MapRegion::ActivatePendingLoad: Could not load region (%i, %i, LOD %i)", m_regionX, m_regionY, m_pPendingLoad->LODLevel);
+        *pLoadLatency = -1.0f;
+        CancelPendingLoad();
+        return true;
+    }
+
+    if (!ActivateRegion(m_pPendingLoad, budgetTimer, timeBudget, ProgressCallbacks::NullProgressCallback))
+        return false;
+
+    *pLoadLatency = (float)m_pPendingLoad->LatencyTimer.GetTimeMilliseconds();
+    Log_PerfPrintf("MapRegion::ActivatePendingLoad: Region (%i, %i) LOD %i loaded in %.2fms", m_regionX, m_regionY, m_pPendingLoad->LODLevel, *pLoadLatency);
+    CancelPendingLoad();
     return true;
 }
 
-void MapRegion::UnloadRegion()
+void MapRegion::CancelPendingLoad()
 {
-    // remove all static entities
-    for (uint32 i = 0; i < m_loadedStaticObjects.GetSize(); i++)
+    DebugAssert(m_pPendingLoad != nullptr);
+    ReleasePendingLoad(m_pPendingLoad);
+    delete m_pPendingLoad;
+    m_pPendingLoad = nullptr;
+}
+
+void MapRegion::ReleasePendingLoad(PendingLoad *pLoad)
+{
+    // a load cancelled part way through activation has some of its data in the world already
+    RemoveStaticObjects(pLoad->StaticObjects);
+    pLoad->EntityIDs.Obliterate();
+    for (uint32 i = 0; i < pLoad->ActivatedTerrainSections; i++)
+        RemoveTerrainSection(&pLoad->TerrainSections[i]);
+
+    for (uint32 i = pLoad->ActivatedTerrainSections; i < pLoad->TerrainSections.GetSize(); i++)
     {
-        Brush *pObject = m_loadedStaticObjects[i];
-        if (pObject->IsInWorld())
-            m_pMap->m_pWorld->RemoveBrush(pObject);
-        else
-            Log_WarningPrintf("MapRegion::UnloadRegion: StaticObject %p from region (%i, %i) was not in world at region unload time.", pObject, m_regionX, m_regionY);
+        RegionTerrainSection *pSection = &pLoad->TerrainSections[i];
+        pSection->pCollisionObject->Release();
+        pSection->pCollisionShape->Release();
+        pSection->pData->Release();
+    }
+    pLoad->TerrainSections.Obliterate();
+    pLoad->ActivatedTerrainSections = 0;
 
-        pObject->Release();
+    if (pLoad->pStream != nullptr)
+    {
+        pLoad->pStream->Release();
+        pLoad->pStream = nullptr;
     }
-    m_loadedStaticObjects.Obliterate();
+}
+
+void MapRegion::UnloadRegion()
+{
+    // remove all static entities
+    RemoveStaticObjects(m_loadedStaticObjects);
 
     // remove dynamic entities
 
@@ -863,23 +1154,39 @@ void MapRegion::UnloadRegion()
 
     // remove terrain sections
     for (uint32 i = 0; i < m_terrainSections.GetSize(); i++)
-    {
-        RegionTerrainSection *pSection = &m_terrainSections[i];
+        RemoveTerrainSection(&m_terrainSections[i]);
+    m_terrainSections.Obliterate();
 
-        if (pSection->pRenderProxy != nullptr)
-        {
-            m_pMap->m_pWorld->GetRenderWorld()->RemoveRenderable(pSection->pRenderProxy);
-            pSection->pRenderProxy->Release();
-        }
+    m_loadedLODLevel = -1;
+}
 
-        m_pMap->m_pWorld->GetPhysicsWorld()->RemoveObject(pSection->pCollisionObject);
-        pSection->pCollisionObject->Release();
-        pSection->pCollisionShape->Release();
+void MapRegion::RemoveStaticObjects(PODArray<Brush *> &staticObjects)
+{
+    for (uint32 i = 0; i < staticObjects.GetSize(); i++)
+    {
+        Brush *pObject = staticObjects[i];
+        if (pObject->IsInWorld())
+            m_pMap->m_pWorld->RemoveBrush(pObject);
+        else
+            Log_WarningPrintf("MapRegion::RemoveStaticObjects: StaticObject %p from region (%i, %i) was not in world at region unload time.", pObject, m_regionX, m_regionY);
 
-        pSection->pData->Release();
+        pObject->Release();
     }
-    m_terrainSections.Obliterate();
+    staticObjects.Obliterate();
+}
 
-    m_loadedLODLevel = -1;
+void MapRegion::RemoveTerrainSection(RegionTerrainSection *pSection)
+{
+    if (pSection->pRenderProxy != nullptr)
+    {
+        m_pMap->m_pWorld->GetRenderWorld()->RemoveRenderable(pSection->pRenderProxy);
+        pSection->pRenderProxy->Release();
+    }
+
+    m_pMap->m_pWorld->GetPhysicsWorld()->RemoveObject(pSection->pCollisionObject);
+    pSection->pCollisionObject->Release();
+    pSection->pCollisionShape->Release();
+
+    pSection->pData->Release();
 }
 
@@ -15,6 +15,17 @@ class TerrainSection;
 class TerrainSectionCollisionShape;
 class TerrainSectionRenderProxy;
 class TerrainRenderer;
+class JobCounter;
+
+// region streaming counters, latency is in milliseconds from the load being queued to the region being fully in the world
+struct MapStreamingStats
+{
+    uint32 PendingRegionLoads;
+    uint32 RegionsLoaded;
+    float LastLoadLatency;
+    float AverageLoadLatency;
+    float MaxLoadLatency;
+};
 
 class Map
 {
@@ -56,15 +67,33 @@ public:
     void LoadAllRegions(ProgressCallbacks *pProgressCallbacks = ProgressCallbacks::NullProgressCallback);
     void UnloadAllRegions();
 
-    // Streaming
+    // Streaming. Region loads are read and decoded on the job system, and added to the world a bit at a time
+    // each call. Regions ahead of moving observers are requested early.
     void HandleStreaming(ProgressCallbacks *pProgressCallbacks = ProgressCallbacks::NullProgressCallback);
 
+    // Waits for all queued region loads, and adds them to the world regardless of the time budget.
+    void FinishStreaming();
+
+    // Streaming statistics
+    const MapStreamingStats &GetStreamingStats() const { return m_streamingStats; }
+
 private:
     bool LoadRegionsHeader(ProgressCallbacks *pProgressCallbacks);
     bool LoadTerrainHeader(ProgressCallbacks *pProgressCallbacks);
     bool LoadGlobalEntities(ProgressCallbacks *pProgressCallbacks);
     
     uint32 CreateEntitiesFromStream(ByteStream *pStream, uint32 entityCount, uint32 entityDataSize, PODArray<uint32> *pOutDynamicEntityIDArray, PODArray<Brush *> *pOutStaticObjectsArray, ProgressCallbacks *pProgressCallbacks);
+    bool CreateEntityFromStream(ByteStream *pStream, PODArray<uint32> *pOutDynamicEntityIDArray, PODArray<Brush *> *pOutStaticObjectsArray, ProgressCallbacks *pProgressCallbacks, uint32 *pCreatedEntityCount);
+
+    // reads a region file into memory, safe to call from any thread
+    ByteStream *ReadRegionFile(int32 regionX, int32 regionY, int32 lodLevel);
+
+    // region streaming
+    void UpdateObserverPredictions();
+    void QueueRegionLoad(MapRegion *pRegion, int32 lodLevel);
+    void ActivatePendingRegions(float timeBudget);
+    void CancelPendingRegionLoads();
+    void UpdateStreamingStats(float loadLatency);
 
     String m_mapName;
     ZipArchive *m_pMapArchive;
@@ -79,6 +108,25 @@ private:
     typedef HashTable<int2, MapRegion *> MapRegionTable;
     MapRegionTable m_regions;
 
+    // the archive stream can only be read by one thread at a time
+    Mutex m_archiveLock;
+
+    // region loads in flight, regions are added to the activation list by a main thread job once their data is decoded
+    JobCounter *m_pRegionLoadJobCounter;
+    PODArray<MapRegion *> m_regionsToActivate;
+
+    // observer movement, for prefetching regions
+    struct ObserverPrediction
+    {
+        const void *Identifier;
+        float3 LastLocation;
+        float3 PredictedLocation;
+    };
+    MemArray<ObserverPrediction> m_observerPredictions;
+    Timer m_observerPredictionTimer;
+
+    MapStreamingStats m_streamingStats;
+
     DynamicWorld *m_pWorld;
 
     CIStringHashTable<uint32> m_mapEntityNameMapping;
@@ -102,17 +150,19 @@ public:
     const int32 GetLoadedLODLevel() const { return m_loadedLODLevel; }
     const bool IsLoaded() const { return (m_loadedLODLevel >= 0); }
 
+    const bool IsLoadPending() const { return (m_pPendingLoad != nullptr); }
+    const int32 GetPendingLODLevel() const { return (m_pPendingLoad != nullptr) ? m_pPendingLoad->LODLevel : -1; }
+
     bool LoadRegion(ByteStream *pStream, uint32 lodLevel, ProgressCallbacks *pProgressCallbacks);
     void UnloadRegion();
 
-private:
-    Map *m_pMap;
-    int32 m_regionX, m_regionY;
-    int32 m_loadedLODLevel;
-    
-    PODArray<uint32> m_loadedEntityIDs;
-    PODArray<Brush *> m_loadedStaticObjects;
+    // asynchronous loading, the data is decoded by DecodePendingLoad on a worker, and added to the world by ActivatePendingLoad
+    void BeginPendingLoad(int32 lodLevel);
+    void DecodePendingLoad();
+    bool ActivatePendingLoad(const Timer &budgetTimer, float timeBudget, float *pLoadLatency);
+    void CancelPendingLoad();
 
+private:
     struct RegionTerrainSection
     {
         TerrainSection *pData;
@@ -120,6 +170,49 @@ private:
         Physics::StaticObject *pCollisionObject;
         TerrainSectionRenderProxy *pRenderProxy;
     };
+
+    // region data decoded off the main thread, waiting to be added to the world
+    struct PendingLoad
+    {
+        PendingLoad(int32 lodLevel) : LODLevel(lodLevel), pStream(nullptr), Failed(false), ActivatedTerrainSections(0), EntityCount(0), ActivatedEntities(0), EntityDataEnd(0) {}
+
+        int32 LODLevel;
+        ByteStream *pStream;
+        bool Failed;
+        MemArray<RegionTerrainSection> TerrainSections;
+        uint32 ActivatedTerrainSections;
+        uint32 EntityCount;
+        uint32 ActivatedEntities;
+        uint64 EntityDataEnd;
+        Timer LatencyTimer;
+
+        // entities added to the world so far, they only become the region's once everything is in
+        PODArray<uint32> EntityIDs;
+        PODArray<Brush *> StaticObjects;
+    };
+
+    // reads the header and terrain sections, leaving the stream at the entity data
+    bool DecodeRegion(PendingLoad *pLoad);
+
+    // adds decoded terrain sections and entities to the world until the budget runs out, returns true once everything is
+    // added. the loaded level of detail is only swapped out for the new one then, so the region is never empty.
+    bool ActivateRegion(PendingLoad *pLoad, const Timer &budgetTimer, float timeBudget, ProgressCallbacks *pProgressCallbacks);
+    void ActivateTerrainSection(RegionTerrainSection *pSection);
+
+    // removes anything from a load that didn't finish activating from the world, and frees what was decoded
+    void ReleasePendingLoad(PendingLoad *pLoad);
+
+    // removal helpers, shared by unloading and cancelled loads
+    void RemoveStaticObjects(PODArray<Brush *> &staticObjects);
+    void RemoveTerrainSection(RegionTerrainSection *pSection);
+
+    Map *m_pMap;
+    int32 m_regionX, m_regionY;
+    int32 m_loadedLODLevel;
+    PendingLoad *m_pPendingLoad;
+    
+    PODArray<uint32> m_loadedEntityIDs;
+    PODArray<Brush *> m_loadedStaticObjects;
     MemArray<RegionTerrainSection> m_terrainSections;
 };
 
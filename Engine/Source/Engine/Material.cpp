@@ -179,8 +179,8 @@ bool Material::Load(const char *resourceName, ByteStream *pStream)
     // store static switch mask
     m_iShaderStaticSwitchMask = header.StaticSwitchMask;
 
-    // create on gpu
-    if (g_pRenderer != nullptr && !CreateDeviceResources())
+    // create on gpu, unless it is being loaded asynchronously
+    if (g_pRenderer != nullptr && !ResourceManager::IsDeviceResourceCreationDeferred() && !CreateDeviceResources())
     {
         Log_ErrorPrintf("GPU upload failed.");
         return false;
@@ -102,7 +102,7 @@ void ParticleSystemEmitter_Sprite::DrawQueueEntry(const InstanceRenderData *pEmi
 
         // ehh whatever fix me later please
         byte *pBuffer = new byte[bufferSize];
-        ParticleSystemSpriteVertexFactory::FillVertexBuffer(g_pRenderer->GetPlatform(), g_pRenderer->GetFeatureLevel(), pEmitterRenderData->VertexFactoryFlags, pCamera, reinterpret_cast<const ParticleData *>(pEmitterRenderData->pGPUStagingBuffer), pEmitterRenderData->ParticleCount, pBuffer, bufferSize);
+        ParticleSystemSpriteVertexFactory::FillVertexBuffer(g_pRenderer->GetPlatform(), g_pRenderer->GetFeatureLevel(), pEmitterRenderData->VertexFactoryFlags, pCamera, pEmitterRenderData->pStagingParticles, pBuffer, bufferSize);
         pCommandList->DrawUserPointer(pBuffer, vertexSize, nVertices);
         delete[] pBuffer;
     }
@@ -131,10 +131,9 @@ void ParticleSystemEmitter_Sprite::InitializeRenderData(InstanceRenderData *pEmi
     // initialize stuff based on flags
     if (vertexFactoryFlags & ParticleSystemSpriteVertexFactory::Flag_RenderBasic)
     {
-        // create 'staging' buffer
-        pEmitterRenderData->GPUStagingBufferSize = sizeof(ParticleData) * m_maxActiveParticles;
-        pEmitterRenderData->pGPUStagingBuffer = reinterpret_cast<byte *>(Y_malloc(pEmitterRenderData->GPUStagingBufferSize));
-
+        // create 'staging' copy of the particles
+        pEmitterRenderData->pStagingParticles = new ParticleBuffer();
+        pEmitterRenderData->pStagingParticles->Allocate(m_maxActiveParticles);
     }
     else if (vertexFactoryFlags & ParticleSystemSpriteVertexFactory::Flag_RenderInstancedQuads)
     {
@@ -156,7 +155,7 @@ void ParticleSystemEmitter_Sprite::UpdateRenderData(const InstanceData *pEmitter
     ParticleSystemEmitter::UpdateRenderData(pEmitterData, pEmitterRenderData);
 
     // count active particles
-    uint32 nActiveParticles = pEmitterData->ParticlesState[0].GetSize();
+    uint32 nActiveParticles = pEmitterData->Particles.GetParticleCount();
     pEmitterRenderData->ParticleCount = nActiveParticles;
     if (nActiveParticles == 0)
     {
@@ -167,10 +166,9 @@ void ParticleSystemEmitter_Sprite::UpdateRenderData(const InstanceData *pEmitter
     // render type specific
     if (pEmitterRenderData->VertexFactoryFlags & ParticleSystemSpriteVertexFactory::Flag_RenderBasic)
     {
-        // Write to GPU staging buffer
-        DebugAssert(pEmitterRenderData->GPUStagingBufferSize >= (sizeof(ParticleData) * nActiveParticles));
-        Y_memcpy(pEmitterRenderData->pGPUStagingBuffer, pEmitterData->ParticlesState[0].GetBasePointer(), sizeof(ParticleData) * nActiveParticles);
-        pEmitterRenderData->GPUStagingBufferUsage = sizeof(ParticleData) * nActiveParticles;
+        // Copy to the staging particles
+        DebugAssert(pEmitterRenderData->pStagingParticles->GetCapacity() >= nActiveParticles);
+        pEmitterRenderData->pStagingParticles->Copy(&pEmitterData->Particles);
     }
     else if (pEmitterRenderData->VertexFactoryFlags & ParticleSystemSpriteVertexFactory::Flag_RenderInstancedQuads)
     {
@@ -189,7 +187,7 @@ void ParticleSystemEmitter_Sprite::UpdateRenderData(const InstanceData *pEmitter
         // write to it
         if (!ParticleSystemSpriteVertexFactory::FillVertexBuffer(g_pRenderer->GetPlatform(), g_pRenderer->GetFeatureLevel(), 
                                                                  pEmitterRenderData->VertexFactoryFlags, nullptr, 
-                                                                 pEmitterData->ParticlesState[0].GetBasePointer(), nActiveParticles,
+                                                                 &pEmitterData->Particles,
                                                                  pMappedPointer, pEmitterRenderData->pGPUBuffer->GetDesc()->Size))
         {
             Log_ErrorPrintf("ParticleSystemEmitter_Sprite::UpdateRenderData: Failed to write to GPU buffer");
@@ -21,16 +21,28 @@ ParticleSystemModule_TimeBased::~ParticleSystemModule_TimeBased()
 
 }
 
-float ParticleSystemModule_TimeBased::GetCoefficient(const ParticleData *pParticle) const
+SIMDVector4f ParticleSystemModule_TimeBased::GetCoefficients(const ParticleBuffer *pParticles, uint32 firstIndex) const
 {
-    float coefficient = Min(pParticle->LifeRemaining / (pParticle->LifeSpan * m_timeFraction), 1.0f);
-    return EasingFunction::GetCoefficient((EasingFunction::Type)m_easingFunction, coefficient);
+    SIMDVector4f lifeRemaining(pParticles->LifeRemaining + firstIndex);
+    SIMDVector4f lifeSpan(pParticles->LifeSpan + firstIndex);
+    SIMDVector4f coefficients(SIMDVector4f(lifeRemaining / (lifeSpan * m_timeFraction)).Min(SIMDVector4f::One));
+
+    // linear easing is the identity, so the vector can be used as-is
+    if (m_easingFunction != EasingFunction::Linear)
+    {
+        EasingFunction::Type easingFunction = (EasingFunction::Type)m_easingFunction;
+        coefficients.Set(EasingFunction::GetCoefficient(easingFunction, coefficients.x),
+                         EasingFunction::GetCoefficient(easingFunction, coefficients.y),
+                         EasingFunction::GetCoefficient(easingFunction, coefficients.z),
+                         EasingFunction::GetCoefficient(easingFunction, coefficients.w));
+    }
+
+    return coefficients;
 }
 
-float ParticleSystemModule_TimeBased::GetInverseCoefficient(const ParticleData *pParticle) const
+SIMDVector4f ParticleSystemModule_TimeBased::GetInverseCoefficients(const ParticleBuffer *pParticles, uint32 firstIndex) const
 {
-    float coefficient = Min(pParticle->LifeRemaining / (pParticle->LifeSpan * m_timeFraction), 1.0f);
-    return 1.0f - EasingFunction::GetCoefficient((EasingFunction::Type)m_easingFunction, coefficient);
+    return SIMDVector4f::One - GetCoefficients(pParticles, firstIndex);
 }
 
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -332,12 +344,16 @@ bool ParticleSystemModule_LockToEmitter::CreateParticle(const ParticleSystemEmit
     return true;
 }
 
-void ParticleSystemModule_LockToEmitter::UpdateParticles(const ParticleSystemEmitter *pEmitter, const Transform *pBaseTransform, RandomNumberGenerator *pRNG, ParticleData *pParticles, uint32 nParticles, float deltaTime) const
+void ParticleSystemModule_LockToEmitter::UpdateParticles(const ParticleSystemEmitter *pEmitter, const Transform *pBaseTransform, RandomNumberGenerator *pRNG, ParticleBuffer *pParticles, float deltaTime) const
 {
+    float3 position(pBaseTransform->TransformPoint(m_offsetPosition));
+    uint32 nParticles = pParticles->GetParticleCount();
+
     for (uint32 particleIndex = 0; particleIndex < nParticles; particleIndex++)
     {
-        ParticleData *pParticle = &pParticles[particleIndex];
-        pParticle->Position = pBaseTransform->TransformPoint(m_offsetPosition);
+        pParticles->PositionX[particleIndex] = position.x;
+        pParticles->PositionY[particleIndex] = position.y;
+        pParticles->PositionZ[particleIndex] = position.z;
     }
 }
 
@@ -367,22 +383,34 @@ bool ParticleSystemModule_FadeOut::CreateParticle(const ParticleSystemEmitter *p
     return true;
 }
 
-void ParticleSystemModule_FadeOut::UpdateParticles(const ParticleSystemEmitter *pEmitter, const Transform *pBaseTransform, RandomNumberGenerator *pRNG, ParticleData *pParticles, uint32 nParticles, float deltaTime) const
+void ParticleSystemModule_FadeOut::UpdateParticles(const ParticleSystemEmitter *pEmitter, const Transform *pBaseTransform, RandomNumberGenerator *pRNG, ParticleBuffer *pParticles, float deltaTime) const
 {
-    for (uint32 particleIndex = 0; particleIndex < nParticles; particleIndex++)
-    {
-        ParticleData *pParticle = &pParticles[particleIndex];
+    uint32 nParticles = pParticles->GetParticleCount();
+    uint32 paddedParticleCount = pParticles->GetPaddedParticleCount();
 
-        // handle start fade-out time
-        float elapsed = pParticle->LifeSpan - pParticle->LifeRemaining;
-        if (elapsed < m_startFadeTime)
+    for (uint32 particleIndex = 0; particleIndex < paddedParticleCount; particleIndex += PARTICLE_BUFFER_SIMD_WIDTH)
+    {
+        SIMDVector4f lifeSpan(pParticles->LifeSpan + particleIndex);
+        SIMDVector4f lifeRemaining(pParticles->LifeRemaining + particleIndex);
+        SIMDVector4f elapsed(lifeSpan - lifeRemaining);
+        SIMDVector4f alpha((SIMDVector4f::One - (lifeRemaining / (lifeSpan - m_startFadeTime))) * 255.0f);
+
+        // pack into the colours, skipping the padding
+        float elapsedValues[PARTICLE_BUFFER_SIMD_WIDTH];
+        float alphaValues[PARTICLE_BUFFER_SIMD_WIDTH];
+        elapsed.Store(elapsedValues);
+        alpha.Store(alphaValues);
+
+        uint32 laneCount = Min(nParticles - particleIndex, (uint32)PARTICLE_BUFFER_SIMD_WIDTH);
+        for (uint32 lane = 0; lane < laneCount; lane++)
         {
-            pParticle->Color |= 0xFF000000;
-            continue;
+            // handle start fade-out time
+            uint32 &color = pParticles->Color[particleIndex + lane];
+            if (elapsedValues[lane] < m_startFadeTime)
+                color |= 0xFF000000;
+            else
+                color = (color & 0x00FFFFFF) | ((uint32)Math::Truncate(alphaValues[lane]) << 24);
         }
-
-        float fraction = 1.0f - (pParticle->LifeRemaining / (pParticle->LifeSpan - m_startFadeTime));
-        pParticle->Color = (pParticle->Color & 0x00FFFFFF) | ((uint32)Math::Truncate(fraction * 255.0f) << 24);
     }
 }
 
@@ -443,30 +471,39 @@ bool ParticleSystemModule_Flipbook::CreateParticle(const ParticleSystemEmitter *
     return true;
 }
 
-void ParticleSystemModule_Flipbook::UpdateParticles(const ParticleSystemEmitter *pEmitter, const Transform *pBaseTransform, RandomNumberGenerator *pRNG, ParticleData *pParticles, uint32 nParticles, float deltaTime) const
+void ParticleSystemModule_Flipbook::UpdateParticles(const ParticleSystemEmitter *pEmitter, const Transform *pBaseTransform, RandomNumberGenerator *pRNG, ParticleBuffer *pParticles, float deltaTime) const
 {
     // Precalculate texture coord range, and the number of frames
     float2 textureCoordinateRange(GetTextureCoordinateRange());
     uint32 frameCount = m_columns * m_rows;
+    uint32 nParticles = pParticles->GetParticleCount();
+    uint32 paddedParticleCount = pParticles->GetPaddedParticleCount();
     float inverseFlipInterval = 1.0f / m_flipInterval;
     
-    // For each particle, calculate the frame number
-    for (uint32 particleIndex = 0; particleIndex < nParticles; particleIndex++)
+    // For each group of particles, calculate the frame numbers
+    for (uint32 particleIndex = 0; particleIndex < paddedParticleCount; particleIndex += PARTICLE_BUFFER_SIMD_WIDTH)
     {
-        ParticleData *pParticle = &pParticles[particleIndex];
-        
         // calculate fraction of time complete
-        float timeElapsed = pParticle->LifeSpan - pParticle->LifeRemaining;
-        float frameNumberF = timeElapsed * inverseFlipInterval;
-        uint32 frameNumber = Math::Truncate(Math::Floor(frameNumberF)) % frameCount;
-        DebugAssert(frameNumber < frameCount);
-
-        // update the uv range for the particle
-        uint32 imageX = frameNumber % m_columns;
-        uint32 imageY = frameNumber / m_columns;
-        pParticle->MinTextureCoordinates.Set(textureCoordinateRange.x * (float)imageX,
-                                             textureCoordinateRange.y * (float)imageY);
-        pParticle->MaxTextureCoordinates.Set(pParticle->MinTextureCoordinates + textureCoordinateRange);
+        SIMDVector4f timeElapsed(SIMDVector4f(pParticles->LifeSpan + particleIndex) - SIMDVector4f(pParticles->LifeRemaining + particleIndex));
+        float frameNumbers[PARTICLE_BUFFER_SIMD_WIDTH];
+        (timeElapsed * inverseFlipInterval).Store(frameNumbers);
+
+        // update the uv range for the particles, skipping the padding
+        uint32 laneCount = Min(nParticles - particleIndex, (uint32)PARTICLE_BUFFER_SIMD_WIDTH);
+        for (uint32 lane = 0; lane < laneCount; lane++)
+        {
+            uint32 frameNumber = Math::Truncate(Math::Floor(frameNumbers[lane])) % frameCount;
+            DebugAssert(frameNumber < frameCount);
+
+            uint32 imageX = frameNumber % m_columns;
+            uint32 imageY = frameNumber / m_columns;
+            float minU = textureCoordinateRange.x * (float)imageX;
+            float minV = textureCoordinateRange.y * (float)imageY;
+            pParticles->MinTextureCoordinatesX[particleIndex + lane] = minU;
+            pParticles->MinTextureCoordinatesY[particleIndex + lane] = minV;
+            pParticles->MaxTextureCoordinatesX[particleIndex + lane] = minU + textureCoordinateRange.x;
+            pParticles->MaxTextureCoordinatesY[particleIndex + lane] = minV + textureCoordinateRange.y;
+        }
     }
 }
 
@@ -497,19 +534,30 @@ bool ParticleSystemModule_ColorOverTime::CreateParticle(const ParticleSystemEmit
     return true;
 }
 
-void ParticleSystemModule_ColorOverTime::UpdateParticles(const ParticleSystemEmitter *pEmitter, const Transform *pBaseTransform, RandomNumberGenerator *pRNG, ParticleData *pParticles, uint32 nParticles, float deltaTime) const
+void ParticleSystemModule_ColorOverTime::UpdateParticles(const ParticleSystemEmitter *pEmitter, const Transform *pBaseTransform, RandomNumberGenerator *pRNG, ParticleBuffer *pParticles, float deltaTime) const
 {
     // fixme: lerp on int
     float3 startColorFloat(PixelFormatHelpers::ConvertRGBAToFloat4(m_startColor).xyz());
     float3 endColorFloat(PixelFormatHelpers::ConvertRGBAToFloat4(m_endColor).xyz());
     float3 colorRange(endColorFloat - startColorFloat);
+    uint32 nParticles = pParticles->GetParticleCount();
+    uint32 paddedParticleCount = pParticles->GetPaddedParticleCount();
 
-    for (uint32 particleIndex = 0; particleIndex < nParticles; particleIndex++)
+    for (uint32 particleIndex = 0; particleIndex < paddedParticleCount; particleIndex += PARTICLE_BUFFER_SIMD_WIDTH)
     {
-        ParticleData *pParticle = &pParticles[particleIndex];
-
-        float timeFraction = GetInverseCoefficient(pParticle);
-        pParticle->Color = (pParticle->Color & 0xFF000000) | PixelFormatHelpers::ConvertFloat4ToRGBA(float4(startColorFloat + colorRange * timeFraction, 0.0f));
+        SIMDVector4f timeFraction(GetInverseCoefficients(pParticles, particleIndex));
+        float red[PARTICLE_BUFFER_SIMD_WIDTH], green[PARTICLE_BUFFER_SIMD_WIDTH], blue[PARTICLE_BUFFER_SIMD_WIDTH];
+        (timeFraction * colorRange.x + startColorFloat.x).Store(red);
+        (timeFraction * colorRange.y + startColorFloat.y).Store(green);
+        (timeFraction * colorRange.z + startColorFloat.z).Store(blue);
+
+        // pack into the colours, skipping the padding
+        uint32 laneCount = Min(nParticles - particleIndex, (uint32)PARTICLE_BUFFER_SIMD_WIDTH);
+        for (uint32 lane = 0; lane < laneCount; lane++)
+        {
+            uint32 &color = pParticles->Color[particleIndex + lane];
+            color = (color & 0xFF000000) | PixelFormatHelpers::ConvertFloat4ToRGBA(float4(red[lane], green[lane], blue[lane], 0.0f));
+        }
     }
 }
 
@@ -540,16 +588,25 @@ bool ParticleSystemModule_OpacityOverTime::CreateParticle(const ParticleSystemEm
     return true;
 }
 
-void ParticleSystemModule_OpacityOverTime::UpdateParticles(const ParticleSystemEmitter *pEmitter, const Transform *pBaseTransform, RandomNumberGenerator *pRNG, ParticleData *pParticles, uint32 nParticles, float deltaTime) const
+void ParticleSystemModule_OpacityOverTime::UpdateParticles(const ParticleSystemEmitter *pEmitter, const Transform *pBaseTransform, RandomNumberGenerator *pRNG, ParticleBuffer *pParticles, float deltaTime) const
 {
-    float opacityRange = m_endOpacity - m_startOpacity;
+    float startAlpha = m_startOpacity * 255.0f;
+    float alphaRange = (m_endOpacity - m_startOpacity) * 255.0f;
+    uint32 nParticles = pParticles->GetParticleCount();
+    uint32 paddedParticleCount = pParticles->GetPaddedParticleCount();
 
-    for (uint32 particleIndex = 0; particleIndex < nParticles; particleIndex++)
+    for (uint32 particleIndex = 0; particleIndex < paddedParticleCount; particleIndex += PARTICLE_BUFFER_SIMD_WIDTH)
     {
-        ParticleData *pParticle = &pParticles[particleIndex];
+        float alpha[PARTICLE_BUFFER_SIMD_WIDTH];
+        (GetInverseCoefficients(pParticles, particleIndex) * alphaRange + startAlpha).Store(alpha);
 
-        float particleOpacity = GetInverseCoefficient(pParticle) * opacityRange + m_startOpacity;
-        pParticle->Color = (pParticle->Color & 0x00FFFFFF) | ((uint32)Math::Clamp(Math::Truncate(particleOpacity * 255.0f), 0, 255) << 24);
+        // pack into the colours, skipping the padding
+        uint32 laneCount = Min(nParticles - particleIndex, (uint32)PARTICLE_BUFFER_SIMD_WIDTH);
+        for (uint32 lane = 0; lane < laneCount; lane++)
+        {
+            uint32 &color = pParticles->Color[particleIndex + lane];
+            color = (color & 0x00FFFFFF) | ((uint32)Math::Clamp(Math::Truncate(alpha[lane]), 0, 255) << 24);
+        }
     }
 }
 
@@ -578,18 +635,17 @@ ParticleSystemModule_SizeOverTime::~ParticleSystemModule_SizeOverTime()
 
 }
 
-void ParticleSystemModule_SizeOverTime::UpdateParticles(const ParticleSystemEmitter *pEmitter, const Transform *pBaseTransform, RandomNumberGenerator *pRNG, ParticleData *pParticles, uint32 nParticles, float deltaTime) const
+void ParticleSystemModule_SizeOverTime::UpdateParticles(const ParticleSystemEmitter *pEmitter, const Transform *pBaseTransform, RandomNumberGenerator *pRNG, ParticleBuffer *pParticles, float deltaTime) const
 {
     float widthRange = m_endWidth - m_startWidth;
     float heightRange = m_endHeight - m_startHeight;
+    uint32 paddedParticleCount = pParticles->GetPaddedParticleCount();
 
-    for (uint32 particleIndex = 0; particleIndex < nParticles; particleIndex++)
+    for (uint32 particleIndex = 0; particleIndex < paddedParticleCount; particleIndex += PARTICLE_BUFFER_SIMD_WIDTH)
     {
-        ParticleData *pParticle = &pParticles[particleIndex];
-
-        float fraction = GetInverseCoefficient(pParticle);
-        pParticle->Width = m_startWidth + widthRange * fraction;
-        pParticle->Height = m_startHeight + heightRange * fraction;
+        SIMDVector4f fraction(GetInverseCoefficients(pParticles, particleIndex));
+        (fraction * widthRange + m_startWidth).Store(pParticles->Width + particleIndex);
+        (fraction * heightRange + m_startHeight).Store(pParticles->Height + particleIndex);
     }
 }
 
@@ -612,15 +668,13 @@ ParticleSystemModule_RotationSpeed::~ParticleSystemModule_RotationSpeed()
 
 }
 
-void ParticleSystemModule_RotationSpeed::UpdateParticles(const ParticleSystemEmitter *pEmitter, const Transform *pBaseTransform, RandomNumberGenerator *pRNG, ParticleData *pParticles, uint32 nParticles, float deltaTime) const
+void ParticleSystemModule_RotationSpeed::UpdateParticles(const ParticleSystemEmitter *pEmitter, const Transform *pBaseTransform, RandomNumberGenerator *pRNG, ParticleBuffer *pParticles, float deltaTime) const
 {
     float rotationDelta = m_rotationSpeed * deltaTime;
+    uint32 paddedParticleCount = pParticles->GetPaddedParticleCount();
 
-    for (uint32 particleIndex = 0; particleIndex < nParticles; particleIndex++)
-    {
-        ParticleData *pParticle = &pParticles[particleIndex];
-        pParticle->Rotation += rotationDelta;
-    }
+    for (uint32 particleIndex = 0; particleIndex < paddedParticleCount; particleIndex += PARTICLE_BUFFER_SIMD_WIDTH)
+        (SIMDVector4f(pParticles->Rotation + particleIndex) + rotationDelta).Store(pParticles->Rotation + particleIndex);
 }
 
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -651,16 +705,44 @@ bool ParticleSystemModule_RotationOverTime::CreateParticle(const ParticleSystemE
     return true;
 }
 
-void ParticleSystemModule_RotationOverTime::UpdateParticles(const ParticleSystemEmitter *pEmitter, const Transform *pBaseTransform, RandomNumberGenerator *pRNG, ParticleData *pParticles, uint32 nParticles, float deltaTime) const
+void ParticleSystemModule_RotationOverTime::UpdateParticles(const ParticleSystemEmitter *pEmitter, const Transform *pBaseTransform, RandomNumberGenerator *pRNG, ParticleBuffer *pParticles, float deltaTime) const
 {
     float rotationRange = m_endRotation - m_startRotation;
+    uint32 paddedParticleCount = pParticles->GetPaddedParticleCount();
 
-    for (uint32 particleIndex = 0; particleIndex < nParticles; particleIndex++)
-    {
-        ParticleData *pParticle = &pParticles[particleIndex];
+    for (uint32 particleIndex = 0; particleIndex < paddedParticleCount; particleIndex += PARTICLE_BUFFER_SIMD_WIDTH)
+        (GetInverseCoefficients(pParticles, particleIndex) * rotationRange + m_startRotation).Store(pParticles->Rotation + particleIndex);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+DEFINE_OBJECT_TYPE_INFO(ParticleSystemModule_Gravity);
+DEFINE_OBJECT_GENERIC_FACTORY(ParticleSystemModule_Gravity);
+BEGIN_OBJECT_PROPERTY_MAP(ParticleSystemModule_Gravity)
+    PROPERTY_TABLE_MEMBER_FLOAT3("Acceleration", 0, offsetof(ParticleSystemModule_Gravity, m_acceleration), nullptr, nullptr)
+END_OBJECT_PROPERTY_MAP()
 
-        float particleRotation = GetInverseCoefficient(pParticle) * rotationRange + m_startRotation;
-        pParticle->Rotation = particleRotation;
+ParticleSystemModule_Gravity::ParticleSystemModule_Gravity()
+    : m_acceleration(0.0f, 0.0f, -10.0f)
+{
+
+}
+
+ParticleSystemModule_Gravity::~ParticleSystemModule_Gravity()
+{
+
+}
+
+void ParticleSystemModule_Gravity::UpdateParticles(const ParticleSystemEmitter *pEmitter, const Transform *pBaseTransform, RandomNumberGenerator *pRNG, ParticleBuffer *pParticles, float deltaTime) const
+{
+    float3 velocityDelta(m_acceleration * deltaTime);
+    uint32 paddedParticleCount = pParticles->GetPaddedParticleCount();
+
+    for (uint32 particleIndex = 0; particleIndex < paddedParticleCount; particleIndex += PARTICLE_BUFFER_SIMD_WIDTH)
+    {
+        (SIMDVector4f(pParticles->VelocityX + particleIndex) + velocityDelta.x).Store(pParticles->VelocityX + particleIndex);
+        (SIMDVector4f(pParticles->VelocityY + particleIndex) + velocityDelta.y).Store(pParticles->VelocityY + particleIndex);
+        (SIMDVector4f(pParticles->VelocityZ + particleIndex) + velocityDelta.z).Store(pParticles->VelocityZ + particleIndex);
     }
 }
 
@@ -688,6 +770,7 @@ void ParticleSystemModule::RegisterBuiltinModules()
     REGISTER_TYPE(ParticleSystemModule_SizeOverTime);
     REGISTER_TYPE(ParticleSystemModule_RotationSpeed);
     REGISTER_TYPE(ParticleSystemModule_RotationOverTime);
+    REGISTER_TYPE(ParticleSystemModule_Gravity);
 
 #undef REGISTER_TYPE
 }
@@ -18,11 +18,11 @@ public:
     void SetEasingFunction(EasingFunction::Type easingFunction) { m_easingFunction = easingFunction; }
 
 protected:
-    // Helper to get a coefficient for a particle's time, ie fraction of time passed
-    float GetCoefficient(const ParticleData *pParticle) const;
+    // Helper to get the coefficients for the times of the PARTICLE_BUFFER_SIMD_WIDTH particles at firstIndex, ie fraction of time passed
+    SIMDVector4f GetCoefficients(const ParticleBuffer *pParticles, uint32 firstIndex) const;
 
-    // Helper to get the inverse coefficient for a particle's time, ie fraction of time remaining
-    float GetInverseCoefficient(const ParticleData *pParticle) const;
+    // Helper to get the inverse coefficients for the times of the PARTICLE_BUFFER_SIMD_WIDTH particles at firstIndex, ie fraction of time remaining
+    SIMDVector4f GetInverseCoefficients(const ParticleBuffer *pParticles, uint32 firstIndex) const;
 
     float m_timeFraction;
     uint32 m_easingFunction;
@@ -261,7 +261,7 @@ public:
     void SetOffsetPosition(const float3 &offsetPosition) { m_offsetPosition = offsetPosition; }
 
     virtual bool CreateParticle(const ParticleSystemEmitter *pEmitter, const Transform *pBaseTransform, RandomNumberGenerator *pRNG, ParticleData *pParticle) const override;
-    virtual void UpdateParticles(const ParticleSystemEmitter *pEmitter, const Transform *pBaseTransform, RandomNumberGenerator *pRNG, ParticleData *pParticles, uint32 nParticles, float deltaTime) const override;
+    virtual void UpdateParticles(const ParticleSystemEmitter *pEmitter, const Transform *pBaseTransform, RandomNumberGenerator *pRNG, ParticleBuffer *pParticles, float deltaTime) const override;
 
 private:
     float3 m_offsetPosition;
@@ -280,7 +280,7 @@ public:
     virtual ~ParticleSystemModule_FadeOut();
 
     virtual bool CreateParticle(const ParticleSystemEmitter *pEmitter, const Transform *pBaseTransform, RandomNumberGenerator *pRNG, ParticleData *pParticle) const override;
-    virtual void UpdateParticles(const ParticleSystemEmitter *pEmitter, const Transform *pBaseTransform, RandomNumberGenerator *pRNG, ParticleData *pParticles, uint32 nParticles, float deltaTime) const override;
+    virtual void UpdateParticles(const ParticleSystemEmitter *pEmitter, const Transform *pBaseTransform, RandomNumberGenerator *pRNG, ParticleBuffer *pParticles, float deltaTime) const override;
 
 private:
     float m_startFadeTime;
@@ -309,7 +309,7 @@ public:
     virtual bool CreateParticle(const ParticleSystemEmitter *pEmitter, const Transform *pBaseTransform, RandomNumberGenerator *pRNG, ParticleData *pParticle) const override;
 
     // Update the texture coordinates of the particle to the next frame of the flipbook if enough time has passed
-    virtual void UpdateParticles(const ParticleSystemEmitter *pEmitter, const Transform *pBaseTransform, RandomNumberGenerator *pRNG, ParticleData *pParticles, uint32 nParticles, float deltaTime) const override;
+    virtual void UpdateParticles(const ParticleSystemEmitter *pEmitter, const Transform *pBaseTransform, RandomNumberGenerator *pRNG, ParticleBuffer *pParticles, float deltaTime) const override;
 
 private:
     // helper function to get the minimum/maximum texture coordinates of a frame
@@ -344,7 +344,7 @@ public:
     virtual bool CreateParticle(const ParticleSystemEmitter *pEmitter, const Transform *pBaseTransform, RandomNumberGenerator *pRNG, ParticleData *pParticle) const override;
 
     // Update the particle to the correct color
-    virtual void UpdateParticles(const ParticleSystemEmitter *pEmitter, const Transform *pBaseTransform, RandomNumberGenerator *pRNG, ParticleData *pParticles, uint32 nParticles, float deltaTime) const override;
+    virtual void UpdateParticles(const ParticleSystemEmitter *pEmitter, const Transform *pBaseTransform, RandomNumberGenerator *pRNG, ParticleBuffer *pParticles, float deltaTime) const override;
 
 private:
     uint32 m_startColor;
@@ -372,7 +372,7 @@ public:
     virtual bool CreateParticle(const ParticleSystemEmitter *pEmitter, const Transform *pBaseTransform, RandomNumberGenerator *pRNG, ParticleData *pParticle) const override;
 
     // Update the particle to the correct color
-    virtual void UpdateParticles(const ParticleSystemEmitter *pEmitter, const Transform *pBaseTransform, RandomNumberGenerator *pRNG, ParticleData *pParticles, uint32 nParticles, float deltaTime) const override;
+    virtual void UpdateParticles(const ParticleSystemEmitter *pEmitter, const Transform *pBaseTransform, RandomNumberGenerator *pRNG, ParticleBuffer *pParticles, float deltaTime) const override;
 
 private:
     float m_startOpacity;
@@ -402,7 +402,7 @@ public:
     void SetWidth(float startWidth, float endWidth) { m_startWidth = startWidth; m_endWidth = endWidth; }
     void SetHeight(float startHeight, float endHeight) { m_startHeight = startHeight; m_endHeight = endHeight; }
 
-    virtual void UpdateParticles(const ParticleSystemEmitter *pEmitter, const Transform *pBaseTransform, RandomNumberGenerator *pRNG, ParticleData *pParticles, uint32 nParticles, float deltaTime) const override;
+    virtual void UpdateParticles(const ParticleSystemEmitter *pEmitter, const Transform *pBaseTransform, RandomNumberGenerator *pRNG, ParticleBuffer *pParticles, float deltaTime) const override;
 
 private:
     float m_startWidth;
@@ -426,7 +426,7 @@ public:
     float GetRotationSpeed() const { return m_rotationSpeed; }
     void SetRotationSpeed(float rotationSpeed) { m_rotationSpeed = rotationSpeed; }
 
-    virtual void UpdateParticles(const ParticleSystemEmitter *pEmitter, const Transform *pBaseTransform, RandomNumberGenerator *pRNG, ParticleData *pParticles, uint32 nParticles, float deltaTime) const override;
+    virtual void UpdateParticles(const ParticleSystemEmitter *pEmitter, const Transform *pBaseTransform, RandomNumberGenerator *pRNG, ParticleBuffer *pParticles, float deltaTime) const override;
 
 private:
     float m_rotationSpeed;
@@ -451,10 +451,32 @@ public:
     void SetRotation(float startRotation, float endRotation) { m_startRotation = startRotation; m_endRotation = endRotation; }
 
     virtual bool CreateParticle(const ParticleSystemEmitter *pEmitter, const Transform *pBaseTransform, RandomNumberGenerator *pRNG, ParticleData *pParticle) const override;
-    virtual void UpdateParticles(const ParticleSystemEmitter *pEmitter, const Transform *pBaseTransform, RandomNumberGenerator *pRNG, ParticleData *pParticles, uint32 nParticles, float deltaTime) const override;
+    virtual void UpdateParticles(const ParticleSystemEmitter *pEmitter, const Transform *pBaseTransform, RandomNumberGenerator *pRNG, ParticleBuffer *pParticles, float deltaTime) const override;
 
 private:
     float m_startRotation;
     float m_endRotation;
 };
 
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+class ParticleSystemModule_Gravity : public ParticleSystemModule
+{
+    DECLARE_OBJECT_TYPE_INFO(ParticleSystemModule_Gravity, ParticleSystemModule);
+    DECLARE_OBJECT_GENERIC_FACTORY(ParticleSystemModule_Gravity);
+    DECLARE_OBJECT_PROPERTY_MAP(ParticleSystemModule_Gravity);
+
+public:
+    ParticleSystemModule_Gravity();
+    virtual ~ParticleSystemModule_Gravity();
+
+    const float3 &GetAcceleration() const { return m_acceleration; }
+    void SetAcceleration(const float3 &acceleration) { m_acceleration = acceleration; }
+
+    // Accelerate the particles, the emitter moves them by their velocity
+    virtual void UpdateParticles(const ParticleSystemEmitter *pEmitter, const Transform *pBaseTransform, RandomNumberGenerator *pRNG, ParticleBuffer *pParticles, float deltaTime) const override;
+
+private:
+    float3 m_acceleration;
+};
+
@@ -0,0 +1,192 @@
+#include "Engine/PrecompiledHeader.h"
+#include "Engine/ParticleSystemCommon.h"
+
+ParticleBuffer::ParticleBuffer()
+    : m_pMemory(nullptr),
+      m_capacity(0),
+      m_particleCount(0)
+{
+    Free();
+}
+
+ParticleBuffer::~ParticleBuffer()
+{
+    Free();
+}
+
+template<typename T>
+static T *AllocateParticleStream(byte *&pMemory, uint32 paddedCapacity)
+{
+    // keep each stream on its own sse-aligned boundary
+    T *pStream = reinterpret_cast<T *>(pMemory);
+    pMemory += (sizeof(T) * paddedCapacity + (Y_SSE_ALIGNMENT - 1)) & ~(Y_SSE_ALIGNMENT - 1);
+    return pStream;
+}
+
+void ParticleBuffer::Allocate(uint32 capacity)
+{
+    Free();
+    if (capacity == 0)
+        return;
+
+    // 18 four-byte streams, and two byte streams padded to the alignment
+    uint32 paddedCapacity = (capacity + (PARTICLE_BUFFER_SIMD_WIDTH - 1)) & ~(PARTICLE_BUFFER_SIMD_WIDTH - 1);
+    uint32 byteStreamSize = (paddedCapacity + (Y_SSE_ALIGNMENT - 1)) & ~(Y_SSE_ALIGNMENT - 1);
+    uint32 memorySize = (sizeof(float) * paddedCapacity * 18) + (byteStreamSize * 2);
+    m_pMemory = (byte *)Y_aligned_malloc(memorySize, Y_SSE_ALIGNMENT);
+    Y_memzero(m_pMemory, memorySize);
+    m_capacity = capacity;
+
+    byte *pMemory = m_pMemory;
+    PositionX = AllocateParticleStream<float>(pMemory, paddedCapacity);
+    PositionY = AllocateParticleStream<float>(pMemory, paddedCapacity);
+    PositionZ = AllocateParticleStream<float>(pMemory, paddedCapacity);
+    VelocityX = AllocateParticleStream<float>(pMemory, paddedCapacity);
+    VelocityY = AllocateParticleStream<float>(pMemory, paddedCapacity);
+    VelocityZ = AllocateParticleStream<float>(pMemory, paddedCapacity);
+    Width = AllocateParticleStream<float>(pMemory, paddedCapacity);
+    Height = AllocateParticleStream<float>(pMemory, paddedCapacity);
+    Rotation = AllocateParticleStream<float>(pMemory, paddedCapacity);
+    Color = AllocateParticleStream<uint32>(pMemory, paddedCapacity);
+    MinTextureCoordinatesX = AllocateParticleStream<float>(pMemory, paddedCapacity);
+    MinTextureCoordinatesY = AllocateParticleStream<float>(pMemory, paddedCapacity);
+    MaxTextureCoordinatesX = AllocateParticleStream<float>(pMemory, paddedCapacity);
+    MaxTextureCoordinatesY = AllocateParticleStream<float>(pMemory, paddedCapacity);
+    LifeSpan = AllocateParticleStream<float>(pMemory, paddedCapacity);
+    LifeRemaining = AllocateParticleStream<float>(pMemory, paddedCapacity);
+    LightRange = AllocateParticleStream<float>(pMemory, paddedCapacity);
+    LightFalloff = AllocateParticleStream<float>(pMemory, paddedCapacity);
+    LightType = AllocateParticleStream<uint8>(pMemory, paddedCapacity);
+    LightParameter = AllocateParticleStream<uint8>(pMemory, paddedCapacity);
+    DebugAssert(pMemory <= m_pMemory + memorySize);
+}
+
+void ParticleBuffer::Free()
+{
+    if (m_pMemory != nullptr)
+        Y_aligned_free(m_pMemory);
+
+    m_pMemory = nullptr;
+    m_capacity = 0;
+    m_particleCount = 0;
+
+    PositionX = PositionY = PositionZ = nullptr;
+    VelocityX = VelocityY = VelocityZ = nullptr;
+    Width = Height = Rotation = nullptr;
+    Color = nullptr;
+    MinTextureCoordinatesX = MinTextureCoordinatesY = MaxTextureCoordinatesX = MaxTextureCoordinatesY = nullptr;
+    LifeSpan = LifeRemaining = nullptr;
+    LightType = LightParameter = nullptr;
+    LightRange = LightFalloff = nullptr;
+}
+
+uint32 ParticleBuffer::Add(const ParticleData &particle)
+{
+    DebugAssert(m_particleCount < m_capacity);
+    uint32 index = m_particleCount++;
+    Set(index, particle);
+    return index;
+}
+
+void ParticleBuffer::Get(uint32 index, ParticleData *pParticle) const
+{
+    DebugAssert(index < m_particleCount);
+    pParticle->Position.Set(PositionX[index], PositionY[index], PositionZ[index]);
+    pParticle->Velocity.Set(VelocityX[index], VelocityY[index], VelocityZ[index]);
+    pParticle->Width = Width[index];
+    pParticle->Height = Height[index];
+    pParticle->Rotation = Rotation[index];
+    pParticle->Color = Color[index];
+    pParticle->MinTextureCoordinates.Set(MinTextureCoordinatesX[index], MinTextureCoordinatesY[index]);
+    pParticle->MaxTextureCoordinates.Set(MaxTextureCoordinatesX[index], MaxTextureCoordinatesY[index]);
+    pParticle->LifeSpan = LifeSpan[index];
+    pParticle->LifeRemaining = LifeRemaining[index];
+    pParticle->LightType = LightType[index];
+    pParticle->LightParameter = LightParameter[index];
+    pParticle->LightRange = LightRange[index];
+    pParticle->LightFalloff = LightFalloff[index];
+}
+
+void ParticleBuffer::Set(uint32 index, const ParticleData &particle)
+{
+    DebugAssert(index < m_particleCount);
+    PositionX[index] = particle.Position.x;
+    PositionY[index] = particle.Position.y;
+    PositionZ[index] = particle.Position.z;
+    VelocityX[index] = particle.Velocity.x;
+    VelocityY[index] = particle.Velocity.y;
+    VelocityZ[index] = particle.Velocity.z;
+    Width[index] = particle.Width;
+    Height[index] = particle.Height;
+    Rotation[index] = particle.Rotation;
+    Color[index] = particle.Color;
+    MinTextureCoordinatesX[index] = particle.MinTextureCoordinates.x;
+    MinTextureCoordinatesY[index] = particle.MinTextureCoordinates.y;
+    MaxTextureCoordinatesX[index] = particle.MaxTextureCoordinates.x;
+    MaxTextureCoordinatesY[index] = particle.MaxTextureCoordinates.y;
+    LifeSpan[index] = particle.LifeSpan;
+    LifeRemaining[index] = particle.LifeRemaining;
+    LightType[index] = particle.LightType;
+    LightParameter[index] = particle.LightParameter;
+    LightRange[index] = particle.LightRange;
+    LightFalloff[index] = particle.LightFalloff;
+}
+
+void ParticleBuffer::SwapRemove(uint32 index)
+{
+    DebugAssert(index < m_particleCount);
+    uint32 lastIndex = --m_particleCount;
+    if (index == lastIndex)
+        return;
+
+    PositionX[index] = PositionX[lastIndex];
+    PositionY[index] = PositionY[lastIndex];
+    PositionZ[index] = PositionZ[lastIndex];
+    VelocityX[index] = VelocityX[lastIndex];
+    VelocityY[index] = VelocityY[lastIndex];
+    VelocityZ[index] = VelocityZ[lastIndex];
+    Width[index] = Width[lastIndex];
+    Height[index] = Height[lastIndex];
+    Rotation[index] = Rotation[lastIndex];
+    Color[index] = Color[lastIndex];
+    MinTextureCoordinatesX[index] = MinTextureCoordinatesX[lastIndex];
+    MinTextureCoordinatesY[index] = MinTextureCoordinatesY[lastIndex];
+    MaxTextureCoordinatesX[index] = MaxTextureCoordinatesX[lastIndex];
+    MaxTextureCoordinatesY[index] = MaxTextureCoordinatesY[lastIndex];
+    LifeSpan[index] = LifeSpan[lastIndex];
+    LifeRemaining[index] = LifeRemaining[lastIndex];
+    LightType[index] = LightType[lastIndex];
+    LightParameter[index] = LightParameter[lastIndex];
+    LightRange[index] = LightRange[lastIndex];
+    LightFalloff[index] = LightFalloff[lastIndex];
+}
+
+void ParticleBuffer::Copy(const ParticleBuffer *pOther)
+{
+    DebugAssert(pOther->m_particleCount <= m_capacity);
+    m_particleCount = pOther->m_particleCount;
+    if (m_particleCount == 0)
+        return;
+
+    uint32 floatSize = sizeof(float) * m_particleCount;
+    Y_memcpy(PositionX, pOther->PositionX, floatSize);
+    Y_memcpy(PositionY, pOther->PositionY, floatSize);
+    Y_memcpy(PositionZ, pOther->PositionZ, floatSize);
+    Y_memcpy(VelocityX, pOther->VelocityX, floatSize);
+    Y_memcpy(VelocityY, pOther->VelocityY, floatSize);
+    Y_memcpy(VelocityZ, pOther->VelocityZ, floatSize);
+    Y_memcpy(Width, pOther->Width, floatSize);
+    Y_memcpy(Height, pOther->Height, floatSize);
+    Y_memcpy(Rotation, pOther->Rotation, floatSize);
+    Y_memcpy(Color, pOther->Color, sizeof(uint32) * m_particleCount);
+    Y_memcpy(MinTextureCoordinatesX, pOther->MinTextureCoordinatesX, floatSize);
+    Y_memcpy(MinTextureCoordinatesY, pOther->MinTextureCoordinatesY, floatSize);
+    Y_memcpy(MaxTextureCoordinatesX, pOther->MaxTextureCoordinatesX, floatSize);
+    Y_memcpy(MaxTextureCoordinatesY, pOther->MaxTextureCoordinatesY, floatSize);
+    Y_memcpy(LifeSpan, pOther->LifeSpan, floatSize);
+    Y_memcpy(LifeRemaining, pOther->LifeRemaining, floatSize);
+    Y_memcpy(LightType, pOther->LightType, sizeof(uint8) * m_particleCount);
+    Y_memcpy(LightParameter, pOther->LightParameter, sizeof(uint8) * m_particleCount);
+    Y_memcpy(LightRange, pOther->LightRange, floatSize);
+    Y_memcpy(LightFalloff, pOther->LightFalloff, floatSize);
+}
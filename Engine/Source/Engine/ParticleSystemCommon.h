@@ -3,6 +3,7 @@
 
 // Forward declarations of all relevant classes
 struct ParticleData;
+class ParticleBuffer;
 class ParticleSystem;
 class ParticleSystemEmitter;
 class ParticleSystemModule;
@@ -28,3 +29,68 @@ struct ParticleData
     float LightRange;
     float LightFalloff;
 };
+
+// Particle instances of an emitter, with one stream per field of ParticleData, so updates only touch the fields they use.
+// Streams are aligned and padded to a multiple of PARTICLE_BUFFER_SIMD_WIDTH, updates can run over the padding
+// with SIMD vectors instead of finishing with scalar code. Values in the padding are undefined.
+#define PARTICLE_BUFFER_SIMD_WIDTH (4)
+
+class ParticleBuffer
+{
+    DeclareNonCopyable(ParticleBuffer);
+
+public:
+    ParticleBuffer();
+    ~ParticleBuffer();
+
+    const uint32 GetCapacity() const { return m_capacity; }
+    const uint32 GetParticleCount() const { return m_particleCount; }
+    const uint32 GetPaddedParticleCount() const { return (m_particleCount + (PARTICLE_BUFFER_SIMD_WIDTH - 1)) & ~(PARTICLE_BUFFER_SIMD_WIDTH - 1); }
+    const bool IsEmpty() const { return (m_particleCount == 0); }
+    const bool IsFull() const { return (m_particleCount == m_capacity); }
+
+    // Allocates the streams, dropping any particles.
+    void Allocate(uint32 capacity);
+    void Free();
+    void Clear() { m_particleCount = 0; }
+
+    // Appends a particle, returns its index. There must be room for it.
+    uint32 Add(const ParticleData &particle);
+
+    // Per-particle access, for spawning.
+    void Get(uint32 index, ParticleData *pParticle) const;
+    void Set(uint32 index, const ParticleData &particle);
+
+    // Removes a particle by moving the last particle over it, so the order is not preserved.
+    void SwapRemove(uint32 index);
+
+    // Copies the particles of another buffer, which must fit.
+    void Copy(const ParticleBuffer *pOther);
+
+    // Streams
+    float *PositionX;
+    float *PositionY;
+    float *PositionZ;
+    float *VelocityX;
+    float *VelocityY;
+    float *VelocityZ;
+    float *Width;
+    float *Height;
+    float *Rotation;
+    uint32 *Color;
+    float *MinTextureCoordinatesX;
+    float *MinTextureCoordinatesY;
+    float *MaxTextureCoordinatesX;
+    float *MaxTextureCoordinatesY;
+    float *LifeSpan;
+    float *LifeRemaining;
+    uint8 *LightType;
+    uint8 *LightParameter;
+    float *LightRange;
+    float *LightFalloff;
+
+private:
+    byte *m_pMemory;
+    uint32 m_capacity;
+    uint32 m_particleCount;
+};
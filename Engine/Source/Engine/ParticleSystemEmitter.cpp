@@ -42,9 +42,8 @@ void ParticleSystemEmitter::RemoveModule(const ParticleSystemModule *pAffector)
 
 void ParticleSystemEmitter::InitializeInstance(InstanceData *pEmitterData) const
 {
-    // Allocate particle arrays
-    pEmitterData->ParticlesState[0].Reserve(m_maxActiveParticles);
-    pEmitterData->ParticlesState[1].Reserve(m_maxActiveParticles);
+    // Allocate particle streams
+    pEmitterData->Particles.Allocate(m_maxActiveParticles);
     pEmitterData->BoundingBox.SetZero();
     pEmitterData->TimeUntilNextSpawn = 0.0f;
 }
@@ -52,46 +51,54 @@ void ParticleSystemEmitter::InitializeInstance(InstanceData *pEmitterData) const
 void ParticleSystemEmitter::CleanupInstance(InstanceData *pEmitterData) const
 {
     // Cleanup everything
-    pEmitterData->ParticlesState[0].Obliterate();
-    pEmitterData->ParticlesState[1].Obliterate();
+    pEmitterData->Particles.Free();
 }
 
 void ParticleSystemEmitter::UpdateInstance(InstanceData *pEmitterData, const Transform *pBaseTransform, RandomNumberGenerator *pRNG, float deltaTime) const
 {
-    // Call affector update on everything in array[1]
-    if (pEmitterData->ParticlesState[0].GetSize() > 0)
+    ParticleBuffer *pParticles = &pEmitterData->Particles;
+
+    // Call affector update on all particles
+    if (!pParticles->IsEmpty())
     {
         for (uint32 affectorIndex = 0; affectorIndex < m_modules.GetSize(); affectorIndex++)
         {
             const ParticleSystemModule *pAffector = m_modules[affectorIndex];
-            pAffector->UpdateParticles(this, pBaseTransform, pRNG, pEmitterData->ParticlesState[0].GetBasePointer(), pEmitterData->ParticlesState[0].GetSize(), deltaTime);
+            pAffector->UpdateParticles(this, pBaseTransform, pRNG, pParticles, deltaTime);
         }
     }
-    
-    // Clear array[2], Update position, lifetime on existing particles, store in array[2]
-    // Calculate new bounding box along the way
-    AABox particlesBoundingBox;
-    uint32 nActiveParticles = 0;
-    pEmitterData->ParticlesState[1].Clear();
-    for (uint32 particleIndex = 0; particleIndex < pEmitterData->ParticlesState[0].GetSize(); particleIndex++)
+
+    // Update position, lifetime on existing particles, four at a time
+    uint32 paddedParticleCount = pParticles->GetPaddedParticleCount();
+    for (uint32 particleIndex = 0; particleIndex < paddedParticleCount; particleIndex += PARTICLE_BUFFER_SIMD_WIDTH)
     {
-        ParticleData *pParticleData = &pEmitterData->ParticlesState[0][particleIndex];
-        pParticleData->LifeRemaining -= deltaTime;
-        if (pParticleData->LifeRemaining <= 0.0f)
-            continue;
-
-        pParticleData->Position += pParticleData->Velocity * deltaTime;
-        
-        float maxDimension = Max(pParticleData->Width, pParticleData->Height);
-        if ((nActiveParticles++) == 0)
-            particlesBoundingBox.SetBounds(pParticleData->Position - maxDimension, pParticleData->Position + maxDimension);
-        else
-            particlesBoundingBox.Merge(AABox(pParticleData->Position - maxDimension, pParticleData->Position + maxDimension));
+        SIMDVector4f lifeRemaining(pParticles->LifeRemaining + particleIndex);
+        (lifeRemaining - deltaTime).Store(pParticles->LifeRemaining + particleIndex);
+
+        SIMDVector4f positionX(pParticles->PositionX + particleIndex);
+        SIMDVector4f positionY(pParticles->PositionY + particleIndex);
+        SIMDVector4f positionZ(pParticles->PositionZ + particleIndex);
+        (positionX + SIMDVector4f(pParticles->VelocityX + particleIndex) * deltaTime).Store(pParticles->PositionX + particleIndex);
+        (positionY + SIMDVector4f(pParticles->VelocityY + particleIndex) * deltaTime).Store(pParticles->PositionY + particleIndex);
+        (positionZ + SIMDVector4f(pParticles->VelocityZ + particleIndex) * deltaTime).Store(pParticles->PositionZ + particleIndex);
+    }
 
-        pEmitterData->ParticlesState[1].Add(*pParticleData);
+    // Remove dead particles, the last particle is moved into the hole and checked next
+    for (uint32 particleIndex = 0; particleIndex < pParticles->GetParticleCount(); )
+    {
+        if (pParticles->LifeRemaining[particleIndex] <= 0.0f)
+            pParticles->SwapRemove(particleIndex);
+        else
+            particleIndex++;
     }
 
-    // Spawn new particles, add to array[2]
+    // Calculate new bounding box of the survivors
+    AABox particlesBoundingBox;
+    uint32 nActiveParticles = pParticles->GetParticleCount();
+    if (nActiveParticles > 0)
+        CalculateBoundingBox(pParticles, &particlesBoundingBox);
+
+    // Spawn new particles
     float remainingDeltaTime = deltaTime;
     while (remainingDeltaTime > 0.0f)
     {
@@ -101,15 +108,15 @@ void ParticleSystemEmitter::UpdateInstance(InstanceData *pEmitterData, const Tra
             remainingDeltaTime -= pEmitterData->TimeUntilNextSpawn;
 
             // room for another particle?
-            if (pEmitterData->ParticlesState[1].GetSize() < m_maxActiveParticles)
+            if (pParticles->GetParticleCount() < m_maxActiveParticles)
             {
                 // spawn particles
-                for (uint32 spawnCount = 0; spawnCount < m_spawnCount && pEmitterData->ParticlesState[1].GetSize() < m_maxActiveParticles; spawnCount++)
+                for (uint32 spawnCount = 0; spawnCount < m_spawnCount && pParticles->GetParticleCount() < m_maxActiveParticles; spawnCount++)
                 {
                     ParticleData particleData;
                     if (InternalCreateParticle(pEmitterData, pBaseTransform, pRNG, &particleData))
                     {
-                        pEmitterData->ParticlesState[1].Add(particleData);
+                        pParticles->Add(particleData);
 
                         // update bounding box
                         float maxDimension = Max(particleData.Width, particleData.Height);
@@ -137,9 +144,6 @@ void ParticleSystemEmitter::UpdateInstance(InstanceData *pEmitterData, const Tra
         }        
     }
 
-    // Swap array[2] with array[1]
-    pEmitterData->ParticlesState[0].Swap(pEmitterData->ParticlesState[1]);
-
     // Update bounding box
     if (nActiveParticles > 0)
         pEmitterData->BoundingBox = particlesBoundingBox;
@@ -147,6 +151,43 @@ void ParticleSystemEmitter::UpdateInstance(InstanceData *pEmitterData, const Tra
     //Log_DevPrintf("num particles %u", nActiveParticles);
 }
 
+void ParticleSystemEmitter::CalculateBoundingBox(const ParticleBuffer *pParticles, AABox *pBoundingBox)
+{
+    // whole groups of four are done with vectors, so the padding doesn't end up in the box
+    uint32 particleCount = pParticles->GetParticleCount();
+    uint32 vectorParticleCount = particleCount & ~(PARTICLE_BUFFER_SIMD_WIDTH - 1);
+    SIMDVector4f minX(SIMDVector4f::Infinite), minY(SIMDVector4f::Infinite), minZ(SIMDVector4f::Infinite);
+    SIMDVector4f maxX(SIMDVector4f::NegativeInfinite), maxY(SIMDVector4f::NegativeInfinite), maxZ(SIMDVector4f::NegativeInfinite);
+    for (uint32 particleIndex = 0; particleIndex < vectorParticleCount; particleIndex += PARTICLE_BUFFER_SIMD_WIDTH)
+    {
+        SIMDVector4f maxDimension(SIMDVector4f(pParticles->Width + particleIndex).Max(SIMDVector4f(pParticles->Height + particleIndex)));
+        SIMDVector4f positionX(pParticles->PositionX + particleIndex);
+        SIMDVector4f positionY(pParticles->PositionY + particleIndex);
+        SIMDVector4f positionZ(pParticles->PositionZ + particleIndex);
+        minX = minX.Min(positionX - maxDimension);
+        minY = minY.Min(positionY - maxDimension);
+        minZ = minZ.Min(positionZ - maxDimension);
+        maxX = maxX.Max(positionX + maxDimension);
+        maxY = maxY.Max(positionY + maxDimension);
+        maxZ = maxZ.Max(positionZ + maxDimension);
+    }
+
+    // reduce the lanes
+    float3 minBounds(Min(Min(minX.x, minX.y), Min(minX.z, minX.w)), Min(Min(minY.x, minY.y), Min(minY.z, minY.w)), Min(Min(minZ.x, minZ.y), Min(minZ.z, minZ.w)));
+    float3 maxBounds(Max(Max(maxX.x, maxX.y), Max(maxX.z, maxX.w)), Max(Max(maxY.x, maxY.y), Max(maxY.z, maxY.w)), Max(Max(maxZ.x, maxZ.y), Max(maxZ.z, maxZ.w)));
+
+    // remaining particles
+    for (uint32 particleIndex = vectorParticleCount; particleIndex < particleCount; particleIndex++)
+    {
+        float maxDimension = Max(pParticles->Width[particleIndex], pParticles->Height[particleIndex]);
+        float3 position(pParticles->PositionX[particleIndex], pParticles->PositionY[particleIndex], pParticles->PositionZ[particleIndex]);
+        minBounds = minBounds.Min(position - maxDimension);
+        maxBounds = maxBounds.Max(position + maxDimension);
+    }
+
+    pBoundingBox->SetBounds(minBounds, maxBounds);
+}
+
 bool ParticleSystemEmitter::InternalCreateParticle(InstanceData *pEmitterData, const Transform *pBaseTransform, RandomNumberGenerator *pRNG, ParticleData *pParticleData) const
 {
     pParticleData->Position = pBaseTransform->TransformPoint(float3::Zero);
@@ -171,54 +212,45 @@ bool ParticleSystemEmitter::InternalCreateParticle(InstanceData *pEmitterData, c
     return true;
 }
 
-ParticleData *ParticleSystemEmitter::InternalSpawnParticle(InstanceData *pEmitterData, const Transform *pBaseTransform, RandomNumberGenerator *pRNG) const
+int32 ParticleSystemEmitter::InternalSpawnParticle(InstanceData *pEmitterData, const Transform *pBaseTransform, RandomNumberGenerator *pRNG, const float3 *pLocalPosition /* = nullptr */, const float3 *pSpawnDirection /* = nullptr */) const
 {
-    if (pEmitterData->ParticlesState[0].GetSize() > m_maxActiveParticles)
-        return nullptr;
+    if (pEmitterData->Particles.GetParticleCount() >= m_maxActiveParticles)
+        return -1;
 
     ParticleData particleData;
     if (!InternalCreateParticle(pEmitterData, pBaseTransform, pRNG, &particleData))
-        return nullptr;
+        return -1;
+
+    // override the location
+    if (pLocalPosition != nullptr)
+        particleData.Position = pBaseTransform->TransformPoint(*pLocalPosition);
+    if (pSpawnDirection != nullptr)
+        particleData.Velocity = *pSpawnDirection;
 
     // update bounding box
     float maxDimension = Max(particleData.Width, particleData.Height);
-    if (pEmitterData->ParticlesState[0].IsEmpty())
+    if (pEmitterData->Particles.IsEmpty())
         pEmitterData->BoundingBox.SetBounds(particleData.Position - maxDimension, particleData.Position + maxDimension);
     else
         pEmitterData->BoundingBox.Merge(AABox(particleData.Position - maxDimension, particleData.Position + maxDimension));
 
     // add particle
-    pEmitterData->ParticlesState[0].Add(particleData);
-    return &pEmitterData->ParticlesState[0].LastElement();
+    return (int32)pEmitterData->Particles.Add(particleData);
 }
 
 bool ParticleSystemEmitter::SpawnParticle(InstanceData *pEmitterData, const Transform *pBaseTransform, RandomNumberGenerator *pRNG) const
 {
-    ParticleData *pParticleData = InternalSpawnParticle(pEmitterData, pBaseTransform, pRNG);
-    if (pEmitterData == nullptr)
-        return false;
-
-    return true;
+    return (InternalSpawnParticle(pEmitterData, pBaseTransform, pRNG) >= 0);
 }
 
 bool ParticleSystemEmitter::SpawnParticle(InstanceData *pEmitterData, const Transform *pBaseTransform, RandomNumberGenerator *pRNG, uint32 emitterSpecificData) const
 {
-    ParticleData *pParticleData = InternalSpawnParticle(pEmitterData, pBaseTransform, pRNG);
-    if (pEmitterData == nullptr)
-        return false;
-
-    return true;
+    return (InternalSpawnParticle(pEmitterData, pBaseTransform, pRNG) >= 0);
 }
 
 bool ParticleSystemEmitter::SpawnParticle(InstanceData *pEmitterData, const Transform *pBaseTransform, RandomNumberGenerator *pRNG, uint32 emitterSpecificData, const float3 &localPosition, const float3 &spawnDirection) const
 {
-    ParticleData *pParticleData = InternalSpawnParticle(pEmitterData, pBaseTransform, pRNG);
-    if (pEmitterData == nullptr)
-        return false;
-
-    pParticleData->Position = pBaseTransform->TransformPoint(localPosition);
-    pParticleData->Velocity = spawnDirection;
-    return true;
+    return (InternalSpawnParticle(pEmitterData, pBaseTransform, pRNG, &localPosition, &spawnDirection) >= 0);
 }
 
 void ParticleSystemEmitter::InitializeRenderData(InstanceRenderData *pEmitterRenderData) const
@@ -231,6 +263,8 @@ void ParticleSystemEmitter::CleanupRenderData(InstanceRenderData *pEmitterRender
 {
     Y_free(pEmitterRenderData->pGPUStagingBuffer);
     pEmitterRenderData->pGPUStagingBuffer = nullptr;
+    delete pEmitterRenderData->pStagingParticles;
+    pEmitterRenderData->pStagingParticles = nullptr;
     pEmitterRenderData->GPUStagingBufferSize = 0;
     pEmitterRenderData->GPUStagingBufferUsage = 0;
     if (pEmitterRenderData->pGPUBuffer != nullptr)
@@ -1,9 +1,9 @@
 #pragma once
 #include "Engine/ParticleSystemCommon.h"
 #include "Renderer/RenderProxy.h"
+#include "Core/RandomNumberGenerator.h"
 
 class GPUBuffer;
-class RandomNumberGenerator;
 
 // Base emitter type
 class ParticleSystemEmitter : public Object
@@ -35,15 +35,14 @@ public:
         SpawnVelocityType_Count
     };
 
-    // Particle type definitions
-    typedef MemArray<ParticleData> ParticleDataArray;
-
     // Emitter data, created once per emitter.
     struct InstanceData
     {
-        // There are two particle arrays, one containing the emitter state at the
-        // start of the frame, and another after the emitter update has completed.
-        ParticleDataArray ParticlesState[2];
+        // Active particles. Dead particles are swapped out during the update, so the order changes.
+        ParticleBuffer Particles;
+
+        // Each instance has its own generator, so emitters can be updated in parallel.
+        RandomNumberGenerator RNG;
 
         // Time remaining until next particle is spawned.
         float TimeUntilNextSpawn;
@@ -67,6 +66,9 @@ public:
         // Emitter data.
         uint32 EmitterData[4];
 
+        // Copy of the particles, for emitters that generate their vertices at draw time.
+        ParticleBuffer *pStagingParticles;
+
         // Buffer containing the data that is uploaded to the GPU, if needed.
         // Guaranteed to be valid and race-free once queued until the frame is complete.
         byte *pGPUStagingBuffer;
@@ -134,7 +136,10 @@ public:
 protected:
     // Internally initialize a new particle.
     virtual bool InternalCreateParticle(InstanceData *pEmitterData, const Transform *pBaseTransform, RandomNumberGenerator *pRNG, ParticleData *pParticleData) const;
-    ParticleData *InternalSpawnParticle(InstanceData *pEmitterData, const Transform *pBaseTransform, RandomNumberGenerator *pRNG) const;
+    int32 InternalSpawnParticle(InstanceData *pEmitterData, const Transform *pBaseTransform, RandomNumberGenerator *pRNG, const float3 *pLocalPosition = nullptr, const float3 *pSpawnDirection = nullptr) const;
+
+    // Bounds of the particles, grown by their largest dimension.
+    static void CalculateBoundingBox(const ParticleBuffer *pParticles, AABox *pBoundingBox);
 
     // Maximum number of particles this emitter can accommodate at once.
     // Used to determine buffer and array sizes.
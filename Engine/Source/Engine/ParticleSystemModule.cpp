@@ -20,7 +20,7 @@ bool ParticleSystemModule::CreateParticle(const ParticleSystemEmitter *pEmitter,
     return true;
 }
 
-void ParticleSystemModule::UpdateParticles(const ParticleSystemEmitter *pEmitter, const Transform *pBaseTransform, RandomNumberGenerator *pRNG, ParticleData *pParticles, uint32 nParticles, float deltaTime) const
+void ParticleSystemModule::UpdateParticles(const ParticleSystemEmitter *pEmitter, const Transform *pBaseTransform, RandomNumberGenerator *pRNG, ParticleBuffer *pParticles, float deltaTime) const
 {
 
 }
@@ -17,8 +17,8 @@ public:
     // Set properties on a new particle
     virtual bool CreateParticle(const ParticleSystemEmitter *pEmitter, const Transform *pBaseTransform, RandomNumberGenerator *pRNG, ParticleData *pParticle) const;
 
-    // Update a list of particles
-    virtual void UpdateParticles(const ParticleSystemEmitter *pEmitter, const Transform *pBaseTransform, RandomNumberGenerator *pRNG, ParticleData *pParticles, uint32 nParticles, float deltaTime) const;
+    // Update all particles in the buffer. Modules may process the padding past the particle count, see ParticleBuffer.
+    virtual void UpdateParticles(const ParticleSystemEmitter *pEmitter, const Transform *pBaseTransform, RandomNumberGenerator *pRNG, ParticleBuffer *pParticles, float deltaTime) const;
 
     // Type registration
     static void RegisterBuiltinModules();
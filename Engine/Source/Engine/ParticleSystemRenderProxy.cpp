@@ -1,6 +1,7 @@
 #include "Engine/PrecompiledHeader.h"
 #include "Engine/ParticleSystemRenderProxy.h"
 #include "Engine/Engine.h"
+#include "Engine/JobSystem.h"
 #include "Renderer/Renderer.h"
 
 ParticleSystemRenderProxy::ParticleSystemRenderProxy(const ParticleSystem *pParticleSystem, uint32 entityID)
@@ -35,6 +36,7 @@ void ParticleSystemRenderProxy::CreateInstanceData()
     {
         const ParticleSystemEmitter *pEmitter = m_pParticleSystem->GetEmitter(emitterIndex);
         pEmitter->InitializeInstance(&m_pEmitterInstanceData[emitterIndex]);
+        m_pEmitterInstanceData[emitterIndex].RNG.Reseed(g_pEngine->GetRandomNumberGenerator()->NextUInt());
         pEmitter->InitializeRenderData(&m_pEmitterInstanceRenderData[emitterIndex]);
     }
 }
@@ -84,9 +86,14 @@ void ParticleSystemRenderProxy::Update(const Transform *pBaseTransform, float de
 
     if (m_timeSinceLastUpdate >= m_pParticleSystem->GetUpdateInterval())
     {
-        // simulate each emitter
-        for (uint32 emitterIndex = 0; emitterIndex < m_emitterCount; emitterIndex++)
-            m_pParticleSystem->GetEmitter(emitterIndex)->UpdateInstance(&m_pEmitterInstanceData[emitterIndex], pBaseTransform, g_pEngine->GetRandomNumberGenerator(), m_timeSinceLastUpdate);
+        // simulate each emitter, they share no state, so they can run on the workers
+        const ParticleSystem *pParticleSystem = m_pParticleSystem;
+        ParticleSystemEmitter::InstanceData *pEmitterInstanceData = m_pEmitterInstanceData;
+        float updateTime = m_timeSinceLastUpdate;
+        g_pEngine->GetJobSystem()->ParallelFor(m_emitterCount, 1, [pParticleSystem, pEmitterInstanceData, pBaseTransform, updateTime](uint32 start, uint32 end) {
+            for (uint32 emitterIndex = start; emitterIndex < end; emitterIndex++)
+                pParticleSystem->GetEmitter(emitterIndex)->UpdateInstance(&pEmitterInstanceData[emitterIndex], pBaseTransform, &pEmitterInstanceData[emitterIndex].RNG, updateTime);
+        });
 
         // queue update on render thread
         ReferenceCountedHolder<ParticleSystemRenderProxy> pThis(this);
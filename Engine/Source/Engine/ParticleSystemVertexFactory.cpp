@@ -96,8 +96,9 @@ static inline void AppendSpriteVertexInstancedQuads(byte *&pCurrentPointer, cons
     pCurrentPointer += sizeof(Vertex);
 }
 
-bool ParticleSystemSpriteVertexFactory::FillVertexBuffer(RENDERER_PLATFORM platform, RENDERER_FEATURE_LEVEL featureLevel, uint32 flags, const Camera *pCamera, const ParticleData *pParticles, uint32 nParticles, void *pBuffer, uint32 bufferSize)
+bool ParticleSystemSpriteVertexFactory::FillVertexBuffer(RENDERER_PLATFORM platform, RENDERER_FEATURE_LEVEL featureLevel, uint32 flags, const Camera *pCamera, const ParticleBuffer *pParticles, void *pBuffer, uint32 bufferSize)
 {
+    uint32 nParticles = pParticles->GetParticleCount();
     uint32 vertexSize = GetVertexSize(platform, featureLevel, flags);
     if (bufferSize < (vertexSize * nParticles * GetVerticesPerSprite(platform, featureLevel, flags)))
         return false;
@@ -112,50 +113,56 @@ bool ParticleSystemSpriteVertexFactory::FillVertexBuffer(RENDERER_PLATFORM platf
         byte *pCurrentPointer = reinterpret_cast<byte *>(pBuffer);
         for (uint32 spriteIndex = 0; spriteIndex < nParticles; spriteIndex++)
         {
-            const ParticleData *pParticleData = &pParticles[spriteIndex];
+            float3 position(pParticles->PositionX[spriteIndex], pParticles->PositionY[spriteIndex], pParticles->PositionZ[spriteIndex]);
+            float rotation = pParticles->Rotation[spriteIndex];
+            uint32 color = pParticles->Color[spriteIndex];
 
             // find half width/height
-            float halfWidth = pParticleData->Width * 0.5f;
-            float halfHeight = pParticleData->Height * 0.5f;
+            float halfWidth = pParticles->Width[spriteIndex] * 0.5f;
+            float halfHeight = pParticles->Height[spriteIndex] * 0.5f;
 
             // find the four vertex positions
             // these coordinates have to be in y-up coordinate system, as we are working with the view matrix
             float3 vertexPositions[4];
-            if (pParticleData->Rotation != 0.0f)
+            if (rotation != 0.0f)
             {
-                float theta = Math::DegreesToRadians(pParticleData->Rotation);
+                float theta = Math::DegreesToRadians(rotation);
                 float sinTheta, cosTheta;
                 Math::SinCos(theta, &sinTheta, &cosTheta);
 
-                vertexPositions[0] = inverseViewMatrixRotation * float3(-halfWidth * cosTheta + -halfHeight * sinTheta, -halfWidth * sinTheta + halfHeight * cosTheta, 0.0f) + pParticleData->Position;
-                vertexPositions[1] = inverseViewMatrixRotation * float3(-halfWidth * cosTheta + halfHeight * sinTheta, -halfWidth * sinTheta + -halfHeight * cosTheta, 0.0f) + pParticleData->Position;
-                vertexPositions[2] = inverseViewMatrixRotation * float3(halfWidth * cosTheta + -halfHeight * sinTheta, halfWidth * sinTheta + halfHeight * cosTheta, 0.0f) + pParticleData->Position;
-                vertexPositions[3] = inverseViewMatrixRotation * float3(halfWidth * cosTheta + halfHeight * sinTheta, halfWidth * sinTheta + -halfHeight * cosTheta, 0.0f) + pParticleData->Position;
+                vertexPositions[0] = inverseViewMatrixRotation * float3(-halfWidth * cosTheta + -halfHeight * sinTheta, -halfWidth * sinTheta + halfHeight * cosTheta, 0.0f) + position;
+                vertexPositions[1] = inverseViewMatrixRotation * float3(-halfWidth * cosTheta + halfHeight * sinTheta, -halfWidth * sinTheta + -halfHeight * cosTheta, 0.0f) + position;
+                vertexPositions[2] = inverseViewMatrixRotation * float3(halfWidth * cosTheta + -halfHeight * sinTheta, halfWidth * sinTheta + halfHeight * cosTheta, 0.0f) + position;
+                vertexPositions[3] = inverseViewMatrixRotation * float3(halfWidth * cosTheta + halfHeight * sinTheta, halfWidth * sinTheta + -halfHeight * cosTheta, 0.0f) + position;
             }
             else
             {
-                vertexPositions[0] = inverseViewMatrixRotation * float3(-halfWidth, halfHeight, 0.0f) + pParticleData->Position;
-                vertexPositions[1] = inverseViewMatrixRotation * float3(-halfWidth, -halfHeight, 0.0f) + pParticleData->Position;
-                vertexPositions[2] = inverseViewMatrixRotation * float3(halfWidth, halfHeight, 0.0f) + pParticleData->Position;
-                vertexPositions[3] = inverseViewMatrixRotation * float3(halfWidth, -halfHeight, 0.0f) + pParticleData->Position;
+                vertexPositions[0] = inverseViewMatrixRotation * float3(-halfWidth, halfHeight, 0.0f) + position;
+                vertexPositions[1] = inverseViewMatrixRotation * float3(-halfWidth, -halfHeight, 0.0f) + position;
+                vertexPositions[2] = inverseViewMatrixRotation * float3(halfWidth, halfHeight, 0.0f) + position;
+                vertexPositions[3] = inverseViewMatrixRotation * float3(halfWidth, -halfHeight, 0.0f) + position;
             }
 
             // same for texture coordinates
+            float minU = pParticles->MinTextureCoordinatesX[spriteIndex];
+            float minV = pParticles->MinTextureCoordinatesY[spriteIndex];
+            float maxU = pParticles->MaxTextureCoordinatesX[spriteIndex];
+            float maxV = pParticles->MaxTextureCoordinatesY[spriteIndex];
             float2 vertexTextureCoordinates[4];
-            vertexTextureCoordinates[0].Set(pParticleData->MinTextureCoordinates);
-            vertexTextureCoordinates[1].Set(pParticleData->MinTextureCoordinates.x, pParticleData->MaxTextureCoordinates.y);
-            vertexTextureCoordinates[2].Set(pParticleData->MaxTextureCoordinates.x, pParticleData->MinTextureCoordinates.y);
-            vertexTextureCoordinates[3].Set(pParticleData->MaxTextureCoordinates.x, pParticleData->MaxTextureCoordinates.y);
+            vertexTextureCoordinates[0].Set(minU, minV);
+            vertexTextureCoordinates[1].Set(minU, maxV);
+            vertexTextureCoordinates[2].Set(maxU, minV);
+            vertexTextureCoordinates[3].Set(maxU, maxV);
 
             // first triangle
-            AppendSpriteVertexBasic(pCurrentPointer, vertexPositions[0], vertexTextureCoordinates[0], pParticleData->Color);
-            AppendSpriteVertexBasic(pCurrentPointer, vertexPositions[1], vertexTextureCoordinates[1], pParticleData->Color);
-            AppendSpriteVertexBasic(pCurrentPointer, vertexPositions[2], vertexTextureCoordinates[2], pParticleData->Color);
+            AppendSpriteVertexBasic(pCurrentPointer, vertexPositions[0], vertexTextureCoordinates[0], color);
+            AppendSpriteVertexBasic(pCurrentPointer, vertexPositions[1], vertexTextureCoordinates[1], color);
+            AppendSpriteVertexBasic(pCurrentPointer, vertexPositions[2], vertexTextureCoordinates[2], color);
 
             // second triangle
-            AppendSpriteVertexBasic(pCurrentPointer, vertexPositions[2], vertexTextureCoordinates[2], pParticleData->Color);
-            AppendSpriteVertexBasic(pCurrentPointer, vertexPositions[1], vertexTextureCoordinates[1], pParticleData->Color);
-            AppendSpriteVertexBasic(pCurrentPointer, vertexPositions[3], vertexTextureCoordinates[3], pParticleData->Color);
+            AppendSpriteVertexBasic(pCurrentPointer, vertexPositions[2], vertexTextureCoordinates[2], color);
+            AppendSpriteVertexBasic(pCurrentPointer, vertexPositions[1], vertexTextureCoordinates[1], color);
+            AppendSpriteVertexBasic(pCurrentPointer, vertexPositions[3], vertexTextureCoordinates[3], color);
         }
 
         return true;
@@ -166,19 +173,14 @@ bool ParticleSystemSpriteVertexFactory::FillVertexBuffer(RENDERER_PLATFORM platf
         byte *pCurrentPointer = reinterpret_cast<byte *>(pBuffer);
         for (uint32 spriteIndex = 0; spriteIndex < nParticles; spriteIndex++)
         {
-            const ParticleData *pParticleData = &pParticles[spriteIndex];
-
-            // find half width/height
-            //float halfWidth = pParticleData->Width * 0.5f;
-            //float halfHeight = pParticleData->Height * 0.5f;
-
             // find texture coordinate range
-            float2 textureCoordinateRange(pParticleData->MaxTextureCoordinates - pParticleData->MinTextureCoordinates);
+            float2 minTextureCoordinates(pParticles->MinTextureCoordinatesX[spriteIndex], pParticles->MinTextureCoordinatesY[spriteIndex]);
+            float2 textureCoordinateRange(pParticles->MaxTextureCoordinatesX[spriteIndex] - minTextureCoordinates.x, pParticles->MaxTextureCoordinatesY[spriteIndex] - minTextureCoordinates.y);
             
             // generate vertex
-            AppendSpriteVertexInstancedQuads(pCurrentPointer, pParticleData->Position, Math::DegreesToRadians(pParticleData->Rotation), 
-                                             pParticleData->MinTextureCoordinates, textureCoordinateRange,
-                                             pParticleData->Width, pParticleData->Height, pParticleData->Color);
+            AppendSpriteVertexInstancedQuads(pCurrentPointer, float3(pParticles->PositionX[spriteIndex], pParticles->PositionY[spriteIndex], pParticles->PositionZ[spriteIndex]),
+                                             Math::DegreesToRadians(pParticles->Rotation[spriteIndex]), minTextureCoordinates, textureCoordinateRange,
+                                             pParticles->Width[spriteIndex], pParticles->Height[spriteIndex], pParticles->Color[spriteIndex]);
         }
 
         // done
@@ -17,11 +17,16 @@
 #include "Renderer/Renderer.h"
 #include "ResourceCompilerInterface/ResourceCompilerInterface.h"
 #include "Core/DefinitionFile.h"
+#include "Core/MappedFile.h"
 Log_SetChannel(Renderer);
 
 static ResourceManager s_ResourceManager;
 ResourceManager *g_pResourceManager = &s_ResourceManager;
 
+// set while a loader thread is loading an asynchronous request, gpu resources are created in a batch afterwards.
+// anything the request loads along the way is collected here rather than published without gpu resources.
+Y_DECLARE_THREAD_LOCAL(PODArray<Resource *> *) s_pAsyncLoadDependencies = nullptr;
+
 ResourceManager::ResourceManager()
 {
     m_pDefaultTexture2D = NULL;
@@ -32,8 +37,8 @@ ResourceManager::ResourceManager()
     m_pDefaultSkeletalMesh = NULL;
 
     m_pResourceModificationChangeNotifier = nullptr;
-    m_pResourceCompilerInterface = nullptr;
-    m_resourceCompilerInUse = false;
+
+    m_asyncLoaderThreadsStarted = false;
 }
 
 ResourceManager::~ResourceManager()
@@ -56,10 +61,11 @@ ResourceManager::~ResourceManager()
     DebugAssert(m_htSkeletalMesh.GetMemberCount() == 0);
     DebugAssert(m_htSkeletalAnimation.GetMemberCount() == 0);
     DebugAssert(m_htParticleSystem.GetMemberCount() == 0);
+    DebugAssert(m_htAsyncRequests.GetMemberCount() == 0);
 
     delete m_pResourceModificationChangeNotifier;
 
-    DebugAssert(m_pResourceCompilerInterface == nullptr);
+    DebugAssert(m_idleResourceCompilerInterfaces.IsEmpty());
 }
 
 const ResourceTypeInfo *ResourceManager::GetResourceTypeForFile(const char *FileName)
@@ -250,6 +256,17 @@ void ResourceManager::ReleaseResources()
 {
     Log_DevPrint("ResourceManager is releasing all managed resources...");
 
+    // drop any asynchronous requests still in flight
+    StopAsyncLoaderThreads();
+
+#if defined(WITH_RESOURCECOMPILER_SUBPROCESS)
+    // close any idle resource compilers
+    m_resourceCompilerLock.Lock();
+    while (m_idleResourceCompilerInterfaces.GetSize() > 0)
+        m_idleResourceCompilerInterfaces.PopBack()->Release();
+    m_resourceCompilerLock.Unlock();
+#endif
+
     // delete particle systems
     for (ParticleSystemTable::Iterator itr = m_htParticleSystem.Begin(); !itr.AtEnd();)
     {
@@ -557,6 +574,9 @@ const Material *ResourceManager::UncachedGetMaterial(const char *Name)
 
 const Material *ResourceManager::GetMaterial(const char *Name)
 {
+    if (s_pAsyncLoadDependencies != nullptr)
+        return static_cast<const Material *>(GetAsyncLoadDependency(Material::StaticTypeInfo(), Name));
+
     m_resourceLock.LockShared();
 
     MaterialTable::Member *pMember = m_htMaterials.Find(Name);
@@ -587,6 +607,10 @@ const Material *ResourceManager::GetMaterial(const char *Name)
 
 const Material *ResourceManager::GetDefaultMaterial()
 {
+    // the cached default is only written on the main thread, loader threads fetch it with the request
+    if (s_pAsyncLoadDependencies != nullptr)
+        return static_cast<const Material *>(GetAsyncLoadDefault(Material::StaticTypeInfo(), g_pEngine->GetDefaultMaterialName()));
+
     if (m_pDefaultMaterial == nullptr && (m_pDefaultMaterial = GetMaterial(g_pEngine->GetDefaultMaterialName())) == nullptr)
         Panic("GetDefaultMaterial() called, and the default material failed to load.");
 
@@ -706,6 +730,9 @@ MaterialShader *ResourceManager::LoadMaterialShader(const char *Name)
 
 const MaterialShader *ResourceManager::GetMaterialShader(const char *Name)
 {
+    if (s_pAsyncLoadDependencies != nullptr)
+        return static_cast<const MaterialShader *>(GetAsyncLoadDependency(MaterialShader::StaticTypeInfo(), Name));
+
     m_resourceLock.LockShared();
 
     MaterialShaderTable::Member *pMember = m_htMaterialShaders.Find(Name);
@@ -750,6 +777,10 @@ const MaterialShader *ResourceManager::UncachedGetMaterialShader(const char *Nam
 
 const MaterialShader *ResourceManager::GetDefaultMaterialShader()
 {
+    // the cached default is only written on the main thread, loader threads fetch it with the request
+    if (s_pAsyncLoadDependencies != nullptr)
+        return static_cast<const MaterialShader *>(GetAsyncLoadDefault(MaterialShader::StaticTypeInfo(), g_pEngine->GetDefaultMaterialShaderName()));
+
     if (m_pDefaultMaterialShader == nullptr && (m_pDefaultMaterialShader = GetMaterialShader(g_pEngine->GetDefaultMaterialShaderName())) == nullptr)
         Panic("GetDefaultShader() called, and the default material shader failed to load.");
 
@@ -794,15 +825,17 @@ Texture *ResourceManager::LoadTexture(const char *Name)
         // loading the compiled version?
         if (hasCompiledVersion)
         {
-            AutoReleasePtr<ByteStream> pStream;
+            // map it, so the image data can be used in place
+            AutoReleasePtr<MappedFile> pMappedFile;
             fileName.Format("%s%s", resourceName.GetCharArray(), texturePlatformExtension.GetCharArray());
-            pStream = g_pVirtualFileSystem->OpenFile(fileName, BYTESTREAM_OPEN_READ | BYTESTREAM_OPEN_STREAMED);
-            if (pStream != nullptr)
+            pMappedFile = g_pVirtualFileSystem->MapFile(fileName);
+            if (pMappedFile != nullptr)
             {
                 // load it
+                AutoReleasePtr<ByteStream> pStream = ByteStream_CreateReadOnlyMemoryStream(pMappedFile->GetData(), (uint32)pMappedFile->GetSize());
                 TEXTURE_TYPE textureType = Texture::GetTextureTypeForStream(fileName, pStream);
                 pTexture = Texture::CreateTextureObjectForType(textureType);
-                if (pTexture == nullptr || !pTexture->Load(resourceName, pStream))
+                if (pTexture == nullptr || !pTexture->LoadFromMapping(resourceName, pMappedFile))
                 {
                     // log the error, then try to recompile it
                     Log_ErrorPrintf("ResourceManager::LoadTexture: Failed to load Texture '%s', read failed.", resourceName.GetCharArray());
@@ -878,6 +911,9 @@ Texture *ResourceManager::LoadTexture(const char *Name)
 
 const Texture *ResourceManager::GetTexture(const char *Name)
 {
+    if (s_pAsyncLoadDependencies != nullptr)
+        return static_cast<const Texture *>(GetAsyncLoadDependency(Texture::StaticTypeInfo(), Name));
+
     m_resourceLock.LockShared();
 
     TextureTable::Member *pMember = m_htTextures.Find(Name);
@@ -991,6 +1027,10 @@ const Texture *ResourceManager::GetDefaultTexture(TEXTURE_TYPE TextureType)
 
 const Texture2D *ResourceManager::GetDefaultTexture2D()
 {
+    // the cached default is only written on the main thread, loader threads fetch it with the request
+    if (s_pAsyncLoadDependencies != nullptr)
+        return static_cast<const Texture2D *>(GetAsyncLoadDefault(Texture2D::StaticTypeInfo(), g_pEngine->GetDefaultTexture2DName()));
+
     if (m_pDefaultTexture2D == nullptr && (m_pDefaultTexture2D = GetTexture2D(g_pEngine->GetDefaultTexture2DName())) == nullptr)
         Panic("GetDefaultTexture2D() called, and the default texture failed to load.");
 
@@ -1000,6 +1040,10 @@ const Texture2D *ResourceManager::GetDefaultTexture2D()
 
 const Texture2DArray *ResourceManager::GetDefaultTexture2DArray()
 {
+    // the cached default is only written on the main thread, loader threads fetch it with the request
+    if (s_pAsyncLoadDependencies != nullptr)
+        return static_cast<const Texture2DArray *>(GetAsyncLoadDefault(Texture2DArray::StaticTypeInfo(), g_pEngine->GetDefaultTexture2DArrayName()));
+
     if (m_pDefaultTexture2DArray == nullptr && (m_pDefaultTexture2DArray = GetTexture2DArray(g_pEngine->GetDefaultTexture2DArrayName())) == nullptr)
         Panic("GetDefaultTexture2DArray() called, and the default texture failed to load.");
 
@@ -1009,6 +1053,10 @@ const Texture2DArray *ResourceManager::GetDefaultTexture2DArray()
 
 const TextureCube *ResourceManager::GetDefaultTextureCube()
 {
+    // the cached default is only written on the main thread, loader threads fetch it with the request
+    if (s_pAsyncLoadDependencies != nullptr)
+        return static_cast<const TextureCube *>(GetAsyncLoadDefault(TextureCube::StaticTypeInfo(), g_pEngine->GetDefaultTextureCubeName()));
+
     if (m_pDefaultTextureCube == nullptr && (m_pDefaultTextureCube = GetTextureCube(g_pEngine->GetDefaultTextureCubeName())) == nullptr)
         Panic("GetDefaultTextureCube() called, and the default texture failed to load.");
 
@@ -1073,14 +1121,15 @@ StaticMesh *ResourceManager::LoadStaticMesh(const char *Name)
         // loading the compiled version?
         if (hasCompiledVersion)
         {
-            AutoReleasePtr<ByteStream> pStream;
+            // map it, so the index data can be used in place
+            AutoReleasePtr<MappedFile> pMappedFile;
             fileName.Format("%s.staticmesh", resourceName.GetCharArray());
-            pStream = g_pVirtualFileSystem->OpenFile(fileName, BYTESTREAM_OPEN_READ | BYTESTREAM_OPEN_STREAMED);
-            if (pStream != nullptr)
+            pMappedFile = g_pVirtualFileSystem->MapFile(fileName);
+            if (pMappedFile != nullptr)
             {
                 // load it
                 pStaticMesh = new StaticMesh();
-                if (!pStaticMesh->Load(resourceName, pStream))
+                if (!pStaticMesh->LoadFromMapping(resourceName, pMappedFile))
                 {
                     // log the error, then try to recompile it
                     Log_ErrorPrintf("ResourceManager::LoadStaticMesh: Failed to load StaticMesh '%s', read failed.", resourceName.GetCharArray());
@@ -1154,6 +1203,9 @@ StaticMesh *ResourceManager::LoadStaticMesh(const char *Name)
 
 const StaticMesh *ResourceManager::GetStaticMesh(const char *Name)
 {
+    if (s_pAsyncLoadDependencies != nullptr)
+        return static_cast<const StaticMesh *>(GetAsyncLoadDependency(StaticMesh::StaticTypeInfo(), Name));
+
     StaticMeshTable::Member *pMember = m_htStaticMeshes.Find(Name);
     if (pMember == nullptr)
     {
@@ -1183,6 +1235,10 @@ const StaticMesh *ResourceManager::UncachedGetStaticMesh(const char *Name)
 
 const StaticMesh *ResourceManager::GetDefaultStaticMesh()
 {
+    // the cached default is only written on the main thread, loader threads fetch it with the request
+    if (s_pAsyncLoadDependencies != nullptr)
+        return static_cast<const StaticMesh *>(GetAsyncLoadDefault(StaticMesh::StaticTypeInfo(), g_pEngine->GetDefaultStaticMeshName()));
+
     if (m_pDefaultStaticMesh == nullptr && (m_pDefaultStaticMesh = GetStaticMesh(g_pEngine->GetDefaultStaticMeshName())) == nullptr)
         Panic("GetDefaultStaticMesh() called, and the default texture failed to load.");
 
@@ -1307,6 +1363,9 @@ Font *ResourceManager::LoadFont(const char *Name)
 
 const Font *ResourceManager::GetFont(const char *name)
 {
+    if (s_pAsyncLoadDependencies != nullptr)
+        return static_cast<const Font *>(GetAsyncLoadDependency(Font::StaticTypeInfo(), name));
+
     FontTable::Member *pMember = m_htFonts.Find(name);
     if (pMember == nullptr)
     {
@@ -1359,14 +1418,15 @@ BlockPalette *ResourceManager::LoadBlockPalette(const char *Name)
         // loading the compiled version?
         if (hasCompiledVersion)
         {
-            AutoReleasePtr<ByteStream> pStream;
+            // map it, so the chunks can be read in place
+            AutoReleasePtr<MappedFile> pMappedFile;
             fileName.Format("%s%s", resourceName.GetCharArray(), texturePlatformExtension.GetCharArray());
-            pStream = g_pVirtualFileSystem->OpenFile(fileName, BYTESTREAM_OPEN_READ | BYTESTREAM_OPEN_STREAMED);
-            if (pStream != nullptr)
+            pMappedFile = g_pVirtualFileSystem->MapFile(fileName);
+            if (pMappedFile != nullptr)
             {
                 // load it
                 pBlockPalette = new BlockPalette();
-                if (!pBlockPalette->Load(resourceName, pStream))
+                if (!pBlockPalette->LoadFromMapping(resourceName, pMappedFile))
                 {
                     // log the error, then try to recompile it
                     Log_ErrorPrintf("ResourceManager::LoadBlockPalette: Failed to load BlockPalette '%s', read failed.", resourceName.GetCharArray());
@@ -1440,6 +1500,9 @@ BlockPalette *ResourceManager::LoadBlockPalette(const char *Name)
 
 const BlockPalette *ResourceManager::GetBlockPalette(const char *Name)
 {
+    if (s_pAsyncLoadDependencies != nullptr)
+        return static_cast<const BlockPalette *>(GetAsyncLoadDependency(BlockPalette::StaticTypeInfo(), Name));
+
     BlockPaletteTable::Member *pMember = m_htBlockPalette.Find(Name);
     if (pMember == nullptr)
     {
@@ -1487,14 +1550,15 @@ TerrainLayerList *ResourceManager::LoadTerrainLayerList(const char *Name)
         // loading the compiled version?
         if (hasCompiledVersion)
         {
-            AutoReleasePtr<ByteStream> pStream;
+            // map it, so the chunks can be read in place
+            AutoReleasePtr<MappedFile> pMappedFile;
             fileName.Format("%s.layerlist", resourceName.GetCharArray());
-            pStream = g_pVirtualFileSystem->OpenFile(fileName, BYTESTREAM_OPEN_READ | BYTESTREAM_OPEN_STREAMED);
-            if (pStream != nullptr)
+            pMappedFile = g_pVirtualFileSystem->MapFile(fileName);
+            if (pMappedFile != nullptr)
             {
                 // load it
                 pTerrainLayerList = new TerrainLayerList();
-                if (!pTerrainLayerList->Load(resourceName, pStream))
+                if (!pTerrainLayerList->LoadFromMapping(resourceName, pMappedFile))
                 {
                     // log the error, then try to recompile it
                     Log_ErrorPrintf("ResourceManager::LoadTerrainLayerList: Failed to load TerrainLayerList '%s', read failed.", resourceName.GetCharArray());
@@ -1567,6 +1631,9 @@ TerrainLayerList *ResourceManager::LoadTerrainLayerList(const char *Name)
 
 const TerrainLayerList *ResourceManager::GetTerrainLayerList(const char *Name)
 {
+    if (s_pAsyncLoadDependencies != nullptr)
+        return static_cast<const TerrainLayerList *>(GetAsyncLoadDependency(TerrainLayerList::StaticTypeInfo(), Name));
+
     TerrainLayerListTable::Member *pMember = m_htTerrainLayerList.Find(Name);
     if (pMember == nullptr)
     {
@@ -1694,6 +1761,9 @@ BlockMesh *ResourceManager::LoadBlockMesh(const char *Name)
 
 const BlockMesh *ResourceManager::GetBlockMesh(const char *Name)
 {
+    if (s_pAsyncLoadDependencies != nullptr)
+        return static_cast<const BlockMesh *>(GetAsyncLoadDependency(BlockMesh::StaticTypeInfo(), Name));
+
     BlockMeshTable::Member *pMember = m_htBlockMesh.Find(Name);
     if (pMember == nullptr)
     {
@@ -1723,6 +1793,10 @@ const BlockMesh *ResourceManager::UncachedGetBlockMesh(const char *Name)
 
 const BlockMesh *ResourceManager::GetDefaultBlockMesh()
 {
+    // the cached default is only written on the main thread, loader threads fetch it with the request
+    if (s_pAsyncLoadDependencies != nullptr)
+        return static_cast<const BlockMesh *>(GetAsyncLoadDefault(BlockMesh::StaticTypeInfo(), g_pEngine->GetDefaultBlockMeshName()));
+
     if (m_pDefaultBlockMesh == nullptr && (m_pDefaultBlockMesh = GetBlockMesh(g_pEngine->GetDefaultBlockMeshName())) == nullptr)
         Panic("GetDefaultBlockMesh() called, and the default mesh failed to load.");
 
@@ -1842,6 +1916,9 @@ Skeleton *ResourceManager::LoadSkeleton(const char *Name)
 
 const Skeleton *ResourceManager::GetSkeleton(const char *name)
 {
+    if (s_pAsyncLoadDependencies != nullptr)
+        return static_cast<const Skeleton *>(GetAsyncLoadDependency(Skeleton::StaticTypeInfo(), name));
+
     SkeletonTable::Member *pMember = m_htSkeleton.Find(name);
     if (pMember == nullptr)
     {
@@ -1889,14 +1966,15 @@ SkeletalMesh *ResourceManager::LoadSkeletalMesh(const char *Name)
         // loading the compiled version?
         if (hasCompiledVersion)
         {
-            AutoReleasePtr<ByteStream> pStream;
+            // map it, so the chunks can be read in place
+            AutoReleasePtr<MappedFile> pMappedFile;
             fileName.Format("%s.skm", resourceName.GetCharArray());
-            pStream = g_pVirtualFileSystem->OpenFile(fileName, BYTESTREAM_OPEN_READ | BYTESTREAM_OPEN_STREAMED);
-            if (pStream != nullptr)
+            pMappedFile = g_pVirtualFileSystem->MapFile(fileName);
+            if (pMappedFile != nullptr)
             {
                 // load it
                 pSkeletalMesh = new SkeletalMesh();
-                if (!pSkeletalMesh->LoadFromStream(resourceName, pStream))
+                if (!pSkeletalMesh->LoadFromMapping(resourceName, pMappedFile))
                 {
                     // log the error, then try to recompile it
                     Log_ErrorPrintf("ResourceManager::LoadSkeletalMesh: Failed to load SkeletalMesh '%s', read failed.", resourceName.GetCharArray());
@@ -1969,6 +2047,9 @@ SkeletalMesh *ResourceManager::LoadSkeletalMesh(const char *Name)
 
 const SkeletalMesh *ResourceManager::GetSkeletalMesh(const char *name)
 {
+    if (s_pAsyncLoadDependencies != nullptr)
+        return static_cast<const SkeletalMesh *>(GetAsyncLoadDependency(SkeletalMesh::StaticTypeInfo(), name));
+
     SkeletalMeshTable::Member *pMember = m_htSkeletalMesh.Find(name);
     if (pMember == nullptr)
     {
@@ -1998,6 +2079,10 @@ const SkeletalMesh *ResourceManager::UncachedGetSkeletalMesh(const char *Name)
 
 const SkeletalMesh *ResourceManager::GetDefaultSkeletalMesh()
 {
+    // the cached default is only written on the main thread, loader threads fetch it with the request
+    if (s_pAsyncLoadDependencies != nullptr)
+        return static_cast<const SkeletalMesh *>(GetAsyncLoadDefault(SkeletalMesh::StaticTypeInfo(), g_pEngine->GetDefaultBlockMeshName()));
+
     if (m_pDefaultSkeletalMesh == nullptr && (m_pDefaultSkeletalMesh = GetSkeletalMesh(g_pEngine->GetDefaultBlockMeshName())) == nullptr)
         Panic("GetDefaultSkeletalMesh() called, and the default mesh failed to load.");
 
@@ -2117,6 +2202,9 @@ SkeletalAnimation *ResourceManager::LoadSkeletalAnimation(const char *Name)
 
 const SkeletalAnimation *ResourceManager::GetSkeletalAnimation(const char *name)
 {
+    if (s_pAsyncLoadDependencies != nullptr)
+        return static_cast<const SkeletalAnimation *>(GetAsyncLoadDependency(SkeletalAnimation::StaticTypeInfo(), name));
+
     SkeletalAnimationTable::Member *pMember = m_htSkeletalAnimation.Find(name);
     if (pMember == nullptr)
     {
@@ -2244,6 +2332,9 @@ ParticleSystem *ResourceManager::LoadParticleSystem(const char *Name)
 
 const ParticleSystem *ResourceManager::GetParticleSystem(const char *name)
 {
+    if (s_pAsyncLoadDependencies != nullptr)
+        return static_cast<const ParticleSystem *>(GetAsyncLoadDependency(ParticleSystem::StaticTypeInfo(), name));
+
     m_resourceLock.LockShared();
 
     ParticleSystemTable::Member *pMember = m_htParticleSystem.Find(name);
@@ -2706,6 +2797,28 @@ const Resource *ResourceManager::UncachedGetResource(const ResourceTypeInfo *pRe
     return NULL;
 }
 
+const Resource *ResourceManager::GetDefaultResource(const ResourceTypeInfo *pResourceTypeInfo)
+{
+    if (pResourceTypeInfo == Texture2D::StaticTypeInfo())
+        return GetDefaultTexture2D();
+    else if (pResourceTypeInfo == Texture2DArray::StaticTypeInfo())
+        return GetDefaultTexture2DArray();
+    else if (pResourceTypeInfo == TextureCube::StaticTypeInfo())
+        return GetDefaultTextureCube();
+    else if (pResourceTypeInfo == Material::StaticTypeInfo())
+        return GetDefaultMaterial();
+    else if (pResourceTypeInfo == MaterialShader::StaticTypeInfo())
+        return GetDefaultMaterialShader();
+    else if (pResourceTypeInfo == StaticMesh::StaticTypeInfo())
+        return GetDefaultStaticMesh();
+    else if (pResourceTypeInfo == BlockMesh::StaticTypeInfo())
+        return GetDefaultBlockMesh();
+    else if (pResourceTypeInfo == SkeletalMesh::StaticTypeInfo())
+        return GetDefaultSkeletalMesh();
+
+    return nullptr;
+}
+
 void ResourceManager::SetResourceModificationDetectionEnabled(bool enabled)
 {
     if (!enabled)
@@ -2755,35 +2868,23 @@ void ResourceManager::CheckForModifiedResources()
 ResourceCompilerInterface *ResourceManager::GetResourceCompilerInterface()
 {
 #if defined(WITH_RESOURCECOMPILER_SUBPROCESS)
-    // hold the lock
+    // each caller gets its own interface, so compiles on several threads don't wait on each other.
+    // the lock only covers the idle list.
     m_resourceCompilerLock.Lock();
-
-    // primary in use?
-    if (m_resourceCompilerInUse)
+    if (m_idleResourceCompilerInterfaces.GetSize() > 0)
     {
-        // resource compiler is in use, so spawn another one
-        return ResourceCompilerInterface::CreateRemoteInterface();
-    }
-
-    // if there's an existing interface, use it
-    if (m_pResourceCompilerInterface != nullptr)
-    {
-        m_resourceCompilerInUse = true;
-        return m_pResourceCompilerInterface;
+        ResourceCompilerInterface *pInterface = m_idleResourceCompilerInterfaces.PopBack();
+        m_resourceCompilerLock.Unlock();
+        return pInterface;
     }
+    m_resourceCompilerLock.Unlock();
 
-    // spawn nw
-    m_pResourceCompilerInterface = ResourceCompilerInterface::CreateRemoteInterface();
-    if (m_pResourceCompilerInterface == nullptr)
-    {
+    // none idle, spawn another
+    ResourceCompilerInterface *pInterface = ResourceCompilerInterface::CreateRemoteInterface();
+    if (pInterface == nullptr)
         Log_ErrorPrintf("ResourceManager::GetResourceCompilerInterface: Failed to create interface.");
-        m_resourceCompilerLock.Unlock();
-        return nullptr;
-    }
 
-    m_resourceCompilerInUse = true;
-    m_resourceCompilerSpawnTime.Reset();
-    return m_pResourceCompilerInterface;
+    return pInterface;
 #else
     Log_ErrorPrintf("ResourceManager::GetResourceCompilerInterface: This engine was not built with ResourceCompiler support.");
     return nullptr;
@@ -2793,31 +2894,524 @@ ResourceCompilerInterface *ResourceManager::GetResourceCompilerInterface()
 void ResourceManager::ReleaseResourceCompilerInterface(ResourceCompilerInterface *pInterface)
 {
 #if defined(WITH_RESOURCECOMPILER_SUBPROCESS)
-    if (pInterface == m_pResourceCompilerInterface)
+    // if there is a zero delay, just close it immediately
+    if (CVars::rm_remote_resource_compiler_close_delay.GetUInt() == 0)
     {
-        DebugAssert(m_resourceCompilerInUse);
-        m_resourceCompilerInUse = false;
+        pInterface->Release();
+        return;
+    }
 
-        // if there is a zero delay, just close it immediately
-        if (CVars::rm_remote_resource_compiler_close_delay.GetUInt() == 0)
+    // keep it for the next caller, Update() closes them once they have been idle for long enough
+    m_resourceCompilerLock.Lock();
+    m_idleResourceCompilerInterfaces.Add(pInterface);
+    m_resourceCompilerIdleTime.Reset();
+    m_resourceCompilerLock.Unlock();
+#endif      // WITH_RESOURCECOMPILER_SUBPROCESS
+}
+
+Resource *ResourceManager::LoadResource(const ResourceTypeInfo *pResourceTypeInfo, const char *name)
+{
+    if (pResourceTypeInfo->IsDerived(Texture::StaticTypeInfo()))
+        return LoadTexture(name);
+    else if (pResourceTypeInfo == Material::StaticTypeInfo())
+        return LoadMaterial(name);
+    else if (pResourceTypeInfo == MaterialShader::StaticTypeInfo())
+        return LoadMaterialShader(name);
+    else if (pResourceTypeInfo == Font::StaticTypeInfo())
+        return LoadFont(name);
+    else if (pResourceTypeInfo == BlockPalette::StaticTypeInfo())
+        return LoadBlockPalette(name);
+    else if (pResourceTypeInfo == TerrainLayerList::StaticTypeInfo())
+        return LoadTerrainLayerList(name);
+    else if (pResourceTypeInfo == StaticMesh::StaticTypeInfo())
+        return LoadStaticMesh(name);
+    else if (pResourceTypeInfo == BlockMesh::StaticTypeInfo())
+        return LoadBlockMesh(name);
+    else if (pResourceTypeInfo == Skeleton::StaticTypeInfo())
+        return LoadSkeleton(name);
+    else if (pResourceTypeInfo == SkeletalMesh::StaticTypeInfo())
+        return LoadSkeletalMesh(name);
+    else if (pResourceTypeInfo == SkeletalAnimation::StaticTypeInfo())
+        return LoadSkeletalAnimation(name);
+    else if (pResourceTypeInfo == ParticleSystem::StaticTypeInfo())
+        return LoadParticleSystem(name);
+
+    return nullptr;
+}
+
+template<class T>
+static const Resource *FindInResourceTable(CIStringHashTable<T *> &table, const char *name)
+{
+    // failed loads are stored as null
+    typename CIStringHashTable<T *>::Member *pMember = table.Find(name);
+    if (pMember == nullptr || pMember->Value == nullptr)
+        return nullptr;
+
+    pMember->Value->AddRef();
+    return pMember->Value;
+}
+
+template<class T>
+static const Resource *InsertIntoResourceTable(CIStringHashTable<T *> &table, T *pResource)
+{
+    // the table takes the loader's reference, unless someone else loaded it in the meantime
+    typename CIStringHashTable<T *>::Member *pMember = table.Find(pResource->GetName().GetCharArray());
+    if (pMember == nullptr)
+        pMember = table.Insert(pResource->GetName().GetCharArray(), pResource);
+    else if (pMember->Value == nullptr)
+        pMember->Value = pResource;
+    else
+        pResource->Release();
+
+    pMember->Value->AddRef();
+    return pMember->Value;
+}
+
+const Resource *ResourceManager::GetLoadedResource(const ResourceTypeInfo *pResourceTypeInfo, const char *name)
+{
+    const Resource *pResource = nullptr;
+    m_resourceLock.LockShared();
+
+    if (pResourceTypeInfo->IsDerived(Texture::StaticTypeInfo()))
+        pResource = FindInResourceTable(m_htTextures, name);
+    else if (pResourceTypeInfo == Material::StaticTypeInfo())
+        pResource = FindInResourceTable(m_htMaterials, name);
+    else if (pResourceTypeInfo == MaterialShader::StaticTypeInfo())
+        pResource = FindInResourceTable(m_htMaterialShaders, name);
+    else if (pResourceTypeInfo == Font::StaticTypeInfo())
+        pResource = FindInResourceTable(m_htFonts, name);
+    else if (pResourceTypeInfo == BlockPalette::StaticTypeInfo())
+        pResource = FindInResourceTable(m_htBlockPalette, name);
+    else if (pResourceTypeInfo == TerrainLayerList::StaticTypeInfo())
+        pResource = FindInResourceTable(m_htTerrainLayerList, name);
+    else if (pResourceTypeInfo == StaticMesh::StaticTypeInfo())
+        pResource = FindInResourceTable(m_htStaticMeshes, name);
+    else if (pResourceTypeInfo == BlockMesh::StaticTypeInfo())
+        pResource = FindInResourceTable(m_htBlockMesh, name);
+    else if (pResourceTypeInfo == Skeleton::StaticTypeInfo())
+        pResource = FindInResourceTable(m_htSkeleton, name);
+    else if (pResourceTypeInfo == SkeletalMesh::StaticTypeInfo())
+        pResource = FindInResourceTable(m_htSkeletalMesh, name);
+    else if (pResourceTypeInfo == SkeletalAnimation::StaticTypeInfo())
+        pResource = FindInResourceTable(m_htSkeletalAnimation, name);
+    else if (pResourceTypeInfo == ParticleSystem::StaticTypeInfo())
+        pResource = FindInResourceTable(m_htParticleSystem, name);
+
+    m_resourceLock.UnlockShared();
+    return pResource;
+}
+
+const Resource *ResourceManager::InsertLoadedResource(Resource *pResource)
+{
+    const ResourceTypeInfo *pResourceTypeInfo = pResource->GetResourceTypeInfo();
+    const Resource *pStoredResource = nullptr;
+    m_resourceLock.LockExclusive();
+
+    if (pResourceTypeInfo->IsDerived(Texture::StaticTypeInfo()))
+        pStoredResource = InsertIntoResourceTable(m_htTextures, static_cast<Texture *>(pResource));
+    else if (pResourceTypeInfo == Material::StaticTypeInfo())
+        pStoredResource = InsertIntoResourceTable(m_htMaterials, static_cast<Material *>(pResource));
+    else if (pResourceTypeInfo == MaterialShader::StaticTypeInfo())
+        pStoredResource = InsertIntoResourceTable(m_htMaterialShaders, static_cast<MaterialShader *>(pResource));
+    else if (pResourceTypeInfo == Font::StaticTypeInfo())
+        pStoredResource = InsertIntoResourceTable(m_htFonts, static_cast<Font *>(pResource));
+    else if (pResourceTypeInfo == BlockPalette::StaticTypeInfo())
+        pStoredResource = InsertIntoResourceTable(m_htBlockPalette, static_cast<BlockPalette *>(pResource));
+    else if (pResourceTypeInfo == TerrainLayerList::StaticTypeInfo())
+        pStoredResource = InsertIntoResourceTable(m_htTerrainLayerList, static_cast<TerrainLayerList *>(pResource));
+    else if (pResourceTypeInfo == StaticMesh::StaticTypeInfo())
+        pStoredResource = InsertIntoResourceTable(m_htStaticMeshes, static_cast<StaticMesh *>(pResource));
+    else if (pResourceTypeInfo == BlockMesh::StaticTypeInfo())
+        pStoredResource = InsertIntoResourceTable(m_htBlockMesh, static_cast<BlockMesh *>(pResource));
+    else if (pResourceTypeInfo == Skeleton::StaticTypeInfo())
+        pStoredResource = InsertIntoResourceTable(m_htSkeleton, static_cast<Skeleton *>(pResource));
+    else if (pResourceTypeInfo == SkeletalMesh::StaticTypeInfo())
+        pStoredResource = InsertIntoResourceTable(m_htSkeletalMesh, static_cast<SkeletalMesh *>(pResource));
+    else if (pResourceTypeInfo == SkeletalAnimation::StaticTypeInfo())
+        pStoredResource = InsertIntoResourceTable(m_htSkeletalAnimation, static_cast<SkeletalAnimation *>(pResource));
+    else if (pResourceTypeInfo == ParticleSystem::StaticTypeInfo())
+        pStoredResource = InsertIntoResourceTable(m_htParticleSystem, static_cast<ParticleSystem *>(pResource));
+    else
+        pResource->Release();
+
+    m_resourceLock.UnlockExclusive();
+    return pStoredResource;
+}
+
+const Resource *ResourceManager::GetAsyncLoadDependency(const ResourceTypeInfo *pResourceTypeInfo, const char *name)
+{
+    const Resource *pResource = GetLoadedResource(pResourceTypeInfo, name);
+    if (pResource != nullptr)
+        return pResource;
+
+    // may already have been loaded for another part of the same request
+    PODArray<Resource *> &dependencies = *s_pAsyncLoadDependencies;
+    for (uint32 i = 0; i < dependencies.GetSize(); i++)
+    {
+        if (dependencies[i]->GetResourceTypeInfo()->IsDerived(pResourceTypeInfo) && dependencies[i]->GetName().CompareInsensitive(name))
         {
-            m_pResourceCompilerInterface->Release();
-            m_pResourceCompilerInterface = nullptr;
+            dependencies[i]->AddRef();
+            return dependencies[i];
         }
     }
+
+    // gpu resources are created with the request, so this is added after its own dependencies
+    Resource *pLoadedResource = LoadResource(pResourceTypeInfo, name);
+    if (pLoadedResource == nullptr)
+        return nullptr;
+
+    pLoadedResource->AddRef();
+    dependencies.Add(pLoadedResource);
+    return pLoadedResource;
+}
+
+const Resource *ResourceManager::GetAsyncLoadDefault(const ResourceTypeInfo *pResourceTypeInfo, const char *name)
+{
+    const Resource *pResource = GetAsyncLoadDependency(pResourceTypeInfo, name);
+    if (pResource == nullptr)
+    {
+        Log_ErrorPrintf("ResourceManager::GetAsyncLoadDefault: Default %s '%s' failed to load.", pResourceTypeInfo->GetTypeName(), name);
+        Panic("Default resource requested by an asynchronous load, and the default failed to load.");
+    }
+
+    return pResource;
+}
+
+static void GetAsyncRequestKey(const ResourceTypeInfo *pResourceTypeInfo, const char *name, String &key)
+{
+    key.Format("%s:%s", pResourceTypeInfo->GetTypeName(), name);
+}
+
+static bool CheckAsyncRequestResourceType(const Resource *pResource, const ResourceTypeInfo *pResourceTypeInfo)
+{
+    if (pResource->GetResourceTypeInfo()->IsDerived(pResourceTypeInfo))
+        return true;
+
+    Log_ErrorPrintf("RESOURCE TYPE MISMATCH: Attempting to access resource '%s' as a %s, when it is a %s", pResource->GetName().GetCharArray(), pResourceTypeInfo->GetTypeName(), pResource->GetResourceTypeInfo()->GetTypeName());
+    return false;
+}
+
+// creates the gpu resources for resources loaded with device resource creation deferred, called on the render thread
+static bool CreateLoadedResourceDeviceResources(const Resource *pResource)
+{
+    const ResourceTypeInfo *pResourceTypeInfo = pResource->GetResourceTypeInfo();
+    if (pResourceTypeInfo->IsDerived(Texture::StaticTypeInfo()))
+        return static_cast<const Texture *>(pResource)->CreateDeviceResources();
+    else if (pResourceTypeInfo == Material::StaticTypeInfo())
+        return static_cast<const Material *>(pResource)->CreateDeviceResources();
+    else if (pResourceTypeInfo == StaticMesh::StaticTypeInfo())
+        return static_cast<const StaticMesh *>(pResource)->CreateGPUResources();
+    else if (pResourceTypeInfo == BlockMesh::StaticTypeInfo())
+        return static_cast<const BlockMesh *>(pResource)->CreateGPUResources();
+    else if (pResourceTypeInfo == SkeletalMesh::StaticTypeInfo())
+        return static_cast<const SkeletalMesh *>(pResource)->CreateGPUResources();
+    else if (pResourceTypeInfo == BlockPalette::StaticTypeInfo())
+        return static_cast<const BlockPalette *>(pResource)->CreateGPUResources();
+    else if (pResourceTypeInfo == TerrainLayerList::StaticTypeInfo())
+        return static_cast<const TerrainLayerList *>(pResource)->CreateGPUResources();
+
+    // everything else creates its gpu resources when loaded
+    return true;
+}
+
+ResourceManager::AsyncLoadRequest::AsyncLoadRequest(const ResourceTypeInfo *pResourceTypeInfo, const char *resourceName, AsyncLoadPriority priority)
+    : m_pResourceTypeInfo(pResourceTypeInfo),
+      m_resourceName(resourceName),
+      m_priority(priority),
+      m_pLoadedResource(nullptr),
+      m_pResource(nullptr),
+      m_complete(false)
+{
+
+}
+
+ResourceManager::AsyncLoadRequest::~AsyncLoadRequest()
+{
+    for (uint32 i = 0; i < m_callbacks.GetSize(); i++)
+        delete m_callbacks[i];
+
+    for (uint32 i = 0; i < m_dependencies.GetSize(); i++)
+        m_dependencies[i]->Release();
+
+    SAFE_RELEASE(m_pLoadedResource);
+    SAFE_RELEASE(m_pResource);
+}
+
+const Resource *ResourceManager::AsyncLoadRequest::GetResource() const
+{
+    if (m_pResource != nullptr)
+    {
+        m_pResource->AddRef();
+        return m_pResource;
+    }
+
+    return g_pResourceManager->GetDefaultResource(m_pResourceTypeInfo);
+}
+
+bool ResourceManager::IsDeviceResourceCreationDeferred()
+{
+    return (s_pAsyncLoadDependencies != nullptr);
+}
+
+ResourceManager::AsyncLoadRequest *ResourceManager::RequestResourceAsync(const ResourceTypeInfo *pResourceTypeInfo, const char *name, AsyncLoadPriority priority /* = AsyncLoadPriority_Normal */, AsyncLoadCallback *pCallback /* = nullptr */)
+{
+    DebugAssert(priority < AsyncLoadPriority_Count);
+
+    // already being loaded? share the request
+    SmallString requestKey;
+    GetAsyncRequestKey(pResourceTypeInfo, name, requestKey);
+    AsyncLoadRequestTable::Member *pMember = m_htAsyncRequests.Find(requestKey.GetCharArray());
+    if (pMember != nullptr)
+    {
+        AsyncLoadRequest *pRequest = pMember->Value;
+        if (pCallback != nullptr)
+            pRequest->m_callbacks.Add(pCallback);
+
+        // move it up the queue if it hasn't been picked up by a loader thread yet
+        if (priority > pRequest->m_priority)
+        {
+            MutexLock lock(m_asyncRequestLock);
+            int32 pendingIndex = m_asyncPendingRequests[pRequest->m_priority].IndexOf(pRequest);
+            if (pendingIndex >= 0)
+            {
+                m_asyncPendingRequests[pRequest->m_priority].OrderedRemove(pendingIndex);
+                m_asyncPendingRequests[priority].Add(pRequest);
+            }
+
+            pRequest->m_priority = priority;
+        }
+
+        pRequest->AddRef();
+        return pRequest;
+    }
+
+    AsyncLoadRequest *pRequest = new AsyncLoadRequest(pResourceTypeInfo, name, priority);
+    if (pCallback != nullptr)
+        pRequest->m_callbacks.Add(pCallback);
+
+    // already loaded? complete it straight away
+    const Resource *pResource = GetLoadedResource(pResourceTypeInfo, name);
+    if (pResource != nullptr)
+    {
+        if (!CheckAsyncRequestResourceType(pResource, pResourceTypeInfo))
+            SAFE_RELEASE(pResource);
+
+        CompleteAsyncRequest(pRequest, pResource);
+        return pRequest;
+    }
+
+    if (!m_asyncLoaderThreadsStarted)
+        StartAsyncLoaderThreads();
+
+    // the table holds a reference until the request completes
+    pRequest->AddRef();
+    m_htAsyncRequests.Insert(requestKey.GetCharArray(), pRequest);
+    {
+        MutexLock lock(m_asyncRequestLock);
+        m_asyncPendingRequests[priority].Add(pRequest);
+    }
+
+    m_asyncLoaderTaskQueue.QueueLambdaTask([this]() { ExecuteAsyncLoad(); });
+    return pRequest;
+}
+
+void ResourceManager::StartAsyncLoaderThreads()
+{
+    // loads fall back to the default resources on the loader threads, they have to be created here first
+    GetDefaultTexture2D()->Release();
+    GetDefaultTexture2DArray()->Release();
+    GetDefaultTextureCube()->Release();
+    GetDefaultMaterial()->Release();
+
+    uint32 loaderThreadCount = CVars::rm_async_load_threads.GetUInt();
+
+    // HTML5 has no threads.
+#ifdef Y_PLATFORM_HTML5
+    loaderThreadCount = 0;
+#endif
+
+    // without loader threads, the tasks are executed as they are queued
+    if (loaderThreadCount == 0 || !m_asyncLoaderTaskQueue.Initialize(TaskQueue::DefaultQueueSize, loaderThreadCount))
+    {
+        if (loaderThreadCount > 0)
+            Log_WarningPrintf("ResourceManager::StartAsyncLoaderThreads: Failed to create %u loader threads, loading on the calling thread.", loaderThreadCount);
+
+        m_asyncLoaderTaskQueue.Initialize((uint32)0, 0);
+    }
     else
     {
-        // was one of the extra spawned ones, so just despawn it
-        pInterface->Release();
+        Log_DevPrintf("ResourceManager::StartAsyncLoaderThreads: Created %u loader threads.", loaderThreadCount);
     }
 
-    // release lock
-    m_resourceCompilerLock.Unlock();
-#endif      // WITH_RESOURCECOMPILER_SUBPROCESS
+    m_asyncLoaderThreadsStarted = true;
+}
+
+void ResourceManager::StopAsyncLoaderThreads()
+{
+    if (!m_asyncLoaderThreadsStarted)
+        return;
+
+    // let the loader threads finish what they are working on, the results are discarded
+    m_asyncLoaderTaskQueue.ExitWorkers();
+    m_asyncLoaderThreadsStarted = false;
+
+    for (uint32 i = 0; i < AsyncLoadPriority_Count; i++)
+        m_asyncPendingRequests[i].Obliterate();
+    m_asyncCompletedRequests.Obliterate();
+
+    // callbacks are not fired, anyone holding a handle sees it as failed
+    for (AsyncLoadRequestTable::Iterator itr = m_htAsyncRequests.Begin(); !itr.AtEnd();)
+    {
+        AsyncLoadRequestTable::Member *pMember = &(*itr++);
+        AsyncLoadRequest *pRequest = pMember->Value;
+        for (uint32 i = 0; i < pRequest->m_callbacks.GetSize(); i++)
+            delete pRequest->m_callbacks[i];
+        pRequest->m_callbacks.Obliterate();
+        SAFE_RELEASE(pRequest->m_pLoadedResource);
+        pRequest->m_complete = true;
+        pRequest->Release();
+
+        m_htAsyncRequests.Remove(pMember);
+    }
+}
+
+void ResourceManager::ExecuteAsyncLoad()
+{
+    // take the highest priority request, which is not necessarily the one that queued this task
+    AsyncLoadRequest *pRequest = nullptr;
+    {
+        MutexLock lock(m_asyncRequestLock);
+        for (int32 priority = AsyncLoadPriority_Count - 1; priority >= 0 && pRequest == nullptr; priority--)
+        {
+            if (m_asyncPendingRequests[priority].GetSize() > 0)
+                pRequest = m_asyncPendingRequests[priority].PopFront();
+        }
+    }
+    if (pRequest == nullptr)
+        return;
+
+    // read and decode the resource here, the gpu upload is batched by Update()
+    s_pAsyncLoadDependencies = &pRequest->m_dependencies;
+    pRequest->m_pLoadedResource = LoadResource(pRequest->m_pResourceTypeInfo, pRequest->m_resourceName);
+    s_pAsyncLoadDependencies = nullptr;
+
+    MutexLock lock(m_asyncRequestLock);
+    m_asyncCompletedRequests.Add(pRequest);
+}
+
+void ResourceManager::CompleteAsyncRequest(AsyncLoadRequest *pRequest, const Resource *pResource)
+{
+    // takes ownership of the resource reference
+    DebugAssert(!pRequest->m_complete && pRequest->m_pResource == nullptr);
+    pRequest->m_pResource = pResource;
+    pRequest->m_complete = true;
+
+    // callbacks may queue further requests, so copy them out first
+    PODArray<AsyncLoadCallback *> callbacks;
+    callbacks.Swap(pRequest->m_callbacks);
+    for (uint32 i = 0; i < callbacks.GetSize(); i++)
+    {
+        callbacks[i]->Invoke(pResource);
+        delete callbacks[i];
+    }
+}
+
+void ResourceManager::UpdateAsyncRequests()
+{
+    if (m_htAsyncRequests.GetMemberCount() == 0)
+        return;
+
+    // pick up completed loads, limited to the batch size so a burst of completions doesn't stall the render thread
+    PODArray<AsyncLoadRequest *> completedRequests;
+    {
+        MutexLock lock(m_asyncRequestLock);
+        uint32 batchSize = CVars::rm_async_upload_batch_size.GetUInt();
+        while (m_asyncCompletedRequests.GetSize() > 0 && (batchSize == 0 || completedRequests.GetSize() < batchSize))
+            completedRequests.Add(m_asyncCompletedRequests.PopFront());
+    }
+    if (completedRequests.GetSize() == 0)
+        return;
+
+    // create the gpu resources for the whole batch in one render thread command. anything using these resources
+    // is queued to the render thread after this, so the upload always happens first.
+    if (g_pRenderer != nullptr)
+    {
+        PODArray<const Resource *> *pUploadResources = new PODArray<const Resource *>();
+        for (uint32 i = 0; i < completedRequests.GetSize(); i++)
+        {
+            const Resource *pResource = completedRequests[i]->m_pLoadedResource;
+            if (pResource != nullptr)
+            {
+                // dependencies first, the resource may look up their gpu resources when creating its own
+                const PODArray<Resource *> &dependencies = completedRequests[i]->m_dependencies;
+                for (uint32 j = 0; j < dependencies.GetSize(); j++)
+                {
+                    dependencies[j]->AddRef();
+                    pUploadResources->Add(dependencies[j]);
+                }
+
+                pResource->AddRef();
+                pUploadResources->Add(pResource);
+            }
+        }
+
+        QUEUE_RENDERER_LAMBDA_COMMAND([pUploadResources]()
+        {
+            for (uint32 i = 0; i < pUploadResources->GetSize(); i++)
+            {
+                const Resource *pResource = pUploadResources->GetElement(i);
+                if (!CreateLoadedResourceDeviceResources(pResource))
+                    Log_ErrorPrintf("ResourceManager: GPU upload of %s '%s' failed.", pResource->GetResourceTypeInfo()->GetTypeName(), pResource->GetName().GetCharArray());
+
+                pResource->Release();
+            }
+
+            delete pUploadResources;
+        });
+    }
+
+    // publish to the resource tables, and notify the requesters
+    SmallString requestKey;
+    for (uint32 i = 0; i < completedRequests.GetSize(); i++)
+    {
+        AsyncLoadRequest *pRequest = completedRequests[i];
+        GetAsyncRequestKey(pRequest->m_pResourceTypeInfo, pRequest->m_resourceName, requestKey);
+        AsyncLoadRequestTable::Member *pMember = m_htAsyncRequests.Find(requestKey.GetCharArray());
+        DebugAssert(pMember != nullptr && pMember->Value == pRequest);
+        m_htAsyncRequests.Remove(pMember);
+
+        const Resource *pResource = nullptr;
+        if (pRequest->m_pLoadedResource != nullptr)
+        {
+            // the tables take the request's references
+            for (uint32 j = 0; j < pRequest->m_dependencies.GetSize(); j++)
+            {
+                const Resource *pDependency = InsertLoadedResource(pRequest->m_dependencies[j]);
+                if (pDependency != nullptr)
+                    pDependency->Release();
+            }
+            pRequest->m_dependencies.Clear();
+
+            pResource = InsertLoadedResource(pRequest->m_pLoadedResource);
+            pRequest->m_pLoadedResource = nullptr;
+            if (pResource != nullptr && !CheckAsyncRequestResourceType(pResource, pRequest->m_pResourceTypeInfo))
+                SAFE_RELEASE(pResource);
+        }
+        else
+        {
+            Log_WarningPrintf("ResourceManager::UpdateAsyncRequests: Asynchronous load of %s '%s' failed.", pRequest->m_pResourceTypeInfo->GetTypeName(), pRequest->m_resourceName.GetCharArray());
+        }
+
+        CompleteAsyncRequest(pRequest, pResource);
+        pRequest->Release();
+    }
 }
 
 void ResourceManager::Update()
 {
+    // hand over any asynchronously loaded resources
+    UpdateAsyncRequests();
+
     // perform maintenance
     uint32 timeDiff = (uint32)Math::Truncate((float)m_lastMaintenanceTime.GetTimeSeconds());
     if (timeDiff >= CVars::rm_maintenance_interval.GetUInt())
@@ -2826,17 +3420,17 @@ void ResourceManager::Update()
         CheckForModifiedResources();
 
 #if defined(WITH_RESOURCECOMPILER_SUBPROCESS)
-        // release resource compiler if it hasn't been used in x time
-        // potential race here, it just means we'll miss cleaning it up for a loop, which
+        // release resource compilers if they haven't been used in x time
+        // potential race here, it just means we'll miss cleaning them up for a loop, which
         // is unlikely to have the time elapsed anyway, and it saves locking every frame
-        if (m_pResourceCompilerInterface != nullptr && m_resourceCompilerLock.TryLock())
+        if (m_idleResourceCompilerInterfaces.GetSize() > 0 && m_resourceCompilerLock.TryLock())
         {
-            uint32 timeElapsed = (uint32)Math::Truncate((float)m_resourceCompilerSpawnTime.GetTimeSeconds());
-            if (!m_resourceCompilerInUse && timeElapsed >= CVars::rm_remote_resource_compiler_close_delay.GetUInt())
+            uint32 timeElapsed = (uint32)Math::Truncate((float)m_resourceCompilerIdleTime.GetTimeSeconds());
+            if (timeElapsed >= CVars::rm_remote_resource_compiler_close_delay.GetUInt())
             {
-                // release him
-                m_pResourceCompilerInterface->Release();
-                m_pResourceCompilerInterface = nullptr;
+                // release them
+                while (m_idleResourceCompilerInterfaces.GetSize() > 0)
+                    m_idleResourceCompilerInterfaces.PopBack()->Release();
             }
             m_resourceCompilerLock.Unlock();
         }
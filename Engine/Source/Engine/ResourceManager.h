@@ -1,5 +1,6 @@
 #pragma once
 #include "Engine/Common.h"
+#include "YBaseLib/TaskQueue.h"
 
 class Resource;
 class Texture;
@@ -24,6 +25,57 @@ class ResourceCompilerInterface;
 class ResourceManager
 {
 public:
+    // priority of asynchronous requests, higher priority requests are loaded first
+    enum AsyncLoadPriority
+    {
+        AsyncLoadPriority_Low,
+        AsyncLoadPriority_Normal,
+        AsyncLoadPriority_High,
+        AsyncLoadPriority_Count,
+    };
+
+    // invoked on the main thread when an asynchronous request completes, the resource is null if the load failed.
+    // the callback does not own a reference to the resource, it should AddRef it if it is kept.
+    typedef FunctorA1<const Resource *> AsyncLoadCallback;
+
+    // handle to an asynchronous request, shared by every caller requesting the same resource
+    class AsyncLoadRequest : public ReferenceCounted
+    {
+        friend class ResourceManager;
+
+    public:
+        ~AsyncLoadRequest();
+
+        const ResourceTypeInfo *GetResourceTypeInfo() const { return m_pResourceTypeInfo; }
+        const String &GetResourceName() const { return m_resourceName; }
+        AsyncLoadPriority GetPriority() const { return m_priority; }
+
+        // only changes during ResourceManager::Update, so can be polled from the main thread
+        bool IsComplete() const { return m_complete; }
+        bool IsLoaded() const { return (m_pResource != nullptr); }
+
+        // returns the loaded resource, or the default resource for the type while loading or if the load failed. the caller owns the reference.
+        const Resource *GetResource() const;
+
+    private:
+        AsyncLoadRequest(const ResourceTypeInfo *pResourceTypeInfo, const char *resourceName, AsyncLoadPriority priority);
+
+        const ResourceTypeInfo *m_pResourceTypeInfo;
+        String m_resourceName;
+        AsyncLoadPriority m_priority;
+
+        // set by the loader thread, not published until the upload is queued
+        Resource *m_pLoadedResource;
+
+        // resources the loaded resource needed that were not loaded yet, uploaded and published before it
+        PODArray<Resource *> m_dependencies;
+
+        // published resource
+        const Resource *m_pResource;
+        PODArray<AsyncLoadCallback *> m_callbacks;
+        bool m_complete;
+    };
+
     ResourceManager();
     ~ResourceManager();
 
@@ -76,6 +128,20 @@ public:
     const SkeletalAnimation *UncachedGetSkeletalAnimation(const char *name);
     const ParticleSystem *UncachedGetParticleSystem(const char *name);
 
+    // default resource for the type, or null if the type has no default
+    const Resource *GetDefaultResource(const ResourceTypeInfo *pResourceTypeInfo);
+
+    // Queues a resource to be loaded on the loader threads, call from the main thread. Requests for a resource that is already being loaded share the same
+    // handle, and raise its priority if needed. The callback (which may be null) is owned by the resource manager, and is invoked
+    // immediately if the resource is already loaded, otherwise from Update() once it is available. The caller owns the returned reference.
+    AsyncLoadRequest *RequestResourceAsync(const ResourceTypeInfo *pResourceTypeInfo, const char *name, AsyncLoadPriority priority = AsyncLoadPriority_Normal, AsyncLoadCallback *pCallback = nullptr);
+
+    // number of asynchronous requests that have not completed yet
+    uint32 GetPendingAsyncRequestCount() const { return m_htAsyncRequests.GetMemberCount(); }
+
+    // true if the current thread is loading an asynchronous request, and the gpu resources will be created later
+    static bool IsDeviceResourceCreationDeferred();
+
     void CreateDeviceResources();
     void ReleaseDeviceResources();
 
@@ -118,6 +184,24 @@ private:
     SkeletalMesh *LoadSkeletalMesh(const char *name);
     SkeletalAnimation *LoadSkeletalAnimation(const char *name);
     ParticleSystem *LoadParticleSystem(const char *name);
+    Resource *LoadResource(const ResourceTypeInfo *pResourceTypeInfo, const char *name);
+
+    // looks up an already loaded resource without loading it, adding a reference
+    const Resource *GetLoadedResource(const ResourceTypeInfo *pResourceTypeInfo, const char *name);
+
+    // adds a resource loaded by an asynchronous request to the tables, returns the resource that is stored
+    const Resource *InsertLoadedResource(Resource *pResource);
+
+    // on a loader thread, looks up or loads a resource needed by the request being loaded, without publishing it
+    const Resource *GetAsyncLoadDependency(const ResourceTypeInfo *pResourceTypeInfo, const char *name);
+    const Resource *GetAsyncLoadDefault(const ResourceTypeInfo *pResourceTypeInfo, const char *name);
+
+    // asynchronous loading
+    void StartAsyncLoaderThreads();
+    void StopAsyncLoaderThreads();
+    void ExecuteAsyncLoad();
+    void UpdateAsyncRequests();
+    void CompleteAsyncRequest(AsyncLoadRequest *pRequest, const Resource *pResource);
 
     // resource lock
     ReadWriteLock m_resourceLock;
@@ -169,17 +253,25 @@ private:
     const BlockMesh *m_pDefaultBlockMesh;
     const SkeletalMesh *m_pDefaultSkeletalMesh;
 
+    // asynchronous requests, keyed by type and name. the pending/completed lists are protected by the lock, the table is main thread only.
+    typedef CIStringHashTable<AsyncLoadRequest *> AsyncLoadRequestTable;
+    AsyncLoadRequestTable m_htAsyncRequests;
+    PODArray<AsyncLoadRequest *> m_asyncPendingRequests[AsyncLoadPriority_Count];
+    PODArray<AsyncLoadRequest *> m_asyncCompletedRequests;
+    Mutex m_asyncRequestLock;
+    TaskQueue m_asyncLoaderTaskQueue;
+    bool m_asyncLoaderThreadsStarted;
+
     // maintenance timer
     Timer m_lastMaintenanceTime;
 
     // resource modification detection
     FileSystem::ChangeNotifier *m_pResourceModificationChangeNotifier;
 
-    // resource compiler interface
-    ResourceCompilerInterface *m_pResourceCompilerInterface;
-    Timer m_resourceCompilerSpawnTime;
-    RecursiveMutex m_resourceCompilerLock;
-    bool m_resourceCompilerInUse;
+    // resource compiler interfaces not in use, shared by whichever threads compile next
+    PODArray<ResourceCompilerInterface *> m_idleResourceCompilerInterfaces;
+    Timer m_resourceCompilerIdleTime;
+    Mutex m_resourceCompilerLock;
 };
 
 extern ResourceManager *g_pResourceManager;
@@ -24,96 +24,163 @@ SkeletalAnimation::~SkeletalAnimation()
     delete[] m_pBoneTracks;
 }
 
-void SkeletalAnimation::TransformTrack::GetKeyFrames(float time, const KeyFrame **ppStartKeyFrame, const KeyFrame **ppEndKeyFrame, float *pFactor) const
+// the kept rotation components are within +/- 1/sqrt(2)
+static const float PACKED_ROTATION_RANGE = 0.70710678f;
+static const float PACKED_ROTATION_SCALE = 32767.0f;
+
+// sequential playback moves at most a key or two per sample, past this a binary search is cheaper
+static const uint32 MAX_CURSOR_STEPS = 4;
+
+void SkeletalAnimation::PackRotation(const Quaternion &rotation, PackedRotation *pPackedRotation)
 {
-    DebugAssert(time >= 0.0f);
-    
-    // only one key?
-    if (m_keyFrames.GetSize() == 1)
+    const float *pComponents = rotation;
+
+    // find the largest component
+    uint32 largestIndex = 0;
+    for (uint32 i = 1; i < 4; i++)
     {
-        *ppStartKeyFrame = &m_keyFrames[0];
-        *ppEndKeyFrame = nullptr;
-        *pFactor = 0.0f;
-        return;
+        if (Math::Abs(pComponents[i]) > Math::Abs(pComponents[largestIndex]))
+            largestIndex = i;
     }
 
-    // find the key that we reside in with a time of <= t
-    uint32 keyIndex;
-    for (keyIndex = 0; keyIndex < (m_keyFrames.GetSize() - 1); keyIndex++)
+    // q and -q are the same rotation, so flip it so that the dropped component is positive
+    float sign = (pComponents[largestIndex] < 0.0f) ? -1.0f : 1.0f;
+    uint32 outIndex = 0;
+    for (uint32 i = 0; i < 4; i++)
     {
-        if (time < m_keyFrames[keyIndex + 1].Key)
-            break;
+        if (i == largestIndex)
+            continue;
+
+        float value = Math::Clamp(pComponents[i] * sign, -PACKED_ROTATION_RANGE, PACKED_ROTATION_RANGE);
+        pPackedRotation->Components[outIndex++] = (uint16)((value / PACKED_ROTATION_RANGE * 0.5f + 0.5f) * PACKED_ROTATION_SCALE + 0.5f);
     }
 
-    // is this the last key?
-    uint32 nextKeyIndex = keyIndex + 1;
-    if (nextKeyIndex == m_keyFrames.GetSize())
+    pPackedRotation->Components[0] |= (uint16)((largestIndex & 1) << 15);
+    pPackedRotation->Components[1] |= (uint16)((largestIndex >> 1) << 15);
+}
+
+Quaternion SkeletalAnimation::UnpackRotation(const PackedRotation &packedRotation)
+{
+    uint32 largestIndex = (uint32)(packedRotation.Components[0] >> 15) | ((uint32)(packedRotation.Components[1] >> 15) << 1);
+
+    float components[4];
+    float sumSquares = 0.0f;
+    uint32 inIndex = 0;
+    for (uint32 i = 0; i < 4; i++)
     {
-        // use the last key
-        *ppStartKeyFrame = &m_keyFrames[keyIndex];
-        *ppEndKeyFrame = nullptr;
-        *pFactor = 0.0f;
-        return;
-    }
+        if (i == largestIndex)
+            continue;
 
-    // calculate factor
-    const float thisKeyTime = m_keyFrames[keyIndex].Key;
-    const float nextKeyTime = m_keyFrames[nextKeyIndex].Key;
-    const float factor = (time - thisKeyTime) / (nextKeyTime - thisKeyTime);
-    DebugAssert(factor >= 0.0f && factor <= 1.0f);
+        float value = ((float)(packedRotation.Components[inIndex++] & 0x7FFF) / PACKED_ROTATION_SCALE * 2.0f - 1.0f) * PACKED_ROTATION_RANGE;
+        components[i] = value;
+        sumSquares += value * value;
+    }
 
-    // store values
-    *ppStartKeyFrame = &m_keyFrames[keyIndex];
-    *ppEndKeyFrame = &m_keyFrames[nextKeyIndex];
-    *pFactor = factor;
+    components[largestIndex] = Y_sqrtf(Max(1.0f - sumSquares, 0.0f));
+    return Quaternion(components[0], components[1], components[2], components[3]);
 }
 
-void SkeletalAnimation::TransformTrack::GetBoneTransform(float time, Transform *pTransform, bool interpolate /* = true */) const
+// finds the last key with a time <= time, starting from the cursor. returns the factor towards the following key.
+static float FindKey(const float *pTimes, uint32 keyCount, float time, uint32 *pKeyIndex)
 {
-    // find the keyframes for this time spec
-    const KeyFrame *startKeyFrame;
-    const KeyFrame *endKeyFrame;
-    float factor;
-    GetKeyFrames(time, &startKeyFrame, &endKeyFrame, &factor);
+    // constant stream?
+    if (keyCount == 1)
+    {
+        *pKeyIndex = 0;
+        return 0.0f;
+    }
 
-    // do we have to interpolate
-    if (endKeyFrame != nullptr)
+    // step from the cursor in either direction, reverse playback moves backwards
+    uint32 keyIndex = Min(*pKeyIndex, keyCount - 1);
+    uint32 steps = 0;
+    while (steps < MAX_CURSOR_STEPS)
     {
-        // handle cases where it is very close to zero/one
-        if (Math::NearEqual(factor, 0.0f, Y_FLT_EPSILON))
-        {
-            // use the start keyframe
-            *pTransform = startKeyFrame->Value;
-        }
-        else if (Math::NearEqual(factor, 1.0f, Y_FLT_EPSILON))
-        {
-            // use the end keyframe
-            *pTransform = endKeyFrame->Value;
-        }
+        if (time < pTimes[keyIndex] && keyIndex > 0)
+            keyIndex--;
+        else if ((keyIndex + 1) < keyCount && time >= pTimes[keyIndex + 1])
+            keyIndex++;
         else
+            break;
+
+        steps++;
+    }
+
+    // jumped too far, most likely a loop restart, so binary search for the first key after time
+    if (steps == MAX_CURSOR_STEPS)
+    {
+        uint32 low = 0;
+        uint32 high = keyCount;
+        while (low < high)
         {
-            // allow interpolation?
-            if (interpolate)
-            {
-                // linear interpolate between the two
-                *pTransform = Transform::LinearInterpolate(startKeyFrame->Value, endKeyFrame->Value, factor);
-            }
+            uint32 middle = (low + high) / 2;
+            if (pTimes[middle] <= time)
+                low = middle + 1;
             else
-            {
-                // if factor >= 0.5, use end, otherwise start
-                if (factor < 0.5f)
-                    *pTransform = startKeyFrame->Value;
-                else
-                    *pTransform = endKeyFrame->Value;
-            }
+                high = middle;
         }
+
+        keyIndex = (low > 0) ? (low - 1) : 0;
     }
+
+    *pKeyIndex = keyIndex;
+
+    // last key holds
+    if ((keyIndex + 1) == keyCount)
+        return 0.0f;
+
+    float keyLength = pTimes[keyIndex + 1] - pTimes[keyIndex];
+    return (keyLength > 0.0f) ? Math::Clamp((time - pTimes[keyIndex]) / keyLength, 0.0f, 1.0f) : 0.0f;
+}
+
+// turns the factor between two keys into the amount of the second key to use
+static bool GetInterpolationFactor(float factor, bool interpolate, float *pFactor)
+{
+    if (factor <= Y_FLT_EPSILON)
+        return false;
+
+    if (!interpolate || factor >= (1.0f - Y_FLT_EPSILON))
+        *pFactor = (factor < 0.5f) ? 0.0f : 1.0f;
     else
-    {
-        // only have one keyframe reference
-        DebugAssert(startKeyFrame != nullptr);
-        *pTransform = startKeyFrame->Value;
-    }
+        *pFactor = factor;
+
+    return (*pFactor > 0.0f);
+}
+
+void SkeletalAnimation::TransformTrack::GetBoneTransform(float time, Transform *pTransform, bool interpolate /* = true */) const
+{
+    // start at the first key, jumps search the streams
+    Cursor cursor;
+    cursor.PositionKey = 0;
+    cursor.RotationKey = 0;
+    cursor.ScaleKey = 0;
+    GetBoneTransform(time, &cursor, pTransform, interpolate);
+}
+
+void SkeletalAnimation::TransformTrack::GetBoneTransform(float time, Cursor *pCursor, Transform *pTransform, bool interpolate /* = true */) const
+{
+    DebugAssert(time >= 0.0f);
+    float factor;
+
+    // position
+    float positionFactor = FindKey(m_positionTimes.GetBasePointer(), m_positionTimes.GetSize(), time, &pCursor->PositionKey);
+    if (GetInterpolationFactor(positionFactor, interpolate, &factor))
+        pTransform->SetPosition(m_positions[pCursor->PositionKey].Lerp(m_positions[pCursor->PositionKey + 1], factor));
+    else
+        pTransform->SetPosition(m_positions[pCursor->PositionKey]);
+
+    // rotation
+    float rotationFactor = FindKey(m_rotationTimes.GetBasePointer(), m_rotationTimes.GetSize(), time, &pCursor->RotationKey);
+    if (GetInterpolationFactor(rotationFactor, interpolate, &factor))
+        pTransform->SetRotation(Quaternion::LinearInterpolate(UnpackRotation(m_rotations[pCursor->RotationKey]), UnpackRotation(m_rotations[pCursor->RotationKey + 1]), factor));
+    else
+        pTransform->SetRotation(UnpackRotation(m_rotations[pCursor->RotationKey]));
+
+    // scale
+    float scaleFactor = FindKey(m_scaleTimes.GetBasePointer(), m_scaleTimes.GetSize(), time, &pCursor->ScaleKey);
+    if (GetInterpolationFactor(scaleFactor, interpolate, &factor))
+        pTransform->SetScale(m_scales[pCursor->ScaleKey].Lerp(m_scales[pCursor->ScaleKey + 1], factor));
+    else
+        pTransform->SetScale(m_scales[pCursor->ScaleKey]);
 }
 
 bool SkeletalAnimation::CalculateRelativeBoneTransform(uint32 boneIndex, float time, Transform *pTransform, bool interpolate /* = true */) const
@@ -135,6 +202,20 @@ bool SkeletalAnimation::CalculateRelativeBoneTransform(uint32 boneIndex, float t
     }
 }
 
+bool SkeletalAnimation::CalculateRelativeBoneTransform(uint32 boneIndex, float time, TransformTrack::Cursor *pTrackCursors, Transform *pTransform, bool interpolate /* = true */) const
+{
+    DebugAssert(boneIndex < m_pSkeleton->GetBoneCount());
+
+    // find the track
+    const BoneTrack *pBoneTrack = m_ppBoneIndexToBoneTrack[boneIndex];
+    if (pBoneTrack == nullptr)
+        return false;
+
+    // get the transform for the specified time
+    pBoneTrack->GetBoneTransform(time, &pTrackCursors[pBoneTrack - m_pBoneTracks], pTransform, interpolate);
+    return true;
+}
+
 void SkeletalAnimation::CalculateAbsoluteBoneTransform(uint32 boneIndex, float time, Transform *pTransform, bool interpolate /* = true */) const
 {
     DebugAssert(boneIndex < m_pSkeleton->GetBoneCount());
@@ -270,28 +351,29 @@ bool SkeletalAnimation::LoadFromStream(const char *name, ByteStream *pStream)
     return true;
 }
 
-bool SkeletalAnimation::TransformTrack::LoadKeyFramesFromStream(ByteStream *pStream, float duration, uint32 keyFrameCount)
+bool SkeletalAnimation::TransformTrack::LoadKeyFramesFromStream(ByteStream *pStream, float duration, uint32 positionKeyCount, uint32 rotationKeyCount, uint32 scaleKeyCount)
 {
-    DebugAssert(duration >= 0.0f && keyFrameCount > 0);
-    m_duration = duration;
-    m_keyFrames.Resize(keyFrameCount);
+    DebugAssert(duration >= 0.0f);
+    if (positionKeyCount == 0 || rotationKeyCount == 0 || scaleKeyCount == 0)
+        return false;
 
-    // read in keyframes
-    const uint32 READ_KEYFRAME_COUNT = 16;
-    DF_SKELETALANIMATION_TRANSFORM_TRACK_KEYFRAME readKeyframes[READ_KEYFRAME_COUNT];
-    for (uint32 i = 0; i < keyFrameCount; i += READ_KEYFRAME_COUNT)
+    m_duration = duration;
+    m_positionTimes.Resize(positionKeyCount);
+    m_positions.Resize(positionKeyCount);
+    m_rotationTimes.Resize(rotationKeyCount);
+    m_rotations.Resize(rotationKeyCount);
+    m_scaleTimes.Resize(scaleKeyCount);
+    m_scales.Resize(scaleKeyCount);
+
+    // read each stream straight into the arrays
+    if (!pStream->Read2(m_positionTimes.GetBasePointer(), sizeof(float) * positionKeyCount) ||
+        !pStream->Read2(m_positions.GetBasePointer(), sizeof(float3) * positionKeyCount) ||
+        !pStream->Read2(m_rotationTimes.GetBasePointer(), sizeof(float) * rotationKeyCount) ||
+        !pStream->Read2(m_rotations.GetBasePointer(), sizeof(PackedRotation) * rotationKeyCount) ||
+        !pStream->Read2(m_scaleTimes.GetBasePointer(), sizeof(float) * scaleKeyCount) ||
+        !pStream->Read2(m_scales.GetBasePointer(), sizeof(float3) * scaleKeyCount))
     {
-        uint32 readCount = Min(READ_KEYFRAME_COUNT, keyFrameCount - i);
-        if (!pStream->Read2(readKeyframes, sizeof(DF_SKELETALANIMATION_TRANSFORM_TRACK_KEYFRAME) * readCount))
-            return false;
-
-        for (uint32 j = 0; j < readCount; j++)
-        {
-            DF_SKELETALANIMATION_TRANSFORM_TRACK_KEYFRAME &rkf = readKeyframes[j];
-            KeyFrame &kf = m_keyFrames[i + j];
-            kf.Key = rkf.Time;
-            kf.Value = Transform(float3(rkf.Position), Quaternion(rkf.Rotation[0], rkf.Rotation[1], rkf.Rotation[2], rkf.Rotation[3]), float3(rkf.Scale));
-        }
+        return false;
     }
 
     return true;
@@ -315,7 +397,7 @@ bool SkeletalAnimation::BoneTrack::LoadFromStream(ByteStream *pStream, const Ske
     m_boneIndex = header.BoneIndex;
     
     // read keyframes
-    if (!LoadKeyFramesFromStream(pStream, header.Duration, header.KeyFrameCount))
+    if (!LoadKeyFramesFromStream(pStream, header.Duration, header.PositionKeyCount, header.RotationKeyCount, header.ScaleKeyCount))
         return false;
 
     // done
@@ -330,7 +412,7 @@ bool SkeletalAnimation::RootMotionTrack::LoadFromStream(ByteStream *pStream, con
         return false;
 
     // read keyframes
-    if (!LoadKeyFramesFromStream(pStream, header.Duration, header.KeyFrameCount))
+    if (!LoadKeyFramesFromStream(pStream, header.Duration, header.PositionKeyCount, header.RotationKeyCount, header.ScaleKeyCount))
         return false;
 
     // done
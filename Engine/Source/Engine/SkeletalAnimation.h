@@ -8,27 +8,50 @@ class SkeletalAnimation : public Resource
     DECLARE_RESOURCE_GENERIC_FACTORY(SkeletalAnimation);
 
 public:
+    // rotation quantized to 48 bits, see DF_SKELETALANIMATION_PACKED_ROTATION
+    struct PackedRotation
+    {
+        uint16 Components[3];
+    };
+
     class TransformTrack
     {
     public:
-        typedef KeyValuePair<float, Transform> KeyFrame;
+        // position in each key stream of the last sample. keeping one per track lets sequential playback continue from
+        // the previous keys instead of searching the streams every sample.
+        struct Cursor
+        {
+            uint32 PositionKey;
+            uint32 RotationKey;
+            uint32 ScaleKey;
+        };
 
     public:
         const float GetDuration() const { return m_duration; }
 
-        // look up the keyframes for a specified time
-        void GetKeyFrames(float time, const KeyFrame **ppStartKeyFrame, const KeyFrame **ppEndKeyFrame, float *pFactor) const;
+        // key counts, a count of one means the component is constant
+        const uint32 GetPositionKeyCount() const { return m_positionTimes.GetSize(); }
+        const uint32 GetRotationKeyCount() const { return m_rotationTimes.GetSize(); }
+        const uint32 GetScaleKeyCount() const { return m_scaleTimes.GetSize(); }
 
         // look up the transform for a specified time
         void GetBoneTransform(float time, Transform *pTransform, bool interpolate = true) const;
 
+        // look up the transform for a specified time, starting the key search from the cursor and updating it
+        void GetBoneTransform(float time, Cursor *pCursor, Transform *pTransform, bool interpolate = true) const;
+
     protected:
-        // load keyframes from stream
-        bool LoadKeyFramesFromStream(ByteStream *pStream, float duration, uint32 keyFrameCount);
+        // load key streams from stream
+        bool LoadKeyFramesFromStream(ByteStream *pStream, float duration, uint32 positionKeyCount, uint32 rotationKeyCount, uint32 scaleKeyCount);
         
-        // keyframe data
+        // keyframe data, each component is stored as a separate stream of times and values
         float m_duration;
-        MemArray<KeyFrame> m_keyFrames;
+        MemArray<float> m_positionTimes;
+        MemArray<float3> m_positions;
+        MemArray<float> m_rotationTimes;
+        MemArray<PackedRotation> m_rotations;
+        MemArray<float> m_scaleTimes;
+        MemArray<float3> m_scales;
     };
 
     class BoneTrack : public TransformTrack
@@ -76,9 +99,16 @@ public:
     // fast path to find the relative transform for a bone
     bool CalculateRelativeBoneTransform(uint32 boneIndex, float time, Transform *pTransform, bool interpolate = true) const;
 
+    // as above, using the cursor for the bone's track from an array of GetBoneTrackCount() cursors
+    bool CalculateRelativeBoneTransform(uint32 boneIndex, float time, TransformTrack::Cursor *pTrackCursors, Transform *pTransform, bool interpolate = true) const;
+
     // slow path to find the absolute transform for a bone
     void CalculateAbsoluteBoneTransform(uint32 boneIndex, float time, Transform *pTransform, bool interpolate = true) const;
 
+    // rotation quantization, shared with the compiler
+    static void PackRotation(const Quaternion &rotation, PackedRotation *pPackedRotation);
+    static Quaternion UnpackRotation(const PackedRotation &packedRotation);
+
 private:
     const Skeleton *m_pSkeleton;
 
@@ -42,6 +42,10 @@ void SkeletalAnimationPlayer::Channel::Clear()
         m_pTransitionMeshState = nullptr;
     }
 
+    delete[] m_pTrackCursors;
+    m_pTrackCursors = nullptr;
+    m_trackCursorCount = 0;
+
     m_transitionTime = 0.0f;
     m_time = 0.0f;
     m_playing = false;
@@ -80,6 +84,18 @@ void SkeletalAnimationPlayer::Channel::PlayAnimation(const SkeletalAnimation *pA
     // set new animation
     m_pAnimation = pAnimation;
     m_pAnimation->AddRef();
+
+    // start the cursors from the first keys, the search finds the position if the time isn't reset
+    if (m_trackCursorCount < pAnimation->GetBoneTrackCount())
+    {
+        delete[] m_pTrackCursors;
+        m_trackCursorCount = pAnimation->GetBoneTrackCount();
+        m_pTrackCursors = new SkeletalAnimation::TransformTrack::Cursor[m_trackCursorCount];
+    }
+
+    if (m_trackCursorCount > 0)
+        Y_memzero(m_pTrackCursors, sizeof(SkeletalAnimation::TransformTrack::Cursor) * m_trackCursorCount);
+
     m_playbackSpeed = playbackSpeed;
     m_loopCount = loopCount;
     m_time = (resetTime || pAnimation->GetDuration() == 0.0f) ? 0.0f : Y_fmodf(m_time, pAnimation->GetDuration());
@@ -212,9 +228,9 @@ void SkeletalAnimationPlayer::SetChannelCount(uint32 channelCount)
     uint32 clearCount = (channelCount <= m_channels.GetSize()) ? (m_channels.GetSize() - channelCount) : 0;
     uint32 newCount = (channelCount >= m_channels.GetSize()) ? (channelCount - m_channels.GetSize()) : 0;
 
-    // clear channels up to channelCount
+    // clear channels past channelCount
     for (uint32 channelIndex = 0; channelIndex < clearCount; channelIndex++)
-        m_channels[channelIndex].Clear();
+        m_channels[channelCount + channelIndex].Clear();
 
     // add new channels
     m_channels.Resize(channelCount);
@@ -369,7 +385,7 @@ void SkeletalAnimationPlayer::UpdateBoneTransform(const Skeleton::Bone *pSkeleto
             // find the transform we are transitioning to
             // if we don't have a transform for this bone, and there isn't a current transform, set it to the base frame
             Transform toTransform;
-            if (channel->m_pAnimation->CalculateRelativeBoneTransform(pSkeletonBone->GetIndex(), 0.0f, &toTransform, false))
+            if (channel->m_pAnimation->CalculateRelativeBoneTransform(pSkeletonBone->GetIndex(), 0.0f, channel->m_pTrackCursors, &toTransform, false))
             {
                 // have to add the parent in here
                 if (parentBoneTransform != nullptr)
@@ -395,7 +411,7 @@ void SkeletalAnimationPlayer::UpdateBoneTransform(const Skeleton::Bone *pSkeleto
                 animationTime = channel->m_pAnimation->GetDuration() - animationTime;
 
             // get transform
-            if (!channel->m_pAnimation->CalculateRelativeBoneTransform(pSkeletonBone->GetIndex(), animationTime, &channelBonePose, true))
+            if (!channel->m_pAnimation->CalculateRelativeBoneTransform(pSkeletonBone->GetIndex(), animationTime, channel->m_pTrackCursors, &channelBonePose, true))
                 continue;
 
             // apply parent transform
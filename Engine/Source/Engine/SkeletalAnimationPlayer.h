@@ -99,6 +99,10 @@ public:
         float m_playbackSpeed;
         int32 m_loopCount;
 
+        // sampling cursor for each bone track of the current animation
+        SkeletalAnimation::TransformTrack::Cursor *m_pTrackCursors;
+        uint32 m_trackCursorCount;
+
         // queued animation
         /*struct QueuedAnimation
         {
@@ -7,6 +7,7 @@
 #include "Renderer/VertexFactories/SkeletalMeshVertexFactory.h"
 #include "Renderer/Renderer.h"
 #include "Core/ChunkFileReader.h"
+#include "Core/MappedFile.h"
 Log_SetChannel(SkeletalMesh);
 
 DEFINE_RESOURCE_TYPE_INFO(SkeletalMesh);
@@ -46,6 +47,19 @@ SkeletalMesh::~SkeletalMesh()
 }
 
 bool SkeletalMesh::LoadFromStream(const char *name, ByteStream *pStream)
+{
+    return InternalLoad(name, pStream, nullptr);
+}
+
+bool SkeletalMesh::LoadFromMapping(const char *name, MappedFile *pMappedFile)
+{
+    ByteStream *pStream = ByteStream_CreateReadOnlyMemoryStream(pMappedFile->GetData(), (uint32)pMappedFile->GetSize());
+    bool result = InternalLoad(name, pStream, pMappedFile);
+    pStream->Release();
+    return result;
+}
+
+bool SkeletalMesh::InternalLoad(const char *name, ByteStream *pStream, MappedFile *pMappedFile)
 {
     DF_SKELETALMESH_HEADER fileHeader;
     if (!pStream->Read2(&fileHeader, sizeof(fileHeader)))
@@ -54,8 +68,9 @@ bool SkeletalMesh::LoadFromStream(const char *name, ByteStream *pStream)
     if (fileHeader.Magic != DF_SKELETALMESH_HEADER_MAGIC || fileHeader.HeaderSize != sizeof(fileHeader))
         return false;
 
+    // when mapped, the chunks follow the header in the mapping
     ChunkFileReader chunkReader;
-    if (!chunkReader.Initialize(pStream))
+    if (!((pMappedFile != nullptr) ? chunkReader.InitializeFromMappedFile(pMappedFile, pStream->GetPosition()) : chunkReader.Initialize(pStream)))
         return false;
 
     // get skeleton
@@ -210,7 +225,7 @@ bool SkeletalMesh::LoadFromStream(const char *name, ByteStream *pStream)
     m_strName = name;
 
     // create on gpu
-    if (!CreateGPUResources())
+    if (!ResourceManager::IsDeviceResourceCreationDeferred() && !CreateGPUResources())
     {
         Log_ErrorPrintf("GPU upload failed.");
         return false;
@@ -7,6 +7,7 @@
 
 class Material;
 class Skeleton;
+class MappedFile;
 
 namespace Physics { class CollisionShape; }
 
@@ -77,6 +78,9 @@ public:
     // initialization
     bool LoadFromStream(const char *name, ByteStream *pStream);
 
+    // loads from a mapped file, chunks are read in place rather than copied
+    bool LoadFromMapping(const char *name, MappedFile *pMappedFile);
+
     // gpu resources
     const VertexBufferBindingArray *GetVertexBuffers() const { return &m_vertexBuffers; }
     const uint32 GetBaseVertexFactoryFlags() const { return m_baseVertexFactoryFlags; }
@@ -87,6 +91,8 @@ public:
     bool CheckGPUResources() const;
     
 private:
+    bool InternalLoad(const char *name, ByteStream *pStream, MappedFile *pMappedFile);
+
     const Skeleton *m_pSkeleton;
 
     AABox m_boundingBox;
@@ -0,0 +1,193 @@
+#include "Engine/PrecompiledHeader.h"
+#include "Engine/SpatialHashGrid.h"
+
+// cell coordinates are clamped to this, so objects at extreme positions don't overflow the range math
+static const float CELL_COORDINATE_LIMIT = 1048576.0f;
+
+SpatialHashGrid::SpatialHashGrid(float cellSize /* = 16.0f */, uint32 maxCellsPerObject /* = 64 */)
+    : m_cellSize(cellSize),
+      m_inverseCellSize(1.0f / cellSize),
+      m_maxCellsPerObject(maxCellsPerObject)
+{
+#ifdef Y_BUILD_CONFIG_DEBUG
+    m_activeEnumerations = 0;
+#endif
+}
+
+SpatialHashGrid::~SpatialHashGrid()
+{
+
+}
+
+void SpatialHashGrid::GetCellRange(const AABox &bounds, CellRange *pRange) const
+{
+    const float3 &minBounds = bounds.GetMinBounds();
+    const float3 &maxBounds = bounds.GetMaxBounds();
+    for (uint32 i = 0; i < 3; i++)
+    {
+        pRange->Min[i] = (int32)Y_floorf(Math::Clamp(minBounds[i] * m_inverseCellSize, -CELL_COORDINATE_LIMIT, CELL_COORDINATE_LIMIT));
+        pRange->Max[i] = (int32)Y_floorf(Math::Clamp(maxBounds[i] * m_inverseCellSize, -CELL_COORDINATE_LIMIT, CELL_COORDINATE_LIMIT));
+    }
+}
+
+uint64 SpatialHashGrid::GetCellCount(const CellRange &range)
+{
+    return (uint64)(range.Max.x - range.Min.x + 1) * (uint64)(range.Max.y - range.Min.y + 1) * (uint64)(range.Max.z - range.Min.z + 1);
+}
+
+uint32 SpatialHashGrid::Insert(const AABox &bounds, uint32 userData)
+{
+    DebugAssert(m_activeEnumerations == 0);
+    uint32 handle;
+    if (!m_freeObjects.IsEmpty())
+    {
+        handle = m_freeObjects.PopBack();
+    }
+    else
+    {
+        handle = m_objects.GetSize();
+        m_objects.Add(Object());
+    }
+
+    Object &object = m_objects[handle];
+    object.Bounds = bounds;
+    object.UserData = userData;
+    object.InUse = true;
+    GetCellRange(bounds, &object.Range);
+    LinkObject(handle);
+    return handle;
+}
+
+void SpatialHashGrid::Move(uint32 handle, const AABox &bounds)
+{
+    DebugAssert(m_activeEnumerations == 0);
+    Object &object = m_objects[handle];
+    DebugAssert(object.InUse);
+    object.Bounds = bounds;
+
+    // most moves stay within the same cells
+    CellRange newRange;
+    GetCellRange(bounds, &newRange);
+    if (newRange == object.Range)
+        return;
+
+    UnlinkObject(handle);
+    m_objects[handle].Range = newRange;
+    LinkObject(handle);
+}
+
+void SpatialHashGrid::Remove(uint32 handle)
+{
+    DebugAssert(m_activeEnumerations == 0);
+    DebugAssert(m_objects[handle].InUse);
+    UnlinkObject(handle);
+    m_objects[handle].InUse = false;
+    m_freeObjects.Add(handle);
+}
+
+void SpatialHashGrid::Clear()
+{
+    DebugAssert(m_activeEnumerations == 0);
+    m_objects.Clear();
+    m_freeObjects.Clear();
+    m_oversizeObjects.Clear();
+    m_cells.Clear();
+    m_freeCells.Clear();
+    m_cellHashTable.Clear();
+}
+
+void SpatialHashGrid::LinkObject(uint32 handle)
+{
+    Object &object = m_objects[handle];
+    object.Oversize = (GetCellCount(object.Range) > (uint64)m_maxCellsPerObject);
+    if (object.Oversize)
+    {
+        m_oversizeObjects.Add(handle);
+        return;
+    }
+
+    int3 coordinates;
+    for (coordinates.z = object.Range.Min.z; coordinates.z <= object.Range.Max.z; coordinates.z++)
+    {
+        for (coordinates.y = object.Range.Min.y; coordinates.y <= object.Range.Max.y; coordinates.y++)
+        {
+            for (coordinates.x = object.Range.Min.x; coordinates.x <= object.Range.Max.x; coordinates.x++)
+            {
+                uint32 cellIndex;
+                CellHashTable::Member *pMember = m_cellHashTable.Find(coordinates);
+                if (pMember != nullptr)
+                {
+                    cellIndex = pMember->Value;
+                }
+                else
+                {
+                    // reuse a cell that was emptied, so its object array keeps its allocation
+                    if (!m_freeCells.IsEmpty())
+                    {
+                        cellIndex = m_freeCells.PopBack();
+                    }
+                    else
+                    {
+                        cellIndex = m_cells.GetSize();
+                        m_cells.Add(Cell());
+                    }
+
+                    m_cells[cellIndex].Coordinates = coordinates;
+                    m_cellHashTable.Insert(coordinates, cellIndex);
+                }
+
+                m_cells[cellIndex].Objects.Add(handle);
+            }
+        }
+    }
+}
+
+void SpatialHashGrid::UnlinkObject(uint32 handle)
+{
+    const Object &object = m_objects[handle];
+    if (object.Oversize)
+    {
+        for (uint32 i = 0; i < m_oversizeObjects.GetSize(); i++)
+        {
+            if (m_oversizeObjects[i] == handle)
+            {
+                m_oversizeObjects.FastRemove(i);
+                break;
+            }
+        }
+
+        return;
+    }
+
+    int3 coordinates;
+    for (coordinates.z = object.Range.Min.z; coordinates.z <= object.Range.Max.z; coordinates.z++)
+    {
+        for (coordinates.y = object.Range.Min.y; coordinates.y <= object.Range.Max.y; coordinates.y++)
+        {
+            for (coordinates.x = object.Range.Min.x; coordinates.x <= object.Range.Max.x; coordinates.x++)
+            {
+                CellHashTable::Member *pMember = m_cellHashTable.Find(coordinates);
+                DebugAssert(pMember != nullptr);
+
+                // cells hold few objects, so a linear search is fine here
+                uint32 cellIndex = pMember->Value;
+                Cell &cell = m_cells[cellIndex];
+                for (uint32 i = 0; i < cell.Objects.GetSize(); i++)
+                {
+                    if (cell.Objects[i] == handle)
+                    {
+                        cell.Objects.FastRemove(i);
+                        break;
+                    }
+                }
+
+                // drop empty cells from the table, so queries don't visit them
+                if (cell.Objects.IsEmpty())
+                {
+                    m_cellHashTable.Remove(pMember);
+                    m_freeCells.Add(cellIndex);
+                }
+            }
+        }
+    }
+}
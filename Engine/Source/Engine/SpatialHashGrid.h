@@ -0,0 +1,168 @@
+#pragma once
+#include "Engine/Common.h"
+#include <atomic>
+
+// Uniform grid over object bounds, with only occupied cells stored in a hash table. Objects are linked into every
+// cell their bounds touch, and moves only touch the grid when the covered cell range changes. Objects covering
+// more than the cell limit are kept in a separate list that every query checks.
+class SpatialHashGrid
+{
+public:
+    SpatialHashGrid(float cellSize = 16.0f, uint32 maxCellsPerObject = 64);
+    ~SpatialHashGrid();
+
+    float GetCellSize() const { return m_cellSize; }
+    uint32 GetObjectCount() const { return m_objects.GetSize() - m_freeObjects.GetSize(); }
+    uint32 GetOccupiedCellCount() const { return m_cells.GetSize() - m_freeCells.GetSize(); }
+    uint32 GetOversizeObjectCount() const { return m_oversizeObjects.GetSize(); }
+
+    // adds an object, the returned handle is used to move/remove it
+    uint32 Insert(const AABox &bounds, uint32 userData);
+
+    // updates the bounds of an object
+    void Move(uint32 handle, const AABox &bounds);
+
+    // removes an object, the handle can be reused by a later insert
+    void Remove(uint32 handle);
+
+    // removes all objects
+    void Clear();
+
+    // object accessors
+    uint32 GetUserData(uint32 handle) const { return m_objects[handle].UserData; }
+    void SetUserData(uint32 handle, uint32 userData) { m_objects[handle].UserData = userData; }
+    const AABox &GetBounds(uint32 handle) const { return m_objects[handle].Bounds; }
+
+    // calls callback(userData) once for each object with bounds intersecting the box, the caller can then
+    // apply a more precise test. only the cells covered by the box are visited.
+    // the callback must not insert, move or remove objects, the cell arrays being walked would change under it.
+    template<typename T>
+    void EnumerateAABox(const AABox &box, T callback) const
+    {
+#ifdef Y_BUILD_CONFIG_DEBUG
+        m_activeEnumerations++;
+#endif
+
+        CellRange queryRange;
+        GetCellRange(box, &queryRange);
+
+        // large queries walk the occupied cells rather than probing every cell in the range
+        uint64 queryCellCount = GetCellCount(queryRange);
+        if (queryCellCount > (uint64)GetOccupiedCellCount())
+        {
+            for (uint32 cellIndex = 0; cellIndex < m_cells.GetSize(); cellIndex++)
+            {
+                const Cell &cell = m_cells[cellIndex];
+                if (!cell.Objects.IsEmpty() && queryRange.Contains(cell.Coordinates))
+                    EnumerateCell(cell, queryRange, box, callback);
+            }
+        }
+        else
+        {
+            int3 coordinates;
+            for (coordinates.z = queryRange.Min.z; coordinates.z <= queryRange.Max.z; coordinates.z++)
+            {
+                for (coordinates.y = queryRange.Min.y; coordinates.y <= queryRange.Max.y; coordinates.y++)
+                {
+                    for (coordinates.x = queryRange.Min.x; coordinates.x <= queryRange.Max.x; coordinates.x++)
+                    {
+                        const CellHashTable::Member *pMember = m_cellHashTable.Find(coordinates);
+                        if (pMember != nullptr)
+                            EnumerateCell(m_cells[pMember->Value], queryRange, box, callback);
+                    }
+                }
+            }
+        }
+
+        // oversize objects are always checked
+        for (uint32 i = 0; i < m_oversizeObjects.GetSize(); i++)
+        {
+            const Object &object = m_objects[m_oversizeObjects[i]];
+            if (box.AABoxIntersection(object.Bounds))
+                callback(object.UserData);
+        }
+
+#ifdef Y_BUILD_CONFIG_DEBUG
+        m_activeEnumerations--;
+#endif
+    }
+
+private:
+    // inclusive range of cell coordinates
+    struct CellRange
+    {
+        int3 Min;
+        int3 Max;
+
+        bool operator==(const CellRange &other) const { return (Min == other.Min && Max == other.Max); }
+        bool Contains(const int3 &coordinates) const
+        {
+            return (coordinates.x >= Min.x && coordinates.x <= Max.x &&
+                    coordinates.y >= Min.y && coordinates.y <= Max.y &&
+                    coordinates.z >= Min.z && coordinates.z <= Max.z);
+        }
+    };
+
+    struct Object
+    {
+        AABox Bounds;
+        CellRange Range;
+        uint32 UserData;
+        bool InUse;
+        bool Oversize;
+    };
+
+    struct Cell
+    {
+        int3 Coordinates;
+        PODArray<uint32> Objects;
+    };
+
+    typedef HashTable<int3, uint32> CellHashTable;
+
+    // cell helpers
+    void GetCellRange(const AABox &bounds, CellRange *pRange) const;
+    static uint64 GetCellCount(const CellRange &range);
+
+    // links/unlinks an object with the cells in its range
+    void LinkObject(uint32 handle);
+    void UnlinkObject(uint32 handle);
+
+    // an object spanning several cells is only reported from the first cell it shares with the query, so no
+    // per-query state is needed to filter duplicates and queries can run concurrently
+    template<typename T>
+    void EnumerateCell(const Cell &cell, const CellRange &queryRange, const AABox &box, T &callback) const
+    {
+        for (uint32 i = 0; i < cell.Objects.GetSize(); i++)
+        {
+            const Object &object = m_objects[cell.Objects[i]];
+            if (Max(object.Range.Min.x, queryRange.Min.x) != cell.Coordinates.x ||
+                Max(object.Range.Min.y, queryRange.Min.y) != cell.Coordinates.y ||
+                Max(object.Range.Min.z, queryRange.Min.z) != cell.Coordinates.z)
+            {
+                continue;
+            }
+
+            if (box.AABoxIntersection(object.Bounds))
+                callback(object.UserData);
+        }
+    }
+
+    float m_cellSize;
+    float m_inverseCellSize;
+    uint32 m_maxCellsPerObject;
+
+    MemArray<Object> m_objects;
+    PODArray<uint32> m_freeObjects;
+    PODArray<uint32> m_oversizeObjects;
+
+    MemArray<Cell> m_cells;
+    PODArray<uint32> m_freeCells;
+    CellHashTable m_cellHashTable;
+
+#ifdef Y_BUILD_CONFIG_DEBUG
+    // catches modification from inside a query callback
+    mutable std::atomic<uint32> m_activeEnumerations;
+#endif
+};
+
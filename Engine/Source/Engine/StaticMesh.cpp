@@ -8,6 +8,7 @@
 #include "Renderer/VertexBufferBindingArray.h"
 #include "Core/ChunkFileReader.h"
 #include "Core/MeshUtilties.h"
+#include "Core/MappedFile.h"
 Log_SetChannel(StaticMesh);
 
 DEFINE_RESOURCE_TYPE_INFO(StaticMesh);
@@ -21,6 +22,7 @@ StaticMesh::StaticMesh(const ResourceTypeInfo *pResourceTypeInfo /* = &s_TypeInf
       m_pCollisionShape(nullptr),
       m_pLODs(nullptr),
       m_LODCount(0),
+      m_pMappedFile(nullptr),
       m_GPUResourcesCreated(false)
 {
 
@@ -29,8 +31,10 @@ StaticMesh::StaticMesh(const ResourceTypeInfo *pResourceTypeInfo /* = &s_TypeInf
 StaticMesh::LOD::LOD()
     : m_vertexFactoryFlags(0),
       m_pIndices(nullptr),
+      m_ownsIndices(false),
       m_indexCount(0),
       m_indexFormat(GPU_INDEX_FORMAT_COUNT),
+      m_screenSize(1.0f),
       m_pIndexBuffer(nullptr),
       m_loaded(false)
 {
@@ -51,12 +55,17 @@ StaticMesh::~StaticMesh()
 
     if (m_pCollisionShape != nullptr)
         m_pCollisionShape->Release();
+
+    // lods may reference the mapping, so it has to outlive them
+    if (m_pMappedFile != nullptr)
+        m_pMappedFile->Release();
 }
 
 StaticMesh::LOD::~LOD()
 {
     ReleaseGPUResources();
-    Y_free(m_pIndices);
+    if (m_ownsIndices)
+        Y_free(m_pIndices);
 }
 
 bool StaticMesh::Load(const char *FileName, ByteStream *pStream)
@@ -148,13 +157,13 @@ bool StaticMesh::Load(const char *FileName, ByteStream *pStream)
         // load the actual lods
         for (uint32 lodIndex = 0; lodIndex < m_LODCount; lodIndex++)
         {
-            if (!binaryReader.SafeSeekAbsolute(m_LODOffsetTable[lodIndex]) || !m_pLODs[lodIndex].LoadFromStream(pStream, m_vertexFactoryFlags))
+            if (!binaryReader.SafeSeekAbsolute(m_LODOffsetTable[lodIndex]) || !m_pLODs[lodIndex].LoadFromStream(pStream, m_vertexFactoryFlags, m_pMappedFile))
                 return false;
         }
     }
 
     // create on gpu
-    if (g_pRenderer != nullptr && !CreateGPUResources())
+    if (g_pRenderer != nullptr && !ResourceManager::IsDeviceResourceCreationDeferred() && !CreateGPUResources())
     {
         ABORTREASON("failed to create GPU resources");
         return false;
@@ -165,7 +174,29 @@ bool StaticMesh::Load(const char *FileName, ByteStream *pStream)
 #undef ABORTREASON
 }
 
-bool StaticMesh::LOD::LoadFromStream(ByteStream *pStream, uint32 vertexFactoryFlags)
+bool StaticMesh::LoadFromMapping(const char *FileName, MappedFile *pMappedFile)
+{
+    DebugAssert(m_pMappedFile == nullptr);
+    m_pMappedFile = pMappedFile;
+    m_pMappedFile->AddRef();
+
+    // the stream starts at the beginning of the mapping, so stream offsets are mapping offsets
+    ByteStream *pStream = ByteStream_CreateReadOnlyMemoryStream(pMappedFile->GetData(), (uint32)pMappedFile->GetSize());
+    bool result = Load(FileName, pStream);
+    pStream->Release();
+    return result;
+}
+
+// returns a pointer to a range of the mapping, or nullptr if it is out of bounds
+static const byte *GetMappedRange(const MappedFile *pMappedFile, uint32 offset, uint32 size)
+{
+    if (((uint64)offset + (uint64)size) > pMappedFile->GetSize())
+        return nullptr;
+
+    return pMappedFile->GetData() + offset;
+}
+
+bool StaticMesh::LOD::LoadFromStream(ByteStream *pStream, uint32 vertexFactoryFlags, const MappedFile *pMappedFile /* = nullptr */)
 {
     BinaryReader binaryReader(pStream);
 
@@ -178,25 +209,39 @@ bool StaticMesh::LOD::LoadFromStream(ByteStream *pStream, uint32 vertexFactoryFl
     m_vertices.Resize(lodHeader.VertexCount);
     m_indexCount = lodHeader.IndexCount;
     m_indexFormat = (GPU_INDEX_FORMAT)lodHeader.IndexFormat;
-    uint32 indicesSize = m_indexCount * ((m_indexFormat == GPU_INDEX_FORMAT_UINT32) ? sizeof(uint32) : sizeof(uint16));
-    m_pIndices = Y_malloc(indicesSize);
+    uint32 indexSize = (m_indexFormat == GPU_INDEX_FORMAT_UINT32) ? sizeof(uint32) : sizeof(uint16);
+    uint32 indicesSize = m_indexCount * indexSize;
     m_batches.Resize(lodHeader.BatchCount);
+    m_screenSize = lodHeader.ScreenSize;
 
     // load vertices
     {
-        if (!binaryReader.SafeSeekAbsolute(lodHeader.VerticesOffset))
-            return false;
-
-        // read them into a temporary memory block
-        DF_STATICMESH_VERTEX *fileVertices = new DF_STATICMESH_VERTEX[m_vertices.GetSize()];
-        if (!binaryReader.SafeReadBytes(fileVertices, sizeof(DF_STATICMESH_VERTEX) * m_vertices.GetSize()))
+        // when mapped and suitably aligned, the file vertices are converted in place, otherwise read them into a temporary memory block
+        DF_STATICMESH_VERTEX *fileVertices = nullptr;
+        const DF_STATICMESH_VERTEX *pFileVertices;
+        uint32 verticesSize = sizeof(DF_STATICMESH_VERTEX) * m_vertices.GetSize();
+        const byte *pMappedVertices = (pMappedFile != nullptr) ? GetMappedRange(pMappedFile, lodHeader.VerticesOffset, verticesSize) : nullptr;
+        if (pMappedVertices != nullptr && ((size_t)pMappedVertices % alignof(DF_STATICMESH_VERTEX)) == 0)
         {
-            delete[] fileVertices;
-            return false;
+            pFileVertices = reinterpret_cast<const DF_STATICMESH_VERTEX *>(pMappedVertices);
+        }
+        else
+        {
+            if (!binaryReader.SafeSeekAbsolute(lodHeader.VerticesOffset))
+                return false;
+
+            fileVertices = new DF_STATICMESH_VERTEX[m_vertices.GetSize()];
+            if (!binaryReader.SafeReadBytes(fileVertices, verticesSize))
+            {
+                delete[] fileVertices;
+                return false;
+            }
+
+            pFileVertices = fileVertices;
         }
 
         // parse vertices
-        const DF_STATICMESH_VERTEX *pSourceVertex = fileVertices;
+        const DF_STATICMESH_VERTEX *pSourceVertex = pFileVertices;
         LocalVertexFactory::Vertex *pDestinationVertex = m_vertices.GetBasePointer();
         for (uint32 vertexIndex = 0; vertexIndex < m_vertices.GetSize(); vertexIndex++)
         {
@@ -216,29 +261,55 @@ bool StaticMesh::LOD::LoadFromStream(ByteStream *pStream, uint32 vertexFactoryFl
 
     // load indices
     {
-        if (!binaryReader.SafeSeekAbsolute(lodHeader.IndicesOffset))
-            return false;
+        // reference them in the mapping if they are suitably aligned
+        const byte *pMappedIndices = (pMappedFile != nullptr) ? GetMappedRange(pMappedFile, lodHeader.IndicesOffset, indicesSize) : nullptr;
+        if (pMappedIndices != nullptr && ((size_t)pMappedIndices % indexSize) == 0)
+        {
+            m_pIndices = const_cast<byte *>(pMappedIndices);
+            m_ownsIndices = false;
+        }
+        else
+        {
+            if (!binaryReader.SafeSeekAbsolute(lodHeader.IndicesOffset))
+                return false;
 
-        // one read
-        if (!binaryReader.SafeReadBytes(m_pIndices, indicesSize))
-            return false;
+            // one read
+            m_pIndices = Y_malloc(indicesSize);
+            m_ownsIndices = true;
+            if (!binaryReader.SafeReadBytes(m_pIndices, indicesSize))
+                return false;
+        }
     }
 
     // load batches
     {
-        if (!binaryReader.SafeSeekAbsolute(lodHeader.BatchesOffset))
-            return false;
-
-        // read them into a temporary memory block
-        DF_STATICMESH_BATCH *fileBatches = new DF_STATICMESH_BATCH[m_batches.GetSize()];
-        if (!binaryReader.SafeReadBytes(fileBatches, sizeof(DF_STATICMESH_BATCH) * m_batches.GetSize()))
+        // same as vertices, only use the mapping directly when it is suitably aligned
+        DF_STATICMESH_BATCH *fileBatches = nullptr;
+        const DF_STATICMESH_BATCH *pFileBatches;
+        uint32 batchesSize = sizeof(DF_STATICMESH_BATCH) * m_batches.GetSize();
+        const byte *pMappedBatches = (pMappedFile != nullptr) ? GetMappedRange(pMappedFile, lodHeader.BatchesOffset, batchesSize) : nullptr;
+        if (pMappedBatches != nullptr && ((size_t)pMappedBatches % alignof(DF_STATICMESH_BATCH)) == 0)
         {
-            delete[] fileBatches;
-            return false;
+            pFileBatches = reinterpret_cast<const DF_STATICMESH_BATCH *>(pMappedBatches);
+        }
+        else
+        {
+            if (!binaryReader.SafeSeekAbsolute(lodHeader.BatchesOffset))
+                return false;
+
+            // read them into a temporary memory block
+            fileBatches = new DF_STATICMESH_BATCH[m_batches.GetSize()];
+            if (!binaryReader.SafeReadBytes(fileBatches, batchesSize))
+            {
+                delete[] fileBatches;
+                return false;
+            }
+
+            pFileBatches = fileBatches;
         }
 
         // parse vertices
-        const DF_STATICMESH_BATCH *pSourceBatch = fileBatches;
+        const DF_STATICMESH_BATCH *pSourceBatch = pFileBatches;
         Batch *pDestinationBatch = m_batches.GetBasePointer();
         for (uint32 batchIndex = 0; batchIndex < m_batches.GetSize(); batchIndex++)
         {
@@ -254,7 +325,7 @@ bool StaticMesh::LOD::LoadFromStream(ByteStream *pStream, uint32 vertexFactoryFl
     }
 
     // create on gpu
-    if (g_pRenderer != nullptr && !CreateGPUResources())
+    if (g_pRenderer != nullptr && !ResourceManager::IsDeviceResourceCreationDeferred() && !CreateGPUResources())
     {
         Log_ErrorPrintf("GPU upload failed.");
         return false;
@@ -270,8 +341,10 @@ void StaticMesh::LOD::Unload()
 
     m_loaded = false;
     m_batches.Obliterate();
-    Y_free(m_pIndices);
+    if (m_ownsIndices)
+        Y_free(m_pIndices);
     m_pIndices = nullptr;
+    m_ownsIndices = false;
     m_indexCount = 0;
     m_indexFormat = GPU_INDEX_FORMAT_COUNT;
     m_vertices.Obliterate();
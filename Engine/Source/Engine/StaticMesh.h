@@ -9,6 +9,7 @@ namespace Physics { class CollisionShape; }
 class VertexBufferBindingArray;
 class Material;
 class ChunkFileReader;
+class MappedFile;
 
 class StaticMesh : public Resource
 {
@@ -41,10 +42,14 @@ public:
         const Batch *GetBatch(uint32 i) const { return &m_batches[i]; }
         const uint32 GetBatchCount() const { return m_batches.GetSize(); }
 
+        // projected size, as a fraction of the screen height, below which this lod is drawn
+        const float GetScreenSize() const { return m_screenSize; }
+
         const VertexBufferBindingArray *GetVertexBuffers() const { return &m_vertexBuffers; }
         GPUBuffer *GetIndexBuffer() const { return m_pIndexBuffer; }
 
-        bool LoadFromStream(ByteStream *pStream, uint32 vertexFactoryFlags);
+        // if pMappedFile is set, the stream must be over it, and data is read from the mapping directly
+        bool LoadFromStream(ByteStream *pStream, uint32 vertexFactoryFlags, const MappedFile *pMappedFile = nullptr);
         void Unload();
 
         bool CreateGPUResources() const;
@@ -55,11 +60,13 @@ public:
         uint32 m_vertexFactoryFlags;
         MemArray<LocalVertexFactory::Vertex> m_vertices;
         void *m_pIndices;
+        bool m_ownsIndices;
         uint32 m_indexCount;
         GPU_INDEX_FORMAT m_indexFormat;
 
         // Rendering information
         MemArray<Batch> m_batches;
+        float m_screenSize;
 
         // Data on GPU
         mutable VertexBufferBindingArray m_vertexBuffers;
@@ -90,6 +97,9 @@ public:
     // binary serialization
     bool Load(const char *FileName, ByteStream *pStream);
 
+    // loads from a mapped file, index data references the mapping rather than being copied
+    bool LoadFromMapping(const char *FileName, MappedFile *pMappedFile);
+
     // resource binding & device resource management
     bool CreateGPUResources() const;
     void ReleaseGPUResources() const;
@@ -107,6 +117,7 @@ private:
 
     LOD *m_pLODs;
     uint32 m_LODCount;
+    MappedFile *m_pMappedFile;
 
     mutable bool m_GPUResourcesCreated;
 };
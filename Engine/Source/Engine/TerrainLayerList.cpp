@@ -4,6 +4,7 @@
 #include "Engine/DataFormats.h"
 #include "Renderer/Renderer.h"
 #include "Core/ChunkFileReader.h"
+#include "Core/MappedFile.h"
 Log_SetChannel(TerrainLayerList);
 
 DEFINE_RESOURCE_TYPE_INFO(TerrainLayerList);
@@ -45,6 +46,19 @@ const TerrainLayerListBaseLayer *TerrainLayerList::GetBaseLayerByName(const char
 }
 
 bool TerrainLayerList::Load(const char *FileName, ByteStream *pStream)
+{
+    return InternalLoad(FileName, pStream, nullptr);
+}
+
+bool TerrainLayerList::LoadFromMapping(const char *FileName, MappedFile *pMappedFile)
+{
+    ByteStream *pStream = ByteStream_CreateReadOnlyMemoryStream(pMappedFile->GetData(), (uint32)pMappedFile->GetSize());
+    bool result = InternalLoad(FileName, pStream, pMappedFile);
+    pStream->Release();
+    return result;
+}
+
+bool TerrainLayerList::InternalLoad(const char *FileName, ByteStream *pStream, MappedFile *pMappedFile)
 {
     PathString tempString;  
 
@@ -67,7 +81,7 @@ bool TerrainLayerList::Load(const char *FileName, ByteStream *pStream)
 
     // init chunkloader
     ChunkFileReader chunkReader;
-    if (!chunkReader.Initialize(pStream))
+    if (!((pMappedFile != nullptr) ? chunkReader.InitializeFromMappedFile(pMappedFile, pStream->GetPosition()) : chunkReader.Initialize(pStream)))
         return false;
 
     // load textures
@@ -203,7 +217,7 @@ bool TerrainLayerList::Load(const char *FileName, ByteStream *pStream)
 #undef ABORTREASON
 
     // create on gpu
-    if (!CreateGPUResources())
+    if (!ResourceManager::IsDeviceResourceCreationDeferred() && !CreateGPUResources())
     {
         Log_ErrorPrintf("GPU upload failed.");
         return false;
@@ -212,7 +226,7 @@ bool TerrainLayerList::Load(const char *FileName, ByteStream *pStream)
     return true;
 }
 
-bool TerrainLayerList::CreateGPUResources()
+bool TerrainLayerList::CreateGPUResources() const
 {
     uint32 i;
 
@@ -46,11 +46,16 @@ public:
     // serialization
     bool Load(const char *FileName, ByteStream *pStream);
 
+    // loads from a mapped file, chunks are read in place rather than copied
+    bool LoadFromMapping(const char *FileName, MappedFile *pMappedFile);
+
     // gpu resources
-    bool CreateGPUResources();
+    bool CreateGPUResources() const;
     void ReleaseGPUResources();
 
 private:
+    bool InternalLoad(const char *FileName, ByteStream *pStream, MappedFile *pMappedFile);
+
     TerrainLayerListBaseLayer *m_pBaseLayers;
     uint32 m_baseLayerArraySize;
 
@@ -1,8 +1,10 @@
 #include "Engine/PrecompiledHeader.h"
 #include "Engine/Texture.h"
 #include "Engine/DataFormats.h"
+#include "Engine/ResourceManager.h"
 #include "Renderer/Renderer.h"
 #include "Core/Image.h"
+#include "Core/MappedFile.h"
 Log_SetChannel(Texture);
 
 Y_Define_NameTable(NameTables::TextureType)
@@ -98,6 +100,7 @@ Texture::Texture(TEXTURE_TYPE TextureType, const ResourceTypeInfo *pResourceType
       m_nMipLevels(0),
       m_nImages(0),
       m_pImages(NULL),
+      m_pMappedFile(nullptr),
       m_pDeviceTexture(NULL),
       m_bDeviceResourcesCreated(false)
 {
@@ -113,11 +116,48 @@ Texture::~Texture()
 
     if (m_pImages != NULL)
     {
-        for (i = 0; i < m_nImages; i++)
-            delete[] m_pImages[i].pPixels;
+        // pixels loaded from a mapping are owned by the mapping
+        if (m_pMappedFile == nullptr)
+        {
+            for (i = 0; i < m_nImages; i++)
+                delete[] m_pImages[i].pPixels;
+        }
 
         delete[] m_pImages;
     }
+
+    if (m_pMappedFile != nullptr)
+        m_pMappedFile->Release();
+}
+
+bool Texture::LoadFromMapping(const char *FileName, MappedFile *pMappedFile)
+{
+    DebugAssert(m_pMappedFile == nullptr && m_pImages == nullptr);
+    m_pMappedFile = pMappedFile;
+    m_pMappedFile->AddRef();
+
+    // the stream starts at the beginning of the mapping, so stream offsets are mapping offsets
+    ByteStream *pStream = ByteStream_CreateReadOnlyMemoryStream(pMappedFile->GetData(), (uint32)pMappedFile->GetSize());
+    bool result = Load(FileName, pStream);
+    pStream->Release();
+    return result;
+}
+
+bool Texture::ReadImagePixels(ByteStream *pStream, ImageData &image)
+{
+    if (m_pMappedFile == nullptr)
+    {
+        image.pPixels = new byte[image.Size];
+        return pStream->Read2(image.pPixels, image.Size);
+    }
+
+    uint64 offset = pStream->GetPosition();
+    if ((offset + image.Size) > m_pMappedFile->GetSize())
+        return false;
+
+    // mappings are read-only, but loaded textures are never written to
+    image.pPixels = const_cast<byte *>(m_pMappedFile->GetData() + offset);
+    return pStream->SeekRelative((int64)image.Size);
 }
 
 GPUTexture *Texture::GetGPUTexture() const
@@ -362,13 +402,12 @@ bool Texture2D::Load(const char *name, ByteStream *pStream)
         dstImage.Size = textureImageHeader.Size;
         dstImage.RowPitch = textureImageHeader.RowPitch;
         dstImage.SlicePitch = textureImageHeader.SlicePitch;
-        dstImage.pPixels = new byte[dstImage.Size];
-        if (!pStream->Read2(dstImage.pPixels, dstImage.Size))
+        if (!ReadImagePixels(pStream, dstImage))
             return false;
     }
 
-    // create on gpu
-    if (g_pRenderer != nullptr && !CreateDeviceResources())
+    // create on gpu, unless it is being loaded asynchronously
+    if (g_pRenderer != nullptr && !ResourceManager::IsDeviceResourceCreationDeferred() && !CreateDeviceResources())
     {
         Log_ErrorPrintf("GPU upload failed.");
         return false;
@@ -608,13 +647,12 @@ bool Texture2DArray::Load(const char *name, ByteStream *pStream)
         dstImage.Size = textureImageHeader.Size;
         dstImage.RowPitch = textureImageHeader.RowPitch;
         dstImage.SlicePitch = textureImageHeader.SlicePitch;
-        dstImage.pPixels = new byte[dstImage.Size];
-        if (!pStream->Read2(dstImage.pPixels, dstImage.Size))
+        if (!ReadImagePixels(pStream, dstImage))
             return false;
     }
 
-    // create on gpu
-    if (g_pRenderer != nullptr && !CreateDeviceResources())
+    // create on gpu, unless it is being loaded asynchronously
+    if (g_pRenderer != nullptr && !ResourceManager::IsDeviceResourceCreationDeferred() && !CreateDeviceResources())
     {
         Log_ErrorPrintf("GPU upload failed.");
         return false;
@@ -806,13 +844,12 @@ bool TextureCube::Load(const char *name, ByteStream *pStream)
         dstImage.Size = textureImageHeader.Size;
         dstImage.RowPitch = textureImageHeader.RowPitch;
         dstImage.SlicePitch = textureImageHeader.SlicePitch;
-        dstImage.pPixels = new byte[dstImage.Size];
-        if (!pStream->Read2(dstImage.pPixels, dstImage.Size))
+        if (!ReadImagePixels(pStream, dstImage))
             return false;
     }
 
-    // create on gpu
-    if (!CreateDeviceResources())
+    // create on gpu, unless it is being loaded asynchronously
+    if (!ResourceManager::IsDeviceResourceCreationDeferred() && !CreateDeviceResources())
     {
         Log_ErrorPrintf("GPU upload failed.");
         return false;
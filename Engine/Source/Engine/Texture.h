@@ -3,6 +3,7 @@
 #include "Renderer/RendererTypes.h"
 
 class Image;
+class MappedFile;
 class GPUTexture;
 class GPUSamplerState;
 
@@ -38,11 +39,17 @@ public:
 
     virtual bool Load(const char *FileName, ByteStream *pInputStream) = 0;
 
+    // loads from a mapped file, image pixels reference the mapping rather than being copied
+    bool LoadFromMapping(const char *FileName, MappedFile *pMappedFile);
+
     GPUTexture *GetGPUTexture() const;
     virtual bool CreateDeviceResources() const;
     virtual void ReleaseDeviceResources() const;
 
 protected:
+    // reads the pixels for an image at the current stream position, or points them into the mapping if loading from one
+    bool ReadImagePixels(ByteStream *pStream, ImageData &image);
+
     TEXTURE_TYPE m_eTextureType;
     TEXTURE_PLATFORM m_eTexturePlatform;
     PIXEL_FORMAT m_ePixelFormat;
@@ -54,6 +61,7 @@ protected:
     uint32 m_nMipLevels;
     uint32 m_nImages;
     ImageData *m_pImages;
+    MappedFile *m_pMappedFile;
 
     mutable GPUTexture *m_pDeviceTexture;
     mutable bool m_bDeviceResourcesCreated;
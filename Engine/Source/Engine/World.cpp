@@ -1,9 +1,12 @@
 #include "Engine/PrecompiledHeader.h"
 #include "Engine/World.h"
+#include "Engine/Engine.h"
+#include "Engine/EngineCVars.h"
 #include "Engine/Physics/PhysicsWorld.h"
 #include "Engine/Brush.h"
 #include "Engine/Entity.h"
 #include "Engine/ParticleSystemRenderProxy.h"
+#include "Engine/Profiling.h"
 #include "Renderer/RenderWorld.h"
 #include "Renderer/Renderer.h"
 
@@ -15,6 +18,7 @@ World::World()
     m_pRenderWorld = new RenderWorld();    
     m_nextEntityID = 1;
     m_gameTime = 0.0f;
+    m_inParallelUpdate = false;
 }
 
 World::~World()
@@ -32,6 +36,9 @@ World::~World()
         m_temporaryParticleEffects.RemoveBack();
     }
 
+    while (m_deferredCommandBuffers.GetSize() > 0)
+        delete m_deferredCommandBuffers.PopBack();
+
     delete m_pPhysicsWorld;
 
     // render world destruction should come from the render thread
@@ -40,8 +47,29 @@ World::~World()
     //});
 }
 
+void World::RequestMoveEntity(Entity *pEntity)
+{
+    if (m_inParallelUpdate)
+    {
+        DeferredCommandBuffer *pBuffer = GetDeferredCommandBuffer();
+        MutexLock lock(pBuffer->Lock);
+        pBuffer->MovedEntities.Add(pEntity);
+        return;
+    }
+
+    MoveEntity(pEntity);
+}
+
 void World::QueueRemoveEntity(Entity *pEntity)
 {
+    if (m_inParallelUpdate)
+    {
+        DeferredCommandBuffer *pBuffer = GetDeferredCommandBuffer();
+        MutexLock lock(pBuffer->Lock);
+        pBuffer->RemovedEntities.Add(pEntity);
+        return;
+    }
+
     if (m_removeQueue.Contains(pEntity))
         return;
 
@@ -96,10 +124,13 @@ void World::UpdateAsync(float deltaTime)
     // update physics world async
     m_pPhysicsWorld->UpdateAsync(deltaTime);
 
-    // update active entities async
+    // update active entities async, parallel-safe ones first
+    bool parallelUpdated = ParallelUpdateEntities(m_activeAsyncEntities, deltaTime, true);
     for (uint32 i = 0; i < m_activeAsyncEntities.GetSize(); i++)
     {
         EntityUpdateData &updateData = m_activeAsyncEntities[i];
+        if (parallelUpdated && updateData.pEntity->GetEntityTypeInfo()->IsParallelUpdateSafe())
+            continue;
 
         updateData.TimeSinceLastUpdate += deltaTime;
 
@@ -118,10 +149,13 @@ void World::Update(float deltaTime)
     // update physics world
     m_pPhysicsWorld->Update(deltaTime);
 
-    // update active entities
+    // update active entities, parallel-safe ones first
+    bool parallelUpdated = ParallelUpdateEntities(m_activeEntities, deltaTime, false);
     for (uint32 i = 0; i < m_activeEntities.GetSize(); i++)
     {
         EntityUpdateData &updateData = m_activeEntities[i];
+        if (parallelUpdated && updateData.pEntity->GetEntityTypeInfo()->IsParallelUpdateSafe())
+            continue;
 
         updateData.TimeSinceLastUpdate += deltaTime;
 
@@ -138,6 +172,81 @@ void World::Update(float deltaTime)
     UpdateTemporaryParticleEffects(deltaTime);
 }
 
+bool World::ParallelUpdateEntities(EntityUpdateDataArray &updateDataArray, float deltaTime, bool async)
+{
+    JobSystem *pJobSystem = g_pEngine->GetJobSystem();
+    if (!CVars::e_parallel_entity_update.GetBool() || pJobSystem->GetWorkerThreadCount() == 0)
+        return false;
+
+    // collect the due entities, their timers are advanced here so the serial loop can skip them
+    m_parallelUpdateEntities.Clear();
+    for (uint32 i = 0; i < updateDataArray.GetSize(); i++)
+    {
+        EntityUpdateData &updateData = updateDataArray[i];
+        if (!updateData.pEntity->GetEntityTypeInfo()->IsParallelUpdateSafe())
+            continue;
+
+        updateData.TimeSinceLastUpdate += deltaTime;
+        if (updateData.TimeSinceLastUpdate >= updateData.UpdateInterval)
+        {
+            m_parallelUpdateEntities.Add(KeyValuePair<Entity *, float>(updateData.pEntity, updateData.TimeSinceLastUpdate));
+            updateData.TimeSinceLastUpdate = 0.0f;
+        }
+    }
+
+#ifdef WITH_PROFILER
+    MicroProfileCounterSet(MicroProfileGetCounterToken((async) ? "world/parallel_async_updated_entities" : "world/parallel_updated_entities"), (int64_t)m_parallelUpdateEntities.GetSize());
+#endif
+
+    if (m_parallelUpdateEntities.IsEmpty())
+        return true;
+
+    // one buffer per worker, plus one shared by the calling thread and anything else that picks up a job
+    uint32 bufferCount = pJobSystem->GetWorkerThreadCount() + 1;
+    while (m_deferredCommandBuffers.GetSize() < bufferCount)
+        m_deferredCommandBuffers.Add(new DeferredCommandBuffer());
+
+    // world changes are recorded while the jobs are running
+    const KeyValuePair<Entity *, float> *pUpdateEntities = m_parallelUpdateEntities.GetBasePointer();
+    m_inParallelUpdate = true;
+    pJobSystem->ParallelFor(m_parallelUpdateEntities.GetSize(), CVars::e_parallel_entity_update_batch_size.GetUInt(), [pUpdateEntities, async](uint32 start, uint32 end) {
+        for (uint32 i = start; i < end; i++)
+        {
+            if (async)
+                pUpdateEntities[i].Key->UpdateAsync(pUpdateEntities[i].Value);
+            else
+                pUpdateEntities[i].Key->Update(pUpdateEntities[i].Value);
+        }
+    });
+    m_inParallelUpdate = false;
+
+    // sync point, apply everything that was deferred
+    ExecuteDeferredCommandBuffers();
+    return true;
+}
+
+World::DeferredCommandBuffer *World::GetDeferredCommandBuffer()
+{
+    int32 workerIndex = g_pEngine->GetJobSystem()->GetCurrentWorkerIndex();
+    return m_deferredCommandBuffers[(workerIndex >= 0) ? (uint32)workerIndex : m_deferredCommandBuffers.GetSize() - 1];
+}
+
+void World::ExecuteDeferredCommandBuffers()
+{
+    // buffers are applied in worker order, an entity is only updated by one thread so per-entity order is kept
+    for (uint32 i = 0; i < m_deferredCommandBuffers.GetSize(); i++)
+    {
+        DeferredCommandBuffer *pBuffer = m_deferredCommandBuffers[i];
+        for (uint32 j = 0; j < pBuffer->MovedEntities.GetSize(); j++)
+            MoveEntity(pBuffer->MovedEntities[j]);
+        for (uint32 j = 0; j < pBuffer->RemovedEntities.GetSize(); j++)
+            QueueRemoveEntity(pBuffer->RemovedEntities[j]);
+
+        pBuffer->MovedEntities.Clear();
+        pBuffer->RemovedEntities.Clear();
+    }
+}
+
 void World::EndFrame()
 {
     // remove anything that has to die
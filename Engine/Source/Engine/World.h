@@ -57,6 +57,9 @@ public:
     // updates spatial structure for new entity bounds
     virtual void MoveEntity(Entity *pEntity) = 0;
 
+    // calls MoveEntity, or during a parallel entity update, records the move to be applied once all update jobs complete
+    void RequestMoveEntity(Entity *pEntity);
+
     // updates any needed internal information when an entity property is modified
     virtual void UpdateEntity(Entity *pEntity) = 0;
 
@@ -64,11 +67,13 @@ public:
     virtual void RemoveEntity(Entity *pEntity) = 0;
 
     // removes the entity from the world at the end of the frame, safer for game use
+    // can be called from a parallel entity update
     void QueueRemoveEntity(Entity *pEntity);
 
     // observers
     uint32 GetObserverCount() const { return m_observers.GetSize(); }
     const float3 &GetObserverLocation(uint32 observerIndex) const { return m_observers[observerIndex].Value; }
+    const void *GetObserverIdentifier(uint32 observerIndex) const { return m_observers[observerIndex].Key; }
     void AddObserver(const void *identifier, const float3 &location = float3::Zero);
     void UpdateObserver(const void *identifier, const float3 &location);
     void RemoveObserver(const void *identifier);
@@ -126,6 +131,23 @@ protected:
     void SortActiveEntities();
     void SortActiveAsyncEntities();
 
+    // updates the due entities with parallel-safe types through the job system, and applies their deferred world changes.
+    // returns false if parallel updates are disabled, in which case the serial loop updates everything.
+    bool ParallelUpdateEntities(EntityUpdateDataArray &updateDataArray, float deltaTime, bool async);
+
+    // world changes made by entities during a parallel update, one buffer per job system thread
+    struct DeferredCommandBuffer
+    {
+        Mutex Lock;
+        PODArray<Entity *> MovedEntities;
+        PODArray<Entity *> RemovedEntities;
+    };
+    DeferredCommandBuffer *GetDeferredCommandBuffer();
+    void ExecuteDeferredCommandBuffers();
+    PODArray<DeferredCommandBuffer *> m_deferredCommandBuffers;
+    MemArray<KeyValuePair<Entity *, float>> m_parallelUpdateEntities;
+    bool m_inParallelUpdate;
+
     // observers
     typedef KeyValuePair<const void *, float3> ObserverEntry;
     typedef MemArray<ObserverEntry> ObserverArray;
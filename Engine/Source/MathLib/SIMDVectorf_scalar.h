@@ -140,6 +140,10 @@ struct SIMDVector4f : public Vector4f
     inline SIMDVector4f(const Vector4i &v) : Vector4f(v) {}
     inline SIMDVector4f(const Vector4f &v) : Vector4f(v) {}
 
+    // load/store
+    void Load(const float *v) { x = v[0]; y = v[1]; z = v[2]; w = v[3]; }
+    void Store(float *v) const { v[0] = x; v[1] = y; v[2] = z; v[3] = w; }
+
     // new vector
     inline SIMDVector4f operator+(const SIMDVector4f &v) const { return Vector4f::operator+(v); }
     inline SIMDVector4f operator-(const SIMDVector4f &v) const { return Vector4f::operator-(v); }
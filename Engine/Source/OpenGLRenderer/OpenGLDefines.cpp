@@ -218,7 +218,7 @@ static const OpenGLTextureFormatMapping s_OpenGLTextureFormatMapping[PIXEL_FORMA
     { GL_COMPRESSED_RED_RGTC1,                  GL_RED,                     GL_UNSIGNED_BYTE,                   true            },  // PIXEL_FORMAT_BC4_UNORM
     { GL_COMPRESSED_SIGNED_RED_RGTC1,           GL_RED,                     GL_UNSIGNED_BYTE,                   true            },  // PIXEL_FORMAT_BC4_SNORM
     { GL_COMPRESSED_RG_RGTC2,                   GL_RG,                      GL_UNSIGNED_BYTE,                   true            },  // PIXEL_FORMAT_BC5_UNORM
-    { GL_COMPRESSED_SIGNED_RED_RGTC1,           GL_RG,                      GL_UNSIGNED_BYTE,                   true            },  // PIXEL_FORMAT_BC5_SNORM
+    { GL_COMPRESSED_SIGNED_RG_RGTC2,            GL_RG,                      GL_UNSIGNED_BYTE,                   true            },  // PIXEL_FORMAT_BC5_SNORM
     { GL_COMPRESSED_RGB_BPTC_UNSIGNED_FLOAT,    GL_RG,                      GL_UNSIGNED_BYTE,                   true            },  // PIXEL_FORMAT_BC6H_UF16
     { GL_COMPRESSED_RGB_BPTC_SIGNED_FLOAT,      GL_RG,                      GL_UNSIGNED_BYTE,                   true            },  // PIXEL_FORMAT_BC6H_SF16
     { GL_COMPRESSED_RGBA_BPTC_UNORM,            GL_RGBA,                    GL_UNSIGNED_BYTE,                   true            },  // PIXEL_FORMAT_BC7_UNORM
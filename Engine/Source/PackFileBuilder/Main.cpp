@@ -0,0 +1,171 @@
+#include "Core/Common.h"
+#include "Core/PackFileWriter.h"
+#include "YBaseLib/FileSystem.h"
+#include "YBaseLib/ByteStream.h"
+#include "YBaseLib/BinaryBlob.h"
+#include "YBaseLib/Timer.h"
+#include "YBaseLib/Log.h"
+Log_SetChannel(PackFileBuilder);
+
+static String s_outputFileName;
+static String s_sourceDirectory;
+static String s_pattern("*");
+static bool s_compress = false;
+
+static void PrintUsage()
+{
+    Log_InfoPrint("Usage: PackFileBuilder <output file name> <source directory> [-Compress] [-Pattern <wildcard>]");
+    Log_InfoPrint("  -Compress: Store files compressed with LZ4, where it saves space.");
+    Log_InfoPrint("  -Pattern: Only include files matching this pattern, default *.");
+}
+
+static bool ParseArguments(int argc, char **argv)
+{
+#define CHECK_ARG(str) !Y_stricmp(argv[i], str)
+#define CHECK_ARG_PARAM(str) !Y_stricmp(argv[i], str) && ((i + 1) < argc)
+
+    if (argc < 2)
+    {
+        Log_ErrorPrintf("Missing output file name or source directory");
+        return false;
+    }
+
+    s_outputFileName = argv[0];
+    s_sourceDirectory = argv[1];
+    FileSystem::BuildOSPath(s_outputFileName);
+    FileSystem::BuildOSPath(s_sourceDirectory);
+
+    for (int i = 2; i < argc; )
+    {
+        if (CHECK_ARG("-Compress"))
+        {
+            s_compress = true;
+        }
+        else if (CHECK_ARG_PARAM("-Pattern"))
+        {
+            s_pattern = argv[++i];
+        }
+        else
+        {
+            Log_ErrorPrintf("Invalid option: %s", argv[i]);
+            return false;
+        }
+
+        i++;
+    }
+
+#undef CHECK_ARG
+#undef CHECK_ARG_PARAM
+
+    return true;
+}
+
+static bool AddSourceFile(PackFileWriter &writer, const FILESYSTEM_FIND_DATA &findData)
+{
+    PathString fileName;
+    fileName.Format("%s/%s", s_sourceDirectory.GetCharArray(), findData.FileName);
+    FileSystem::BuildOSPath(fileName);
+
+    ByteStream *pStream = FileSystem::OpenFile(fileName, BYTESTREAM_OPEN_READ | BYTESTREAM_OPEN_STREAMED);
+    if (pStream == nullptr)
+    {
+        Log_ErrorPrintf("Failed to open '%s'", fileName.GetCharArray());
+        return false;
+    }
+
+    BinaryBlob *pBlob = BinaryBlob::CreateFromStream(pStream);
+    pStream->Release();
+    if (pBlob == nullptr)
+    {
+        Log_ErrorPrintf("Failed to read '%s'", fileName.GetCharArray());
+        return false;
+    }
+
+    // names in the pack always use forward slashes
+    PathString packName(findData.FileName);
+    packName.Replace('\\', '/');
+
+    bool result = writer.AddFile(packName, pBlob->GetDataPointer(), pBlob->GetDataSize(), (uint64)findData.ModificationTime.AsUnixTimestamp(), s_compress);
+    pBlob->Release();
+    if (!result)
+        Log_ErrorPrintf("Failed to add '%s' to pack", packName.GetCharArray());
+
+    return result;
+}
+
+static int RunPackFileBuilder(int argc, char **argv)
+{
+    if (!ParseArguments(argc, argv))
+    {
+        PrintUsage();
+        return 1;
+    }
+
+    Log_InfoPrintf("Source directory: %s", s_sourceDirectory.GetCharArray());
+    Log_InfoPrintf("Output file name: %s", s_outputFileName.GetCharArray());
+
+    FileSystem::FindResultsArray findResults;
+    if (!FileSystem::FindFiles(s_sourceDirectory, s_pattern, FILESYSTEM_FIND_FILES | FILESYSTEM_FIND_RECURSIVE | FILESYSTEM_FIND_RELATIVE_PATHS, &findResults))
+    {
+        Log_ErrorPrintf("Failed to search source directory '%s'", s_sourceDirectory.GetCharArray());
+        return 2;
+    }
+
+    ByteStream *pOutputStream = FileSystem::OpenFile(s_outputFileName, BYTESTREAM_OPEN_CREATE | BYTESTREAM_OPEN_WRITE | BYTESTREAM_OPEN_TRUNCATE | BYTESTREAM_OPEN_SEEKABLE | BYTESTREAM_OPEN_ATOMIC_UPDATE);
+    if (pOutputStream == nullptr)
+    {
+        Log_ErrorPrintf("Failed to open output file '%s'", s_outputFileName.GetCharArray());
+        return 3;
+    }
+
+    Timer timer;
+    bool result;
+    {
+        PackFileWriter writer;
+        result = writer.Initialize(pOutputStream);
+        for (uint32 i = 0; i < findResults.GetSize() && result; i++)
+            result = AddSourceFile(writer, findResults[i]);
+
+        if (result)
+        {
+            uint32 entryCount = writer.GetEntryCount();
+            uint32 compressedEntryCount = writer.GetCompressedEntryCount();
+            uint64 uncompressedDataSize = writer.GetUncompressedDataSize();
+            uint64 storedDataSize = writer.GetStoredDataSize();
+            result = writer.Close();
+            if (result)
+            {
+                Log_InfoPrintf("Wrote %u files (%u compressed), %.2f KB of data stored as %.2f KB, in %.2f seconds.", entryCount, compressedEntryCount,
+                               (double)uncompressedDataSize / 1024.0, (double)storedDataSize / 1024.0, timer.GetTimeSeconds());
+            }
+        }
+
+        // writer goes out of scope here, so it has finished with the stream before it is committed or discarded
+    }
+
+    if (result && pOutputStream->Commit())
+    {
+        pOutputStream->Release();
+        return 0;
+    }
+
+    Log_ErrorPrintf("Failed to write output file '%s'", s_outputFileName.GetCharArray());
+    pOutputStream->Discard();
+    pOutputStream->Release();
+    return 4;
+}
+
+int main(int argc, char *argv[])
+{
+    g_pLog->SetConsoleOutputParams(true);
+    g_pLog->SetDebugOutputParams(true);
+
+    // skip the program name
+    int returnCode = RunPackFileBuilder(argc - 1, argv + 1);
+    if (returnCode == 0)
+        Log_InfoPrint("Exiting with success.");
+    else
+        Log_ErrorPrintf("Exiting with error code %d.", returnCode);
+
+    return returnCode;
+}
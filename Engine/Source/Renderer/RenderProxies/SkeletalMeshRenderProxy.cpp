@@ -6,6 +6,22 @@
 #include "Engine/EngineCVars.h"
 #include "Engine/Camera.h"
 #include "Engine/Material.h"
+#include "Engine/Engine.h"
+#include "Engine/JobSystem.h"
+#include "Engine/Profiling.h"
+
+// proxies waiting for cpu skinning, each holds a reference
+static Mutex s_pendingCPUSkinningLock;
+static PODArray<SkeletalMeshRenderProxy *> s_pendingCPUSkinningProxies;
+
+// range of a batch skinned by one job
+struct CPUSkinningJob
+{
+    const SkeletalMeshRenderProxy *pProxy;
+    uint32 BatchIndex;
+    uint32 FirstVertex;
+    uint32 VertexCount;
+};
 
 SkeletalMeshRenderProxy::SkeletalMeshRenderProxy(uint32 entityId, const SkeletalMesh *pSkeletalMesh, const Transform &transform, uint32 shadowFlags)
     : RenderProxy(entityId),
@@ -15,6 +31,7 @@ SkeletalMeshRenderProxy::SkeletalMeshRenderProxy(uint32 entityId, const Skeletal
       m_tintEnabled(false),
       m_tintColor(0xFFFFFFFF),
       m_bGPUResourcesCreated(false),
+      m_cpuSkinningPending(false),
       m_pCPUSkinningVertexBuffer(nullptr),
       m_useGPUSkinning(CVars::r_gpu_skinning.GetBool())
 {
@@ -398,39 +415,40 @@ void SkeletalMeshRenderProxy::InitializeBoneTransformArray()
     DebugAssert(pSkeleton->GetBoneCount() > 0 && m_pSkeletalMesh->GetBoneRefCount() > 0);
 
     m_boneTransforms.Resize(m_pSkeletalMesh->GetBoneRefCount());
+    m_localToBoneMatrices.Resize(m_boneTransforms.GetSize());
+    m_skinningMatrices.Resize(m_boneTransforms.GetSize());
     for (uint32 i = 0; i < m_boneTransforms.GetSize(); i++)
     {
         const uint32 meshBoneIndex = (uint32)m_pSkeletalMesh->GetBoneRef(i);
         const SkeletalMesh::Bone *pMeshBone = m_pSkeletalMesh->GetBone(meshBoneIndex);
 
+        // the local to bone matrix doesn't change with the pose, so is only built once
+        SkeletalMeshSkinning::SetBoneMatrix(&m_localToBoneMatrices[i], pMeshBone->LocalToBoneTransform.GetTransformMatrix3x4());
+
         // calculate base frame transform
-        //m_boneTransforms[i] = pSkeleton->GetBoneByIndex(pMeshBone->SkeletonBoneIndex)->GetAbsoluteBaseFrameTransform().GetTransformMatrix3x4() * pMeshBone->LocalToBoneTransform.GetTransformMatrix3x4();
-        m_boneTransforms[i] = Transform::ConcatenateTransforms(pMeshBone->LocalToBoneTransform, pSkeleton->GetBoneByIndex(pMeshBone->SkeletonBoneIndex)->GetAbsoluteBaseFrameTransform()).GetTransformMatrix3x4();
+        SetBoneRefTransform(i, pSkeleton->GetBoneByIndex(pMeshBone->SkeletonBoneIndex)->GetAbsoluteBaseFrameTransform().GetTransformMatrix3x4());
     }
 }
 
+void SkeletalMeshRenderProxy::SetBoneRefTransform(uint32 boneRefIndex, const float3x4 &poseMatrix)
+{
+    SkeletalMeshSkinning::BoneMatrix poseBoneMatrix;
+    SkeletalMeshSkinning::SetBoneMatrix(&poseBoneMatrix, poseMatrix);
+    SkeletalMeshSkinning::ConcatenateBoneMatrices(&m_skinningMatrices[boneRefIndex], poseBoneMatrix, m_localToBoneMatrices[boneRefIndex]);
+    SkeletalMeshSkinning::GetBoneMatrix(&m_boneTransforms[boneRefIndex], m_skinningMatrices[boneRefIndex]);
+}
+
 void SkeletalMeshRenderProxy::SetBoneTransforms(uint32 firstTransform, uint32 transformCount, const float3x4 *pTransforms)
 {
     for (uint32 boneRefIndex = 0; boneRefIndex < m_boneTransforms.GetSize(); boneRefIndex++)
     {
         const uint32 meshBoneIndex = (uint32)m_pSkeletalMesh->GetBoneRef(boneRefIndex);
-        const SkeletalMesh::Bone *pMeshBone = m_pSkeletalMesh->GetBone(meshBoneIndex);
-
         if (meshBoneIndex >= firstTransform && meshBoneIndex < (firstTransform + transformCount))
-        {
-            uint32 transformArrayIndex = meshBoneIndex - firstTransform;
-            m_boneTransforms[boneRefIndex] = Transform::ConcatenateTransforms(pMeshBone->LocalToBoneTransform, Transform(pTransforms[transformArrayIndex])).GetTransformMatrix3x4();
-            //m_boneTransforms[boneRefIndex] = pTransforms[transformArrayIndex];
-        }
+            SetBoneRefTransform(boneRefIndex, pTransforms[meshBoneIndex - firstTransform]);
     }
 
     if (!m_useGPUSkinning)
-    {
-        if (!m_bGPUResourcesCreated && !CreateDeviceResources())
-            return;
-
-        TransformVerticesOnCPU();
-    }
+        QueueCPUSkinning();
 }
 
 void SkeletalMeshRenderProxy::SetBoneTransforms(uint32 firstTransform, uint32 transformCount, const Transform *pTransforms)
@@ -438,23 +456,12 @@ void SkeletalMeshRenderProxy::SetBoneTransforms(uint32 firstTransform, uint32 tr
     for (uint32 boneRefIndex = 0; boneRefIndex < m_boneTransforms.GetSize(); boneRefIndex++)
     {
         const uint32 meshBoneIndex = (uint32)m_pSkeletalMesh->GetBoneRef(boneRefIndex);
-        const SkeletalMesh::Bone *pMeshBone = m_pSkeletalMesh->GetBone(meshBoneIndex);
-
         if (meshBoneIndex >= firstTransform && meshBoneIndex < (firstTransform + transformCount))
-        {
-            uint32 transformArrayIndex = meshBoneIndex - firstTransform;
-            m_boneTransforms[boneRefIndex] = Transform::ConcatenateTransforms(pMeshBone->LocalToBoneTransform, pTransforms[transformArrayIndex]).GetTransformMatrix3x4();
-            //m_boneTransforms[boneRefIndex] = pTransforms[transformArrayIndex].GetTransformMatrix3x4();
-        }
+            SetBoneRefTransform(boneRefIndex, pTransforms[meshBoneIndex - firstTransform].GetTransformMatrix3x4());
     }
 
     if (!m_useGPUSkinning)
-    {
-        if (!m_bGPUResourcesCreated && !CreateDeviceResources())
-            return;
-
-        TransformVerticesOnCPU();
-    }
+        QueueCPUSkinning();
 }
 
 void SkeletalMeshRenderProxy::ResetToBaseFrameTransform()
@@ -470,9 +477,11 @@ void SkeletalMeshRenderProxy::ResetToBaseFrameTransform()
         const SkeletalMesh::Bone *pMeshBone = m_pSkeletalMesh->GetBone(meshBoneIndex);
 
         // calculate base frame transform
-        //m_boneTransforms[i] = pSkeleton->GetBoneByIndex(pMeshBone->SkeletonBoneIndex)->GetAbsoluteBaseFrameTransform().GetTransformMatrix3x4() * pMeshBone->LocalToBoneTransform.GetTransformMatrix3x4();
-        m_boneTransforms[i] = Transform::ConcatenateTransforms(pMeshBone->LocalToBoneTransform, pSkeleton->GetBoneByIndex(pMeshBone->SkeletonBoneIndex)->GetAbsoluteBaseFrameTransform()).GetTransformMatrix3x4();
+        SetBoneRefTransform(i, pSkeleton->GetBoneByIndex(pMeshBone->SkeletonBoneIndex)->GetAbsoluteBaseFrameTransform().GetTransformMatrix3x4());
     }
+
+    if (!m_useGPUSkinning)
+        QueueCPUSkinning();
 }
 
 void SkeletalMeshRenderProxy::DrawDebugInfo(const Camera *pCamera, GPUCommandList *pCommandList, MiniGUIContext *pGUIContext) const
@@ -515,81 +524,85 @@ void SkeletalMeshRenderProxy::DrawDebugInfo(const Camera *pCamera, GPUCommandLis
     }
 }
 
-void SkeletalMeshRenderProxy::TransformVerticesOnCPU()
+void SkeletalMeshRenderProxy::QueueCPUSkinning()
 {
-    DebugAssert(m_cpuSkinnedVertices.GetSize() == m_pSkeletalMesh->GetVertexCount());
+    MutexLock lock(s_pendingCPUSkinningLock);
+    if (m_cpuSkinningPending)
+        return;
+
+    // the list holds a reference until the vertices are uploaded
+    m_cpuSkinningPending = true;
+    AddRef();
+    s_pendingCPUSkinningProxies.Add(this);
+}
+
+void SkeletalMeshRenderProxy::ExecutePendingCPUSkinning()
+{
+    MICROPROFILE_SCOPEI("SkeletalMeshRenderProxy", "ExecutePendingCPUSkinning", MICROPROFILE_COLOR(200, 120, 40));
 
-    for (uint32 batchIndex = 0; batchIndex < m_pSkeletalMesh->GetBatchCount(); batchIndex++)
+    // take the pending list, anything posed from here on is skinned next frame
+    PODArray<SkeletalMeshRenderProxy *> proxies;
     {
-        const SkeletalMesh::Batch *pBatch = m_pSkeletalMesh->GetBatch(batchIndex);
+        MutexLock lock(s_pendingCPUSkinningLock);
+        if (s_pendingCPUSkinningProxies.IsEmpty())
+            return;
 
-        const SkeletalMeshVertexFactory::Vertex *pSourceVertex = m_pSkeletalMesh->GetVertex(pBatch->BaseVertex);
-        SkeletalMeshVertexFactory::Vertex *pDestinationVertex = &m_cpuSkinnedVertices[pBatch->BaseVertex];
-        const uint32 weightCount = pBatch->WeightCount;
-        const uint32 baseBoneRef = pBatch->BaseBoneRef;
-        const uint32 vertexCount = pBatch->VertexCount;
-        DebugAssert(pBatch->WeightCount > 0);
+        proxies.Swap(s_pendingCPUSkinningProxies);
+        for (uint32 i = 0; i < proxies.GetSize(); i++)
+            proxies[i]->m_cpuSkinningPending = false;
+    }
+
+    // split the meshes into ranges of vertices, so a few large meshes still spread over the workers
+    static const uint32 VERTICES_PER_JOB = 1024;
+    MemArray<CPUSkinningJob> jobs;
+    for (uint32 i = 0; i < proxies.GetSize(); i++)
+    {
+        // proxies switched to gpu skinning since they were queued are skipped
+        const SkeletalMeshRenderProxy *pProxy = proxies[i];
+        if (pProxy->m_useGPUSkinning || (!pProxy->m_bGPUResourcesCreated && !pProxy->CreateDeviceResources()))
+            continue;
 
-        for (uint32 vertexIndex = 0; vertexIndex < vertexCount; vertexIndex++, pSourceVertex++, pDestinationVertex++)
+        for (uint32 batchIndex = 0; batchIndex < pProxy->m_pSkeletalMesh->GetBatchCount(); batchIndex++)
         {
-            // should always have at least one bone
-            const float3x4 *pBoneTransform = &m_boneTransforms[baseBoneRef + (uint32)pSourceVertex->BoneIndices[0]];
-            float boneWeight = pSourceVertex->BoneWeights[0];
-
-            // transform the attributes
-            pDestinationVertex->Position = pBoneTransform->TransformPoint(pSourceVertex->Position) * boneWeight;
-            pDestinationVertex->TangentX = pBoneTransform->TransformNormal(pSourceVertex->TangentX) * boneWeight;
-            pDestinationVertex->TangentY = pBoneTransform->TransformNormal(pSourceVertex->TangentY) * boneWeight;
-            pDestinationVertex->TangentZ = pBoneTransform->TransformNormal(pSourceVertex->TangentZ) * boneWeight;
-
-            // and any remaining bones
-            switch (weightCount)
+            const uint32 batchVertexCount = pProxy->m_pSkeletalMesh->GetBatch(batchIndex)->VertexCount;
+            for (uint32 firstVertex = 0; firstVertex < batchVertexCount; firstVertex += VERTICES_PER_JOB)
             {
-            case 4:
-                {
-                    pBoneTransform = &m_boneTransforms[baseBoneRef + (uint32)pSourceVertex->BoneIndices[3]];
-                    boneWeight = pSourceVertex->BoneWeights[3];
-
-                    pDestinationVertex->Position += pBoneTransform->TransformPoint(pSourceVertex->Position) * boneWeight;
-                    pDestinationVertex->TangentX += pBoneTransform->TransformNormal(pSourceVertex->TangentX) * boneWeight;
-                    pDestinationVertex->TangentY += pBoneTransform->TransformNormal(pSourceVertex->TangentY) * boneWeight;
-                    pDestinationVertex->TangentZ += pBoneTransform->TransformNormal(pSourceVertex->TangentZ) * boneWeight;
-                }
+                CPUSkinningJob job = { pProxy, batchIndex, firstVertex, Min(VERTICES_PER_JOB, batchVertexCount - firstVertex) };
+                jobs.Add(job);
+            }
+        }
+    }
 
-            case 3:
-                {
-                    pBoneTransform = &m_boneTransforms[baseBoneRef + (uint32)pSourceVertex->BoneIndices[2]];
-                    boneWeight = pSourceVertex->BoneWeights[2];
+    // skin on the workers
+    const CPUSkinningJob *pJobs = jobs.GetBasePointer();
+    g_pEngine->GetJobSystem()->ParallelFor(jobs.GetSize(), 1, [pJobs](uint32 start, uint32 end) {
+        for (uint32 i = start; i < end; i++)
+            pJobs[i].pProxy->TransformVerticesOnCPU(pJobs[i].BatchIndex, pJobs[i].FirstVertex, pJobs[i].VertexCount);
+    });
 
-                    pDestinationVertex->Position += pBoneTransform->TransformPoint(pSourceVertex->Position) * boneWeight;
-                    pDestinationVertex->TangentX += pBoneTransform->TransformNormal(pSourceVertex->TangentX) * boneWeight;
-                    pDestinationVertex->TangentY += pBoneTransform->TransformNormal(pSourceVertex->TangentY) * boneWeight;
-                    pDestinationVertex->TangentZ += pBoneTransform->TransformNormal(pSourceVertex->TangentZ) * boneWeight;
-                }
+    // buffers are written from this thread
+    for (uint32 i = 0; i < proxies.GetSize(); i++)
+    {
+        if (!proxies[i]->m_useGPUSkinning && proxies[i]->m_bGPUResourcesCreated)
+            proxies[i]->UploadCPUSkinnedVertices();
 
-            case 2:
-                {
-                    pBoneTransform = &m_boneTransforms[baseBoneRef + (uint32)pSourceVertex->BoneIndices[1]];
-                    boneWeight = pSourceVertex->BoneWeights[1];
+        proxies[i]->Release();
+    }
+}
 
-                    pDestinationVertex->Position += pBoneTransform->TransformPoint(pSourceVertex->Position) * boneWeight;
-                    pDestinationVertex->TangentX += pBoneTransform->TransformNormal(pSourceVertex->TangentX) * boneWeight;
-                    pDestinationVertex->TangentY += pBoneTransform->TransformNormal(pSourceVertex->TangentY) * boneWeight;
-                    pDestinationVertex->TangentZ += pBoneTransform->TransformNormal(pSourceVertex->TangentZ) * boneWeight;
-                }
-            }
+void SkeletalMeshRenderProxy::TransformVerticesOnCPU(uint32 batchIndex, uint32 firstVertex, uint32 vertexCount) const
+{
+    DebugAssert(m_cpuSkinnedVertices.GetSize() == m_pSkeletalMesh->GetVertexCount());
 
-            // normalize tangents
-            pDestinationVertex->TangentX.SafeNormalizeInPlace();
-            pDestinationVertex->TangentY.SafeNormalizeInPlace();
-            pDestinationVertex->TangentZ.SafeNormalizeInPlace();
+    const SkeletalMesh::Batch *pBatch = m_pSkeletalMesh->GetBatch(batchIndex);
+    DebugAssert(pBatch->WeightCount > 0 && (firstVertex + vertexCount) <= pBatch->VertexCount);
 
-            // non-changing attributes
-            pDestinationVertex->TexCoord = pSourceVertex->TexCoord;
-            pDestinationVertex->Color = pSourceVertex->Color;
-        }
-    }
+    SkeletalMeshSkinning::SkinVertices(&m_cpuSkinnedVertices[pBatch->BaseVertex + firstVertex], m_pSkeletalMesh->GetVertex(pBatch->BaseVertex + firstVertex), vertexCount,
+                                       pBatch->WeightCount, &m_skinningMatrices[pBatch->BaseBoneRef]);
+}
 
+void SkeletalMeshRenderProxy::UploadCPUSkinnedVertices() const
+{
     // update the buffer
     void *pMappedBufferPointer;
     if (g_pRenderer->GetGPUContext()->MapBuffer(m_pCPUSkinningVertexBuffer, GPU_MAP_TYPE_WRITE_DISCARD, &pMappedBufferPointer))
@@ -599,4 +612,3 @@ void SkeletalMeshRenderProxy::TransformVerticesOnCPU()
         g_pRenderer->GetGPUContext()->Unmapbuffer(m_pCPUSkinningVertexBuffer, pMappedBufferPointer);
     }
 }
-
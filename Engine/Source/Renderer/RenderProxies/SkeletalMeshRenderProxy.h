@@ -1,5 +1,6 @@
 #pragma once
 #include "Renderer/RenderProxy.h"
+#include "Renderer/SkeletalMeshSkinning.h"
 #include "Engine/SkeletalMesh.h"
 
 class SkeletalMeshRenderProxy : public RenderProxy
@@ -22,6 +23,10 @@ public:
     void SetBoneTransforms(uint32 firstTransform, uint32 transformCount, const Transform *pTransforms);
     void ResetToBaseFrameTransform();
 
+    // skins the vertices of every proxy posed since the last call, spread over the job system workers.
+    // called once per frame by the world renderer before the render queue is filled.
+    static void ExecutePendingCPUSkinning();
+
     // render proxy stuff
     virtual void QueueForRender(const Camera *pCamera, RenderQueue *pRenderQueue) const override;
     virtual void SetupForDraw(const Camera *pCamera, const RENDER_QUEUE_RENDERABLE_ENTRY *pQueueEntry, GPUCommandList *pCommandList, ShaderProgram *pShaderProgram) const override;
@@ -42,8 +47,13 @@ private:
     // initialize the bone transform array
     void InitializeBoneTransformArray();
 
+    // sets the bone transform for a bone ref from a pose matrix
+    void SetBoneRefTransform(uint32 boneRefIndex, const float3x4 &poseMatrix);
+
     // cpu skinning
-    void TransformVerticesOnCPU();
+    void QueueCPUSkinning();
+    void TransformVerticesOnCPU(uint32 batchIndex, uint32 firstVertex, uint32 vertexCount) const;
+    void UploadCPUSkinnedVertices() const;
 
     bool m_visibility;
     const SkeletalMesh *m_pSkeletalMesh;
@@ -59,7 +69,10 @@ private:
     mutable VertexBufferBindingArray m_VertexBuffers;
     MemArray<float3x4> m_boneTransforms;
 
-    // cpu skinning
+    // cpu skinning, matrices are by bone ref
+    MemArray<SkeletalMeshSkinning::BoneMatrix> m_localToBoneMatrices;
+    MemArray<SkeletalMeshSkinning::BoneMatrix> m_skinningMatrices;
+    bool m_cpuSkinningPending;
     mutable MemArray<SkeletalMeshVertexFactory::Vertex> m_cpuSkinnedVertices;
     mutable GPUBuffer *m_pCPUSkinningVertexBuffer;
     mutable bool m_useGPUSkinning;
@@ -4,6 +4,7 @@
 #include "Renderer/Renderer.h"
 #include "Engine/Camera.h"
 #include "Engine/Material.h"
+#include "Engine/EngineCVars.h"
 
 StaticMeshRenderProxy::StaticMeshRenderProxy(uint32 entityId, const StaticMesh *pStaticMesh, const Transform &transform, uint32 shadowFlags)
     : RenderProxy(entityId),
@@ -12,6 +13,7 @@ StaticMeshRenderProxy::StaticMeshRenderProxy(uint32 entityId, const StaticMesh *
       m_shadowFlags(shadowFlags),
       m_tintEnabled(false),
       m_tintColor(0xFFFFFFFF),
+      m_selectedLOD(0),
       m_bGPUResourcesCreated(false)
 {
     uint32 i;
@@ -83,6 +85,7 @@ void StaticMeshRenderProxy::RealSetStaticMesh(const StaticMesh *pStaticMesh)
     // set new mesh
     m_pStaticMesh = pStaticMesh;
     m_pStaticMesh->AddRef();
+    m_selectedLOD = 0;
 
     // reallocate materials
     m_materials.Resize(m_pStaticMesh->GetMaterialCount());
@@ -231,10 +234,6 @@ void StaticMeshRenderProxy::QueueForRender(const Camera *pCamera, RenderQueue *p
     if (!m_bGPUResourcesCreated && !CreateDeviceResources())
         return;
 
-    // Select the LOD index we are drawing for.
-    uint32 selectedLOD = 0;
-    DebugAssert(selectedLOD < m_pStaticMesh->GetLODCount());
-
     // Store the requested render passes.
     uint32 wantedRenderPasses = RENDER_PASSES_DEFAULT;
     if (!(m_shadowFlags & ENTITY_SHADOW_FLAG_CAST_DYNAMIC_SHADOWS))
@@ -253,6 +252,20 @@ void StaticMeshRenderProxy::QueueForRender(const Camera *pCamera, RenderQueue *p
     // Calculate view distance
     float viewDistance = pCamera->CalculateDepthToPoint(GetBoundingSphere().GetCenter());
 
+    // Select the LOD index we are drawing for. Shadow map cameras don't say anything about how big the mesh is on
+    // screen, so those passes use the LOD of the last view, which also keeps the shadow matching the mesh.
+    uint32 selectedLOD = 0;
+    uint32 lodCount = m_pStaticMesh->GetLODCount();
+    if (lodCount > 1)
+    {
+        if ((pRenderQueue->GetAcceptingRenderPassMask() & ~RENDER_PASS_SHADOW_MAP) != 0)
+            m_selectedLOD = SelectLOD(pCamera, viewDistance);
+
+        int32 biasedLOD = (int32)m_selectedLOD + CVars::r_static_mesh_lod_bias.GetInt();
+        selectedLOD = (uint32)Math::Clamp(biasedLOD, 0, (int32)lodCount - 1);
+    }
+    DebugAssert(selectedLOD < lodCount);
+
     // Draw this LOD.
     const StaticMesh::LOD *pLOD = m_pStaticMesh->GetLOD(selectedLOD);
     for (uint32 i = 0; i < pLOD->GetBatchCount(); i++)
@@ -286,6 +299,45 @@ void StaticMeshRenderProxy::QueueForRender(const Camera *pCamera, RenderQueue *p
     }
 }
 
+uint32 StaticMeshRenderProxy::SelectLOD(const Camera *pCamera, float viewDistance) const
+{
+    // projected diameter of the bounding sphere as a fraction of the screen height
+    float radius = GetBoundingSphere().GetRadius();
+    float screenSize;
+    if (pCamera->GetProjectionType() == CAMERA_PROJECTION_TYPE_PERSPECTIVE)
+    {
+        // inside the sphere covers the whole screen
+        if (viewDistance <= radius)
+            return 0;
+
+        float sinHalfFov, cosHalfFov;
+        Math::SinCos(Math::DegreesToRadians(pCamera->GetPerspectiveFieldOfView()) * 0.5f, &sinHalfFov, &cosHalfFov);
+        screenSize = (radius * cosHalfFov) / (viewDistance * sinHalfFov);
+    }
+    else
+    {
+        screenSize = (radius * 2.0f) / Math::Abs(pCamera->GetOrthoWindowTop() - pCamera->GetOrthoWindowBottom());
+    }
+
+    // the coarsest lod that takes over above the projected size
+    uint32 lodCount = m_pStaticMesh->GetLODCount();
+    uint32 lodIndex = 0;
+    while ((lodIndex + 1) < lodCount && screenSize < m_pStaticMesh->GetLOD(lodIndex + 1)->GetScreenSize())
+        lodIndex++;
+
+    // going back to a more detailed lod needs the mesh to grow a bit past the threshold, so meshes sitting right on it
+    // don't flip between lods every frame
+    if (lodIndex < m_selectedLOD && m_selectedLOD < lodCount)
+    {
+        float hysteresis = 1.0f + CVars::r_static_mesh_lod_hysteresis.GetFloat();
+        lodIndex = m_selectedLOD;
+        while (lodIndex > 0 && screenSize >= m_pStaticMesh->GetLOD(lodIndex)->GetScreenSize() * hysteresis)
+            lodIndex--;
+    }
+
+    return lodIndex;
+}
+
 void StaticMeshRenderProxy::SetupForDraw(const Camera *pCamera, const RENDER_QUEUE_RENDERABLE_ENTRY *pQueueEntry, GPUCommandList *pCommandList, ShaderProgram *pShaderProgram) const
 {
     uint32 lodIndex = pQueueEntry->UserData[0];
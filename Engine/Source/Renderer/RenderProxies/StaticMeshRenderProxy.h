@@ -35,6 +35,9 @@ private:
     void RealSetShadowFlags(uint32 shadowFlags);
     void RealSetVisibility(bool visible);
 
+    // picks the lod for the mesh's projected size, before the bias is applied
+    uint32 SelectLOD(const Camera *pCamera, float viewDistance) const;
+
     // read from render thread at async time, write from game thread at sync time
     bool m_visibility;
     const StaticMesh *m_pStaticMesh;
@@ -45,6 +48,9 @@ private:
     bool m_tintEnabled;
     uint32 m_tintColor;
 
+    // lod picked for the last view, shadow passes reuse it. owned by render thread.
+    mutable uint32 m_selectedLOD;
+
     // gpu resources, also owned by render thread.
     mutable bool m_bGPUResourcesCreated;
     //mutable VertexBufferBindingArray m_VertexBuffers;
@@ -6,7 +6,9 @@ RenderProxy::RenderProxy(uint32 entityId)
     : m_iEntityId(entityId), 
       m_boundingBox(AABox::Zero), 
       m_boundingSphere(Sphere::Zero),
-      m_pRenderWorld(NULL)
+      m_pRenderWorld(NULL),
+      m_renderWorldNodeIndex(0),
+      m_renderWorldTreeProxyId(-1)
 {
 
 }
@@ -65,5 +65,9 @@ private:
     AABox m_boundingBox;
     Sphere m_boundingSphere;
     RenderWorld *m_pRenderWorld;
+
+    // Owned by the render world, index into its node list and spatial index.
+    uint32 m_renderWorldNodeIndex;
+    int32 m_renderWorldTreeProxyId;
 };
 
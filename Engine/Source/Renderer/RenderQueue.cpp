@@ -342,36 +342,162 @@ void RenderQueue::MarkRenderProxyWithPredicate(const RenderProxy *pRenderProxy,
         }
     }
 }
-/*
-static int CompFunc(const RENDER_QUEUE_RENDERABLE_ENTRY *pLHS, const RENDER_QUEUE_RENDERABLE_ENTRY *pRHS)
+
+// if more than this fraction of adjacent keys are out of order in last frame's order, fall back to a full sort
+static const uint32 COHERENT_SORT_MAX_DESCENT_DIVISOR = 32;
+
+// a few descents can still be far out of place, so the insertion sort gives up after this many moves per key
+static const uint32 COHERENT_SORT_MAX_MOVES_PER_KEY = 4;
+
+void RenderQueue::RadixSortKeys(RENDER_QUEUE_SORT_KEY *pKeys, RENDER_QUEUE_SORT_KEY *pScratchKeys, uint32 count)
 {
-    // bleh, unsigned ints make life harder
-    if (pLHS->SortKey > pRHS->SortKey)
-        return 1;
-    else if (pLHS->SortKey < pRHS->SortKey)
-        return -1;
-    else
-        return 0;
-}*/
+    if (count < 2)
+        return;
 
-static bool CompFuncSTL(const RENDER_QUEUE_RENDERABLE_ENTRY &lhs, const RENDER_QUEUE_RENDERABLE_ENTRY &rhs)
+    // build the histograms for all eight digits in one pass
+    uint32 histograms[8][256];
+    Y_memzero(histograms, sizeof(histograms));
+    for (uint32 i = 0; i < count; i++)
+    {
+        uint64 sortKey = pKeys[i].SortKey;
+        for (uint32 pass = 0; pass < 8; pass++)
+            histograms[pass][(sortKey >> (pass * 8)) & 0xFF]++;
+    }
+
+    RENDER_QUEUE_SORT_KEY *pSource = pKeys;
+    RENDER_QUEUE_SORT_KEY *pDestination = pScratchKeys;
+    for (uint32 pass = 0; pass < 8; pass++)
+    {
+        uint32 *histogram = histograms[pass];
+        uint32 shift = pass * 8;
+
+        // skip digits that are the same for every key, e.g. the transparency/layer bits
+        if (histogram[(pSource[0].SortKey >> shift) & 0xFF] == count)
+            continue;
+
+        // convert counts to offsets
+        uint32 offset = 0;
+        for (uint32 digit = 0; digit < 256; digit++)
+        {
+            uint32 digitCount = histogram[digit];
+            histogram[digit] = offset;
+            offset += digitCount;
+        }
+
+        for (uint32 i = 0; i < count; i++)
+            pDestination[histogram[(pSource[i].SortKey >> shift) & 0xFF]++] = pSource[i];
+
+        Swap(pSource, pDestination);
+    }
+
+    if (pSource != pKeys)
+        Y_memcpy(pKeys, pSource, sizeof(RENDER_QUEUE_SORT_KEY) * count);
+}
+
+static uint32 CountSortKeyDescents(const RENDER_QUEUE_SORT_KEY *pKeys, uint32 count)
 {
-    return (lhs.SortKey < rhs.SortKey);
+    uint32 descents = 0;
+    for (uint32 i = 1; i < count; i++)
+    {
+        if (pKeys[i].SortKey < pKeys[i - 1].SortKey)
+            descents++;
+    }
+
+    return descents;
 }
 
-void RenderQueue::Sort()
+// returns false if more than maxMoves elements had to be moved, the keys are then only partially sorted
+static bool InsertionSortKeys(RENDER_QUEUE_SORT_KEY *pKeys, uint32 count, uint32 maxMoves)
+{
+    uint32 moves = 0;
+    for (uint32 i = 1; i < count; i++)
+    {
+        RENDER_QUEUE_SORT_KEY key = pKeys[i];
+        uint32 j = i;
+        for (; j > 0 && pKeys[j - 1].SortKey > key.SortKey; j--)
+            pKeys[j] = pKeys[j - 1];
+
+        pKeys[j] = key;
+        moves += i - j;
+        if (moves > maxMoves)
+            return false;
+    }
+
+    return true;
+}
+
+void RenderQueue::SortRenderables(RenderableArray &renderables, SortState &sortState)
 {
-    if (m_opaqueRenderables.GetSize() > 0)
+    uint32 count = renderables.GetSize();
+    if (count < 2)
     {
-        //Y_qsortT<RENDER_QUEUE_RENDERABLE_ENTRY>(m_opaqueRenderables.GetBasePointer(), m_opaqueRenderables.GetSize(), CompFunc);
-        std::sort(m_opaqueRenderables.GetBasePointer(), m_opaqueRenderables.GetBasePointer() + m_opaqueRenderables.GetSize(), CompFuncSTL);
+        sortState.LastOrder.Clear();
+        return;
     }
 
-    if (m_translucentRenderables.GetSize() > 0)
+    sortState.Keys.Resize(count);
+    RENDER_QUEUE_SORT_KEY *pKeys = sortState.Keys.GetBasePointer();
+    const RENDER_QUEUE_RENDERABLE_ENTRY *pEntries = renderables.GetBasePointer();
+
+    // Objects are usually queued in the same order each frame, so if the count matches, try last frame's
+    // order first. If it is still mostly sorted an insertion sort finishes it in close to linear time.
+    bool sorted = false;
+    if (sortState.LastOrder.GetSize() == count)
     {
-        //Y_qsortT<RENDER_QUEUE_RENDERABLE_ENTRY>(m_translucentRenderables.GetBasePointer(), m_translucentRenderables.GetSize(), CompFunc);
-        std::sort(m_translucentRenderables.GetBasePointer(), m_translucentRenderables.GetBasePointer() + m_translucentRenderables.GetSize(), CompFuncSTL);
+        const uint32 *pLastOrder = sortState.LastOrder.GetBasePointer();
+        for (uint32 i = 0; i < count; i++)
+        {
+            pKeys[i].SortKey = pEntries[pLastOrder[i]].SortKey;
+            pKeys[i].Index = pLastOrder[i];
+        }
+
+        uint32 descents = CountSortKeyDescents(pKeys, count);
+        if (descents <= (count / COHERENT_SORT_MAX_DESCENT_DIVISOR))
+        {
+            if (descents > 0 && !InsertionSortKeys(pKeys, count, count * COHERENT_SORT_MAX_MOVES_PER_KEY))
+            {
+                // too far out of place, the keys are still a permutation of the entries so they can be radix sorted as is
+                sortState.ScratchKeys.Resize(count);
+                RadixSortKeys(pKeys, sortState.ScratchKeys.GetBasePointer(), count);
+            }
+
+            sorted = true;
+        }
     }
+
+    if (!sorted)
+    {
+        for (uint32 i = 0; i < count; i++)
+        {
+            pKeys[i].SortKey = pEntries[i].SortKey;
+            pKeys[i].Index = i;
+        }
+
+        if (CountSortKeyDescents(pKeys, count) > 0)
+        {
+            sortState.ScratchKeys.Resize(count);
+            RadixSortKeys(pKeys, sortState.ScratchKeys.GetBasePointer(), count);
+        }
+    }
+
+    // remember the order for next frame, and move the entries into place
+    sortState.LastOrder.Resize(count);
+    sortState.SortedRenderables.Resize(count);
+    uint32 *pLastOrder = sortState.LastOrder.GetBasePointer();
+    RENDER_QUEUE_RENDERABLE_ENTRY *pSortedEntries = sortState.SortedRenderables.GetBasePointer();
+    for (uint32 i = 0; i < count; i++)
+    {
+        pLastOrder[i] = pKeys[i].Index;
+        Y_memcpy(&pSortedEntries[i], &pEntries[pKeys[i].Index], sizeof(RENDER_QUEUE_RENDERABLE_ENTRY));
+    }
+
+    renderables.Swap(sortState.SortedRenderables);
+}
+
+void RenderQueue::Sort()
+{
+    SortRenderables(m_opaqueRenderables, m_opaqueSortState);
+    SortRenderables(m_translucentRenderables, m_translucentSortState);
 }
 
 void RenderQueue::Clear()
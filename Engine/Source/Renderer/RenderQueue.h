@@ -49,6 +49,13 @@ struct RENDER_QUEUE_RENDERABLE_ENTRY
     inline RENDER_QUEUE_RENDERABLE_ENTRY() { Y_memzero(this, sizeof(RENDER_QUEUE_RENDERABLE_ENTRY)); }
 };
 
+// Compact key/index pair, sorted in place of the full queue entries.
+struct RENDER_QUEUE_SORT_KEY
+{
+    uint64 SortKey;
+    uint32 Index;
+};
+
 struct RENDER_QUEUE_DIRECTIONAL_LIGHT_ENTRY
 {
     float3 LightColor;
@@ -121,6 +128,7 @@ public:
     typedef MemArray<RENDER_QUEUE_RENDERABLE_ENTRY> RenderableArray;
     typedef MemArray<RENDER_QUEUE_OCCLUDER_ENTRY> OccluderArray;
     typedef PODArray<const RenderProxy *> DebugDrawRenderableArray;
+    typedef MemArray<RENDER_QUEUE_SORT_KEY> SortKeyArray;
 
 public:
     RenderQueue();
@@ -159,6 +167,21 @@ public:
     // Re-sorts the render queue for optimal performance.
     void Sort();
 
+    // Stable LSD radix sort of the keys, pScratchKeys must have space for count keys.
+    static void RadixSortKeys(RENDER_QUEUE_SORT_KEY *pKeys, RENDER_QUEUE_SORT_KEY *pScratchKeys, uint32 count);
+
+    // Per-array sort state, kept between frames so the previous order can be reused.
+    struct SortState
+    {
+        SortKeyArray Keys;
+        SortKeyArray ScratchKeys;
+        PODArray<uint32> LastOrder;
+        RenderableArray SortedRenderables;
+    };
+
+    // Sorts the keys, then moves each entry to its sorted position once.
+    static void SortRenderables(RenderableArray &renderables, SortState &sortState);
+
     // Clears the render queue.
     void Clear();
 
@@ -232,5 +255,9 @@ private:
 
     // objects with debug draw callbacks
     DebugDrawRenderableArray m_debugDrawObjects;
+
+    // sort state for opaque/translucent objects
+    SortState m_opaqueSortState;
+    SortState m_translucentSortState;
 };
 
@@ -1,40 +1,40 @@
 #include "Renderer/PrecompiledHeader.h"
 #include "Renderer/RenderWorld.h"
 #include "Renderer/Renderer.h"
+#include "Engine/EngineCVars.h"
+
+// Amount the spatial index bounds are enlarged by, movement within this margin does not touch the tree.
+static const float RENDER_WORLD_SPATIAL_INDEX_MARGIN = 0.5f;
 
 RenderWorld::RenderWorld()
+    : m_tree(RENDER_WORLD_SPATIAL_INDEX_MARGIN)
 {
 
 }
 
 RenderWorld::~RenderWorld()
 {
-#if RENDER_WORLD_USE_LINKED_LIST
-    for (NodeList::Iterator itr = m_nodes.Begin(); !itr.AtEnd(); )
-    {
-        RenderProxy *pRenderProxy = itr->pRenderProxy;
-        pRenderProxy->OnRemoveFromRenderWorld(this);
-        pRenderProxy->m_pRenderWorld = NULL;
-        pRenderProxy->Release();
-
-        itr = m_nodes.EraseIterator(itr);
-    }
-#else
     while (m_nodes.GetSize() > 0)
     {
         Node &node = m_nodes[m_nodes.GetSize() - 1];
         node.pRenderProxy->OnRemoveFromRenderWorld(this);
         node.pRenderProxy->m_pRenderWorld = nullptr;
+        node.pRenderProxy->m_renderWorldTreeProxyId = -1;
         node.pRenderProxy->Release();
         m_nodes.FastRemove(m_nodes.GetSize() - 1);
     }
     m_nodes.Obliterate();
-#endif
+    m_tree.RemoveAll();
 
     // should be empty
     Assert(m_nodes.GetSize() == 0);
 }
 
+bool RenderWorld::IsSpatialIndexEnabled() const
+{
+    return CVars::r_render_world_spatial_index.GetBool();
+}
+
 void RenderWorld::AddRenderable(RenderProxy *pRenderProxy)
 {
     // bind it to the render world, that way any modifications that happen
@@ -52,11 +52,9 @@ void RenderWorld::AddRenderable(RenderProxy *pRenderProxy)
         node.BoundingSphere = pRenderProxy->GetBoundingSphere();
         node.pRenderProxy = pRenderProxy;
 
-#if RENDER_WORLD_USE_LINKED_LIST
-        pThis->m_nodes.PushBack(node);
-#else
+        pRenderProxy->m_renderWorldNodeIndex = pThis->m_nodes.GetSize();
+        pRenderProxy->m_renderWorldTreeProxyId = pThis->m_tree.CreateProxy(node.BoundingBox, pRenderProxy);
         pThis->m_nodes.Add(node);
-#endif
     });
 }
 
@@ -67,39 +65,20 @@ void RenderWorld::RemoveRenderable(RenderProxy *pRenderProxy)
     ReferenceCountedHolder<RenderWorld> pThis(this);
     QUEUE_RENDERER_LAMBDA_COMMAND([pRenderProxy, pThis]()
     {
-#if RENDER_WORLD_USE_LINKED_LIST
+        uint32 nodeIndex = pRenderProxy->m_renderWorldNodeIndex;
+        if (pRenderProxy->m_renderWorldTreeProxyId < 0 || nodeIndex >= pThis->m_nodes.GetSize() || pThis->m_nodes[nodeIndex].pRenderProxy != pRenderProxy)
+            Panic("Attempt to remove renderable not in render world");
 
-        NodeList::Iterator itr;
-        for (itr = m_nodes.Begin(); !itr.AtEnd(); itr.Forward())
-        {
-            if (itr->pRenderProxy == pRenderProxy)
-                break;
-        }
+        pThis->m_tree.DestroyProxy(pRenderProxy->m_renderWorldTreeProxyId);
+        pRenderProxy->m_renderWorldTreeProxyId = -1;
 
-        Assert(!itr.AtEnd());
-        pRenderProxy->OnRemoveFromRenderWorld(pThis);
-        pThis->m_nodes.Erase(itr);
+        // the last node is moved into this slot, so fix up its index
+        pThis->m_nodes.FastRemove(nodeIndex);
+        if (nodeIndex < pThis->m_nodes.GetSize())
+            pThis->m_nodes[nodeIndex].pRenderProxy->m_renderWorldNodeIndex = nodeIndex;
 
         pRenderProxy->m_pRenderWorld = NULL;
         pRenderProxy->Release();
-
-#else
-
-        for (uint32 i = 0; i < pThis->m_nodes.GetSize(); i++)
-        {
-            Node &node = pThis->m_nodes[i];
-            if (node.pRenderProxy == pRenderProxy)
-            {
-                pThis->m_nodes.FastRemove(i);
-                pRenderProxy->m_pRenderWorld = NULL;
-                pRenderProxy->Release();
-                return;
-            }
-        }
-
-        Panic("Attempt to remove renderable not in render world");
-
-#endif
     });
 }
 
@@ -107,33 +86,63 @@ void RenderWorld::MoveRenderable(RenderProxy *pRenderProxy)
 {
     DebugAssert(Renderer::IsOnRenderThread());
 
-#if RENDER_WORLD_USE_LINKED_LIST
+    uint32 nodeIndex = pRenderProxy->m_renderWorldNodeIndex;
+    if (pRenderProxy->m_renderWorldTreeProxyId < 0 || nodeIndex >= m_nodes.GetSize() || m_nodes[nodeIndex].pRenderProxy != pRenderProxy)
+        Panic("Attempting to update renderable not in world.");
 
-    NodeList::Iterator itr = m_nodes.Begin();
-    for (; !itr.AtEnd(); itr.Forward())
-    {
-        if (itr->pRenderProxy == pRenderProxy)
-        {
-            itr->BoundingBox = pRenderProxy->GetBoundingBox();
-            itr->BoundingSphere = pRenderProxy->GetBoundingSphere();
-            return;
-        }
-    }
+    Node &node = m_nodes[nodeIndex];
+    node.BoundingBox = pRenderProxy->GetBoundingBox();
+    node.BoundingSphere = pRenderProxy->GetBoundingSphere();
+    m_tree.MoveProxy(pRenderProxy->m_renderWorldTreeProxyId, node.BoundingBox);
+}
 
-#else
+bool RenderWorld::RayCast(const Ray &ray, float3 &contactNormal, float3 &contactPoint, bool exitAtFirstIntersection) const
+{
+    float closestDistance = Y_FLT_INFINITE;
+    float3 closestNormal, closestPoint;
+    bool foundAny = false;
 
-    for (uint32 i = 0; i < m_nodes.GetSize(); i++)
+    auto testRenderProxy = [&](const RenderProxy *pRenderProxy)
     {
-        Node &node = m_nodes[i];
-        if (node.pRenderProxy == pRenderProxy)
-        {
-            node.BoundingBox = pRenderProxy->GetBoundingBox();
-            node.BoundingSphere = pRenderProxy->GetBoundingSphere();
+        if (foundAny && exitAtFirstIntersection)
             return;
+
+        float3 nodeContactNormal, nodeContactPoint;
+        if (pRenderProxy->RayCast(ray, nodeContactNormal, nodeContactPoint, exitAtFirstIntersection))
+        {
+            float nodeDistance = (nodeContactPoint - ray.GetOrigin()).SquaredLength();
+            if (!foundAny || nodeDistance < closestDistance)
+            {
+                closestDistance = nodeDistance;
+                closestNormal = nodeContactNormal;
+                closestPoint = nodeContactPoint;
+                foundAny = true;
+            }
         }
+    };
+
+    if (IsSpatialIndexEnabled())
+    {
+        m_tree.EnumerateIntersectingRay(ray, [&testRenderProxy](void *pUserData) { testRenderProxy(reinterpret_cast<const RenderProxy *>(pUserData)); });
+    }
+    else
+    {
+        for (uint32 i = 0; i < m_nodes.GetSize(); i++)
+            testRenderProxy(m_nodes[i].pRenderProxy);
     }
 
-#endif
+    if (!foundAny)
+        return false;
 
-    Panic("Attempting to update renderable not in world.");
+    contactNormal = closestNormal;
+    contactPoint = closestPoint;
+    return true;
+}
+
+void RenderWorld::GetIntersectingTrianglesInAABox(const AABox &aaBox, RenderProxy::IntersectingTriangleArray &intersectingTriangles) const
+{
+    EnumerateRenderablesInAABox(aaBox, [&aaBox, &intersectingTriangles](const RenderProxy *pRenderProxy)
+    {
+        pRenderProxy->GetIntersectingTriangles(aaBox, intersectingTriangles);
+    });
 }
@@ -1,8 +1,7 @@
 #pragma once
 #include "Renderer/Common.h"
 #include "Renderer/RenderProxy.h"
-
-//#define RENDER_WORLD_USE_LINKED_LIST 1
+#include "Core/DynamicAABBTree.h"
 
 class RenderWorld : public ReferenceCounted
 {
@@ -17,172 +16,25 @@ public:
     // Can be called from render thread.
     void MoveRenderable(RenderProxy *pRenderProxy);
 
-#if RENDER_WORLD_USE_LINKED_LIST
-    // enumerators
-    template<typename T>
-    void EnumerateRenderables(T &Callback)
-    {
-        NodeList::Iterator itr = m_nodes.Begin();
-        for (; !itr.AtEnd(); itr.Forward())
-            Callback(itr->pRenderProxy);
-    }
-    template<typename T>
-    void EnumerateRenderables(T &Callback) const
-    {
-        NodeList::ConstIterator itr = m_nodes.Begin();
-        for (; !itr.AtEnd(); itr.Forward())
-            Callback(itr->pRenderProxy);
-    }
-    template<typename T>
-    void EnumerateRenderablesInAABox(const AABox &aaBox, T Callback)
-    {
-        NodeList::Iterator itr = m_nodes.Begin();
-        for (; !itr.AtEnd(); itr.Forward())
-        {
-            if (aaBox.AABoxIntersection(itr->BoundingBox))
-                Callback(itr->pRenderProxy);
-        }
-    }
-    template<typename T>
-    void EnumerateRenderablesForEntity(uint32 entityId, T Callback)
-    {
-        NodeList::Iterator itr = m_nodes.Begin();
-        for (; !itr.AtEnd(); itr.Forward())
-        {
-            Node &node = *itr;
-            if (node.pRenderProxy->GetEntityId() == entityId)
-                Callback(node.pRenderProxy);
-        }
-    }
-    template<typename T>
-    void EnumerateRenderablesInAABox(const AABox &aaBox, T Callback) const
-    {
-        NodeList::ConstIterator itr = m_nodes.Begin();
-        for (; !itr.AtEnd(); itr.Forward())
-        {
-            if (aaBox.AABoxIntersection(itr->BoundingBox))
-                Callback(itr->pRenderProxy);
-        }
-    }
-    template<typename T>
-    void EnumerateRenderablesInFrustum(const Frustum &rFrustum, T Callback)
-    {
-        NodeList::Iterator itr = m_nodes.Begin();
-        for (; !itr.AtEnd(); itr.Forward())
-        {
-            //if (rFrustum.SphereIntersection(itr->BoundingSphere) && rFrustum.AABoxIntersection(itr->BoundingBox))
-            if (rFrustum.AABoxIntersection(itr->BoundingBox))
-                Callback(itr->pRenderProxy);
-        }
-    }
-    template<typename T>
-    void EnumerateRenderablesInFrustum(const Frustum &rFrustum, T Callback) const
-    {
-        NodeList::ConstIterator itr = m_nodes.Begin();
-        for (; !itr.AtEnd(); itr.Forward())
-        {
-            //if (rFrustum.SphereIntersection(itr->BoundingSphere) && rFrustum.AABoxIntersection(itr->BoundingBox))
-            if (rFrustum.AABoxIntersection(itr->BoundingBox))
-                Callback(itr->pRenderProxy);
-        }
-    }
-    template<typename T>
-    void EnumerateRenderablesForEntity(uint32 entityId, T Callback) const
-    {
-        NodeList::ConstIterator itr = m_nodes.Begin();
-        for (; !itr.AtEnd(); itr.Forward())
-        {
-            const Node &node = *itr;
-            if (node.pRenderProxy->GetEntityId() == entityId)
-                Callback(node.pRenderProxy);
-        }
-    }
-
-    bool RayCast(const Ray &ray, float3 &contactNormal, float3 &contactPoint, bool exitAtFirstIntersection) const
-    {
-        float closestDistance = Y_FLT_INFINITE;
-        float3 closestNormal, closestPoint;
-
-        NodeList::ConstIterator itr = m_nodes.Begin();
-        for (; !itr.AtEnd(); itr.Forward())
-        {
-            const Node &node = *itr;
-            float3 nodeContactNormal, nodeContactPoint;
-            if (node.pRenderProxy->RayCast(ray, nodeContactNormal, nodeContactPoint, exitAtFirstIntersection))
-            {
-                if (exitAtFirstIntersection)
-                {
-                    contactNormal = nodeContactNormal;
-                    contactPoint = nodeContactPoint;
-                    return true;
-                }
-
-                float nodeDistance = (nodeContactPoint - ray.GetOrigin()).SquaredLength();
-                if (nodeDistance < closestDistance)
-                {
-                    closestDistance = nodeDistance;
-                    closestNormal = nodeContactNormal;
-                    closestPoint = nodeContactPoint;
-                }
-            }
-        }
-
-        if (closestDistance == Y_FLT_INFINITE)
-            return false;
-
-        contactNormal = closestNormal;
-        contactPoint = closestPoint;
-        return true;
-    }
+    // Returns false if queries should walk the flat renderable list instead of the spatial index (r_render_world_spatial_index).
+    bool IsSpatialIndexEnabled() const;
 
-    void GetIntersectingTrianglesInAABox(const AABox &aaBox, RenderProxy::IntersectingTriangleArray &intersectingTriangles) const
-    {
-        NodeList::ConstIterator itr = m_nodes.Begin();
-        for (; !itr.AtEnd(); itr.Forward())
-        {
-            const Node &node = *itr;
-            if (node.pRenderProxy->GetBoundingBox().AABoxIntersection(aaBox))
-                node.pRenderProxy->GetIntersectingTriangles(aaBox, intersectingTriangles);
-        }
-    }
-
-#else
     // enumerators
     template<typename T>
-    void EnumerateRenderables(T &Callback)
-    {
-        for (uint32 i = 0; i < m_nodes.GetSize(); i++)
-            Callback(m_nodes[i].pRenderProxy);
-    }
-    template<typename T>
     void EnumerateRenderables(T &Callback) const
     {
         for (uint32 i = 0; i < m_nodes.GetSize(); i++)
             Callback(m_nodes[i].pRenderProxy);
     }
     template<typename T>
-    void EnumerateRenderablesInAABox(const AABox &aaBox, T Callback)
-    {
-        for (uint32 i = 0; i < m_nodes.GetSize(); i++)
-        {
-            Node &node = m_nodes[i];
-            if (aaBox.AABoxIntersection(node.BoundingBox))
-                Callback(node.pRenderProxy);
-        }
-    }
-    template<typename T>
-    void EnumerateRenderablesForEntity(uint32 entityId, T Callback)
+    void EnumerateRenderablesInAABox(const AABox &aaBox, T Callback) const
     {
-        for (uint32 i = 0; i < m_nodes.GetSize(); i++)
+        if (IsSpatialIndexEnabled())
         {
-            Node &node = m_nodes[i];
-            if (node.pRenderProxy->GetEntityId() == entityId)
-                Callback(node.pRenderProxy);
+            m_tree.EnumerateInAABox(aaBox, [&Callback](void *pUserData) { Callback(reinterpret_cast<RenderProxy *>(pUserData)); });
+            return;
         }
-    }
-    template<typename T>
-    void EnumerateRenderablesInAABox(const AABox &aaBox, T Callback) const
-    {
+
         for (uint32 i = 0; i < m_nodes.GetSize(); i++)
         {
             const Node &node = m_nodes[i];
@@ -191,19 +43,14 @@ public:
         }
     }
     template<typename T>
-    void EnumerateRenderablesInFrustum(const Frustum &rFrustum, T Callback)
+    void EnumerateRenderablesInFrustum(const Frustum &rFrustum, T Callback) const
     {
-        for (uint32 i = 0; i < m_nodes.GetSize(); i++)
+        if (IsSpatialIndexEnabled())
         {
-            Node &node = m_nodes[i];
-            if (rFrustum.SphereIntersection(node.BoundingSphere) && rFrustum.AABoxIntersection(node.BoundingBox))
-            //if (rFrustum.AABoxIntersection(node.BoundingBox))
-                Callback(node.pRenderProxy);
+            m_tree.EnumerateInFrustum(rFrustum, [&Callback](void *pUserData) { Callback(reinterpret_cast<RenderProxy *>(pUserData)); });
+            return;
         }
-    }
-    template<typename T>
-    void EnumerateRenderablesInFrustum(const Frustum &rFrustum, T Callback) const
-    {
+
         for (uint32 i = 0; i < m_nodes.GetSize(); i++)
         {
             const Node &node = m_nodes[i];
@@ -223,52 +70,13 @@ public:
         }
     }
 
-    bool RayCast(const Ray &ray, float3 &contactNormal, float3 &contactPoint, bool exitAtFirstIntersection) const
-    {
-        float closestDistance = Y_FLT_INFINITE;
-        float3 closestNormal, closestPoint;
+    bool RayCast(const Ray &ray, float3 &contactNormal, float3 &contactPoint, bool exitAtFirstIntersection) const;
 
-        for (uint32 i = 0; i < m_nodes.GetSize(); i++)
-        {
-            const Node &node = m_nodes[i];
-            float3 nodeContactNormal, nodeContactPoint;
-            if (node.pRenderProxy->RayCast(ray, nodeContactNormal, nodeContactPoint, exitAtFirstIntersection))
-            {
-                if (exitAtFirstIntersection)
-                {
-                    contactNormal = nodeContactNormal;
-                    contactPoint = nodeContactPoint;
-                    return true;
-                }
-
-                float nodeDistance = (nodeContactPoint - ray.GetOrigin()).SquaredLength();
-                if (nodeDistance < closestDistance)
-                {
-                    closestDistance = nodeDistance;
-                    closestNormal = nodeContactNormal;
-                    closestPoint = nodeContactPoint;
-                }
-            }
-        }
-
-        if (closestDistance == Y_FLT_INFINITE)
-            return false;
+    void GetIntersectingTrianglesInAABox(const AABox &aaBox, RenderProxy::IntersectingTriangleArray &intersectingTriangles) const;
 
-        contactNormal = closestNormal;
-        contactPoint = closestPoint;
-        return true;
-    }
-
-    void GetIntersectingTrianglesInAABox(const AABox &aaBox, RenderProxy::IntersectingTriangleArray &intersectingTriangles) const
-    {
-        for (uint32 i = 0; i < m_nodes.GetSize(); i++)
-        {
-            const Node &node = m_nodes[i];
-            if (node.pRenderProxy->GetBoundingBox().AABoxIntersection(aaBox))
-                node.pRenderProxy->GetIntersectingTriangles(aaBox, intersectingTriangles);
-        }
-    }
-#endif
+    // Statistics
+    uint32 GetRenderableCount() const { return m_nodes.GetSize(); }
+    int32 GetSpatialIndexHeight() const { return m_tree.GetHeight(); }
     
 private:
     struct Node
@@ -279,15 +87,11 @@ private:
         RenderProxy *pRenderProxy;
     };
 
-#if RENDER_WORLD_USE_LINKED_LIST
-    typedef List<Node> NodeList;
-#else
     typedef MemArray<Node> NodeList;
-#endif
-    typedef PODArray<RenderProxy *> RenderProxyQueue;
 
     // Owned by render thread at async run time.
     // Owned by game thread at synchronization time.
+    // The node list and tree always contain the same renderables, RenderProxy holds the index into both.
     NodeList m_nodes;
+    DynamicAABBTree m_tree;
 };
-
@@ -12,6 +12,8 @@
 #include "Renderer/ShaderProgram.h"
 #include "Renderer/ShaderConstantBuffer.h"
 #include "Renderer/ShaderCompilerFrontend.h"
+#include "Renderer/VertexFactory.h"
+#include "Core/MappedFile.h"
 #include "Renderer/Shaders/OverlayShader.h"
 #include "Renderer/Shaders/TextureBlitShader.h"
 #include "Renderer/Shaders/DownsampleShader.h"
@@ -481,6 +483,17 @@ bool Renderer::BaseOnStart()
     // set render thread id
     s_renderThreadId = Thread::GetCurrentThreadId();
 
+    // open the shader cache for this configuration before any programs are needed
+    if (CVars::r_use_shader_cache.GetBool())
+    {
+        SmallString shaderCacheName;
+        shaderCacheName.Format("shadercache/%s_%s_%s", NameTable_GetNameString(NameTables::RendererPlatform, GetPlatform()),
+                                                       NameTable_GetNameString(NameTables::RendererFeatureLevel, GetFeatureLevel()),
+                                                       (CVars::r_use_debug_shaders.GetBool()) ? "DEBUG" : "RELEASE");
+
+        m_shaderCache.Open(shaderCacheName);
+    }
+
     // states
     if (!m_fixedResources.CreateResources())
     {
@@ -513,6 +526,9 @@ void Renderer::BaseOnShutdown()
     // release all non-material shaders
     m_nullMaterialShaderMap.ReleaseGPUResources();
 
+    // write out anything compiled this session
+    m_shaderCache.Close();
+
     // free command list pool
     Assert(m_outstandingCommandListCount == 0);
     while (m_freeCommandListPool.GetSize() > 0)
@@ -1111,6 +1127,110 @@ ShaderProgram *Renderer::GetShaderProgram(uint32 globalShaderFlags, const Shader
     return shaderMap.GetShaderPermutation(globalShaderFlags, pBaseShaderTypeInfo, baseShaderFlags, pVertexFactoryTypeInfo, vertexFactoryFlags, pMaterialShader, materialShaderFlags);
 }
 
+void Renderer::PrecompileRecordedShaderPermutations(ProgressCallbacks *pProgressCallbacks /* = ProgressCallbacks::NullProgressCallback */)
+{
+    Array<ShaderCache::RecordedPermutation> recordedPermutations;
+    if (!m_shaderCache.IsOpen() || !m_shaderCache.ReadRecordedPermutations(&recordedPermutations) || recordedPermutations.IsEmpty())
+        return;
+
+    struct Permutation
+    {
+        uint32 GlobalShaderFlags;
+        const ShaderComponentTypeInfo *pBaseShaderTypeInfo;
+        uint32 BaseShaderFlags;
+        const VertexFactoryTypeInfo *pVertexFactoryTypeInfo;
+        uint32 VertexFactoryFlags;
+        const MaterialShader *pMaterialShader;
+        uint32 MaterialShaderFlags;
+    };
+
+    // resolve names, permutations referring to types or materials that no longer exist are skipped
+    pProgressCallbacks->SetStatusText("Loading shader permutations...");
+    MemArray<Permutation> permutations;
+    for (uint32 i = 0; i < recordedPermutations.GetSize(); i++)
+    {
+        const ShaderCache::RecordedPermutation &recordedPermutation = recordedPermutations[i];
+        Permutation permutation;
+        permutation.GlobalShaderFlags = recordedPermutation.GlobalShaderFlags;
+        permutation.pBaseShaderTypeInfo = nullptr;
+        permutation.BaseShaderFlags = recordedPermutation.BaseShaderFlags;
+        permutation.pVertexFactoryTypeInfo = nullptr;
+        permutation.VertexFactoryFlags = recordedPermutation.VertexFactoryFlags;
+        permutation.pMaterialShader = nullptr;
+        permutation.MaterialShaderFlags = recordedPermutation.MaterialShaderFlags;
+
+        if (!recordedPermutation.BaseShaderTypeName.IsEmpty())
+        {
+            const ObjectTypeInfo *pTypeInfo = ObjectTypeInfo::GetRegistry().GetTypeInfoByName(recordedPermutation.BaseShaderTypeName);
+            if (pTypeInfo == nullptr || !pTypeInfo->IsDerived(SHADER_COMPONENT_INFO(ShaderComponent)))
+                continue;
+
+            permutation.pBaseShaderTypeInfo = static_cast<const ShaderComponentTypeInfo *>(pTypeInfo);
+        }
+
+        if (!recordedPermutation.VertexFactoryTypeName.IsEmpty())
+        {
+            const ObjectTypeInfo *pTypeInfo = ObjectTypeInfo::GetRegistry().GetTypeInfoByName(recordedPermutation.VertexFactoryTypeName);
+            if (pTypeInfo == nullptr || !pTypeInfo->IsDerived(VERTEX_FACTORY_TYPE_INFO(VertexFactory)))
+                continue;
+
+            permutation.pVertexFactoryTypeInfo = static_cast<const VertexFactoryTypeInfo *>(pTypeInfo);
+        }
+
+        if (!recordedPermutation.MaterialShaderName.IsEmpty() && (permutation.pMaterialShader = g_pResourceManager->GetMaterialShader(recordedPermutation.MaterialShaderName)) == nullptr)
+            continue;
+
+        permutations.Add(permutation);
+    }
+
+    // compile anything missing from the cache on the workers, in groups so progress can be reported
+    JobSystem *pJobSystem = g_pEngine->GetJobSystem();
+    uint32 groupSize = Max(pJobSystem->GetWorkerThreadCount(), (uint32)1) * 4;
+    const Permutation *pPermutationArray = permutations.GetBasePointer();
+    pProgressCallbacks->SetFormattedStatusText("Compiling %u shader permutations...", permutations.GetSize());
+    pProgressCallbacks->SetProgressRange(permutations.GetSize());
+    pProgressCallbacks->SetProgressValue(0);
+    for (uint32 groupStart = 0; groupStart < permutations.GetSize(); groupStart += groupSize)
+    {
+        uint32 groupCount = Min(groupSize, permutations.GetSize() - groupStart);
+        pJobSystem->ParallelFor(groupCount, 1, [pPermutationArray, groupStart](uint32 start, uint32 end) {
+            for (uint32 i = groupStart + start; i < groupStart + end; i++)
+            {
+                const Permutation &permutation = pPermutationArray[i];
+                MappedFile *pProgramData = ShaderMap::LoadProgramData(permutation.GlobalShaderFlags, permutation.pBaseShaderTypeInfo, permutation.BaseShaderFlags,
+                                                                      permutation.pVertexFactoryTypeInfo, permutation.VertexFactoryFlags,
+                                                                      permutation.pMaterialShader, permutation.MaterialShaderFlags);
+                if (pProgramData != nullptr)
+                    pProgramData->Release();
+            }
+        });
+
+        pProgressCallbacks->SetProgressValue(groupStart + groupCount);
+    }
+
+    // write the new programs out now, rather than at shutdown
+    m_shaderCache.Flush();
+
+    // gpu objects are created on the render thread, the permutations are all cached by now
+    pProgressCallbacks->SetStatusText("Creating shader programs...");
+    QUEUE_BLOCKING_RENDERER_LAMBA_COMMAND([this, &permutations]() {
+        for (uint32 i = 0; i < permutations.GetSize(); i++)
+        {
+            const Permutation &permutation = permutations[i];
+            GetShaderProgram(permutation.GlobalShaderFlags, permutation.pBaseShaderTypeInfo, permutation.BaseShaderFlags,
+                             permutation.pVertexFactoryTypeInfo, permutation.VertexFactoryFlags,
+                             permutation.pMaterialShader, permutation.MaterialShaderFlags);
+        }
+    });
+
+    Log_InfoPrintf("Renderer::PrecompileRecordedShaderPermutations: %u of %u recorded permutations created", permutations.GetSize(), recordedPermutations.GetSize());
+    for (uint32 i = 0; i < permutations.GetSize(); i++)
+    {
+        if (permutations[i].pMaterialShader != nullptr)
+            permutations[i].pMaterialShader->Release();
+    }
+}
+
 uint3 Renderer::GetTextureDimensions(const GPUTexture *pTexture)
 {
     switch (pTexture->GetTextureType())
@@ -7,6 +7,7 @@
 #include "Renderer/VertexFactories/PlainVertexFactory.h"        // <--- TODO REMOVE ME
 #include "Renderer/MiniGUIContext.h"
 #include "Renderer/ShaderMap.h"
+#include "Renderer/ShaderCache.h"
 
 // Forward declare classes
 class Camera;
@@ -950,6 +951,13 @@ public:
     template<class T> ShaderProgram *GetShaderProgram(uint32 globalShaderFlags, uint32 baseShaderFlags, const VertexFactoryTypeInfo *pVertexFactoryTypeInfo, uint32 vertexFactoryFlags, const MaterialShader *pMaterialShader, uint32 materialShaderFlags) { return GetShaderProgram(globalShaderFlags, SHADER_COMPONENT_INFO(T), baseShaderFlags, pVertexFactoryTypeInfo, vertexFactoryFlags, pMaterialShader, materialShaderFlags); }
     template<class SHADERTYPE, class VERTEXFACTORYTYPE> ShaderProgram *GetShaderProgram(uint32 globalShaderFlags, uint32 baseShaderFlags, uint32 vertexFactoryFlags, const MaterialShader *pMaterialShader, uint32 materialShaderFlags) { return GetShaderProgram(globalShaderFlags, SHADER_COMPONENT_INFO(SHADERTYPE), baseShaderFlags, VERTEX_FACTORY_TYPE_INFO(VERTEXFACTORYTYPE), vertexFactoryFlags, pMaterialShader, materialShaderFlags); }
 
+    // on-disk cache of compiled shader programs
+    ShaderCache *GetShaderCache() { return &m_shaderCache; }
+
+    // compiles every permutation in the shader cache's recorded list on the job system, then creates the programs
+    // on the render thread. intended to be called from a loading screen.
+    void PrecompileRecordedShaderPermutations(ProgressCallbacks *pProgressCallbacks = ProgressCallbacks::NullProgressCallback);
+
     // determine texture dimensions on a gpu texture
     static uint3 GetTextureDimensions(const GPUTexture *pTexture);
 
@@ -1051,6 +1059,9 @@ protected:
     ShaderMap m_nullMaterialShaderMap;
     Mutex m_shaderLock;
 
+    // compiled shader cache
+    ShaderCache m_shaderCache;
+
     // state manager
     Renderer::FixedResources m_fixedResources;
 
@@ -0,0 +1,423 @@
+#include "Renderer/PrecompiledHeader.h"
+#include "Renderer/ShaderCache.h"
+#include "Renderer/ShaderComponentTypeInfo.h"
+#include "Renderer/VertexFactoryTypeInfo.h"
+#include "Engine/MaterialShader.h"
+#include "Engine/DataFormats.h"
+#include "Core/MappedFile.h"
+#include "YBaseLib/BinaryBlob.h"
+#include "YBaseLib/BinaryReader.h"
+#include "YBaseLib/BinaryWriter.h"
+Log_SetChannel(ShaderCache);
+
+static uint32 GetPaddedEntrySize(uint32 dataSize)
+{
+    return (dataSize + DF_SHADER_CACHE_ENTRY_ALIGNMENT - 1) & ~(uint32)(DF_SHADER_CACHE_ENTRY_ALIGNMENT - 1);
+}
+
+static uint32 GetHashCodeKey(const uint8 hashCode[16])
+{
+    uint32 key;
+    Y_memcpy(&key, hashCode, sizeof(key));
+    return key;
+}
+
+int32 ShaderCache::HashCodeIndex::Find(const uint8 hashCode[16]) const
+{
+    const HashTable<uint32, uint32>::Member *pMember = m_heads.Find(GetHashCodeKey(hashCode));
+    if (pMember == nullptr)
+        return -1;
+
+    for (int32 nodeIndex = (int32)pMember->Value; nodeIndex >= 0; nodeIndex = m_nodes[nodeIndex].Next)
+    {
+        const Node &node = m_nodes[nodeIndex];
+        if (Y_memcmp(node.HashCode, hashCode, sizeof(node.HashCode)) == 0)
+            return (int32)node.Value;
+    }
+
+    return -1;
+}
+
+void ShaderCache::HashCodeIndex::Insert(const uint8 hashCode[16], uint32 value)
+{
+    // new nodes go on the front of the chain
+    Node node;
+    Y_memcpy(node.HashCode, hashCode, sizeof(node.HashCode));
+    node.Value = value;
+    node.Next = -1;
+
+    uint32 nodeIndex = m_nodes.GetSize();
+    HashTable<uint32, uint32>::Member *pMember = m_heads.Find(GetHashCodeKey(hashCode));
+    if (pMember != nullptr)
+    {
+        node.Next = (int32)pMember->Value;
+        pMember->Value = nodeIndex;
+    }
+    else
+    {
+        m_heads.Insert(GetHashCodeKey(hashCode), nodeIndex);
+    }
+
+    m_nodes.Add(node);
+}
+
+void ShaderCache::HashCodeIndex::Clear()
+{
+    m_nodes.Clear();
+    m_heads.Clear();
+}
+
+ShaderCache::ShaderCache()
+    : m_open(false),
+      m_pMappedFile(nullptr),
+      m_fileSize(0),
+      m_pendingEntryCount(0),
+      m_permutationListValid(false)
+{
+
+}
+
+ShaderCache::~ShaderCache()
+{
+    Close();
+}
+
+bool ShaderCache::Open(const char *baseFileName)
+{
+    Close();
+
+    m_cacheFileName.Format("%s.cache", baseFileName);
+    m_permutationListFileName.Format("%s.permutations", baseFileName);
+    m_open = true;
+
+    MutexLock lock(m_lock);
+    if (LoadCacheFile())
+        Log_InfoPrintf("ShaderCache::Open: %u programs in '%s'", m_entries.GetSize(), m_cacheFileName.GetCharArray());
+
+    LoadRecordedHashCodes();
+    return true;
+}
+
+void ShaderCache::Close()
+{
+    if (!m_open)
+        return;
+
+    Flush();
+
+    MutexLock lock(m_lock);
+    ReleaseEntries();
+    m_recordedHashCodes.Clear();
+    m_open = false;
+}
+
+bool ShaderCache::LoadCacheFile()
+{
+    DebugAssert(m_pMappedFile == nullptr);
+    m_pMappedFile = g_pVirtualFileSystem->MapFile(m_cacheFileName);
+    if (m_pMappedFile == nullptr)
+        return false;
+
+    const byte *pData = m_pMappedFile->GetData();
+    uint64 fileSize = m_pMappedFile->GetSize();
+    const DF_SHADER_CACHE_HEADER *pHeader = reinterpret_cast<const DF_SHADER_CACHE_HEADER *>(pData);
+    if (fileSize < sizeof(DF_SHADER_CACHE_HEADER) || pHeader->Magic != DF_SHADER_CACHE_HEADER_MAGIC || pHeader->Version != DF_SHADER_CACHE_HEADER_VERSION)
+    {
+        Log_WarningPrintf("ShaderCache::LoadCacheFile: '%s' has a bad header, it will be rebuilt.", m_cacheFileName.GetCharArray());
+        ReleaseEntries();
+        return false;
+    }
+
+    // walk the entries, later entries replace earlier ones with the same hash code
+    uint64 offset = sizeof(DF_SHADER_CACHE_HEADER);
+    while (offset < fileSize)
+    {
+        const DF_SHADER_CACHE_ENTRY_HEADER *pEntryHeader = reinterpret_cast<const DF_SHADER_CACHE_ENTRY_HEADER *>(pData + offset);
+        if ((offset + sizeof(DF_SHADER_CACHE_ENTRY_HEADER)) > fileSize || pEntryHeader->Magic != DF_SHADER_CACHE_ENTRY_MAGIC ||
+            (offset + sizeof(DF_SHADER_CACHE_ENTRY_HEADER) + pEntryHeader->DataSize) > fileSize)
+        {
+            // most likely an interrupted append, the file can't be truncated while it's mapped so start over
+            Log_WarningPrintf("ShaderCache::LoadCacheFile: '%s' is damaged at offset %u, it will be rebuilt.", m_cacheFileName.GetCharArray(), (uint32)offset);
+            ReleaseEntries();
+            return false;
+        }
+
+        Entry entry;
+        Y_memcpy(entry.HashCode, pEntryHeader->HashCode, sizeof(entry.HashCode));
+        entry.DataOffset = (uint32)(offset + sizeof(DF_SHADER_CACHE_ENTRY_HEADER));
+        entry.DataSize = pEntryHeader->DataSize;
+        entry.pPendingData = nullptr;
+
+        int32 entryIndex = m_entryIndex.Find(entry.HashCode);
+        if (entryIndex >= 0)
+        {
+            m_entries[entryIndex] = entry;
+        }
+        else
+        {
+            m_entryIndex.Insert(entry.HashCode, m_entries.GetSize());
+            m_entries.Add(entry);
+        }
+
+        offset += sizeof(DF_SHADER_CACHE_ENTRY_HEADER) + GetPaddedEntrySize(pEntryHeader->DataSize);
+    }
+
+    m_fileSize = fileSize;
+    return true;
+}
+
+void ShaderCache::ReleaseEntries()
+{
+    for (uint32 i = 0; i < m_entries.GetSize(); i++)
+    {
+        if (m_entries[i].pPendingData != nullptr)
+            m_entries[i].pPendingData->Release();
+    }
+
+    m_entries.Clear();
+    m_entryIndex.Clear();
+    m_pendingEntryCount = 0;
+    m_fileSize = 0;
+
+    if (m_pMappedFile != nullptr)
+    {
+        m_pMappedFile->Release();
+        m_pMappedFile = nullptr;
+    }
+}
+
+MappedFile *ShaderCache::FindEntry(const uint8 hashCode[16])
+{
+    MutexLock lock(m_lock);
+    int32 entryIndex = m_entryIndex.Find(hashCode);
+    if (entryIndex < 0)
+        return nullptr;
+
+    const Entry &entry = m_entries[entryIndex];
+    if (entry.pPendingData != nullptr)
+        return MappedFile::CreateView(entry.pPendingData, reinterpret_cast<const byte *>(entry.pPendingData->GetDataPointer()), entry.DataSize);
+    else
+        return MappedFile::CreateView(m_pMappedFile, m_pMappedFile->GetData() + entry.DataOffset, entry.DataSize);
+}
+
+void ShaderCache::AddEntry(const uint8 hashCode[16], const void *pData, uint32 dataSize)
+{
+    BinaryBlob *pBlob = BinaryBlob::Allocate(dataSize);
+    Y_memcpy(pBlob->GetDataPointer(), pData, dataSize);
+
+    MutexLock lock(m_lock);
+    int32 entryIndex = m_entryIndex.Find(hashCode);
+    if (entryIndex < 0)
+    {
+        entryIndex = (int32)m_entries.GetSize();
+        m_entryIndex.Insert(hashCode, (uint32)entryIndex);
+        m_entries.Add(Entry());
+        Y_memcpy(m_entries[entryIndex].HashCode, hashCode, sizeof(m_entries[entryIndex].HashCode));
+        m_entries[entryIndex].pPendingData = nullptr;
+    }
+
+    Entry &entry = m_entries[entryIndex];
+    if (entry.pPendingData != nullptr)
+        entry.pPendingData->Release();
+    else
+        m_pendingEntryCount++;
+
+    entry.DataOffset = 0;
+    entry.DataSize = dataSize;
+    entry.pPendingData = pBlob;
+}
+
+bool ShaderCache::Flush()
+{
+    MutexLock lock(m_lock);
+    if (m_pendingEntryCount == 0)
+        return true;
+
+    // the file can't be written while we have it mapped, any outstanding views hold their own reference
+    if (m_pMappedFile != nullptr)
+    {
+        m_pMappedFile->Release();
+        m_pMappedFile = nullptr;
+    }
+
+    bool appending = (m_fileSize > 0);
+    uint32 openFlags = BYTESTREAM_OPEN_CREATE | BYTESTREAM_OPEN_CREATE_PATH | BYTESTREAM_OPEN_WRITE | ((appending) ? BYTESTREAM_OPEN_APPEND : BYTESTREAM_OPEN_TRUNCATE);
+    ByteStream *pStream = g_pVirtualFileSystem->OpenFile(m_cacheFileName, openFlags);
+    bool result = (pStream != nullptr);
+    if (result)
+    {
+        if (!appending)
+        {
+            DF_SHADER_CACHE_HEADER header;
+            header.Magic = DF_SHADER_CACHE_HEADER_MAGIC;
+            header.Version = DF_SHADER_CACHE_HEADER_VERSION;
+            result &= pStream->Write2(&header, sizeof(header));
+        }
+
+        static const byte padding[DF_SHADER_CACHE_ENTRY_ALIGNMENT] = { 0 };
+        for (uint32 i = 0; i < m_entries.GetSize() && result; i++)
+        {
+            const Entry &entry = m_entries[i];
+            if (entry.pPendingData == nullptr)
+                continue;
+
+            DF_SHADER_CACHE_ENTRY_HEADER entryHeader;
+            entryHeader.Magic = DF_SHADER_CACHE_ENTRY_MAGIC;
+            Y_memcpy(entryHeader.HashCode, entry.HashCode, sizeof(entryHeader.HashCode));
+            entryHeader.DataSize = entry.DataSize;
+
+            uint32 paddingSize = GetPaddedEntrySize(entry.DataSize) - entry.DataSize;
+            result &= pStream->Write2(&entryHeader, sizeof(entryHeader));
+            result &= pStream->Write2(entry.pPendingData->GetDataPointer(), entry.DataSize);
+            result &= (paddingSize == 0 || pStream->Write2(padding, paddingSize));
+        }
+
+        pStream->Release();
+    }
+
+    if (!result)
+        Log_WarningPrintf("ShaderCache::Flush: Failed to write to '%s'", m_cacheFileName.GetCharArray());
+    else
+        Log_DevPrintf("ShaderCache::Flush: Wrote %u programs to '%s'", m_pendingEntryCount, m_cacheFileName.GetCharArray());
+
+    // rebuild the index from the file, new entries that failed to write are kept in memory
+    MemArray<Entry> unwrittenEntries;
+    if (!result)
+    {
+        for (uint32 i = 0; i < m_entries.GetSize(); i++)
+        {
+            if (m_entries[i].pPendingData != nullptr)
+            {
+                m_entries[i].pPendingData->AddRef();
+                unwrittenEntries.Add(m_entries[i]);
+            }
+        }
+    }
+
+    ReleaseEntries();
+    LoadCacheFile();
+
+    for (uint32 i = 0; i < unwrittenEntries.GetSize(); i++)
+    {
+        const Entry &entry = unwrittenEntries[i];
+        int32 entryIndex = m_entryIndex.Find(entry.HashCode);
+        if (entryIndex < 0)
+        {
+            m_entryIndex.Insert(entry.HashCode, m_entries.GetSize());
+            m_entries.Add(entry);
+        }
+        else
+        {
+            m_entries[entryIndex] = entry;
+        }
+
+        m_pendingEntryCount++;
+    }
+
+    return result;
+}
+
+void ShaderCache::RecordPermutation(const uint8 hashCode[16], uint32 globalShaderFlags, const ShaderComponentTypeInfo *pBaseShaderTypeInfo, uint32 baseShaderFlags, const VertexFactoryTypeInfo *pVertexFactoryTypeInfo, uint32 vertexFactoryFlags, const MaterialShader *pMaterialShader, uint32 materialShaderFlags)
+{
+    MutexLock lock(m_recordLock);
+    if (!m_open || m_recordedHashCodes.Find(hashCode) >= 0)
+        return;
+
+    m_recordedHashCodes.Insert(hashCode, 0);
+
+    // permutations are rare enough to open the file for each one, so it is never held open
+    bool newFile = !m_permutationListValid;
+    uint32 openFlags = BYTESTREAM_OPEN_CREATE | BYTESTREAM_OPEN_CREATE_PATH | BYTESTREAM_OPEN_WRITE | ((newFile) ? BYTESTREAM_OPEN_TRUNCATE : BYTESTREAM_OPEN_APPEND);
+    ByteStream *pStream = g_pVirtualFileSystem->OpenFile(m_permutationListFileName, openFlags);
+    if (pStream == nullptr)
+    {
+        Log_WarningPrintf("ShaderCache::RecordPermutation: Failed to open '%s'", m_permutationListFileName.GetCharArray());
+        return;
+    }
+
+    BinaryWriter binaryWriter(pStream);
+    if (newFile)
+    {
+        DF_SHADER_PERMUTATION_LIST_HEADER header;
+        header.Magic = DF_SHADER_PERMUTATION_LIST_HEADER_MAGIC;
+        header.Version = DF_SHADER_PERMUTATION_LIST_HEADER_VERSION;
+        binaryWriter.WriteBytes(&header, sizeof(header));
+    }
+
+    DF_SHADER_PERMUTATION_LIST_ENTRY entry;
+    Y_memcpy(entry.HashCode, hashCode, sizeof(entry.HashCode));
+    entry.GlobalShaderFlags = globalShaderFlags;
+    entry.BaseShaderFlags = baseShaderFlags;
+    entry.VertexFactoryFlags = vertexFactoryFlags;
+    entry.MaterialShaderFlags = materialShaderFlags;
+    binaryWriter.WriteBytes(&entry, sizeof(entry));
+    binaryWriter.WriteCString((pBaseShaderTypeInfo != nullptr) ? pBaseShaderTypeInfo->GetTypeName() : "");
+    binaryWriter.WriteCString((pVertexFactoryTypeInfo != nullptr) ? pVertexFactoryTypeInfo->GetTypeName() : "");
+    binaryWriter.WriteCString((pMaterialShader != nullptr) ? pMaterialShader->GetName().GetCharArray() : "");
+    pStream->Release();
+    m_permutationListValid = true;
+}
+
+bool ShaderCache::ReadRecordedPermutations(Array<RecordedPermutation> *pPermutations)
+{
+    MutexLock lock(m_recordLock);
+    ByteStream *pStream = g_pVirtualFileSystem->OpenFile(m_permutationListFileName, BYTESTREAM_OPEN_READ | BYTESTREAM_OPEN_STREAMED);
+    if (pStream == nullptr)
+        return false;
+
+    BinaryReader binaryReader(pStream);
+    DF_SHADER_PERMUTATION_LIST_HEADER header;
+    if (!binaryReader.SafeReadBytes(&header, sizeof(header)) || header.Magic != DF_SHADER_PERMUTATION_LIST_HEADER_MAGIC || header.Version != DF_SHADER_PERMUTATION_LIST_HEADER_VERSION)
+    {
+        Log_WarningPrintf("ShaderCache::ReadRecordedPermutations: '%s' has a bad header", m_permutationListFileName.GetCharArray());
+        pStream->Release();
+        return false;
+    }
+
+    // a partially written entry at the end is ignored
+    DF_SHADER_PERMUTATION_LIST_ENTRY entry;
+    RecordedPermutation permutation;
+    while (binaryReader.SafeReadBytes(&entry, sizeof(entry)) &&
+           binaryReader.SafeReadCString(&permutation.BaseShaderTypeName) &&
+           binaryReader.SafeReadCString(&permutation.VertexFactoryTypeName) &&
+           binaryReader.SafeReadCString(&permutation.MaterialShaderName))
+    {
+        permutation.GlobalShaderFlags = entry.GlobalShaderFlags;
+        permutation.BaseShaderFlags = entry.BaseShaderFlags;
+        permutation.VertexFactoryFlags = entry.VertexFactoryFlags;
+        permutation.MaterialShaderFlags = entry.MaterialShaderFlags;
+        pPermutations->Add(permutation);
+    }
+
+    pStream->Release();
+    return true;
+}
+
+void ShaderCache::LoadRecordedHashCodes()
+{
+    MutexLock lock(m_recordLock);
+    m_recordedHashCodes.Clear();
+    m_permutationListValid = false;
+
+    ByteStream *pStream = g_pVirtualFileSystem->OpenFile(m_permutationListFileName, BYTESTREAM_OPEN_READ | BYTESTREAM_OPEN_STREAMED);
+    if (pStream == nullptr)
+        return;
+
+    BinaryReader binaryReader(pStream);
+    DF_SHADER_PERMUTATION_LIST_HEADER header;
+    if (binaryReader.SafeReadBytes(&header, sizeof(header)) && header.Magic == DF_SHADER_PERMUTATION_LIST_HEADER_MAGIC && header.Version == DF_SHADER_PERMUTATION_LIST_HEADER_VERSION)
+    {
+        // anything else is replaced by the next recorded permutation
+        m_permutationListValid = true;
+
+        DF_SHADER_PERMUTATION_LIST_ENTRY entry;
+        SmallString name;
+        while (binaryReader.SafeReadBytes(&entry, sizeof(entry)) &&
+               binaryReader.SafeReadCString(&name) && binaryReader.SafeReadCString(&name) && binaryReader.SafeReadCString(&name))
+        {
+            m_recordedHashCodes.Insert(entry.HashCode, 0);
+        }
+    }
+
+    pStream->Release();
+}
@@ -0,0 +1,109 @@
+#pragma once
+#include "Renderer/Common.h"
+
+class MappedFile;
+class BinaryBlob;
+class ShaderComponentTypeInfo;
+class VertexFactoryTypeInfo;
+class MaterialShader;
+
+// Single file cache of compiled shader programs for one platform/feature level/configuration, indexed by the program
+// hash code. The file is mapped when opened, programs added during the session are held in memory until Flush()
+// appends them to the end of the file. The cache can also record every permutation that is requested, so a later
+// run can compile and create them up front instead of when a draw first needs them.
+class ShaderCache
+{
+public:
+    // recorded permutation, components are stored by name so the list stays valid between runs
+    struct RecordedPermutation
+    {
+        uint32 GlobalShaderFlags;
+        String BaseShaderTypeName;
+        uint32 BaseShaderFlags;
+        String VertexFactoryTypeName;
+        uint32 VertexFactoryFlags;
+        String MaterialShaderName;
+        uint32 MaterialShaderFlags;
+    };
+
+public:
+    ShaderCache();
+    ~ShaderCache();
+
+    bool IsOpen() const { return m_open; }
+    uint32 GetEntryCount() const { return m_entries.GetSize(); }
+
+    // opens the cache files <baseFileName>.cache and <baseFileName>.permutations, missing files are created on write
+    bool Open(const char *baseFileName);
+
+    // writes any new entries, and releases the files
+    void Close();
+
+    // returns a view of the program data for a hash code, or nullptr if it is not cached.
+    // the view holds its own reference to the data, so remains valid after a flush. thread safe.
+    MappedFile *FindEntry(const uint8 hashCode[16]);
+
+    // adds program data, replacing any entry with the same hash code. thread safe.
+    void AddEntry(const uint8 hashCode[16], const void *pData, uint32 dataSize);
+
+    // appends entries added since the last flush to the file, and maps it again. thread safe.
+    bool Flush();
+
+    // appends a permutation to the recorded list, if it is not already there. thread safe.
+    void RecordPermutation(const uint8 hashCode[16], uint32 globalShaderFlags, const ShaderComponentTypeInfo *pBaseShaderTypeInfo, uint32 baseShaderFlags, const VertexFactoryTypeInfo *pVertexFactoryTypeInfo, uint32 vertexFactoryFlags, const MaterialShader *pMaterialShader, uint32 materialShaderFlags);
+
+    // reads the recorded permutation list
+    bool ReadRecordedPermutations(Array<RecordedPermutation> *pPermutations);
+
+private:
+    // maps 128-bit hash codes to values, chained on the first 32 bits of the code
+    class HashCodeIndex
+    {
+    public:
+        int32 Find(const uint8 hashCode[16]) const;
+        void Insert(const uint8 hashCode[16], uint32 value);
+        void Clear();
+
+    private:
+        struct Node
+        {
+            uint8 HashCode[16];
+            uint32 Value;
+            int32 Next;
+        };
+
+        MemArray<Node> m_nodes;
+        HashTable<uint32, uint32> m_heads;
+    };
+
+    struct Entry
+    {
+        uint8 HashCode[16];
+        uint32 DataOffset;
+        uint32 DataSize;
+        BinaryBlob *pPendingData;       // set until the entry is written to the file
+    };
+
+    // builds the entry index from the mapped file, discarding it if it's damaged
+    bool LoadCacheFile();
+    void ReleaseEntries();
+
+    // reads the hash codes of the recorded permutations
+    void LoadRecordedHashCodes();
+
+    String m_cacheFileName;
+    String m_permutationListFileName;
+    bool m_open;
+
+    Mutex m_lock;
+    MappedFile *m_pMappedFile;
+    uint64 m_fileSize;
+    uint32 m_pendingEntryCount;
+    MemArray<Entry> m_entries;
+    HashCodeIndex m_entryIndex;
+
+    Mutex m_recordLock;
+    HashCodeIndex m_recordedHashCodes;
+    bool m_permutationListValid;
+};
+
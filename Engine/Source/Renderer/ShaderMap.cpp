@@ -1,5 +1,6 @@
 #include "Renderer/PrecompiledHeader.h"
 #include "Renderer/ShaderMap.h"
+#include "Renderer/ShaderCache.h"
 #include "Renderer/ShaderProgram.h"
 #include "Renderer/Renderer.h"
 #include "Renderer/ShaderCompilerFrontend.h"
@@ -7,11 +8,35 @@
 #include "Engine/EngineCVars.h"
 #include "Engine/ResourceManager.h"
 #include "Engine/DataFormats.h"
+#include "Core/MappedFile.h"
+#include "YBaseLib/BinaryBlob.h"
 Log_SetChannel(ShaderMap);
 
-int32 ShaderMap::Key::Compare(const Key *a, const Key *b)
+// smallest slot table allocated once a permutation is loaded
+static const uint32 MIN_PROGRAM_SLOT_COUNT = 256;
+
+static inline uint64 MixPermutationHash(uint64 hash, uint64 value)
+{
+    hash ^= value + 0x9E3779B97F4A7C15ULL + (hash << 6) + (hash >> 2);
+    return hash;
+}
+
+uint64 ShaderMap::Key::ComputeHash() const
 {
-    return Y_memcmp(a, b, sizeof(Key));
+    uint64 hash = 0;
+    hash = MixPermutationHash(hash, (uint64)(size_t)pBaseShaderTypeInfo);
+    hash = MixPermutationHash(hash, (uint64)(size_t)pVertexFactoryTypeInfo);
+    hash = MixPermutationHash(hash, (uint64)(size_t)pMaterialShader);
+    hash = MixPermutationHash(hash, ((uint64)GlobalShaderFlags << 32) | (uint64)BaseShaderFlags);
+    hash = MixPermutationHash(hash, ((uint64)VertexFactoryFlags << 32) | (uint64)MaterialShaderFlags);
+
+    // finalize, so the low bits used to pick a slot depend on every field
+    hash ^= hash >> 33;
+    hash *= 0xFF51AFD7ED558CCDULL;
+    hash ^= hash >> 33;
+    hash *= 0xC4CEB9FE1A85EC53ULL;
+    hash ^= hash >> 33;
+    return hash;
 }
 
 ShaderMap::ShaderMap()
@@ -26,11 +51,11 @@ ShaderMap::~ShaderMap()
 
 ShaderProgram *ShaderMap::GetShaderPermutation(uint32 globalShaderFlags, const ShaderComponentTypeInfo *pBaseShaderTypeInfo, uint32 baseShaderFlags, const GPU_VERTEX_ELEMENT_DESC *pVertexAttributes, uint32 nVertexAttributes, const MaterialShader *pMaterialShader, uint32 materialShaderFlags) const
 {
-    // binary search the list
+    // look up in the loaded list
     Key key(globalShaderFlags, pBaseShaderTypeInfo, baseShaderFlags, nullptr, 0, pMaterialShader, materialShaderFlags);
-    const ProgramEntry *pProgramEntry = m_arrLoadedShaders.BinarySearchKey<Key>(key, [](const Key *key, const ProgramEntry *pe) { return Key::Compare(key, &pe->Key); });
-    if (pProgramEntry != nullptr)
-        return pProgramEntry->Value;
+    ShaderProgram *pProgram;
+    if (FindLoadedPermutation(key, &pProgram))
+        return pProgram;
     
     // load it
     return LoadShaderPermutation(globalShaderFlags, pBaseShaderTypeInfo, baseShaderFlags, nullptr, 0, pMaterialShader, materialShaderFlags, pVertexAttributes, nVertexAttributes);
@@ -38,11 +63,11 @@ ShaderProgram *ShaderMap::GetShaderPermutation(uint32 globalShaderFlags, const S
 
 ShaderProgram *ShaderMap::GetShaderPermutation(uint32 globalShaderFlags, const ShaderComponentTypeInfo *pBaseShaderTypeInfo, uint32 baseShaderFlags, const VertexFactoryTypeInfo *pVertexFactoryTypeInfo, uint32 vertexFactoryFlags, const MaterialShader *pMaterialShader, uint32 materialShaderFlags) const
 {
-    // binary search the list
+    // look up in the loaded list
     Key key(globalShaderFlags, pBaseShaderTypeInfo, baseShaderFlags, pVertexFactoryTypeInfo, vertexFactoryFlags, pMaterialShader, materialShaderFlags);
-    const ProgramEntry *pProgramEntry = m_arrLoadedShaders.BinarySearchKey<Key>(key, [](const Key *key, const ProgramEntry *pe) { return Key::Compare(key, &pe->Key); });
-    if (pProgramEntry != nullptr)
-        return pProgramEntry->Value;
+    ShaderProgram *pProgram;
+    if (FindLoadedPermutation(key, &pProgram))
+        return pProgram;
     
     // load it
     GPU_VERTEX_ELEMENT_DESC vertexAttributes[GPU_INPUT_LAYOUT_MAX_ELEMENTS];
@@ -52,49 +77,100 @@ ShaderProgram *ShaderMap::GetShaderPermutation(uint32 globalShaderFlags, const S
 
 void ShaderMap::ReleaseGPUResources()
 {
-    for (uint32 i = 0; i < m_arrLoadedShaders.GetSize(); i++)
-        delete m_arrLoadedShaders[i].Value;
+    for (uint32 i = 0; i < m_loadedPrograms.GetSize(); i++)
+        delete m_loadedPrograms[i].Value;
 
-    m_arrLoadedShaders.Obliterate();
+    m_loadedPrograms.Obliterate();
+    m_programSlots.Obliterate();
 }
 
-ShaderProgram *ShaderMap::LoadShaderPermutation(uint32 globalShaderFlags, const ShaderComponentTypeInfo *pBaseShaderTypeInfo, uint32 baseShaderFlags, const VertexFactoryTypeInfo *pVertexFactoryTypeInfo, uint32 vertexFactoryFlags, const MaterialShader *pMaterialShader, uint32 materialShaderFlags, const GPU_VERTEX_ELEMENT_DESC *pVertexAttributes, uint32 nVertexAttributes) const
+bool ShaderMap::FindLoadedPermutation(const Key &key, ShaderProgram **ppProgram) const
 {
-    // stuff to load
-    RENDERER_PLATFORM rendererPlatform = g_pRenderer->GetPlatform();
-    RENDERER_FEATURE_LEVEL rendererFeatureLevel = g_pRenderer->GetFeatureLevel();
+    if (m_programSlots.IsEmpty())
+        return false;
 
-    // resultant gpu program
-    GPUShaderProgram *pGPUProgram = nullptr;
+    // linear probe until the key or an empty slot is found, the table always has empty slots
+    uint32 slotMask = m_programSlots.GetSize() - 1;
+    for (uint32 slot = (uint32)key.Hash & slotMask; ; slot = (slot + 1) & slotMask)
+    {
+        int32 index = m_programSlots[slot];
+        if (index < 0)
+            return false;
+
+        const ProgramEntry &entry = m_loadedPrograms[index];
+        if (entry.Key == key)
+        {
+            *ppProgram = entry.Value;
+            return true;
+        }
+    }
+}
+
+void ShaderMap::AddLoadedPermutation(const Key &key, ShaderProgram *pProgram) const
+{
+#ifdef Y_BUILD_CONFIG_DEBUG
+    ShaderProgram *pExistingProgram;
+    DebugAssert(!FindLoadedPermutation(key, &pExistingProgram));
+#endif
+
+    // grow before going over half full
+    uint32 index = m_loadedPrograms.GetSize();
+    if ((index + 1) * 2 > m_programSlots.GetSize())
+        ResizeSlotTable(Max(m_programSlots.GetSize() * 2, MIN_PROGRAM_SLOT_COUNT));
+
+    m_loadedPrograms.Add(ProgramEntry(key, pProgram));
+
+    uint32 slotMask = m_programSlots.GetSize() - 1;
+    uint32 slot = (uint32)key.Hash & slotMask;
+    while (m_programSlots[slot] >= 0)
+        slot = (slot + 1) & slotMask;
+
+    m_programSlots[slot] = (int32)index;
+}
+
+void ShaderMap::ResizeSlotTable(uint32 slotCount) const
+{
+    DebugAssert(Y_ispow2(slotCount));
+    m_programSlots.Resize(slotCount);
+    for (uint32 i = 0; i < slotCount; i++)
+        m_programSlots[i] = -1;
+
+    // re-insert everything, the hashes are stored in the keys
+    uint32 slotMask = slotCount - 1;
+    for (uint32 i = 0; i < m_loadedPrograms.GetSize(); i++)
+    {
+        uint32 slot = (uint32)m_loadedPrograms[i].Key.Hash & slotMask;
+        while (m_programSlots[slot] >= 0)
+            slot = (slot + 1) & slotMask;
+
+        m_programSlots[slot] = (int32)i;
+    }
+}
+
+MappedFile *ShaderMap::LoadProgramData(uint32 globalShaderFlags, const ShaderComponentTypeInfo *pBaseShaderTypeInfo, uint32 baseShaderFlags, const VertexFactoryTypeInfo *pVertexFactoryTypeInfo, uint32 vertexFactoryFlags, const MaterialShader *pMaterialShader, uint32 materialShaderFlags)
+{
+    ShaderCache *pShaderCache = g_pRenderer->GetShaderCache();
 
     // get hash code for shader
     uint8 shaderHashCode[16];
     SmallString hashCodeStr;
-    PathString diskCacheFileName;
     ShaderCompilerFrontend::GenerateShaderHashCode(shaderHashCode, globalShaderFlags, pBaseShaderTypeInfo, baseShaderFlags, pVertexFactoryTypeInfo, vertexFactoryFlags, pMaterialShader, materialShaderFlags);
     StringConverter::BytesToHexString(hashCodeStr, shaderHashCode, sizeof(shaderHashCode));
-    
+
     // can we use the disk cache?
-    if (CVars::r_use_shader_cache.GetBool())
+    if (pShaderCache->IsOpen())
     {
-        // construct filename
-        diskCacheFileName.Format("shadercache/%s_%s_%s/%s.bin", NameTable_GetNameString(NameTables::RendererPlatform, rendererPlatform),
-                                                                NameTable_GetNameString(NameTables::RendererFeatureLevel, rendererFeatureLevel),
-                                                                (CVars::r_use_debug_shaders.GetBool()) ? "DEBUG" : "RELEASE",
-                                                                hashCodeStr.GetCharArray());
-
-        // try opening it
-        ByteStream *pStream = g_pVirtualFileSystem->OpenFile(diskCacheFileName, BYTESTREAM_OPEN_READ);
-        if (pStream != nullptr)
+        MappedFile *pProgramData = pShaderCache->FindEntry(shaderHashCode);
+        if (pProgramData != nullptr)
         {
-            Log_DevPrintf("ShaderMap::LoadShaderPermutation: Shader program '%s' found in cache, attempting to use it.", hashCodeStr.GetCharArray());
+            Log_DevPrintf("ShaderMap::LoadProgramData: Shader program '%s' found in cache, attempting to use it.", hashCodeStr.GetCharArray());
 
-            // read common header
-            DF_SHADER_PROGRAM_COMMON_HEADER commonHeader;
-            if (!pStream->Read2(&commonHeader, sizeof(commonHeader)) || commonHeader.Magic != DF_SHADER_PROGRAM_COMMON_HEADER_MAGIC)
+            // check common header
+            const DF_SHADER_PROGRAM_COMMON_HEADER *pCommonHeader = reinterpret_cast<const DF_SHADER_PROGRAM_COMMON_HEADER *>(pProgramData->GetData());
+            if (pProgramData->GetSize() < sizeof(DF_SHADER_PROGRAM_COMMON_HEADER) || pCommonHeader->Magic != DF_SHADER_PROGRAM_COMMON_HEADER_MAGIC)
             {
-                Log_WarningPrintf("ShaderMap::LoadShaderPermutation: Bad common magic for shader program '%s'", hashCodeStr.GetCharArray());
-                pStream->Release();
+                Log_WarningPrintf("ShaderMap::LoadProgramData: Bad common magic for shader program '%s'", hashCodeStr.GetCharArray());
+                pProgramData->Release();
             }
             else
             {
@@ -103,114 +179,129 @@ ShaderProgram *ShaderMap::LoadShaderPermutation(uint32 globalShaderFlags, const
                 uint32 baseShaderParameterCRC = (pBaseShaderTypeInfo != nullptr) ? pBaseShaderTypeInfo->GetParameterCRC() : 0;
                 uint32 vertexFactoryParameterCRC = (pVertexFactoryTypeInfo != nullptr) ? pVertexFactoryTypeInfo->GetParameterCRC() : 0;
                 uint32 materialShaderCRC = (pMaterialShader != nullptr) ? pMaterialShader->GetSourceCRC() : 0;
-                if (commonHeader.ShaderStoreCRC != ShaderCompilerFrontend::GetShaderStoreHash() ||
-                    commonHeader.BaseShaderParameterCRC != baseShaderParameterCRC ||
-                    commonHeader.VertexFactoryParameterCRC != vertexFactoryParameterCRC ||
-                    commonHeader.MaterialShaderCRC != materialShaderCRC)
+                if (pCommonHeader->ShaderStoreCRC != ShaderCompilerFrontend::GetShaderStoreHash() ||
+                    pCommonHeader->BaseShaderParameterCRC != baseShaderParameterCRC ||
+                    pCommonHeader->VertexFactoryParameterCRC != vertexFactoryParameterCRC ||
+                    pCommonHeader->MaterialShaderCRC != materialShaderCRC)
                 {
-                    Log_WarningPrintf("ShaderMap::LoadShaderPermutation: Shader program '%s' is out of date. Disregarding cache version.", hashCodeStr.GetCharArray());
-                    pStream->Release();
+                    Log_WarningPrintf("ShaderMap::LoadProgramData: Shader program '%s' is out of date. Disregarding cache version.", hashCodeStr.GetCharArray());
+                    pProgramData->Release();
                 }
                 else
                 {
-                    // create shader
-                    pGPUProgram = g_pRenderer->CreateGraphicsProgram(pVertexAttributes, nVertexAttributes, pStream);
-                    pStream->Release();
+                    return pProgramData;
                 }
 #else
-                // create shader, since we have no compiler support
-                pGPUProgram = g_pRenderer->CreateGraphicsProgram(pVertexAttributes, nVertexAttributes, pStream);
-                pStream->Release();
+                // use it, since we have no compiler support
+                return pProgramData;
 #endif
             }
         }
         else
         {
             // log a warning
-            Log_WarningPrintf("ShaderMap::LoadShaderPermutation: Shader program '%s' not found in cache, attempting compilation.", hashCodeStr.GetCharArray());
+            Log_WarningPrintf("ShaderMap::LoadProgramData: Shader program '%s' not found in cache, attempting compilation.", hashCodeStr.GetCharArray());
         }
     }
 
 #if defined(WITH_CONTENTCONVERTER_EMBEDDED) || defined(WITH_RESOURCECOMPILER_SUBPROCESS)
-    // is a compile necessary?
-    if (pGPUProgram == nullptr)
+    Log_InfoPrintf("ShaderMap::LoadProgramData: Compiling program (%s, %s, %s, %X, %s, %X, %s, %X) -> %s...", 
+                   NameTable_GetNameString(NameTables::RendererPlatform, g_pRenderer->GetPlatform()),
+                   NameTable_GetNameString(NameTables::RendererFeatureLevel, g_pRenderer->GetFeatureLevel()),
+                   (pBaseShaderTypeInfo != nullptr) ? pBaseShaderTypeInfo->GetTypeName() : "NULL",
+                   baseShaderFlags,
+                   (pVertexFactoryTypeInfo != nullptr) ? pVertexFactoryTypeInfo->GetTypeName() : "NULL",
+                   vertexFactoryFlags,
+                   (pMaterialShader != nullptr) ? pMaterialShader->GetName().GetCharArray() : "NULL",
+                   materialShaderFlags,
+                   hashCodeStr.GetCharArray());
+
+    // create streams
+    AutoReleasePtr<GrowableMemoryByteStream> pByteCodeStream = ByteStream_CreateGrowableMemoryStream();
+    AutoReleasePtr<ByteStream> pInfoLogStream = nullptr;
+
+    // setup dump stream
+    if (CVars::r_dump_shaders.GetBool())
     {
-        Log_InfoPrintf("ShaderMap::LoadShaderPermutation: Compiling program (%s, %s, %s, %X, %s, %X, %s, %X) -> %s...", 
-                       NameTable_GetNameString(NameTables::RendererPlatform, rendererPlatform),
-                       NameTable_GetNameString(NameTables::RendererFeatureLevel, rendererFeatureLevel),
-                       (pBaseShaderTypeInfo != nullptr) ? pBaseShaderTypeInfo->GetTypeName() : "NULL",
-                       baseShaderFlags,
-                       (pVertexFactoryTypeInfo != nullptr) ? pVertexFactoryTypeInfo->GetTypeName() : "NULL",
-                       vertexFactoryFlags,
-                       (pMaterialShader != nullptr) ? pMaterialShader->GetName().GetCharArray() : "NULL",
-                       materialShaderFlags,
-                       hashCodeStr.GetCharArray());
-
-        // create streams
-        AutoReleasePtr<GrowableMemoryByteStream> pByteCodeStream = ByteStream_CreateGrowableMemoryStream();
-        AutoReleasePtr<ByteStream> pInfoLogStream = nullptr;
-
-        // setup dump stream
-        if (CVars::r_dump_shaders.GetBool())
-        {
-            PathString dumpFileName;
-            StringConverter::BytesToHexString(hashCodeStr, shaderHashCode, sizeof(shaderHashCode));
-            dumpFileName.Format("shaderdump/%s_%s_%s/%s.txt", NameTable_GetNameString(NameTables::RendererPlatform, g_pRenderer->GetPlatform()), 
-                                                              NameTable_GetNameString(NameTables::RendererFeatureLevel, g_pRenderer->GetFeatureLevel()),
-                                                              (CVars::r_use_debug_shaders.GetBool()) ? "DEBUG" : "RELEASE",
-                                                              hashCodeStr.GetCharArray());
-            
-            pInfoLogStream = g_pVirtualFileSystem->OpenFile(dumpFileName, BYTESTREAM_OPEN_CREATE | BYTESTREAM_OPEN_CREATE_PATH | BYTESTREAM_OPEN_WRITE | BYTESTREAM_OPEN_TRUNCATE);
-        }
+        PathString dumpFileName;
+        dumpFileName.Format("shaderdump/%s_%s_%s/%s.txt", NameTable_GetNameString(NameTables::RendererPlatform, g_pRenderer->GetPlatform()), 
+                                                          NameTable_GetNameString(NameTables::RendererFeatureLevel, g_pRenderer->GetFeatureLevel()),
+                                                          (CVars::r_use_debug_shaders.GetBool()) ? "DEBUG" : "RELEASE",
+                                                          hashCodeStr.GetCharArray());
+        
+        pInfoLogStream = g_pVirtualFileSystem->OpenFile(dumpFileName, BYTESTREAM_OPEN_CREATE | BYTESTREAM_OPEN_CREATE_PATH | BYTESTREAM_OPEN_WRITE | BYTESTREAM_OPEN_TRUNCATE);
+    }
 
-        // get resource compiler interface
-        ResourceCompilerInterface *pCompilerInterface = g_pResourceManager->GetResourceCompilerInterface();
-        if (pCompilerInterface != nullptr)
-        {
-            // forward through to compiler
-            if (ShaderCompilerFrontend::CompileShader(pCompilerInterface, globalShaderFlags, g_pRenderer->GetPlatform(), g_pRenderer->GetFeatureLevel(),
-                                                      pBaseShaderTypeInfo, baseShaderFlags, pVertexFactoryTypeInfo, vertexFactoryFlags, pMaterialShader, materialShaderFlags,
-                                                      CVars::r_use_debug_shaders.GetBool(), pByteCodeStream, pInfoLogStream))
-            { 
-                // write to disk cache
-                if (CVars::r_use_shader_cache.GetBool() && CVars::r_allow_shader_cache_writes.GetBool())
-                {
-                    ByteStream *pStream = g_pVirtualFileSystem->OpenFile(diskCacheFileName, BYTESTREAM_OPEN_CREATE | BYTESTREAM_OPEN_CREATE_PATH | BYTESTREAM_OPEN_WRITE | BYTESTREAM_OPEN_TRUNCATE | BYTESTREAM_OPEN_ATOMIC_UPDATE);
-                    if (pStream != nullptr)
-                    {
-                        // generate the common header
-                        DF_SHADER_PROGRAM_COMMON_HEADER commonHeader;
-                        commonHeader.Magic = DF_SHADER_PROGRAM_COMMON_HEADER_MAGIC;
-                        commonHeader.ShaderStoreCRC = ShaderCompilerFrontend::GetShaderStoreHash();
-                        commonHeader.BaseShaderParameterCRC = (pBaseShaderTypeInfo != nullptr) ? pBaseShaderTypeInfo->GetParameterCRC() : 0;
-                        commonHeader.VertexFactoryParameterCRC = (pVertexFactoryTypeInfo != nullptr) ? pVertexFactoryTypeInfo->GetParameterCRC() : 0;
-                        commonHeader.MaterialShaderCRC = (pMaterialShader != nullptr) ? pMaterialShader->GetSourceCRC() : 0;
-
-                        // write common header and bytecode
-                        pByteCodeStream->SeekAbsolute(0);
-                        if (pStream->Write2(&commonHeader, sizeof(commonHeader)) && ByteStream_AppendStream(pByteCodeStream, pStream))
-                            pStream->Commit();
-                        else
-                            pStream->Discard();
-
-                        pStream->Release();
-                    }
-                }
+    // get resource compiler interface
+    ResourceCompilerInterface *pCompilerInterface = g_pResourceManager->GetResourceCompilerInterface();
+    if (pCompilerInterface == nullptr)
+        return nullptr;
 
-                // create gpu object
-                pByteCodeStream->SeekAbsolute(0);
-                pGPUProgram = g_pRenderer->CreateGraphicsProgram(pVertexAttributes, nVertexAttributes, pByteCodeStream);
-            }
-            else
-            {
-                Log_ErrorPrintf("ShaderMap::LoadShaderPermutation: Compiling program %s failed.", hashCodeStr.GetCharArray());
-            }
+    // forward through to compiler
+    MappedFile *pProgramData = nullptr;
+    if (ShaderCompilerFrontend::CompileShader(pCompilerInterface, globalShaderFlags, g_pRenderer->GetPlatform(), g_pRenderer->GetFeatureLevel(),
+                                              pBaseShaderTypeInfo, baseShaderFlags, pVertexFactoryTypeInfo, vertexFactoryFlags, pMaterialShader, materialShaderFlags,
+                                              CVars::r_use_debug_shaders.GetBool(), pByteCodeStream, pInfoLogStream))
+    { 
+        // generate the common header
+        DF_SHADER_PROGRAM_COMMON_HEADER commonHeader;
+        commonHeader.Magic = DF_SHADER_PROGRAM_COMMON_HEADER_MAGIC;
+        commonHeader.ShaderStoreCRC = ShaderCompilerFrontend::GetShaderStoreHash();
+        commonHeader.BaseShaderParameterCRC = (pBaseShaderTypeInfo != nullptr) ? pBaseShaderTypeInfo->GetParameterCRC() : 0;
+        commonHeader.VertexFactoryParameterCRC = (pVertexFactoryTypeInfo != nullptr) ? pVertexFactoryTypeInfo->GetParameterCRC() : 0;
+        commonHeader.MaterialShaderCRC = (pMaterialShader != nullptr) ? pMaterialShader->GetSourceCRC() : 0;
+
+        // combine common header and bytecode
+        uint32 byteCodeSize = (uint32)pByteCodeStream->GetSize();
+        BinaryBlob *pBlob = BinaryBlob::Allocate(sizeof(commonHeader) + byteCodeSize);
+        Y_memcpy(pBlob->GetDataPointer(), &commonHeader, sizeof(commonHeader));
+        pByteCodeStream->SeekAbsolute(0);
+        if (pByteCodeStream->Read2(reinterpret_cast<byte *>(pBlob->GetDataPointer()) + sizeof(commonHeader), byteCodeSize))
+        {
+            // write to disk cache
+            if (pShaderCache->IsOpen() && CVars::r_allow_shader_cache_writes.GetBool())
+                pShaderCache->AddEntry(shaderHashCode, pBlob->GetDataPointer(), pBlob->GetDataSize());
 
-            // release compiler interface
-            g_pResourceManager->ReleaseResourceCompilerInterface(pCompilerInterface);
+            pProgramData = MappedFile::CreateView(pBlob, reinterpret_cast<const byte *>(pBlob->GetDataPointer()), pBlob->GetDataSize());
         }
+
+        pBlob->Release();
+    }
+    else
+    {
+        Log_ErrorPrintf("ShaderMap::LoadProgramData: Compiling program %s failed.", hashCodeStr.GetCharArray());
     }
+
+    // release compiler interface
+    g_pResourceManager->ReleaseResourceCompilerInterface(pCompilerInterface);
+    return pProgramData;
+#else
+    return nullptr;
 #endif
+}
+
+ShaderProgram *ShaderMap::LoadShaderPermutation(uint32 globalShaderFlags, const ShaderComponentTypeInfo *pBaseShaderTypeInfo, uint32 baseShaderFlags, const VertexFactoryTypeInfo *pVertexFactoryTypeInfo, uint32 vertexFactoryFlags, const MaterialShader *pMaterialShader, uint32 materialShaderFlags, const GPU_VERTEX_ELEMENT_DESC *pVertexAttributes, uint32 nVertexAttributes) const
+{
+    // record the permutation for warm-up, programs with an explicit vertex layout can't be recreated from the list
+    ShaderCache *pShaderCache = g_pRenderer->GetShaderCache();
+    if (CVars::r_record_shader_permutations.GetBool() && pShaderCache->IsOpen() && (pVertexFactoryTypeInfo != nullptr || nVertexAttributes == 0))
+    {
+        uint8 shaderHashCode[16];
+        ShaderCompilerFrontend::GenerateShaderHashCode(shaderHashCode, globalShaderFlags, pBaseShaderTypeInfo, baseShaderFlags, pVertexFactoryTypeInfo, vertexFactoryFlags, pMaterialShader, materialShaderFlags);
+        pShaderCache->RecordPermutation(shaderHashCode, globalShaderFlags, pBaseShaderTypeInfo, baseShaderFlags, pVertexFactoryTypeInfo, vertexFactoryFlags, pMaterialShader, materialShaderFlags);
+    }
+
+    // resultant gpu program
+    GPUShaderProgram *pGPUProgram = nullptr;
+    MappedFile *pProgramData = LoadProgramData(globalShaderFlags, pBaseShaderTypeInfo, baseShaderFlags, pVertexFactoryTypeInfo, vertexFactoryFlags, pMaterialShader, materialShaderFlags);
+    if (pProgramData != nullptr)
+    {
+        // bytecode follows the common header
+        ByteStream *pStream = ByteStream_CreateReadOnlyMemoryStream(pProgramData->GetData() + sizeof(DF_SHADER_PROGRAM_COMMON_HEADER), (uint32)pProgramData->GetSize() - sizeof(DF_SHADER_PROGRAM_COMMON_HEADER));
+        pGPUProgram = g_pRenderer->CreateGraphicsProgram(pVertexAttributes, nVertexAttributes, pStream);
+        pStream->Release();
+        pProgramData->Release();
+    }
 
     // set debug name
 #ifdef Y_BUILD_CONFIG_DEBUG
@@ -226,9 +317,8 @@ ShaderProgram *ShaderMap::LoadShaderPermutation(uint32 globalShaderFlags, const
     // got a gpu program?
     ShaderProgram *pProgram = (pGPUProgram != nullptr) ? new ShaderProgram(pGPUProgram, globalShaderFlags, pBaseShaderTypeInfo, baseShaderFlags, pVertexFactoryTypeInfo, vertexFactoryFlags, pMaterialShader, materialShaderFlags) : nullptr;
     
-    // add to list, and re-sort it
-    m_arrLoadedShaders.Add(ProgramEntry(Key(globalShaderFlags, pBaseShaderTypeInfo, baseShaderFlags, pVertexFactoryTypeInfo, vertexFactoryFlags, pMaterialShader, materialShaderFlags), pProgram));
-    m_arrLoadedShaders.SortCB([](const ProgramEntry &a, const ProgramEntry &b) { return Key::Compare(&a.Key, &b.Key); });
+    // add to list, failures are stored too so they aren't retried every draw
+    AddLoadedPermutation(Key(globalShaderFlags, pBaseShaderTypeInfo, baseShaderFlags, pVertexFactoryTypeInfo, vertexFactoryFlags, pMaterialShader, materialShaderFlags), pProgram);
     return pProgram;
 }
 
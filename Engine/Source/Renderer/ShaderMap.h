@@ -6,14 +6,17 @@ class ShaderComponentTypeInfo;
 class VertexFactoryTypeInfo;
 class MaterialShader;
 class ShaderProgram;
+class MappedFile;
 
 class ShaderMap
 {
+public:
+    // permutation key. the hash is computed once on construction, so lookups only compare the fields on a hash match.
     struct Key
     {
         Key() {}
         Key(uint32 globalShaderFlags, const ShaderComponentTypeInfo *pBaseShaderTypeInfo, uint32 baseShaderFlags, const VertexFactoryTypeInfo *pVertexFactoryTypeInfo, uint32 vertexFactoryFlags, const MaterialShader *pMaterialShader, uint32 materialShaderFlags)
-            : pBaseShaderTypeInfo(pBaseShaderTypeInfo), pVertexFactoryTypeInfo(pVertexFactoryTypeInfo), pMaterialShader(pMaterialShader), GlobalShaderFlags(globalShaderFlags), BaseShaderFlags(baseShaderFlags), VertexFactoryFlags(vertexFactoryFlags), MaterialShaderFlags(materialShaderFlags) {}
+            : pBaseShaderTypeInfo(pBaseShaderTypeInfo), pVertexFactoryTypeInfo(pVertexFactoryTypeInfo), pMaterialShader(pMaterialShader), GlobalShaderFlags(globalShaderFlags), BaseShaderFlags(baseShaderFlags), VertexFactoryFlags(vertexFactoryFlags), MaterialShaderFlags(materialShaderFlags), Hash(ComputeHash()) {}
 
         const ShaderComponentTypeInfo *pBaseShaderTypeInfo;
         const VertexFactoryTypeInfo *pVertexFactoryTypeInfo;
@@ -22,10 +25,16 @@ class ShaderMap
         uint32 BaseShaderFlags; 
         uint32 VertexFactoryFlags;
         uint32 MaterialShaderFlags;
+        uint64 Hash;
 
-        static int32 Compare(const Key *a, const Key *b);
+        uint64 ComputeHash() const;
 
-        bool operator<(const Key &other) const { return (Compare(this, &other) < 0); }
+        bool operator==(const Key &other) const
+        {
+            return (Hash == other.Hash && 
+                    pBaseShaderTypeInfo == other.pBaseShaderTypeInfo && pVertexFactoryTypeInfo == other.pVertexFactoryTypeInfo && pMaterialShader == other.pMaterialShader &&
+                    GlobalShaderFlags == other.GlobalShaderFlags && BaseShaderFlags == other.BaseShaderFlags && VertexFactoryFlags == other.VertexFactoryFlags && MaterialShaderFlags == other.MaterialShaderFlags);
+        }
     };
 
 public:
@@ -36,11 +45,29 @@ public:
     ShaderProgram *GetShaderPermutation(uint32 globalShaderFlags, const ShaderComponentTypeInfo *pBaseShaderTypeInfo, uint32 baseShaderFlags, const VertexFactoryTypeInfo *pVertexFactoryTypeInfo, uint32 vertexFactoryFlags, const MaterialShader *pMaterialShader, uint32 materialShaderFlags) const;
     void ReleaseGPUResources();
 
+    // finds the compiled program in the shader cache, compiling and caching it on a miss. the data starts with a
+    // DF_SHADER_PROGRAM_COMMON_HEADER. does not touch the gpu, so can be called from any thread.
+    static MappedFile *LoadProgramData(uint32 globalShaderFlags, const ShaderComponentTypeInfo *pBaseShaderTypeInfo, uint32 baseShaderFlags, const VertexFactoryTypeInfo *pVertexFactoryTypeInfo, uint32 vertexFactoryFlags, const MaterialShader *pMaterialShader, uint32 materialShaderFlags);
+
 private:
+    // the lookup benchmark fills a map without loading any programs
+    friend struct ShaderMapTestAccess;
+
+    // looks up a loaded permutation, returning false if it has not been loaded yet. failed loads are stored as nullptr.
+    bool FindLoadedPermutation(const Key &key, ShaderProgram **ppProgram) const;
+
+    // adds a loaded permutation, the map takes ownership of the program
+    void AddLoadedPermutation(const Key &key, ShaderProgram *pProgram) const;
+
     ShaderProgram *LoadShaderPermutation(uint32 globalShaderFlags, const ShaderComponentTypeInfo *pBaseShaderTypeInfo, uint32 baseShaderFlags, const VertexFactoryTypeInfo *pVertexFactoryTypeInfo, uint32 vertexFactoryFlags, const MaterialShader *pMaterialShader, uint32 materialShaderFlags, const GPU_VERTEX_ELEMENT_DESC *pVertexAttributes, uint32 nVertexAttributes) const;
 
+    // rebuilds the slot table with the given number of slots
+    void ResizeSlotTable(uint32 slotCount) const;
+
+    // programs are stored in load order, and found through an open addressing table of indices into the array.
+    // the table is a power of two in size and kept at most half full, so probe sequences stay short.
     typedef KeyValuePair<Key, ShaderProgram *> ProgramEntry;
-    typedef MemArray<ProgramEntry> LoadedShaderArray;
-    mutable LoadedShaderArray m_arrLoadedShaders;
+    mutable MemArray<ProgramEntry> m_loadedPrograms;
+    mutable MemArray<int32> m_programSlots;
 };
 
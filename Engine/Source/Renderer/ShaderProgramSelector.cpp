@@ -18,7 +18,9 @@ ShaderProgramSelector::ShaderProgramSelector(uint32 baseGlobalFlags)
       m_baseShaderFlags(0),
       m_vertexFactoryFlags(0),
       m_materialStaticSwitchMask(0),
-      m_dirtyFlags(DirtyGlobalFlags | DirtyBaseShader | DirtyVertexFactory | DirtyMaterialShader | DirtyMaterial)
+      m_dirtyFlags(DirtyGlobalFlags | DirtyBaseShader | DirtyVertexFactory | DirtyMaterialShader | DirtyMaterial),
+      m_programCacheCount(0),
+      m_programCacheNext(0)
 {
 
 }
@@ -29,7 +31,7 @@ void ShaderProgramSelector::SetGlobalFlags(uint32 globalFlags)
     if (newGlobalFlags != m_globalShaderFlags)
     {
         m_globalShaderFlags = newGlobalFlags;
-        m_dirtyFlags = DirtyGlobalFlags;
+        m_dirtyFlags |= DirtyGlobalFlags;
     }
 }
 
@@ -106,7 +108,30 @@ ShaderProgram *ShaderProgramSelector::MakeActive(GPUCommandList *pCommandList)
 
     if (dirtyFlags & (DirtyGlobalFlags | DirtyBaseShader | DirtyVertexFactory | DirtyMaterialShader))
     {
-        m_pCurrentProgram = g_pRenderer->GetShaderProgram(m_globalShaderFlags, m_pBaseShaderType, m_baseShaderFlags, m_pVertexFactoryType, m_vertexFactoryFlags, m_pMaterialShader, m_materialStaticSwitchMask);
+        ShaderMap::Key key(m_globalShaderFlags, m_pBaseShaderType, m_baseShaderFlags, m_pVertexFactoryType, m_vertexFactoryFlags, m_pMaterialShader, m_materialStaticSwitchMask);
+        uint32 cacheIndex;
+        for (cacheIndex = 0; cacheIndex < m_programCacheCount; cacheIndex++)
+        {
+            if (m_programCache[cacheIndex].Key == key)
+                break;
+        }
+
+        if (cacheIndex < m_programCacheCount)
+        {
+            m_pCurrentProgram = m_programCache[cacheIndex].pProgram;
+        }
+        else
+        {
+            m_pCurrentProgram = g_pRenderer->GetShaderProgram(m_globalShaderFlags, m_pBaseShaderType, m_baseShaderFlags, m_pVertexFactoryType, m_vertexFactoryFlags, m_pMaterialShader, m_materialStaticSwitchMask);
+
+            // replace the oldest entry
+            m_programCache[m_programCacheNext].Key = key;
+            m_programCache[m_programCacheNext].pProgram = m_pCurrentProgram;
+            m_programCacheNext = (m_programCacheNext + 1) % PROGRAM_CACHE_SIZE;
+            if (m_programCacheCount < PROGRAM_CACHE_SIZE)
+                m_programCacheCount++;
+        }
+
         if (m_pCurrentProgram == nullptr)
             return nullptr;
 
@@ -1,5 +1,6 @@
 #pragma once
 #include "Renderer/RendererTypes.h"
+#include "Renderer/ShaderMap.h"
 
 class ShaderProgram;
 class GPUContext;
@@ -39,6 +40,15 @@ private:
         DirtyMaterial = (1 << 4)
     };
 
+    // recently resolved programs, checked before asking the renderer. a sorted queue mostly switches between a
+    // handful of permutations, so these hit without taking the shader lock or searching the shader map.
+    static const uint32 PROGRAM_CACHE_SIZE = 4;
+    struct CachedProgram
+    {
+        ShaderMap::Key Key;
+        ShaderProgram *pProgram;
+    };
+
     const ShaderComponentTypeInfo *m_pBaseShaderType;
     const VertexFactoryTypeInfo *m_pVertexFactoryType;
     const Material *m_pMaterial;
@@ -50,4 +60,8 @@ private:
     uint32 m_vertexFactoryFlags;
     uint32 m_materialStaticSwitchMask;
     uint32 m_dirtyFlags;
+
+    CachedProgram m_programCache[PROGRAM_CACHE_SIZE];
+    uint32 m_programCacheCount;
+    uint32 m_programCacheNext;
 };
@@ -0,0 +1,108 @@
+#include "Renderer/PrecompiledHeader.h"
+#include "Renderer/SkeletalMeshSkinning.h"
+#include "MathLib/SIMDVectorf.h"
+
+namespace SkeletalMeshSkinning {
+
+void SetBoneMatrix(BoneMatrix *pBoneMatrix, const float3x4 &matrix)
+{
+    for (uint32 column = 0; column < 4; column++)
+    {
+        pBoneMatrix->Columns[column][0] = matrix.Row[0][column];
+        pBoneMatrix->Columns[column][1] = matrix.Row[1][column];
+        pBoneMatrix->Columns[column][2] = matrix.Row[2][column];
+        pBoneMatrix->Columns[column][3] = 0.0f;
+    }
+}
+
+void GetBoneMatrix(float3x4 *pMatrix, const BoneMatrix &boneMatrix)
+{
+    for (uint32 column = 0; column < 4; column++)
+    {
+        pMatrix->Row[0][column] = boneMatrix.Columns[column][0];
+        pMatrix->Row[1][column] = boneMatrix.Columns[column][1];
+        pMatrix->Row[2][column] = boneMatrix.Columns[column][2];
+    }
+}
+
+void ConcatenateBoneMatrices(BoneMatrix *pResult, const BoneMatrix &pose, const BoneMatrix &localToBone)
+{
+    SIMDVector4f poseColumn0(pose.Columns[0]);
+    SIMDVector4f poseColumn1(pose.Columns[1]);
+    SIMDVector4f poseColumn2(pose.Columns[2]);
+    SIMDVector4f poseColumn3(pose.Columns[3]);
+
+    // each column of the result is the pose applied to the matching localToBone column, the translation column as a point
+    SIMDVector4f column0(poseColumn0 * localToBone.Columns[0][0] + poseColumn1 * localToBone.Columns[0][1] + poseColumn2 * localToBone.Columns[0][2]);
+    SIMDVector4f column1(poseColumn0 * localToBone.Columns[1][0] + poseColumn1 * localToBone.Columns[1][1] + poseColumn2 * localToBone.Columns[1][2]);
+    SIMDVector4f column2(poseColumn0 * localToBone.Columns[2][0] + poseColumn1 * localToBone.Columns[2][1] + poseColumn2 * localToBone.Columns[2][2]);
+    SIMDVector4f column3(poseColumn0 * localToBone.Columns[3][0] + poseColumn1 * localToBone.Columns[3][1] + poseColumn2 * localToBone.Columns[3][2] + poseColumn3);
+
+    column0.Store(pResult->Columns[0]);
+    column1.Store(pResult->Columns[1]);
+    column2.Store(pResult->Columns[2]);
+    column3.Store(pResult->Columns[3]);
+}
+
+static inline void StoreNormalizedVector(float3 *pDestination, const SIMDVector4f &v)
+{
+    // w is zero, so the four component dot is the squared length
+    float squaredLength = v.Dot(v);
+    if (squaredLength != 0.0f)
+    {
+        SIMDVector4f normalized(v * (1.0f / Y_sqrtf(squaredLength)));
+        pDestination->Set(normalized.x, normalized.y, normalized.z);
+    }
+    else
+    {
+        pDestination->Set(v.x, v.y, v.z);
+    }
+}
+
+void SkinVertices(SkeletalMeshVertexFactory::Vertex *pDestinationVertices, const SkeletalMeshVertexFactory::Vertex *pSourceVertices, uint32 vertexCount, uint32 weightCount, const BoneMatrix *pBoneMatrices)
+{
+    DebugAssert(weightCount > 0 && weightCount <= 4);
+
+    const SkeletalMeshVertexFactory::Vertex *pSourceVertex = pSourceVertices;
+    SkeletalMeshVertexFactory::Vertex *pDestinationVertex = pDestinationVertices;
+    for (uint32 vertexIndex = 0; vertexIndex < vertexCount; vertexIndex++, pSourceVertex++, pDestinationVertex++)
+    {
+        // blend the bone matrices, rather than transforming each attribute by every bone
+        const BoneMatrix *pBoneMatrix = &pBoneMatrices[pSourceVertex->BoneIndices[0]];
+        float boneWeight = pSourceVertex->BoneWeights[0];
+        SIMDVector4f column0(SIMDVector4f(pBoneMatrix->Columns[0]) * boneWeight);
+        SIMDVector4f column1(SIMDVector4f(pBoneMatrix->Columns[1]) * boneWeight);
+        SIMDVector4f column2(SIMDVector4f(pBoneMatrix->Columns[2]) * boneWeight);
+        SIMDVector4f column3(SIMDVector4f(pBoneMatrix->Columns[3]) * boneWeight);
+        for (uint32 weightIndex = 1; weightIndex < weightCount; weightIndex++)
+        {
+            pBoneMatrix = &pBoneMatrices[pSourceVertex->BoneIndices[weightIndex]];
+            boneWeight = pSourceVertex->BoneWeights[weightIndex];
+            column0 += SIMDVector4f(pBoneMatrix->Columns[0]) * boneWeight;
+            column1 += SIMDVector4f(pBoneMatrix->Columns[1]) * boneWeight;
+            column2 += SIMDVector4f(pBoneMatrix->Columns[2]) * boneWeight;
+            column3 += SIMDVector4f(pBoneMatrix->Columns[3]) * boneWeight;
+        }
+
+        // transform the attributes
+        const float3 &sourcePosition = pSourceVertex->Position;
+        const float3 &sourceTangentX = pSourceVertex->TangentX;
+        const float3 &sourceTangentY = pSourceVertex->TangentY;
+        const float3 &sourceTangentZ = pSourceVertex->TangentZ;
+        SIMDVector4f position(column0 * sourcePosition.x + column1 * sourcePosition.y + column2 * sourcePosition.z + column3);
+        SIMDVector4f tangentX(column0 * sourceTangentX.x + column1 * sourceTangentX.y + column2 * sourceTangentX.z);
+        SIMDVector4f tangentY(column0 * sourceTangentY.x + column1 * sourceTangentY.y + column2 * sourceTangentY.z);
+        SIMDVector4f tangentZ(column0 * sourceTangentZ.x + column1 * sourceTangentZ.y + column2 * sourceTangentZ.z);
+
+        pDestinationVertex->Position.Set(position.x, position.y, position.z);
+        StoreNormalizedVector(&pDestinationVertex->TangentX, tangentX);
+        StoreNormalizedVector(&pDestinationVertex->TangentY, tangentY);
+        StoreNormalizedVector(&pDestinationVertex->TangentZ, tangentZ);
+
+        // non-changing attributes
+        pDestinationVertex->TexCoord = pSourceVertex->TexCoord;
+        pDestinationVertex->Color = pSourceVertex->Color;
+    }
+}
+
+};      // namespace SkeletalMeshSkinning
@@ -0,0 +1,26 @@
+#pragma once
+#include "Renderer/Common.h"
+#include "Renderer/VertexFactories/SkeletalMeshVertexFactory.h"
+
+// CPU skinning routines. Bone matrices are held by column, so both pose concatenation and vertex transforms are
+// only multiply-adds of whole columns, which SIMDVector4f maps onto SSE where it is available.
+namespace SkeletalMeshSkinning {
+
+// affine bone matrix, the fourth column is the translation. w of every column is kept at zero.
+struct BoneMatrix
+{
+    float Columns[4][4];
+};
+
+// conversion from/to the row-major matrices used by the gpu path
+void SetBoneMatrix(BoneMatrix *pBoneMatrix, const float3x4 &matrix);
+void GetBoneMatrix(float3x4 *pMatrix, const BoneMatrix &boneMatrix);
+
+// pResult = pose * localToBone, ie. localToBone is applied first
+void ConcatenateBoneMatrices(BoneMatrix *pResult, const BoneMatrix &pose, const BoneMatrix &localToBone);
+
+// linear blend skinning of weightCount (1-4) bones per vertex, bone indices are relative to pBoneMatrices.
+// positions and tangents are transformed by the weighted sum of the bone matrices, tangents are renormalized.
+void SkinVertices(SkeletalMeshVertexFactory::Vertex *pDestinationVertices, const SkeletalMeshVertexFactory::Vertex *pSourceVertices, uint32 vertexCount, uint32 weightCount, const BoneMatrix *pBoneMatrices);
+
+};      // namespace SkeletalMeshSkinning
@@ -8,6 +8,7 @@
 #include "Renderer/Renderer.h"
 #include "Renderer/RenderProxy.h"
 #include "Renderer/RenderWorld.h"
+#include "Renderer/RenderProxies/SkeletalMeshRenderProxy.h"
 #include "Renderer/ShaderProgram.h"
 #include "Renderer/ShaderProgramSelector.h"
 #include "Renderer/ShaderCompilerFrontend.h"
@@ -472,6 +473,9 @@ void WorldRenderer::FillRenderQueue(const Camera *pCamera, const RenderWorld *pR
 {
     MICROPROFILE_SCOPEI("WorldRenderer", "FillRenderQueue", MICROPROFILE_COLOR(0, 255, 255));
 
+    // skin anything posed since the last frame, before it is drawn by any view or shadow map
+    SkeletalMeshRenderProxy::ExecutePendingCPUSkinning();
+
     // clear render queue
     m_renderQueue.Clear();
 
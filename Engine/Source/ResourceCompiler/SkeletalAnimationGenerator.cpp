@@ -797,18 +797,24 @@ bool SkeletalAnimationGenerator::Compile(ResourceCompilerCallbacks *pCallbacks,
 {
     if (optimize)
     {
+        // the tolerances can be overridden per animation, the defaults are below what is visible on a character
+        CompressionTolerances tolerances;
+        tolerances.Position = m_properties.GetPropertyValueDefaultFloat("CompressionPositionTolerance", 0.0005f);
+        tolerances.Rotation = m_properties.GetPropertyValueDefaultFloat("CompressionRotationTolerance", 0.0005f);
+        tolerances.Scale = m_properties.GetPropertyValueDefaultFloat("CompressionScaleTolerance", 0.0005f);
+
         SkeletalAnimationGenerator animationCopy;
         animationCopy.Copy(this);
         animationCopy.Optimize(true);
-        return animationCopy.InternalCompile(pCallbacks, pStream);
+        return animationCopy.InternalCompile(pCallbacks, pStream, &tolerances);
     }
     else
     {
-        return InternalCompile(pCallbacks, pStream);
+        return InternalCompile(pCallbacks, pStream, nullptr);
     }
 }
 
-bool SkeletalAnimationGenerator::InternalCompile(ResourceCompilerCallbacks *pCallbacks, ByteStream *pStream) const
+bool SkeletalAnimationGenerator::InternalCompile(ResourceCompilerCallbacks *pCallbacks, ByteStream *pStream, const CompressionTolerances *pTolerances) const
 {
     if (m_skeletonName.IsEmpty() || 
         (m_boneTracks.GetSize() == 0))
@@ -874,22 +880,10 @@ bool SkeletalAnimationGenerator::InternalCompile(ResourceCompilerCallbacks *pCal
                 return false;
             }
 
-            // create bone track header
-            DF_SKELETALANIMATION_BONE_TRACK_HEADER boneTrackHeader;
-            boneTrackHeader.BoneIndex = pBone->GetIndex();
-            boneTrackHeader.Duration = pBoneTrack->GetDuration();
-            boneTrackHeader.KeyFrameCount = pBoneTrack->GetKeyFrameCount();
-            if (!pStream->Write2(&boneTrackHeader, sizeof(boneTrackHeader)))
+            // write header and key streams
+            if (!InternalWriteTransformTrackStreams(pStream, pBoneTrack, pTolerances, pBone->GetIndex(), false))
                 return false;
 
-            // write keyframes
-            for (uint32 keyFrameIndex = 0; keyFrameIndex < pBoneTrack->GetKeyFrameCount(); keyFrameIndex++)
-            {
-                const BoneTrack::KeyFrame *pKeyFrame = pBoneTrack->GetKeyFrame(keyFrameIndex);
-                if (!InternalWriteTransformKeyFrame(pStream, pKeyFrame))
-                    return false;
-            }
-
             // increment bone track count
             fileHeader.BoneTrackCount++;
         }
@@ -900,23 +894,11 @@ bool SkeletalAnimationGenerator::InternalCompile(ResourceCompilerCallbacks *pCal
     }
 
     // write root motion track
-    if (m_pRootMotionTrack != nullptr)
+    if (m_pRootMotionTrack != nullptr && m_pRootMotionTrack->GetKeyFrameCount() > 0)
     {
         fileHeader.RootMotionOffset = (uint32)(pStream->GetPosition() - headerOffset);
-        
-        DF_SKELETALANIMATION_ROOT_MOTION_TRACK_HEADER rootMotionTrackHeader;
-        rootMotionTrackHeader.Duration = m_pRootMotionTrack->GetDuration();
-        rootMotionTrackHeader.KeyFrameCount = m_pRootMotionTrack->GetKeyFrameCount();
-        if (!pStream->Write2(&rootMotionTrackHeader, sizeof(rootMotionTrackHeader)))
+        if (!InternalWriteTransformTrackStreams(pStream, m_pRootMotionTrack, pTolerances, 0, true))
             return false;
-
-        // write keyframes
-        for (uint32 keyFrameIndex = 0; keyFrameIndex < m_pRootMotionTrack->GetKeyFrameCount(); keyFrameIndex++)
-        {
-            const BoneTrack::KeyFrame *pKeyFrame = m_pRootMotionTrack->GetKeyFrame(keyFrameIndex);
-            if (!InternalWriteTransformKeyFrame(pStream, pKeyFrame))
-                return false;
-        }
     }
 
     // rewrite header
@@ -928,21 +910,132 @@ bool SkeletalAnimationGenerator::InternalCompile(ResourceCompilerCallbacks *pCal
     return true;
 }
 
-bool SkeletalAnimationGenerator::InternalWriteTransformKeyFrame(ByteStream *pStream, const TransformTrack::KeyFrame *pKeyFrame)
-{
-    DF_SKELETALANIMATION_TRANSFORM_TRACK_KEYFRAME fileKeyFrame;
-    fileKeyFrame.Time = pKeyFrame->GetTime();
-    fileKeyFrame.Position[0] = pKeyFrame->GetPosition().x;
-    fileKeyFrame.Position[1] = pKeyFrame->GetPosition().y;
-    fileKeyFrame.Position[2] = pKeyFrame->GetPosition().z;
-    fileKeyFrame.Rotation[0] = pKeyFrame->GetRotation().x;
-    fileKeyFrame.Rotation[1] = pKeyFrame->GetRotation().y;
-    fileKeyFrame.Rotation[2] = pKeyFrame->GetRotation().z;
-    fileKeyFrame.Rotation[3] = pKeyFrame->GetRotation().w;
-    fileKeyFrame.Scale[0] = pKeyFrame->GetScale().x;
-    fileKeyFrame.Scale[1] = pKeyFrame->GetScale().y;
-    fileKeyFrame.Scale[2] = pKeyFrame->GetScale().z;
-    return pStream->Write2(&fileKeyFrame, sizeof(fileKeyFrame));
+// drops keys from a stream that interpolating between the surrounding kept keys reproduces within the tolerance.
+// a stream that never leaves the tolerance of its first key is reduced to that key.
+template<typename T, typename InterpolateFunction, typename ErrorFunction>
+static void ReduceKeyStream(MemArray<float> &times, MemArray<T> &values, float tolerance, InterpolateFunction interpolate, ErrorFunction error)
+{
+    uint32 keyCount = values.GetSize();
+    uint32 keyIndex;
+    for (keyIndex = 1; keyIndex < keyCount; keyIndex++)
+    {
+        if (error(values[keyIndex], values[0]) > tolerance)
+            break;
+    }
+
+    if (keyIndex == keyCount)
+    {
+        times.Resize(1);
+        values.Resize(1);
+        return;
+    }
+
+    // extend the span from the last kept key until a key in the middle can't be reproduced
+    MemArray<float> newTimes;
+    MemArray<T> newValues;
+    newTimes.Add(times[0]);
+    newValues.Add(values[0]);
+    uint32 anchorIndex = 0;
+    for (uint32 endIndex = 2; endIndex < keyCount; endIndex++)
+    {
+        float spanLength = times[endIndex] - times[anchorIndex];
+        for (uint32 middleIndex = anchorIndex + 1; middleIndex < endIndex; middleIndex++)
+        {
+            float factor = (spanLength > 0.0f) ? ((times[middleIndex] - times[anchorIndex]) / spanLength) : 0.0f;
+            if (error(interpolate(values[anchorIndex], values[endIndex], factor), values[middleIndex]) > tolerance)
+            {
+                anchorIndex = endIndex - 1;
+                newTimes.Add(times[anchorIndex]);
+                newValues.Add(values[anchorIndex]);
+                break;
+            }
+        }
+    }
+
+    newTimes.Add(times[keyCount - 1]);
+    newValues.Add(values[keyCount - 1]);
+    times.Swap(newTimes);
+    values.Swap(newValues);
+}
+
+static float GetRotationError(const Quaternion &left, const Quaternion &right)
+{
+    // q and -q are the same rotation
+    float sign = ((left.x * right.x + left.y * right.y + left.z * right.z + left.w * right.w) < 0.0f) ? -1.0f : 1.0f;
+    return Max(Max(Math::Abs(left.x - right.x * sign), Math::Abs(left.y - right.y * sign)), Max(Math::Abs(left.z - right.z * sign), Math::Abs(left.w - right.w * sign)));
+}
+
+static float GetVectorError(const float3 &left, const float3 &right)
+{
+    return Max(Max(Math::Abs(left.x - right.x), Math::Abs(left.y - right.y)), Math::Abs(left.z - right.z));
+}
+
+bool SkeletalAnimationGenerator::InternalWriteTransformTrackStreams(ByteStream *pStream, const TransformTrack *pTrack, const CompressionTolerances *pTolerances, uint32 boneIndex, bool rootMotion)
+{
+    DebugAssert(pTrack->GetKeyFrameCount() > 0);
+
+    // split the keyframes into a stream per component
+    uint32 keyFrameCount = pTrack->GetKeyFrameCount();
+    MemArray<float> positionTimes, rotationTimes, scaleTimes;
+    MemArray<float3> positions, scales;
+    MemArray<Quaternion> rotations;
+    for (uint32 keyFrameIndex = 0; keyFrameIndex < keyFrameCount; keyFrameIndex++)
+    {
+        const TransformTrack::KeyFrame *pKeyFrame = pTrack->GetKeyFrame(keyFrameIndex);
+        positionTimes.Add(pKeyFrame->GetTime());
+        positions.Add(pKeyFrame->GetPosition());
+        rotationTimes.Add(pKeyFrame->GetTime());
+        rotations.Add(pKeyFrame->GetRotation().Normalize());
+        scaleTimes.Add(pKeyFrame->GetTime());
+        scales.Add(pKeyFrame->GetScale());
+    }
+
+    // each component changes at its own rate, so the streams are reduced separately
+    if (pTolerances != nullptr)
+    {
+        auto lerpVector = [](const float3 &start, const float3 &end, float factor) { return start.Lerp(end, factor); };
+        ReduceKeyStream(positionTimes, positions, pTolerances->Position, lerpVector, GetVectorError);
+        ReduceKeyStream(rotationTimes, rotations, pTolerances->Rotation, Quaternion::LinearInterpolate, GetRotationError);
+        ReduceKeyStream(scaleTimes, scales, pTolerances->Scale, lerpVector, GetVectorError);
+        Log_DevPrintf("SkeletalAnimationGenerator::InternalWriteTransformTrackStreams: %u keyframes to %u position, %u rotation, %u scale keys", keyFrameCount, positions.GetSize(), rotations.GetSize(), scales.GetSize());
+    }
+
+    // write header
+    if (rootMotion)
+    {
+        DF_SKELETALANIMATION_ROOT_MOTION_TRACK_HEADER rootMotionTrackHeader;
+        rootMotionTrackHeader.Duration = pTrack->GetDuration();
+        rootMotionTrackHeader.PositionKeyCount = positions.GetSize();
+        rootMotionTrackHeader.RotationKeyCount = rotations.GetSize();
+        rootMotionTrackHeader.ScaleKeyCount = scales.GetSize();
+        if (!pStream->Write2(&rootMotionTrackHeader, sizeof(rootMotionTrackHeader)))
+            return false;
+    }
+    else
+    {
+        DF_SKELETALANIMATION_BONE_TRACK_HEADER boneTrackHeader;
+        boneTrackHeader.BoneIndex = boneIndex;
+        boneTrackHeader.Duration = pTrack->GetDuration();
+        boneTrackHeader.PositionKeyCount = positions.GetSize();
+        boneTrackHeader.RotationKeyCount = rotations.GetSize();
+        boneTrackHeader.ScaleKeyCount = scales.GetSize();
+        if (!pStream->Write2(&boneTrackHeader, sizeof(boneTrackHeader)))
+            return false;
+    }
+
+    // quantize rotations
+    MemArray<DF_SKELETALANIMATION_PACKED_ROTATION> packedRotations;
+    packedRotations.Resize(rotations.GetSize());
+    for (uint32 i = 0; i < rotations.GetSize(); i++)
+        SkeletalAnimation::PackRotation(rotations[i], reinterpret_cast<SkeletalAnimation::PackedRotation *>(&packedRotations[i]));
+
+    // write streams
+    return (pStream->Write2(positionTimes.GetBasePointer(), sizeof(float) * positionTimes.GetSize()) &&
+            pStream->Write2(positions.GetBasePointer(), sizeof(float3) * positions.GetSize()) &&
+            pStream->Write2(rotationTimes.GetBasePointer(), sizeof(float) * rotationTimes.GetSize()) &&
+            pStream->Write2(packedRotations.GetBasePointer(), sizeof(DF_SKELETALANIMATION_PACKED_ROTATION) * packedRotations.GetSize()) &&
+            pStream->Write2(scaleTimes.GetBasePointer(), sizeof(float) * scaleTimes.GetSize()) &&
+            pStream->Write2(scales.GetBasePointer(), sizeof(float3) * scales.GetSize()));
 }
 
 void SkeletalAnimationGenerator::GenerateKeyFrameTimeList(PODArray<float> *pKeyFrameTimeArray) const
@@ -147,8 +147,16 @@ public:
     void GenerateKeyFrameTimeList(PODArray<float> *pKeyFrameTimeArray) const;
 
 private:
-    bool InternalCompile(ResourceCompilerCallbacks *pCallbacks, ByteStream *pStream) const;
-    static bool InternalWriteTransformKeyFrame(ByteStream *pStream, const TransformTrack::KeyFrame *pKeyFrame);
+    // key stream error tolerances, compressing drops keys that interpolation reproduces within these
+    struct CompressionTolerances
+    {
+        float Position;
+        float Rotation;
+        float Scale;
+    };
+
+    bool InternalCompile(ResourceCompilerCallbacks *pCallbacks, ByteStream *pStream, const CompressionTolerances *pTolerances) const;
+    static bool InternalWriteTransformTrackStreams(ByteStream *pStream, const TransformTrack *pTrack, const CompressionTolerances *pTolerances, uint32 boneIndex, bool rootMotion);
 
     String m_skeletonName;
     PropertyTable m_properties;
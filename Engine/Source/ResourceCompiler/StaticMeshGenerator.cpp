@@ -205,6 +205,8 @@ bool StaticMeshGenerator::LoadFromXML(const char *FileName, ByteStream *pStream)
                                 case 0:
                                     {
                                         LOD *lod = new LOD();
+                                        const char *screenSizeStr = xmlReader.FetchAttribute("screen-size");
+                                        lod->ScreenSize = (screenSizeStr != nullptr) ? StringConverter::StringToFloat(screenSizeStr) : GetDefaultLODScreenSize(m_lods.GetSize());
                                         m_lods.Add(lod);
 
                                         if (!xmlReader.IsEmptyElement())
@@ -501,6 +503,9 @@ bool StaticMeshGenerator::SaveToXML(ByteStream *pStream) const
 
             xmlWriter.StartElement("lod");
             {
+                StringConverter::FloatToString(tempString, lod->ScreenSize);
+                xmlWriter.WriteAttribute("screen-size", tempString);
+
                 xmlWriter.StartElement("vertices");
                 {
                     for (uint32 vertexIndex = 0; vertexIndex < lod->Vertices.GetSize(); vertexIndex++)
@@ -711,6 +716,7 @@ bool StaticMeshGenerator::Compile(ByteStream *pStream) const
             lodHeader.IndicesOffset = 0;
             lodHeader.BatchCount = 0;
             lodHeader.BatchesOffset = 0;
+            lodHeader.ScreenSize = lod->ScreenSize;
             if (!pStream->Write2(&lodHeader, sizeof(lodHeader)))
                 return false;
 
@@ -902,6 +908,7 @@ void StaticMeshGenerator::Copy(const StaticMeshGenerator *pGenerator)
 
         LOD *destLOD = new LOD;
         destLOD->Vertices.Assign(srcLOD->Vertices);
+        destLOD->ScreenSize = srcLOD->ScreenSize;
 
         for (uint32 batchIndex = 0; batchIndex < srcLOD->Batches.GetSize(); batchIndex++)
         {
@@ -920,6 +927,7 @@ void StaticMeshGenerator::Copy(const StaticMeshGenerator *pGenerator)
 uint32 StaticMeshGenerator::AddLOD()
 {
     LOD *lod = new LOD;
+    lod->ScreenSize = GetDefaultLODScreenSize(m_lods.GetSize());
     m_lods.Add(lod);
     return m_lods.GetSize() - 1;
 }
@@ -1245,6 +1253,169 @@ void StaticMeshGenerator::FlipTriangleWinding()
     }
 }
 
+float StaticMeshGenerator::GetDefaultLODScreenSize(uint32 lod)
+{
+    // each lod takes over at half the size of the one before
+    return Math::Pow(0.5f, (float)lod);
+}
+
+bool StaticMeshGenerator::GenerateLODs(const float *pTriangleRatios, const float *pScreenSizes, uint32 count, float maxError)
+{
+    if (m_lods.GetSize() == 0)
+        return false;
+
+    // drop the existing chain
+    for (uint32 lodIndex = 1; lodIndex < m_lods.GetSize(); lodIndex++)
+    {
+        LOD *lod = m_lods[lodIndex];
+        for (uint32 batchIndex = 0; batchIndex < lod->Batches.GetSize(); batchIndex++)
+            delete lod->Batches[batchIndex];
+
+        delete lod;
+    }
+    m_lods.Resize(1);
+
+    // flatten the base lod's batches into one triangle list, so the whole mesh is simplified at once
+    const LOD *baseLOD = m_lods[0];
+    MemArray<Triangle> baseTriangles;
+    PODArray<uint32> baseTriangleBatches;
+    for (uint32 batchIndex = 0; batchIndex < baseLOD->Batches.GetSize(); batchIndex++)
+    {
+        const Batch *batch = baseLOD->Batches[batchIndex];
+        for (uint32 triangleIndex = 0; triangleIndex < batch->Triangles.GetSize(); triangleIndex++)
+        {
+            baseTriangles.Add(batch->Triangles[triangleIndex]);
+            baseTriangleBatches.Add(batchIndex);
+        }
+    }
+    if (baseTriangles.GetSize() == 0)
+        return false;
+
+    // vertices shared between batches stay put, so the material borders don't open up
+    MemArray<bool> lockedVertices;
+    PODArray<uint32> vertexBatches;
+    lockedVertices.Resize(baseLOD->Vertices.GetSize());
+    vertexBatches.Resize(baseLOD->Vertices.GetSize());
+    for (uint32 vertexIndex = 0; vertexIndex < baseLOD->Vertices.GetSize(); vertexIndex++)
+    {
+        lockedVertices[vertexIndex] = false;
+        vertexBatches[vertexIndex] = 0xFFFFFFFF;
+    }
+    for (uint32 triangleIndex = 0; triangleIndex < baseTriangles.GetSize(); triangleIndex++)
+    {
+        for (uint32 i = 0; i < 3; i++)
+        {
+            uint32 vertexIndex = baseTriangles[triangleIndex].Indices[i];
+            if (vertexBatches[vertexIndex] == 0xFFFFFFFF)
+                vertexBatches[vertexIndex] = baseTriangleBatches[triangleIndex];
+            else if (vertexBatches[vertexIndex] != baseTriangleBatches[triangleIndex])
+                lockedVertices[vertexIndex] = true;
+        }
+    }
+
+    // the error limit is relative to the size of the mesh
+    AABox baseBounds(baseLOD->Vertices[0].Position, baseLOD->Vertices[0].Position);
+    for (uint32 vertexIndex = 1; vertexIndex < baseLOD->Vertices.GetSize(); vertexIndex++)
+        baseBounds.Merge(baseLOD->Vertices[vertexIndex].Position);
+    float maxDistance = maxError * baseBounds.GetExtents().Length() * 0.5f;
+
+    MemArray<Triangle> simplifiedTriangles;
+    PODArray<uint32> sourceTriangles;
+    PODArray<uint32> vertexRemap;
+    simplifiedTriangles.Resize(baseTriangles.GetSize());
+    sourceTriangles.Resize(baseTriangles.GetSize());
+    vertexRemap.Resize(baseLOD->Vertices.GetSize());
+
+    uint32 lastTriangleCount = baseTriangles.GetSize();
+    for (uint32 ratioIndex = 0; ratioIndex < count; ratioIndex++)
+    {
+        uint32 targetTriangleCount = (uint32)((float)baseTriangles.GetSize() * pTriangleRatios[ratioIndex]);
+        uint32 simplifiedTriangleCount = MeshUtilites::SimplifyMesh(&baseLOD->Vertices[0].Position, sizeof(Vertex), baseLOD->Vertices.GetSize(),
+                                                                    baseTriangles.GetBasePointer(), sizeof(Triangle), baseTriangles.GetSize(),
+                                                                    lockedVertices.GetBasePointer(), targetTriangleCount, maxDistance,
+                                                                    simplifiedTriangles.GetBasePointer(), sizeof(Triangle), sourceTriangles.GetBasePointer());
+
+        // not worth another lod if it barely saves anything, and the later ratios can only hit the same limit
+        if (simplifiedTriangleCount == 0 || simplifiedTriangleCount > (lastTriangleCount * 9) / 10)
+        {
+            // nothing removed at all usually means everything is locked or over the error limit
+            if (simplifiedTriangleCount >= lastTriangleCount)
+                Log_WarningPrintf("StaticMeshGenerator::GenerateLODs: LOD %u (ratio %f) could not remove any of %u triangles, stopping", m_lods.GetSize(), pTriangleRatios[ratioIndex], lastTriangleCount);
+            else
+                Log_DevPrintf("StaticMeshGenerator::GenerateLODs: Stopping at %u lods, ratio %f only reached %u of %u triangles", m_lods.GetSize(), pTriangleRatios[ratioIndex], simplifiedTriangleCount, baseTriangles.GetSize());
+
+            break;
+        }
+
+        // copy the vertices that are still referenced
+        LOD *lod = new LOD;
+        lod->ScreenSize = (pScreenSizes != nullptr) ? pScreenSizes[ratioIndex] : GetDefaultLODScreenSize(m_lods.GetSize());
+        for (uint32 vertexIndex = 0; vertexIndex < baseLOD->Vertices.GetSize(); vertexIndex++)
+            vertexRemap[vertexIndex] = 0xFFFFFFFF;
+        for (uint32 triangleIndex = 0; triangleIndex < simplifiedTriangleCount; triangleIndex++)
+        {
+            Triangle &triangle = simplifiedTriangles[triangleIndex];
+            for (uint32 i = 0; i < 3; i++)
+            {
+                uint32 vertexIndex = triangle.Indices[i];
+                if (vertexRemap[vertexIndex] == 0xFFFFFFFF)
+                {
+                    vertexRemap[vertexIndex] = lod->Vertices.GetSize();
+                    lod->Vertices.Add(baseLOD->Vertices[vertexIndex]);
+                }
+
+                triangle.Indices[i] = vertexRemap[vertexIndex];
+            }
+        }
+
+        // put the triangles back in the batch they came from, batches that lost all their triangles are left out
+        for (uint32 batchIndex = 0; batchIndex < baseLOD->Batches.GetSize(); batchIndex++)
+        {
+            Batch *batch = new Batch;
+            batch->MaterialName = baseLOD->Batches[batchIndex]->MaterialName;
+            for (uint32 triangleIndex = 0; triangleIndex < simplifiedTriangleCount; triangleIndex++)
+            {
+                if (baseTriangleBatches[sourceTriangles[triangleIndex]] == batchIndex)
+                    batch->Triangles.Add(simplifiedTriangles[triangleIndex]);
+            }
+
+            if (batch->Triangles.GetSize() > 0)
+                lod->Batches.Add(batch);
+            else
+                delete batch;
+        }
+
+        Log_DevPrintf("StaticMeshGenerator::GenerateLODs: LOD %u: %u triangles, %u vertices (ratio %f, screen size %f)", m_lods.GetSize(), simplifiedTriangleCount, lod->Vertices.GetSize(), pTriangleRatios[ratioIndex], lod->ScreenSize);
+        m_lods.Add(lod);
+        lastTriangleCount = simplifiedTriangleCount;
+    }
+
+    return true;
+}
+
+bool StaticMeshGenerator::GenerateLODsFromProperties()
+{
+    // meshes that come with their own lods are left alone
+    if (!m_properties.GetPropertyValueDefaultBool("GenerateLODs", true) || m_lods.GetSize() != 1)
+        return true;
+
+    // up to four lods, a zero ratio ends the chain early
+    float triangleRatios[4];
+    float screenSizes[4];
+    m_properties.GetPropertyValueDefaultFloat4("GenerateLODTriangleRatios", float4(0.5f, 0.25f, 0.125f, 0.0f)).Store(triangleRatios);
+    m_properties.GetPropertyValueDefaultFloat4("GenerateLODScreenSizes", float4(GetDefaultLODScreenSize(1), GetDefaultLODScreenSize(2), GetDefaultLODScreenSize(3), GetDefaultLODScreenSize(4))).Store(screenSizes);
+    float maxError = m_properties.GetPropertyValueDefaultFloat("GenerateLODMaxError", 0.05f);
+
+    uint32 count = 0;
+    while (count < countof(triangleRatios) && triangleRatios[count] > 0.0f && triangleRatios[count] < 1.0f)
+        count++;
+
+    if (count == 0)
+        return true;
+
+    return GenerateLODs(triangleRatios, screenSizes, count, maxError);
+}
+
 // StaticMeshGenerator &StaticMeshGenerator::operator=(const StaticMeshGenerator &copyFrom)
 // {
 //     m_boundingBox = copyFrom.m_boundingBox;
@@ -1286,6 +1457,14 @@ BinaryBlob *ResourceCompiler::CompileStaticMesh(ResourceCompilerCallbacks *pCall
     pStream->Release();
     pSourceData->Release();
 
+    // build the lod chain if the source didn't provide one
+    if (!pGenerator->GenerateLODsFromProperties())
+    {
+        Log_ErrorPrintf("ResourceCompiler::CompileStaticMesh: Failed to generate LODs for '%s'", name);
+        delete pGenerator;
+        return nullptr;
+    }
+
     ByteStream *pOutputStream = ByteStream_CreateGrowableMemoryStream();
     if (!pGenerator->Compile(pOutputStream))
     {
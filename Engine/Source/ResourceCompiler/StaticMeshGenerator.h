@@ -33,6 +33,9 @@ public:
     {
         MemArray<Vertex> Vertices;
         PODArray<Batch *> Batches;
+
+        // the lod is drawn once the mesh's projected size falls below this fraction of the screen height
+        float ScreenSize;
     };
 
     enum CenterOrigin
@@ -68,6 +71,8 @@ public:
     const uint32 GetBatchCount(uint32 lod) const { return m_lods[lod]->Batches.GetSize(); }
     const LOD *GetLOD(uint32 i) const { return m_lods[i]; }
     const uint32 GetLODCount() const { return m_lods.GetSize(); }
+    const float GetLODScreenSize(uint32 lod) const { return m_lods[lod]->ScreenSize; }
+    void SetLODScreenSize(uint32 lod, float screenSize) { m_lods[lod]->ScreenSize = screenSize; }
     const Physics::CollisionShapeGenerator *GetCollisionShape() const { return m_pCollisionShapeGenerator; }
 
     // properties
@@ -108,6 +113,16 @@ public:
     void CenterMesh(CenterOrigin origin = CenterOrigin_Center, float3 *pOffset = nullptr);
     void FlipTriangleWinding();
 
+    // LOD chain generation, replaces every lod after the first with a simplified copy of it, one per triangle ratio.
+    // if pScreenSizes is null the default for each lod index is used. simplification stops short of the ratio rather
+    // than move the surface further than maxError times the bounding radius. lods that don't end up with fewer
+    // triangles than the one before are dropped.
+    bool GenerateLODs(const float *pTriangleRatios, const float *pScreenSizes, uint32 count, float maxError);
+
+    // builds the lod chain from the GenerateLOD* properties, if enabled and the mesh only has the one lod
+    bool GenerateLODsFromProperties();
+    static float GetDefaultLODScreenSize(uint32 lod);
+
     // Collision Shape Generators
     bool BuildCollisionShape(CollisionShapeType type);
     bool BuildBoxCollisionShape();
@@ -4,6 +4,7 @@
 #include "Engine/DataFormats.h"
 #include "Core/ImageCodec.h"
 #include "Core/Image.h"
+#include "Core/ImageResampler.h"
 #include "Core/DDSReader.h"
 #include "YBaseLib/ZipArchive.h"
 #include "YBaseLib/XMLReader.h"
@@ -22,10 +23,14 @@ const char *TextureGenerator::Properties::AddressW = "AddressW";
 const char *TextureGenerator::Properties::BorderColor = "BorderColor";
 const char *TextureGenerator::Properties::GenerateMipmaps = "GenerateMipmaps";
 const char *TextureGenerator::Properties::MipmapResizeFilter = "MipmapResizeFilter";
+const char *TextureGenerator::Properties::CascadedMipmaps = "CascadedMipmaps";
 const char *TextureGenerator::Properties::NPOTMipmaps = "NPOTMipmaps";
 const char *TextureGenerator::Properties::EnableSRGB = "EnableSRGB";
 const char *TextureGenerator::Properties::EnablePremultipliedAlpha = "EnablePremultipliedAlpha";
 const char *TextureGenerator::Properties::EnableTextureCompression = "EnableTextureCompression";
+const char *TextureGenerator::Properties::CompressionQuality = "CompressionQuality";
+const char *TextureGenerator::Properties::EnableBC7Compression = "EnableBC7Compression";
+const char *TextureGenerator::Properties::TwoChannelNormalMap = "TwoChannelNormalMap";
 
 TextureGenerator::TextureGenerator()
     : m_eTextureType(TEXTURE_TYPE_COUNT),
@@ -112,6 +117,11 @@ void TextureGenerator::SetGenerateMipmaps(bool enabled)
     m_propertyList.SetPropertyValueBool(Properties::GenerateMipmaps, enabled);
 }
 
+void TextureGenerator::SetCascadedMipmaps(bool enabled)
+{
+    m_propertyList.SetPropertyValueBool(Properties::CascadedMipmaps, enabled);
+}
+
 void TextureGenerator::SetSourcePremultipliedAlpha(bool enabled)
 {
     m_propertyList.SetPropertyValueBool(Properties::SourcePremultipliedAlpha, enabled);
@@ -127,6 +137,21 @@ void TextureGenerator::SetEnableTextureCompression(bool enabled)
     m_propertyList.SetPropertyValueBool(Properties::EnableTextureCompression, enabled);
 }
 
+void TextureGenerator::SetCompressionQuality(BLOCK_COMPRESSION_QUALITY quality)
+{
+    m_propertyList.SetPropertyValue(Properties::CompressionQuality, NameTable_GetNameString(NameTables::BlockCompressionQuality, quality));
+}
+
+void TextureGenerator::SetEnableBC7Compression(bool enabled)
+{
+    m_propertyList.SetPropertyValueBool(Properties::EnableBC7Compression, enabled);
+}
+
+void TextureGenerator::SetTwoChannelNormalMap(bool enabled)
+{
+    m_propertyList.SetPropertyValueBool(Properties::TwoChannelNormalMap, enabled);
+}
+
 void TextureGenerator::SetEnableSRGB(bool enabled)
 {
     m_propertyList.SetPropertyValueBool(Properties::EnableSRGB, enabled);
@@ -157,10 +182,14 @@ void TextureGenerator::SetDefaultProperties(TEXTURE_USAGE usage)
     m_propertyList.SetPropertyValueFloat4(Properties::BorderColor, float4::One);
     m_propertyList.SetPropertyValueBool(Properties::GenerateMipmaps, true);
     m_propertyList.SetPropertyValue(Properties::MipmapResizeFilter, NameTable_GetNameString(NameTables::ImageResizeFilter, DEFAULT_MIPMAP_RESIZE_FILTER));
+    m_propertyList.SetPropertyValueBool(Properties::CascadedMipmaps, false);
     m_propertyList.SetPropertyValueBool(Properties::NPOTMipmaps, false);
     m_propertyList.SetPropertyValueBool(Properties::EnableSRGB, useSRGB);
     m_propertyList.SetPropertyValueBool(Properties::EnablePremultipliedAlpha, true);
     m_propertyList.SetPropertyValueBool(Properties::EnableTextureCompression, true);
+    m_propertyList.SetPropertyValue(Properties::CompressionQuality, NameTable_GetNameString(NameTables::BlockCompressionQuality, BLOCK_COMPRESSION_QUALITY_NORMAL));
+    m_propertyList.SetPropertyValueBool(Properties::EnableBC7Compression, false);
+    m_propertyList.SetPropertyValueBool(Properties::TwoChannelNormalMap, false);
 }
 
 bool TextureGenerator::InternalCreate(TEXTURE_TYPE textureType, PIXEL_FORMAT pixelFormat, uint32 width, uint32 height, uint32 depth, uint32 mipLevels, uint32 arraySize)
@@ -514,11 +543,13 @@ CLEANUP:
 
 bool TextureGenerator::Resize(IMAGE_RESIZE_FILTER resizeFilter, uint32 width, uint32 height, uint32 depth)
 {
+    bool sourceSRGB = m_propertyList.GetPropertyValueDefaultBool(Properties::SourceSRGB, false);
+
     // throw away mip chain
     Image *pNewImages = new Image[m_nArraySize];
-    for (uint32 i = 0; i < m_nImages; i++)
+    for (uint32 i = 0; i < m_nArraySize; i++)
     {
-        if (!pNewImages[i].CopyAndResize(m_pImages[i * m_nMipLevels], resizeFilter, width, height, depth))
+        if (!ImageResampler::ResizeImage(&pNewImages[i], &m_pImages[i * m_nMipLevels], resizeFilter, width, height, depth, sourceSRGB))
         {
             delete[] pNewImages;
             return false;
@@ -526,6 +557,9 @@ bool TextureGenerator::Resize(IMAGE_RESIZE_FILTER resizeFilter, uint32 width, ui
     }
 
     delete[] m_pImages;
+    m_iWidth = width;
+    m_iHeight = height;
+    m_iDepth = depth;
     m_nMipLevels = 1;
     m_pImages = pNewImages;
     m_nImages = m_nArraySize;
@@ -755,53 +789,47 @@ bool TextureGenerator::GenerateMipmaps()
     if (!NameTable_TranslateType(NameTables::ImageResizeFilter, m_propertyList.GetPropertyValueDefault(Properties::MipmapResizeFilter), &resizeFilter, true))
         resizeFilter = DEFAULT_MIPMAP_RESIZE_FILTER;
 
-    // for each array image
-    uint32 i, j;
-    for (i = 0; i < m_nArraySize; i++)
+    // colour maps are filtered in linear space
+    bool sourceSRGB = m_propertyList.GetPropertyValueDefaultBool(Properties::SourceSRGB, false);
+    bool cascade = m_propertyList.GetPropertyValueDefaultBool(Properties::CascadedMipmaps, false);
+
+    // resize full scale images if necessary
+    Image *pBaseImages = new Image[m_nArraySize];
+    ImageResampler::MipChainJob *pMipChainJobs = new ImageResampler::MipChainJob[m_nArraySize];
+    for (uint32 i = 0; i < m_nArraySize; i++)
     {
-        // convert to the uncompressed format
-        Image baseImage;
-        baseImage.Copy(m_pImages[i * m_nMipLevels]);
-
-        // resize full scale image if necessary
-        if (baseWidth != baseImage.GetWidth() ||
-            baseHeight != baseImage.GetHeight() ||
-            baseDepth != baseImage.GetDepth())
+        const Image &sourceImage = m_pImages[i * m_nMipLevels];
+        const Image *pBaseImage = &sourceImage;
+        if (baseWidth != sourceImage.GetWidth() ||
+            baseHeight != sourceImage.GetHeight() ||
+            baseDepth != sourceImage.GetDepth())
         {
-            if (!baseImage.Resize(resizeFilter, baseWidth, baseHeight, baseDepth))
+            if (!ImageResampler::ResizeImage(&pBaseImages[i], &sourceImage, resizeFilter, baseWidth, baseHeight, baseDepth, sourceSRGB))
             {
                 Log_ErrorPrintf("TextureGenerator::GenerateMipmaps: Could not resize base image.");
+                delete[] pMipChainJobs;
+                delete[] pBaseImages;
                 delete[] pNewImageArray;
                 return false;
             }
+
+            pBaseImage = &pBaseImages[i];
         }
 
-        // store mip levels
-        currentWidth = baseWidth;
-        currentHeight = baseHeight;
-        currentDepth = baseDepth;
-        for (j = 0; j < nMips; j++)
-        {
-            Image &destImage = pNewImageArray[i * nMips + j];
-            if (j == 0)
-            {
-                // miplevel 0 can just be copied
-                destImage.Copy(baseImage);
-            }
-            else
-            {
-                if (!destImage.CopyAndResize(baseImage, resizeFilter, currentWidth, currentHeight, currentDepth))
-                {
-                    Log_ErrorPrintf("TextureGenerator::GenerateMipmaps: Could not copy/resize miplevel %u of array index %u", j, i);
-                    delete[] pNewImageArray;
-                    return false;
-                }
-            }
+        pMipChainJobs[i].pBaseImage = pBaseImage;
+        pMipChainJobs[i].pMipImages = &pNewImageArray[i * nMips];
+        pMipChainJobs[i].MipCount = nMips;
+    }
 
-            currentWidth = Max(currentWidth / 2, (uint32)1);
-            currentHeight = Max(currentHeight / 2, (uint32)1);
-            currentDepth = Max(currentDepth / 2, (uint32)1);
-        }
+    // array slices and cube faces are built in parallel
+    bool result = ImageResampler::GenerateMipChains(resizeFilter, sourceSRGB, cascade, pMipChainJobs, m_nArraySize);
+    delete[] pMipChainJobs;
+    delete[] pBaseImages;
+    if (!result)
+    {
+        Log_ErrorPrintf("TextureGenerator::GenerateMipmaps: Could not generate mip chains.");
+        delete[] pNewImageArray;
+        return false;
     }
 
     // store everything
@@ -822,6 +850,10 @@ bool TextureGenerator::ConvertToPixelFormat(PIXEL_FORMAT newPixelFormat)
     if (m_ePixelFormat == newPixelFormat)
         return true;
 
+    // block compressed formats encode every mip and slice at once
+    if (BlockCompression::IsSupportedFormat(newPixelFormat))
+        return ConvertToBlockCompressedPixelFormat(newPixelFormat);
+
     uint32 i;
     Image *pNewImageArray = new Image[m_nImages];
     for (i = 0; i < m_nImages; i++)
@@ -840,6 +872,67 @@ bool TextureGenerator::ConvertToPixelFormat(PIXEL_FORMAT newPixelFormat)
     return true;
 }
 
+bool TextureGenerator::ConvertToBlockCompressedPixelFormat(PIXEL_FORMAT newPixelFormat)
+{
+    // the encoders read R8G8B8A8
+    const Image *pSourceImages = m_pImages;
+    Image *pConvertedImages = NULL;
+    if (m_ePixelFormat != PIXEL_FORMAT_R8G8B8A8_UNORM)
+    {
+        pConvertedImages = new Image[m_nImages];
+        for (uint32 i = 0; i < m_nImages; i++)
+        {
+            if (!pConvertedImages[i].CopyAndConvertPixelFormat(m_pImages[i], PIXEL_FORMAT_R8G8B8A8_UNORM))
+            {
+                Log_ErrorPrintf("TextureGenerator::ConvertToBlockCompressedPixelFormat: Failed to convert image %u to R8G8B8A8", i);
+                delete[] pConvertedImages;
+                return false;
+            }
+        }
+
+        pSourceImages = pConvertedImages;
+    }
+
+    BLOCK_COMPRESSION_QUALITY quality;
+    if (!NameTable_TranslateType(NameTables::BlockCompressionQuality, m_propertyList.GetPropertyValueDefault(Properties::CompressionQuality, ""), &quality, true))
+        quality = BLOCK_COMPRESSION_QUALITY_NORMAL;
+
+    // one job per depth slice of every image, so large mips and small ones are spread over the same threads
+    Image *pNewImageArray = new Image[m_nImages];
+    MemArray<BlockCompression::EncodeJob> jobs;
+    for (uint32 i = 0; i < m_nImages; i++)
+    {
+        const Image &sourceImage = pSourceImages[i];
+        Image &destinationImage = pNewImageArray[i];
+        destinationImage.Create(newPixelFormat, sourceImage.GetWidth(), sourceImage.GetHeight(), sourceImage.GetDepth());
+        for (uint32 slice = 0; slice < sourceImage.GetDepth(); slice++)
+        {
+            BlockCompression::EncodeJob job;
+            job.pSourcePixels = sourceImage.GetData() + slice * sourceImage.GetDataSlicePitch();
+            job.SourcePitch = sourceImage.GetDataRowPitch();
+            job.Width = sourceImage.GetWidth();
+            job.Height = sourceImage.GetHeight();
+            job.pDestinationBlocks = destinationImage.GetData() + slice * destinationImage.GetDataSlicePitch();
+            job.DestinationPitch = destinationImage.GetDataRowPitch();
+            jobs.Add(job);
+        }
+    }
+
+    Log_DevPrintf("TextureGenerator::ConvertToBlockCompressedPixelFormat: Encoding %u images to %s (%s quality)", jobs.GetSize(), NameTable_GetNameString(NameTables::PixelFormat, newPixelFormat), NameTable_GetNameString(NameTables::BlockCompressionQuality, quality));
+    bool result = BlockCompression::EncodeImages(newPixelFormat, quality, jobs.GetBasePointer(), jobs.GetSize());
+    delete[] pConvertedImages;
+    if (!result)
+    {
+        delete[] pNewImageArray;
+        return false;
+    }
+
+    m_ePixelFormat = newPixelFormat;
+    delete[] m_pImages;
+    m_pImages = pNewImageArray;
+    return true;
+}
+
 bool TextureGenerator::AnalyzeImage()
 {
     uint32 i;
@@ -1040,9 +1133,11 @@ PIXEL_FORMAT TextureGenerator::GetBestPixelFormat(bool allowCompression) const
             case TEXTURE_USAGE_COLOR_MAP:
             case TEXTURE_USAGE_UI_ASSET:
                 {
-                    // TODO: Optional BC7
-                    if (allowCompression)
-                        return (m_bHasAlpha && m_bHasAlphaLevels) ? PIXEL_FORMAT_BC3_UNORM : PIXEL_FORMAT_BC1_UNORM;
+                    // bc7 keeps smooth alpha gradients that bc3 bands
+                    if (allowCompression && m_bHasAlpha && m_bHasAlphaLevels)
+                        return m_propertyList.GetPropertyValueDefaultBool(Properties::EnableBC7Compression, false) ? PIXEL_FORMAT_BC7_UNORM : PIXEL_FORMAT_BC3_UNORM;
+                    else if (allowCompression)
+                        return PIXEL_FORMAT_BC1_UNORM;
                     else
                         return PIXEL_FORMAT_R8G8B8A8_UNORM;
                 }
@@ -1053,18 +1148,19 @@ PIXEL_FORMAT TextureGenerator::GetBestPixelFormat(bool allowCompression) const
             case TEXTURE_USAGE_UI_LUMINANCE_ASSET:
             case TEXTURE_USAGE_HEIGHT_MAP:
                 {
-                    //if (allowCompression)
-                        //return PIXEL_FORMAT_BC4_UNORM;
-                    //else
+                    if (allowCompression)
+                        return PIXEL_FORMAT_BC4_UNORM;
+                    else
                         return PIXEL_FORMAT_R8_UNORM;
                 }
                 break;
 
             case TEXTURE_USAGE_NORMAL_MAP:
                 {
-                    //if (allowCompression)
-                        //return PIXEL_FORMAT_BC5_UNORM;
-                    //else
+                    // two channel maps only carry x and y, the shaders sampling them have to rebuild z
+                    if (allowCompression && m_propertyList.GetPropertyValueDefaultBool(Properties::TwoChannelNormalMap, false))
+                        return PIXEL_FORMAT_BC5_UNORM;
+                    else
                         return PIXEL_FORMAT_R8G8B8A8_UNORM;
                 }
                 break;
@@ -2,6 +2,7 @@
 #include "ResourceCompiler/Common.h"
 #include "Engine/Texture.h"
 #include "Core/Image.h"
+#include "Core/BlockCompression.h"
 #include "Core/PropertyTable.h"
 
 class TextureGenerator
@@ -25,10 +26,14 @@ public:
         static const char *BorderColor;
         static const char *GenerateMipmaps;
         static const char *MipmapResizeFilter;
+        static const char *CascadedMipmaps;
         static const char *NPOTMipmaps;
         static const char *EnableSRGB;
         static const char *EnablePremultipliedAlpha;
         static const char *EnableTextureCompression;
+        static const char *CompressionQuality;
+        static const char *EnableBC7Compression;
+        static const char *TwoChannelNormalMap;
     };
 
 public:
@@ -67,9 +72,13 @@ public:
 
     void SetMipMapResizeFilter(IMAGE_RESIZE_FILTER filter);
     void SetGenerateMipmaps(bool enabled);
+    void SetCascadedMipmaps(bool enabled);
     void SetSourcePremultipliedAlpha(bool enabled);
     void SetEnablePremultipliedAlpha(bool enabled);
     void SetEnableTextureCompression(bool enabled);
+    void SetCompressionQuality(BLOCK_COMPRESSION_QUALITY quality);
+    void SetEnableBC7Compression(bool enabled);
+    void SetTwoChannelNormalMap(bool enabled);
     void SetEnableSRGB(bool enabled);
     void SetSourceSRGB(bool enabled);
 
@@ -99,6 +108,7 @@ private:
     bool InternalCreate(TEXTURE_TYPE textureType, PIXEL_FORMAT pixelFormat, uint32 width, uint32 height, uint32 depth, uint32 mipLevels, uint32 arraySize);
     void SetDefaultProperties(TEXTURE_USAGE usage);
     bool InternalCompile(ByteStream *pOutputStream);
+    bool ConvertToBlockCompressedPixelFormat(PIXEL_FORMAT newPixelFormat);
 
     TEXTURE_TYPE m_eTextureType;
     TEXTURE_PLATFORM m_eTexturePlatform;
@@ -0,0 +1,203 @@
+#include "Engine/Common.h"
+#include "BlockEngine/BlockWorldNoise.h"
+#include "BlockEngine/BlockWorldGenerator.h"
+#include "BlockEngine/BlockWorldChunk.h"
+#include "YBaseLib/Log.h"
+Log_SetChannel(TestBlockWorldGeneration);
+
+// Checks the parts parallel generation is built from: that the noise gives the same values every time and stays in
+// range, and that the lods a generated column builds match what BlockWorldChunk::UpdateLODs leaves when each block is
+// set one at a time. A full BlockWorld needs the engine running, so the per-block update is replayed on plain arrays,
+// picking blocks the same way the chunk does.
+
+static const int32 TEST_CHUNK_SIZE = 16;
+static const int32 TEST_LOD_LEVELS = BLOCK_WORLD_MAX_LOD_LEVELS;
+static const int32 TEST_MIN_CHUNK_Z = -1;
+static const int32 TEST_MAX_CHUNK_Z = 2;
+static const uint32 TEST_GRID_SIZE = 96;
+static const uint32 TEST_COLUMN_HEIGHT = 64;
+
+static uint32 TestNoise()
+{
+    static const char *typeNames[NUM_BLOCK_WORLD_NOISE_TYPES] = { "value", "perlin", "simplex" };
+    const uint32 pointCount = TEST_GRID_SIZE * TEST_GRID_SIZE;
+    float *pFirstResults = new float[pointCount];
+    float *pSecondResults = new float[pointCount];
+    float *pOtherSeedResults = new float[pointCount];
+    float firstColumn[TEST_COLUMN_HEIGHT];
+    float secondColumn[TEST_COLUMN_HEIGHT];
+
+    uint32 failureCount = 0;
+    for (uint32 type = 0; type < NUM_BLOCK_WORLD_NOISE_TYPES; type++)
+    {
+        BlockWorldNoiseParameters parameters = { (BLOCK_WORLD_NOISE_TYPE)type, 1234, 1.0f / 48.0f, 5, 2.0f, 0.5f };
+        BlockWorldNoise::Fractal2DGrid(parameters, -1000.0f, 250.0f, TEST_GRID_SIZE, TEST_GRID_SIZE, pFirstResults);
+        BlockWorldNoise::Fractal2DGrid(parameters, -1000.0f, 250.0f, TEST_GRID_SIZE, TEST_GRID_SIZE, pSecondResults);
+        BlockWorldNoise::Fractal3DColumn(parameters, 17.0f, -3.0f, -32.0f, TEST_COLUMN_HEIGHT, firstColumn);
+        BlockWorldNoise::Fractal3DColumn(parameters, 17.0f, -3.0f, -32.0f, TEST_COLUMN_HEIGHT, secondColumn);
+
+        BlockWorldNoiseParameters otherSeedParameters = parameters;
+        otherSeedParameters.Seed++;
+        BlockWorldNoise::Fractal2DGrid(otherSeedParameters, -1000.0f, 250.0f, TEST_GRID_SIZE, TEST_GRID_SIZE, pOtherSeedResults);
+
+        // the comparisons are written so that nan counts as out of range
+        uint32 mismatchCount = 0;
+        uint32 outOfRangeCount = 0;
+        uint32 sameAsOtherSeedCount = 0;
+        for (uint32 i = 0; i < pointCount; i++)
+        {
+            mismatchCount += (pFirstResults[i] != pSecondResults[i]) ? 1 : 0;
+            outOfRangeCount += (Math::Abs(pFirstResults[i]) <= 1.0f) ? 0 : 1;
+            sameAsOtherSeedCount += (pFirstResults[i] == pOtherSeedResults[i]) ? 1 : 0;
+        }
+        for (uint32 i = 0; i < TEST_COLUMN_HEIGHT; i++)
+        {
+            mismatchCount += (firstColumn[i] != secondColumn[i]) ? 1 : 0;
+            outOfRangeCount += (Math::Abs(firstColumn[i]) <= 1.0f) ? 0 : 1;
+        }
+
+        bool passed = (mismatchCount == 0 && outOfRangeCount == 0 && sameAsOtherSeedCount < (pointCount / 100));
+        failureCount += (passed) ? 0 : 1;
+        Log_InfoPrintf("%s noise: %u mismatches between runs, %u out of range, %u unchanged by the seed: %s",
+                       typeNames[type], mismatchCount, outOfRangeCount, sameAsOtherSeedCount, (passed) ? "ok" : "FAILED");
+    }
+
+    delete[] pOtherSeedResults;
+    delete[] pSecondResults;
+    delete[] pFirstResults;
+    return failureCount;
+}
+
+struct ReferenceChunk
+{
+    BlockWorldBlockType *pBlockValues[BLOCK_WORLD_MAX_LOD_LEVELS];
+    BlockWorldBlockDataType *pBlockData[BLOCK_WORLD_MAX_LOD_LEVELS];
+};
+
+static uint32 GetReferenceBlockCount(int32 lodLevel)
+{
+    int32 lodChunkSize = TEST_CHUNK_SIZE >> lodLevel;
+    return (uint32)(lodChunkSize * lodChunkSize * lodChunkSize);
+}
+
+static uint32 GetReferenceBlockIndex(int32 lodLevel, int32 bx, int32 by, int32 bz)
+{
+    int32 lodChunkSize = TEST_CHUNK_SIZE >> lodLevel;
+    return (uint32)(((bz * lodChunkSize) + by) * lodChunkSize + bx);
+}
+
+// BlockWorldChunk::UpdateLODs without the chunk
+static void ReferenceUpdateLODs(ReferenceChunk *pChunk, int32 lodLevel, int32 blockX, int32 blockY, int32 blockZ)
+{
+    if (lodLevel == (TEST_LOD_LEVELS - 1))
+        return;
+
+    int32 baseBlockX = blockX & ~1;
+    int32 baseBlockY = blockY & ~1;
+    int32 baseBlockZ = blockZ & ~1;
+    BlockWorldBlockType blocks[8];
+    BlockWorldBlockDataType blockData[8];
+    for (uint32 i = 0; i < 8; i++)
+    {
+        uint32 index = GetReferenceBlockIndex(lodLevel, baseBlockX + (int32)(i & 1), baseBlockY + (int32)((i >> 1) & 1), baseBlockZ + (int32)(i >> 2));
+        blocks[i] = pChunk->pBlockValues[lodLevel][index];
+        blockData[i] = pChunk->pBlockData[lodLevel][index];
+    }
+
+    uint32 sourceBlock = BlockWorldChunk::SelectLODSourceBlock(blocks);
+    uint32 nextIndex = GetReferenceBlockIndex(lodLevel + 1, baseBlockX / 2, baseBlockY / 2, baseBlockZ / 2);
+    pChunk->pBlockValues[lodLevel + 1][nextIndex] = blocks[sourceBlock];
+    pChunk->pBlockData[lodLevel + 1][nextIndex] = blockData[sourceBlock];
+    ReferenceUpdateLODs(pChunk, lodLevel + 1, baseBlockX / 2, baseBlockY / 2, baseBlockZ / 2);
+}
+
+static uint32 TestColumnLODs()
+{
+    BlockWorldGeneratorColumn column(TEST_CHUNK_SIZE, TEST_LOD_LEVELS, 5, -3, TEST_MIN_CHUNK_Z, TEST_MAX_CHUNK_Z);
+
+    // hills from a height map with caves cut out of them, so the coarser lods have mixed blocks to pick from
+    BlockWorldNoiseParameters heightParameters = { BLOCK_WORLD_NOISE_TYPE_SIMPLEX, 77, 1.0f / 32.0f, 4, 2.0f, 0.5f };
+    BlockWorldNoiseParameters caveParameters = { BLOCK_WORLD_NOISE_TYPE_PERLIN, 78, 1.0f / 12.0f, 2, 2.0f, 0.5f };
+    float heights[TEST_CHUNK_SIZE * TEST_CHUNK_SIZE];
+    BlockWorldNoise::Fractal2DGrid(heightParameters, (float)column.GetBaseBlockX(), (float)column.GetBaseBlockY(), TEST_CHUNK_SIZE, TEST_CHUNK_SIZE, heights);
+
+    uint32 columnHeight = (uint32)(column.GetMaxBlockZ() - column.GetMinBlockZ() + 1);
+    float *pDensities = new float[columnHeight];
+    for (int32 ly = 0; ly < TEST_CHUNK_SIZE; ly++)
+    {
+        for (int32 lx = 0; lx < TEST_CHUNK_SIZE; lx++)
+        {
+            int32 height = Min((int32)(heights[ly * TEST_CHUNK_SIZE + lx] * 24.0f) + 8, column.GetMaxBlockZ());
+            BlockWorldNoise::Fractal3DColumn(caveParameters, (float)(column.GetBaseBlockX() + lx), (float)(column.GetBaseBlockY() + ly), (float)column.GetMinBlockZ(), columnHeight, pDensities);
+            for (int32 bz = column.GetMinBlockZ(); bz <= height; bz++)
+            {
+                if (pDensities[bz - column.GetMinBlockZ()] > 0.35f)
+                    continue;
+
+                column.SetBlock(lx, ly, bz, (BlockWorldBlockType)(1 + ((bz & 0xFF) % 5)), (BlockWorldBlockDataType)((lx + ly + bz) & 0xF));
+            }
+        }
+    }
+    delete[] pDensities;
+
+    column.BuildLODs();
+
+    uint32 failureCount = 0;
+    for (int32 chunkZ = TEST_MIN_CHUNK_Z; chunkZ <= TEST_MAX_CHUNK_Z; chunkZ++)
+    {
+        // lod 0 as generated, with the coarser lods filled in by setting every block in turn
+        ReferenceChunk referenceChunk;
+        for (int32 lodLevel = 0; lodLevel < TEST_LOD_LEVELS; lodLevel++)
+        {
+            uint32 blockCount = GetReferenceBlockCount(lodLevel);
+            referenceChunk.pBlockValues[lodLevel] = new BlockWorldBlockType[blockCount];
+            referenceChunk.pBlockData[lodLevel] = new BlockWorldBlockDataType[blockCount];
+            Y_memzero(referenceChunk.pBlockValues[lodLevel], sizeof(BlockWorldBlockType) * blockCount);
+            Y_memzero(referenceChunk.pBlockData[lodLevel], sizeof(BlockWorldBlockDataType) * blockCount);
+        }
+
+        Y_memcpy(referenceChunk.pBlockValues[0], column.GetChunkBlockValues(0, chunkZ), sizeof(BlockWorldBlockType) * GetReferenceBlockCount(0));
+        Y_memcpy(referenceChunk.pBlockData[0], column.GetChunkBlockData(0, chunkZ), sizeof(BlockWorldBlockDataType) * GetReferenceBlockCount(0));
+        for (int32 bz = 0; bz < TEST_CHUNK_SIZE; bz++)
+        {
+            for (int32 by = 0; by < TEST_CHUNK_SIZE; by++)
+            {
+                for (int32 bx = 0; bx < TEST_CHUNK_SIZE; bx++)
+                    ReferenceUpdateLODs(&referenceChunk, 0, bx, by, bz);
+            }
+        }
+
+        for (int32 lodLevel = 0; lodLevel < TEST_LOD_LEVELS; lodLevel++)
+        {
+            uint32 blockCount = GetReferenceBlockCount(lodLevel);
+            const BlockWorldBlockType *pColumnValues = column.GetChunkBlockValues(lodLevel, chunkZ);
+            const BlockWorldBlockDataType *pColumnData = column.GetChunkBlockData(lodLevel, chunkZ);
+            uint32 mismatchCount = 0;
+            uint32 solidBlockCount = 0;
+            for (uint32 i = 0; i < blockCount; i++)
+            {
+                mismatchCount += (pColumnValues[i] != referenceChunk.pBlockValues[lodLevel][i] || pColumnData[i] != referenceChunk.pBlockData[lodLevel][i]) ? 1 : 0;
+                solidBlockCount += (referenceChunk.pBlockValues[lodLevel][i] != 0) ? 1 : 0;
+            }
+
+            bool passed = (mismatchCount == 0 && column.GetChunkSolidBlockCount(lodLevel, chunkZ) == solidBlockCount);
+            failureCount += (passed) ? 0 : 1;
+            Log_InfoPrintf("chunk z %i lod %i: %u mismatched blocks, %u solid blocks (column counted %u): %s",
+                           chunkZ, lodLevel, mismatchCount, solidBlockCount, column.GetChunkSolidBlockCount(lodLevel, chunkZ), (passed) ? "ok" : "FAILED");
+
+            delete[] referenceChunk.pBlockData[lodLevel];
+            delete[] referenceChunk.pBlockValues[lodLevel];
+        }
+    }
+
+    return failureCount;
+}
+
+int main_blockworldgeneration(int argc, char *argv[])
+{
+    Log::GetInstance().SetConsoleOutputParams(true);
+
+    uint32 failureCount = TestNoise();
+    failureCount += TestColumnLODs();
+    return (failureCount == 0) ? 0 : 1;
+}
@@ -0,0 +1,197 @@
+#include "Engine/Common.h"
+#include "BlockEngine/BlockWorldRayCast.h"
+#include "Core/RandomNumberGenerator.h"
+#include "YBaseLib/Timer.h"
+#include "YBaseLib/Log.h"
+Log_SetChannel(TestBlockWorldRayCast);
+
+// Compares the box sweep RayCastBlock used to do, testing every block of each chunk the ray touches, against the
+// grid traversal, over a generated terrain held in memory. A full BlockWorld needs the engine running, so the chunks
+// are supplied to the shared traversal directly, the same way BlockWorld does.
+
+static const int32 BENCHMARK_CHUNK_SIZE = 16;
+static const int32 BENCHMARK_CHUNK_COUNT_XY = 16;
+static const int32 BENCHMARK_CHUNK_COUNT_Z = 8;
+static const uint32 BENCHMARK_RAY_COUNT = 2000;
+static const float BENCHMARK_RAY_LENGTH = 192.0f;
+
+struct BenchmarkWorld
+{
+    BlockWorldBlockType *pChunks[BENCHMARK_CHUNK_COUNT_Z][BENCHMARK_CHUNK_COUNT_XY][BENCHMARK_CHUNK_COUNT_XY];
+
+    const BlockWorldBlockType *GetChunk(int32 chunkX, int32 chunkY, int32 chunkZ) const
+    {
+        if (chunkX < 0 || chunkY < 0 || chunkZ < 0 || chunkX >= BENCHMARK_CHUNK_COUNT_XY || chunkY >= BENCHMARK_CHUNK_COUNT_XY || chunkZ >= BENCHMARK_CHUNK_COUNT_Z)
+            return nullptr;
+
+        return pChunks[chunkZ][chunkY][chunkX];
+    }
+
+    AABox GetBounds() const
+    {
+        return AABox(float3::Zero, float3((float)(BENCHMARK_CHUNK_COUNT_XY * BENCHMARK_CHUNK_SIZE), (float)(BENCHMARK_CHUNK_COUNT_XY * BENCHMARK_CHUNK_SIZE), (float)(BENCHMARK_CHUNK_COUNT_Z * BENCHMARK_CHUNK_SIZE)));
+    }
+};
+
+static void GenerateWorld(BenchmarkWorld *pWorld, RandomNumberGenerator &rng)
+{
+    const int32 chunkBlockCount = BENCHMARK_CHUNK_SIZE * BENCHMARK_CHUNK_SIZE * BENCHMARK_CHUNK_SIZE;
+    for (int32 chunkZ = 0; chunkZ < BENCHMARK_CHUNK_COUNT_Z; chunkZ++)
+    {
+        for (int32 chunkY = 0; chunkY < BENCHMARK_CHUNK_COUNT_XY; chunkY++)
+        {
+            for (int32 chunkX = 0; chunkX < BENCHMARK_CHUNK_COUNT_XY; chunkX++)
+            {
+                BlockWorldBlockType *pBlocks = new BlockWorldBlockType[chunkBlockCount];
+                uint32 solidCount = 0;
+                for (int32 z = 0; z < BENCHMARK_CHUNK_SIZE; z++)
+                {
+                    for (int32 y = 0; y < BENCHMARK_CHUNK_SIZE; y++)
+                    {
+                        for (int32 x = 0; x < BENCHMARK_CHUNK_SIZE; x++)
+                        {
+                            // rolling hills, with a few floating blocks above them
+                            float worldX = (float)(chunkX * BENCHMARK_CHUNK_SIZE + x);
+                            float worldY = (float)(chunkY * BENCHMARK_CHUNK_SIZE + y);
+                            int32 worldZ = chunkZ * BENCHMARK_CHUNK_SIZE + z;
+                            int32 height = 32 + (int32)(Math::Sin(worldX * 0.05f) * 12.0f + Math::Cos(worldY * 0.07f) * 12.0f);
+                            bool solid = (worldZ < height) || (worldZ < height + 24 && (rng.NextUInt() % 512) == 0);
+
+                            BlockWorldBlockType &blockValue = pBlocks[(z * BENCHMARK_CHUNK_SIZE + y) * BENCHMARK_CHUNK_SIZE + x];
+                            blockValue = (solid) ? (BlockWorldBlockType)(1 + (worldZ % 7)) : 0;
+                            solidCount += (solid) ? 1 : 0;
+                        }
+                    }
+                }
+
+                if (solidCount == 0)
+                {
+                    delete[] pBlocks;
+                    pBlocks = nullptr;
+                }
+
+                pWorld->pChunks[chunkZ][chunkY][chunkX] = pBlocks;
+            }
+        }
+    }
+}
+
+static void FreeWorld(BenchmarkWorld *pWorld)
+{
+    for (int32 chunkZ = 0; chunkZ < BENCHMARK_CHUNK_COUNT_Z; chunkZ++)
+    {
+        for (int32 chunkY = 0; chunkY < BENCHMARK_CHUNK_COUNT_XY; chunkY++)
+        {
+            for (int32 chunkX = 0; chunkX < BENCHMARK_CHUNK_COUNT_XY; chunkX++)
+                delete[] pWorld->pChunks[chunkZ][chunkY][chunkX];
+        }
+    }
+}
+
+static bool SweepRay(const BenchmarkWorld *pWorld, const Ray &ray, BlockWorldRayCastResult *pResult)
+{
+    pResult->Hit = false;
+    pResult->Distance = Y_FLT_MAX;
+
+    for (int32 chunkZ = 0; chunkZ < BENCHMARK_CHUNK_COUNT_Z; chunkZ++)
+    {
+        for (int32 chunkY = 0; chunkY < BENCHMARK_CHUNK_COUNT_XY; chunkY++)
+        {
+            for (int32 chunkX = 0; chunkX < BENCHMARK_CHUNK_COUNT_XY; chunkX++)
+            {
+                const BlockWorldBlockType *pBlocks = pWorld->pChunks[chunkZ][chunkY][chunkX];
+                if (pBlocks == nullptr)
+                    continue;
+
+                float3 chunkMinBounds((float)(chunkX * BENCHMARK_CHUNK_SIZE), (float)(chunkY * BENCHMARK_CHUNK_SIZE), (float)(chunkZ * BENCHMARK_CHUNK_SIZE));
+                float3 chunkMaxBounds(chunkMinBounds + float3((float)BENCHMARK_CHUNK_SIZE, (float)BENCHMARK_CHUNK_SIZE, (float)BENCHMARK_CHUNK_SIZE));
+                if (!ray.AABoxIntersection(chunkMinBounds, chunkMaxBounds))
+                    continue;
+
+                for (int32 z = 0; z < BENCHMARK_CHUNK_SIZE; z++)
+                {
+                    for (int32 y = 0; y < BENCHMARK_CHUNK_SIZE; y++)
+                    {
+                        for (int32 x = 0; x < BENCHMARK_CHUNK_SIZE; x++)
+                        {
+                            BlockWorldBlockType blockValue = pBlocks[(z * BENCHMARK_CHUNK_SIZE + y) * BENCHMARK_CHUNK_SIZE + x];
+                            if (blockValue == 0)
+                                continue;
+
+                            float3 blockMinBounds(chunkMinBounds + float3((float)x, (float)y, (float)z));
+                            float contactTime;
+                            CUBE_FACE contactFace;
+                            if (ray.AABoxIntersectionTimeFace(blockMinBounds, blockMinBounds + float3::One, &contactTime, &contactFace) && contactTime < pResult->Distance)
+                            {
+                                pResult->Hit = true;
+                                pResult->BlockX = chunkX * BENCHMARK_CHUNK_SIZE + x;
+                                pResult->BlockY = chunkY * BENCHMARK_CHUNK_SIZE + y;
+                                pResult->BlockZ = chunkZ * BENCHMARK_CHUNK_SIZE + z;
+                                pResult->BlockFace = contactFace;
+                                pResult->BlockValue = blockValue;
+                                pResult->Distance = contactTime;
+                            }
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    return pResult->Hit;
+}
+
+int main_blockworldraycast(int argc, char *argv[])
+{
+    Log::GetInstance().SetConsoleOutputParams(true);
+
+    RandomNumberGenerator rng(BENCHMARK_RAY_COUNT);
+    BenchmarkWorld world;
+    GenerateWorld(&world, rng);
+
+    // rays from above the terrain, mostly looking down at it
+    Ray *pRays = new Ray[BENCHMARK_RAY_COUNT];
+    float worldSize = (float)(BENCHMARK_CHUNK_COUNT_XY * BENCHMARK_CHUNK_SIZE);
+    for (uint32 i = 0; i < BENCHMARK_RAY_COUNT; i++)
+    {
+        float3 origin(rng.NextRangeFloat(0.0f, worldSize), rng.NextRangeFloat(0.0f, worldSize), rng.NextRangeFloat(48.0f, 80.0f));
+        float3 direction(rng.NextRangeFloat(-1.0f, 1.0f), rng.NextRangeFloat(-1.0f, 1.0f), rng.NextRangeFloat(-1.0f, 0.25f));
+        pRays[i] = Ray(origin, direction.Normalize(), BENCHMARK_RAY_LENGTH);
+    }
+
+    BlockWorldRayCastResult *pSweepResults = new BlockWorldRayCastResult[BENCHMARK_RAY_COUNT];
+    BlockWorldRayCastResult *pTraceResults = new BlockWorldRayCastResult[BENCHMARK_RAY_COUNT];
+    AABox worldBounds(world.GetBounds());
+    auto lookupChunk = [&world](int32 chunkX, int32 chunkY, int32 chunkZ) { return world.GetChunk(chunkX, chunkY, chunkZ); };
+
+    Timer sweepTimer;
+    for (uint32 i = 0; i < BENCHMARK_RAY_COUNT; i++)
+        SweepRay(&world, pRays[i], &pSweepResults[i]);
+    double sweepTime = sweepTimer.GetTimeMilliseconds();
+
+    Timer traceTimer;
+    for (uint32 i = 0; i < BENCHMARK_RAY_COUNT; i++)
+        BlockWorldRayCast::TraceRay(pRays[i], worldBounds, BENCHMARK_CHUNK_SIZE, lookupChunk, &pTraceResults[i]);
+    double traceTime = traceTimer.GetTimeMilliseconds();
+
+    // rays that graze an edge can hit either block at the same distance, so compare the distances
+    uint32 hitCount = 0;
+    uint32 mismatchCount = 0;
+    for (uint32 i = 0; i < BENCHMARK_RAY_COUNT; i++)
+    {
+        const BlockWorldRayCastResult &sweepResult = pSweepResults[i];
+        const BlockWorldRayCastResult &traceResult = pTraceResults[i];
+        hitCount += (sweepResult.Hit) ? 1 : 0;
+        if (sweepResult.Hit != traceResult.Hit || (sweepResult.Hit && Math::Abs(sweepResult.Distance - traceResult.Distance) > 0.001f))
+            mismatchCount++;
+    }
+
+    Log_InfoPrintf("%u rays, %u hits: box sweep %.4fms, grid traversal %.4fms (%.2fx), %u mismatches",
+                   BENCHMARK_RAY_COUNT, hitCount, sweepTime, traceTime, sweepTime / traceTime, mismatchCount);
+
+    delete[] pTraceResults;
+    delete[] pSweepResults;
+    delete[] pRays;
+    FreeWorld(&world);
+    return (mismatchCount == 0) ? 0 : 1;
+}
@@ -0,0 +1,196 @@
+#include "Renderer/Common.h"
+#include "Renderer/SkeletalMeshSkinning.h"
+#include "Core/RandomNumberGenerator.h"
+#include "YBaseLib/Timer.h"
+#include "YBaseLib/Log.h"
+Log_SetChannel(TestCPUSkinning);
+
+// Compares the scalar skinning SkeletalMeshRenderProxy used to do, transforming each attribute by every weighted
+// bone, against the blended column matrices, on a single thread. Pose concatenation is measured the same way.
+
+static const uint32 BENCHMARK_ITERATIONS = 20;
+static const uint32 BENCHMARK_BONE_COUNT = 64;
+
+typedef SkeletalMeshVertexFactory::Vertex Vertex;
+
+static Transform MakeRandomTransform(RandomNumberGenerator &rng)
+{
+    return Transform(float3(rng.NextRangeFloat(-2.0f, 2.0f), rng.NextRangeFloat(-2.0f, 2.0f), rng.NextRangeFloat(-2.0f, 2.0f)),
+                     Quaternion::FromEulerAngles(float3(rng.NextRangeFloat(-180.0f, 180.0f), rng.NextRangeFloat(-180.0f, 180.0f), rng.NextRangeFloat(-180.0f, 180.0f))),
+                     float3::One);
+}
+
+static float3 MakeRandomDirection(RandomNumberGenerator &rng)
+{
+    float3 direction(rng.NextRangeFloat(-1.0f, 1.0f), rng.NextRangeFloat(-1.0f, 1.0f), rng.NextRangeFloat(-1.0f, 1.0f));
+    direction.SafeNormalizeInPlace();
+    return direction;
+}
+
+// the old per-vertex loop
+static void SkinVerticesScalar(Vertex *pDestinationVertex, const Vertex *pSourceVertex, uint32 vertexCount, uint32 weightCount, const float3x4 *pBoneTransforms)
+{
+    for (uint32 vertexIndex = 0; vertexIndex < vertexCount; vertexIndex++, pSourceVertex++, pDestinationVertex++)
+    {
+        pDestinationVertex->Position = float3::Zero;
+        pDestinationVertex->TangentX = float3::Zero;
+        pDestinationVertex->TangentY = float3::Zero;
+        pDestinationVertex->TangentZ = float3::Zero;
+        for (uint32 weightIndex = 0; weightIndex < weightCount; weightIndex++)
+        {
+            const float3x4 *pBoneTransform = &pBoneTransforms[pSourceVertex->BoneIndices[weightIndex]];
+            float boneWeight = pSourceVertex->BoneWeights[weightIndex];
+            pDestinationVertex->Position += pBoneTransform->TransformPoint(pSourceVertex->Position) * boneWeight;
+            pDestinationVertex->TangentX += pBoneTransform->TransformNormal(pSourceVertex->TangentX) * boneWeight;
+            pDestinationVertex->TangentY += pBoneTransform->TransformNormal(pSourceVertex->TangentY) * boneWeight;
+            pDestinationVertex->TangentZ += pBoneTransform->TransformNormal(pSourceVertex->TangentZ) * boneWeight;
+        }
+
+        pDestinationVertex->TangentX.SafeNormalizeInPlace();
+        pDestinationVertex->TangentY.SafeNormalizeInPlace();
+        pDestinationVertex->TangentZ.SafeNormalizeInPlace();
+        pDestinationVertex->TexCoord = pSourceVertex->TexCoord;
+        pDestinationVertex->Color = pSourceVertex->Color;
+    }
+}
+
+static void RunPoseBenchmark()
+{
+    RandomNumberGenerator rng(BENCHMARK_BONE_COUNT);
+    MemArray<Transform> localToBoneTransforms;
+    MemArray<Transform> poseTransforms;
+    MemArray<SkeletalMeshSkinning::BoneMatrix> localToBoneMatrices;
+    localToBoneTransforms.Resize(BENCHMARK_BONE_COUNT);
+    poseTransforms.Resize(BENCHMARK_BONE_COUNT);
+    localToBoneMatrices.Resize(BENCHMARK_BONE_COUNT);
+    for (uint32 i = 0; i < BENCHMARK_BONE_COUNT; i++)
+    {
+        localToBoneTransforms[i] = MakeRandomTransform(rng);
+        poseTransforms[i] = MakeRandomTransform(rng);
+        SkeletalMeshSkinning::SetBoneMatrix(&localToBoneMatrices[i], localToBoneTransforms[i].GetTransformMatrix3x4());
+    }
+
+    // pose rebuilt many times, as each animated proxy does every frame
+    static const uint32 POSE_REPEAT_COUNT = 1000;
+    MemArray<float3x4> scalarMatrices;
+    MemArray<float3x4> simdMatrices;
+    scalarMatrices.Resize(BENCHMARK_BONE_COUNT);
+    simdMatrices.Resize(BENCHMARK_BONE_COUNT);
+
+    Timer timer;
+    for (uint32 repeat = 0; repeat < POSE_REPEAT_COUNT; repeat++)
+    {
+        for (uint32 i = 0; i < BENCHMARK_BONE_COUNT; i++)
+            scalarMatrices[i] = Transform::ConcatenateTransforms(localToBoneTransforms[i], poseTransforms[i]).GetTransformMatrix3x4();
+    }
+    double scalarTime = timer.GetTimeMilliseconds();
+
+    timer.Reset();
+    for (uint32 repeat = 0; repeat < POSE_REPEAT_COUNT; repeat++)
+    {
+        for (uint32 i = 0; i < BENCHMARK_BONE_COUNT; i++)
+        {
+            SkeletalMeshSkinning::BoneMatrix poseMatrix;
+            SkeletalMeshSkinning::BoneMatrix skinningMatrix;
+            SkeletalMeshSkinning::SetBoneMatrix(&poseMatrix, poseTransforms[i].GetTransformMatrix3x4());
+            SkeletalMeshSkinning::ConcatenateBoneMatrices(&skinningMatrix, poseMatrix, localToBoneMatrices[i]);
+            SkeletalMeshSkinning::GetBoneMatrix(&simdMatrices[i], skinningMatrix);
+        }
+    }
+    double simdTime = timer.GetTimeMilliseconds();
+
+    float maxError = 0.0f;
+    for (uint32 i = 0; i < BENCHMARK_BONE_COUNT; i++)
+    {
+        for (uint32 row = 0; row < 3; row++)
+        {
+            for (uint32 column = 0; column < 4; column++)
+                maxError = Max(maxError, Y_fabs(scalarMatrices[i].Row[row][column] - simdMatrices[i].Row[row][column]));
+        }
+    }
+
+    Log_InfoPrintf("%u bones x %u poses: concatenate transforms %.4fms, bone matrices %.4fms, max error %f",
+                   BENCHMARK_BONE_COUNT, POSE_REPEAT_COUNT, scalarTime, simdTime, maxError);
+}
+
+static void RunSkinningBenchmark(uint32 vertexCount, uint32 weightCount)
+{
+    RandomNumberGenerator rng(vertexCount * weightCount);
+
+    // random pose, in both forms
+    MemArray<float3x4> boneTransforms;
+    MemArray<SkeletalMeshSkinning::BoneMatrix> boneMatrices;
+    boneTransforms.Resize(BENCHMARK_BONE_COUNT);
+    boneMatrices.Resize(BENCHMARK_BONE_COUNT);
+    for (uint32 i = 0; i < BENCHMARK_BONE_COUNT; i++)
+    {
+        boneTransforms[i] = MakeRandomTransform(rng).GetTransformMatrix3x4();
+        SkeletalMeshSkinning::SetBoneMatrix(&boneMatrices[i], boneTransforms[i]);
+    }
+
+    // vertices with normalized weights
+    MemArray<Vertex> sourceVertices;
+    sourceVertices.Resize(vertexCount);
+    sourceVertices.ZeroContents();
+    for (uint32 i = 0; i < vertexCount; i++)
+    {
+        Vertex &vertex = sourceVertices[i];
+        vertex.Position.Set(rng.NextRangeFloat(-1.0f, 1.0f), rng.NextRangeFloat(0.0f, 2.0f), rng.NextRangeFloat(-1.0f, 1.0f));
+        vertex.TangentX = MakeRandomDirection(rng);
+        vertex.TangentY = MakeRandomDirection(rng);
+        vertex.TangentZ = MakeRandomDirection(rng);
+
+        float weightSum = 0.0f;
+        for (uint32 j = 0; j < weightCount; j++)
+        {
+            vertex.BoneIndices[j] = (uint8)rng.NextRangeUInt(0, BENCHMARK_BONE_COUNT - 1);
+            vertex.BoneWeights[j] = rng.NextRangeFloat(0.1f, 1.0f);
+            weightSum += vertex.BoneWeights[j];
+        }
+        for (uint32 j = 0; j < weightCount; j++)
+            vertex.BoneWeights[j] /= weightSum;
+    }
+
+    MemArray<Vertex> scalarVertices;
+    MemArray<Vertex> simdVertices;
+    scalarVertices.Resize(vertexCount);
+    simdVertices.Resize(vertexCount);
+
+    Timer timer;
+    double scalarTime = 0.0;
+    double simdTime = 0.0;
+    for (uint32 iteration = 0; iteration < BENCHMARK_ITERATIONS; iteration++)
+    {
+        timer.Reset();
+        SkinVerticesScalar(scalarVertices.GetBasePointer(), sourceVertices.GetBasePointer(), vertexCount, weightCount, boneTransforms.GetBasePointer());
+        scalarTime += timer.GetTimeMilliseconds();
+
+        timer.Reset();
+        SkeletalMeshSkinning::SkinVertices(simdVertices.GetBasePointer(), sourceVertices.GetBasePointer(), vertexCount, weightCount, boneMatrices.GetBasePointer());
+        simdTime += timer.GetTimeMilliseconds();
+    }
+
+    float maxError = 0.0f;
+    for (uint32 i = 0; i < vertexCount; i++)
+    {
+        maxError = Max(maxError, (scalarVertices[i].Position - simdVertices[i].Position).Length());
+        maxError = Max(maxError, (scalarVertices[i].TangentZ - simdVertices[i].TangentZ).Length());
+    }
+
+    scalarTime /= (double)BENCHMARK_ITERATIONS;
+    simdTime /= (double)BENCHMARK_ITERATIONS;
+    Log_InfoPrintf("%u vertices, %u weights: scalar %.4fms (%.0f vertices/ms), blended %.4fms (%.0f vertices/ms), max error %f",
+                   vertexCount, weightCount, scalarTime, (double)vertexCount / scalarTime, simdTime, (double)vertexCount / simdTime, maxError);
+}
+
+int main_cpuskinning(int argc, char *argv[])
+{
+    Log::GetInstance().SetConsoleOutputParams(true);
+
+    RunPoseBenchmark();
+    RunSkinningBenchmark(10000, 1);
+    RunSkinningBenchmark(10000, 2);
+    RunSkinningBenchmark(10000, 4);
+    RunSkinningBenchmark(100000, 4);
+    return 0;
+}
@@ -0,0 +1,86 @@
+#include "Core/Common.h"
+#include "Core/Image.h"
+#include "Core/ImageResampler.h"
+#include "Core/RandomNumberGenerator.h"
+#include "YBaseLib/Timer.h"
+#include "YBaseLib/Log.h"
+Log_SetChannel(TestImageResampler);
+
+// Builds the mip chains of a cube map the way the texture generator does, filtering every level from the base image on
+// one thread, against cascaded chains spread across threads. Differences per level come from the cascade re-filtering.
+
+static const uint32 BENCHMARK_FACE_COUNT = 6;
+static const uint32 BENCHMARK_SIZE = 1024;
+static const uint32 BENCHMARK_MIP_COUNT = 11;
+
+static bool BuildMipChains(IMAGE_RESIZE_FILTER filter, bool cascade, uint32 threadCount, const Image *pBaseImages, Image *pMipImages, double *pTime)
+{
+    ImageResampler::MipChainJob jobs[BENCHMARK_FACE_COUNT];
+    for (uint32 i = 0; i < BENCHMARK_FACE_COUNT; i++)
+    {
+        jobs[i].pBaseImage = &pBaseImages[i];
+        jobs[i].pMipImages = &pMipImages[i * BENCHMARK_MIP_COUNT];
+        jobs[i].MipCount = BENCHMARK_MIP_COUNT;
+    }
+
+    Timer timer;
+    bool result = ImageResampler::GenerateMipChains(filter, true, cascade, jobs, BENCHMARK_FACE_COUNT, threadCount);
+    *pTime = timer.GetTimeMilliseconds();
+    return result;
+}
+
+static void RunMipChainBenchmark(IMAGE_RESIZE_FILTER filter, const Image *pBaseImages)
+{
+    Image *pDirectMips = new Image[BENCHMARK_FACE_COUNT * BENCHMARK_MIP_COUNT];
+    Image *pCascadedMips = new Image[BENCHMARK_FACE_COUNT * BENCHMARK_MIP_COUNT];
+
+    double directTime, cascadedTime;
+    if (!BuildMipChains(filter, false, 1, pBaseImages, pDirectMips, &directTime) ||
+        !BuildMipChains(filter, true, 0, pBaseImages, pCascadedMips, &cascadedTime))
+    {
+        Log_ErrorPrintf("%s: mip chain generation failed", NameTable_GetNameString(NameTables::ImageResizeFilter, filter));
+        delete[] pCascadedMips;
+        delete[] pDirectMips;
+        return;
+    }
+
+    Log_InfoPrintf("%s: direct on one thread %.4fms, cascaded on all threads %.4fms (%.2fx)",
+                   NameTable_GetNameString(NameTables::ImageResizeFilter, filter), directTime, cascadedTime, directTime / cascadedTime);
+
+    for (uint32 level = 1; level < BENCHMARK_MIP_COUNT; level++)
+    {
+        uint32 maxDifference = 0;
+        for (uint32 face = 0; face < BENCHMARK_FACE_COUNT; face++)
+        {
+            const Image &directImage = pDirectMips[face * BENCHMARK_MIP_COUNT + level];
+            const Image &cascadedImage = pCascadedMips[face * BENCHMARK_MIP_COUNT + level];
+            for (uint32 i = 0; i < directImage.GetDataSize(); i++)
+                maxDifference = Max(maxDifference, (uint32)Math::Abs((int32)directImage.GetData()[i] - (int32)cascadedImage.GetData()[i]));
+        }
+
+        Log_InfoPrintf("  level %u (%ux%u): max difference %u", level, pDirectMips[level].GetWidth(), pDirectMips[level].GetHeight(), maxDifference);
+    }
+
+    delete[] pCascadedMips;
+    delete[] pDirectMips;
+}
+
+int main_imageresampler(int argc, char *argv[])
+{
+    Log::GetInstance().SetConsoleOutputParams(true);
+
+    RandomNumberGenerator rng(BENCHMARK_SIZE);
+    Image baseImages[BENCHMARK_FACE_COUNT];
+    for (uint32 face = 0; face < BENCHMARK_FACE_COUNT; face++)
+    {
+        baseImages[face].Create(PIXEL_FORMAT_R8G8B8A8_UNORM, BENCHMARK_SIZE, BENCHMARK_SIZE, 1);
+        for (uint32 i = 0; i < baseImages[face].GetDataSize(); i++)
+            baseImages[face].GetData()[i] = (byte)rng.NextUInt();
+    }
+
+    RunMipChainBenchmark(IMAGE_RESIZE_FILTER_BOX, baseImages);
+    RunMipChainBenchmark(IMAGE_RESIZE_FILTER_BILINEAR, baseImages);
+    RunMipChainBenchmark(IMAGE_RESIZE_FILTER_LANCZOS3, baseImages);
+    RunMipChainBenchmark(IMAGE_RESIZE_FILTER_KAISER, baseImages);
+    return 0;
+}
@@ -0,0 +1,183 @@
+#include "Engine/Common.h"
+#include "Core/MeshUtilties.h"
+#include "YBaseLib/Timer.h"
+#include "YBaseLib/Log.h"
+Log_SetChannel(TestMeshSimplification);
+
+// Runs the quadric simplifier the resource compiler builds static mesh lods with over a unit sphere, with a texture
+// seam down one side and a fan of separate vertices at each pole as exporters tend to write them. Checks that each
+// ratio is reached, that no triangle ends up facing into the sphere, and that the volume stays close.
+// Then over a finely divided cube with separate vertices for each face, as hard edges are written. Checks that it
+// reaches each ratio, and that no triangle ends up using vertices of two faces.
+
+static const uint32 SPHERE_RINGS = 64;
+static const uint32 SPHERE_SEGMENTS = 128;
+
+static void CreateSphere(MemArray<float3> &vertices, MemArray<uint32> &indices)
+{
+    for (uint32 ring = 0; ring <= SPHERE_RINGS; ring++)
+    {
+        for (uint32 segment = 0; segment <= SPHERE_SEGMENTS; segment++)
+        {
+            float theta = Y_PI * (float)ring / (float)SPHERE_RINGS;
+            float phi = 2.0f * Y_PI * (float)(segment % SPHERE_SEGMENTS) / (float)SPHERE_SEGMENTS;
+            vertices.Add(float3(Math::Sin(theta) * Math::Cos(phi), Math::Sin(theta) * Math::Sin(phi), Math::Cos(theta)));
+        }
+    }
+
+    for (uint32 ring = 0; ring < SPHERE_RINGS; ring++)
+    {
+        for (uint32 segment = 0; segment < SPHERE_SEGMENTS; segment++)
+        {
+            uint32 i0 = ring * (SPHERE_SEGMENTS + 1) + segment;
+            uint32 i1 = i0 + 1;
+            uint32 i2 = i0 + SPHERE_SEGMENTS + 1;
+            uint32 i3 = i2 + 1;
+            if (ring > 0)
+            {
+                indices.Add(i0);
+                indices.Add(i2);
+                indices.Add(i1);
+            }
+            if (ring < (SPHERE_RINGS - 1))
+            {
+                indices.Add(i1);
+                indices.Add(i2);
+                indices.Add(i3);
+            }
+        }
+    }
+}
+
+static const uint32 CUBE_FACE_DIVISIONS = 16;
+
+// each face has its own grid of vertices, running counter-clockwise seen from outside
+static void CreateCube(MemArray<float3> &vertices, MemArray<uint32> &indices)
+{
+    static const float3 faceNormals[6] = { float3(1.0f, 0.0f, 0.0f), float3(-1.0f, 0.0f, 0.0f), float3(0.0f, 1.0f, 0.0f), float3(0.0f, -1.0f, 0.0f), float3(0.0f, 0.0f, 1.0f), float3(0.0f, 0.0f, -1.0f) };
+    static const float3 faceAxisU[6] = { float3(0.0f, 1.0f, 0.0f), float3(0.0f, 0.0f, 1.0f), float3(0.0f, 0.0f, 1.0f), float3(1.0f, 0.0f, 0.0f), float3(1.0f, 0.0f, 0.0f), float3(0.0f, 1.0f, 0.0f) };
+    for (uint32 face = 0; face < 6; face++)
+    {
+        float3 axisV(faceNormals[face].Cross(faceAxisU[face]));
+        uint32 baseVertex = vertices.GetSize();
+        for (uint32 v = 0; v <= CUBE_FACE_DIVISIONS; v++)
+        {
+            for (uint32 u = 0; u <= CUBE_FACE_DIVISIONS; u++)
+            {
+                float fu = 2.0f * (float)u / (float)CUBE_FACE_DIVISIONS - 1.0f;
+                float fv = 2.0f * (float)v / (float)CUBE_FACE_DIVISIONS - 1.0f;
+                vertices.Add(faceNormals[face] + faceAxisU[face] * fu + axisV * fv);
+            }
+        }
+
+        for (uint32 v = 0; v < CUBE_FACE_DIVISIONS; v++)
+        {
+            for (uint32 u = 0; u < CUBE_FACE_DIVISIONS; u++)
+            {
+                uint32 i0 = baseVertex + v * (CUBE_FACE_DIVISIONS + 1) + u;
+                uint32 i1 = i0 + 1;
+                uint32 i2 = i0 + CUBE_FACE_DIVISIONS + 1;
+                uint32 i3 = i2 + 1;
+                indices.Add(i0);
+                indices.Add(i1);
+                indices.Add(i3);
+                indices.Add(i0);
+                indices.Add(i3);
+                indices.Add(i2);
+            }
+        }
+    }
+}
+
+static uint32 TestCube()
+{
+    MemArray<float3> vertices;
+    MemArray<uint32> indices;
+    CreateCube(vertices, indices);
+
+    uint32 triangleCount = indices.GetSize() / 3;
+    uint32 faceVertexCount = (CUBE_FACE_DIVISIONS + 1) * (CUBE_FACE_DIVISIONS + 1);
+    MemArray<uint32> outIndices;
+    outIndices.Resize(indices.GetSize());
+
+    static const float ratios[] = { 0.5f, 0.25f, 0.1f };
+    uint32 failureCount = 0;
+    for (uint32 ratioIndex = 0; ratioIndex < countof(ratios); ratioIndex++)
+    {
+        uint32 targetTriangleCount = (uint32)((float)triangleCount * ratios[ratioIndex]);
+        uint32 outTriangleCount = MeshUtilites::SimplifyMesh(vertices.GetBasePointer(), sizeof(float3), vertices.GetSize(),
+                                                             indices.GetBasePointer(), sizeof(uint32) * 3, triangleCount,
+                                                             nullptr, targetTriangleCount, Y_FLT_MAX,
+                                                             outIndices.GetBasePointer(), sizeof(uint32) * 3, nullptr);
+
+        uint32 mixedFaceCount = 0;
+        float volume = 0.0f;
+        for (uint32 i = 0; i < outTriangleCount; i++)
+        {
+            uint32 face = outIndices[i * 3 + 0] / faceVertexCount;
+            if ((outIndices[i * 3 + 1] / faceVertexCount) != face || (outIndices[i * 3 + 2] / faceVertexCount) != face)
+                mixedFaceCount++;
+
+            const float3 &p0 = vertices[outIndices[i * 3 + 0]];
+            const float3 &p1 = vertices[outIndices[i * 3 + 1]];
+            const float3 &p2 = vertices[outIndices[i * 3 + 2]];
+            volume += p0.Dot(p1.Cross(p2)) / 6.0f;
+        }
+
+        // a collapse along an edge of the cube removes a triangle from each face, so it can step over the target by one
+        bool passed = (outTriangleCount <= targetTriangleCount && (outTriangleCount + 2) >= targetTriangleCount && mixedFaceCount == 0 && Math::Abs(volume - 8.0f) < 0.001f);
+        failureCount += (passed) ? 0 : 1;
+        Log_InfoPrintf("cube ratio %.2f: %u -> %u triangles (target %u), %u across faces, volume %.4f of 8: %s",
+                       ratios[ratioIndex], triangleCount, outTriangleCount, targetTriangleCount, mixedFaceCount, volume, (passed) ? "ok" : "FAILED");
+    }
+
+    return failureCount;
+}
+
+int main_meshsimplification(int argc, char *argv[])
+{
+    Log::GetInstance().SetConsoleOutputParams(true);
+
+    MemArray<float3> vertices;
+    MemArray<uint32> indices;
+    CreateSphere(vertices, indices);
+
+    uint32 triangleCount = indices.GetSize() / 3;
+    MemArray<uint32> outIndices;
+    outIndices.Resize(indices.GetSize());
+
+    static const float ratios[] = { 0.5f, 0.25f, 0.1f };
+    float sphereVolume = 4.0f / 3.0f * Y_PI;
+    uint32 failureCount = TestCube();
+    for (uint32 ratioIndex = 0; ratioIndex < countof(ratios); ratioIndex++)
+    {
+        uint32 targetTriangleCount = (uint32)((float)triangleCount * ratios[ratioIndex]);
+
+        Timer timer;
+        uint32 outTriangleCount = MeshUtilites::SimplifyMesh(vertices.GetBasePointer(), sizeof(float3), vertices.GetSize(),
+                                                             indices.GetBasePointer(), sizeof(uint32) * 3, triangleCount,
+                                                             nullptr, targetTriangleCount, Y_FLT_MAX,
+                                                             outIndices.GetBasePointer(), sizeof(uint32) * 3, nullptr);
+        double simplifyTime = timer.GetTimeMilliseconds();
+
+        uint32 inwardCount = 0;
+        float volume = 0.0f;
+        for (uint32 i = 0; i < outTriangleCount; i++)
+        {
+            const float3 &p0 = vertices[outIndices[i * 3 + 0]];
+            const float3 &p1 = vertices[outIndices[i * 3 + 1]];
+            const float3 &p2 = vertices[outIndices[i * 3 + 2]];
+            if ((p1 - p0).Cross(p2 - p0).Dot(p0) <= 0.0f)
+                inwardCount++;
+
+            volume += p0.Dot(p1.Cross(p2)) / 6.0f;
+        }
+
+        bool passed = (outTriangleCount == targetTriangleCount && inwardCount == 0 && Math::Abs(volume - sphereVolume) < (sphereVolume * 0.02f));
+        failureCount += (passed) ? 0 : 1;
+        Log_InfoPrintf("ratio %.2f: %u -> %u triangles (target %u) in %.4fms, %u facing inward, volume %.4f of %.4f: %s",
+                       ratios[ratioIndex], triangleCount, outTriangleCount, targetTriangleCount, simplifyTime, inwardCount, volume, sphereVolume, (passed) ? "ok" : "FAILED");
+    }
+
+    return (failureCount == 0) ? 0 : 1;
+}
@@ -0,0 +1,108 @@
+#include "Core/Common.h"
+#include "Core/PixelFormat.h"
+#include "Core/RandomNumberGenerator.h"
+#include "YBaseLib/Timer.h"
+#include "YBaseLib/Log.h"
+Log_SetChannel(TestPixelConversion);
+
+// Compares the decode/encode path through R32G32B32A32 pixels, as every conversion used to take, against the direct
+// converters PixelFormat_ConvertPixels now picks for common pairs. The outputs are expected to match.
+
+static const uint32 BENCHMARK_ITERATIONS = 10;
+static const uint32 BENCHMARK_WIDTH = 2048;
+static const uint32 BENCHMARK_HEIGHT = 2048;
+
+static void FillSourcePixels(byte *pPixels, uint32 size, PIXEL_FORMAT format, RandomNumberGenerator &rng)
+{
+    // float formats get values in the unorm range, so the 8-bit destinations don't saturate
+    if (format == PIXEL_FORMAT_R32G32B32A32_FLOAT || format == PIXEL_FORMAT_R32_FLOAT)
+    {
+        float *pValues = reinterpret_cast<float *>(pPixels);
+        for (uint32 i = 0; i < size / sizeof(float); i++)
+            pValues[i] = rng.NextUniformFloat();
+    }
+    else if (format == PIXEL_FORMAT_R16G16B16A16_FLOAT || format == PIXEL_FORMAT_R16_FLOAT)
+    {
+        uint16 *pValues = reinterpret_cast<uint16 *>(pPixels);
+        for (uint32 i = 0; i < size / sizeof(uint16); i++)
+            pValues[i] = Math::FloatToHalf(rng.NextUniformFloat());
+    }
+    else
+    {
+        for (uint32 i = 0; i < size; i++)
+            pPixels[i] = (byte)rng.NextUInt();
+    }
+}
+
+static void RunConversionBenchmark(PIXEL_FORMAT sourceFormat, PIXEL_FORMAT destinationFormat)
+{
+    RandomNumberGenerator rng(sourceFormat * PIXEL_FORMAT_COUNT + destinationFormat);
+    uint32 sourcePitch = PixelFormat_CalculateRowPitch(sourceFormat, BENCHMARK_WIDTH);
+    uint32 sourceSize = PixelFormat_CalculateImageSize(sourceFormat, BENCHMARK_WIDTH, BENCHMARK_HEIGHT, 1);
+    uint32 destinationPitch = PixelFormat_CalculateRowPitch(destinationFormat, BENCHMARK_WIDTH);
+    uint32 destinationSize = PixelFormat_CalculateImageSize(destinationFormat, BENCHMARK_WIDTH, BENCHMARK_HEIGHT, 1);
+
+    byte *pSourcePixels = Y_mallocT<byte>(sourceSize);
+    byte *pFloatPathPixels = Y_mallocT<byte>(destinationSize);
+    byte *pDirectPixels = Y_mallocT<byte>(destinationSize);
+    FillSourcePixels(pSourcePixels, sourceSize, sourceFormat, rng);
+
+    Timer timer;
+    double floatPathTime = 0.0;
+    double directTime = 0.0;
+    for (uint32 iteration = 0; iteration < BENCHMARK_ITERATIONS; iteration++)
+    {
+        uint32 outputSize = destinationSize;
+        timer.Reset();
+        if (!PixelFormat_ConvertPixelsThroughFloat(BENCHMARK_WIDTH, BENCHMARK_HEIGHT, pSourcePixels, sourcePitch, sourceFormat, pFloatPathPixels, destinationPitch, destinationFormat, &outputSize))
+        {
+            Log_ErrorPrintf("%s -> %s: float path conversion failed", PixelFormat_GetPixelFormatName(sourceFormat), PixelFormat_GetPixelFormatName(destinationFormat));
+            break;
+        }
+        floatPathTime += timer.GetTimeMilliseconds();
+
+        outputSize = destinationSize;
+        timer.Reset();
+        if (!PixelFormat_ConvertPixels(BENCHMARK_WIDTH, BENCHMARK_HEIGHT, pSourcePixels, sourcePitch, sourceFormat, pDirectPixels, destinationPitch, destinationFormat, &outputSize))
+        {
+            Log_ErrorPrintf("%s -> %s: direct conversion failed", PixelFormat_GetPixelFormatName(sourceFormat), PixelFormat_GetPixelFormatName(destinationFormat));
+            break;
+        }
+        directTime += timer.GetTimeMilliseconds();
+    }
+
+    // compared bytewise, a half-float rounding difference shows up as a mismatch
+    uint32 mismatchedBytes = 0;
+    for (uint32 i = 0; i < destinationSize; i++)
+    {
+        if (pFloatPathPixels[i] != pDirectPixels[i])
+            mismatchedBytes++;
+    }
+
+    floatPathTime /= (double)BENCHMARK_ITERATIONS;
+    directTime /= (double)BENCHMARK_ITERATIONS;
+    Log_InfoPrintf("%s -> %s: float path %.4fms, direct %.4fms (%.2fx), %u mismatched bytes",
+                   PixelFormat_GetPixelFormatName(sourceFormat), PixelFormat_GetPixelFormatName(destinationFormat),
+                   floatPathTime, directTime, floatPathTime / directTime, mismatchedBytes);
+
+    Y_free(pDirectPixels);
+    Y_free(pFloatPathPixels);
+    Y_free(pSourcePixels);
+}
+
+int main_pixelconversion(int argc, char *argv[])
+{
+    Log::GetInstance().SetConsoleOutputParams(true);
+
+    RunConversionBenchmark(PIXEL_FORMAT_R8G8B8A8_UNORM, PIXEL_FORMAT_B8G8R8A8_UNORM);
+    RunConversionBenchmark(PIXEL_FORMAT_B8G8R8X8_UNORM, PIXEL_FORMAT_R8G8B8A8_UNORM);
+    RunConversionBenchmark(PIXEL_FORMAT_R8G8B8_UNORM, PIXEL_FORMAT_R8G8B8A8_UNORM);
+    RunConversionBenchmark(PIXEL_FORMAT_B8G8R8_UNORM, PIXEL_FORMAT_R8G8B8A8_UNORM);
+    RunConversionBenchmark(PIXEL_FORMAT_R8G8B8A8_UNORM, PIXEL_FORMAT_R8G8B8_UNORM);
+    RunConversionBenchmark(PIXEL_FORMAT_R8_UNORM, PIXEL_FORMAT_R8G8B8A8_UNORM);
+    RunConversionBenchmark(PIXEL_FORMAT_R8G8B8A8_UNORM, PIXEL_FORMAT_R32G32B32A32_FLOAT);
+    RunConversionBenchmark(PIXEL_FORMAT_R32G32B32A32_FLOAT, PIXEL_FORMAT_R8G8B8A8_UNORM);
+    RunConversionBenchmark(PIXEL_FORMAT_R32G32B32A32_FLOAT, PIXEL_FORMAT_R16G16B16A16_FLOAT);
+    RunConversionBenchmark(PIXEL_FORMAT_R16G16B16A16_FLOAT, PIXEL_FORMAT_R32G32B32A32_FLOAT);
+    return 0;
+}
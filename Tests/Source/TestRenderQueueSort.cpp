@@ -0,0 +1,117 @@
+#include "Renderer/Common.h"
+#include "Renderer/RenderQueue.h"
+#include "Core/RandomNumberGenerator.h"
+#include "YBaseLib/Timer.h"
+#include "YBaseLib/Log.h"
+#include <algorithm>
+Log_SetChannel(TestRenderQueueSort);
+
+// Compares the std::sort over full queue entries against the radix sort/gather used by RenderQueue::Sort.
+
+static const uint32 BENCHMARK_ITERATIONS = 20;
+static const uint32 BENCHMARK_MATERIAL_COUNT = 64;
+
+static bool CompareQueueEntries(const RENDER_QUEUE_RENDERABLE_ENTRY &lhs, const RENDER_QUEUE_RENDERABLE_ENTRY &rhs)
+{
+    return (lhs.SortKey < rhs.SortKey);
+}
+
+static uint64 MakeBenchmarkSortKey(RandomNumberGenerator &rng)
+{
+    // layer 1, one of a small set of materials, random depth, same as MakeSortKey for opaque objects
+    uint64 materialPart = rng.NextRangeUInt(0, BENCHMARK_MATERIAL_COUNT - 1) * 0x9E3779B1u;
+    uint64 depthPart = rng.NextUInt();
+    return (uint64(1) << 60) | ((materialPart & 0x07FFFFFF) << 32) | depthPart;
+}
+
+static void FillEntries(RenderQueue::RenderableArray &entries, uint32 count, RandomNumberGenerator &rng)
+{
+    entries.Resize(count);
+    for (uint32 i = 0; i < count; i++)
+        entries[i].SortKey = MakeBenchmarkSortKey(rng);
+}
+
+static void JitterEntries(RenderQueue::RenderableArray &entries, RandomNumberGenerator &rng)
+{
+    // simulate the camera moving slightly, a few objects change depth
+    for (uint32 i = 0; i < entries.GetSize(); i += 64)
+        entries[i].SortKey = (entries[i].SortKey & 0xFFFFFFFF00000000ULL) | (uint64)rng.NextUInt();
+}
+
+static void CheckSorted(const RenderQueue::RenderableArray &entries, const char *name)
+{
+    for (uint32 i = 1; i < entries.GetSize(); i++)
+    {
+        if (entries[i].SortKey < entries[i - 1].SortKey)
+        {
+            Log_ErrorPrintf("%s: entries not sorted at index %u", name, i);
+            return;
+        }
+    }
+}
+
+static void RunBenchmark(uint32 count)
+{
+    RandomNumberGenerator rng(count);
+    RenderQueue::RenderableArray sourceEntries;
+    RenderQueue::RenderableArray entries;
+    FillEntries(sourceEntries, count, rng);
+
+    Timer timer;
+    double stdSortTime = 0.0;
+    double radixSortTime = 0.0;
+    double coherentSortTime = 0.0;
+
+    for (uint32 iteration = 0; iteration < BENCHMARK_ITERATIONS; iteration++)
+    {
+        entries.Clear();
+        entries.AddRange(sourceEntries.GetBasePointer(), sourceEntries.GetSize());
+        timer.Reset();
+        std::sort(entries.GetBasePointer(), entries.GetBasePointer() + entries.GetSize(), CompareQueueEntries);
+        stdSortTime += timer.GetTimeMilliseconds();
+        CheckSorted(entries, "std::sort");
+
+        // fresh state each iteration, so the previous order can't be reused
+        RenderQueue::SortState sortState;
+        entries.Clear();
+        entries.AddRange(sourceEntries.GetBasePointer(), sourceEntries.GetSize());
+        timer.Reset();
+        RenderQueue::SortRenderables(entries, sortState);
+        radixSortTime += timer.GetTimeMilliseconds();
+        CheckSorted(entries, "radix");
+    }
+
+    // frame-to-frame: same queue order each frame, with a small number of keys changing
+    {
+        RenderQueue::SortState sortState;
+        entries.Clear();
+        entries.AddRange(sourceEntries.GetBasePointer(), sourceEntries.GetSize());
+        RenderQueue::SortRenderables(entries, sortState);
+
+        for (uint32 iteration = 0; iteration < BENCHMARK_ITERATIONS; iteration++)
+        {
+            JitterEntries(sourceEntries, rng);
+            entries.Clear();
+            entries.AddRange(sourceEntries.GetBasePointer(), sourceEntries.GetSize());
+            timer.Reset();
+            RenderQueue::SortRenderables(entries, sortState);
+            coherentSortTime += timer.GetTimeMilliseconds();
+            CheckSorted(entries, "coherent");
+        }
+    }
+
+    Log_InfoPrintf("%u entries: std::sort %.4fms, radix %.4fms, radix coherent %.4fms", count,
+                   stdSortTime / (double)BENCHMARK_ITERATIONS,
+                   radixSortTime / (double)BENCHMARK_ITERATIONS,
+                   coherentSortTime / (double)BENCHMARK_ITERATIONS);
+}
+
+int main_rqsort(int argc, char *argv[])
+{
+    Log::GetInstance().SetConsoleOutputParams(true);
+
+    RunBenchmark(1000);
+    RunBenchmark(10000);
+    RunBenchmark(100000);
+    return 0;
+}
@@ -0,0 +1,128 @@
+#include "Renderer/Common.h"
+#include "Renderer/ShaderMap.h"
+#include "Core/RandomNumberGenerator.h"
+#include "YBaseLib/Timer.h"
+#include "YBaseLib/Log.h"
+Log_SetChannel(TestShaderMapLookup);
+
+// Compares the binary search over a sorted key array, as ShaderMap used to do, against the hashed lookup, with
+// draw-order resolves spread over every loaded permutation.
+
+static const uint32 BENCHMARK_ITERATIONS = 20;
+static const uint32 BENCHMARK_LOOKUPS = 100000;
+static const uint32 BENCHMARK_BASE_SHADER_COUNT = 16;
+static const uint32 BENCHMARK_VERTEX_FACTORY_COUNT = 8;
+static const uint32 BENCHMARK_MATERIAL_SHADER_COUNT = 256;
+
+typedef KeyValuePair<ShaderMap::Key, ShaderProgram *> SortedEntry;
+
+// the permutation table is private, the map only exposes lookups that load programs
+struct ShaderMapTestAccess
+{
+    static bool FindLoadedPermutation(const ShaderMap &shaderMap, const ShaderMap::Key &key, ShaderProgram **ppProgram) { return shaderMap.FindLoadedPermutation(key, ppProgram); }
+    static void AddLoadedPermutation(const ShaderMap &shaderMap, const ShaderMap::Key &key, ShaderProgram *pProgram) { shaderMap.AddLoadedPermutation(key, pProgram); }
+};
+
+// the old comparison, the fields before the hash
+static int32 CompareKeys(const ShaderMap::Key *a, const ShaderMap::Key *b)
+{
+    return Y_memcmp(a, b, offsetof(ShaderMap::Key, Hash));
+}
+
+template<typename T>
+static const T *MakeFakePointer(uint32 index)
+{
+    // never dereferenced, only compared and hashed
+    return reinterpret_cast<const T *>((size_t)(index + 1) * 256);
+}
+
+static ShaderMap::Key MakeBenchmarkKey(RandomNumberGenerator &rng)
+{
+    return ShaderMap::Key(rng.NextRangeUInt(0, 3),
+                          MakeFakePointer<ShaderComponentTypeInfo>(rng.NextRangeUInt(0, BENCHMARK_BASE_SHADER_COUNT - 1)), rng.NextRangeUInt(0, 7),
+                          MakeFakePointer<VertexFactoryTypeInfo>(rng.NextRangeUInt(0, BENCHMARK_VERTEX_FACTORY_COUNT - 1)), rng.NextRangeUInt(0, 3),
+                          MakeFakePointer<MaterialShader>(rng.NextRangeUInt(0, BENCHMARK_MATERIAL_SHADER_COUNT - 1)), rng.NextRangeUInt(0, 15));
+}
+
+static void RunBenchmark(uint32 permutationCount)
+{
+    RandomNumberGenerator rng(permutationCount);
+    MemArray<ShaderMap::Key> keys;
+    ShaderMap shaderMap;
+
+    // the values are left null, which the map stores for failed loads, so nothing is deleted on destruction
+    Timer timer;
+    double hashedBuildTime = 0.0;
+    while (keys.GetSize() < permutationCount)
+    {
+        ShaderMap::Key key(MakeBenchmarkKey(rng));
+        ShaderProgram *pProgram;
+        if (ShaderMapTestAccess::FindLoadedPermutation(shaderMap, key, &pProgram))
+            continue;
+
+        timer.Reset();
+        ShaderMapTestAccess::AddLoadedPermutation(shaderMap, key, nullptr);
+        hashedBuildTime += timer.GetTimeMilliseconds();
+        keys.Add(key);
+    }
+
+    // the old path re-sorted after every load
+    MemArray<SortedEntry> sortedEntries;
+    timer.Reset();
+    for (uint32 i = 0; i < keys.GetSize(); i++)
+    {
+        sortedEntries.Add(SortedEntry(keys[i], nullptr));
+        sortedEntries.SortCB([](const SortedEntry &a, const SortedEntry &b) { return CompareKeys(&a.Key, &b.Key); });
+    }
+    double sortedBuildTime = timer.GetTimeMilliseconds();
+
+    // resolve order, each selector builds its key before looking it up
+    MemArray<uint32> lookupOrder;
+    lookupOrder.Resize(BENCHMARK_LOOKUPS);
+    for (uint32 i = 0; i < BENCHMARK_LOOKUPS; i++)
+        lookupOrder[i] = rng.NextRangeUInt(0, permutationCount - 1);
+
+    double sortedLookupTime = 0.0;
+    double hashedLookupTime = 0.0;
+    uint32 sortedFound = 0;
+    uint32 hashedFound = 0;
+    for (uint32 iteration = 0; iteration < BENCHMARK_ITERATIONS; iteration++)
+    {
+        timer.Reset();
+        for (uint32 i = 0; i < BENCHMARK_LOOKUPS; i++)
+        {
+            const ShaderMap::Key &key = keys[lookupOrder[i]];
+            if (sortedEntries.BinarySearchKey<ShaderMap::Key>(key, [](const ShaderMap::Key *key, const SortedEntry *pe) { return CompareKeys(key, &pe->Key); }) != nullptr)
+                sortedFound++;
+        }
+        sortedLookupTime += timer.GetTimeMilliseconds();
+
+        timer.Reset();
+        for (uint32 i = 0; i < BENCHMARK_LOOKUPS; i++)
+        {
+            const ShaderMap::Key &sourceKey = keys[lookupOrder[i]];
+            ShaderMap::Key key(sourceKey.GlobalShaderFlags, sourceKey.pBaseShaderTypeInfo, sourceKey.BaseShaderFlags, sourceKey.pVertexFactoryTypeInfo, sourceKey.VertexFactoryFlags, sourceKey.pMaterialShader, sourceKey.MaterialShaderFlags);
+            ShaderProgram *pProgram;
+            if (ShaderMapTestAccess::FindLoadedPermutation(shaderMap, key, &pProgram))
+                hashedFound++;
+        }
+        hashedLookupTime += timer.GetTimeMilliseconds();
+    }
+
+    if (sortedFound != hashedFound || hashedFound != BENCHMARK_LOOKUPS * BENCHMARK_ITERATIONS)
+        Log_ErrorPrintf("%u permutations: lookup mismatch, sorted %u hashed %u", permutationCount, sortedFound, hashedFound);
+
+    Log_InfoPrintf("%u permutations: build sorted %.4fms hashed %.4fms, %u lookups sorted %.4fms hashed %.4fms (hashed includes key construction)",
+                   permutationCount, sortedBuildTime, hashedBuildTime, BENCHMARK_LOOKUPS,
+                   sortedLookupTime / (double)BENCHMARK_ITERATIONS, hashedLookupTime / (double)BENCHMARK_ITERATIONS);
+}
+
+int main_shadermap(int argc, char *argv[])
+{
+    Log::GetInstance().SetConsoleOutputParams(true);
+
+    RunBenchmark(500);
+    RunBenchmark(2000);
+    RunBenchmark(5000);
+    return 0;
+}
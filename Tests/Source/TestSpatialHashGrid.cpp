@@ -0,0 +1,106 @@
+#include "Engine/Common.h"
+#include "Engine/SpatialHashGrid.h"
+#include "Core/RandomNumberGenerator.h"
+#include "YBaseLib/Timer.h"
+#include "YBaseLib/Log.h"
+Log_SetChannel(TestSpatialHashGrid);
+
+// Compares a linear scan over all entity bounds, as DynamicWorld used to do, against the spatial hash grid,
+// with every entity moving each frame and a batch of gameplay-sized queries.
+
+static const uint32 BENCHMARK_FRAMES = 20;
+static const uint32 BENCHMARK_QUERIES_PER_FRAME = 1000;
+static const float BENCHMARK_WORLD_SIZE = 4096.0f;
+static const float BENCHMARK_WORLD_HEIGHT = 256.0f;
+static const float BENCHMARK_QUERY_RADIUS = 24.0f;
+
+struct BenchmarkEntity
+{
+    float3 Position;
+    float3 Velocity;
+    float Radius;
+    uint32 GridHandle;
+
+    AABox GetBounds() const { return AABox(Position - float3(Radius, Radius, Radius), Position + float3(Radius, Radius, Radius)); }
+};
+
+static void RunBenchmark(uint32 entityCount, float cellSize)
+{
+    RandomNumberGenerator rng(entityCount);
+    MemArray<BenchmarkEntity> entities;
+    entities.Resize(entityCount);
+
+    SpatialHashGrid grid(cellSize);
+    for (uint32 i = 0; i < entityCount; i++)
+    {
+        BenchmarkEntity &entity = entities[i];
+        entity.Position.Set(rng.NextRangeFloat(0.0f, BENCHMARK_WORLD_SIZE), rng.NextRangeFloat(0.0f, BENCHMARK_WORLD_HEIGHT), rng.NextRangeFloat(0.0f, BENCHMARK_WORLD_SIZE));
+        entity.Velocity.Set(rng.NextRangeFloat(-4.0f, 4.0f), rng.NextRangeFloat(-1.0f, 1.0f), rng.NextRangeFloat(-4.0f, 4.0f));
+        entity.Radius = rng.NextRangeFloat(0.5f, 2.0f);
+        entity.GridHandle = grid.Insert(entity.GetBounds(), i);
+    }
+
+    Timer timer;
+    double moveTime = 0.0;
+    double linearQueryTime = 0.0;
+    double gridQueryTime = 0.0;
+    uint64 linearResults = 0;
+    uint64 gridResults = 0;
+
+    for (uint32 frame = 0; frame < BENCHMARK_FRAMES; frame++)
+    {
+        // move everything, same as each entity calling MoveEntity
+        timer.Reset();
+        for (uint32 i = 0; i < entityCount; i++)
+        {
+            BenchmarkEntity &entity = entities[i];
+            entity.Position += entity.Velocity;
+            grid.Move(entity.GridHandle, entity.GetBounds());
+        }
+        moveTime += timer.GetTimeMilliseconds();
+
+        // generate this frame's queries
+        MemArray<AABox> queries;
+        queries.Resize(BENCHMARK_QUERIES_PER_FRAME);
+        for (uint32 i = 0; i < BENCHMARK_QUERIES_PER_FRAME; i++)
+        {
+            const float3 &center = entities[rng.NextRangeUInt(0, entityCount - 1)].Position;
+            queries[i] = AABox(center - float3(BENCHMARK_QUERY_RADIUS, BENCHMARK_QUERY_RADIUS, BENCHMARK_QUERY_RADIUS), center + float3(BENCHMARK_QUERY_RADIUS, BENCHMARK_QUERY_RADIUS, BENCHMARK_QUERY_RADIUS));
+        }
+
+        timer.Reset();
+        for (uint32 i = 0; i < BENCHMARK_QUERIES_PER_FRAME; i++)
+        {
+            for (uint32 j = 0; j < entityCount; j++)
+            {
+                if (queries[i].AABoxIntersection(entities[j].GetBounds()))
+                    linearResults++;
+            }
+        }
+        linearQueryTime += timer.GetTimeMilliseconds();
+
+        timer.Reset();
+        for (uint32 i = 0; i < BENCHMARK_QUERIES_PER_FRAME; i++)
+            grid.EnumerateAABox(queries[i], [&gridResults](uint32) { gridResults++; });
+        gridQueryTime += timer.GetTimeMilliseconds();
+    }
+
+    if (linearResults != gridResults)
+        Log_ErrorPrintf("%u entities: result mismatch, linear %u grid %u", entityCount, (uint32)linearResults, (uint32)gridResults);
+
+    Log_InfoPrintf("%u entities, cell size %.0f: move %.4fms, %u queries linear %.4fms grid %.4fms, %.1f results/query, %u cells",
+                   entityCount, cellSize, moveTime / (double)BENCHMARK_FRAMES, BENCHMARK_QUERIES_PER_FRAME,
+                   linearQueryTime / (double)BENCHMARK_FRAMES, gridQueryTime / (double)BENCHMARK_FRAMES,
+                   (double)gridResults / (double)(BENCHMARK_FRAMES * BENCHMARK_QUERIES_PER_FRAME), grid.GetOccupiedCellCount());
+}
+
+int main_spatialgrid(int argc, char *argv[])
+{
+    Log::GetInstance().SetConsoleOutputParams(true);
+
+    RunBenchmark(5000, 16.0f);
+    RunBenchmark(50000, 8.0f);
+    RunBenchmark(50000, 16.0f);
+    RunBenchmark(50000, 32.0f);
+    return 0;
+}